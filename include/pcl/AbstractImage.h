@@ -65,6 +65,7 @@
 #include <pcl/ReferenceArray.h>
 #include <pcl/StatusMonitor.h>
 #include <pcl/Thread.h>
+#include <pcl/ThreadPool.h>
 
 #ifdef __PCL_BUILDING_PIXINSIGHT_APPLICATION
 namespace pi
@@ -946,7 +947,12 @@ public:
     *
     * When the \a threads array contains more than one thread, this static
     * member function launches the threads in sequence and waits until all
-    * threads have finished execution. While the threads are running, the
+    * threads have finished execution. If pooled execution of threads is
+    * enabled (see ThreadPool::IsEnabled()), or if this function is called
+    * from a pool worker thread, the threads are executed on persistent pool
+    * workers (see TaskGroup::Start()) instead of being started as new
+    * execution threads, which avoids the cost of thread creation for each
+    * call. While the threads are running, the
     * \c status member of ThreadData is incremented regularly to perform the
     * process monitoring task. This also ensures that the graphical interface
     * remains responsive during the whole process.
@@ -1006,6 +1012,12 @@ public:
          }
       }
 
+      if ( ThreadPool::IsEnabled() || ThreadPool::IsWorkerThread() )
+      {
+         RunPooledThreads( threads, data );
+         return;
+      }
+
       if ( useAffinity )
          if ( !Thread::IsRootThread() )
             useAffinity = false;
@@ -1064,6 +1076,63 @@ public:
 
 protected:
 
+   template <class thread>
+   static void RunPooledThreads( ReferenceArray<thread>& threads, ThreadData& data )
+   {
+      TaskGroup group;
+      for ( thread& t : threads )
+         group.Start( t );
+
+      /*
+       * Pool workers must not block waiting for nested tasks: help execute
+       * pending tasks instead. Status monitoring is performed by the thread
+       * that started the outermost set of threads.
+       */
+      if ( ThreadPool::IsWorkerThread() )
+      {
+         group.Wait();
+         return;
+      }
+
+      uint32 waitTime = StatusMonitor::RefreshRate() >> 1;
+      waitTime += waitTime >> 2; // waitTime = 0.625 * StatusMonitor::RefreshRate()
+
+      for ( size_type lastCount = 0; ; )
+      {
+         if ( group.Wait( waitTime ) )
+         {
+            if ( data.total > 0 )
+               data.status += data.total - lastCount;
+            return;
+         }
+
+         if ( data.mutex.TryLock() )
+         {
+            try
+            {
+               if ( data.total > 0 )
+               {
+                  data.status += data.count - lastCount;
+                  lastCount = data.count;
+               }
+               else
+                  ++data.status;
+
+               data.mutex.Unlock();
+            }
+            catch ( ... )
+            {
+               data.mutex.Unlock();
+               for ( thread& t : threads )
+                  t.Abort();
+               group.Wait();
+               threads.Destroy();
+               throw ProcessAborted();
+            }
+         }
+      }
+   }
+
    mutable ImageSelections m_selected;
    mutable selection_stack m_savedSelections;
    mutable StatusMonitor   m_status;
@@ -74,6 +74,10 @@ namespace pcl
  * On output, A is replaced by its inverse matrix and B is the set of solution
  * vectors X.
  *
+ * The system is solved by LU decomposition with partial pivoting (see
+ * GenericLUDecomposition). Throws an Error exception if A is not square, if A
+ * and B have different numbers of rows, or if A is singular.
+ *
  * This is an overloaded function for the Matrix type, which is a template
  * instantiation of GenericMatrix for double.
  *
@@ -87,6 +91,10 @@ void PCL_FUNC InPlaceGaussJordan( Matrix& A, Matrix& B );
  * On output, A is replaced by its inverse matrix and B is the set of solution
  * vectors X.
  *
+ * The system is solved by LU decomposition with partial pivoting (see
+ * GenericLUDecomposition). Throws an Error exception if A is not square, if A
+ * and B have different numbers of rows, or if A is singular.
+ *
  * This is an overloaded function for the FMatrix type, which is a template
  * instantiation of GenericMatrix for float.
  *
@@ -219,12 +227,383 @@ public:
 
 // ----------------------------------------------------------------------------
 
+void PCL_FUNC LUDecompositionImplementation( Matrix&, IVector& );
+void PCL_FUNC LUDecompositionImplementation( FMatrix&, IVector& );
+void PCL_FUNC LUSolveImplementation( const Matrix&, const IVector&, Matrix& );
+void PCL_FUNC LUSolveImplementation( const FMatrix&, const IVector&, FMatrix& );
+
+/*!
+ * \class GenericLUDecomposition
+ * \brief Generic LU decomposition with partial pivoting.
+ *
+ * Computes the factorization P*A = L*U of a square matrix A, where P is a
+ * permutation matrix, L is a lower triangular matrix with unit diagonal
+ * elements, and U is an upper triangular matrix. The decomposition is
+ * performed by a blocked algorithm where most of the work is done by cache
+ * blocked, vectorized and parallelized matrix products.
+ */
+template <typename T>
+class PCL_CLASS GenericLUDecomposition
+{
+public:
+
+   /*!
+    * Represents a vector involved in an LU decomposition.
+    */
+   typedef GenericVector<T>            vector;
+
+   /*!
+    * Represents a matrix involved in an LU decomposition.
+    */
+   typedef GenericMatrix<T>            matrix;
+
+   /*!
+    * Represents a vector component.
+    */
+   typedef typename vector::component  vector_component;
+
+   /*!
+    * Represents a matrix element.
+    */
+   typedef typename matrix::element    matrix_element;
+
+   /*!
+    * The L and U factors of the decomposition. The strict lower triangle of
+    * this matrix stores L (excluding its implicit unit diagonal elements);
+    * the diagonal and upper triangle store U.
+    */
+   matrix LU;
+
+   /*!
+    * Row interchanges. During the decomposition, the row i of the matrix has
+    * been interchanged with the row P[i], for i = 0,1,...,n-1 in that order.
+    */
+   IVector P;
+
+   /*!
+    * LU decomposition of a square matrix \a A.
+    *
+    * Throws an Error exception if \a A is not square or is singular.
+    */
+   GenericLUDecomposition( const matrix& A ) :
+      LU( A )
+   {
+      LUDecompositionImplementation( LU, P );
+   }
+
+   /*!
+    * Returns the solution to the linear system A*x = b.
+    */
+   vector Solve( const vector& b ) const
+   {
+      matrix X = matrix::FromColumnVector( b );
+      LUSolveImplementation( LU, P, X );
+      return X.ColumnVector( 0 );
+   }
+
+   /*!
+    * Returns the set of solution vectors to the linear system A*X = B.
+    */
+   matrix Solve( const matrix& B ) const
+   {
+      matrix X( B );
+      LUSolveImplementation( LU, P, X );
+      return X;
+   }
+
+   /*!
+    * Returns the inverse of the decomposed matrix.
+    */
+   matrix Inverse() const
+   {
+      return Solve( matrix::UnitMatrix( LU.Rows() ) );
+   }
+
+   /*!
+    * Returns the determinant of the decomposed matrix.
+    */
+   double Determinant() const
+   {
+      double d = 1;
+      for ( int i = 0; i < LU.Rows(); ++i )
+      {
+         d *= LU[i][i];
+         if ( P[i] != i )
+            d = -d;
+      }
+      return d;
+   }
+};
+
+/*!
+ * \class LUDecomposition
+ * \brief LU decomposition with partial pivoting for Matrix objects.
+ *
+ * %LUDecomposition is a template instantiation of GenericLUDecomposition for
+ * the double type. %LUDecomposition works with Matrix and Vector objects.
+ */
+class PCL_CLASS LUDecomposition : public GenericLUDecomposition<double>
+{
+public:
+
+   /*!
+    * Identifies the parent template class, which implements the underlying
+    * algorithm for this class.
+    */
+   typedef GenericLUDecomposition<double>    algorithm_implementation;
+
+   /*!
+    * Represents a vector involved in an LU decomposition.
+    */
+   typedef algorithm_implementation::vector  vector;
+
+   /*!
+    * Represents a matrix involved in an LU decomposition.
+    */
+   typedef algorithm_implementation::matrix  matrix;
+
+   /*!
+    * LU decomposition of a square matrix \a A.
+    *
+    * Throws an Error exception if \a A is not square or is singular.
+    */
+   LUDecomposition( const Matrix& A ) :
+      algorithm_implementation( A )
+   {
+   }
+};
+
+/*!
+ * \class FLUDecomposition
+ * \brief LU decomposition with partial pivoting for FMatrix objects.
+ *
+ * %FLUDecomposition is a template instantiation of GenericLUDecomposition for
+ * the float type. %FLUDecomposition works with FMatrix and FVector objects.
+ */
+class PCL_CLASS FLUDecomposition : public GenericLUDecomposition<float>
+{
+public:
+
+   /*!
+    * Identifies the parent template class, which implements the underlying
+    * algorithm for this class.
+    */
+   typedef GenericLUDecomposition<float>     algorithm_implementation;
+
+   /*!
+    * Represents a vector involved in an LU decomposition.
+    */
+   typedef algorithm_implementation::vector  vector;
+
+   /*!
+    * Represents a matrix involved in an LU decomposition.
+    */
+   typedef algorithm_implementation::matrix  matrix;
+
+   /*!
+    * LU decomposition of a square matrix \a A.
+    *
+    * Throws an Error exception if \a A is not square or is singular.
+    */
+   FLUDecomposition( const FMatrix& A ) :
+      algorithm_implementation( A )
+   {
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+void PCL_FUNC CholeskyDecompositionImplementation( Matrix& );
+void PCL_FUNC CholeskyDecompositionImplementation( FMatrix& );
+void PCL_FUNC CholeskySolveImplementation( const Matrix&, Matrix& );
+void PCL_FUNC CholeskySolveImplementation( const FMatrix&, FMatrix& );
+
+/*!
+ * \class GenericCholeskyDecomposition
+ * \brief Generic Cholesky decomposition of symmetric positive definite matrices.
+ *
+ * Computes the factorization A = L*Lt of a symmetric positive definite matrix
+ * A, where L is a lower triangular matrix with positive diagonal elements.
+ * Only the lower triangle of A is used. For symmetric positive definite
+ * systems, such as normal equations and thin plate spline systems with
+ * smoothing, this is about twice as fast as an LU decomposition.
+ */
+template <typename T>
+class PCL_CLASS GenericCholeskyDecomposition
+{
+public:
+
+   /*!
+    * Represents a vector involved in a Cholesky decomposition.
+    */
+   typedef GenericVector<T>            vector;
+
+   /*!
+    * Represents a matrix involved in a Cholesky decomposition.
+    */
+   typedef GenericMatrix<T>            matrix;
+
+   /*!
+    * Represents a vector component.
+    */
+   typedef typename vector::component  vector_component;
+
+   /*!
+    * Represents a matrix element.
+    */
+   typedef typename matrix::element    matrix_element;
+
+   /*!
+    * The lower triangular factor L of the decomposition. The elements above
+    * the main diagonal are zero.
+    */
+   matrix L;
+
+   /*!
+    * Cholesky decomposition of a symmetric positive definite matrix \a A.
+    *
+    * Throws an Error exception if \a A is not square or is not positive
+    * definite.
+    */
+   GenericCholeskyDecomposition( const matrix& A ) :
+      L( A )
+   {
+      CholeskyDecompositionImplementation( L );
+   }
+
+   /*!
+    * Returns the solution to the linear system A*x = b.
+    */
+   vector Solve( const vector& b ) const
+   {
+      matrix X = matrix::FromColumnVector( b );
+      CholeskySolveImplementation( L, X );
+      return X.ColumnVector( 0 );
+   }
+
+   /*!
+    * Returns the set of solution vectors to the linear system A*X = B.
+    */
+   matrix Solve( const matrix& B ) const
+   {
+      matrix X( B );
+      CholeskySolveImplementation( L, X );
+      return X;
+   }
+
+   /*!
+    * Returns the inverse of the decomposed matrix.
+    */
+   matrix Inverse() const
+   {
+      return Solve( matrix::UnitMatrix( L.Rows() ) );
+   }
+
+   /*!
+    * Returns the determinant of the decomposed matrix.
+    */
+   double Determinant() const
+   {
+      double d = 1;
+      for ( int i = 0; i < L.Rows(); ++i )
+         d *= L[i][i];
+      return d*d;
+   }
+};
+
+/*!
+ * \class CholeskyDecomposition
+ * \brief Cholesky decomposition for Matrix objects.
+ *
+ * %CholeskyDecomposition is a template instantiation of
+ * GenericCholeskyDecomposition for the double type. %CholeskyDecomposition
+ * works with Matrix and Vector objects.
+ */
+class PCL_CLASS CholeskyDecomposition : public GenericCholeskyDecomposition<double>
+{
+public:
+
+   /*!
+    * Identifies the parent template class, which implements the underlying
+    * algorithm for this class.
+    */
+   typedef GenericCholeskyDecomposition<double> algorithm_implementation;
+
+   /*!
+    * Represents a vector involved in a Cholesky decomposition.
+    */
+   typedef algorithm_implementation::vector     vector;
+
+   /*!
+    * Represents a matrix involved in a Cholesky decomposition.
+    */
+   typedef algorithm_implementation::matrix     matrix;
+
+   /*!
+    * Cholesky decomposition of a symmetric positive definite matrix \a A.
+    *
+    * Throws an Error exception if \a A is not square or is not positive
+    * definite.
+    */
+   CholeskyDecomposition( const Matrix& A ) :
+      algorithm_implementation( A )
+   {
+   }
+};
+
+/*!
+ * \class FCholeskyDecomposition
+ * \brief Cholesky decomposition for FMatrix objects.
+ *
+ * %FCholeskyDecomposition is a template instantiation of
+ * GenericCholeskyDecomposition for the float type. %FCholeskyDecomposition
+ * works with FMatrix and FVector objects.
+ */
+class PCL_CLASS FCholeskyDecomposition : public GenericCholeskyDecomposition<float>
+{
+public:
+
+   /*!
+    * Identifies the parent template class, which implements the underlying
+    * algorithm for this class.
+    */
+   typedef GenericCholeskyDecomposition<float>  algorithm_implementation;
+
+   /*!
+    * Represents a vector involved in a Cholesky decomposition.
+    */
+   typedef algorithm_implementation::vector     vector;
+
+   /*!
+    * Represents a matrix involved in a Cholesky decomposition.
+    */
+   typedef algorithm_implementation::matrix     matrix;
+
+   /*!
+    * Cholesky decomposition of a symmetric positive definite matrix \a A.
+    *
+    * Throws an Error exception if \a A is not square or is not positive
+    * definite.
+    */
+   FCholeskyDecomposition( const FMatrix& A ) :
+      algorithm_implementation( A )
+   {
+   }
+};
+
+// ----------------------------------------------------------------------------
+
 void PCL_FUNC InPlaceSVDImplementation( Matrix&, Vector&, Matrix& );
 void PCL_FUNC InPlaceSVDImplementation( FMatrix&, FVector&, FMatrix& );
 
 /*!
  * \class GenericInPlaceSVD
  * \brief Generic in-place singular value decomposition algorithm.
+ *
+ * The decomposition is computed with the one-sided Jacobi method (Hestenes'
+ * algorithm), which computes small singular values with high relative
+ * accuracy. Column rotations are performed in parallel for large matrices.
+ * Singular values are not sorted.
  */
 template <typename T>
 class PCL_CLASS GenericInPlaceSVD
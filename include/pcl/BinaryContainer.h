@@ -0,0 +1,465 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/BinaryContainer.h - Released 2019-01-21T12:06:07Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#ifndef __PCL_BinaryContainer_h
+#define __PCL_BinaryContainer_h
+
+/// \file pcl/BinaryContainer.h
+
+#include <pcl/Defs.h>
+
+#include <pcl/Array.h>
+#include <pcl/String.h>
+#include <pcl/Vector.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \namespace pcl::BinaryBlockType
+ * \brief     Data types of blocks stored in binary data containers.
+ *
+ * <table border="1" cellpadding="4" cellspacing="0">
+ * <tr><td>BinaryBlockType::Invalid</td>  <td>Undefined or unsupported block type.</td></tr>
+ * <tr><td>BinaryBlockType::UInt8</td>    <td>8-bit unsigned integers.</td></tr>
+ * <tr><td>BinaryBlockType::Int32</td>    <td>32-bit signed integers.</td></tr>
+ * <tr><td>BinaryBlockType::UInt64</td>   <td>64-bit unsigned integers.</td></tr>
+ * <tr><td>BinaryBlockType::Float32</td>  <td>IEEE 754 32-bit floating point real numbers.</td></tr>
+ * <tr><td>BinaryBlockType::Float64</td>  <td>IEEE 754 64-bit floating point real numbers.</td></tr>
+ * <tr><td>BinaryBlockType::UTF8Text</td> <td>UTF-8 encoded text, not null-terminated.</td></tr>
+ * </table>
+ *
+ * \sa BinaryContainerWriter, BinaryContainerReader
+ */
+namespace BinaryBlockType
+{
+   enum value_type
+   {
+      Invalid,
+      UInt8,
+      Int32,
+      UInt64,
+      Float32,
+      Float64,
+      UTF8Text,
+      NumberOfTypes
+   };
+
+   /*!
+    * Returns the size in bytes of a data item of the specified block \a type,
+    * or zero if \a type is not a valid block type.
+    */
+   inline size_type ItemSize( value_type type )
+   {
+      switch ( type )
+      {
+      case UInt8:
+      case UTF8Text: return 1;
+      case Int32:
+      case Float32:  return 4;
+      case UInt64:
+      case Float64:  return 8;
+      default:       return 0;
+      }
+   }
+}
+
+/*!
+ * \internal
+ * Block type identification for the scalar types supported by binary data
+ * containers.
+ */
+inline BinaryBlockType::value_type BinaryBlockTypeOf( const uint8* )  { return BinaryBlockType::UInt8; }
+inline BinaryBlockType::value_type BinaryBlockTypeOf( const int32* )  { return BinaryBlockType::Int32; }
+inline BinaryBlockType::value_type BinaryBlockTypeOf( const uint64* ) { return BinaryBlockType::UInt64; }
+inline BinaryBlockType::value_type BinaryBlockTypeOf( const float* )  { return BinaryBlockType::Float32; }
+inline BinaryBlockType::value_type BinaryBlockTypeOf( const double* ) { return BinaryBlockType::Float64; }
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class BinaryContainerWriter
+ * \brief Generation of binary data container files
+ *
+ * A binary data container is a simple file format for fast storage and
+ * retrieval of numeric arrays. It is an alternative to %XML-based formats
+ * when large amounts of numeric data must be loaded, since data blocks are
+ * stored as raw, properly aligned arrays that can be accessed directly after
+ * mapping the file into memory. The layout of a container file is as follows
+ * (all integers are stored in little-endian byte order):
+ *
+ * <b>Header</b> - 64 bytes at offset zero:\n
+ * 8 bytes: the signature 'PCLBDC10'.\n
+ * 8 bytes: a format identifier of up to eight ASCII characters, padded with
+ * null characters. For example, 'XDRZ' for drizzle data.\n
+ * uint32: Number of data blocks.\n
+ * uint32: Reserved, must be zero.\n
+ * uint64: Total size of the file in bytes.\n
+ * 32 bytes: Reserved, must be zero.
+ *
+ * <b>Block directory</b> - one 64-byte entry for each data block, starting at
+ * offset 64:\n
+ * 24 bytes: Block identifier of up to 23 ASCII characters, padded with null
+ * characters. Identifiers are unique within a container.\n
+ * uint32: Block type, one of the BinaryBlockType::value_type constants.\n
+ * 3 x uint32: Block dimensions. Their meaning is defined by each format. For
+ * example, matrices use (rows,columns,0) and images (width,height,channels).\n
+ * uint64: Offset in bytes of the block data from the beginning of the file.
+ * This is always a multiple of 64 bytes.\n
+ * uint64: Size in bytes of the block data.\n
+ * uint64: Reserved, must be zero.
+ *
+ * <b>Block data</b> - stored after the directory, each data block beginning
+ * at a 64-byte boundary. Padding bytes are zero.
+ *
+ * Data blocks are written in the native byte order of the machine. All
+ * platforms supported by PixInsight are little-endian.
+ *
+ * \sa BinaryContainerReader
+ */
+class PCL_CLASS BinaryContainerWriter
+{
+public:
+
+   /*!
+    * Constructs a new binary container writer for the specified \a formatId,
+    * which must be a nonempty string of up to eight ASCII characters.
+    */
+   BinaryContainerWriter( const IsoString& formatId );
+
+   /*!
+    * Destroys a %BinaryContainerWriter object.
+    */
+   virtual ~BinaryContainerWriter()
+   {
+   }
+
+   /*!
+    * Adds a new data block to this container.
+    *
+    * \param id      Block identifier. Must be a nonempty string of up to 23
+    *                ASCII characters, unique in this container.
+    *
+    * \param type    Block type.
+    *
+    * \param data    Starting address of the block data. The data are not
+    *                copied by this function: the caller must guarantee that
+    *                the \a data remain valid until WriteFile() is called.
+    *
+    * \param size    Size in bytes of the block data.
+    *
+    * \param dim0, dim1, dim2    Block dimensions. Zero by default.
+    *
+    * Throws an Error exception if the specified block is not valid.
+    */
+   void AddBlock( const IsoString& id, BinaryBlockType::value_type type, const void* data, size_type size,
+                  int dim0 = 0, int dim1 = 0, int dim2 = 0 );
+
+   /*!
+    * Adds a new UTF-8 text block to this container. The specified \a text is
+    * converted to UTF-8 and stored in this object until it is destroyed.
+    * Empty strings are not stored.
+    */
+   void AddText( const IsoString& id, const String& text );
+
+   /*!
+    * Adds a one-dimensional block storing the components of a vector. The
+    * vector data are not copied: the caller must guarantee that \a v is not
+    * modified or destroyed until WriteFile() is called. Empty vectors are not
+    * stored.
+    */
+   template <typename T>
+   void AddVector( const IsoString& id, const GenericVector<T>& v )
+   {
+      if ( !v.IsEmpty() )
+         AddBlock( id, BinaryBlockTypeOf( v.Begin() ), v.Begin(), v.Size(), v.Length() );
+   }
+
+   /*!
+    * Writes all data blocks defined in this object to a new container file.
+    *
+    * \warning If a file already exists at the specified \a filePath, its
+    * previous contents will be lost after calling this function.
+    */
+   void WriteFile( const String& filePath ) const;
+
+private:
+
+   struct Block
+   {
+      IsoString                   id;
+      BinaryBlockType::value_type type;
+      int                         dim[ 3 ];
+      const void*                 data;
+      size_type                   size;
+      IsoString                   text;
+   };
+
+   IsoString    m_formatId;
+   Array<Block> m_blocks;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class BinaryContainerReader
+ * \brief Memory-mapped access to binary data container files
+ *
+ * %BinaryContainerReader maps a container file generated by
+ * BinaryContainerWriter into the address space of the calling process with
+ * read-only access. Data blocks can then be accessed directly through typed
+ * pointers, which are always aligned to 64-byte boundaries. Since data are
+ * only read from disk when they are accessed, blocks that are not used have
+ * no I/O cost. If the file cannot be mapped into memory, its entire contents
+ * are read into an aligned memory buffer.
+ *
+ * The file mapping remains valid until the reader is closed or destroyed.
+ *
+ * \sa BinaryContainerWriter
+ */
+class PCL_CLASS BinaryContainerReader
+{
+public:
+
+   /*!
+    * Describes a data block stored in a binary data container.
+    */
+   struct Block
+   {
+      IsoString                   id;       //!< Block identifier.
+      BinaryBlockType::value_type type;     //!< Block type.
+      int                         dim[ 3 ]; //!< Block dimensions.
+      const void*                 data;     //!< Starting address of the block data.
+      size_type                   size;     //!< Size of the block data in bytes.
+
+      /*!
+       * Returns the number of data items stored in this block.
+       */
+      size_type Length() const
+      {
+         return size/BinaryBlockType::ItemSize( type );
+      }
+   };
+
+   /*!
+    * Constructs an inactive %BinaryContainerReader object.
+    */
+   BinaryContainerReader() = default;
+
+   /*!
+    * Constructs a %BinaryContainerReader object and opens a container file.
+    * See Open() for a description of function parameters.
+    */
+   BinaryContainerReader( const String& filePath, const IsoString& formatId )
+   {
+      Open( filePath, formatId );
+   }
+
+   /*!
+    * Destroys a %BinaryContainerReader object. If a container file is open, it
+    * is closed and all mapped data are released.
+    */
+   virtual ~BinaryContainerReader()
+   {
+      Close();
+   }
+
+   /*!
+    * Copy constructor. This constructor is disabled because container readers
+    * are unique objects.
+    */
+   BinaryContainerReader( const BinaryContainerReader& ) = delete;
+
+   /*!
+    * Copy assignment. This operator is disabled because container readers are
+    * unique objects.
+    */
+   BinaryContainerReader& operator =( const BinaryContainerReader& ) = delete;
+
+   /*!
+    * Opens an existing container file.
+    *
+    * \param filePath   Path to the container file.
+    *
+    * \param formatId   The format identifier that the container must have.
+    *
+    * The file header and block directory are validated. This function throws
+    * an Error exception if the file is not a valid container, if its format
+    * identifier does not match \a formatId, or if an I/O error occurs.
+    */
+   void Open( const String& filePath, const IsoString& formatId );
+
+   /*!
+    * Closes the container file and releases all mapped data. Pointers to
+    * block data retrieved from this object are no longer valid after calling
+    * this function.
+    */
+   void Close();
+
+   /*!
+    * Returns true iff this object has an open container file.
+    */
+   bool IsOpen() const
+   {
+      return m_data != nullptr;
+   }
+
+   /*!
+    * Returns true iff the open container file has been mapped into memory,
+    * false if its contents have been read into a memory buffer.
+    */
+   bool IsMapped() const
+   {
+      return m_mapped;
+   }
+
+   /*!
+    * Returns the path to the open container file, or an empty string if this
+    * object is inactive.
+    */
+   const String& FilePath() const
+   {
+      return m_filePath;
+   }
+
+   /*!
+    * Returns the number of data blocks in the open container file.
+    */
+   int NumberOfBlocks() const
+   {
+      return int( m_blocks.Length() );
+   }
+
+   /*!
+    * Returns a reference to the data block at the specified zero-based
+    * \a index in the block directory.
+    */
+   const Block& operator []( int index ) const
+   {
+      return m_blocks[index];
+   }
+
+   /*!
+    * Returns the address of the data block with the specified identifier, or
+    * nullptr if no such block exists in the open container file.
+    */
+   const Block* FindBlock( const IsoString& id ) const;
+
+   /*!
+    * Returns a typed pointer to the data of a block with the specified
+    * identifier, or nullptr if no such block exists. If the block exists, its
+    * length in data items is stored in the variable referenced by \a length.
+    * Throws an Error exception if the block exists but its type does not
+    * correspond to the type T.
+    */
+   template <typename T>
+   const T* BlockData( const IsoString& id, size_type& length ) const
+   {
+      const Block* block = TypedBlock( id, BinaryBlockTypeOf( (const T*)nullptr ) );
+      if ( block == nullptr )
+         return nullptr;
+      length = block->Length();
+      return reinterpret_cast<const T*>( block->data );
+   }
+
+   /*!
+    * Returns a vector with a copy of the data stored in the block with the
+    * specified identifier, or an empty vector if no such block exists. Throws
+    * an Error exception if the block exists but its type does not correspond
+    * to the type T.
+    */
+   template <typename T>
+   GenericVector<T> VectorBlock( const IsoString& id ) const
+   {
+      size_type length;
+      const T* data = BlockData<T>( id, length );
+      if ( data == nullptr )
+         return GenericVector<T>();
+      return GenericVector<T>( data, int( length ) );
+   }
+
+   /*!
+    * Returns the text stored in a UTF-8 text block with the specified
+    * identifier, or an empty string if no such block exists.
+    */
+   String TextBlock( const IsoString& id ) const;
+
+   /*!
+    * Returns true iff the file at the specified path exists and begins with a
+    * valid binary data container signature.
+    */
+   static bool IsContainerFile( const String& filePath );
+
+private:
+
+   String       m_filePath;
+   const uint8* m_data = nullptr;
+   size_type    m_size = 0;
+   bool         m_mapped = false;
+   void*        m_fileHandle = nullptr;    // Windows only
+   void*        m_mappingHandle = nullptr; // Windows only
+   Array<Block> m_blocks;
+
+   const Block* TypedBlock( const IsoString& id, BinaryBlockType::value_type type ) const;
+   void LoadFile();
+   void ParseDirectory( const IsoString& formatId );
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __PCL_BinaryContainer_h
+
+// ----------------------------------------------------------------------------
+// EOF pcl/BinaryContainer.h - Released 2019-01-21T12:06:07Z
@@ -118,22 +118,31 @@ uint32 Checksum( const C& data )
  * Returns the CRC-32 error-detecting code calculated for a data sequence.
  *
  * \param data    Address of the first byte in the data sequence.
+ *
  * \param length  Length in bytes of the data sequence.
  *
- * \b References
+ * \param crc     Initial CRC-32 value. To compute the CRC-32 code of a
+ *                sequence processed in consecutive fragments, pass the value
+ *                returned for the preceding fragment. The default value is
+ *                zero, which starts a new calculation.
  *
- * CRC calculation routine based on original code by Michael Barr. The employed
- * code requires the following copyright notice:
+ * This function computes the standard CRC-32 code (ISO 3309, ITU-T V.42,
+ * zlib, PNG) with the reflected polynomial 0xEDB88320. On x86_64 processors
+ * supporting the PCLMULQDQ instruction, data blocks of 64 bytes or more are
+ * processed with a carry-less multiplication folding algorithm. Otherwise a
+ * portable slice-by-16 table-driven algorithm is used. The implementation is
+ * selected at runtime.
+ *
+ * \b References
  *
- * <em>Copyright (c) 2000 by Michael Barr.  This software is placed into the
- * public domain and may be used for any purpose.  However, this notice must
- * not be changed or removed and no warranty is either expressed or implied by
- * its publication or distribution.</em>
+ * V. Gopal, E. Ozturk, J. Guilford, G. Wolrich, W. Feghali, M. Dixon and
+ * D. Karakoyunlu, <em>Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction</em>, Intel Corporation, 2009.
  *
  * \ingroup checksum_functions
- * \sa CRC32( const C& )
+ * \sa CRC32( const C& ), CRC32C()
  */
-uint32 PCL_FUNC CRC32( const void* data, size_type length );
+uint32 PCL_FUNC CRC32( const void* data, size_type length, uint32 crc = 0 );
 
 /*!
  * Returns the CRC-32 error-detecting code for a container.
@@ -143,7 +152,7 @@ uint32 PCL_FUNC CRC32( const void* data, size_type length );
  *                current data bytes in this container instance.
  *
  * \ingroup checksum_functions
- * \sa CRC32( const void*, size_type )
+ * \sa CRC32( const void*, size_type, uint32 )
  */
 template <class C> inline
 uint32 CRC32( const C& data )
@@ -151,6 +160,46 @@ uint32 CRC32( const C& data )
    return CRC32( data.Begin(), sizeof( *(data.Begin()) )*data.Length() );
 }
 
+/*!
+ * Returns the CRC-32C (Castagnoli) error-detecting code calculated for a data
+ * sequence.
+ *
+ * \param data    Address of the first byte in the data sequence.
+ *
+ * \param length  Length in bytes of the data sequence.
+ *
+ * \param crc     Initial CRC-32C value. To compute the CRC-32C code of a
+ *                sequence processed in consecutive fragments, pass the value
+ *                returned for the preceding fragment. The default value is
+ *                zero, which starts a new calculation.
+ *
+ * CRC-32C uses the reflected Castagnoli polynomial 0x82F63B78 (iSCSI, ext4,
+ * Btrfs). It has better error detection properties than CRC-32 and is
+ * computed by a dedicated instruction on x86_64 processors supporting SSE4.2,
+ * which is used when available. Otherwise a portable slice-by-16 algorithm is
+ * used.
+ *
+ * \ingroup checksum_functions
+ * \sa CRC32C( const C& ), CRC32()
+ */
+uint32 PCL_FUNC CRC32C( const void* data, size_type length, uint32 crc = 0 );
+
+/*!
+ * Returns the CRC-32C error-detecting code for a container.
+ *
+ * \param data    Reference to a container whose CRC-32C checksum will be
+ *                calculated. The checksum code will be generated for the
+ *                current data bytes in this container instance.
+ *
+ * \ingroup checksum_functions
+ * \sa CRC32C( const void*, size_type, uint32 )
+ */
+template <class C> inline
+uint32 CRC32C( const C& data )
+{
+   return CRC32C( data.Begin(), sizeof( *(data.Begin()) )*data.Length() );
+}
+
 // ----------------------------------------------------------------------------
 
 } // pcl
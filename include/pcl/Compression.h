@@ -514,68 +514,29 @@ protected:
     * Byte shuffling algorithm applied to \a size bytes starting at \a data,
     * with element length \a itemSize in bytes. Returns the shuffled data as a
     * ByteArray object.
+    *
+    * Shuffling is performed with vectorized transposition kernels for item
+    * sizes of 2, 4 and 8 bytes on SSE2 capable architectures.
     */
-   static ByteArray Shuffle( const uint8* data, size_type size, size_type itemSize )
-   {
-      ByteArray shuffled( size );
-      if ( size > 0 && data != nullptr )
-      {
-         size_type numberOfItems = size / itemSize;
-         ByteArray::iterator s = shuffled.Begin();
-         for ( size_type j = 0; j < itemSize; ++j )
-         {
-            ByteArray::const_iterator u = data + j;
-            for ( size_type i = 0; i < numberOfItems; ++i, ++s, u += itemSize )
-               *s = *u;
-         }
-         ::memcpy( s, data + numberOfItems*itemSize, size % itemSize );
-      }
-      return shuffled;
-   }
+   static ByteArray Shuffle( const uint8* data, size_type size, size_type itemSize );
 
    /*!
     * Reverse byte shuffling algorithm (or \e unshuffling) applied to \a size
     * bytes starting at \a data, with element length \a itemSize in bytes.
     * Returns the unshuffled data as a ByteArray object.
     */
-   static ByteArray Unshuffle( const uint8* data, size_type size, size_type itemSize )
-   {
-      ByteArray unshuffled( size );
-      if ( size > 0 && data != nullptr )
-      {
-         size_type numberOfItems = size / itemSize;
-         ByteArray::const_iterator s = data;
-         for ( size_type j = 0; j < itemSize; ++j )
-         {
-            ByteArray::iterator u = unshuffled.At( j );
-            for ( size_type i = 0; i < numberOfItems; ++i, ++s, u += itemSize )
-               *u = *s;
-         }
-         ::memcpy( unshuffled.At( numberOfItems*itemSize ), s, size % itemSize );
-      }
-      return unshuffled;
-   }
+   static ByteArray Unshuffle( const uint8* data, size_type size, size_type itemSize );
 
    /*!
     * In-place reverse byte shuffling algorithm (or \e unshuffling) applied to
     * \a size bytes starting at \a data, with element length \a itemSize in
     * bytes.
+    *
+    * This function does not allocate a copy of the data block. Besides a
+    * small fixed-size buffer, it only requires one bit of temporary storage
+    * for every 16384/\a itemSize bytes of data.
     */
-   static void InPlaceUnshuffle( uint8* data, size_type size, size_type itemSize )
-   {
-      if ( size > 0 && data != nullptr )
-      {
-         const ByteArray shuffled( data, data+size );
-         size_type numberOfItems = size / itemSize;
-         ByteArray::const_iterator s = shuffled.Begin();
-         for ( size_type j = 0; j < itemSize; ++j )
-         {
-            ByteArray::iterator u = data + j;
-            for ( size_type i = 0; i < numberOfItems; ++i, ++s, u += itemSize )
-               *u = *s;
-         }
-      }
-   }
+   static void InPlaceUnshuffle( uint8* data, size_type size, size_type itemSize );
 
    /*!
     * Helper function to throw an error message with inclusion of the algorithm
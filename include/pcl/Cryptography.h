@@ -300,6 +300,9 @@ private:
  *
  * An SHA-1 message digest (or SHA-1 hash value) is 160 bits (20 bytes) long.
  *
+ * On x86_64 processors supporting the Intel SHA extensions, message blocks
+ * are compressed with the SHA-NI instructions. This is detected at runtime.
+ *
  * \ingroup cryptography_classes
  * \sa CryptographicHash, MD5, SHA224, SHA256, SHA384, SHA512,
  *     CryptographicHashFactory
@@ -348,7 +351,7 @@ public:
 
 private:
 
-   void* m_context = nullptr; // RFC4634
+   void* m_context = nullptr;
 
    /*!
     */
@@ -443,6 +446,9 @@ private:
  *
  * An SHA-256 message digest is 256 bits (32 bytes) long.
  *
+ * On x86_64 processors supporting the Intel SHA extensions, message blocks
+ * are compressed with the SHA-NI instructions. This is detected at runtime.
+ *
  * \ingroup cryptography_classes
  * \sa CryptographicHash, MD5, SHA1, SHA224, SHA384, SHA512,
  *     CryptographicHashFactory
@@ -491,7 +497,7 @@ public:
 
 private:
 
-   void* m_context = nullptr; // RFC4634
+   void* m_context = nullptr;
 
    /*!
     */
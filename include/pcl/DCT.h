@@ -0,0 +1,791 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/DCT.h - Released 2019-01-21T12:06:07Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#ifndef __PCL_DCT_h
+#define __PCL_DCT_h
+
+/// \file pcl/DCT.h
+
+#include <pcl/Defs.h>
+
+#include <pcl/Matrix.h>
+#include <pcl/ParallelProcess.h>
+#include <pcl/StatusMonitor.h>
+#include <pcl/Vector.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+class DCTBase
+{
+protected:
+
+   /*
+    * Transform kinds: 0...3 = DCT-I...DCT-IV, 4...7 = DST-I...DST-IV.
+    */
+   static int   OptimizedLength( int, int kind );
+
+   static void* Create( int, int kind, float* );
+   static void* Create( int, int kind, double* );
+
+   static void  Destroy( void* );
+
+   static void  Transform( void*, float*, const float* );
+   static void  Transform( void*, double*, const double* );
+
+   static void  Transform( int, int, float*, const float*, int kind, StatusMonitor*, bool, int );
+   static void  Transform( int, int, double*, const double*, int kind, StatusMonitor*, bool, int );
+
+   static double Scale( int, int kind );
+   static int    InverseKind( int kind );
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class AbstractDCT
+ * \brief Abstract base class of all one-dimensional discrete cosine and sine
+ * transform classes
+ *
+ * The %AbstractDCT template class implements basic properties and functions
+ * shared by the GenericDCT and GenericDST classes.
+ *
+ * All real-to-real transforms are computed in O(n*log(n)) time with the same
+ * FFT routines used by the GenericFFT and GenericRealFFT classes. As happens
+ * with our Fourier transforms, discrete cosine and sine transforms are not
+ * normalized: performing a transform followed by its inverse transform (see
+ * InverseType()) multiplies the input data by the value returned by Scale().
+ *
+ * The definitions used for the eight transforms of length \e n are:
+ *
+ * <pre>
+ * DCT-I   : y[k] = x[0] + (-1)^k*x[n-1] + 2*Sum( x[j]*cos(pi*j*k/(n-1)) ), j=1,...,n-2
+ * DCT-II  : y[k] = 2*Sum( x[j]*cos(pi*(j+1/2)*k/n) ), j=0,...,n-1
+ * DCT-III : y[k] = x[0] + 2*Sum( x[j]*cos(pi*j*(k+1/2)/n) ), j=1,...,n-1
+ * DCT-IV  : y[k] = 2*Sum( x[j]*cos(pi*(j+1/2)*(k+1/2)/n) ), j=0,...,n-1
+ * DST-I   : y[k] = 2*Sum( x[j]*sin(pi*(j+1)*(k+1)/(n+1)) ), j=0,...,n-1
+ * DST-II  : y[k] = 2*Sum( x[j]*sin(pi*(j+1/2)*(k+1)/n) ), j=0,...,n-1
+ * DST-III : y[k] = (-1)^k*x[n-1] + 2*Sum( x[j]*sin(pi*(j+1)*(k+1/2)/n) ), j=0,...,n-2
+ * DST-IV  : y[k] = 2*Sum( x[j]*sin(pi*(j+1/2)*(k+1/2)/n) ), j=0,...,n-1
+ * </pre>
+ *
+ * for k = 0,...,n-1. These are the conventions followed by most numerical
+ * libraries, so results can be compared directly with other implementations.
+ *
+ * \sa GenericDCT, GenericDST, AbstractDCT2D
+ */
+template <typename T>
+class PCL_CLASS AbstractDCT : public DCTBase
+{
+public:
+
+   /*!
+    * Represents a scalar in the context of this transform class.
+    */
+   typedef T                        scalar;
+
+   /*!
+    * Represents a vector of real numbers.
+    */
+   typedef GenericVector<scalar>    vector;
+
+   /*!
+    * Constructs an %AbstractDCT object of the specified \a length and
+    * transform \a kind (0 to 7: DCT-I to DCT-IV, then DST-I to DST-IV).
+    */
+   AbstractDCT( int length, int kind ) : m_length( length ), m_kind( kind )
+   {
+      PCL_PRECONDITION( kind >= 0 && kind < 8 )
+   }
+
+   /*!
+    * Copy constructor. This constructor is disabled because transform objects
+    * own internal control structures that cannot be shared.
+    */
+   AbstractDCT( const AbstractDCT& ) = delete;
+
+   /*!
+    * Copy assignment. This operator is disabled because transform objects
+    * own internal control structures that cannot be shared.
+    */
+   AbstractDCT& operator =( const AbstractDCT& ) = delete;
+
+   /*!
+    * Virtual destructor. Destroys all internal control structures in this
+    * %AbstractDCT object.
+    */
+   virtual ~AbstractDCT()
+   {
+      Release();
+   }
+
+   /*!
+    * Returns the length of this transform, or the number of data items that
+    * can be transformed.
+    */
+   int Length() const
+   {
+      return m_length;
+   }
+
+   /*!
+    * Returns the type of this transform: 1, 2, 3 or 4 for types I, II, III and
+    * IV, respectively.
+    */
+   int Type() const
+   {
+      return m_kind%4 + 1;
+   }
+
+   /*!
+    * Returns the type of the inverse of this transform: 2 for type III, 3 for
+    * type II, and the same type otherwise.
+    */
+   int InverseType() const
+   {
+      return this->InverseKind( m_kind )%4 + 1;
+   }
+
+   /*!
+    * Returns the factor by which the input data are multiplied when this
+    * transform is followed by its inverse transform. This is 2*(n - 1) for
+    * DCT-I, 2*(n + 1) for DST-I, and 2*n for the rest of transforms, where n
+    * is the transform length.
+    */
+   double Scale() const
+   {
+      return DCTBase::Scale( m_length, m_kind );
+   }
+
+   /*!
+    * Performs this transform of an input vector of real values, and stores
+    * the result in a caller-supplied output vector.
+    *
+    * \param[out] y  Output vector. Must be the starting address of a
+    *                contiguous sequence of at least Length() real numbers.
+    *
+    * \param[in] x   Input vector. Must be the starting address of a contiguous
+    *                sequence of at least Length() real numbers.
+    *
+    * In-place transforms are supported: \a y and \a x can be the same address.
+    *
+    * This member function is not thread-safe: the same object cannot be used
+    * to perform transforms concurrently from several threads.
+    */
+   void operator()( scalar* y, const scalar* x ) const
+   {
+      if ( m_handle == nullptr )
+         m_handle = this->Create( m_length, m_kind, static_cast<scalar*>( nullptr ) );
+      this->Transform( m_handle, y, x );
+   }
+
+   /*!
+    * Returns this transform of a vector of real values. The specified vector
+    * \a x must have at least Length() elements. Otherwise an Error exception
+    * will be thrown.
+    */
+   vector operator()( const vector& x ) const
+   {
+      PCL_PRECONDITION( x.Length() >= m_length )
+      if ( x.Length() < m_length )
+         throw Error( "Invalid DCT/DST input vector length." );
+      vector y( m_length );
+      operator()( *y, *x );
+      return y;
+   }
+
+   /*!
+    * Destroys all internal control structures in this object.
+    */
+   virtual void Release()
+   {
+      if ( m_handle != nullptr )
+         this->Destroy( m_handle ), m_handle = nullptr;
+   }
+
+protected:
+
+           int   m_length;
+           int   m_kind;
+   mutable void* m_handle = nullptr; // Opaque pointer to internal control structures
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class GenericDCT
+ * \brief Generic discrete cosine transform of real data
+ *
+ * The %GenericDCT template class computes one-dimensional discrete cosine
+ * transforms of types I to IV. See the AbstractDCT class for transform
+ * definitions.
+ *
+ * \sa AbstractDCT, GenericDST, GenericDCT2D
+ */
+template <typename T>
+class PCL_CLASS GenericDCT : public AbstractDCT<T>
+{
+public:
+
+   /*!
+    * Identifies the base class of this transform class.
+    */
+   typedef AbstractDCT<T>        base;
+
+   /*!
+    * Represents a scalar in the context of this transform class.
+    */
+   typedef typename base::scalar scalar;
+
+   /*!
+    * Represents a vector of real numbers.
+    */
+   typedef typename base::vector vector;
+
+   /*!
+    * Constructs a %GenericDCT object of the specified length \a n and
+    * transform \a type (1, 2, 3 or 4). The default type is DCT-II.
+    *
+    * Transforms of arbitrary lengths are supported (n >= 2 for type I), but
+    * the underlying routines are much faster for lengths returned by
+    * GenericDCT::OptimizedLength().
+    */
+   GenericDCT( int n, int type = 2 ) : base( n, Range( type, 1, 4 ) - 1 )
+   {
+      PCL_PRECONDITION( type >= 1 && type <= 4 )
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~GenericDCT()
+   {
+   }
+
+   /*!
+    * Returns the smallest optimized length larger than or equal to \a n for a
+    * discrete cosine transform of the specified \a type.
+    */
+   static int OptimizedLength( int n, int type = 2 )
+   {
+      return DCTBase::OptimizedLength( n, Range( type, 1, 4 ) - 1 );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class GenericDST
+ * \brief Generic discrete sine transform of real data
+ *
+ * The %GenericDST template class computes one-dimensional discrete sine
+ * transforms of types I to IV. See the AbstractDCT class for transform
+ * definitions.
+ *
+ * \sa AbstractDCT, GenericDCT, GenericDST2D
+ */
+template <typename T>
+class PCL_CLASS GenericDST : public AbstractDCT<T>
+{
+public:
+
+   /*!
+    * Identifies the base class of this transform class.
+    */
+   typedef AbstractDCT<T>        base;
+
+   /*!
+    * Represents a scalar in the context of this transform class.
+    */
+   typedef typename base::scalar scalar;
+
+   /*!
+    * Represents a vector of real numbers.
+    */
+   typedef typename base::vector vector;
+
+   /*!
+    * Constructs a %GenericDST object of the specified length \a n and
+    * transform \a type (1, 2, 3 or 4). The default type is DST-II.
+    *
+    * Transforms of arbitrary lengths are supported, but the underlying
+    * routines are much faster for lengths returned by
+    * GenericDST::OptimizedLength().
+    */
+   GenericDST( int n, int type = 2 ) : base( n, Range( type, 1, 4 ) + 3 )
+   {
+      PCL_PRECONDITION( type >= 1 && type <= 4 )
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~GenericDST()
+   {
+   }
+
+   /*!
+    * Returns the smallest optimized length larger than or equal to \a n for a
+    * discrete sine transform of the specified \a type.
+    */
+   static int OptimizedLength( int n, int type = 2 )
+   {
+      return DCTBase::OptimizedLength( n, Range( type, 1, 4 ) + 3 );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class AbstractDCT2D
+ * \brief Abstract base class of all two-dimensional discrete cosine and sine
+ * transform classes
+ *
+ * A two-dimensional transform applies the corresponding one-dimensional
+ * transform to all rows of a matrix, then to all columns of the result. Rows
+ * and columns are transformed in parallel with multiple threads. Transform
+ * definitions and normalization are the same as for AbstractDCT; the scaling
+ * factor of a transform followed by its inverse is the product of the factors
+ * of both dimensions.
+ *
+ * \sa GenericDCT2D, GenericDST2D, AbstractDCT
+ */
+template <typename T>
+class PCL_CLASS AbstractDCT2D : public DCTBase, public ParallelProcess
+{
+public:
+
+   /*!
+    * Represents a scalar in the context of this transform class.
+    */
+   typedef T                        scalar;
+
+   /*!
+    * Represents a real matrix.
+    */
+   typedef GenericMatrix<scalar>    matrix;
+
+   /*!
+    * Constructs an %AbstractDCT2D object of the specified dimensions and
+    * transform \a kind (0 to 7: DCT-I to DCT-IV, then DST-I to DST-IV).
+    */
+   AbstractDCT2D( int rows, int cols, int kind ) :
+      m_rows( rows ), m_cols( cols ), m_kind( kind )
+   {
+      PCL_PRECONDITION( kind >= 0 && kind < 8 )
+   }
+
+   /*!
+    * Constructs an %AbstractDCT2D object of the specified dimensions and
+    * transform \a kind, using the specified status \a monitor object.
+    *
+    * On each transform performed with this object, the status monitor will be
+    * incremented by the sum of transform dimensions: \a rows + \a cols.
+    */
+   AbstractDCT2D( int rows, int cols, int kind, StatusMonitor& monitor ) :
+      m_rows( rows ), m_cols( cols ), m_kind( kind ), m_monitor( &monitor )
+   {
+      PCL_PRECONDITION( kind >= 0 && kind < 8 )
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~AbstractDCT2D()
+   {
+   }
+
+   /*!
+    * Returns the number of rows in the 2-D transform of this object.
+    */
+   int Rows() const
+   {
+      return m_rows;
+   }
+
+   /*!
+    * Returns the number of columns in the 2-D transform of this object.
+    */
+   int Cols() const
+   {
+      return m_cols;
+   }
+
+   /*!
+    * Returns the total number of matrix elements in the 2-D data set of this
+    * object, or Rows() multiplied by Cols().
+    */
+   int NumberOfElements() const
+   {
+      return m_rows*m_cols;
+   }
+
+   /*!
+    * Returns the type of this transform: 1, 2, 3 or 4 for types I, II, III and
+    * IV, respectively.
+    */
+   int Type() const
+   {
+      return m_kind%4 + 1;
+   }
+
+   /*!
+    * Returns the type of the inverse of this transform: 2 for type III, 3 for
+    * type II, and the same type otherwise.
+    */
+   int InverseType() const
+   {
+      return this->InverseKind( m_kind )%4 + 1;
+   }
+
+   /*!
+    * Returns the factor by which the input data are multiplied when this
+    * transform is followed by its inverse transform.
+    */
+   double Scale() const
+   {
+      return DCTBase::Scale( m_rows, m_kind )*DCTBase::Scale( m_cols, m_kind );
+   }
+
+   /*!
+    * Performs the two-dimensional transform of an input matrix of real
+    * numbers, and stores the result in an output matrix.
+    *
+    * \param[out] y  Output matrix. Must be the starting address of a
+    *                contiguous sequence of at least NumberOfElements() real
+    *                numbers. The result will be stored in row order.
+    *
+    * \param[in] x   Input matrix. Must be the starting address of a contiguous
+    *                sequence of at least NumberOfElements() real numbers,
+    *                stored in row order: all elements of the first row
+    *                followed by all elements of the second row, and so on.
+    *
+    * In-place transforms are supported: \a y and \a x can be the same address.
+    */
+   void operator()( scalar* y, const scalar* x ) const
+   {
+      this->Transform( m_rows, m_cols, y, x, m_kind, m_monitor, m_parallel, m_maxProcessors );
+   }
+
+   /*!
+    * Returns the two-dimensional transform of a matrix of real numbers. The
+    * specified matrix \a x must have Rows() and Cols() dimensions. Otherwise
+    * an Error exception will be thrown.
+    */
+   matrix operator()( const matrix& x ) const
+   {
+      PCL_PRECONDITION( x.Rows() == m_rows )
+      PCL_PRECONDITION( x.Cols() == m_cols )
+      if ( x.Rows() != m_rows || x.Cols() != m_cols )
+         throw Error( "Invalid DCT/DST input matrix dimensions." );
+      matrix y( m_rows, m_cols );
+      operator()( *y, *x );
+      return y;
+   }
+
+private:
+
+   int            m_rows;
+   int            m_cols;
+   int            m_kind;
+   StatusMonitor* m_monitor = nullptr;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class GenericDCT2D
+ * \brief Generic two-dimensional discrete cosine transform of real data
+ *
+ * \sa AbstractDCT2D, GenericDST2D, GenericDCT
+ */
+template <typename T>
+class PCL_CLASS GenericDCT2D : public AbstractDCT2D<T>
+{
+public:
+
+   /*!
+    * Identifies the base class of this transform class.
+    */
+   typedef AbstractDCT2D<T>      base;
+
+   /*!
+    * Represents a scalar in the context of this transform class.
+    */
+   typedef typename base::scalar scalar;
+
+   /*!
+    * Represents a real matrix.
+    */
+   typedef typename base::matrix matrix;
+
+   /*!
+    * Constructs a %GenericDCT2D object of the specified dimensions \a rows and
+    * \a cols, and transform \a type (1, 2, 3 or 4). The default type is
+    * DCT-II. For best performance, use dimensions returned by
+    * GenericDCT2D::OptimizedLength().
+    */
+   GenericDCT2D( int rows, int cols, int type = 2 ) :
+      base( rows, cols, Range( type, 1, 4 ) - 1 )
+   {
+   }
+
+   /*!
+    * Constructs a %GenericDCT2D object of the specified dimensions and
+    * transform \a type, using the specified status \a monitor object.
+    */
+   GenericDCT2D( int rows, int cols, int type, StatusMonitor& monitor ) :
+      base( rows, cols, Range( type, 1, 4 ) - 1, monitor )
+   {
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~GenericDCT2D()
+   {
+   }
+
+   /*!
+    * Returns the smallest optimized length larger than or equal to \a n for a
+    * discrete cosine transform of the specified \a type. The optimized length
+    * can be used for the \a rows and \a cols constructor arguments.
+    */
+   static int OptimizedLength( int n, int type = 2 )
+   {
+      return DCTBase::OptimizedLength( n, Range( type, 1, 4 ) - 1 );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class GenericDST2D
+ * \brief Generic two-dimensional discrete sine transform of real data
+ *
+ * \sa AbstractDCT2D, GenericDCT2D, GenericDST
+ */
+template <typename T>
+class PCL_CLASS GenericDST2D : public AbstractDCT2D<T>
+{
+public:
+
+   /*!
+    * Identifies the base class of this transform class.
+    */
+   typedef AbstractDCT2D<T>      base;
+
+   /*!
+    * Represents a scalar in the context of this transform class.
+    */
+   typedef typename base::scalar scalar;
+
+   /*!
+    * Represents a real matrix.
+    */
+   typedef typename base::matrix matrix;
+
+   /*!
+    * Constructs a %GenericDST2D object of the specified dimensions \a rows and
+    * \a cols, and transform \a type (1, 2, 3 or 4). The default type is
+    * DST-II. For best performance, use dimensions returned by
+    * GenericDST2D::OptimizedLength().
+    */
+   GenericDST2D( int rows, int cols, int type = 2 ) :
+      base( rows, cols, Range( type, 1, 4 ) + 3 )
+   {
+   }
+
+   /*!
+    * Constructs a %GenericDST2D object of the specified dimensions and
+    * transform \a type, using the specified status \a monitor object.
+    */
+   GenericDST2D( int rows, int cols, int type, StatusMonitor& monitor ) :
+      base( rows, cols, Range( type, 1, 4 ) + 3, monitor )
+   {
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~GenericDST2D()
+   {
+   }
+
+   /*!
+    * Returns the smallest optimized length larger than or equal to \a n for a
+    * discrete sine transform of the specified \a type. The optimized length
+    * can be used for the \a rows and \a cols constructor arguments.
+    */
+   static int OptimizedLength( int n, int type = 2 )
+   {
+      return DCTBase::OptimizedLength( n, Range( type, 1, 4 ) + 3 );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \defgroup dct_dst Discrete Cosine and Sine Transforms
+ */
+
+#ifndef __PCL_NO_DCT_INSTANTIATE
+
+/*!
+ * \class pcl::FDCT
+ * \ingroup dct_dst
+ * \brief Discrete cosine transform of 32-bit floating point real data.
+ */
+typedef GenericDCT<float>     FDCT;
+
+/*!
+ * \class pcl::DDCT
+ * \ingroup dct_dst
+ * \brief Discrete cosine transform of 64-bit floating point real data.
+ */
+typedef GenericDCT<double>    DDCT;
+
+/*!
+ * \class pcl::DCT
+ * \ingroup dct_dst
+ * \brief Discrete cosine transform of 32-bit floating point real data.
+ *
+ * %DCT is an alias for FDCT.
+ */
+typedef FDCT                  DCT;
+
+/*!
+ * \class pcl::FDST
+ * \ingroup dct_dst
+ * \brief Discrete sine transform of 32-bit floating point real data.
+ */
+typedef GenericDST<float>     FDST;
+
+/*!
+ * \class pcl::DDST
+ * \ingroup dct_dst
+ * \brief Discrete sine transform of 64-bit floating point real data.
+ */
+typedef GenericDST<double>    DDST;
+
+/*!
+ * \class pcl::DST
+ * \ingroup dct_dst
+ * \brief Discrete sine transform of 32-bit floating point real data.
+ *
+ * %DST is an alias for FDST.
+ */
+typedef FDST                  DST;
+
+/*!
+ * \class pcl::FDCT2D
+ * \ingroup dct_dst
+ * \brief Two-dimensional discrete cosine transform of 32-bit floating point
+ * real data.
+ */
+typedef GenericDCT2D<float>   FDCT2D;
+
+/*!
+ * \class pcl::DDCT2D
+ * \ingroup dct_dst
+ * \brief Two-dimensional discrete cosine transform of 64-bit floating point
+ * real data.
+ */
+typedef GenericDCT2D<double>  DDCT2D;
+
+/*!
+ * \class pcl::DCT2D
+ * \ingroup dct_dst
+ * \brief Two-dimensional discrete cosine transform of 32-bit floating point
+ * real data.
+ *
+ * %DCT2D is an alias for FDCT2D.
+ */
+typedef FDCT2D                DCT2D;
+
+/*!
+ * \class pcl::FDST2D
+ * \ingroup dct_dst
+ * \brief Two-dimensional discrete sine transform of 32-bit floating point
+ * real data.
+ */
+typedef GenericDST2D<float>   FDST2D;
+
+/*!
+ * \class pcl::DDST2D
+ * \ingroup dct_dst
+ * \brief Two-dimensional discrete sine transform of 64-bit floating point
+ * real data.
+ */
+typedef GenericDST2D<double>  DDST2D;
+
+/*!
+ * \class pcl::DST2D
+ * \ingroup dct_dst
+ * \brief Two-dimensional discrete sine transform of 32-bit floating point
+ * real data.
+ *
+ * %DST2D is an alias for FDST2D.
+ */
+typedef FDST2D                DST2D;
+
+#endif // __PCL_NO_DCT_INSTANTIATE
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __PCL_DCT_h
+
+// ----------------------------------------------------------------------------
+// EOF pcl/DCT.h - Released 2019-01-21T12:06:07Z
@@ -67,6 +67,8 @@ namespace pcl
 
 class PCL_CLASS XMLDocument;
 class PCL_CLASS XMLElement;
+class PCL_CLASS BinaryContainerReader;
+class PCL_CLASS BinaryContainerWriter;
 
 /*!
  * \class DrizzleData
@@ -759,10 +761,12 @@ public:
     *
     * \param filePath   Path to an existing file that will be parsed. The file
     *                   contents can be in %XML drizzle data format (normally,
-    *                   a file with the .xdrz suffix), or in old plain text
-    *                   format (typically with the .drz suffix). This function
-    *                   will detect the format in use from the first bytes read
-    *                   from the file, and will decode it correspondingly.
+    *                   a file with the .xdrz suffix), in binary drizzle data
+    *                   format (see SerializeToBinaryFile()), or in old plain
+    *                   text format (typically with the .drz suffix). This
+    *                   function will detect the format in use from the first
+    *                   bytes read from the file, and will decode it
+    *                   correspondingly.
     *
     * \param ignoreIntegrationData  If true, all drizzle data relative to the
     *                   image integration task will be ignored. This includes
@@ -872,6 +876,25 @@ public:
     */
    void SerializeToFile( const String& path ) const;
 
+   /*!
+    * Serializes the drizzle integration data transported by this object as a
+    * new binary data container file. The file will be newly created at the
+    * specified file \a path.
+    *
+    * The binary drizzle data format stores the same data as the .xdrz format,
+    * but alignment matrices, surface spline nodes and coefficients, image
+    * integration vectors and pixel rejection maps are written as raw arrays
+    * aligned to 64-byte boundaries. Binary drizzle data files are mapped into
+    * memory by Parse( const String& ), which is much faster than decoding
+    * %XML documents, especially for large pixel rejection maps. Conversion
+    * between both formats is lossless. See BinaryContainerWriter for a
+    * description of the container file format.
+    *
+    * \warning If a file already exists at the specified \a path, its previous
+    * contents will be lost after calling this function.
+    */
+   void SerializeToBinaryFile( const String& path ) const;
+
 private:
 
            String         m_sourceFilePath;
@@ -904,8 +927,23 @@ private:
    void SerializeRejectionMap( XMLElement* ) const;
 
    static void ParseSpline( spline&, const XMLElement& );
+   static void ValidateSpline( const spline& );
    static void SerializeSpline( XMLElement*, const spline& );
 
+   static void DecodeBinarySpline( spline&, const BinaryContainerReader&, const IsoString& prefix );
+   static void EncodeBinarySpline( BinaryContainerWriter&, const spline&, const IsoString& prefix, Vector& parameters );
+
+   void ValidateSerializableData() const;
+   void ValidateParsedData( bool ignoreIntegrationData );
+   void DecodeBinary( const BinaryContainerReader&, bool ignoreIntegrationData );
+
+   /*!
+    * \internal
+    * \class DrizzleData::XMLDecoder
+    * \brief Event-driven parser of XDRZ files
+    */
+   class XMLDecoder;
+
    /*!
     * \internal
     * \class DrizzleData::PlainTextDecoder
@@ -0,0 +1,474 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/FileDataCache.h - Released 2019-01-21T12:06:07Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#ifndef __PCL_FileDataCache_h
+#define __PCL_FileDataCache_h
+
+/// \file pcl/FileDataCache.h
+
+#include <pcl/Defs.h>
+
+#include <pcl/ByteArray.h>
+#include <pcl/File.h>
+#include <pcl/ReadWriteMutex.h>
+#include <pcl/ReferenceSortedArray.h>
+#include <pcl/SortedArray.h>
+#include <pcl/StringList.h>
+#include <pcl/Vector.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class FileDataCacheItem
+ * \brief An element of a file data cache
+ *
+ * %FileDataCacheItem associates a set of data with an existing file. The data
+ * remain valid as long as the file is not modified. A file is identified by
+ * its full path, and its contents by its modification time, size and a 64-bit
+ * content fingerprint, which allows cached data to be reused when a file is
+ * renamed or moved.
+ *
+ * Derived classes store specific data and implement the protected virtual
+ * functions of this class to copy, serialize, deserialize and validate them.
+ *
+ * \sa FileDataCache
+ */
+class PCL_CLASS FileDataCacheItem
+{
+public:
+
+   String     path;            //!< Full path to the cached file.
+   unsigned   lastUsed = 0;    //!< Date of last usage, JD.0
+   FileTime   time;            //!< Cached file time.
+   fsize_type size = 0;        //!< Cached file size in bytes.
+   uint64     fingerprint = 0; //!< Cached file content fingerprint.
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~FileDataCacheItem()
+   {
+   }
+
+   /*!
+    * Assigns the file identification members of another item to this object.
+    * Cached data are not copied by this function; see AssignData().
+    */
+   void Assign( const FileDataCacheItem& i )
+   {
+      path        = i.path;
+      lastUsed    = i.lastUsed;
+      time        = i.time;
+      size        = i.size;
+      fingerprint = i.fingerprint;
+   }
+
+   /*!
+    * Returns true iff this item corresponds to the same file as another item.
+    */
+   bool operator ==( const FileDataCacheItem& i ) const
+   {
+      return path == i.path;
+   }
+
+   /*!
+    * Returns true iff the file path of this item precedes the file path of
+    * another item.
+    */
+   bool operator <( const FileDataCacheItem& i ) const
+   {
+      return path < i.path;
+   }
+
+   /*!
+    * Returns true iff the cached file time precedes the specified file time.
+    * Differences of less than one second are ignored.
+    */
+   bool ModifiedSince( FileTime t ) const
+   {
+      if ( time.year != t.year )
+         return time.year < t.year;
+      if ( time.month != t.month )
+         return time.month < t.month;
+      if ( time.day != t.day )
+         return time.day < t.day;
+      if ( time.hour != t.hour )
+         return time.hour < t.hour;
+      if ( time.minute != t.minute )
+         return time.minute < t.minute;
+      if ( time.second != t.second )
+         return time.second < t.second;
+#if 0
+      /*
+       * File time milliseconds are available on Windows, but they are
+       * unreliable and generate wrong cache invalidations.
+       */
+      if ( time.milliseconds != t.milliseconds )
+         return time.milliseconds < t.milliseconds;
+#endif
+      return false;
+   }
+
+   /*!
+    * Returns the number of days elapsed since this item was last used.
+    */
+   unsigned DaysSinceLastUsed() const;
+
+   /*!
+    * Returns a 64-bit fingerprint of the contents of the specified file. The
+    * fingerprint is computed from the file size and a fixed set of sampled
+    * blocks, so its cost does not depend on the size of the file.
+    */
+   static uint64 Fingerprint( const String& path, fsize_type size );
+
+protected:
+
+   /*!
+    * Copies the cached data of another item to this object. The default
+    * implementation does nothing.
+    */
+   virtual void AssignData( const FileDataCacheItem& )
+   {
+   }
+
+   /*!
+    * Returns a string serialization of the cached data in this item. The
+    * default implementation returns an empty string.
+    */
+   virtual String DataAsString() const
+   {
+      return String();
+   }
+
+   /*!
+    * Loads cached data from a list of string tokens, as generated by
+    * DataAsString(). Returns true iff the data could be loaded. The default
+    * implementation returns true.
+    */
+   virtual bool GetDataFromTokens( const StringList& )
+   {
+      return true;
+   }
+
+   /*!
+    * Returns true iff the cached data in this item are valid. The default
+    * implementation returns true.
+    */
+   virtual bool ValidateData() const
+   {
+      return true;
+   }
+
+   /*!
+    * Utility function that returns a string serialization of a vector,
+    * suitable to be loaded with GetVector().
+    */
+   static String VectorAsString( const DVector& );
+
+   /*!
+    * Utility function that loads a vector serialized by VectorAsString() from
+    * a list of string tokens, starting at the specified iterator \a i, which
+    * is advanced past the loaded components. Returns true iff the vector
+    * could be loaded.
+    */
+   static bool GetVector( DVector&, StringList::const_iterator& i, const StringList& );
+
+   /*!
+    * Constructs an item for the specified file \a path. Mainly used to search
+    * for items in a cache.
+    */
+   FileDataCacheItem( const String& p = String() ) : path( p )
+   {
+   }
+
+   /*!
+    * Copy constructor.
+    */
+   FileDataCacheItem( const FileDataCacheItem& item )
+   {
+      (void)operator =( item );
+   }
+
+private:
+
+   mutable bool modified = false; // not yet written to the persistent log
+
+   bool FromString( const String& s );
+
+   bool Load( const IsoString& keyPrefix, int index );
+
+   void Serialize( ByteArray& ) const;
+   bool Deserialize( const uint8* data, size_type length );
+
+   friend class FileDataCache;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class FileDataCache
+ * \brief A persistent, thread-safe cache of file data
+ *
+ * %FileDataCache stores FileDataCacheItem objects associated with existing
+ * files. Cache items are stored persistently in a binary log file, where
+ * modified and removed items are appended incrementally, so saving a cache
+ * does not require rewriting all of its items. Items that have not been used
+ * for a specified number of days are removed automatically.
+ *
+ * Derived classes must reimplement the NewItem() pure virtual function to
+ * create items of the appropriate type.
+ *
+ * \sa FileDataCacheItem
+ */
+class PCL_CLASS FileDataCache
+{
+public:
+
+   /*!
+    * Constructs a new file data cache.
+    *
+    * \param key     The settings key used to store the cache persistently. It
+    *                also identifies the file where cache items are stored.
+    *
+    * \param days    The maximum number of days an item can remain unused in
+    *                the cache. If zero or negative, cache items never expire.
+    */
+   FileDataCache( const IsoString& key, int days = 30 ) :
+      m_cache(),
+      m_fingerprints(),
+      m_keyPrefix( key.Trimmed() ),
+      m_durationDays( Max( 0, days ) ),
+      m_enabled( true )
+   {
+      PCL_PRECONDITION( !m_keyPrefix.IsEmpty() )
+      if ( m_keyPrefix.IsEmpty() )
+         throw Error( "FileDataCache: Invalid key" );
+      if ( !m_keyPrefix.StartsWith( '/' ) )
+         m_keyPrefix.Prepend( '/' );
+      if ( !m_keyPrefix.EndsWith( '/' ) )
+         m_keyPrefix.Append( '/' );
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~FileDataCache()
+   {
+      Clear();
+   }
+
+   /*!
+    * Returns the name of this cache.
+    */
+   virtual String CacheName() const
+   {
+      return "File Cache";
+   }
+
+   /*!
+    * Returns true iff this cache is enabled.
+    */
+   bool IsEnabled() const
+   {
+      return m_enabled;
+   }
+
+   /*!
+    * Enables or disables this cache.
+    */
+   void Enable( bool enable )
+   {
+      m_enabled = enable;
+   }
+
+   /*!
+    * Returns the maximum number of days an item can remain unused in this
+    * cache, or zero if cache items never expire.
+    */
+   int Duration() const
+   {
+      return m_durationDays;
+   }
+
+   /*!
+    * Sets the maximum number of days an item can remain unused in this cache.
+    * If zero or negative, cache items never expire.
+    */
+   void SetDuration( int days )
+   {
+      m_durationDays = Max( 0, days );
+   }
+
+   /*!
+    * Returns true iff the items in this cache never expire.
+    */
+   bool NeverExpires() const
+   {
+      return m_durationDays <= 0;
+   }
+
+   /*!
+    * Returns the number of items in this cache.
+    */
+   size_type NumberOfItems() const
+   {
+      return m_cache.Length();
+   }
+
+   /*!
+    * Returns true iff this cache is empty. This function is thread-safe.
+    */
+   bool IsEmpty() const;
+
+   /*!
+    * Returns a pointer to the cache item for the specified file \a path, or
+    * nullptr if no such item exists. This function is thread-safe.
+    */
+   const FileDataCacheItem* Find( const String& path ) const;
+
+   /*!
+    * Removes all items in this cache. This function is thread-safe.
+    */
+   void Clear();
+
+   /*!
+    * Adds a new item to this cache, or updates an existing item for the same
+    * file. This function is thread-safe.
+    */
+   void Add( const FileDataCacheItem& );
+
+   /*!
+    * Retrieves the cached data for the specified file \a path. If valid cached
+    * data exist, copies them to \a item and returns true. Cached data for a
+    * file with the same contents but a different path are also retrieved.
+    * This function is thread-safe.
+    */
+   bool Get( FileDataCacheItem& item, const String& path );
+
+   /*!
+    * Loads this cache from persistent storage.
+    */
+   virtual void Load();
+
+   /*!
+    * Writes the new and modified items in this cache to persistent storage.
+    */
+   virtual void Save() const;
+
+   /*!
+    * Removes all persistent storage associated with this cache.
+    */
+   virtual void Purge() const;
+
+   /*!
+    * Returns the full path to the binary file where cache items are stored
+    * persistently.
+    */
+   String CacheFilePath() const;
+
+protected:
+
+   /*!
+    * Returns a new cache item of the appropriate type. Must be reimplemented
+    * by derived classes.
+    */
+   virtual FileDataCacheItem* NewItem() const = 0;
+
+private:
+
+   struct FingerprintIndexItem
+   {
+      uint64                   fingerprint;
+      const FileDataCacheItem* item;
+
+      bool operator ==( const FingerprintIndexItem& x ) const
+      {
+         return fingerprint == x.fingerprint && item == x.item;
+      }
+
+      bool operator <( const FingerprintIndexItem& x ) const
+      {
+         return (fingerprint != x.fingerprint) ? fingerprint < x.fingerprint : item < x.item;
+      }
+   };
+
+   typedef ReferenceSortedArray<FileDataCacheItem> cache_index;
+   typedef SortedArray<FingerprintIndexItem>       fingerprint_index;
+
+   mutable ReadWriteMutex    m_mutex;
+           cache_index       m_cache;
+           fingerprint_index m_fingerprints;
+           IsoString         m_keyPrefix;
+           int               m_durationDays; // <= 0 -> never expires
+           bool              m_enabled;
+   mutable StringList        m_removed;          // removals not yet written to the persistent log
+   mutable size_type         m_logRecords = 0;   // number of records in the persistent log
+   mutable bool              m_rewrite = false;  // the persistent log must be rewritten
+
+   FileDataCacheItem* AddItem( const String& path );
+   void DestroyItem( cache_index::const_iterator );
+   void DestroyItems();
+   void LoadSettingsItems();
+   void PurgeSettings() const;
+   void WriteLog( bool compact ) const;
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __PCL_FileDataCache_h
+
+// ----------------------------------------------------------------------------
+// EOF pcl/FileDataCache.h - Released 2019-01-21T12:06:07Z
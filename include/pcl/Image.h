@@ -63,6 +63,7 @@
 #include <pcl/Compression.h>
 #include <pcl/File.h>
 #include <pcl/Mutex.h>
+#include <pcl/ParallelSelection.h>
 #include <pcl/PixelAllocator.h>
 #include <pcl/PixelTraits.h>
 #include <pcl/ReferenceArray.h>
@@ -11636,6 +11637,9 @@ public:
     * high and low medians is statistically irrelevant (modulo special cases
     * that are irrelevant for practical matters).
     *
+    * The median is computed in parallel without copying pixel samples; see
+    * ParallelSampleSelection.
+    *
     * \note Increments the status monitoring object by the number of selected
     * pixel samples.
     */
@@ -11650,54 +11654,128 @@ public:
       if ( m_status.IsInitializationEnabled() )
          m_status.Initialize( "Computing median sample value", N );
 
-      int numberOfThreads = this->NumberOfThreadsForRows( r.Height(), r.Width(), maxProcessors );
-      int rowsPerThread = r.Height()/numberOfThreads;
-      bool useAffinity = m_parallel && Thread::IsRootThread();
-
-      ReferenceArray<SmpThread> threads;
-      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
-         threads.Add( new SmpThread( *this, r, firstChannel, lastChannel,
-                                     i*rowsPerThread,
-                                     (j < numberOfThreads) ? j*rowsPerThread : r.Height() ) );
-      if ( numberOfThreads > 1 )
+      selection S = Selection( r, firstChannel, lastChannel, maxProcessors );
+      size_type n = S.Count();
+      double m = 0;
+      if ( n >= 2 )
       {
-         int n = 0;
-         for ( SmpThread& thread : threads )
-            thread.Start( ThreadPriority::DefaultMax, useAffinity ? n++ : -1 );
-         for ( SmpThread& thread : threads )
-            thread.Wait();
-      }
-      else
-         threads[0].Run();
-
-      Array<sample> samples;
-      for ( SmpThread& thread : threads )
-         if ( !thread.samples.IsEmpty() )
+         size_type n2 = n >> 1;
+         if ( n < 0x10000 && (n & 1) == 0 )
          {
-            samples.Add( thread.samples.Begin(), thread.samples.At( thread.n ) );
-            thread.samples.Clear();
+            double m1;
+            m = S.OrderStatistic( n2, &m1 );
+            m = (m + m1)/2;
          }
+         else
+            m = S.OrderStatistic( n2 );
+      }
 
-      threads.Destroy();
+      m_status += N;
 
-      size_type n = samples.Length();
-      if ( n < 2 )
+      return m;
+   }
+
+   /*!
+    * Returns an order statistic of a subset of pixel samples.
+    *
+    * \param k      Normalized rank of the order statistic in the [0,1] range.
+    *                The order statistic of rank RoundInt( k*(n - 1) ) will be
+    *                returned, where n is the number of selected samples. For
+    *                example, k=0.5 yields the high median, and k=0.25 and
+    *                k=0.75 yield the first and third quartiles, respectively.
+    *
+    * \param maxProcessors    If a value greater than zero is specified, it is
+    *          the maximum number of concurrent threads that this function can
+    *          execute. If zero or a negative value is specified, the current
+    *          thread limit for this image will be used instead (see
+    *          AbstractImage::SetMaxProcessors()). The default value is zero.
+    *
+    * For information on the rest of parameters of this member function, see
+    * the documentation for Fill().
+    *
+    * This member function returns the order statistic in the normalized range
+    * [0,1], irrespective of the sample data type of the image. For
+    * complex-valued images, this function works on the magnitudes of the
+    * selected samples. If range clipping is enabled for this image, only pixel
+    * samples within the current clipping range will be taken into account.
+    *
+    * Order statistics are computed in parallel without copying pixel samples,
+    * by successive refinement of radix histograms; see
+    * ParallelSampleSelection.
+    *
+    * \note Increments the status monitoring object by the number of selected
+    * pixel samples.
+    */
+   double OrderStatistic( double k, const Rect& rect = Rect( 0 ), int firstChannel = -1, int lastChannel = -1,
+                          int maxProcessors = 0 ) const
+   {
+      PCL_PRECONDITION( 0 <= k && k <= 1 )
+
+      Rect r = rect;
+      if ( !ParseSelection( r, firstChannel, lastChannel ) )
          return 0;
 
-      size_type n2 = n >> 1;
-      double m;
-      P::FromSample( m, *pcl::Select( samples.Begin(), samples.End(), n2 ) );
-      if ( n < 0x10000 )
-         if ( (n & 1) == 0 )
-         {
-            double m1;
-            P::FromSample( m1, *pcl::Select( samples.Begin(), samples.End(), n2-1 ) );
-            m = (m + m1)/2;
-         }
+      size_type N = size_type( r.Width() )*size_type( r.Height() )*(1 + lastChannel - firstChannel);
+      if ( m_status.IsInitializationEnabled() )
+         m_status.Initialize( "Computing order statistic", N );
+
+      selection S = Selection( r, firstChannel, lastChannel, maxProcessors );
+      size_type n = S.Count();
+      double x = 0;
+      if ( n > 0 )
+         x = S.OrderStatistic( size_type( pcl::Range( k, 0.0, 1.0 )*(n - 1) + 0.5 ) );
 
       m_status += N;
 
-      return m;
+      return x;
+   }
+
+   /*!
+    * Returns the two-sided trimmed mean of a subset of pixel samples.
+    *
+    * \param l      Fraction of the lowest selected samples that will be
+    *                excluded from the calculation, in the [0,0.5) range. The
+    *                default value is 0.2.
+    *
+    * \param h      Fraction of the highest selected samples that will be
+    *                excluded from the calculation, in the [0,0.5) range. The
+    *                default value is 0.2.
+    *
+    * \param maxProcessors    If a value greater than zero is specified, it is
+    *          the maximum number of concurrent threads that this function can
+    *          execute. If zero or a negative value is specified, the current
+    *          thread limit for this image will be used instead (see
+    *          AbstractImage::SetMaxProcessors()). The default value is zero.
+    *
+    * For information on the rest of parameters of this member function, see
+    * the documentation for Fill().
+    *
+    * This member function returns the trimmed mean in the normalized range
+    * [0,1], irrespective of the sample data type of the image. For
+    * complex-valued images, this function works on the magnitudes of the
+    * selected samples. If range clipping is enabled for this image, only pixel
+    * samples within the current clipping range will be taken into account.
+    *
+    * \note Increments the status monitoring object by the number of selected
+    * pixel samples.
+    */
+   double TrimmedMean( double l = 0.2, double h = 0.2,
+                       const Rect& rect = Rect( 0 ), int firstChannel = -1, int lastChannel = -1,
+                       int maxProcessors = 0 ) const
+   {
+      Rect r = rect;
+      if ( !ParseSelection( r, firstChannel, lastChannel ) )
+         return 0;
+
+      size_type N = size_type( r.Width() )*size_type( r.Height() )*(1 + lastChannel - firstChannel);
+      if ( m_status.IsInitializationEnabled() )
+         m_status.Initialize( "Computing trimmed mean", N );
+
+      double t = Selection( r, firstChannel, lastChannel, maxProcessors ).TrimmedMean( l, h );
+
+      m_status += N;
+
+      return t;
    }
 
    /*!
@@ -11972,6 +12050,9 @@ public:
     * between a high median and the mean of the high and low medians is
     * statistically irrelevant.
     *
+    * The MAD is computed in parallel without copying pixel samples or
+    * deviations; see ParallelSampleSelection.
+    *
     * \note To make the MAD estimator consistent with the standard deviation of
     * a normal distribution, it must be multiplied by the constant 1.4826.
     *
@@ -11989,47 +12070,21 @@ public:
       if ( m_status.IsInitializationEnabled() )
          m_status.Initialize( "Computing median absolute deviation", N );
 
-      int numberOfThreads = this->NumberOfThreadsForRows( r.Height(), r.Width(), maxProcessors );
-      int rowsPerThread = r.Height()/numberOfThreads;
-      bool useAffinity = m_parallel && Thread::IsRootThread();
-
-      ReferenceArray<SmpAbsDevThread> threads;
-      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
-         threads.Add( new SmpAbsDevThread( *this, center, r, firstChannel, lastChannel,
-                                           i*rowsPerThread,
-                                           (j < numberOfThreads) ? j*rowsPerThread : r.Height() ) );
-      if ( numberOfThreads > 1 )
-      {
-         int n = 0;
-         for ( SmpAbsDevThread& thread : threads )
-            thread.Start( ThreadPriority::DefaultMax, useAffinity ? ++n : -1 );
-         for ( SmpAbsDevThread& thread : threads )
-            thread.Wait();
-      }
-      else
-         threads[0].Run();
-
-      Array<double> devs;
-      for ( SmpAbsDevThread& thread : threads )
-         if ( !thread.devs.IsEmpty() )
-         {
-            devs.Add( thread.devs.Begin(), thread.devs.At( thread.n ) );
-            thread.devs.Clear();
-         }
-
-      threads.Destroy();
+      selection S = Selection( r, firstChannel, lastChannel, maxProcessors );
+      S.SetCenter( center );
+      size_type n = S.Count();
 
       m_status += N;
 
-      size_type n = devs.Length();
       if ( n < 2 )
          return 0;
 
       size_type n2 = n >> 1;
       if ( n & 1 || n > 0xffff )
-         return *pcl::Select( devs.Begin(), devs.End(), n2 );
-      return (*pcl::Select( devs.Begin(), devs.End(), n2 )
-            + *pcl::Select( devs.Begin(), devs.End(), n2-1 ))/2;
+         return S.OrderStatistic( n2 );
+      double d1;
+      double d = S.OrderStatistic( n2, &d1 );
+      return (d + d1)/2;
    }
 
    /*!
@@ -15098,29 +15153,41 @@ private:
 
    // -------------------------------------------------------------------------
 
-   class SmpThread : public RectThreadBase
+   /*
+    * Sample filter for parallel selection of order statistics, honoring the
+    * current range clipping state of the image.
+    */
+   struct SelectionFilter
    {
-   public:
+      bool   clip = false;
+      sample clipLow = 0;
+      sample clipHigh = 0;
 
-      Array<sample> samples;
-      size_type n;
-
-      SmpThread( const GenericImage& image, const Rect& rect, int ch1, int ch2, int firstRow, int endRow ) :
-         RectThreadBase( image, rect, ch1, ch2, firstRow, endRow ), samples(), n( 0 )
+      bool operator()( const sample& v ) const
       {
-         size_type N = size_type(  this->m_rect.Width() )
-                     * size_type( this->m_endRow - this->m_firstRow )
-                     * (1 + this->m_ch2 - this->m_ch1);
-         samples = Array<sample>( N );
+         return !clip || (v > clipLow && v < clipHigh);
       }
+   };
 
-   private:
+   typedef ParallelSampleSelection<P, SelectionFilter>   selection;
 
-      void Perform( const sample* f ) override
+   selection Selection( const Rect& r, int firstChannel, int lastChannel, int maxProcessors ) const
+   {
+      SelectionFilter filter;
+      if ( this->IsRangeClippingEnabled() )
       {
-         samples[n++] = *f;
+         filter.clip = true;
+         filter.clipLow = P::ToSample( this->RangeClipLow() );
+         filter.clipHigh = P::ToSample( this->RangeClipHigh() );
       }
-   };
+
+      Array<const sample*> channels;
+      for ( int c = firstChannel; c <= lastChannel; ++c )
+         channels << m_pixelData[c];
+
+      return selection( channels, m_width, r, filter,
+                        this->NumberOfThreadsForRows( r.Height(), r.Width(), maxProcessors ) );
+   }
 
    // -------------------------------------------------------------------------
 
@@ -15151,35 +15218,6 @@ private:
 
    // -------------------------------------------------------------------------
 
-   class SmpAbsDevThread : public RectThreadBase
-   {
-   public:
-
-      Array<double> devs;
-      size_type n;
-
-      SmpAbsDevThread( const GenericImage& image, double center, const Rect& rect, int ch1, int ch2, int firstRow, int endRow ) :
-         RectThreadBase( image, rect, ch1, ch2, firstRow, endRow ), devs(), n( 0 ), m_center( center )
-      {
-         size_type N = size_type(  this->m_rect.Width() )
-                     * size_type( this->m_endRow - this->m_firstRow )
-                     * (1 + this->m_ch2 - this->m_ch1);
-         devs = Array<double>( N );
-      }
-
-   private:
-
-      double m_center;
-
-      void Perform( const sample* f ) override
-      {
-         double v; P::FromSample( v, *f );
-         devs[n++] = pcl::Abs( v - m_center );
-      }
-   };
-
-   // -------------------------------------------------------------------------
-
    class SumAbsDevThread : public SumThread
    {
    public:
@@ -58,6 +58,7 @@
 #include <pcl/Diagnostics.h>
 
 #include <pcl/GeometricTransformation.h>
+#include <pcl/ParallelProcess.h>
 
 namespace pcl
 {
@@ -94,7 +95,8 @@ namespace IntegerDownsampleMode
  *
  * ### TODO: Write a detailed description for %IntegerResample.
  */
-class PCL_CLASS IntegerResample : public GeometricTransformation
+class PCL_CLASS IntegerResample : public GeometricTransformation,
+                                  public ParallelProcess
 {
 public:
 
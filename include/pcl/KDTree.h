@@ -57,8 +57,16 @@
 #include <pcl/Defs.h>
 
 #include <pcl/Array.h>
+#include <pcl/ParallelProcess.h>
+#include <pcl/ReferenceArray.h>
+#include <pcl/Selection.h>
+#include <pcl/Sort.h>
+#include <pcl/Thread.h>
 #include <pcl/Vector.h>
 
+#include <float.h> // DBL_MAX
+#include <limits>
+
 namespace pcl
 {
 
@@ -71,10 +79,28 @@ namespace pcl
  * An n-dimensional K-d tree is a specialized binary tree for partitioning of
  * a set of points in an n-dimensional space. K-d trees have important
  * applications in computational geometry problems requiring efficient
- * rectangular range searching.
+ * rectangular range searching and nearest neighbor queries.
  *
  * This class implements a <em>bucket point region K-d tree</em> structure
- * (see Reference 2).
+ * (see Reference 2) with a flat memory layout. Tree nodes are stored in a
+ * single contiguous array in depth-first order, where the left child of a node
+ * immediately follows its parent. Points are reordered during the build so
+ * that the points of each leaf node (or bucket) occupy a contiguous range of
+ * indices, and point coordinates are stored as a structure of arrays: all
+ * coordinates on the first axis, then all coordinates on the second axis, and
+ * so on. This layout minimizes cache misses during tree traversals and allows
+ * for vectorized distance computations in leaf nodes.
+ *
+ * Each internal node splits its points at the median coordinate on the axis
+ * of largest spread, so the tree is always balanced, even for point sets with
+ * duplicate or degenerate coordinates. Trees are built in O(n*log(n)) time,
+ * using multiple threads for large point sets.
+ *
+ * Besides the traditional rectangular range search operation (Search()),
+ * this class implements k-nearest neighbor (NearestNeighbors()) and
+ * Euclidean radius (RadiusSearch()) queries, including batched versions for
+ * parallel execution of multiple queries. All search member functions are
+ * thread-safe and can be called concurrently for the same %KDTree object.
  *
  * The template type argument T represents the type of a \e point object stored
  * in a %KDTree structure. The type T must have the following properties:
@@ -96,15 +122,6 @@ namespace pcl
  * stored in the K-d tree, such that 0 <= i < N, where N > 0 is the dimension
  * of the point space.
  *
- * \note We use this implementation of K-d trees in some essential PixInsight
- * tools with success (e.g., StarAlignment), and hopefully it will be also
- * useful for you, but we don't claim it to be complete. This is a practical
- * and relatively simple implementation, where only the construction,
- * destruction and range search operations are available. In particular, this
- * implementation does not include point addition, deletion and iteration
- * operations. Future versions of PCL will include more complete
- * implementations of this fundamental data structure.
- *
  * \b References
  *
  * \li 1. Mark de Berg et al., <em>Computational Geometry: Algorithms and
@@ -113,10 +130,14 @@ namespace pcl
  * \li 2. Hanan Samet, <em>Foundations of Multidimensional and Metric Data
  * Structures,</em> Morgan Kaufmann, 2006, Section 1.5.
  *
+ * \li 3. Jerome H. Friedman, Jon L. Bentley, Raphael A. Finkel, <em>An
+ * Algorithm for Finding Best Matches in Logarithmic Expected Time,</em> ACM
+ * Transactions on Mathematical Software, Vol. 3, No. 3, 1977, pp. 209-226.
+ *
  * \sa QuadTree
  */
 template <class T>
-class PCL_CLASS KDTree
+class PCL_CLASS KDTree : public ParallelProcess
 {
 public:
 
@@ -141,13 +162,15 @@ public:
     */
    typedef Array<point>                point_list;
 
+   /*!
+    * A list of point lists. Used for batched search operations.
+    */
+   typedef Array<point_list>           point_list_array;
+
    /*!
     * Constructs an empty K-d tree.
     */
-   KDTree() :
-      m_root( nullptr ), m_dimension( 0 ), m_bucketCapacity( 0 ), m_length( 0 )
-   {
-   }
+   KDTree() = default;
 
    /*!
     * Constructs a K-d tree and builds it for the specified list of \a points.
@@ -167,8 +190,7 @@ public:
     * empty K-d tree. If the dimension of the point space is less than one, an
     * Error exception is thrown.
     */
-   KDTree( const point_list& points, int bucketCapacity = 16 ) :
-      m_root( nullptr ), m_dimension( 0 ), m_bucketCapacity( 0 ), m_length( 0 )
+   KDTree( const point_list& points, int bucketCapacity = 16 )
    {
       Build( points, bucketCapacity );
    }
@@ -192,35 +214,49 @@ public:
     * empty K-d tree. If the dimension of the point space is less than one, an
     * Error exception is thrown.
     */
-   KDTree( const point_list& points, int dimension, int bucketCapacity ) :
-      m_root( nullptr ), m_dimension( 0 ), m_bucketCapacity( 0 ), m_length( 0 )
+   KDTree( const point_list& points, int dimension, int bucketCapacity )
    {
       Build( points, dimension, bucketCapacity );
    }
 
+   /*!
+    * Copy constructor.
+    */
+   KDTree( const KDTree& ) = default;
+
    /*!
     * Move constructor.
     */
    KDTree( KDTree&& x ) :
-      m_root( x.m_root ), m_dimension( x.m_dimension ),
-      m_bucketCapacity( x.m_bucketCapacity ), m_length( x.m_length )
+      ParallelProcess( x ),
+      m_dimension( x.m_dimension ),
+      m_bucketCapacity( x.m_bucketCapacity )
    {
-      x.m_root = nullptr;
-      x.m_length = 0;
+      pcl::Swap( m_nodes, x.m_nodes );
+      pcl::Swap( m_points, x.m_points );
+      pcl::Swap( m_coordinates, x.m_coordinates );
    }
 
+   /*!
+    * Copy assignment operator. Returns a reference to this object.
+    */
+   KDTree& operator =( const KDTree& ) = default;
+
    /*!
     * Move assignment operator. Returns a reference to this object.
     */
    KDTree& operator =( KDTree&& x )
    {
-      DestroyTree( m_root );
-      m_root = x.m_root;
-      m_dimension = x.m_dimension;
-      m_bucketCapacity = x.m_bucketCapacity;
-      m_length = x.m_length;
-      x.m_root = nullptr;
-      x.m_length = 0;
+      if ( &x != this )
+      {
+         ParallelProcess::operator =( x );
+         pcl::Swap( m_nodes, x.m_nodes );
+         pcl::Swap( m_points, x.m_points );
+         pcl::Swap( m_coordinates, x.m_coordinates );
+         m_dimension = x.m_dimension;
+         m_bucketCapacity = x.m_bucketCapacity;
+         x.Clear();
+      }
       return *this;
    }
 
@@ -229,7 +265,6 @@ public:
     */
    ~KDTree()
    {
-      Clear();
    }
 
    /*!
@@ -237,9 +272,9 @@ public:
     */
    void Clear()
    {
-      DestroyTree( m_root );
-      m_root = nullptr;
-      m_length = 0;
+      m_nodes.Clear();
+      m_points.Clear();
+      m_coordinates.Clear();
    }
 
    /*!
@@ -266,14 +301,8 @@ public:
    void Build( const point_list& points, int bucketCapacity = 16 )
    {
       Clear();
-      m_bucketCapacity = Max( 1, bucketCapacity );
       if ( !points.IsEmpty() )
-      {
-         m_dimension = points[0].Length();
-         if ( m_dimension < 1 )
-            throw Error( "Invalid point space dimension in KDTree::Build()" );
-         m_root = BuildTree( points, 0 );
-      }
+         Build( points, points[0].Length(), bucketCapacity );
    }
 
    /*!
@@ -304,7 +333,90 @@ public:
       m_bucketCapacity = Max( 1, bucketCapacity );
       if ( (m_dimension = dimension) < 1 )
          throw Error( "Invalid point space dimension in KDTree::Build()" );
-      m_root = BuildTree( points, 0 );
+      if ( points.Length() > size_type( uint32_max ) )
+         throw Error( "Too many points in KDTree::Build()" );
+      if ( points.IsEmpty() )
+         return;
+
+      uint32 n = uint32( points.Length() );
+
+      /*
+       * Structure-of-arrays coordinates in input order.
+       */
+      Array<double> coordinates( size_type( n )*m_dimension );
+      for ( uint32 i = 0; i < n; ++i )
+      {
+         const point& p = points[i];
+         for ( int d = 0; d < m_dimension; ++d )
+            coordinates[d*size_type( n ) + i] = double( p[d] );
+      }
+
+      /*
+       * Median splits yield a tree shape that depends only on the number of
+       * points, so the node array can be allocated in advance and independent
+       * subtrees can be built concurrently.
+       */
+      m_nodes = node_list( NumberOfNodes( n ) );
+      Array<uint32> index( n );
+      for ( uint32 i = 0; i < n; ++i )
+         index[i] = i;
+
+      BuildContext context( *this, coordinates.Begin(), index.Begin(), n );
+
+      int numberOfThreads = m_parallel ? Min( m_maxProcessors, Thread::NumberOfThreads( n, 4096 ) ) : 1;
+      if ( numberOfThreads > 1 )
+      {
+         /*
+          * Build the top levels of the tree serially, until we have enough
+          * independent subtrees to feed all threads.
+          */
+         Array<BuildTask> tasks;
+         tasks << BuildTask{ 0, 0, n };
+         while ( tasks.Length() < size_type( 4*numberOfThreads ) )
+         {
+            Array<BuildTask> next;
+            bool split = false;
+            for ( const BuildTask& t : tasks )
+               if ( t.end - t.begin > uint32( m_bucketCapacity ) )
+               {
+                  uint32 right = BuildNode( context, t.node, t.begin, t.end );
+                  uint32 middle = t.begin + ((t.end - t.begin) >> 1);
+                  next << BuildTask{ t.node+1, t.begin, middle } << BuildTask{ right, middle, t.end };
+                  split = true;
+               }
+               else
+                  next << t;
+            tasks = next;
+            if ( !split )
+               break;
+         }
+
+         bool useAffinity = Thread::IsRootThread();
+         ReferenceArray<BuildThread> threads;
+         for ( int i = 0; i < numberOfThreads; ++i )
+            threads << new BuildThread( context, tasks, i, numberOfThreads );
+         int k = 0;
+         for ( BuildThread& thread : threads )
+            thread.Start( ThreadPriority::DefaultMax, useAffinity ? k++ : -1 );
+         for ( BuildThread& thread : threads )
+            thread.Wait();
+         threads.Destroy();
+      }
+      else
+         BuildTree( context, 0, 0, n );
+
+      /*
+       * Store points and coordinates in tree order, so that each leaf node
+       * owns a contiguous range of both.
+       */
+      m_points = point_list( size_type( n ) );
+      m_coordinates = Array<double>( coordinates.Length() );
+      for ( uint32 i = 0; i < n; ++i )
+      {
+         m_points[i] = points[index[i]];
+         for ( int d = 0; d < m_dimension; ++d )
+            m_coordinates[d*size_type( n ) + i] = coordinates[d*size_type( n ) + index[i]];
+      }
    }
 
    /*!
@@ -330,15 +442,12 @@ public:
     */
    point_list Search( const point& pt, component epsilon ) const
    {
-      component_vector p0( m_dimension );
-      component_vector p1( m_dimension );
-      for ( int i = 0; i < m_dimension; ++i )
-      {
-         p0[i] = pt[i] - epsilon;
-         p1[i] = pt[i] + epsilon;
-      }
       point_list found;
-      SearchTree( found, p0, p1, m_root, 0 );
+      Search( pt, epsilon,
+              []( const point& p, void* data )
+              {
+                 reinterpret_cast<point_list*>( data )->Add( p );
+              }, &found );
       return found;
    }
 
@@ -375,14 +484,185 @@ public:
    template <class F>
    void Search( const point& pt, component epsilon, F callback, void* data ) const
    {
-      component_vector p0( m_dimension );
-      component_vector p1( m_dimension );
+      if ( m_nodes.IsEmpty() )
+         return;
+
+      GenericVector<double> p0( m_dimension );
+      GenericVector<double> p1( m_dimension );
       for ( int i = 0; i < m_dimension; ++i )
       {
-         p0[i] = pt[i] - epsilon;
-         p1[i] = pt[i] + epsilon;
+         p0[i] = double( component( pt[i] - epsilon ) );
+         p1[i] = double( component( pt[i] + epsilon ) );
+      }
+
+      const size_type n = m_points.Length();
+      uint32 stack[ MaxDepth ];
+      int top = 0;
+      stack[top++] = 0;
+      while ( top > 0 )
+      {
+         const Node& node = m_nodes[stack[--top]];
+         if ( node.IsLeaf() )
+         {
+            for ( uint32 i = node.begin; i < node.end; ++i )
+               for ( int j = 0; ; )
+               {
+                  double x = m_coordinates[j*n + i];
+                  if ( x < p0[j] || p1[j] < x )
+                     break;
+                  if ( ++j == m_dimension )
+                  {
+                     callback( m_points[i], data );
+                     break;
+                  }
+               }
+         }
+         else
+         {
+            uint32 self = uint32( &node - m_nodes.Begin() );
+            if ( p1[node.axis] >= node.split )
+               stack[top++] = node.right;
+            if ( p0[node.axis] <= node.split )
+               stack[top++] = self + 1;
+         }
+      }
+   }
+
+   /*!
+    * Finds the \a k nearest neighbors of a point.
+    *
+    * \param pt         Reference to the point being searched for.
+    *
+    * \param k          Maximum number of neighbors to find. Must be > 0.
+    *
+    * \param distances  If non-null, the address of a vector where the
+    *                   Euclidean distances from \a pt to the found points will
+    *                   be stored.
+    *
+    * \param maxDistance   Maximum Euclidean distance from \a pt to a found
+    *                   point. The default value is unlimited distance.
+    *
+    * Returns a list with the min(k,Length()) points nearest to \a pt (or less,
+    * if \a maxDistance is specified), sorted by increasing Euclidean
+    * distance. Ties are resolved in an unspecified order.
+    */
+   point_list NearestNeighbors( const point& pt, int k, GenericVector<double>* distances = nullptr,
+                                double maxDistance = DBL_MAX ) const
+   {
+      Array<uint32> found;
+      Array<double> dist2;
+      FindNearestNeighbors( found, dist2, pt, k, maxDistance );
+      point_list neighbors;
+      neighbors.Reserve( found.Length() );
+      for ( uint32 i : found )
+         neighbors << m_points[i];
+      if ( distances != nullptr )
+      {
+         *distances = GenericVector<double>( int( dist2.Length() ) );
+         for ( int i = 0; i < distances->Length(); ++i )
+            (*distances)[i] = Sqrt( dist2[i] );
+      }
+      return neighbors;
+   }
+
+   /*!
+    * Returns the nearest neighbor of a point. If \a distance is non-null, the
+    * Euclidean distance from \a pt to the found point is stored in the
+    * variable pointed to by \a distance.
+    *
+    * If this K-d tree is empty, or if no distance from \a pt to a point in
+    * the tree can be computed (for example, because \a pt has NaN
+    * coordinates), this function throws an Error exception.
+    */
+   point NearestNeighbor( const point& pt, double* distance = nullptr ) const
+   {
+      if ( m_nodes.IsEmpty() )
+         throw Error( "KDTree::NearestNeighbor(): Empty tree." );
+      Array<uint32> found;
+      Array<double> dist2;
+      FindNearestNeighbors( found, dist2, pt, 1, DBL_MAX );
+      if ( found.IsEmpty() )
+         throw Error( "KDTree::NearestNeighbor(): Invalid search point." );
+      if ( distance != nullptr )
+         *distance = Sqrt( dist2[0] );
+      return m_points[found[0]];
+   }
+
+   /*!
+    * Performs a batched k-nearest neighbor search. Returns a list with the
+    * result of NearestNeighbors( queries[i], k, nullptr, maxDistance ) for
+    * each point in the specified list of \a queries. Queries are performed
+    * in parallel with multiple threads, if parallel processing is enabled for
+    * this object.
+    */
+   point_list_array NearestNeighbors( const point_list& queries, int k, double maxDistance = DBL_MAX ) const
+   {
+      point_list_array results( queries.Length() );
+      RunQueries( queries,
+                  [&]( size_type i )
+                  {
+                     results[i] = NearestNeighbors( queries[i], k, nullptr, maxDistance );
+                  } );
+      return results;
+   }
+
+   /*!
+    * Performs a Euclidean range search.
+    *
+    * \param pt         Reference to the point being searched for.
+    *
+    * \param radius     Search radius. Must be >= 0.
+    *
+    * \param distances  If non-null, the address of a vector where the
+    *                   Euclidean distances from \a pt to the found points will
+    *                   be stored.
+    *
+    * Returns a list with all points in the tree at Euclidean distances less
+    * than or equal to \a radius from \a pt, sorted by increasing distance.
+    */
+   point_list RadiusSearch( const point& pt, double radius, GenericVector<double>* distances = nullptr ) const
+   {
+      Array<uint32> found;
+      Array<double> dist2;
+      FindInRadius( found, dist2, pt, radius );
+
+      /*
+       * Sort found points by increasing distance.
+       */
+      Array<uint32> order( found.Length() );
+      for ( size_type i = 0; i < order.Length(); ++i )
+         order[i] = uint32( i );
+      pcl::Sort( order.Begin(), order.End(),
+                 [&dist2]( uint32 a, uint32 b ) { return dist2[a] < dist2[b]; } );
+
+      point_list neighbors;
+      neighbors.Reserve( found.Length() );
+      for ( uint32 i : order )
+         neighbors << m_points[found[i]];
+      if ( distances != nullptr )
+      {
+         *distances = GenericVector<double>( int( order.Length() ) );
+         for ( int i = 0; i < distances->Length(); ++i )
+            (*distances)[i] = Sqrt( dist2[order[i]] );
       }
-      SearchTree( p0, p1, callback, data, m_root, 0 );
+      return neighbors;
+   }
+
+   /*!
+    * Performs a batched Euclidean range search. Returns a list with the
+    * result of RadiusSearch( queries[i], radius ) for each point in the
+    * specified list of \a queries. Queries are performed in parallel with
+    * multiple threads, if parallel processing is enabled for this object.
+    */
+   point_list_array RadiusSearch( const point_list& queries, double radius ) const
+   {
+      point_list_array results( queries.Length() );
+      RunQueries( queries,
+                  [&]( size_type i )
+                  {
+                     results[i] = RadiusSearch( queries[i], radius );
+                  } );
+      return results;
    }
 
    /*!
@@ -399,15 +679,25 @@ public:
     */
    size_type Length() const
    {
-      return m_length;
+      return m_points.Length();
    }
 
    /*!
     * Returns true iff this K-d tree is empty.
     */
-   bool IsEmpty()
+   bool IsEmpty() const
    {
-      return m_root == nullptr;
+      return m_points.IsEmpty();
+   }
+
+   /*!
+    * Returns a reference to the immutable list of points stored in this K-d
+    * tree. Points are stored in tree order, which in general is different
+    * from the order of the list used to build the tree.
+    */
+   const point_list& Points() const
+   {
+      return m_points;
    }
 
    /*!
@@ -415,165 +705,372 @@ public:
     */
    friend void Swap( KDTree& x1, KDTree& x2 )
    {
-      pcl::Swap( x1.m_root,           x2.m_root );
+      x1.ParallelProcess::Swap( x2 );
+      pcl::Swap( x1.m_nodes,          x2.m_nodes );
+      pcl::Swap( x1.m_points,         x2.m_points );
+      pcl::Swap( x1.m_coordinates,    x2.m_coordinates );
       pcl::Swap( x1.m_dimension,      x2.m_dimension );
       pcl::Swap( x1.m_bucketCapacity, x2.m_bucketCapacity );
-      pcl::Swap( x1.m_length,         x2.m_length );
    }
 
 private:
 
+   /*
+    * Tree nodes are stored in depth-first order. The left child of an internal
+    * node is the next node in the array.
+    */
    struct Node
    {
       double split;  // position of this node's splitting hyperplane
-      Node*  left;   // child points at coordinates <= split
-      Node*  right;  // child points at coordinates > split
-
-      Node( double s = 0 ) : split( s ), left( nullptr ), right( nullptr )
-      {
-      }
+      uint32 right;  // index of the right child node, or zero for leaf nodes
+      uint32 begin;  // first point of this node
+      uint32 end;    // end of the points of this node
+      int32  axis;   // splitting axis: left points <= split <= right points
 
       bool IsLeaf() const
       {
-         return left == nullptr && right == nullptr;
+         return right == 0;
       }
    };
 
-   struct LeafNode : public Node
+   typedef Array<Node> node_list;
+
+   /*
+    * The maximum tree depth is bounded by the number of bits in a point index.
+    */
+   enum { MaxDepth = 64 };
+
+   /*
+    * Squared distance limit for nearest neighbor and radius searches. Large
+    * distances, such as the default DBL_MAX limit, would overflow when
+    * squared; they mean an unbounded search, where squared point distances
+    * that overflow to infinity must still be accepted.
+    */
+   static double SquaredDistance( double d )
+   {
+      return (d < 1.0e+150) ? d*d : std::numeric_limits<double>::infinity();
+   }
+
+   node_list     m_nodes;
+   point_list    m_points;            // points in tree order
+   Array<double> m_coordinates;       // point coordinates in tree order, SoA
+   int           m_dimension = 0;
+   int           m_bucketCapacity = 16;
+
+   uint32 NumberOfNodes( uint32 n ) const
    {
-      point_list points;
+      if ( n <= uint32( m_bucketCapacity ) )
+         return 1;
+      uint32 h = n >> 1;
+      return 1 + NumberOfNodes( h ) + NumberOfNodes( n - h );
+   }
 
-      LeafNode( const point_list& p ) : Node(), points( p )
+   struct BuildTask
+   {
+      uint32 node, begin, end;
+   };
+
+   struct BuildContext
+   {
+      KDTree&       tree;
+      const double* coordinates;
+      uint32*       index;
+      uint32        length;
+
+      BuildContext( KDTree& t, const double* c, uint32* i, uint32 n ) :
+         tree( t ), coordinates( c ), index( i ), length( n )
       {
       }
    };
 
-   Node*     m_root;
-   int       m_dimension;
-   int       m_bucketCapacity;
-   size_type m_length;
-
-   Node* BuildTree( const point_list& points, int depth )
+   /*
+    * Builds the internal node at the specified index for the point range
+    * [begin,end), partitioning the point index array. Returns the index of the
+    * right child node.
+    */
+   uint32 BuildNode( BuildContext& context, uint32 nodeIndex, uint32 begin, uint32 end )
    {
-      if ( points.IsEmpty() )
-         return nullptr;
+      const size_type n = context.length;
+      uint32* index = context.index;
 
-      if ( points.Length() <= size_type( m_bucketCapacity ) )
+      int axis = 0;
+      double maxSpread = -1;
+      for ( int d = 0; d < m_dimension; ++d )
       {
-         m_length += points.Length();
-         return new LeafNode( points );
+         const double* c = context.coordinates + d*n;
+         double cmin = c[index[begin]], cmax = cmin;
+         for ( uint32 i = begin+1; i < end; ++i )
+         {
+            double x = c[index[i]];
+            if ( x < cmin )
+               cmin = x;
+            else if ( x > cmax )
+               cmax = x;
+         }
+         if ( cmax - cmin > maxSpread )
+         {
+            maxSpread = cmax - cmin;
+            axis = d;
+         }
       }
 
-      int index = depth % m_dimension;
-
-      Node* node = new Node( SplitValue( points, index ) );
+      const double* c = context.coordinates + axis*n;
+      uint32 middle = begin + ((end - begin) >> 1);
+      pcl::Select( index + begin, index + end, distance_type( middle - begin ),
+                   [c]( uint32 a, uint32 b ) { return c[a] < c[b]; } );
 
-      point_list left, right;
-      for ( const point& p : points )
-         if ( p[index] <= node->split )
-            left.Add( p );
-         else
-            right.Add( p );
+      Node& node = m_nodes[nodeIndex];
+      node.split = c[index[middle]];
+      node.right = nodeIndex + 1 + NumberOfNodes( middle - begin );
+      node.begin = begin;
+      node.end = end;
+      node.axis = axis;
+      return node.right;
+   }
 
-      // If we are about to build a degenerate subtree, abort this branch of
-      // recursion right now.
-      if ( left.IsEmpty() || right.IsEmpty() )
+   void BuildTree( BuildContext& context, uint32 nodeIndex, uint32 begin, uint32 end )
+   {
+      if ( end - begin <= uint32( m_bucketCapacity ) )
       {
-         delete node;
-         return nullptr;
+         Node& node = m_nodes[nodeIndex];
+         node.split = 0;
+         node.right = 0;
+         node.begin = begin;
+         node.end = end;
+         node.axis = 0;
+         return;
       }
 
-      node->left  = BuildTree( left, depth+1 );
-      node->right = BuildTree( right, depth+1 );
+      uint32 right = BuildNode( context, nodeIndex, begin, end );
+      uint32 middle = begin + ((end - begin) >> 1);
+      BuildTree( context, nodeIndex+1, begin, middle );
+      BuildTree( context, right, middle, end );
+   }
+
+   class BuildThread : public Thread
+   {
+   public:
+
+      BuildThread( BuildContext& context, const Array<BuildTask>& tasks, int first, int step ) :
+         m_context( context ), m_tasks( tasks ), m_first( first ), m_step( step )
+      {
+      }
 
-      // Don't propagate degeneracies.
-      if ( node->IsLeaf() )
+      void Run() override
       {
-         delete node;
-         return nullptr;
+         for ( size_type i = m_first; i < m_tasks.Length(); i += m_step )
+         {
+            const BuildTask& t = m_tasks[i];
+            m_context.tree.BuildTree( m_context, t.node, t.begin, t.end );
+         }
       }
 
-      return node;
-   }
+   private:
 
-   void SearchTree( point_list& found, const component_vector& p0, const component_vector& p1, const Node* node, int depth ) const
+            BuildContext&     m_context;
+      const Array<BuildTask>& m_tasks;
+            int               m_first;
+            int               m_step;
+   };
+
+   void FindNearestNeighbors( Array<uint32>& found, Array<double>& dist2, const point& pt, int k, double maxDistance ) const
    {
-      if ( node != nullptr )
-         if ( node->IsLeaf() )
+      found.Clear();
+      dist2.Clear();
+      if ( m_nodes.IsEmpty() || k < 1 )
+         return;
+
+      GenericVector<double> q( m_dimension );
+      for ( int d = 0; d < m_dimension; ++d )
+         q[d] = double( pt[d] );
+
+      /*
+       * Bounded list of the best candidates found so far, sorted by increasing
+       * squared distance.
+       */
+      k = int( Min( size_type( k ), m_points.Length() ) );
+      found.Reserve( k );
+      dist2.Reserve( k );
+      double worst = SquaredDistance( maxDistance );
+
+      const size_type n = m_points.Length();
+      GenericVector<double> d2( m_bucketCapacity );
+
+      struct Item
+      {
+         uint32 node;
+         double bound; // squared distance from q to the splitting hyperplane
+      };
+      Item stack[ MaxDepth ];
+      int top = 0;
+      stack[top++] = Item{ 0, 0.0 };
+      while ( top > 0 )
+      {
+         const Item item = stack[--top];
+         if ( item.bound > worst )
+            continue;
+
+         const Node& node = m_nodes[item.node];
+         if ( node.IsLeaf() )
          {
-            const LeafNode* leaf = static_cast<const LeafNode*>( node );
-            for ( const point& p : leaf->points )
-               for ( int j = 0; ; )
-               {
-                  component x = p[j];
-                  if ( x < p0[j] || p1[j] < x )
-                     break;
-                  if ( ++j == m_dimension )
+            uint32 m = node.end - node.begin;
+            LeafDistances( *d2, q, node.begin, m, n );
+            for ( uint32 i = 0; i < m; ++i )
+               if ( d2[i] <= worst )
+                  if ( found.Length() < size_type( k ) || d2[i] < dist2[k-1] )
                   {
-                     found.Add( p );
-                     break;
+                     /*
+                      * Insertion into the sorted list of candidates.
+                      */
+                     size_type j = found.Length();
+                     if ( j == size_type( k ) )
+                        --j;
+                     else
+                     {
+                        found.Add( 0 );
+                        dist2.Add( 0.0 );
+                     }
+                     for ( ; j > 0 && dist2[j-1] > d2[i]; --j )
+                     {
+                        found[j] = found[j-1];
+                        dist2[j] = dist2[j-1];
+                     }
+                     found[j] = node.begin + i;
+                     dist2[j] = d2[i];
+                     if ( found.Length() == size_type( k ) )
+                        worst = Min( worst, dist2[k-1] );
                   }
-               }
          }
          else
          {
-            int index = depth % m_dimension;
-            if ( p0[index] <= node->split )
-               SearchTree( found, p0, p1, node->left, depth+1 );
-            if ( p1[index] > node->split )
-               SearchTree( found, p0, p1, node->right, depth+1 );
+            /*
+             * Visit the near child first: push it last.
+             */
+            double delta = q[node.axis] - node.split;
+            double farBound = Max( item.bound, delta*delta );
+            if ( delta <= 0 )
+            {
+               stack[top++] = Item{ node.right, farBound };
+               stack[top++] = Item{ item.node+1, item.bound };
+            }
+            else
+            {
+               stack[top++] = Item{ item.node+1, farBound };
+               stack[top++] = Item{ node.right, item.bound };
+            }
          }
+      }
    }
 
-   template <class F>
-   void SearchTree( const component_vector& p0, const component_vector& p1, F callback, void* data, const Node* node, int depth ) const
+   void FindInRadius( Array<uint32>& found, Array<double>& dist2, const point& pt, double radius ) const
    {
-      if ( node != nullptr )
-         if ( node->IsLeaf() )
+      found.Clear();
+      dist2.Clear();
+      if ( m_nodes.IsEmpty() || radius < 0 )
+         return;
+
+      GenericVector<double> q( m_dimension );
+      for ( int d = 0; d < m_dimension; ++d )
+         q[d] = double( pt[d] );
+      double r2 = SquaredDistance( radius );
+
+      const size_type n = m_points.Length();
+      GenericVector<double> d2( m_bucketCapacity );
+
+      uint32 stack[ MaxDepth ];
+      int top = 0;
+      stack[top++] = 0;
+      while ( top > 0 )
+      {
+         const Node& node = m_nodes[stack[--top]];
+         if ( node.IsLeaf() )
          {
-            const LeafNode* leaf = static_cast<const LeafNode*>( node );
-            for ( const point& p : leaf->points )
-               for ( int j = 0; ; )
+            uint32 m = node.end - node.begin;
+            LeafDistances( *d2, q, node.begin, m, n );
+            for ( uint32 i = 0; i < m; ++i )
+               if ( d2[i] <= r2 )
                {
-                  component x = p[j];
-                  if ( x < p0[j] || p1[j] < x )
-                     break;
-                  if ( ++j == m_dimension )
-                  {
-                     callback( p, data );
-                     break;
-                  }
+                  found << node.begin + i;
+                  dist2 << d2[i];
                }
          }
          else
          {
-            int index = depth % m_dimension;
-            if ( p0[index] <= node->split )
-               SearchTree( p0, p1, callback, data, node->left, depth+1 );
-            if ( p1[index] > node->split )
-               SearchTree( p0, p1, callback, data, node->right, depth+1 );
+            uint32 self = uint32( &node - m_nodes.Begin() );
+            double delta = q[node.axis] - node.split;
+            if ( delta <= radius )
+               stack[top++] = self + 1;
+            if ( delta >= -radius )
+               stack[top++] = node.right;
          }
+      }
    }
 
-   void DestroyTree( Node* node )
+   /*
+    * Squared distances from q to the m points starting at index i0. With SoA
+    * coordinates, the inner loop runs over contiguous memory.
+    */
+   void LeafDistances( double* d2, const GenericVector<double>& q, uint32 i0, uint32 m, size_type n ) const
    {
-      if ( node != nullptr )
-         if ( node->IsLeaf() )
-            delete static_cast<LeafNode*>( node );
-         else
+      for ( uint32 i = 0; i < m; ++i )
+         d2[i] = 0;
+      for ( int d = 0; d < m_dimension; ++d )
+      {
+         const double* c = m_coordinates.Begin() + d*n + i0;
+         double qd = q[d];
+         for ( uint32 i = 0; i < m; ++i )
          {
-            DestroyTree( node->left );
-            DestroyTree( node->right );
-            delete node;
+            double delta = c[i] - qd;
+            d2[i] += delta*delta;
          }
+      }
    }
 
-   double SplitValue( const point_list& points, int index )
+   template <class F>
+   class QueryThread : public Thread
+   {
+   public:
+
+      QueryThread( F& f, size_type begin, size_type end ) :
+         m_f( f ), m_begin( begin ), m_end( end )
+      {
+      }
+
+      void Run() override
+      {
+         for ( size_type i = m_begin; i < m_end; ++i )
+            m_f( i );
+      }
+
+   private:
+
+      F&        m_f;
+      size_type m_begin;
+      size_type m_end;
+   };
+
+   template <class F>
+   void RunQueries( const point_list& queries, F f ) const
    {
-      component_vector v( points.Length() );
-      for ( int i = 0; i < v.Length(); ++i )
-         v[i] = points[i][index];
-      return v.Median();
+      size_type count = queries.Length();
+      int numberOfThreads = m_parallel ? Min( m_maxProcessors, Thread::NumberOfThreads( count, 16 ) ) : 1;
+      if ( numberOfThreads > 1 )
+      {
+         size_type queriesPerThread = count/numberOfThreads;
+         ReferenceArray<QueryThread<F> > threads;
+         for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+            threads << new QueryThread<F>( f, i*queriesPerThread, (j < numberOfThreads) ? j*queriesPerThread : count );
+         bool useAffinity = Thread::IsRootThread();
+         int k = 0;
+         for ( QueryThread<F>& thread : threads )
+            thread.Start( ThreadPriority::DefaultMax, useAffinity ? k++ : -1 );
+         for ( QueryThread<F>& thread : threads )
+            thread.Wait();
+         threads.Destroy();
+      }
+      else
+         for ( size_type i = 0; i < count; ++i )
+            f( i );
    }
 };
 
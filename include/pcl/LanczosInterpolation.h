@@ -262,7 +262,7 @@ public:
             if ( m_fillBorder )
                FillRow( sp, sn, wp, wn, m_lut[k][dy] );
             else
-               InterpolateRow( sp, sn, wp, wn, m_data - 2*int64( y )*m_width, x0, m_lut[k][dy] );
+               InterpolateRow( sp, sn, wp, wn, m_data - int64( y )*m_width, x0, m_lut[k][dy] );
          }
 
          // Unclipped rows
@@ -302,7 +302,7 @@ public:
             if ( m_fillBorder )
                FillRow( sp, sn, wp, wn, Lanczos( i - dy ) );
             else
-               InterpolateRow( sp, sn, wp, wn, m_data - 2*int64( y )*m_width, x0, Lanczos( i - dy ) );
+               InterpolateRow( sp, sn, wp, wn, m_data - int64( y )*m_width, x0, Lanczos( i - dy ) );
          }
 
          // Unclipped rows
@@ -609,7 +609,7 @@ public:
          if ( m_fillBorder )
             FillRow( sp, sn, wp, wn, m_Ly[k] );
          else
-            InterpolateRow( sp, sn, wp, wn, m_data - 2*int64( y )*m_width, x0, m_Ly[k] );
+            InterpolateRow( sp, sn, wp, wn, m_data - int64( y )*m_width, x0, m_Ly[k] );
       }
 
       // Unclipped rows
@@ -68,6 +68,7 @@ namespace pcl
 
 class PCL_CLASS XMLDocument;
 class PCL_CLASS XMLElement;
+class PCL_CLASS BinaryContainerReader;
 
 /*!
  * \class LocalNormalizationData
@@ -153,7 +154,10 @@ public:
     *
     * \param filePath   Path to an existing file that will be parsed. The file
     *                   contents must be in %XML normalization data format
-    *                   (usually, a file with the .xnml suffix).
+    *                   (usually, a file with the .xnml suffix), or in binary
+    *                   normalization data format (see SerializeToBinaryFile()).
+    *                   This function will detect the format in use from the
+    *                   first bytes read from the file.
     *
     * \param ignoreNormalizationData     If true, local normalization data will
     *                   be ignored and not parsed. This includes matrices of
@@ -592,6 +596,23 @@ public:
     */
    void SerializeToFile( const String& path ) const;
 
+   /*!
+    * Serializes the normalization data transported by this object as a new
+    * binary data container file. The file will be newly created at the
+    * specified file \a path.
+    *
+    * The binary normalization data format stores the same data as the XNML
+    * format, but matrices of normalization function coefficients are written
+    * as raw arrays aligned to 64-byte boundaries, which are mapped into memory
+    * by Parse( const String& ) instead of being decoded from an %XML document.
+    * Conversion between both formats is lossless. See BinaryContainerWriter
+    * for a description of the container file format.
+    *
+    * \warning If a file already exists at the specified \a path, its previous
+    * contents will be lost after calling this function.
+    */
+   void SerializeToBinaryFile( const String& path ) const;
+
 private:
 
    String                 m_referenceFilePath;    // path to the normalization reference image
@@ -610,6 +631,16 @@ private:
 
    void ParseNormalizationMatrices( normalization_matrices&, const XMLElement& ) const;
    void SerializeNormalizationMatrices( XMLElement*, const normalization_matrices& ) const;
+   void ValidateSerializableData() const;
+   void ValidateParsedData( bool ignoreNormalizationData );
+   void DecodeBinary( const BinaryContainerReader&, bool ignoreNormalizationData );
+
+   /*!
+    * \internal
+    * \class LocalNormalizationData::XMLDecoder
+    * \brief Event-driven parser of XNML files
+    */
+   class XMLDecoder;
 };
 
 // ----------------------------------------------------------------------------
@@ -142,6 +142,143 @@ inline int MaxSSEInstructionSetSupported()
    return 0;
 }
 
+/*!
+ * Returns true iff the running processor supports the PCLMULQDQ carry-less
+ * multiplication instruction. This function is a portable wrapper to the
+ * CPUID x86 instruction.
+ *
+ * \ingroup hw_identification_functions
+ */
+inline bool IsPCLMULQDQInstructionSupported()
+{
+   int32 ecxFlags = 0;
+
+#ifdef _MSC_VER
+   int cpuInfo[ 4 ];
+   __cpuid( cpuInfo, 1 );
+   ecxFlags = cpuInfo[2];
+#else
+   asm volatile( "mov $0x00000001, %%eax\n\t"
+                 "cpuid\n\t"
+                 "mov %%ecx, %0\n"
+                  : "=r" (ecxFlags)                   // output operands
+                  :                                   // input operands
+                  : "%eax", "%ebx", "%ecx", "%edx" ); // clobbered registers
+#endif
+
+   return (ecxFlags & (1u << 1)) != 0;
+}
+
+/*!
+ * Returns true iff the running processor supports the Intel SHA extensions,
+ * which accelerate the SHA-1 and SHA-256 cryptographic hash algorithms. This
+ * function is a portable wrapper to the CPUID x86 instruction.
+ *
+ * \ingroup hw_identification_functions
+ */
+inline bool IsSHAInstructionSetSupported()
+{
+   int32 ebxFlags = 0;
+
+#ifdef _MSC_VER
+   int cpuInfo[ 4 ];
+   __cpuid( cpuInfo, 0 );
+   if ( cpuInfo[0] >= 7 )
+   {
+      __cpuidex( cpuInfo, 7, 0 );
+      ebxFlags = cpuInfo[1];
+   }
+#else
+   int32 maxLeaf = 0;
+   asm volatile( "mov $0x00000000, %%eax\n\t"
+                 "cpuid\n\t"
+                 "mov %%eax, %0\n"
+                  : "=r" (maxLeaf)                    // output operands
+                  :                                   // input operands
+                  : "%eax", "%ebx", "%ecx", "%edx" ); // clobbered registers
+   if ( maxLeaf >= 7 )
+      asm volatile( "mov $0x00000007, %%eax\n\t"
+                    "xor %%ecx, %%ecx\n\t"
+                    "cpuid\n\t"
+                    "mov %%ebx, %0\n"
+                     : "=r" (ebxFlags)                   // output operands
+                     :                                   // input operands
+                     : "%eax", "%ebx", "%ecx", "%edx" ); // clobbered registers
+#endif
+
+   return (ebxFlags & (1u << 29)) != 0;
+}
+
+/*!
+ * Returns true iff the running processor supports the AVX2 and FMA3
+ * instruction sets, and the operating system preserves the 256-bit AVX
+ * register state across context switches. This function is a portable
+ * wrapper to the CPUID and XGETBV x86 instructions.
+ *
+ * \ingroup hw_identification_functions
+ */
+inline bool IsAVX2InstructionSetSupported()
+{
+   int32 ecxFlags = 0;
+   int32 ebxFlags = 0;
+   int32 maxLeaf = 0;
+
+#ifdef _MSC_VER
+   int cpuInfo[ 4 ];
+   __cpuid( cpuInfo, 0 );
+   maxLeaf = cpuInfo[0];
+   __cpuid( cpuInfo, 1 );
+   ecxFlags = cpuInfo[2];
+   if ( maxLeaf >= 7 )
+   {
+      __cpuidex( cpuInfo, 7, 0 );
+      ebxFlags = cpuInfo[1];
+   }
+#else
+   asm volatile( "mov $0x00000000, %%eax\n\t"
+                 "cpuid\n\t"
+                 "mov %%eax, %0\n"
+                  : "=r" (maxLeaf)                    // output operands
+                  :                                   // input operands
+                  : "%eax", "%ebx", "%ecx", "%edx" ); // clobbered registers
+   asm volatile( "mov $0x00000001, %%eax\n\t"
+                 "cpuid\n\t"
+                 "mov %%ecx, %0\n"
+                  : "=r" (ecxFlags)                   // output operands
+                  :                                   // input operands
+                  : "%eax", "%ebx", "%ecx", "%edx" ); // clobbered registers
+   if ( maxLeaf >= 7 )
+      asm volatile( "mov $0x00000007, %%eax\n\t"
+                    "xor %%ecx, %%ecx\n\t"
+                    "cpuid\n\t"
+                    "mov %%ebx, %0\n"
+                     : "=r" (ebxFlags)                   // output operands
+                     :                                   // input operands
+                     : "%eax", "%ebx", "%ecx", "%edx" ); // clobbered registers
+#endif
+
+   // FMA (bit 12), OSXSAVE (bit 27) and AVX (bit 28)
+   const uint32 ecxMask = (1u << 12) | (1u << 27) | (1u << 28);
+   if ( (uint32( ecxFlags ) & ecxMask) != ecxMask )
+      return false;
+   if ( (ebxFlags & (1u << 5)) == 0 ) // AVX2
+      return false;
+
+   // The OS must save and restore the XMM and YMM registers.
+   uint32 xcr0;
+#ifdef _MSC_VER
+   xcr0 = uint32( _xgetbv( 0 ) );
+#else
+   asm volatile( "xor %%ecx, %%ecx\n\t"
+                 "xgetbv\n\t"
+                 "mov %%eax, %0\n"
+                  : "=r" (xcr0)                       // output operands
+                  :                                   // input operands
+                  : "%eax", "%ecx", "%edx" );         // clobbered registers
+#endif
+   return (xcr0 & 6u) == 6u;
+}
+
 // ----------------------------------------------------------------------------
 
 /*!
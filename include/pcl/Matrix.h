@@ -3047,6 +3047,41 @@ GenericMatrix<T> operator -( const T& x, const GenericMatrix<T>& A )
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Matrix product implementation: R = A*B, where R has been allocated with the
+ * dimensions of the result.
+ *
+ * The specializations for double and float are implemented in Algebra.cpp as
+ * cache-blocked, packed and vectorized (with runtime AVX2/FMA dispatch) matrix
+ * multiplication routines, which run in parallel for large matrices. The
+ * generic version uses a row-oriented triple loop, which accesses the
+ * elements of the right-hand operand sequentially.
+ */
+void PCL_FUNC MatrixProductImplementation( GenericMatrix<double>&, const GenericMatrix<double>&, const GenericMatrix<double>& );
+void PCL_FUNC MatrixProductImplementation( GenericMatrix<float>&, const GenericMatrix<float>&, const GenericMatrix<float>& );
+
+template <typename T> inline
+void MatrixProductImplementation( GenericMatrix<T>& R, const GenericMatrix<T>& A, const GenericMatrix<T>& B )
+{
+   int n = R.Rows();
+   int m = R.Cols();
+   int p = A.Cols();
+   for ( int i = 0; i < n; ++i )
+   {
+      T* r = R[i];
+      for ( int j = 0; j < m; ++j )
+         r[j] = T( 0 );
+      const T* a = A[i];
+      for ( int k = 0; k < p; ++k )
+      {
+         const T aik = a[k];
+         const T* b = B[k];
+         for ( int j = 0; j < m; ++j )
+            r[j] += aik * b[j];
+      }
+   }
+}
+
 /*!
  * Returns the product of two matrices \a A and \a B.
  *
@@ -3068,14 +3103,7 @@ GenericMatrix<T> operator *( const GenericMatrix<T>& A, const GenericMatrix<T>&
    if ( B.Rows() != p )
       throw Error( "Invalid matrix multiplication." );
    GenericMatrix<T> R( n, m );
-   for ( int i = 0; i < n; ++i )
-      for ( int j = 0; j < m; ++j )
-      {
-         T rij = 0;
-         for ( int k = 0; k < p; ++k )
-            rij += A[i][k] * B[k][j];
-         R[i][j] = rij;
-      }
+   MatrixProductImplementation( R, A, B );
    return R;
 }
 
@@ -0,0 +1,280 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/PSFFitter.h - Released 2019-01-21T12:06:07Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+
+#ifndef __PCL_PSFFitter_h
+#define __PCL_PSFFitter_h
+
+/// \file pcl/PSFFitter.h
+
+#include <pcl/Defs.h>
+#include <pcl/Diagnostics.h>
+
+#include <pcl/Array.h>
+#include <pcl/Matrix.h>
+#include <pcl/ParallelProcess.h>
+#include <pcl/Vector.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class PSFFitter
+ * \brief Nonlinear least squares fitting of point spread function models.
+ *
+ * %PSFFitter fits analytic PSF models to matrices of sampled pixel values by
+ * the Levenberg-Marquardt algorithm. Partial derivatives of all supported
+ * models are evaluated analytically, along with model values, in a single
+ * pass over the sampled pixels, so each iteration requires just one model
+ * evaluation irrespective of the number of fitted parameters.
+ *
+ * The following models are supported, where q is the squared radial distance
+ * from the centroid normalized by the scale parameters, in the rotated frame
+ * of the PSF for elliptical functions:
+ *
+ * <table border="1" cellpadding="4" cellspacing="0">
+ * <tr><td>PSFFitter::Gaussian</td>   <td>f = B + A*Exp( -q/2 )</td></tr>
+ * <tr><td>PSFFitter::Moffat</td>     <td>f = B + A/(1 + q)^beta</td></tr>
+ * <tr><td>PSFFitter::Lorentzian</td> <td>f = B + A/(1 + q)</td></tr>
+ * </table>
+ *
+ * Model parameters are stored in vectors with the following components:
+ *
+ * <table border="1" cellpadding="4" cellspacing="0">
+ * <tr><td>Circular</td>   <td>B, A, x0, y0, sx, beta</td></tr>
+ * <tr><td>Elliptical</td> <td>B, A, x0, y0, sx, sy, theta, beta</td></tr>
+ * </table>
+ *
+ * where B is the local background, A is the amplitude, (x0,y0) are the
+ * centroid coordinates relative to the pixel at column Cols()/2 and row
+ * Rows()/2 of the sample matrix, sx and sy are the scale parameters on the X
+ * and Y axes, theta is the rotation angle in radians, and beta is the Moffat
+ * shape parameter. The beta component is ignored by Gaussian and Lorentzian
+ * functions, and is fitted only by Moffat functions with variable shape.
+ *
+ * Besides single fits, %PSFFitter can solve a set of independent problems in
+ * parallel threads, which is the preferred way to fit all stars detected in
+ * an image.
+ */
+class PCL_CLASS PSFFitter : public ParallelProcess
+{
+public:
+
+   /*!
+    * Supported PSF model functions.
+    */
+   enum Function
+   {
+      Gaussian,
+      Moffat,
+      Lorentzian
+   };
+
+   /*!
+    * Fitting result codes. The order of these codes is the same as in the
+    * status enumerations used by standard modules.
+    */
+   enum Status
+   {
+      NotFitted,
+      FittedOk,
+      BadParameters,
+      NoSolution,
+      NoConvergence,
+      InaccurateSolution,
+      UnknownError
+   };
+
+   /*!
+    * \struct pcl::PSFFitter::Problem
+    * \brief An independent PSF fitting problem for batch fits.
+    */
+   struct Problem
+   {
+      Matrix S;                  //!< Matrix of sampled pixel values.
+      Vector P;                  //!< Initial parameter estimates on input; fitted parameters on output.
+      Status status = NotFitted; //!< Fitting result code.
+   };
+
+   /*!
+    * An array of PSF fitting problems.
+    */
+   typedef Array<Problem>  problem_list;
+
+   /*!
+    * Constructs a new %PSFFitter object.
+    *
+    * \param function   The PSF model function.
+    *
+    * \param circular   Whether to fit circular or elliptical PSF models.
+    *
+    * \param fixedBeta  Whether the beta shape parameter of Moffat functions is
+    *                   fixed or fitted. This parameter is ignored for Gaussian
+    *                   and Lorentzian functions.
+    *
+    * \param tolerance  Convergence tolerance. Fitting terminates successfully
+    *                   when either the relative reduction in the sum of squared
+    *                   residuals or the relative parameter increment is not
+    *                   larger than this value.
+    */
+   PSFFitter( Function function, bool circular, bool fixedBeta = true, double tolerance = 1.0e-08 ) :
+      m_function( function ),
+      m_circular( circular ),
+      m_fixedBeta( fixedBeta || function != Moffat ),
+      m_tolerance( Max( tolerance, 1.0e-15 ) )
+   {
+   }
+
+   /*!
+    * Copy constructor.
+    */
+   PSFFitter( const PSFFitter& ) = default;
+
+   /*!
+    * Copy assignment operator. Returns a reference to this object.
+    */
+   PSFFitter& operator =( const PSFFitter& ) = default;
+
+   /*!
+    * Returns the PSF model function fitted by this object.
+    */
+   Function PSFFunction() const
+   {
+      return m_function;
+   }
+
+   /*!
+    * Returns true iff this object fits circular PSF models.
+    */
+   bool IsCircular() const
+   {
+      return m_circular;
+   }
+
+   /*!
+    * Returns true iff the beta shape parameter is fitted.
+    */
+   bool IsVariableShape() const
+   {
+      return !m_fixedBeta;
+   }
+
+   /*!
+    * Returns the convergence tolerance of this object.
+    */
+   double Tolerance() const
+   {
+      return m_tolerance;
+   }
+
+   /*!
+    * Returns the length of a parameter vector for circular or elliptical PSF
+    * models.
+    */
+   static int NumberOfParameters( bool circular )
+   {
+      return circular ? 6 : 8;
+   }
+
+   /*!
+    * Returns the index of the beta shape parameter in parameter vectors.
+    */
+   int BetaIndex() const
+   {
+      return m_circular ? 5 : 7;
+   }
+
+   /*!
+    * Returns the number of parameters actually fitted by this object.
+    */
+   int NumberOfFittedParameters() const
+   {
+      return (m_circular ? 5 : 7) + (m_fixedBeta ? 0 : 1);
+   }
+
+   /*!
+    * Fits a PSF model to a matrix of sampled pixel values.
+    *
+    * \param[in,out] P  Parameter vector. On input, this vector must contain
+    *                initial estimates for all model parameters. On output, it
+    *                will contain the fitted parameters. Its length must be at
+    *                least NumberOfParameters( IsCircular() ).
+    *
+    * \param S       Matrix of sampled pixel values.
+    *
+    * Returns a fitting result code.
+    */
+   Status Fit( Vector& P, const Matrix& S ) const;
+
+   /*!
+    * Solves a set of independent PSF fitting problems using parallel threads,
+    * as allowed by the current parallel processing settings of this object.
+    */
+   void Fit( problem_list& problems ) const;
+
+private:
+
+   Function m_function;
+   bool     m_circular;
+   bool     m_fixedBeta;
+   double   m_tolerance;
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __PCL_PSFFitter_h
+
+// ----------------------------------------------------------------------------
+// EOF pcl/PSFFitter.h - Released 2019-01-21T12:06:07Z
@@ -0,0 +1,566 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/ParallelSelection.h - Released 2019-01-21T12:06:07Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#ifndef __PCL_ParallelSelection_h
+#define __PCL_ParallelSelection_h
+
+/// \file pcl/ParallelSelection.h
+
+#include <pcl/Defs.h>
+
+#include <pcl/Array.h>
+#include <pcl/Math.h>
+#include <pcl/Rectangle.h>
+#include <pcl/Selection.h>
+#include <pcl/ThreadPool.h>
+
+#include <string.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class ParallelSampleSelection
+ * \brief Parallel, copy-free selection of order statistics on image samples.
+ *
+ * %ParallelSampleSelection computes order statistics (medians, percentiles,
+ * trimmed means, etc.) of a rectangular region of one or more image channels
+ * without copying pixel samples. Selection is performed by successive
+ * refinement of radix buckets: each sample is transformed to a 64-bit key that
+ * preserves the ordering of its floating point value, and a histogram of the
+ * most significant key bits within the current bucket is computed in parallel
+ * for all selected samples. Each refinement pass narrows the search to the
+ * bucket containing the requested order statistic, until either a single key
+ * remains or the bucket is small enough to be gathered and solved with a
+ * conventional selection algorithm. Selected values are exact.
+ *
+ * The template argument P is a pixel traits class. The template argument F is
+ * a filter class providing the following member function:
+ *
+ * \code bool operator()( const typename P::sample& ) const; \endcode
+ *
+ * which must return true for each sample that has to be included in the
+ * calculations. For complex pixel types, the magnitudes of the selected
+ * samples are used.
+ *
+ * Optionally, all calculations can be performed on absolute deviations from a
+ * given center value; see SetCenter(). This allows for calculation of robust
+ * estimators of scale such as MAD.
+ *
+ * Additional memory requirements are proportional to the number of histogram
+ * bins and the number of threads, irrespective of the number of samples.
+ */
+template <class P, class F>
+class PCL_CLASS ParallelSampleSelection
+{
+public:
+
+   /*!
+    * Represents a pixel sample.
+    */
+   typedef typename P::sample    sample;
+
+   /*!
+    * Represents a sample filter.
+    */
+   typedef F                     filter;
+
+   /*!
+    * Constructs a new selection object.
+    *
+    * \param channels   Addresses of the first pixel samples of the channels
+    *                   that will be used for calculations.
+    *
+    * \param width      Image width in pixels.
+    *
+    * \param rect       Rectangular region of interest in image coordinates.
+    *
+    * \param f          Sample filter.
+    *
+    * \param numberOfThreads  Maximum number of concurrent threads. The
+    *                   region of interest will be divided into this number of
+    *                   row stripes, which will be processed by pool worker
+    *                   threads; see ThreadPool::ParallelFor().
+    */
+   ParallelSampleSelection( const Array<const sample*>& channels, int width, const Rect& rect, const F& f,
+                            int numberOfThreads = 1 ) :
+      m_channels( channels ),
+      m_width( width ),
+      m_rect( rect ),
+      m_filter( f ),
+      m_numberOfThreads( Range( numberOfThreads, 1, Max( 1, rect.Height() ) ) )
+   {
+   }
+
+   /*!
+    * Causes all subsequent calculations to be performed on absolute
+    * deviations from the specified \a center value, in the normalized [0,1]
+    * range.
+    */
+   void SetCenter( double center )
+   {
+      m_center = center;
+      m_deviations = true;
+      m_scanned = false;
+   }
+
+   /*!
+    * Causes all subsequent calculations to be performed on sample values.
+    */
+   void ClearCenter()
+   {
+      m_deviations = false;
+      m_scanned = false;
+   }
+
+   /*!
+    * Returns the number of samples selected by the filter.
+    */
+   size_type Count()
+   {
+      Scan();
+      return m_count;
+   }
+
+   /*!
+    * Returns the order statistic of rank \a k, that is, the value that would
+    * be at position \a k (zero-based) if the selected values were sorted in
+    * ascending order.
+    *
+    * If \a previous is not \c nullptr, the order statistic of rank \a k-1 will
+    * be stored in the variable pointed to by \a previous, or zero if \a k is
+    * zero.
+    *
+    * Returns zero if there are less than \a k+1 selected samples.
+    */
+   double OrderStatistic( size_type k, double* previous = nullptr )
+   {
+      Scan();
+      if ( previous != nullptr )
+         *previous = 0;
+      if ( k >= m_count )
+         return 0;
+
+      /*
+       * Radix selection on 16-bit digits, most significant first. The first
+       * level histogram has already been computed by Scan().
+       */
+      size_type below = 0; // number of values in lower buckets
+      uint64 lo = 0;
+      Array<size_type> H = m_histogram;
+      for ( int shift = 48; ; shift -= 16 )
+      {
+         const Array<size_type>& h = H;
+         int b = 0;
+         for ( ; below + h[b] <= k; ++b )
+            below += h[b];
+         size_type count = h[b];
+
+         lo += uint64( b ) << shift;
+         if ( shift == 0 )
+         {
+            // A single key remains.
+            double x = ValueFromKey( lo );
+            if ( previous != nullptr && k > 0 )
+               *previous = (k > below) ? x : Predecessor( lo );
+            return x;
+         }
+
+         uint64 hi = lo + ((uint64( 1 ) << shift) - 1);
+         if ( count <= GatherLimit )
+         {
+            GatherAccumulator G( lo, hi );
+            G = Accumulate( G );
+            size_type r = k - below;
+            double x = *pcl::Select( G.values.Begin(), G.values.End(), distance_type( r ) );
+            if ( previous != nullptr && k > 0 )
+               *previous = (r > 0) ? *pcl::MaxItem( G.values.Begin(), G.values.At( r ) ) : Predecessor( lo );
+            return x;
+         }
+
+         H = Accumulate( HistogramAccumulator( lo, shift - 16 ) ).bins;
+      }
+   }
+
+   /*!
+    * Returns the median of the selected values. For sets of even length, the
+    * mean of the two central values is returned, as pcl::Median() does.
+    * Returns zero if there are no selected samples.
+    */
+   double Median()
+   {
+      size_type n = Count();
+      if ( n == 0 )
+         return 0;
+      size_type n2 = n >> 1;
+      if ( n & 1 )
+         return OrderStatistic( n2 );
+      double m1;
+      double m = OrderStatistic( n2, &m1 );
+      return (m + m1)/2;
+   }
+
+   /*!
+    * Returns the two-sided trimmed mean of the selected values. The \a l and
+    * \a h parameters are the fractions of the lowest and highest values that
+    * will be excluded, respectively, in the [0,0.5) range. Returns zero if no
+    * values remain after trimming.
+    */
+   double TrimmedMean( double l = 0.2, double h = 0.2 )
+   {
+      size_type n = Count();
+      size_type r0 = size_type( Range( l, 0.0, 0.5 )*n );
+      size_type r1 = n - size_type( Range( h, 0.0, 0.5 )*n ); // exclusive
+      if ( r1 <= r0 )
+         return 0;
+
+      double t0 = OrderStatistic( r0 );
+      double t1 = OrderStatistic( r1-1 );
+      if ( t0 == t1 )
+         return t0;
+
+      TrimmedSumAccumulator T( t0, t1 );
+      T = Accumulate( T );
+
+      /*
+       * Account for the exact numbers of values equal to the trimming limits,
+       * which may be repeated.
+       */
+      size_type c0 = T.countBelow + T.countLow - r0;   // ranks [r0,countBelow+countLow) == t0
+      size_type c1 = r1 - (n - T.countAbove - T.countHigh); // ranks [n-countAbove-countHigh,r1) == t1
+      return (T.sum + c0*t0 + c1*t1)/(r1 - r0);
+   }
+
+   /*!
+    * Calls the specified accumulator for each selected value in parallel, and
+    * returns the combined result.
+    *
+    * The accumulator class A must be copy constructible and provide the
+    * following member functions:
+    *
+    * \code
+    * void operator()( double value, int x, int y );
+    * void Combine( const A& );
+    * \endcode
+    *
+    * where \a value is a selected value (or an absolute deviation if a center
+    * has been set) in the normalized [0,1] range, and \a x, \a y are the image
+    * coordinates of the corresponding pixel. Each row stripe is accumulated
+    * on a copy of \a a. Partial results are combined in ascending order of
+    * image rows, so the result does not depend on thread scheduling.
+    */
+   template <class A>
+   A Accumulate( const A& a ) const
+   {
+      int rowsPerStripe = m_rect.Height()/m_numberOfThreads;
+      Array<A> partial( size_type( m_numberOfThreads ), a );
+      ThreadPool::ParallelFor( 0, size_type( m_numberOfThreads ),
+         [&]( size_type i0, size_type i1 )
+         {
+            for ( size_type i = i0; i < i1; ++i )
+            {
+               int j = int( i );
+               AccumulateRows( partial[i],
+                               m_rect.y0 + j*rowsPerStripe,
+                               (j+1 < m_numberOfThreads) ? m_rect.y0 + (j+1)*rowsPerStripe : m_rect.y1 );
+            }
+         }, 1, m_numberOfThreads );
+
+      A result( partial[0] );
+      for ( int i = 1; i < m_numberOfThreads; ++i )
+         result.Combine( partial[i] );
+      return result;
+   }
+
+private:
+
+   enum { NumberOfBins = 65536, GatherLimit = 65536 };
+
+   Array<const sample*> m_channels;
+   int                  m_width;
+   Rect                 m_rect;
+   F                    m_filter;
+   int                  m_numberOfThreads;
+   double               m_center = 0;
+   bool                 m_deviations = false;
+   bool                 m_scanned = false;
+   size_type            m_count = 0;
+   Array<size_type>     m_histogram;    // first level histogram
+
+   /*
+    * Monotonic mapping of IEEE 754 double values to unsigned integers.
+    */
+   static uint64 KeyFromValue( double x )
+   {
+      uint64 u;
+      ::memcpy( &u, &x, sizeof( u ) );
+      return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+   }
+
+   static double ValueFromKey( uint64 u )
+   {
+      u = (u & 0x8000000000000000ull) ? (u & 0x7fffffffffffffffull) : ~u;
+      double x;
+      ::memcpy( &x, &u, sizeof( x ) );
+      return x;
+   }
+
+   /*
+    * Computes the first level histogram of the 16 most significant key bits,
+    * which also yields the number of selected values.
+    */
+   void Scan()
+   {
+      if ( !m_scanned )
+      {
+         HistogramAccumulator H = Accumulate( HistogramAccumulator( 0, 48 ) );
+         m_histogram = H.bins;
+         m_count = 0;
+         for ( size_type c : m_histogram )
+            m_count += c;
+         m_scanned = true;
+      }
+   }
+
+   /*
+    * Returns the largest selected value whose key is less than the specified
+    * key. Requires a full pass over the data.
+    */
+   double Predecessor( uint64 key ) const
+   {
+      PredecessorAccumulator M( key );
+      M = Accumulate( M );
+      return ValueFromKey( M.maxKey );
+   }
+
+   // -------------------------------------------------------------------------
+
+   /*
+    * Accumulates the selected values in the range [firstRow,endRow) of image
+    * rows.
+    */
+   template <class A>
+   void AccumulateRows( A& accumulator, int firstRow, int endRow ) const
+   {
+      const F filter = m_filter;
+      const int x0 = m_rect.x0;
+      const int x1 = m_rect.x1;
+      const size_type width = size_type( m_width );
+      const bool deviations = m_deviations;
+      const double center = m_center;
+
+      for ( const sample* data : m_channels )
+         for ( int y = firstRow; y < endRow; ++y )
+         {
+            const sample* f = data + size_type( y )*width + x0;
+            if ( deviations )
+            {
+               for ( int x = x0; x < x1; ++x, ++f )
+                  if ( filter( *f ) )
+                  {
+                     double v; P::FromSample( v, *f );
+                     accumulator( pcl::Abs( v - center ), x, y );
+                  }
+            }
+            else
+            {
+               for ( int x = x0; x < x1; ++x, ++f )
+                  if ( filter( *f ) )
+                  {
+                     double v; P::FromSample( v, *f );
+                     accumulator( v, x, y );
+                  }
+            }
+         }
+   }
+
+   // -------------------------------------------------------------------------
+
+   /*
+    * Histogram of 16-bit key digits within a bucket [lo,lo+2^(shift+16)).
+    */
+   struct HistogramAccumulator
+   {
+      Array<size_type> bins;
+      uint64           lo;
+      uint64           span;
+      int              shift;
+
+      HistogramAccumulator( uint64 l, int s ) :
+         bins( size_type( NumberOfBins ), size_type( 0 ) ),
+         lo( l ), span( (s < 48) ? ~(~uint64( 0 ) << (s + 16)) : ~uint64( 0 ) ), shift( s ), m_bins( bins.Begin() )
+      {
+      }
+
+      // Each copy owns a private histogram; no implicit data sharing.
+      HistogramAccumulator( const HistogramAccumulator& H ) :
+         bins( H.bins.Begin(), H.bins.End() ), lo( H.lo ), span( H.span ), shift( H.shift ), m_bins( bins.Begin() )
+      {
+      }
+
+      HistogramAccumulator& operator =( const HistogramAccumulator& H )
+      {
+         bins = Array<size_type>( H.bins.Begin(), H.bins.End() );
+         lo = H.lo;
+         span = H.span;
+         shift = H.shift;
+         m_bins = bins.Begin();
+         return *this;
+      }
+
+      void operator()( double v, int, int )
+      {
+         uint64 d = KeyFromValue( v ) - lo;
+         if ( d <= span )
+            ++m_bins[d >> shift];
+      }
+
+      void Combine( const HistogramAccumulator& H )
+      {
+         for ( int i = 0; i < NumberOfBins; ++i )
+            m_bins[i] += H.bins[i];
+      }
+
+   private:
+
+      size_type* m_bins;
+   };
+
+   struct GatherAccumulator
+   {
+      Array<double> values;
+      uint64        lo, hi;
+
+      GatherAccumulator( uint64 l, uint64 h ) : lo( l ), hi( h )
+      {
+      }
+
+      void operator()( double v, int, int )
+      {
+         uint64 k = KeyFromValue( v );
+         if ( k >= lo && k <= hi )
+            values << v;
+      }
+
+      void Combine( const GatherAccumulator& G )
+      {
+         values.Add( G.values );
+      }
+   };
+
+   struct PredecessorAccumulator
+   {
+      uint64 key;
+      uint64 maxKey = 0;
+
+      PredecessorAccumulator( uint64 k ) : key( k )
+      {
+      }
+
+      void operator()( double v, int, int )
+      {
+         uint64 k = KeyFromValue( v );
+         if ( k < key )
+            if ( k > maxKey )
+               maxKey = k;
+      }
+
+      void Combine( const PredecessorAccumulator& M )
+      {
+         maxKey = Max( maxKey, M.maxKey );
+      }
+   };
+
+   struct TrimmedSumAccumulator
+   {
+      double    t0, t1;
+      double    sum = 0;
+      size_type countBelow = 0, countLow = 0, countHigh = 0, countAbove = 0;
+
+      TrimmedSumAccumulator( double a, double b ) : t0( a ), t1( b )
+      {
+      }
+
+      void operator()( double v, int, int )
+      {
+         if ( v < t0 )
+            ++countBelow;
+         else if ( v == t0 )
+            ++countLow;
+         else if ( v < t1 )
+            sum += v;
+         else if ( v == t1 )
+            ++countHigh;
+         else
+            ++countAbove;
+      }
+
+      void Combine( const TrimmedSumAccumulator& T )
+      {
+         sum += T.sum;
+         countBelow += T.countBelow;
+         countLow += T.countLow;
+         countHigh += T.countHigh;
+         countAbove += T.countAbove;
+      }
+   };
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif  // __PCL_ParallelSelection_h
+
+// ----------------------------------------------------------------------------
+// EOF pcl/ParallelSelection.h - Released 2019-01-21T12:06:07Z
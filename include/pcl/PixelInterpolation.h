@@ -821,6 +821,23 @@ public:
       return desc;
    }
 
+   /*!
+    * Returns the filter order of this Lanczos pixel interpolation.
+    */
+   int FilterOrder() const
+   {
+      return m_n;
+   }
+
+   /*!
+    * Returns the clamping threshold of this Lanczos pixel interpolation. A
+    * negative threshold means that interpolation clamping is disabled.
+    */
+   float ClampingThreshold() const
+   {
+      return m_clamp;
+   }
+
 private:
 
    int   m_n;     // filter order
@@ -909,6 +926,15 @@ public:
       return desc;
    }
 
+   /*!
+    * Returns the clamping threshold of this Lanczos pixel interpolation. A
+    * negative threshold means that interpolation clamping is disabled.
+    */
+   float ClampingThreshold() const
+   {
+      return m_clamp;
+   }
+
 private:
 
    float m_clamp; // clamping threshold (enabled if >= 0)
@@ -996,6 +1022,15 @@ public:
       return desc;
    }
 
+   /*!
+    * Returns the clamping threshold of this Lanczos pixel interpolation. A
+    * negative threshold means that interpolation clamping is disabled.
+    */
+   float ClampingThreshold() const
+   {
+      return m_clamp;
+   }
+
 private:
 
    float m_clamp; // clamping threshold (enabled if >= 0)
@@ -1083,6 +1118,15 @@ public:
       return desc;
    }
 
+   /*!
+    * Returns the clamping threshold of this Lanczos pixel interpolation. A
+    * negative threshold means that interpolation clamping is disabled.
+    */
+   float ClampingThreshold() const
+   {
+      return m_clamp;
+   }
+
 private:
 
    float m_clamp; // clamping threshold (enabled if >= 0)
@@ -388,6 +388,276 @@ private:
 
 // ----------------------------------------------------------------------------
 
+/*!
+ * \class Philox4x32
+ * \brief Counter-based Philox4x32-10 pseudo-random number generator.
+ *
+ * Philox is a counter-based generator: each block of four 32-bit random
+ * integers is a bijective function of a 128-bit counter and a 64-bit key. The
+ * key is the generator's seed, while the counter is formed by a 64-bit stream
+ * index and a 64-bit block index. Consequently, any number of independent,
+ * reproducible random streams can be defined for a given seed, and any
+ * position in a stream can be accessed in constant time with Seek().
+ *
+ * This makes %Philox4x32 the generator of choice for parallel tasks that must
+ * produce identical results irrespective of the number of threads used. For
+ * example, if each row of an image is generated with a different stream index
+ * (say, the row number), the result will be the same no matter how rows are
+ * distributed among running threads.
+ *
+ * Besides single deviates, this class provides block functions to fill arrays
+ * with uniform, normal and Poisson random deviates. Block functions generate
+ * exactly the same sequences as successive calls to their single-value
+ * counterparts, but are considerably faster. Normal deviates are generated
+ * with the ziggurat method of Marsaglia and Tsang.
+ *
+ * Examples of use:
+ *
+ * \code
+ * Philox4x32 R( 1234 ); // seed = 1234, stream = 0
+ * double x = R();       // x = random uniform deviate in the range [0,1)
+ * double y = R.Normal( 0, 2 ); // y = normal deviate with mean=0 and sigma=2
+ * DVector v( 1000 );
+ * R.SetStream( 5 );     // switch to stream #5, position 0.
+ * R.Normal( v.Begin(), v.Length() ); // v = 1000 standard normal deviates
+ * \endcode
+ *
+ * <b>References</b>
+ *
+ * John K. Salmon, Mark A. Moraes, Ron O. Dror, David E. Shaw (2011),
+ * <em>Parallel Random Numbers: As Easy as 1, 2, 3</em>, Proceedings of the
+ * International Conference for High Performance Computing, Networking,
+ * Storage and Analysis (SC11).
+ *
+ * George Marsaglia, Wai Wan Tsang (2000), <em>The Ziggurat Method for
+ * Generating Random Variables</em>, Journal of Statistical Software, Vol. 5,
+ * Issue 8.
+ *
+ * Wolfgang H&ouml;rmann (1993), <em>The transformed rejection method for
+ * generating Poisson random variables</em>, Insurance: Mathematics and
+ * Economics, Vol. 12, Issue 1, pp. 39-45.
+ *
+ * \ingroup random_numbers
+ */
+class PCL_CLASS Philox4x32
+{
+public:
+
+   /*!
+    * Constructs a %Philox4x32 random generator.
+    *
+    * \param seed    64-bit initialization seed. If this parameter is zero, a
+    *                unique random seed will be generated automatically. The
+    *                default value is zero.
+    *
+    * \param stream  Index of the random stream. The default value is zero.
+    */
+   Philox4x32( uint64 seed = 0, uint64 stream = 0 )
+   {
+      Initialize( seed, stream );
+   }
+
+   /*!
+    * Reinitializes this generator with a new \a seed and \a stream index. The
+    * current position is reset to the beginning of the stream.
+    *
+    * If the specified \a seed is zero, a unique, high-quality random seed will
+    * be generated automatically by calling RandomSeed64().
+    */
+   void Initialize( uint64 seed, uint64 stream = 0 )
+   {
+      m_seed = (seed != 0) ? seed : RandomSeed64();
+      m_stream = stream;
+      Seek( 0 );
+   }
+
+   /*!
+    * Returns the 64-bit seed of this generator.
+    */
+   uint64 Seed() const
+   {
+      return m_seed;
+   }
+
+   /*!
+    * Returns the current stream index of this generator.
+    */
+   uint64 Stream() const
+   {
+      return m_stream;
+   }
+
+   /*!
+    * Selects a new random \a stream for the current seed. The current
+    * position is reset to the beginning of the stream.
+    */
+   void SetStream( uint64 stream )
+   {
+      m_stream = stream;
+      Seek( 0 );
+   }
+
+   /*!
+    * Returns the current position in the current random stream, measured in
+    * 32-bit words generated since the beginning of the stream.
+    */
+   uint64 Position() const
+   {
+      return (m_block << 2) + m_index;
+   }
+
+   /*!
+    * Moves to the specified \a position in the current random stream,
+    * measured in 32-bit words. This is a constant time operation.
+    */
+   void Seek( uint64 position )
+   {
+      m_block = position >> 2;
+      Generate();
+      m_index = int( position & 3 );
+   }
+
+   /*!
+    * Returns a double precision uniform random deviate in the [0,1) range.
+    * Each deviate is generated from two consecutive 32-bit words with 53
+    * bits of resolution.
+    */
+   double operator()()
+   {
+      return 1.1102230246251565404236316680908203125e-16 * (UI64() >> 11); // 2^-53
+   }
+
+   /*!
+    * Returns a 64-bit unsigned integer uniform random deviate.
+    */
+   uint64 UI64()
+   {
+      uint64 lo = UI32();
+      return lo | (uint64( UI32() ) << 32);
+   }
+
+   /*!
+    * Returns a 32-bit unsigned integer uniform random deviate.
+    */
+   uint32 UI32()
+   {
+      if ( m_index == BufferLength )
+      {
+         m_block += BufferBlocks;
+         Generate();
+         m_index = 0;
+      }
+      return m_buffer[m_index++];
+   }
+
+   /*!
+    * Returns an unsigned integer uniform random deviate in the range [0,n-1].
+    */
+   uint32 UIN( uint32 n )
+   {
+      return UI64() % n;
+   }
+
+   /*!
+    * Fills the first \a n elements of the array \a x with uniform random
+    * deviates in the [0,1) range. The generated sequence is identical to \a n
+    * successive calls to operator()().
+    */
+   void Uniform( double* x, size_type n );
+
+   /*!
+    * Fills the first \a n elements of the array \a x with single precision
+    * uniform random deviates in the [0,1) range. Each deviate is generated
+    * from a single 32-bit word with 24 bits of resolution.
+    */
+   void Uniform( float* x, size_type n );
+
+   /*!
+    * Returns a normal random deviate with the specified \a mean and standard
+    * deviation \a sigma.
+    */
+   double Normal( double mean = 0, double sigma = 1 )
+   {
+      return mean + sigma*StandardNormal();
+   }
+
+   /*!
+    * Fills the first \a n elements of the array \a x with normal random
+    * deviates with the specified \a mean and standard deviation \a sigma.
+    * The generated sequence is identical to \a n successive calls to
+    * Normal( mean, sigma ).
+    */
+   void Normal( double* x, size_type n, double mean = 0, double sigma = 1 );
+
+   /*!
+    * Fills the first \a n elements of the array \a x with single precision
+    * normal random deviates with the specified \a mean and standard deviation
+    * \a sigma.
+    */
+   void Normal( float* x, size_type n, double mean = 0, double sigma = 1 );
+
+   /*!
+    * Returns a discrete random deviate from a Poisson distribution with the
+    * specified expected value \a lambda.
+    */
+   int Poisson( double lambda );
+
+   /*!
+    * Replaces each of the first \a n elements of the array \a x, which are
+    * interpreted as expected values, with a discrete random deviate from a
+    * Poisson distribution with the corresponding expected value. The
+    * generated sequence is identical to successive calls to Poisson().
+    */
+   void Poisson( double* x, size_type n );
+
+   /*!
+    * Replaces each of the first \a n elements of the array \a x, which are
+    * interpreted as expected values, with a discrete random deviate from a
+    * Poisson distribution with the corresponding expected value.
+    */
+   void Poisson( float* x, size_type n );
+
+   /*!
+    * The Philox4x32-10 bijection. Computes four 32-bit random integers in the
+    * \a result array as a function of a 128-bit \a counter and a 64-bit
+    * \a key, respectively stored as four and two 32-bit words.
+    */
+   static void Bijection( uint32* result, const uint32* counter, const uint32* key )
+   {
+      uint32 c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+      uint32 k0 = key[0], k1 = key[1];
+      for ( int r = 0; ; )
+      {
+         uint64 p0 = uint64( 0xD2511F53u ) * c0;
+         uint64 p1 = uint64( 0xCD9E8D57u ) * c2;
+         c0 = uint32( p1 >> 32 ) ^ c1 ^ k0;
+         c1 = uint32( p1 );
+         c2 = uint32( p0 >> 32 ) ^ c3 ^ k1;
+         c3 = uint32( p0 );
+         if ( ++r == 10 )
+            break;
+         k0 += 0x9E3779B9u;
+         k1 += 0xBB67AE85u;
+      }
+      result[0] = c0; result[1] = c1; result[2] = c2; result[3] = c3;
+   }
+
+private:
+
+   enum { BufferBlocks = 16, BufferLength = 4*BufferBlocks };
+
+   uint64 m_seed;
+   uint64 m_stream;
+   uint64 m_block;                  // counter of the first block in m_buffer
+   int    m_index;                  // index of the next word in m_buffer
+   uint32 m_buffer[ BufferLength ];
+
+   void Generate();
+   double StandardNormal();
+};
+
+// ----------------------------------------------------------------------------
+
 } // pcl
 
 #endif   // __PCL_Random_h
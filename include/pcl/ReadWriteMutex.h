@@ -74,6 +74,10 @@ namespace pcl
  * simultaneously, which in turn improves concurrency if write accesses are
  * relatively infrequent.
  *
+ * When PCL code runs without the PixInsight core application (standalone
+ * mode), %ReadWriteMutex is implemented natively with POSIX read/write locks
+ * on UNIX and Linux platforms, and slim reader/writer locks on Windows.
+ *
  * \sa Mutex
  */
 class PCL_CLASS ReadWriteMutex : public UIObject
@@ -92,9 +96,7 @@ public:
     * undefined (mostly catastrophic) behavior. Always ensure that a read/write
     * mutex has been unlocked before destroying it.
     */
-   virtual ~ReadWriteMutex()
-   {
-   }
+   virtual ~ReadWriteMutex();
 
    /*!
     * Copy constructor. This constructor is disabled because %ReadWriteMutex
@@ -177,6 +179,10 @@ public:
 
 private:
 
+   struct NativeData;
+
+   NativeData* m_native = nullptr; // native lock in standalone mode
+
    ReadWriteMutex( void* h ) : UIObject( h )
    {
    }
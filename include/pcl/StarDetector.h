@@ -0,0 +1,504 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/StarDetector.h - Released 2019-01-21T12:06:07Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#ifndef __PCL_StarDetector_h
+#define __PCL_StarDetector_h
+
+/// \file pcl/StarDetector.h
+
+#include <pcl/Defs.h>
+#include <pcl/Diagnostics.h>
+
+#include <pcl/Array.h>
+#include <pcl/Image.h>
+#include <pcl/ImageVariant.h>
+#include <pcl/ParallelProcess.h>
+#include <pcl/Point.h>
+#include <pcl/Rectangle.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class StarDetector
+ * \brief Multithreaded detection of stars on full images.
+ *
+ * %StarDetector finds stars on the intensity component of an image in two
+ * stages:
+ *
+ * \li A <em>structure map</em> is built by optional hot pixel and noise
+ * reduction filtering, a high-pass filter whose scale is controlled by the
+ * StructureLayers() parameter, a dilation filter, and an adaptive binarization
+ * based on a wavelet noise estimate. These operations are applied to the
+ * whole image and run in parallel as allowed by the parallel processing
+ * settings of this object.
+ *
+ * \li The structure map is scanned on a grid of square tiles, which are
+ * processed concurrently. Structures are grown downward from their topmost
+ * pixels in raster order, and each structure is reported only by the tile
+ * where it has been seeded, which removes duplicate detections at tile seams
+ * without any synchronization. Each tile is extended by TileOverlap() pixels
+ * on each side, where structures seeded on neighbor tiles are scanned again
+ * just to reproduce the state of a serial scan of the whole map. For each
+ * reported structure, local background estimation, barycenter computation
+ * and rejection criteria are evaluated on the preprocessed image.
+ *
+ * Structures clipped by the boundaries of an extended tile are scanned again
+ * on the whole structure map after the parallel pass, so large structures are
+ * never lost at tile seams. The results are identical to a serial scan of the
+ * whole structure map as long as the dimensions of connected structures
+ * crossing tile seams don't exceed one half of the tile overlap distance.
+ *
+ * Detected stars are returned as a StarDetector::StarList structure, which
+ * stores star properties as a set of parallel arrays (structure of arrays)
+ * ready to generate initial estimates for PSF fitting. Stars are sorted in
+ * raster order of tiles, so the output does not depend on the number of
+ * threads used.
+ */
+class PCL_CLASS StarDetector : public ParallelProcess
+{
+public:
+
+   /*!
+    * \struct pcl::StarDetector::StarList
+    * \brief A list of detected stars stored as a structure of arrays.
+    *
+    * All arrays have the same length, and the i-th element of each array
+    * corresponds to the i-th detected star.
+    */
+   struct StarList
+   {
+      Array<DPoint> pos;         //!< Barycenter coordinates. Pixel centers are at half-integer coordinates.
+      Array<Rect>   rect;        //!< Bounding rectangle of the detected structure.
+      Array<int>    size;        //!< Number of pixels in the detected structure.
+      Array<double> flux;        //!< Total flux, the sum of structure pixel values.
+      Array<double> peak;        //!< Maximum structure pixel value.
+      Array<double> background;  //!< Local background estimate.
+      Array<double> normalized;  //!< Detection level corrected for peak response.
+
+      /*!
+       * Returns the number of stars in this list.
+       */
+      size_type Length() const
+      {
+         return pos.Length();
+      }
+
+      /*!
+       * Returns true iff this list is empty.
+       */
+      bool IsEmpty() const
+      {
+         return pos.IsEmpty();
+      }
+
+      /*!
+       * Appends all stars in the specified list to this list.
+       */
+      void Add( const StarList& stars )
+      {
+         pos.Add( stars.pos );
+         rect.Add( stars.rect );
+         size.Add( stars.size );
+         flux.Add( stars.flux );
+         peak.Add( stars.peak );
+         background.Add( stars.background );
+         normalized.Add( stars.normalized );
+      }
+
+      /*!
+       * Removes all stars in this list.
+       */
+      void Clear()
+      {
+         pos.Clear();
+         rect.Clear();
+         size.Clear();
+         flux.Clear();
+         peak.Clear();
+         background.Clear();
+         normalized.Clear();
+      }
+   };
+
+   /*!
+    * Default constructor. Constructs a star detector with default parameters.
+    */
+   StarDetector() = default;
+
+   /*!
+    * Copy constructor.
+    */
+   StarDetector( const StarDetector& ) = default;
+
+   /*!
+    * Copy assignment operator. Returns a reference to this object.
+    */
+   StarDetector& operator =( const StarDetector& ) = default;
+
+   /*!
+    * Returns the number of wavelet layers used for structure detection. The
+    * high-pass filter applied to build the structure map removes structures
+    * larger than about 2^n pixels. The default value is 5.
+    */
+   int StructureLayers() const
+   {
+      return m_structureLayers;
+   }
+
+   /*!
+    * Sets the number of wavelet layers used for structure detection.
+    */
+   void SetStructureLayers( int n )
+   {
+      PCL_PRECONDITION( n > 0 && n <= 16 )
+      m_structureLayers = Range( n, 1, 16 );
+   }
+
+   /*!
+    * Returns the number of small-scale wavelet layers used for noise
+    * suppression in the structure map, or zero if no noise suppression is
+    * applied. The default value is zero.
+    */
+   int NoiseLayers() const
+   {
+      return m_noiseLayers;
+   }
+
+   /*!
+    * Sets the number of wavelet layers used for noise suppression.
+    */
+   void SetNoiseLayers( int n )
+   {
+      PCL_PRECONDITION( n >= 0 && n <= 16 )
+      m_noiseLayers = Range( n, 0, 16 );
+   }
+
+   /*!
+    * Returns the radius in pixels of the median filter applied for hot pixel
+    * removal, or zero if no hot pixel removal is applied. The default value
+    * is 1.
+    */
+   int HotPixelFilterRadius() const
+   {
+      return m_hotPixelFilterRadius;
+   }
+
+   /*!
+    * Sets the radius in pixels of the hot pixel removal filter.
+    */
+   void SetHotPixelFilterRadius( int r )
+   {
+      PCL_PRECONDITION( r >= 0 )
+      m_hotPixelFilterRadius = Max( 0, r );
+   }
+
+   /*!
+    * Returns true iff hot pixel removal is applied to the image used to
+    * evaluate star properties. Otherwise hot pixel removal is only applied to
+    * the image used to build the structure map. The default value is false.
+    *
+    * When enabled, detection is robust to hot pixels not larger than the hot
+    * pixel filter, but less sensitive, so fewer stars will be detected in
+    * general.
+    */
+   bool IsHotPixelFilterEnabled() const
+   {
+      return m_hotPixelFilter;
+   }
+
+   /*!
+    * Enables hot pixel removal for the image used to evaluate star
+    * properties.
+    */
+   void EnableHotPixelFilter( bool enable = true )
+   {
+      m_hotPixelFilter = enable;
+   }
+
+   /*!
+    * Disables hot pixel removal for the image used to evaluate star
+    * properties.
+    */
+   void DisableHotPixelFilter( bool disable = true )
+   {
+      EnableHotPixelFilter( !disable );
+   }
+
+   /*!
+    * Returns the radius in pixels of the Gaussian filter applied for noise
+    * reduction, or zero if no noise reduction is applied. The default value
+    * is zero. A nonzero noise reduction filter radius implies hot pixel
+    * removal for the image used to evaluate star properties.
+    */
+   int NoiseReductionFilterRadius() const
+   {
+      return m_noiseReductionFilterRadius;
+   }
+
+   /*!
+    * Sets the radius in pixels of the noise reduction filter.
+    */
+   void SetNoiseReductionFilterRadius( int r )
+   {
+      PCL_PRECONDITION( r >= 0 )
+      m_noiseReductionFilterRadius = Max( 0, r );
+   }
+
+   /*!
+    * Returns the detection sensitivity, a lower bound for the relative
+    * difference between the detection level of a star and its local
+    * background. Smaller values mean more sensitivity. The default value is
+    * 0.1.
+    */
+   float Sensitivity() const
+   {
+      return m_sensitivity;
+   }
+
+   /*!
+    * Sets the detection sensitivity.
+    */
+   void SetSensitivity( float s )
+   {
+      PCL_PRECONDITION( s >= 0 )
+      m_sensitivity = Max( 0.0F, s );
+   }
+
+   /*!
+    * Returns the peak response of the detector, in the [0,1] range. Larger
+    * values are more tolerant with relatively flat structures. The default
+    * value is 0.8.
+    */
+   float PeakResponse() const
+   {
+      return m_peakResponse;
+   }
+
+   /*!
+    * Sets the peak response of the detector.
+    */
+   void SetPeakResponse( float r )
+   {
+      PCL_PRECONDITION( r >= 0 && r <= 1 )
+      m_peakResponse = Range( r, 0.0F, 1.0F );
+   }
+
+   /*!
+    * Returns the maximum distortion allowed for detected structures, relative
+    * to a perfect square. The distortion of a perfect circle is pi/4. The
+    * default value is 0.5.
+    */
+   float MaxDistortion() const
+   {
+      return m_maxDistortion;
+   }
+
+   /*!
+    * Sets the maximum distortion allowed for detected structures.
+    */
+   void SetMaxDistortion( float d )
+   {
+      PCL_PRECONDITION( d >= 0 && d <= 1 )
+      m_maxDistortion = Range( d, 0.0F, 1.0F );
+   }
+
+   /*!
+    * Returns the upper limit for star peak values. Stars with peak values
+    * greater than this limit are rejected. The default value is 1.
+    */
+   float UpperLimit() const
+   {
+      return m_upperLimit;
+   }
+
+   /*!
+    * Sets the upper limit for star peak values.
+    */
+   void SetUpperLimit( float u )
+   {
+      m_upperLimit = u;
+   }
+
+   /*!
+    * Returns the inflation distance in pixels of the rectangular region
+    * around each detected structure where its local background is evaluated.
+    * The default value is 3.
+    */
+   int BackgroundExpansion() const
+   {
+      return m_backgroundExpansion;
+   }
+
+   /*!
+    * Sets the inflation distance in pixels for local background evaluation.
+    */
+   void SetBackgroundExpansion( int n )
+   {
+      PCL_PRECONDITION( n > 0 )
+      m_backgroundExpansion = Max( 1, n );
+   }
+
+   /*!
+    * Returns the stretch factor of the barycenter search algorithm, in sigma
+    * units. Larger values make barycenters more robust to nearby structures,
+    * such as multiple stars and small nebular features, but less accurate.
+    * The default value is 1.5.
+    */
+   float XYStretch() const
+   {
+      return m_xyStretch;
+   }
+
+   /*!
+    * Sets the stretch factor of the barycenter search algorithm.
+    */
+   void SetXYStretch( float k )
+   {
+      PCL_PRECONDITION( k >= 0 )
+      m_xyStretch = Max( 0.0F, k );
+   }
+
+   /*!
+    * Returns the size in pixels of the square tiles used to scan the
+    * structure map in parallel. The default value is 512.
+    */
+   int TileSize() const
+   {
+      return m_tileSize;
+   }
+
+   /*!
+    * Sets the size in pixels of structure map scanning tiles.
+    */
+   void SetTileSize( int n )
+   {
+      PCL_PRECONDITION( n >= 16 )
+      m_tileSize = Max( 16, n );
+   }
+
+   /*!
+    * Returns the distance in pixels by which scanning tiles are extended on
+    * each side. Structures that don't fit in an extended tile are scanned
+    * again serially on the whole structure map, so this distance should be
+    * large enough to contain most stars. The default value is 64.
+    */
+   int TileOverlap() const
+   {
+      return m_tileOverlap;
+   }
+
+   /*!
+    * Sets the distance in pixels by which scanning tiles are extended.
+    */
+   void SetTileOverlap( int n )
+   {
+      PCL_PRECONDITION( n >= 0 )
+      m_tileOverlap = Max( 0, n );
+   }
+
+   /*!
+    * Detects stars on the intensity component of the specified image.
+    * Returns the list of detected stars.
+    */
+   StarList Detect( const ImageVariant& image ) const;
+
+   /*!
+    * Detects stars on a preprocessed image and its structure map, as returned
+    * by WorkingImage() and StructureMap() respectively. Returns the list of
+    * detected stars.
+    */
+   StarList Detect( const Image& workingImage, const Image& structureMap ) const;
+
+   /*!
+    * Returns the preprocessed image used to evaluate star properties: the
+    * intensity component of the specified image with optional hot pixel
+    * removal and noise reduction filters applied.
+    */
+   Image WorkingImage( const ImageVariant& image ) const;
+
+   /*!
+    * Returns the binarized structure map computed for the specified
+    * preprocessed image, which must have been generated by WorkingImage().
+    */
+   Image StructureMap( const Image& workingImage ) const;
+
+private:
+
+   int   m_structureLayers = 5;
+   int   m_noiseLayers = 0;
+   int   m_hotPixelFilterRadius = 1;
+   bool  m_hotPixelFilter = false;
+   int   m_noiseReductionFilterRadius = 0;
+   float m_sensitivity = 0.1F;
+   float m_peakResponse = 0.8F;
+   float m_maxDistortion = 0.5F;
+   float m_upperLimit = 1.0F;
+   int   m_backgroundExpansion = 3;
+   float m_xyStretch = 1.5F;
+   int   m_tileSize = 512;
+   int   m_tileOverlap = 64;
+
+   void HotPixelFilter( Image& ) const;
+
+   friend class PCL_StarDetectorThread;
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __PCL_StarDetector_h
+
+// ----------------------------------------------------------------------------
+// EOF pcl/StarDetector.h - Released 2019-01-21T12:06:07Z
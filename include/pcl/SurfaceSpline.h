@@ -125,6 +125,18 @@ protected:
     * Surface spline interpolation callback, 64-bit floating point data.
     */
    static double Interpolate( const double*, const double*, int, const double*, int, double, double );
+
+   /*!
+    * Batched surface spline interpolation, 32-bit floating point data.
+    */
+   static void Interpolate( float*, const double*, const double*, size_type,
+                            const float*, const float*, int, const float*, int, double, double, double );
+
+   /*!
+    * Batched surface spline interpolation, 64-bit floating point data.
+    */
+   static void Interpolate( double*, const double*, const double*, size_type,
+                            const double*, const double*, int, const double*, int, double, double, double );
 };
 
 // ----------------------------------------------------------------------------
@@ -148,6 +160,13 @@ protected:
  * GridInterpolation and PointGridInterpolation classes for discretized
  * implementations with much higher efficiency.
  *
+ * Surface spline generation and evaluation are implemented natively in PCL.
+ * The linear system is solved by a blocked LU decomposition with partial
+ * pivoting, using parallel threads for large node sets. To interpolate many
+ * points, the Evaluate() member function is much faster than repeated calls
+ * to operator()(), since it processes blocks of points with single sweeps over
+ * the list of nodes, in a way suitable for vectorization.
+ *
  * \sa PointSurfaceSpline, GridInterpolation, PointGridInterpolation,
  * ShepardInterpolation, SurfacePolynomial
  */
@@ -385,6 +404,42 @@ public:
       return Interpolate( m_x.Begin(), m_y.Begin(), m_x.Length(), m_spline.Begin(), m_order, m_r0*(x - m_x0), m_r0*(y - m_y0) );
    }
 
+   /*!
+    * Batched two-dimensional surface spline interpolation.
+    *
+    * \param[out] z    Pointer to the first element of an array where the
+    *                   \a count interpolated values will be stored.
+    *
+    * \param x         X coordinates of the interpolation points.
+    *
+    * \param y         Y coordinates of the interpolation points.
+    *
+    * \param count     Number of interpolation points.
+    *
+    * The result is equivalent to z[i] = operator()( x[i], y[i] ) for
+    * 0 <= i < \a count, but this function is much more efficient, especially
+    * for large sets of nodes and interpolation points.
+    */
+   void Evaluate( T* z, const double* x, const double* y, size_type count ) const
+   {
+      PCL_PRECONDITION( !m_x.IsEmpty() && !m_y.IsEmpty() )
+      PCL_PRECONDITION( m_order >= 1 )
+      PCL_PRECONDITION( !m_spline.IsEmpty() )
+      Interpolate( z, x, y, count, m_x.Begin(), m_y.Begin(), m_x.Length(), m_spline.Begin(), m_order, m_r0, m_x0, m_y0 );
+   }
+
+   /*!
+    * Batched two-dimensional surface spline interpolation. Returns a vector
+    * of interpolated values at the specified \a x and \a y coordinates.
+    */
+   vector_type Evaluate( const DVector& x, const DVector& y ) const
+   {
+      PCL_PRECONDITION( x.Length() == y.Length() )
+      vector_type z( Min( x.Length(), y.Length() ) );
+      Evaluate( z.Begin(), x.Begin(), y.Begin(), z.Length() );
+      return z;
+   }
+
    /*!
     * Resets this surface spline interpolation, deallocating all internal
     * working structures.
@@ -302,6 +302,18 @@ public:
       return operator ()( p.x, p.y );
    }
 
+   /*!
+    * Batched point interpolation. For 0 <= i < \a count, stores in zx[i] and
+    * zy[i] the coordinates of the point interpolated at x[i] and y[i]. This is
+    * much faster than successive calls to operator()() for large sets of
+    * points. See SurfaceSpline::Evaluate() for more information.
+    */
+   void Evaluate( double* zx, double* zy, const double* x, const double* y, size_type count ) const
+   {
+      m_Sx.Evaluate( zx, x, y, count );
+      m_Sy.Evaluate( zy, x, y, count );
+   }
+
 private:
 
    spline m_Sx, m_Sy; // the surface splines in the X and Y plane directions.
@@ -495,13 +507,15 @@ private:
 
       PCL_HOT_FUNCTION void Run() override
       {
+         int cols = m_grid.m_Gx.Cols();
+         DVector x( cols ), y( cols );
+         for ( int j = 0; j < cols; ++j )
+            x[j] = m_grid.m_rect.x0 + j*m_grid.m_delta;
          for ( int i = m_startRow; i < m_endRow; ++i )
-            for ( int j = 0, dx = 0, y = m_grid.m_rect.y0 + i*m_grid.m_delta; j < m_grid.m_Gx.Cols(); ++j, dx += m_grid.m_delta )
-            {
-               DPoint p = m_splines( m_grid.m_rect.x0 + dx, y );
-               m_grid.m_Gx[i][j] = p.x;
-               m_grid.m_Gy[i][j] = p.y;
-            }
+         {
+            y = double( m_grid.m_rect.y0 + i*m_grid.m_delta );
+            m_splines.Evaluate( m_grid.m_Gx[i], m_grid.m_Gy[i], x.Begin(), y.Begin(), cols );
+         }
       }
 
    private:
@@ -724,9 +738,18 @@ private:
 
       PCL_HOT_FUNCTION void Run() override
       {
+         int cols = m_grid.m_G.Cols();
+         DVector x( cols ), y( cols );
+         for ( int j = 0; j < cols; ++j )
+            x[j] = m_grid.m_rect.x0 + j*m_grid.m_delta;
+         GenericVector<T> z( cols );
          for ( int i = m_startRow; i < m_endRow; ++i )
-            for ( int j = 0, dx = 0, y = m_grid.m_rect.y0 + i*m_grid.m_delta; j < m_grid.m_G.Cols(); ++j, dx += m_grid.m_delta )
-               m_grid.m_G[i][j] = m_splines( m_grid.m_rect.x0 + dx, y );
+         {
+            y = double( m_grid.m_rect.y0 + i*m_grid.m_delta );
+            m_splines.Evaluate( z.Begin(), x.Begin(), y.Begin(), cols );
+            for ( int j = 0; j < cols; ++j )
+               m_grid.m_G[i][j] = z[j];
+         }
       }
 
    private:
@@ -56,6 +56,7 @@
 
 #include <pcl/Defs.h>
 
+#include <pcl/Atomic.h>
 #include <pcl/String.h>
 #include <pcl/UIObject.h>
 
@@ -124,6 +125,17 @@ namespace ThreadPriority
  *
  * ### TODO: Write a detailed description for %Thread
  *
+ * <b>Standalone execution</b>
+ *
+ * When PCL code runs without the PixInsight core application, for example in
+ * a command-line utility or a unit test (that is, when the global API pointer
+ * is null), %Thread is implemented natively with operating system threads.
+ * In this mode thread status words and abort requests are managed locally,
+ * console output is not accumulated, and the maximum number of processors
+ * used by NumberOfThreads() is given by MaxProcessors(), which can be set with
+ * the PCL_MAX_PROCESSORS environment variable or by calling
+ * SetMaxProcessors().
+ *
  * \ingroup thread_support
  */
 class PCL_CLASS Thread : public UIObject
@@ -143,9 +155,7 @@ public:
    /*!
     * Destroys a %Thread object.
     */
-   virtual ~Thread()
-   {
-   }
+   virtual ~Thread();
 
    /*!
     * Ensures that the server-side object managed by this instance is uniquely
@@ -625,9 +635,42 @@ public:
     */
    static int NumberOfThreads( size_type count, size_type overheadLimit = 16u );
 
+   /*!
+    * Returns the maximum number of processors that can be used to run
+    * concurrent threads.
+    *
+    * When running within the PixInsight core application, this is the
+    * smallest of the System/NumberOfProcessors and Process/MaxProcessors
+    * global settings.
+    *
+    * In standalone mode (without core application support), this is the
+    * number of logical processors reported by the operating system, unless
+    * the PCL_MAX_PROCESSORS environment variable is defined as a positive
+    * integer, or a different value has been set by a call to
+    * SetMaxProcessors().
+    */
+   static int MaxProcessors();
+
+   /*!
+    * Sets the maximum number of processors that can be used to run concurrent
+    * threads in standalone mode. The specified value \a n will be constrained
+    * to the [1,PCL_MAX_PROCESSORS] range.
+    *
+    * This function has no effect when running within the PixInsight core
+    * application, where the maximum number of processors is controlled by
+    * global settings. See MaxProcessors() for more information.
+    */
+   static void SetMaxProcessors( int n );
+
 private:
 
-   int m_processorIndex = -1;
+   struct NativeData;
+
+           int         m_processorIndex = -1;
+           bool        m_pooled = false;   // being executed by a ThreadPool worker
+   mutable AtomicInt   m_localStatus;      // thread status word of a pooled or native thread
+   mutable AtomicInt   m_localActive;      // nonzero while a pooled or native thread is running
+           NativeData* m_native = nullptr; // native thread data in standalone mode
 
    Thread( void* h ) : UIObject( h )
    {
@@ -635,7 +678,10 @@ private:
 
    void* CloneHandle() const override;
 
+   void RunPooled();
+
    friend class ThreadDispatcher;
+   friend class TaskGroup;
 };
 
 // ----------------------------------------------------------------------------
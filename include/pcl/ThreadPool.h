@@ -0,0 +1,594 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/ThreadPool.h - Released 2019-01-21T12:06:07Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#ifndef __PCL_ThreadPool_h
+#define __PCL_ThreadPool_h
+
+/// \file pcl/ThreadPool.h
+
+#include <pcl/Defs.h>
+
+#include <pcl/Atomic.h>
+#include <pcl/Mutex.h>
+#include <pcl/ReferenceArray.h>
+#include <pcl/Thread.h>
+
+#include <exception>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+class PCL_CLASS TaskGroup;
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class ThreadPoolTask
+ * \brief Abstract base class of all tasks executed by the process-wide thread
+ * pool.
+ *
+ * Each %ThreadPoolTask belongs to a TaskGroup, which keeps track of pending
+ * tasks, captures exceptions and allows waiting for completion. Tasks are
+ * normally created implicitly by TaskGroup::Run() and
+ * ThreadPool::ParallelFor(); you seldom will need to derive from this class.
+ *
+ * \ingroup thread_support
+ */
+class PCL_CLASS ThreadPoolTask
+{
+public:
+
+   /*!
+    * Constructs a new task belonging to the specified task \a group.
+    */
+   ThreadPoolTask( TaskGroup& group ) :
+      m_group( group )
+   {
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~ThreadPoolTask()
+   {
+   }
+
+   /*!
+    * Task execution routine. Derived classes must reimplement this function
+    * to provide the task's functionality.
+    */
+   virtual void Execute() = 0;
+
+   /*!
+    * Returns a reference to the task group this task belongs to.
+    */
+   TaskGroup& Group() const
+   {
+      return m_group;
+   }
+
+private:
+
+   TaskGroup& m_group;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class TaskGroup
+ * \brief A set of tasks executed concurrently by the process-wide thread pool.
+ *
+ * %TaskGroup allows running an arbitrary number of function objects on the
+ * persistent worker threads of ThreadPool, and waiting until all of them have
+ * completed execution. Tasks can be submitted from any thread, including
+ * tasks being executed by pool workers (nested parallelism). Tasks submitted
+ * from a worker thread are pushed to the worker's local queue, where they can
+ * be stolen by idle workers.
+ *
+ * When a task throws an exception, the group is canceled and the first
+ * exception thrown is propagated to the caller of Wait(). Tasks belonging to a
+ * canceled group that have not started execution yet are discarded.
+ *
+ * Example:
+ *
+ * \code
+ * TaskGroup group;
+ * for ( int i = 0; i < n; ++i )
+ *    group.Run( [&,i]() { DoSomething( i ); } );
+ * group.Wait();
+ * \endcode
+ *
+ * \ingroup thread_support
+ */
+class PCL_CLASS TaskGroup
+{
+public:
+
+   /*!
+    * Constructs an empty task group.
+    */
+   TaskGroup() = default;
+
+   /*!
+    * Destroys a task group. If there are pending tasks, the group is canceled
+    * and this destructor waits until all running tasks have finished. Any
+    * exceptions thrown by tasks are ignored.
+    */
+   ~TaskGroup();
+
+   /*!
+    * Copy constructor. This constructor is disabled because task groups are
+    * unique objects.
+    */
+   TaskGroup( const TaskGroup& ) = delete;
+
+   /*!
+    * Copy assignment. This operator is disabled because task groups are
+    * unique objects.
+    */
+   TaskGroup& operator =( const TaskGroup& ) = delete;
+
+   /*!
+    * Submits a function object \a f for asynchronous execution on the
+    * process-wide thread pool. The function object will be called without
+    * arguments. It is copied, so any objects captured by reference must
+    * remain valid until this group has been waited for.
+    */
+   template <class F>
+   void Run( const F& f )
+   {
+      Enqueue( new FunctionTask<F>( *this, f ) );
+   }
+
+   /*!
+    * Submits a %Thread object for execution on the process-wide thread pool.
+    *
+    * The reimplemented Thread::Run() member function of \a thread will be
+    * called from a pool worker thread. While the thread is being executed, its
+    * status word, including the abort flag, is managed locally instead of
+    * through the PixInsight core application, so Thread::Abort() and
+    * Thread::TryIsAborted() work as usual. Exceptions thrown by
+    * Thread::Run() are never propagated, exactly as happens with threads
+    * started with Thread::Start().
+    *
+    * This function is used by AbstractImage::RunThreads() to run sets of
+    * image processing threads without creating new execution threads.
+    */
+   void Start( Thread& thread );
+
+   /*!
+    * Waits until all tasks in this group have completed execution.
+    *
+    * The calling thread executes pending tasks while it waits. This prevents
+    * deadlocks with nested parallelism when this function is called from a
+    * pool worker thread.
+    *
+    * If a task has thrown an exception, this function rethrows the first
+    * exception captured after all tasks have finished.
+    */
+   void Wait();
+
+   /*!
+    * Waits until all tasks in this group have completed execution, or until
+    * the specified time interval \a ms in milliseconds has elapsed. Returns
+    * true iff all tasks have completed.
+    *
+    * Unlike Wait(), this function never executes pending tasks on the calling
+    * thread and never throws exceptions, so it can be used to implement
+    * monitoring loops that must remain responsive.
+    */
+   bool Wait( unsigned ms );
+
+   /*!
+    * Returns true iff all tasks in this group have completed execution.
+    */
+   bool IsDone() const
+   {
+      return m_pending.Load() == 0;
+   }
+
+   /*!
+    * Cancels this group. Tasks that have not started execution yet will be
+    * discarded. Running tasks are not interrupted, but they can call
+    * IsCanceled() to stop their work as soon as possible.
+    */
+   void Cancel()
+   {
+      m_canceled.Store( 1 );
+   }
+
+   /*!
+    * Returns true iff this group has been canceled, either explicitly by a
+    * call to Cancel() or because a task has thrown an exception.
+    */
+   bool IsCanceled() const
+   {
+      return m_canceled.Load() != 0;
+   }
+
+private:
+
+   mutable AtomicInt  m_pending;
+   mutable AtomicInt  m_canceled;
+           Mutex      m_mutex;
+   std::exception_ptr m_exception;
+
+   template <class F>
+   class FunctionTask : public ThreadPoolTask
+   {
+   public:
+
+      FunctionTask( TaskGroup& group, const F& f ) :
+         ThreadPoolTask( group ),
+         m_function( f )
+      {
+      }
+
+      void Execute() override
+      {
+         m_function();
+      }
+
+   private:
+
+      F m_function;
+   };
+
+   void Enqueue( ThreadPoolTask* );
+   void SetException( std::exception_ptr );
+   void ThrowException();
+
+   friend class PCL_ThreadPoolEngine;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class ThreadPool
+ * \brief Process-wide pool of persistent worker threads.
+ *
+ * %ThreadPool manages a fixed set of native worker threads that are created
+ * the first time the pool is used and live until the process (or module)
+ * terminates. Work is submitted to the pool through TaskGroup objects and the
+ * ParallelFor() algorithm, which avoids the cost of creating, starting and
+ * destroying execution threads for each parallel operation.
+ *
+ * Each worker owns a double-ended task queue. Workers execute tasks from the
+ * back of their own queues and, when idle, steal tasks from the front of
+ * other workers' queues, so load is balanced dynamically among all available
+ * processors.
+ *
+ * The pool creates Thread::MaxProcessors() workers, that is, one worker per
+ * logical processor allowed by the platform's global settings, or by the
+ * standalone configuration when running without core application support.
+ *
+ * Pool workers are native threads unknown to the PixInsight core
+ * application. Code executed by pool workers must not generate console
+ * output or interact with the graphical interface, and
+ * Thread::IsRootThread() always returns false for them. This is why pooled
+ * execution, both of Thread objects and of ParallelFor() work, is disabled
+ * by default; see ThreadPool::IsEnabled().
+ *
+ * \ingroup thread_support
+ */
+class PCL_CLASS ThreadPool
+{
+public:
+
+   /*!
+    * Default constructor. This constructor is disabled because %ThreadPool is
+    * not an instantiable class.
+    */
+   ThreadPool() = delete;
+
+   /*!
+    * Returns the number of worker threads in the process-wide pool. Calling
+    * this function creates the pool if it does not exist yet.
+    *
+    * If the maximum number of processors (see Thread::MaxProcessors()) has
+    * been increased since the pool was created, new workers are created as
+    * necessary before returning. Workers are never destroyed while the pool
+    * exists; when the maximum number of processors is reduced, ParallelFor()
+    * and its callers limit the number of concurrent tasks accordingly, and
+    * surplus workers remain idle.
+    */
+   static int NumberOfWorkers();
+
+   /*!
+    * Returns the zero-based index of the pool worker thread from which this
+    * function is called, or -1 if the calling thread is not a pool worker.
+    *
+    * Worker indices are in the range [0,NumberOfWorkers()-1]. Since the pool
+    * can grow at any time (see NumberOfWorkers()), arrays indexed by worker
+    * must be able to hold PCL_MAX_PROCESSORS elements. Worker indices can be
+    * used to select per-worker accumulators in reduction algorithms: a worker
+    * executes a single task at a time, so data indexed by
+    * CurrentWorkerIndex()+1 will never be accessed concurrently.
+    */
+   static int CurrentWorkerIndex();
+
+   /*!
+    * Returns true iff this function is called from a pool worker thread.
+    */
+   static bool IsWorkerThread()
+   {
+      return CurrentWorkerIndex() >= 0;
+   }
+
+   /*!
+    * Returns true iff execution of Thread objects on the pool is enabled.
+    *
+    * When this function returns true, AbstractImage::RunThreads() executes
+    * threads on pool workers, and ParallelFor() distributes its work among
+    * pool workers. Otherwise RunThreads() starts each thread as an
+    * independent execution thread by calling Thread::Start(), and
+    * ParallelFor() runs on transient threads created for each call, exactly
+    * as parallel code did before the pool existed. In both cases, code called
+    * from a pool worker thread always runs on the pool to prevent
+    * oversubscription.
+    *
+    * Pooled execution is disabled by default, since pool workers are not
+    * registered with the PixInsight core application: console output
+    * generated by pooled Thread objects is not shown, and
+    * Thread::IsRootThread() returns false for them. It can be safely enabled
+    * for code that does not depend on these features, and for standalone
+    * applications.
+    */
+   static bool IsEnabled();
+
+   /*!
+    * Enables or disables execution of Thread objects on the pool. See
+    * IsEnabled() for more information.
+    */
+   static void Enable( bool enable = true );
+
+   /*!
+    * Disables or enables execution of Thread objects on the pool. See
+    * IsEnabled() for more information.
+    */
+   static void Disable( bool disable = true )
+   {
+      Enable( !disable );
+   }
+
+   /*!
+    * Parallel for loop with dynamic load balancing.
+    *
+    * \param begin      First index of the range to be processed.
+    *
+    * \param end        End of the range. The range to be processed is
+    *                   [begin,end).
+    *
+    * \param body       Function object that will be called as
+    *                   <tt>body( i0, i1 )</tt>, where [i0,i1) is a nonempty
+    *                   subrange of [begin,end).
+    *
+    * \param grainSize  Number of indices processed by each call to \a body.
+    *                   If zero (the default value), the range is split into
+    *                   four chunks per thread.
+    *
+    * \param maxThreads Maximum number of threads that will run \a body
+    *                   concurrently, including the calling thread. This is
+    *                   normally the value returned by
+    *                   Thread::NumberOfThreads(), limited by the
+    *                   maxProcessors setting of a ParallelProcess object.
+    *
+    * The range is divided into chunks of \a grainSize indices. The calling
+    * thread and up to \a maxThreads-1 pool workers fetch chunks dynamically
+    * from a shared counter until the whole range has been processed, so
+    * nonuniform workloads, such as rows with very different processing costs,
+    * are distributed evenly among all threads.
+    *
+    * If pooled execution is disabled (see IsEnabled()) and this function is
+    * not called from a pool worker thread, the helper threads are transient
+    * Thread objects created for this call instead of pool workers.
+    *
+    * If \a body throws an exception, no more chunks are processed, and the
+    * first exception thrown is propagated to the caller once all running
+    * chunks have finished.
+    */
+   template <class F>
+   static void ParallelFor( size_type begin, size_type end, const F& body,
+                            size_type grainSize = 0, int maxThreads = PCL_MAX_PROCESSORS )
+   {
+      if ( end <= begin )
+         return;
+
+      bool pooled = IsEnabled() || IsWorkerThread();
+      size_type N = end - begin;
+      int numberOfThreads = (maxThreads > 1) ? Min( maxThreads, pooled ? NumberOfWorkers() : Thread::MaxProcessors() ) : 1;
+      if ( numberOfThreads < 2 || N < 2 )
+      {
+         body( begin, end );
+         return;
+      }
+
+      if ( grainSize == 0 )
+         grainSize = Max( size_type( 1 ), N/(4*size_type( numberOfThreads )) );
+      grainSize = Max( grainSize, (N + int_max - 1)/int_max );
+      int numberOfChunks = int( (N + grainSize - 1)/grainSize );
+      if ( numberOfChunks < 2 )
+      {
+         body( begin, end );
+         return;
+      }
+      numberOfThreads = Min( numberOfThreads, numberOfChunks );
+
+      AtomicInt nextChunk;
+      AtomicInt stop;
+      auto worker = [&]()
+      {
+         try
+         {
+            for ( int i; (i = nextChunk.FetchAndAdd( 1 )) < numberOfChunks && stop.Load() == 0; )
+            {
+               size_type i0 = begin + i*grainSize;
+               body( i0, Min( i0 + grainSize, end ) );
+            }
+         }
+         catch ( ... )
+         {
+            stop.Store( 1 );
+            throw;
+         }
+      };
+
+      if ( !pooled )
+      {
+         RunOnThreads( worker, numberOfThreads );
+         return;
+      }
+
+      TaskGroup group;
+      for ( int i = 1; i < numberOfThreads; ++i )
+         group.Run( worker );
+
+      try
+      {
+         worker();
+      }
+      catch ( ... )
+      {
+         group.Cancel();
+         try
+         {
+            group.Wait();
+         }
+         catch ( ... )
+         {
+         }
+         throw;
+      }
+
+      group.Wait();
+   }
+
+private:
+
+   template <class W>
+   class ParallelForThread : public Thread
+   {
+   public:
+
+      std::exception_ptr exception;
+
+      ParallelForThread( const W& worker ) :
+         m_worker( worker )
+      {
+      }
+
+      void Run() override
+      {
+         try
+         {
+            m_worker();
+         }
+         catch ( ... )
+         {
+            exception = std::current_exception();
+         }
+      }
+
+   private:
+
+      const W& m_worker;
+   };
+
+   /*
+    * Runs a ParallelFor() worker function on the calling thread and
+    * numberOfThreads-1 transient threads. Used when pooled execution is
+    * disabled.
+    */
+   template <class W>
+   static void RunOnThreads( const W& worker, int numberOfThreads )
+   {
+      ReferenceArray<ParallelForThread<W> > threads;
+      for ( int i = 1; i < numberOfThreads; ++i )
+         threads.Add( new ParallelForThread<W>( worker ) );
+      for ( ParallelForThread<W>& thread : threads )
+         thread.Start( ThreadPriority::DefaultMax );
+
+      std::exception_ptr exception;
+      try
+      {
+         worker();
+      }
+      catch ( ... )
+      {
+         exception = std::current_exception();
+      }
+
+      for ( ParallelForThread<W>& thread : threads )
+         thread.Wait();
+      if ( !exception )
+         for ( const ParallelForThread<W>& thread : threads )
+            if ( thread.exception )
+            {
+               exception = thread.exception;
+               break;
+            }
+      threads.Destroy();
+
+      if ( exception )
+         std::rethrow_exception( exception );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __PCL_ThreadPool_h
+
+// ----------------------------------------------------------------------------
+// EOF pcl/ThreadPool.h - Released 2019-01-21T12:06:07Z
@@ -270,6 +270,25 @@ public:
     */
    constexpr static fsize_type DefaultMaxBlockInlineSize = 3072; // 3072*4/3 = 4096 (base64)
 
+   /*!
+    * Default size in bytes of a compression subblock. When compression
+    * subblocks are enabled (see XISFOptions::compressionSubblocks), compressed
+    * blocks are divided into subblocks of this size, which allows for
+    * parallel compression and for incremental reads that only uncompress the
+    * subblocks covering the requested data. Compressed streamed images are
+    * always written by subblocks of this size.
+    */
+   constexpr static fsize_type DefaultCompressionSubblockSize = 1024*1024;
+
+   /*!
+    * Minimum size in bytes of an image written incrementally for streamed
+    * output. Images of this size or larger created with
+    * XISFWriter::CreateImage() are written directly to the output file as
+    * pixel samples are received, instead of being held in memory until the
+    * image is closed.
+    */
+   constexpr static fsize_type MinStreamedImageSize = 64*1024*1024;
+
    /*!
     * Maximum allowed width or height of an %XISF image thumbnail in pixels.
     */
@@ -297,6 +316,14 @@ public:
     */
    constexpr static int MaxCompressionLevel = 100;
 
+   /*!
+    * Whether compressed blocks are divided into subblocks of
+    * DefaultCompressionSubblockSize bytes by default. This is false by
+    * default: each compressed block is stored as a single subblock, unless
+    * its size exceeds the maximum block size supported by the codec.
+    */
+   constexpr static bool DefaultCompressionSubblocks = false;
+
    /*!
     * The default verbosity level: 0=quiet, 1=normal, 2=quite, >2=very.
     */
@@ -367,11 +394,14 @@ public:
 
    static const fsize_type DefaultBlockAlignSize;
    static const fsize_type DefaultMaxBlockInlineSize;
+   static const fsize_type DefaultCompressionSubblockSize;
+   static const fsize_type MinStreamedImageSize;
    static const int MaxThumbnailSize;
    static const block_checksum DefaultChecksum;
    static const block_compression DefaultCompression;
    static const int DefaultCompressionLevel;
    static const int MaxCompressionLevel;
+   static const bool DefaultCompressionSubblocks;
    static const int DefaultVerbosity;
    static const double DefaultOutputLowerBound;
    static const double DefaultOutputUpperBound;
@@ -636,6 +666,7 @@ public:
    XISF::block_checksum    checksumAlgorithm  : 4;  //!< The algorithm used for block checksum calculations.
    XISF::block_compression compressionCodec   : 4;  //!< The codec used for compression of %XISF blocks.
    uint8                   compressionLevel   : 7;  //!< Codec-independent compression level: 0 = auto, 1 = fast, 100 = maximum compression.
+   bool                    compressionSubblocks : 1; //!< Divide compressed blocks into subblocks of XISF::DefaultCompressionSubblockSize bytes.
    uint8                   verbosity          : 3;  //!< Verbosity level: 0 = quiet, > 0 = write console state messages.
    uint16                  blockAlignmentSize;      //!< Block alignment size in bytes (0 = 1 = unaligned).
    uint16                  maxInlineBlockSize;      //!< Maximum size in bytes of an inline/embedded block.
@@ -676,6 +707,7 @@ public:
       checksumAlgorithm  = XISF::DefaultChecksum;
       compressionCodec   = XISF::DefaultCompression;
       compressionLevel   = XISF::DefaultCompressionLevel;
+      compressionSubblocks = XISF::DefaultCompressionSubblocks;
       verbosity          = XISF::DefaultVerbosity;
       blockAlignmentSize = XISF::DefaultBlockAlignSize;
       maxInlineBlockSize = XISF::DefaultMaxBlockInlineSize;
@@ -1509,6 +1541,12 @@ public:
     *
     * The data type and other image parameters are defined by the current set
     * of format-independent options (see SetImageOptions()).
+    *
+    * Images of XISF::MinStreamedImageSize bytes or larger are streamed: pixel
+    * samples are written directly to the output file by WriteSamples(), so
+    * memory usage does not depend on image dimensions. Compressed streamed
+    * images are compressed by subblocks when the image is closed. The %XML
+    * header is completed when the output stream is closed.
     */
    void CreateImage( const ImageInfo& info );
 
@@ -73,6 +73,7 @@ namespace pcl
 
 class PCL_CLASS XMLDocument;
 class PCL_CLASS XMLElement;
+class XMLDocumentBuilder;
 
 // ----------------------------------------------------------------------------
 
@@ -2410,6 +2411,767 @@ typedef Flags<XMLParserOption::mask_type>  XMLParserOptions;
 
 // ----------------------------------------------------------------------------
 
+/*!
+ * \class XMLStringView
+ * \brief Read-only view of a fragment of a UTF-8 encoded %XML document
+ *
+ * %XMLStringView is a pair of pointers to a contiguous sequence of UTF-8 code
+ * units in a text buffer owned by the caller of XMLSAXParser::Parse(). Views
+ * are generated by the parser without allocating or copying any data. A view
+ * is only valid while the parsed buffer exists and remains unmodified.
+ *
+ * Views transport raw document text: %XML references are not decoded and
+ * spaces are not normalized. Use the ToString() member function to obtain
+ * decoded text, or work directly on the raw UTF-8 code units for maximum
+ * performance, for example to decode numeric lists or Base64 encoded data.
+ *
+ * \ingroup xml_parsing_and_generation
+ * \sa XMLSAXParser
+ */
+class PCL_CLASS XMLStringView
+{
+public:
+
+   /*!
+    * Represents an immutable iterator on a string view.
+    */
+   typedef const char*  const_iterator;
+
+   /*!
+    * Default constructor. Constructs an empty string view.
+    */
+   XMLStringView() = default;
+
+   /*!
+    * Constructs a view of the range [i,j) of UTF-8 code units.
+    */
+   XMLStringView( const_iterator i, const_iterator j ) :
+      m_begin( i ), m_end( j )
+   {
+   }
+
+   /*!
+    * Copy constructor.
+    */
+   XMLStringView( const XMLStringView& ) = default;
+
+   /*!
+    * Copy assignment operator. Returns a reference to this object.
+    */
+   XMLStringView& operator =( const XMLStringView& ) = default;
+
+   /*!
+    * Returns an iterator located at the first UTF-8 code unit of this view.
+    */
+   const_iterator Begin() const
+   {
+      return m_begin;
+   }
+
+   /*!
+    * Returns an iterator located at the end of this view.
+    */
+   const_iterator End() const
+   {
+      return m_end;
+   }
+
+   /*!
+    * Returns the length of this view in UTF-8 code units (bytes).
+    */
+   size_type Length() const
+   {
+      return size_type( m_end - m_begin );
+   }
+
+   /*!
+    * Returns true iff this is an empty view.
+    */
+   bool IsEmpty() const
+   {
+      return m_end == m_begin;
+   }
+
+   /*!
+    * Returns true iff this view is equal to the specified null-terminated
+    * string \a s, which is compared as a sequence of UTF-8 code units.
+    */
+   bool operator ==( const char* s ) const
+   {
+      for ( const_iterator i = m_begin; i < m_end; ++i, ++s )
+         if ( *i != *s || *s == '\0' )
+            return false;
+      return *s == '\0';
+   }
+
+   /*!
+    * Returns true iff this view is not equal to the specified null-terminated
+    * string \a s.
+    */
+   bool operator !=( const char* s ) const
+   {
+      return !operator ==( s );
+   }
+
+   /*!
+    * Returns true iff this view and the specified view \a v represent equal
+    * sequences of UTF-8 code units.
+    */
+   bool operator ==( const XMLStringView& v ) const
+   {
+      if ( Length() != v.Length() )
+         return false;
+      for ( const_iterator i = m_begin, j = v.m_begin; i < m_end; ++i, ++j )
+         if ( *i != *j )
+            return false;
+      return true;
+   }
+
+   /*!
+    * Returns true iff this view and the specified view \a v represent
+    * different sequences of UTF-8 code units.
+    */
+   bool operator !=( const XMLStringView& v ) const
+   {
+      return !operator ==( v );
+   }
+
+   /*!
+    * Returns a view of this text fragment with all leading and trailing %XML
+    * space characters removed.
+    */
+   XMLStringView Trimmed() const
+   {
+      const_iterator i = m_begin, j = m_end;
+      for ( ; i < j && XML::IsSpaceChar( *i ); ++i ) {}
+      for ( ; j > i && XML::IsSpaceChar( *(j-1) ); --j ) {}
+      return XMLStringView( i, j );
+   }
+
+   /*!
+    * Returns a copy of the UTF-8 code units in this view, without any
+    * decoding or transformation.
+    */
+   IsoString ToIsoString() const
+   {
+      return IsoString( m_begin, m_end );
+   }
+
+   /*!
+    * Returns this text fragment converted to UTF-16, without decoding %XML
+    * references.
+    */
+   String ToString() const;
+
+   /*!
+    * Returns this text fragment converted to UTF-16, with all %XML entity and
+    * character references replaced with their corresponding characters.
+    */
+   String DecodedText() const;
+
+   /*!
+    * Returns this text fragment interpreted as an attribute value, in the
+    * same way as done by XMLAttributeList::Parse(): leading and trailing
+    * spaces are removed, %XML references are decoded, and sequences of space
+    * characters are replaced with single white spaces.
+    */
+   String ToAttributeValue() const;
+
+   /*!
+    * STL-compatible iteration. Equivalent to Begin() const.
+    */
+   const_iterator begin() const
+   {
+      return Begin();
+   }
+
+   /*!
+    * STL-compatible iteration. Equivalent to End() const.
+    */
+   const_iterator end() const
+   {
+      return End();
+   }
+
+private:
+
+   const_iterator m_begin = nullptr;
+   const_iterator m_end = nullptr;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct XMLSAXAttribute
+ * \brief An element attribute reported by XMLSAXParser
+ * \ingroup xml_parsing_and_generation
+ */
+struct PCL_CLASS XMLSAXAttribute
+{
+   XMLStringView name;  //!< The qualified attribute name.
+   XMLStringView value; //!< The raw attribute value, excluding quotes.
+};
+
+/*!
+ * \class XMLSAXAttributeList
+ * \brief Read-only list of element attributes reported by XMLSAXParser
+ *
+ * Attribute lists are stored in a buffer owned by the parser, which is reused
+ * for all start-tags in a document. An %XMLSAXAttributeList object is only
+ * valid during the XMLSAXParser::StartElement() call that receives it.
+ *
+ * \ingroup xml_parsing_and_generation
+ */
+class PCL_CLASS XMLSAXAttributeList
+{
+public:
+
+   /*!
+    * Represents an immutable attribute list iterator.
+    */
+   typedef const XMLSAXAttribute*  const_iterator;
+
+   /*!
+    * Constructs a list of \a n attributes stored at the specified location.
+    */
+   XMLSAXAttributeList( const_iterator attributes, size_type n ) :
+      m_begin( attributes ), m_end( attributes + n )
+   {
+   }
+
+   /*!
+    * Returns the number of attributes in this list.
+    */
+   size_type Length() const
+   {
+      return size_type( m_end - m_begin );
+   }
+
+   /*!
+    * Returns true iff this list is empty.
+    */
+   bool IsEmpty() const
+   {
+      return m_end == m_begin;
+   }
+
+   /*!
+    * Returns an iterator located at the first attribute in this list.
+    */
+   const_iterator Begin() const
+   {
+      return m_begin;
+   }
+
+   /*!
+    * Returns an iterator located at the end of this list.
+    */
+   const_iterator End() const
+   {
+      return m_end;
+   }
+
+   /*!
+    * Returns a pointer to the attribute with the specified \a name, or
+    * nullptr if no such attribute exists in this list.
+    */
+   const XMLSAXAttribute* Find( const char* name ) const
+   {
+      for ( const_iterator i = m_begin; i < m_end; ++i )
+         if ( i->name == name )
+            return i;
+      return nullptr;
+   }
+
+   /*!
+    * Returns true iff this list contains an attribute with the specified
+    * \a name.
+    */
+   bool HasAttribute( const char* name ) const
+   {
+      return Find( name ) != nullptr;
+   }
+
+   /*!
+    * Returns the raw value of the attribute with the specified \a name, or an
+    * empty view if no such attribute exists in this list.
+    */
+   XMLStringView RawValue( const char* name ) const
+   {
+      const XMLSAXAttribute* a = Find( name );
+      return (a != nullptr) ? a->value : XMLStringView();
+   }
+
+   /*!
+    * Returns the value of the attribute with the specified \a name, decoded
+    * and normalized as described in XMLStringView::ToAttributeValue(). Returns
+    * an empty string if no such attribute exists in this list.
+    */
+   String AttributeValue( const char* name ) const
+   {
+      const XMLSAXAttribute* a = Find( name );
+      return (a != nullptr) ? a->value.ToAttributeValue() : String();
+   }
+
+   /*!
+    * Returns a new XMLAttributeList object with decoded copies of all the
+    * attributes in this list.
+    */
+   XMLAttributeList ToAttributeList() const;
+
+   /*!
+    * STL-compatible iteration. Equivalent to Begin() const.
+    */
+   const_iterator begin() const
+   {
+      return Begin();
+   }
+
+   /*!
+    * STL-compatible iteration. Equivalent to End() const.
+    */
+   const_iterator end() const
+   {
+      return End();
+   }
+
+private:
+
+   const_iterator m_begin;
+   const_iterator m_end;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class XMLSAXParser
+ * \brief Event-driven parser of UTF-8 encoded %XML documents
+ *
+ * %XMLSAXParser reads a well-formed %XML document directly from a UTF-8
+ * encoded text buffer and reports its components to a set of virtual member
+ * functions, in document order, without building a document object model.
+ * Reported element names, attributes and text are XMLStringView objects that
+ * point into the source buffer, so no memory is allocated for them. Element
+ * attributes are stored in an internal buffer that is reused for all
+ * start-tags in the document.
+ *
+ * Derived classes reimplement the StartElement(), EndElement(), Characters()
+ * and other event handlers to extract the information they need. Compared to
+ * XMLDocument, this avoids the conversion of the whole document to UTF-16 and
+ * the generation of a node tree that is usually visited only once. This is
+ * particularly important for large documents where most of the data are
+ * stored as long text nodes, such as Base64 encoded binary data or lists of
+ * numeric values, which can be decoded by event handlers directly from the
+ * source buffer.
+ *
+ * For valid UTF-8 text, this parser accepts the same documents as
+ * XMLDocument::Parse(), and reports syntax errors with the same messages and
+ * text locations: errors in markup are located at the '<' delimiter of the
+ * offending tag. Text locations count UTF-16 code units, as in %XMLDocument,
+ * not bytes. The XMLParserOption::IgnoreComments,
+ * XMLParserOption::IgnoreUnknownElements and
+ * XMLParserOption::IgnoreStrayCharacters options are supported. The
+ * XMLParserOption::NormalizeTextSpaces option is ignored because text is
+ * always reported without transformations.
+ *
+ * Exceptions thrown by event handlers abort the parsing process and are
+ * propagated to the caller of Parse().
+ *
+ * \ingroup xml_parsing_and_generation
+ * \sa XMLDocument
+ */
+class PCL_CLASS XMLSAXParser
+{
+public:
+
+   /*!
+    * Default constructor.
+    */
+   XMLSAXParser() = default;
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~XMLSAXParser()
+   {
+   }
+
+   /*!
+    * Copy constructor. This constructor is disabled because parsers are
+    * unique objects.
+    */
+   XMLSAXParser( const XMLSAXParser& ) = delete;
+
+   /*!
+    * Copy assignment. This operator is disabled because parsers are unique
+    * objects.
+    */
+   XMLSAXParser& operator =( const XMLSAXParser& ) = delete;
+
+   /*!
+    * Returns the current set of parser options.
+    */
+   XMLParserOptions ParserOptions() const
+   {
+      return m_parserOptions;
+   }
+
+   /*!
+    * Sets a parser option. See XMLParserOption for the available options.
+    */
+   void SetParserOption( XMLParserOption::mask_type option, bool on = true )
+   {
+      m_parserOptions.SetFlag( option, on );
+   }
+
+   /*!
+    * Sets the specified parser \a options.
+    */
+   void SetParserOptions( XMLParserOptions options )
+   {
+      m_parserOptions = options;
+   }
+
+   /*!
+    * Resets all parser options.
+    */
+   void ClearParserOptions()
+   {
+      m_parserOptions.Clear();
+   }
+
+   /*!
+    * Parses the %XML document stored as a sequence of UTF-8 code units in the
+    * range [begin,end). A leading UTF-8 byte order mark is ignored.
+    *
+    * The source buffer must remain valid and unmodified until this function
+    * returns. Throws an XMLParseError exception if the document is not
+    * well-formed.
+    */
+   void Parse( const char* begin, const char* end );
+
+   /*!
+    * Parses the %XML document stored in the specified UTF-8 encoded \a text.
+    */
+   void Parse( const IsoString& text )
+   {
+      Parse( text.Begin(), text.End() );
+   }
+
+   /*!
+    * Returns the location in the source document of the component being
+    * reported by the current event handler. This is the location of the '<'
+    * delimiter for markup, and the end of the text for character data, as for
+    * the nodes generated by XMLDocument::Parse(). This function can also be
+    * called from an exception handler after Parse() has thrown an exception.
+    *
+    * Text locations are computed on demand, so calling this function has no
+    * cost for documents parsed without errors or warnings.
+    */
+   XMLNodeLocation Location() const;
+
+   /*!
+    * Returns the number of currently open elements. Within StartElement() and
+    * EndElement(), the reported element is included in the returned value.
+    */
+   int Depth() const
+   {
+      return m_depth;
+   }
+
+protected:
+
+   /*!
+    * Called for each start-tag and empty-element tag in the document.
+    *
+    * \param name       The qualified name of the element.
+    *
+    * \param attributes The list of element attributes. This object, and the
+    *                   views that it transports, are only valid during this
+    *                   function call.
+    *
+    * The default implementation does nothing.
+    */
+   virtual void StartElement( const XMLStringView& name, const XMLSAXAttributeList& attributes )
+   {
+   }
+
+   /*!
+    * Called for each end-tag and empty-element tag in the document. The
+    * default implementation does nothing.
+    */
+   virtual void EndElement( const XMLStringView& name )
+   {
+   }
+
+   /*!
+    * Called for each contiguous sequence of character data within an
+    * element. Character data may be split into several calls by comments,
+    * CDATA sections or processing instructions, and can be formed exclusively
+    * by space characters. %XML references are not decoded. The default
+    * implementation does nothing.
+    */
+   virtual void Characters( const XMLStringView& text )
+   {
+   }
+
+   /*!
+    * Called for each CDATA section. The default implementation does nothing.
+    */
+   virtual void CDATASection( const XMLStringView& data )
+   {
+   }
+
+   /*!
+    * Called for each comment, unless the XMLParserOption::IgnoreComments
+    * option is enabled. The default implementation does nothing.
+    */
+   virtual void Comment( const XMLStringView& comment )
+   {
+   }
+
+   /*!
+    * Called for each processing instructions tag, excluding the %XML
+    * declaration. The default implementation does nothing.
+    */
+   virtual void ProcessingInstructions( const XMLStringView& target, const XMLStringView& instructions )
+   {
+   }
+
+   /*!
+    * Called for each unknown special element (a tag starting with "<!" which
+    * is not a comment, CDATA section or DOCTYPE declaration), unless the
+    * XMLParserOption::IgnoreUnknownElements option is enabled. The default
+    * implementation does nothing.
+    */
+   virtual void UnknownElement( const XMLStringView& name, const XMLStringView& parameters )
+   {
+   }
+
+   /*!
+    * Called for the %XML declaration, if present. The \a version and
+    * \a encoding views are raw attribute values; \a encoding is empty if not
+    * specified. The default implementation does nothing.
+    */
+   virtual void Declaration( const XMLStringView& version, const XMLStringView& encoding, bool standalone )
+   {
+   }
+
+   /*!
+    * Called for the document type declaration, if present. The default
+    * implementation does nothing.
+    */
+   virtual void DocTypeDeclaration( const XMLStringView& name, const XMLStringView& definition )
+   {
+   }
+
+   /*!
+    * Skips the element being reported. This function can only be called from
+    * a reimplemented StartElement() function. The element and all of its
+    * contents will be parsed for well-formedness but not reported; the
+    * EndElement() function will not be called for the skipped element.
+    */
+   void SkipElement()
+   {
+      if ( m_skipDepth == 0 )
+         m_skipDepth = m_depth;
+   }
+
+private:
+
+   XMLParserOptions         m_parserOptions;
+   const char*              m_begin = nullptr;
+   const char*              m_end = nullptr;
+   const char*              m_pos = nullptr;
+   mutable const char*      m_locPos = nullptr;
+   mutable XMLNodeLocation  m_location;
+   Array<XMLStringView>     m_elements;
+   int                      m_depth = 0;
+   int                      m_skipDepth = 0;
+   Array<XMLSAXAttribute>   m_attributes;
+   size_type                m_attributeCount = 0;
+   bool                     m_hasRoot = false;
+   bool                     m_hasDeclaration = false;
+   bool                     m_hasDocType = false;
+
+   struct TagData
+   {
+      XMLStringView name;        // the tag name
+      XMLStringView parameters;  // tag contents after the name, trimmed
+      const char*   next;        // after the end-tag delimiter
+      bool          start : 1;   // true if this is a start-tag
+      bool          end   : 1;   // true if this is an end-tag or empty element
+      bool          PI    : 1;   // true if this is a processing instructions tag
+   };
+
+   TagData ParseTag( const char* p );
+   void ParseAttributes( const XMLStringView& text );
+   const char* ParseElementTag( const char* p );
+   const char* ParseSpecialTag( const char* p );
+   const char* ParseProcessingInstructions( const char* p );
+   void PushElement( const XMLStringView& name );
+   void PopElement( const XMLStringView& name );
+   void SyntaxError( const String& message );
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class XMLSAXDecoder
+ * \brief Base class of event-driven decoders of structured %XML documents
+ *
+ * %XMLSAXDecoder implements the scaffolding shared by %XML decoders of data
+ * files based on XMLSAXParser, such as the decoders of drizzle data (.xdrz)
+ * and local normalization data (.xnml) files. These documents have a root
+ * element whose children are independent data items. Errors found while
+ * decoding a child element of the root element are shown on the console and
+ * the rest of that child element is ignored; decoding continues with the
+ * next child of the root element.
+ *
+ * Derived classes reimplement StartRootElement(), StartDecodedElement() and
+ * EndDecodedElement(). Elements whose contents are text call StartText()
+ * from StartDecodedElement(), and get their accumulated contents with Text()
+ * from EndDecodedElement(). Unexpected text, CDATA sections and processing
+ * instructions generate warning messages.
+ *
+ * Comments and unknown special elements are always ignored.
+ *
+ * \ingroup xml_parsing_and_generation
+ * \sa XMLSAXParser
+ */
+class PCL_CLASS XMLSAXDecoder : public XMLSAXParser
+{
+public:
+
+   /*!
+    * Default constructor.
+    */
+   XMLSAXDecoder()
+   {
+      SetParserOption( XMLParserOption::IgnoreComments );
+      SetParserOption( XMLParserOption::IgnoreUnknownElements );
+   }
+
+   /*!
+    * Virtual destructor.
+    */
+   virtual ~XMLSAXDecoder()
+   {
+   }
+
+protected:
+
+   /*!
+    * Called for the root element of the document. Reimplementations should
+    * throw an exception if the root element is not valid. The default
+    * implementation does nothing.
+    */
+   virtual void StartRootElement( const XMLStringView& name, const XMLSAXAttributeList& attributes )
+   {
+   }
+
+   /*!
+    * Called for each descendant element of the root element that is not
+    * being skipped. Exceptions thrown by this function are shown as errors,
+    * and the element is skipped.
+    */
+   virtual void StartDecodedElement( const XMLStringView& name, const XMLSAXAttributeList& attributes ) = 0;
+
+   /*!
+    * Called at the end of each descendant element of the root element that
+    * has not been skipped or failed. Exceptions thrown by this function are
+    * shown as errors.
+    */
+   virtual void EndDecodedElement( const XMLStringView& name ) = 0;
+
+   /*!
+    * Returns the name of the element being reported for diagnostic messages.
+    * The default implementation returns the name of the current child element
+    * of the root element.
+    */
+   virtual String ParentElementName() const
+   {
+      return m_elementName;
+   }
+
+   /*!
+    * Starts accumulating the character data of the current element, which
+    * will be available through Text().
+    */
+   void StartText()
+   {
+      m_textDepth = Depth();
+      m_textView = XMLStringView();
+      m_textBuffer.Clear();
+   }
+
+   /*!
+    * Returns the character data accumulated since the last call to
+    * StartText(). Character data split by comments or other nodes are joined
+    * in an internal buffer; otherwise the returned view points to the source
+    * document.
+    */
+   XMLStringView Text() const
+   {
+      return m_textBuffer.IsEmpty() ? m_textView : XMLStringView( m_textBuffer.Begin(), m_textBuffer.End() );
+   }
+
+   /*!
+    * Decodes the specified Base64 encoded \a text, ignoring leading and
+    * trailing spaces.
+    */
+   static ByteArray DecodeBase64( const XMLStringView& text )
+   {
+      XMLStringView data = text.Trimmed();
+      return IsoString( data.Begin(), data.End() ).FromBase64();
+   }
+
+   /*!
+    * Returns the name of the current child element of the root element.
+    */
+   const String& ElementName() const
+   {
+      return m_elementName;
+   }
+
+   /*!
+    * Shows an error message on the console for an exception thrown while
+    * decoding the current child element of the root element. As in
+    * XMLDocument-based decoders, the error is located at the start tag of
+    * the child element of the root element.
+    */
+   void ShowError( const Exception& x ) const;
+
+   /*!
+    * Shows a warning message on the console for an unexpected child node of
+    * the specified type.
+    */
+   void WarnOnUnexpectedChildNode( const String& nodeType ) const;
+
+   /*!
+    * Shows a warning message on the console and skips the specified unknown
+    * element, child of \a parsingWhatElement.
+    */
+   void SkipUnknownElement( const XMLStringView& name, const String& parsingWhatElement );
+
+   void StartElement( const XMLStringView& name, const XMLSAXAttributeList& attributes ) override;
+   void EndElement( const XMLStringView& name ) override;
+   void Characters( const XMLStringView& text ) override;
+   void CDATASection( const XMLStringView& data ) override;
+   void ProcessingInstructions( const XMLStringView& target, const XMLStringView& instructions ) override;
+
+private:
+
+   String          m_elementName;     // current child element of the root element
+   XMLNodeLocation m_elementLocation; // start tag location of m_elementName
+   bool            m_failed = false;  // skip the rest of the current child of the root element
+   int             m_textDepth = 0;   // depth of the current text element, 0 if none
+   XMLStringView   m_textView;
+   IsoString       m_textBuffer;      // used only for fragmented text
+};
+
+// ----------------------------------------------------------------------------
+
 /*!
  * \class XMLDocument
  * \brief %XML document parsing and generation
@@ -2813,6 +3575,25 @@ public:
     */
    void Parse( const String& text );
 
+   /*!
+    * %XML document parser. Reads and interprets the specified \a text, which
+    * must be encoded in UTF-8, as a well-formed %XML document.
+    *
+    * This function generates the same document object model as Parse(), but
+    * parses the source document directly in its UTF-8 encoding with an
+    * XMLSAXParser object. This avoids a conversion of the whole document to
+    * UTF-16, and all data stored in the source document are only converted
+    * once as they are stored in the generated nodes. This function is
+    * considerably faster than Parse( text.UTF8ToUTF16() ), especially for
+    * large documents, and should be preferred to parse UTF-8 encoded files.
+    *
+    * Syntax errors are reported with the same messages and locations as
+    * Parse(). The only exception is when an element filter has been set
+    * (see SetElementFilter()): this function still checks elements rejected
+    * by the filter for well-formedness, while Parse() does not.
+    */
+   void ParseUTF8( const IsoString& text );
+
    /*!
     * Returns true iff the auto-formatting feature is enabled for %XML
     * serialization with this %XMLDocument object.
@@ -2964,6 +3745,8 @@ private:
    bool                  m_autoFormatting : 1;
    bool                  m_indentTabs     : 1;
    unsigned              m_indentSize     : 4;
+
+   friend class XMLDocumentBuilder;
 };
 
 // ----------------------------------------------------------------------------
@@ -56,6 +56,7 @@
 # include <pcl/AutoLock.h>
 #endif
 #include <pcl/Console.h>
+#include <pcl/EndianConversions.h>
 #include <pcl/ErrorHandler.h>
 #include <pcl/ICCProfile.h>
 #include <pcl/MetaModule.h>
@@ -118,6 +119,7 @@ struct FITSFileData
 {
    void* fits         = nullptr; // CFITSIO's ::fitsfile*
    mutable int status = 0;       // CFITSIO's persistent error code
+   File  file;                   // direct access to uncompressed data units
 
    FITSFileData() = default;
 
@@ -145,6 +147,9 @@ struct FITSHDUData
    double                     zeroOffset       = 0;           // BZERO
    double                     scaleRange       = 1;           // BSCALE
    bool                       signedIsPhysical = false;       // signed integer values store physical pixel data
+   fpos_type                  dataOffset       = -1;          // file position of the raw data unit, < 0 if not directly readable
+   double                     bzero            = 0;           // physical = bzero + bscale*raw (integer data only)
+   double                     bscale           = 1;
    IsoString                  iccExtName;                     // name of ICC profile extension
    IsoString                  thumbExtName;                   // name of thumbnail image extension
 };
@@ -194,10 +199,136 @@ struct FITSReaderData
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Raw FITS sample values, as stored in uncompressed data units (big-endian
+ * byte order), for each supported BITPIX value.
+ */
+template <typename T> inline T FITSFromBigEndian( T x )
+{
+   return IsLittleEndianMachine() ? BigToLittleEndian( x ) : x;
+}
+
+template <int bitpix> struct FITSRawSample;
+
+template <> struct FITSRawSample<BYTE_IMG>
+{
+   typedef uint8  raw;
+   static double Value( raw x ) { return x; }
+};
+
+template <> struct FITSRawSample<SHORT_IMG>
+{
+   typedef uint16 raw;
+   static double Value( raw x ) { return int16( FITSFromBigEndian( x ) ); }
+};
+
+template <> struct FITSRawSample<LONG_IMG>
+{
+   typedef uint32 raw;
+   static double Value( raw x ) { return int32( FITSFromBigEndian( x ) ); }
+};
+
+template <> struct FITSRawSample<FLOAT_IMG>
+{
+   typedef uint32 raw;
+   static double Value( raw x ) { union { uint32 u; float f; } v; v.u = FITSFromBigEndian( x ); return v.f; }
+};
+
+template <> struct FITSRawSample<DOUBLE_IMG>
+{
+   typedef uint64 raw;
+   static double Value( raw x ) { union { uint64 u; double d; } v; v.u = FITSFromBigEndian( x ); return v.d; }
+};
+
+// ----------------------------------------------------------------------------
+
 class FITSReaderPrivate
 {
 public:
 
+   /*
+    * Uncompressed image data units are read directly from the file in strips
+    * of at most this size, bypassing CFITSIO.
+    */
+   constexpr static size_type DirectReadStripSize = 4*1024*1024;
+
+   /*
+    * Transforms n raw samples of an uncompressed data unit to the target
+    * sample type in a single pass: byte order conversion, BZERO/BSCALE
+    * scaling, cleanup of non-finite values, optional truncation of negative
+    * values, and rescaling. The result is identical to reading with
+    * fits_read_pix( TDOUBLE ) and then converting the 64-bit floating point
+    * values, as done for data read through CFITSIO.
+    */
+   template <class P, int bitpix, bool scaled, bool truncate, bool rescale>
+   static void DirectConvert( typename P::sample* f, const void* data, size_type n,
+                              const FITSHDUData& hdu, double k )
+   {
+      typedef FITSRawSample<bitpix> S;
+      const typename S::raw* r = reinterpret_cast<const typename S::raw*>( data );
+      const double z = hdu.zeroOffset;
+      const double m = P::MinSampleValue();
+      for ( size_type i = 0; i < n; ++i )
+      {
+         double v = S::Value( r[i] );
+         if ( bitpix < 0 )
+         {
+            if ( !IsFinite( v ) )
+               v = 0;
+         }
+         else if ( scaled )
+            v = hdu.bzero + hdu.bscale*v;
+         if ( truncate )
+            if ( v < 0 )
+               v = 0;
+         f[i] = rescale ? P::FloatToSample( k*(v - z) + m ) : typename P::sample( v );
+      }
+   }
+
+   template <class P, int bitpix>
+   static void DirectConvert( typename P::sample* f, const void* data, size_type n,
+                              const FITSHDUData& hdu, bool rescale, double k )
+   {
+      // Resolve loop invariants at compile time to allow vectorization.
+      bool scaled = bitpix > 0 && (hdu.bzero != 0 || hdu.bscale != 1);
+      switch ( (scaled ? 4 : 0) | (hdu.signedIsPhysical ? 2 : 0) | (rescale ? 1 : 0) )
+      {
+      case 0: DirectConvert<P, bitpix, false, false, false>( f, data, n, hdu, k ); break;
+      case 1: DirectConvert<P, bitpix, false, false,  true>( f, data, n, hdu, k ); break;
+      case 2: DirectConvert<P, bitpix, false,  true, false>( f, data, n, hdu, k ); break;
+      case 3: DirectConvert<P, bitpix, false,  true,  true>( f, data, n, hdu, k ); break;
+      case 4: DirectConvert<P, bitpix,  true, false, false>( f, data, n, hdu, k ); break;
+      case 5: DirectConvert<P, bitpix,  true, false,  true>( f, data, n, hdu, k ); break;
+      case 6: DirectConvert<P, bitpix,  true,  true, false>( f, data, n, hdu, k ); break;
+      case 7: DirectConvert<P, bitpix,  true,  true,  true>( f, data, n, hdu, k ); break;
+      }
+   }
+
+   template <class P>
+   static void DirectConvert( typename P::sample* f, const void* data, size_type n,
+                              const FITSHDUData& hdu, bool rescale, double k )
+   {
+      switch ( hdu.bitpix )
+      {
+      case BYTE_IMG:   DirectConvert<P, BYTE_IMG>( f, data, n, hdu, rescale, k ); break;
+      case SHORT_IMG:  DirectConvert<P, SHORT_IMG>( f, data, n, hdu, rescale, k ); break;
+      case LONG_IMG:   DirectConvert<P, LONG_IMG>( f, data, n, hdu, rescale, k ); break;
+      case FLOAT_IMG:  DirectConvert<P, FLOAT_IMG>( f, data, n, hdu, rescale, k ); break;
+      case DOUBLE_IMG: DirectConvert<P, DOUBLE_IMG>( f, data, n, hdu, rescale, k ); break;
+      }
+   }
+
+   /*
+    * Reads size bytes of the data unit of the specified HDU, starting at the
+    * specified sample index.
+    */
+   static void DirectRead( void* data, const FITSHDUData& hdu, fsize_type index, fsize_type size, FITSReader& reader )
+   {
+      File& file = reader.m_fileData->file;
+      file.SetPosition( hdu.dataOffset + index*(Abs( hdu.bitpix ) >> 3) );
+      file.Read( data, size );
+   }
+
    template <class P> inline
    static void ReadImage( GenericImage<P>& image, FITSReader& reader )
    {
@@ -225,14 +356,18 @@ public:
 
       try
       {
-         // Restore CFITSIO's current HDU to the current image HDU.
+         // Restore CFITSIO's current HDU to the current image HDU, unless we
+         // can read pixels directly.
          // N.B.: CFITSIO expects HDU numbers relative to 1.
+         if ( hdu.dataOffset < 0 )
          {
-            CFITSIO_LOCK
-            ::fits_movabs_hdu( fits_handle, hdu.hduNumber+1, 0, &fitsStatus );
+            {
+               CFITSIO_LOCK
+               ::fits_movabs_hdu( fits_handle, hdu.hduNumber+1, 0, &fitsStatus );
+            }
+            if ( fitsStatus != 0 )
+               throw FITS::UnableToAccessCurrentHDU( reader.m_path );
          }
-         if ( fitsStatus != 0 )
-            throw FITS::UnableToAccessCurrentHDU( reader.m_path );
 
          // Allocate pixel data.
          // Don't trust info fields since they are publicly accessible.
@@ -256,11 +391,6 @@ public:
                   image.NumberOfSamples() );
          }
 
-         // To support 32-bit integer samples and to provide for arbitrary integer
-         // format output, we'll ask FITSIO to store 64-bit floating point pixel
-         // values in a temporary row buffer.
-         F64Vector buffer( image.Width() );
-
          // A rescaling operation is required for integer sample values if the
          // source data type (as provided by FITSIO, i.e taking BZERO into account)
          // doesn't match the target image's sample type.
@@ -269,6 +399,37 @@ public:
          if ( rescalingRequired )
             k = (double( P::MaxSampleValue() ) - P::MinSampleValue())/(hdu.scaleRange - hdu.zeroOffset);
 
+         // Uncompressed data unit: read strips of raw pixel rows and transform
+         // them directly to the target sample type.
+         if ( hdu.dataOffset >= 0 )
+         {
+            size_type rowSize = size_type( image.Width() )*(Abs( hdu.bitpix ) >> 3);
+            int stripRows = Range( int( DirectReadStripSize/rowSize ), 1, image.Height() );
+            ByteArray buffer( stripRows*rowSize );
+
+            for ( int c = 0; c < image.NumberOfChannels(); ++c )
+               for ( int i = 0; i < image.Height(); i += stripRows )
+               {
+                  int n = Min( stripRows, image.Height() - i );
+                  DirectRead( buffer.Begin(), hdu, (fsize_type( c )*image.Height() + i)*image.Width(), n*rowSize, reader );
+
+                  // Mirror pixel rows vertically if we are loading with bottom-up orientation.
+                  for ( int r = 0; r < n; ++r )
+                     DirectConvert<P>( image.ScanLine( reader.FITSOptions().bottomUp ? image.Height()-(i+r)-1 : i+r, c ),
+                                       buffer.At( r*rowSize ), image.Width(), hdu, rescalingRequired, k );
+
+                  if ( reader.FITSOptions().verbosity > 0 )
+                     monitor += size_type( n )*image.Width();
+               }
+
+            return;
+         }
+
+         // To support 32-bit integer samples and to provide for arbitrary integer
+         // format output, we'll ask FITSIO to store 64-bit floating point pixel
+         // values in a temporary row buffer.
+         F64Vector buffer( image.Width() );
+
          // Coordinate selectors.
          // The primary image HDU is assumed to be FITSIO's current HDU.
          // N.B.: CFITSIO expects one-based indexes.
@@ -360,23 +521,9 @@ public:
 
       try
       {
-         // Restore CFITSIO's current HDU to the current image HDU.
-         // N.B.: CFITSIO expects HDU numbers relative to 1.
-         {
-            CFITSIO_LOCK
-            ::fits_movabs_hdu( fits_handle, hdu.hduNumber+1, 0, &fitsStatus );
-         }
-         if ( fitsStatus != 0 )
-            throw FITS::UnableToAccessCurrentHDU( reader.m_path );
-
          // Number of samples to read.
          long N = hdu.naxes[0]*rowCount;
 
-         // To support 32-bit integer samples and to provide for arbitrary integer
-         // format output, we'll ask FITSIO to store 64-bit floating point pixel
-         // values in a temporary row buffer.
-         F64Vector buffer( N );
-
          // A rescaling operation is required for integer sample values if the
          // source data type (as provided by FITSIO, i.e taking BZERO into account)
          // doesn't match the target image's sample type.
@@ -385,43 +532,68 @@ public:
          if ( rescalingRequired )
             k = (double( P::MaxSampleValue() ) - P::MinSampleValue())/(hdu.scaleRange - hdu.zeroOffset);
 
-         // Coordinate selectors.
-         // N.B.: CFITSIO expects one-based indexes.
-         long fpixel[ 3 ];
-         fpixel[0] = 1;
-         fpixel[1] = startRow + 1;
-         fpixel[2] = c + 1;
-
-         // Read a strip of FITS rows.
+         if ( hdu.dataOffset >= 0 )
          {
-            CFITSIO_LOCK
-            ::fits_read_pix( fits_handle, TDOUBLE, fpixel, N, 0, buffer.Begin(), 0, &fitsStatus );
+            // Uncompressed data unit: read the raw strip of FITS rows and
+            // transform it directly to the target sample type.
+            ByteArray buffer( size_type( N )*(Abs( hdu.bitpix ) >> 3) );
+            DirectRead( buffer.Begin(), hdu, (fsize_type( c )*hdu.naxes[1] + startRow)*hdu.naxes[0], buffer.Length(), reader );
+            DirectConvert<P>( f, buffer.Begin(), N, hdu, rescalingRequired, k );
          }
-         if ( fitsStatus != 0 )
-            throw FITS::FileReadError( reader.m_path );
-
-         // When reading floating point images, replace NaN and infinity IEEE 754 entities
-         // with zeros. For sanity, we perform this cleaning task for all image types, as
-         // we are forcing CFITSIO to read pixels to a floating point buffer.
-         for ( int i = 0; i < N; ++i )
-            if ( !IsFinite( buffer[i] ) )
-               buffer[i] = 0;
-
-         // Optional truncation of negative pixel values for signed integer FITS files.
-         // This is just for compatibility with writers that store raw (physical) pixel
-         // data as signed integers.
-         if ( hdu.signedIsPhysical )
+         else
+         {
+            // Restore CFITSIO's current HDU to the current image HDU.
+            // N.B.: CFITSIO expects HDU numbers relative to 1.
+            {
+               CFITSIO_LOCK
+               ::fits_movabs_hdu( fits_handle, hdu.hduNumber+1, 0, &fitsStatus );
+            }
+            if ( fitsStatus != 0 )
+               throw FITS::UnableToAccessCurrentHDU( reader.m_path );
+
+            // To support 32-bit integer samples and to provide for arbitrary integer
+            // format output, we'll ask FITSIO to store 64-bit floating point pixel
+            // values in a temporary row buffer.
+            F64Vector buffer( N );
+
+            // Coordinate selectors.
+            // N.B.: CFITSIO expects one-based indexes.
+            long fpixel[ 3 ];
+            fpixel[0] = 1;
+            fpixel[1] = startRow + 1;
+            fpixel[2] = c + 1;
+
+            // Read a strip of FITS rows.
+            {
+               CFITSIO_LOCK
+               ::fits_read_pix( fits_handle, TDOUBLE, fpixel, N, 0, buffer.Begin(), 0, &fitsStatus );
+            }
+            if ( fitsStatus != 0 )
+               throw FITS::FileReadError( reader.m_path );
+
+            // When reading floating point images, replace NaN and infinity IEEE 754 entities
+            // with zeros. For sanity, we perform this cleaning task for all image types, as
+            // we are forcing CFITSIO to read pixels to a floating point buffer.
             for ( int i = 0; i < N; ++i )
-               if ( buffer[i] < 0 )
+               if ( !IsFinite( buffer[i] ) )
                   buffer[i] = 0;
 
-         // Transfer pixels from the buffer to the image.
-         if ( rescalingRequired )
-            for ( int i = 0; i < N; ++i )
-               f[i] = P::FloatToSample( k*(buffer[i] - hdu.zeroOffset) + P::MinSampleValue() );
-         else
-            for ( int i = 0; i < N; ++i )
-               f[i] = typename P::sample( buffer[i] );
+            // Optional truncation of negative pixel values for signed integer FITS files.
+            // This is just for compatibility with writers that store raw (physical) pixel
+            // data as signed integers.
+            if ( hdu.signedIsPhysical )
+               for ( int i = 0; i < N; ++i )
+                  if ( buffer[i] < 0 )
+                     buffer[i] = 0;
+
+            // Transfer pixels from the buffer to the image.
+            if ( rescalingRequired )
+               for ( int i = 0; i < N; ++i )
+                  f[i] = P::FloatToSample( k*(buffer[i] - hdu.zeroOffset) + P::MinSampleValue() );
+            else
+               for ( int i = 0; i < N; ++i )
+                  f[i] = typename P::sample( buffer[i] );
+         }
 
          // Mirror pixel rows vertically if we are loading with bottom-up orientation.
          if ( reader.FITSOptions().bottomUp )
@@ -498,6 +670,27 @@ void FITSReader::Open( const String& filePath )
       if ( fitsStatus != 0 )
          throw FITS::UnableToOpenFile( m_path );
 
+      // Open a separate file stream for direct reading of uncompressed data
+      // units. Compressed files (gzip, etc.) can only be read with CFITSIO.
+      try
+      {
+         m_fileData->file.OpenForReading( m_path );
+         char signature[ 6 ];
+         if ( m_fileData->file.Size() < 2880 )
+            m_fileData->file.Close();
+         else
+         {
+            m_fileData->file.Read( signature, 6 );
+            if ( ::memcmp( signature, "SIMPLE", 6 ) != 0 )
+               m_fileData->file.Close();
+         }
+      }
+      catch ( ... )
+      {
+         // Direct reading is an optimization; just let CFITSIO do the job.
+         m_fileData->file.Close();
+      }
+
       // Explore all image HDUs
 
       int numberOfReadableImages = 0;
@@ -827,6 +1020,33 @@ void FITSReader::Open( const String& filePath )
          if ( nonImageExtension )
             continue;
 
+         // Uncompressed image data units can be read directly.
+         if ( hdu.naxis > 0 && m_fileData->file.IsOpen() )
+         {
+            int compressed;
+            LONGLONG headStart, dataStart, dataEnd;
+            {
+               CFITSIO_LOCK
+               compressed = ::fits_is_compressed_image( fits_handle, &fitsStatus );
+               ::fits_get_hduaddrll( fits_handle, &headStart, &dataStart, &dataEnd, &fitsStatus );
+            }
+            if ( fitsStatus != 0 )
+               throw FITS::FileReadError( m_path );
+
+            fsize_type dataSize = fsize_type( image.info.NumberOfSamples() )*(Abs( hdu.bitpix ) >> 3);
+            if ( !compressed )
+               if ( dataStart + dataSize <= m_fileData->file.Size() )
+                  hdu.dataOffset = dataStart;
+
+            // CFITSIO applies BZERO/BSCALE to integer data, except when we
+            // have disabled automatic scaling for floating point images.
+            if ( !image.options.ieeefpSampleFormat )
+            {
+               hdu.bzero = fits.zeroOffset;
+               hdu.bscale = fits.scaleRange;
+            }
+         }
+
          // Increment the count of nonempty images
          if ( hdu.naxis > 0 )
             ++numberOfReadableImages;
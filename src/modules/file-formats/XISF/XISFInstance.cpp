@@ -76,6 +76,8 @@ namespace pcl
  *    compress-data                  w
  *    no-compress-data               w
  *    compression-level <n>          w
+ *    compression-subblocks          w
+ *    no-compression-subblocks       w
  *    checksums <method>             w
  *    no-checksums                   w
  *    embedded-data                 rw
@@ -153,6 +155,7 @@ public:
    HintValue<bool>              autoMetadata;
    HintValue<block_compression> compressionCodec;
    HintValue<int>               compressionLevel;
+   HintValue<bool>              compressionSubblocks;
    HintValue<block_checksum>    checksumAlgorithm;
    HintValue<unsigned>          blockAlignmentSize;
    HintValue<unsigned>          maxInlineBlockSize;
@@ -209,6 +212,10 @@ public:
                if ( n >= 0 ) // 0=default
                   compressionLevel = Range( n, XISF::DefaultCompressionLevel, /*XISF::MaxCompressionLevel*/100 );
          }
+         else if ( *i == "compression-subblocks" )
+            compressionSubblocks = true;
+         else if ( *i == "no-compression-subblocks" )
+            compressionSubblocks = false;
          else if ( *i == "compress-data" ) // (deprecated) = compression-codec zlib
             compressionCodec = XISFCompression::Zlib;
          else if ( *i == "no-compression" ||
@@ -345,6 +352,9 @@ public:
       if ( compressionLevel.HasChanged() && compressionCodec.Value() != XISFCompression::None )
          hints << "compression-level " + IsoString( compressionLevel.Value() );
 
+      if ( compressionSubblocks.HasChanged() )
+         hints << (compressionSubblocks.Value() ? "compression-subblocks" : "no-compression-subblocks");
+
       if ( checksumAlgorithm.HasChanged() )
          hints << ((checksumAlgorithm.Value() != XISFChecksum::None) ?
                    "checksums " + IsoString( XISF::ChecksumAlgorithmId( checksumAlgorithm.Value() ) ) :
@@ -445,6 +455,8 @@ public:
          options.compressionCodec = compressionCodec;
       if ( compressionLevel.HasChanged() )
          options.compressionLevel = compressionLevel;
+      if ( compressionSubblocks.HasChanged() )
+         options.compressionSubblocks = compressionSubblocks;
       if ( checksumAlgorithm.HasChanged() )
          options.checksumAlgorithm = checksumAlgorithm;
       if ( blockAlignmentSize.HasChanged() )
@@ -57,7 +57,7 @@
 
 #include "DynamicPSFParameters.h"
 #include "PSF.h"
-#include "StarDetector.h"
+#include "SingleStarDetector.h"
 
 namespace pcl
 {
@@ -52,7 +52,7 @@
 
 #include "DynamicPSFInterface.h"
 #include "DynamicPSFProcess.h"
-#include "StarDetector.h"
+#include "SingleStarDetector.h"
 
 #include <pcl/Dialog.h>
 #include <pcl/FileDialog.h>
@@ -820,7 +820,7 @@ void DynamicPSFInterface::DynamicMouseRelease( View& view, const DPoint& pos, in
                break;
             }
 
-            StarDetector D( collection->image, ch, pos, instance.p_searchRadius, instance.p_threshold, instance.p_autoAperture );
+            SingleStarDetector D( collection->image, ch, pos, instance.p_searchRadius, instance.p_threshold, instance.p_autoAperture );
             if ( D )
             {
                Star* star = collection->AddStar( D.star );
@@ -2030,7 +2030,7 @@ void DynamicPSFInterface::Star::Regenerate( float threshold, bool autoAperture,
 void DynamicPSFInterface::Star::Regenerate( const ImageVariant& image, float threshold, bool autoAperture,
                                             const DynamicPSFInterface::PSFOptions& options )
 {
-   StarDetector D( collection->image, channel, pos, RoundInt( rect.Width()/2 ), threshold, autoAperture );
+   SingleStarDetector D( collection->image, channel, pos, RoundInt( rect.Width()/2 ), threshold, autoAperture );
    AssignData( D.star );
    Regenerate( image, options );
 }
@@ -2047,7 +2047,7 @@ void DynamicPSFInterface::Star::Recalculate( float threshold, bool autoAperture
 
 void DynamicPSFInterface::Star::Recalculate( const ImageVariant& image, float threshold, bool autoAperture )
 {
-   StarDetector D( collection->image, channel, pos, RoundInt( rect.Width()/2 ), threshold, autoAperture );
+   SingleStarDetector D( collection->image, channel, pos, RoundInt( rect.Width()/2 ), threshold, autoAperture );
    if ( D )
    {
       AssignData( D.star );
@@ -2268,7 +2268,7 @@ void DynamicPSFInterface::PSFCollection::Regenerate( float threshold, bool autoA
    {
       for ( Star& star : stars )
       {
-         star.status = StarDetector::NotDetected;
+         star.status = SingleStarDetector::NotDetected;
          star.psfs.Destroy();
       }
    }
@@ -2306,7 +2306,7 @@ void DynamicPSFInterface::PSFCollection::Recalculate( float threshold, bool auto
    {
       for ( Star& star : stars )
       {
-         star.status = StarDetector::NotDetected;
+         star.status = SingleStarDetector::NotDetected;
          for ( PSF& psf : star.psfs )
             psf.status = PSFFit::NotFitted;
       }
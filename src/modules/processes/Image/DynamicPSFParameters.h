@@ -137,7 +137,7 @@ class DPStarStatus : public MetaEnumeration
 public:
 
    /*
-    * NB: Must be compatible with StarDetector::Status
+    * NB: Must be compatible with SingleStarDetector::Status
     */
    enum { NotDetected,
           DetectedOk,
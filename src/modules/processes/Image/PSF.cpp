@@ -52,7 +52,7 @@
 
 #include "PSF.h"
 
-#include <cminpack/cminpack.h>
+#include <pcl/PSFFitter.h>
 
 namespace pcl
 {
@@ -106,84 +106,8 @@ PSFFit::PSFFit( const ImageVariant& image,
    }
 
    /*
-    * CMINPACK - Levenberg-Marquadt / finite differences.
+    * Initial shape parameter of Moffat functions
     */
-
-   // Number of data points
-   int m = S.NumberOfElements();
-
-   // Number of fitted parameters
-   int n = (function == Moffat) ? 6 : 5;
-   if ( !circular )
-      n += 2; // sy, theta
-
-   // Fitting function
-   cminpack_callback fitFunc;
-   if ( circular )
-      switch ( function )
-      {
-      default:
-      case Gaussian:
-         fitFunc = FitCircularGaussian;
-         break;
-      case Moffat:
-         fitFunc = FitCircularMoffat;
-         break;
-      case MoffatA:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat8:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat6:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat4:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat25:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat15:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Lorentzian:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      }
-   else
-      switch ( function )
-      {
-      default:
-      case Gaussian:
-         fitFunc = FitGaussian;
-         break;
-      case Moffat:
-         fitFunc = FitMoffat;
-         break;
-      case MoffatA:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat8:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat6:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat4:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat25:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat15:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Lorentzian:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      }
-
    int ibeta = circular ? 5 : 7;
    switch ( function )
    {
@@ -191,7 +115,7 @@ PSFFit::PSFFit( const ImageVariant& image,
    case Gaussian:
       break;
    case Moffat:
-      beta0 = P[ibeta] = 3;
+      P[ibeta] = 3;
       break;
    case MoffatA:
       P[ibeta] = 10;
@@ -216,22 +140,13 @@ PSFFit::PSFFit( const ImageVariant& image,
       break;
    }
 
-   Vector fvec( m );
-   IVector iwa( n );
-   Vector wa( m*n + 5*n + m );
-
-   int info = lmdif1( fitFunc,
-                      this,
-                      m,
-                      n,
-                      P.Begin(),
-                      fvec.Begin(),
-                      1.0e-08,
-                      iwa.Begin(),
-                      wa.Begin(),
-                      wa.Length() );
-
-   psf.status = CminpackInfoToStatus( info );
+   /*
+    * Levenberg-Marquardt with analytic Jacobian.
+    */
+   PSFFitter F( (function == Gaussian) ? PSFFitter::Gaussian :
+                ((function == Lorentzian) ? PSFFitter::Lorentzian : PSFFitter::Moffat),
+                circular, function != Moffat/*fixedBeta*/ );
+   psf.status = Status( F.Fit( P, S ) );
 
    if ( psf )
       if ( function == Moffat )
@@ -351,319 +266,6 @@ PSFFit::PSFFit( const ImageVariant& image,
    }
 }
 
-// ----------------------------------------------------------------------------
-// ----------------------------------------------------------------------------
-// Elliptical PSF Functions
-// ----------------------------------------------------------------------------
-// ----------------------------------------------------------------------------
-
-#define F      reinterpret_cast<const PSFFit*>( p )
-#define B      a[0]
-#define A      a[1]
-#define x0     a[2]
-#define y0     a[3]
-#define sx     a[4]
-#define sy     a[5]
-#define theta  a[6]
-#define beta   a[7]
-
-// ----------------------------------------------------------------------------
-
-/*
- * Elliptical Gaussian PSF.
- */
-int PSFFit::FitGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A*Exp(-(a*(x - x0)^2 + 2*b*(x - x0)*(y - y0) + c*(y - y0)^2))
-    */
-
-   if ( B < 0 || A < 0 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double st, ct;
-   SinCos( theta, st, ct );
-   double sct  = st*ct;
-   double st2  = st*st;
-   double ct2  = ct*ct;
-   double ksx2 = 2*sx*sx;
-   double ksy2 = 2*sy*sy;
-   double p1   = ct2/ksx2 + st2/ksy2;
-   double p2   = sct/ksy2 - sct/ksx2;
-   double p3   = st2/ksx2 + ct2/ksy2;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double twop2dy = 2*p2*dy;
-      double p3dy2 = p3*dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A*Exp( -(p1*dx*dx + twop2dy*dx + p3dy2) ) );
-      }
-   }
-   return 0;
-}
-
-// ----------------------------------------------------------------------------
-
-/*
- * Elliptical Moffat PSF, variable beta exponent.
- */
-int PSFFit::FitMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A/(1 + a*(x - x0)^2 + 2*b*(x - x0)*(y - y0) + c*(y - y0)^2)^beta
-    */
-
-   if ( B < 0 || A < 0 || beta < 0 || beta > 10 || Abs( beta - F->beta0 )/F->beta0 > 0.05 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   F->beta0 = beta;
-
-   double st, ct;
-   SinCos( theta, st, ct );
-   double sct = st*ct;
-   double st2 = st*st;
-   double ct2 = ct*ct;
-   double sx2 = sx*sx;
-   double sy2 = sy*sy;
-   double p1  = ct2/sx2 + st2/sy2;
-   double p2  = sct/sy2 - sct/sx2;
-   double p3  = st2/sx2 + ct2/sy2;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double twop2dy = 2*p2*dy;
-      double p3dy2 = p3*dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + p1*dx*dx + twop2dy*dx + p3dy2, beta ) );
-      }
-   }
-   return 0;
-}
-
-// ----------------------------------------------------------------------------
-
-/*
- * Elliptical Moffat PSF, fixed beta exponent.
- */
-#undef beta
-#define beta   F->P[7]
-int PSFFit::FitMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A/(1 + a*(x - x0)^2 + 2*b*(x - x0)*(y - y0) + c*(y - y0)^2)^beta
-    */
-
-   if ( B < 0 || A < 0 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double st, ct;
-   SinCos( theta, st, ct );
-   double sct = st*ct;
-   double st2 = st*st;
-   double ct2 = ct*ct;
-   double sx2 = sx*sx;
-   double sy2 = sy*sy;
-   double p1  = ct2/sx2 + st2/sy2;
-   double p2  = sct/sy2 - sct/sx2;
-   double p3  = st2/sx2 + ct2/sy2;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double twop2dy = 2*p2*dy;
-      double p3dy2 = p3*dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + p1*dx*dx + twop2dy*dx + p3dy2, beta ) );
-      }
-   }
-   return 0;
-}
-
-// ----------------------------------------------------------------------------
-
-#undef F
-#undef B
-#undef A
-#undef x0
-#undef y0
-#undef sx
-#undef sy
-#undef theta
-#undef beta
-
-// ----------------------------------------------------------------------------
-// ----------------------------------------------------------------------------
-// Circular PSF Functions
-// ----------------------------------------------------------------------------
-// ----------------------------------------------------------------------------
-
-#define F      reinterpret_cast<const PSFFit*>( p )
-#define B      a[0]
-#define A      a[1]
-#define x0     a[2]
-#define y0     a[3]
-#define sx     a[4]
-#define beta   a[5]
-
-// ----------------------------------------------------------------------------
-
-/*
- * Circular Gaussian PSF.
- */
-int PSFFit::FitCircularGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A*Exp( -((x - x0)^2 + (y - y0)^2)/(2*sigma^2) )
-    */
-
-   if ( B < 0 || A < 0 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double twosx2 = 2*sx*sx;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double dy2 = dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A*Exp( -(dx*dx + dy2)/twosx2 ) );
-      }
-   }
-   return 0;
-}
-
-// ----------------------------------------------------------------------------
-
-/*
- * Circular Moffat PSF, variable beta exponent.
- */
-int PSFFit::FitCircularMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A/(1 + ((x - x0)^2 + (y - y0)^2)/sigma^2)^beta
-    */
-
-   if ( B < 0 || A < 0 || beta < 0 || beta > 10 || Abs( beta - F->beta0 )/F->beta0 > 0.05 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   F->beta0 = beta;
-
-   double sx2 = sx*sx;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double dy2 = dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + (dx*dx + dy2)/sx2, beta ) );
-      }
-   }
-   return 0;
-}
-
-// ----------------------------------------------------------------------------
-
-/*
- * Circular Moffat PSF, fixed beta exponent.
- */
-#undef beta
-#define beta   F->P[5]
-int PSFFit::FitCircularMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A/(1 + ((x - x0)^2 + (y - y0)^2)/sigma^2)^beta
-    */
-
-   if ( B < 0 || A < 0 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double sx2 = sx*sx;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double dy2 = dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + (dx*dx + dy2)/sx2, beta ) );
-      }
-   }
-   return 0;
-}
-
-// ----------------------------------------------------------------------------
-
-#undef F
-#undef B
-#undef A
-#undef x0
-#undef y0
-#undef sx
-#undef beta
-
-// ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
 /*
@@ -839,31 +441,6 @@ Vector PSFFit::GoodnessOfFit( Function function, bool circular ) const
 
 // ----------------------------------------------------------------------------
 
-/*
- * Translate CMINPACK information codes into PSF error codes.
- */
-PSFFit::Status PSFFit::CminpackInfoToStatus( int info )
-{
-   switch ( info )
-   {
-   case 0:  // improper input parameters
-      return BadParameters;
-   case 1:  // The relative error in the sum of squares is at most tol
-   case 2:  // The relative error between x and the solution is at most tol
-   case 3:  // Conditions 1 and 2 both hold
-      return FittedOk;
-   case 4:  // Function vector (fvec) is orthogonal to the columns of the Jacobian to machine precision
-      return NoSolution;
-   case 5:  // Number of calls to fcn with iflag = 1 has reached 100*(n+1)
-      return NoConvergence;
-   case 6:  // tol is too small. No further reduction in the sum of squares is possible
-   case 7:  // tol is too small. No further improvement in the approximate solution x is possible
-      return InaccurateSolution;
-   default:
-      return UnknownError;
-   }
-}
-
 // ----------------------------------------------------------------------------
 
 void PSFData::ToImage( Image& image ) const
@@ -164,20 +164,8 @@ private:
 
    Matrix S; // matrix of sampled data
    Vector P; // vector of function parameters
-   mutable double beta0;
 
    Vector GoodnessOfFit( Function, bool circular ) const;
-
-   typedef int (*cminpack_callback)( void*, int, int, const double*, double*, int );
-
-   // CMINPACK - Levenberg-Marquadt / finite differences.
-   static int FitGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitCircularGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitCircularMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitCircularMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static Status CminpackInfoToStatus( int info );
 };
 
 // ----------------------------------------------------------------------------
@@ -6,7 +6,7 @@
 // ----------------------------------------------------------------------------
 // Standard Image Process Module Version 01.03.00.0437
 // ----------------------------------------------------------------------------
-// StarDetector.cpp - Released 2019-01-21T12:06:41Z
+// SingleStarDetector.cpp - Released 2019-01-21T12:06:41Z
 // ----------------------------------------------------------------------------
 // This file is part of the standard Image PixInsight module.
 //
@@ -50,7 +50,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------------------------------------
 
-#include "StarDetector.h"
+#include "SingleStarDetector.h"
 
 #include <pcl/Matrix.h>
 
@@ -67,7 +67,7 @@ void Threshold( FMatrix& V, float threshold )
 }
 
 static
-StarDetector::Status Detect( const Image& img, int channel,
+SingleStarDetector::Status Detect( const Image& img, int channel,
                              DPoint& pos, int& radius, float threshold )
 {
    /*
@@ -81,7 +81,7 @@ StarDetector::Status Detect( const Image& img, int channel,
       // Search box
       Rect r0( p0-radius, p0+radius+1 );
       if ( !img.Intersects( r0 ) )
-         return StarDetector::OutsideImage;
+         return SingleStarDetector::OutsideImage;
 
       // Extract the search subimage
       img.Clip( r0 ); // in case the search box is clipped
@@ -92,7 +92,7 @@ StarDetector::Status Detect( const Image& img, int channel,
 
       // Begin searching from the brightest pixel
       if ( V.MaxElement( p0 ) == V.MinElement() )
-         return StarDetector::NoSignificantData;
+         return SingleStarDetector::NoSignificantData;
 
       // Coordinate and intensity accumulators.
       double sx = 0, sy = 0, si = 0;
@@ -192,7 +192,7 @@ StarDetector::Status Detect( const Image& img, int channel,
        * Check if we have gathered some data.
        */
       if ( 1 + si == 1 )
-         return StarDetector::NoSignificantData;
+         return SingleStarDetector::NoSignificantData;
 
       /*
        * Update barycenter coordinates.
@@ -215,14 +215,14 @@ StarDetector::Status Detect( const Image& img, int channel,
           */
          if ( Abs( pos.x - lastPos.x ) < 0.005 && Abs( pos.y - lastPos.y ) < 0.005 )
             return (r.x0 > 0 && r.y0 > 0 && r.x1 < V.Cols() && r.y1 < V.Rows()) ?
-                        StarDetector::DetectedOk : StarDetector::CrossingEdges;
+                        SingleStarDetector::DetectedOk : SingleStarDetector::CrossingEdges;
       }
    }
 
-   return StarDetector::NoConvergence;
+   return SingleStarDetector::NoConvergence;
 }
 
-StarDetector::StarDetector( const Image& img, int channel,
+SingleStarDetector::SingleStarDetector( const Image& img, int channel,
                             const DPoint& pos, int radius, float threshold, bool autoAperture )
 {
    star.status = NotDetected;
@@ -254,4 +254,4 @@ StarDetector::StarDetector( const Image& img, int channel,
 } // pcl
 
 // ----------------------------------------------------------------------------
-// EOF StarDetector.cpp - Released 2019-01-21T12:06:41Z
+// EOF SingleStarDetector.cpp - Released 2019-01-21T12:06:41Z
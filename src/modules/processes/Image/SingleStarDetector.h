@@ -6,7 +6,7 @@
 // ----------------------------------------------------------------------------
 // Standard Image Process Module Version 01.03.00.0437
 // ----------------------------------------------------------------------------
-// StarDetector.h - Released 2019-01-21T12:06:41Z
+// SingleStarDetector.h - Released 2019-01-21T12:06:41Z
 // ----------------------------------------------------------------------------
 // This file is part of the standard Image PixInsight module.
 //
@@ -50,8 +50,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------------------------------------
 
-#ifndef __StarDetector_h
-#define __StarDetector_h
+#ifndef __SingleStarDetector_h
+#define __SingleStarDetector_h
 
 #include <pcl/Image.h>
 #include <pcl/MetaParameter.h>   // pcl_enum, pcl_bool
@@ -63,7 +63,7 @@ namespace pcl
 
 struct StarData
 {
-   pcl_enum status;  // error code (StarDetector::Status)
+   pcl_enum status;  // error code (SingleStarDetector::Status)
    int32    channel; // channel index (0=R/K, 1=G, 2=B)
    DRect    rect;    // selection rectangle
    DPoint   pos;     // barycenter position
@@ -75,7 +75,7 @@ struct StarData
 
 // ----------------------------------------------------------------------------
 
-class StarDetector
+class SingleStarDetector
 {
 public:
 
@@ -92,7 +92,7 @@ public:
 
    StarData star;
 
-   StarDetector( const Image& img, int channel,
+   SingleStarDetector( const Image& img, int channel,
                  const DPoint& pos, int searchRadius = 8, float bkgThreshold = 1.0F,
                  bool autoAperture = true );
 
@@ -106,7 +106,7 @@ public:
 
 inline StarData::operator bool() const
 {
-   return status == StarDetector::DetectedOk;
+   return status == SingleStarDetector::DetectedOk;
 }
 
 // ----------------------------------------------------------------------------
@@ -115,14 +115,14 @@ inline String StarData::StatusToString() const
 {
    switch ( status )
    {
-   case StarDetector::NotDetected:       return "Not detected";
-   case StarDetector::DetectedOk:        return "Detected Ok";
-   case StarDetector::NoSignificantData: return "No significant data";
-   case StarDetector::CrossingEdges:     return "Crossing edges";
-   case StarDetector::OutsideImage:      return "Outside image";
-   case StarDetector::NoConvergence:     return "No convergence";
+   case SingleStarDetector::NotDetected:       return "Not detected";
+   case SingleStarDetector::DetectedOk:        return "Detected Ok";
+   case SingleStarDetector::NoSignificantData: return "No significant data";
+   case SingleStarDetector::CrossingEdges:     return "Crossing edges";
+   case SingleStarDetector::OutsideImage:      return "Outside image";
+   case SingleStarDetector::NoConvergence:     return "No convergence";
    default:
-   case StarDetector::UnknownError:      return "Unknown error";
+   case SingleStarDetector::UnknownError:      return "Unknown error";
    }
 }
 
@@ -130,7 +130,7 @@ inline String StarData::StatusToString() const
 
 } // pcl
 
-#endif   // __StarDetector_h
+#endif   // __SingleStarDetector_h
 
 // ----------------------------------------------------------------------------
-// EOF StarDetector.h - Released 2019-01-21T12:06:41Z
+// EOF SingleStarDetector.h - Released 2019-01-21T12:06:41Z
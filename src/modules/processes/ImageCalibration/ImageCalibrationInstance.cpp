@@ -335,19 +335,6 @@ static void SubtractDark( Image& target, const Image& dark, const FVector& dScal
 
 // ----------------------------------------------------------------------------
 
-/*
- * One-channel dark subtraction with scaling
- */
-static void SubtractOneChannelDark( Image& target, int tCh, const Image& dark, int dCh, float k )
-{
-         float* t  = target.PixelData( tCh );
-         float* t1 = t + target.NumberOfPixels();
-   const float* d  = dark.PixelData( dCh );
-   LOOP *t++ -= SCALED_DARK;
-}
-
-// ----------------------------------------------------------------------------
-
 /*
  * Full calibration routine
  */
@@ -450,6 +437,33 @@ static void Calibrate( Image& target,
 
 // ----------------------------------------------------------------------------
 
+/*
+ * First wavelet layer of one channel of an image, computed with the 5x5
+ * B3-spline scaling function.
+ *
+ * The starlet transform is linear, so the first layer of (target - k*dark) is
+ * just w(target) - k*w(dark). Dark frame optimization computes the layers of
+ * the optimization dark frame once for all target frames, and the layer of
+ * each target frame channel once per frame. Then every noise evaluation
+ * performed during the minimization is reduced to a single pass over two
+ * precomputed layers.
+ */
+static Image DarkOptimizationLayer( const Image& image, int c )
+{
+   image.ResetSelections();
+   image.SelectChannel( c );
+
+   SeparableFilter H( __5x5B3Spline_hv, __5x5B3Spline_hv, 5 );
+   ATrousWaveletTransform W( H, 1 );
+   W.DisableParallelProcessing();
+   W.DisableLayer( 1 );
+   W << image;
+
+   image.ResetSelections();
+
+   return W[0];
+}
+
 /*
  * Quick estimation of noise sigma after dark subtraction by the iterative
  * k-sigma method.
@@ -460,21 +474,55 @@ static void Calibrate( Image& target,
  *    Support Publications of the Royal Astronomical Society of the Pacific,
  *    vol. 110, February 1998, pp. 193-199
  *
- * Returns a noise estimate for (target - k*dark).
+ * Returns a noise estimate for (target - k*dark), where wt and wd are the
+ * first wavelet layers of the target and dark frames, respectively. This is
+ * equivalent to ATrousWaveletTransform::NoiseKSigma( 0 ) with default
+ * parameters, but the scaled differences are generated on the fly and the
+ * k-sigma clipped set is never stored: after each iteration the set is
+ * defined by the smallest clipping threshold found so far, so each iteration
+ * is a single branchless pass that the compiler can vectorize.
+ *
+ * We can work with unscaled noise estimates here, hence no division by
+ * __5x5B3Spline_kj[0].
  */
-static double TestDarkOptimization( float k, const Image& target, const Image& dark )
+static double DarkOptimizationNoise( float k, const Image& wt, const Image& wd )
 {
-   Image t( target );
-   t.Status().DisableInitialization();
+   const float  K   = 3;    // clipping factor
+   const double eps = 0.01; // convergence limit
+   const int    n   = 10;   // maximum number of iterations
 
-   SubtractOneChannelDark( t, 0, dark, Min( target.SelectedChannel(), dark.NumberOfChannels()-1 ), k );
+   const float* a = wt.PixelData();
+   const float* b = wd.PixelData();
+   size_type N = Min( wt.NumberOfPixels(), wd.NumberOfPixels() );
 
-   SeparableFilter H( __5x5B3Spline_hv, __5x5B3Spline_hv, 5 );
-   ATrousWaveletTransform W( H, 1 );
-   W.DisableParallelProcessing();
-   W.DisableLayer( 1 );
-   W << t;
-   return W.NoiseKSigma( 0 ) /*/__5x5B3Spline_kj[0]*/; // we can work with unscaled noise estimates here
+   float T = FLT_MAX;
+   double s0 = 0;
+
+   for ( int it = 0; ; )
+   {
+      double c = 0, s1 = 0, s2 = 0;
+      for ( size_type i = 0; i < N; ++i )
+      {
+         float f = a[i] - k*b[i];
+         float m = (Abs( f ) < T) ? 1.0F : 0.0F;
+         f *= m;
+         c += m;
+         s1 += f;
+         s2 += f*f;
+      }
+
+      if ( c < 2 )
+         return 0;
+
+      double s = Sqrt( Max( 0.0, (s2 - s1*s1/c)/(c - 1) ) );
+      if ( 1 + s == 1 )
+         return 0;
+      if ( ++it == n || it > 1 && (s0 - s)/s0 < eps )
+         return s;
+
+      s0 = s;
+      T = Min( T, float( K*s ) );
+   }
 }
 
 // ----------------------------------------------------------------------------
@@ -492,10 +540,10 @@ inline T SameSign( const T& x, const T& sameAs )
    return (sameAs < 0) ? ((x < 0) ? x : -x) : ((x < 0) ? -x : x);
 }
 
-#define TEST_DARK( x )  TestDarkOptimization( x, target, dark )
+#define TEST_DARK( x )  DarkOptimizationNoise( x, targetLayer, darkLayer )
 
 static void BracketDarkOptimization( float& ax, float& bx, float& cx,
-                                     const Image& target, const Image& dark, bool useConsole )
+                                     const Image& targetLayer, const Image& darkLayer, bool useConsole )
 {
    if ( useConsole )
    {
@@ -606,7 +654,7 @@ static void BracketDarkOptimization( float& ax, float& bx, float& cx,
  * W.H. Press et al, Numerical Recipes in C, 2nd Edition
  * (section 10.1, pp. 397-402).
  */
-static float DarkOptimization( const Image& target, const Image& dark, int c, bool useConsole = false )
+static float DarkOptimization( const Image& targetLayer, const Image& darkLayer, bool useConsole = false )
 {
    /*
     * The golden ratios
@@ -614,14 +662,11 @@ static float DarkOptimization( const Image& target, const Image& dark, int c, bo
    const float R = 0.61803399;
    const float C = 1 - R;
 
-   target.ResetSelections();
-   target.SelectChannel( c );
-
    /*
     * Find an initial triplet ax,bx,cx that brackets the minimum.
     */
    float ax, bx, cx;
-   BracketDarkOptimization( ax, bx, cx, target, dark, useConsole );
+   BracketDarkOptimization( ax, bx, cx, targetLayer, darkLayer, useConsole );
 
    if ( useConsole ) // if we are not running into a thread
    {
@@ -724,7 +769,21 @@ static Rect OptimizingRect( const Image& target, int windowSize )
                                                        Max( 0, (target.Height()-windowSize)>>1 ) );
 }
 
-static FVector OptimizeDark( const Image& target, const Image& optimizingDark, bool isDarkCFA )
+/*
+ * First wavelet layers of all channels of the dark frame optimization image,
+ * shared by all target frames.
+ */
+static Array<Image> OptimizingDarkLayers( const Image& optimizingDark )
+{
+   optimizingDark.Status().DisableInitialization();
+
+   Array<Image> layers;
+   for ( int c = 0; c < optimizingDark.NumberOfChannels(); ++c )
+      layers << DarkOptimizationLayer( optimizingDark, c );
+   return layers;
+}
+
+static FVector OptimizeDark( const Image& target, const Array<Image>& darkLayers, bool isDarkCFA )
 {
    // The console cannot be used from a thread.
    bool useConsole = Thread::IsRootThread();
@@ -737,16 +796,18 @@ static FVector OptimizeDark( const Image& target, const Image& optimizingDark, b
    if ( isDarkCFA )
       IntegerResample( -2 ) >> optimizingTarget;
 
-   if ( optimizingTarget.Bounds() != optimizingDark.Bounds() )
+   const Image& darkLayer0 = darkLayers[0];
+   if ( optimizingTarget.Bounds() != darkLayer0.Bounds() )
    {
-      int windowSize = Max( optimizingDark.Width(), optimizingDark.Height() );
+      int windowSize = Max( darkLayer0.Width(), darkLayer0.Height() );
       optimizingTarget.SelectRectangle( OptimizingRect( optimizingTarget, windowSize ) );
       optimizingTarget.Crop();
       optimizingTarget.ResetSelections();
    }
 
    for ( int c = 0; c < optimizingTarget.NumberOfChannels(); ++c )
-      K[c] = DarkOptimization( optimizingTarget, optimizingDark, c, useConsole );
+      K[c] = DarkOptimization( DarkOptimizationLayer( optimizingTarget, c ),
+                               darkLayers[Min( c, int( darkLayers.Length() )-1 )], useConsole );
 
    return K;
 }
@@ -891,13 +952,14 @@ struct CalibrationThreadData
 {
    ImageCalibrationInstance* instance; // the instance being executed
    ImageCalibrationInstance::overscan_table overscan; // overscan regions grouped by target regions
-   Image*  bias;           // master bias frame, overscan corrected
-   Image*  dark;           // master dark frame, overscan+bias corrected
-   Image*  optimizingDark; // calibrated dark frame, central window for dark optimization, maybe thresholded, maybe binned 2x2
-   bool    isDarkCFA;      // if true, the master dark frame is a CFA and we must bin 2x2 prior to optimization
-   Image*  flat;           // master flat frame, overscan+bias+dark corrected
-   FVector fScale;         // flat scaling factor
-   int     maxProcessors;  // maximum number of threads allowed (for noise estimation)
+   Image*       bias;                 // master bias frame, overscan corrected
+   Image*       dark;                 // master dark frame, overscan+bias corrected
+   Image*       optimizingDark;       // calibrated dark frame, central window for dark optimization, maybe thresholded, maybe binned 2x2
+   Array<Image> optimizingDarkLayers; // first wavelet layers of optimizingDark, one per channel
+   bool         isDarkCFA;            // if true, the master dark frame is a CFA and we must bin 2x2 prior to optimization
+   Image*       flat;                 // master flat frame, overscan+bias+dark corrected
+   FVector      fScale;               // flat scaling factor
+   int          maxProcessors;        // maximum number of threads allowed (for noise estimation)
 };
 
 class CalibrationThread : public Thread
@@ -946,7 +1008,7 @@ public:
           */
          if ( m_data.dark != nullptr && m_data.instance->optimizeDarks && m_data.optimizingDark != nullptr )
             K = OptimizeDark( *m_target,
-                              *m_data.optimizingDark,
+                               m_data.optimizingDarkLayers,
                                m_data.isDarkCFA );
          else
             K = FVector( 1.0F, m_target->NumberOfChannels() );
@@ -1882,6 +1944,7 @@ bool ImageCalibrationInstance::ExecuteGlobal()
        * Master frames in use.
        */
       AutoPointer<Image> bias, dark, optimizingDark, flat;
+      Array<Image> optimizingDarkLayers;
 
       /*
        * Flag true if the master dark frame is mosaiced with a Color Filter
@@ -2073,6 +2136,8 @@ bool ImageCalibrationInstance::ExecuteGlobal()
                      optimizingDark->Crop();
                      optimizingDark->ResetSelections();
                   }
+
+                  optimizingDarkLayers = OptimizingDarkLayers( *optimizingDark );
                }
             }
          }
@@ -2099,7 +2164,7 @@ bool ImageCalibrationInstance::ExecuteGlobal()
                      if ( optimizeDarks && optimizingDark )
                      {
                         console.WriteLn( "Optimizing master dark frame:" );
-                        K = OptimizeDark( *flat, *optimizingDark, isDarkCFA );
+                        K = OptimizeDark( *flat, optimizingDarkLayers, isDarkCFA );
                         for ( int c = 0; c < flat->NumberOfChannels(); ++c )
                         {
                            console.WriteLn( String().Format( "<end><cbr>k%d = %.3f", c, K[c] ) );
@@ -2181,6 +2246,7 @@ bool ImageCalibrationInstance::ExecuteGlobal()
       threadData.bias = bias;
       threadData.dark = dark;
       threadData.optimizingDark = optimizingDark;
+      threadData.optimizingDarkLayers = optimizingDarkLayers;
       threadData.isDarkCFA = isDarkCFA;
       threadData.flat = flat;
       threadData.fScale = s;
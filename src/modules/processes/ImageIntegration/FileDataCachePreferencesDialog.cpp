@@ -51,8 +51,8 @@
 // ----------------------------------------------------------------------------
 
 #include "FileDataCachePreferencesDialog.h"
-#include "FileDataCache.h"
 
+#include <pcl/FileDataCache.h>
 #include <pcl/MessageBox.h>
 
 namespace pcl
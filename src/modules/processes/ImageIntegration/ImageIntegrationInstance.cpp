@@ -2212,54 +2212,54 @@ public:
       }
    }
 
-   static double RejectionMedian( const RejectionDataItem* r, int n )
+   static double RejectionMedian( const float* v, int n )
    {
-      // Assume that {r0...rn} is already sorted by value.
+      // Assume that {v0...vn} is already sorted.
       if ( n < 2 )
          return 0;
       int n2 = n >> 1;
-      return (n & 1) ? r[n2].value : (r[n2].value + r[n2-1].value)/2;
+      return (n & 1) ? v[n2] : (v[n2] + v[n2-1])/2;
    }
 
-   static double RejectionSigma( const RejectionDataItem* r, int n )
+   static double RejectionSigma( const float* v, int n )
    {
       if ( n < 2 )
          return 0;
       double mean = 0;
       for ( int i = 0; i < n; ++i )
-         mean += r[i].value;
+         mean += v[i];
       mean /= n;
       double var = 0, eps = 0;
       for ( int i = 0; i < n; ++i )
       {
-         double d = r[i].value - mean;
+         double d = v[i] - mean;
          var += d*d;
          eps += d;
       }
       return Sqrt( (var - (eps*eps)/n)/(n - 1) );
    }
 
-   static double RejectionADev( const RejectionDataItem* r, int n, double median )
+   static double RejectionADev( const float* v, int n, double median )
    {
       if ( n < 2 )
          return 0;
       double sd = 0;
       for ( int i = 0; i < n; ++i )
-         sd += Abs( r[i].value - median );
+         sd += Abs( v[i] - median );
       return sd/n;
    }
 
-   static double RejectionMAD( const RejectionDataItem* r, int n, double median )
+   static double RejectionMAD( const float* v, int n, double median )
    {
       if ( n < 2 )
          return 0;
       DVector d( n );
       for ( int i = 0; i < n; ++i )
-         d[i] = r[i].value - median;
+         d[i] = v[i] - median;
       return pcl::Median( d.Begin(), d.End() );
    }
 
-   static void RejectionWinsorization( double& mean, double& sigma, const RejectionDataItem* r, int n )
+   static void RejectionWinsorization( double& mean, double& sigma, const float* v, int n )
    {
       if ( n < 2 )
       {
@@ -2267,12 +2267,10 @@ public:
          return;
       }
 
-      mean = RejectionMedian( r, n );
-      sigma = RejectionSigma( r, n );
+      mean = RejectionMedian( v, n );
+      sigma = RejectionSigma( v, n );
 
-      DVector v( n );
-      for ( int i = 0; i < n; ++i )
-         v[i] = r[i].value;
+      DVector w( v, n );
 
       for ( int it = 0; ; )
       {
@@ -2283,18 +2281,227 @@ public:
          double t1 = mean + 1.5*sigma;
 
          for ( int i = 0; i < n; ++i )
-            if ( v[i] < t0 )
-               v[i] = t0;
-            else if ( v[i] > t1 )
-               v[i] = t1;
+            if ( w[i] < t0 )
+               w[i] = t0;
+            else if ( w[i] > t1 )
+               w[i] = t1;
 
          double s0 = sigma;
-         sigma = 1.134*v.StdDev();
+         sigma = 1.134*w.StdDev();
          if ( ++it > 1 && Abs( s0 - sigma )/s0 < 0.0005 )
             break;
       }
    }
 
+   /*
+    * Structure-of-arrays working set for rejection of a single pixel stack.
+    *
+    * The values of accepted pixels are kept in ascending order as packed
+    * floats in a contiguous array, along with the positions of their items in
+    * the stack. Since clipping a sorted stack rejects a prefix and/or a suffix
+    * of the accepted range, rejection iterations only have to narrow the
+    * accepted window and never require sorting the stack again. Store() writes
+    * the stack back with all accepted items first, in ascending order of
+    * value, followed by rejected items.
+    */
+   class RejectionWorkingSet
+   {
+   public:
+
+      RejectionWorkingSet() = default;
+
+      /*
+       * Loads the first count items of the stack r, which cannot be rejected
+       * items, and sorts them by value.
+       */
+      void Load( const RejectionDataItem* r, int count )
+      {
+         if ( count > m_capacity )
+         {
+            m_capacity = count;
+            m_keys = key_vector( count );
+            m_work = key_vector( count );
+            m_v = FVector( count );
+            m_p = IVector( count );
+            m_rejected = IVector( count );
+            m_items = item_vector( count );
+         }
+
+         m_count = n = count;
+         m_first = 0;
+         m_numberOfRejected = 0;
+
+         // Pack order-preserving value bits and stack positions into 64-bit
+         // sort keys. Stacks are often already sorted; avoid sorting them.
+         uint64* k = m_keys.Begin();
+         bool sorted = true;
+         for ( int j = 0; j < count; ++j )
+         {
+            k[j] = (uint64( OrderedBits( r[j].value ) ) << 32) | uint64( j );
+            if ( j > 0 )
+               if ( r[j].value < r[j-1].value )
+                  sorted = false;
+         }
+         if ( !sorted )
+            SortKeys();
+
+         float* v = m_v.Begin();
+         int* p = m_p.Begin();
+         for ( int j = 0; j < count; ++j )
+         {
+            p[j] = int( uint32( k[j] ) );
+            v[j] = r[p[j]].value;
+         }
+      }
+
+      /*
+       * Rejects the nl lowest and nh highest accepted items. If the low and
+       * high sets overlap, items in the intersection are rejected as both low
+       * and high pixels.
+       */
+      void Reject( int nl, int nh )
+      {
+         const int* p = m_p.Begin() + m_first;
+         for ( int j = 0; j < n; ++j )
+         {
+            int flags = ((j < nl) ? RejectLowFlag : 0) | ((j >= n-nh) ? RejectHighFlag : 0);
+            if ( flags != 0 )
+               m_rejected[m_numberOfRejected++] = (p[j] << 2) | flags;
+            else if ( j < n-nh )
+               j = n-nh-1; // skip the accepted window
+         }
+         if ( nl + nh >= n )
+            m_first += n, n = 0;
+         else
+            m_first += nl, n -= nl + nh;
+      }
+
+      /*
+       * Rejects accepted items according to a set of flags, where flags[j]
+       * is a combination of RejectLowFlag and RejectHighFlag (or zero) for
+       * the j-th accepted item. The accepted window is compacted, preserving
+       * the order of values.
+       */
+      void Reject( const uint8* flags )
+      {
+         float* v = m_v.Begin() + m_first;
+         int* p = m_p.Begin() + m_first;
+         int w = 0;
+         for ( int j = 0; j < n; ++j )
+            if ( flags[j] != 0 )
+               m_rejected[m_numberOfRejected++] = (p[j] << 2) | flags[j];
+            else
+            {
+               v[w] = v[j];
+               p[w] = p[j];
+               ++w;
+            }
+         n = w;
+      }
+
+      /*
+       * Sorted values of accepted items.
+       */
+      const float* Values() const
+      {
+         return m_v.Begin() + m_first;
+      }
+
+      /*
+       * Writes the working set back to the stack r.
+       */
+      void Store( RejectionDataItem* r )
+      {
+         RejectionDataItem* t = m_items.Begin();
+         const int* p = m_p.Begin() + m_first;
+         for ( int j = 0; j < n; ++j )
+            t[j] = r[p[j]];
+         for ( int j = 0; j < m_numberOfRejected; ++j )
+         {
+            RejectionDataItem& d = t[n+j] = r[m_rejected[j] >> 2];
+            if ( m_rejected[j] & RejectLowFlag )
+               d.rejectLow = true;
+            if ( m_rejected[j] & RejectHighFlag )
+               d.rejectHigh = true;
+         }
+         ::memcpy( r, t, m_count*sizeof( RejectionDataItem ) );
+      }
+
+      int n = 0; // number of accepted items
+
+      enum { RejectLowFlag = 1, RejectHighFlag = 2 };
+
+   private:
+
+      typedef GenericVector<uint64>             key_vector;
+      typedef GenericVector<RejectionDataItem>  item_vector;
+
+      key_vector  m_keys, m_work;
+      FVector     m_v;                    // packed values, ascending order
+      IVector     m_p;                    // item positions in the stack
+      IVector     m_rejected;             // rejected item positions and flags
+      item_vector m_items;                // working stack for Store()
+      int         m_capacity = 0;
+      int         m_count = 0;            // number of loaded items
+      int         m_first = 0;            // start of the accepted window
+      int         m_numberOfRejected = 0;
+
+      // Maps IEEE 754 single precision values to unsigned integers with the
+      // same ordering.
+      static uint32 OrderedBits( float x )
+      {
+         union { float f; uint32 u; } v = { x };
+         return (v.u & 0x80000000u) ? ~v.u : (v.u | 0x80000000u);
+      }
+
+      /*
+       * Sorts the packed keys. Small stacks are sorted by comparison; larger
+       * ones with a stable least significant digit radix sort on the value
+       * bits, skipping passes for bytes that are common to all values (the
+       * typical case for pixel stacks, where values are similar).
+       */
+      void SortKeys()
+      {
+         uint64* a = m_keys.Begin();
+         if ( m_count < 64 )
+         {
+            pcl::Sort( a, a + m_count );
+            return;
+         }
+
+         uint64* b = m_work.Begin();
+         int count[ 4 ][ 256 ];
+         ::memset( count, 0, sizeof( count ) );
+         for ( int j = 0; j < m_count; ++j )
+         {
+            uint32 u = uint32( a[j] >> 32 );
+            ++count[0][u & 0xff];
+            ++count[1][(u >> 8) & 0xff];
+            ++count[2][(u >> 16) & 0xff];
+            ++count[3][u >> 24];
+         }
+
+         for ( int d = 0; d < 4; ++d )
+         {
+            int shift = 32 + 8*d;
+            if ( count[d][(a[0] >> shift) & 0xff] == m_count )
+               continue;
+            int offset[ 256 ];
+            for ( int i = 0, s = 0; i < 256; ++i )
+            {
+               offset[i] = s;
+               s += count[d][i];
+            }
+            for ( int j = 0; j < m_count; ++j )
+               b[offset[(a[j] >> shift) & 0xff]++] = a[j];
+            pcl::Swap( a, b );
+         }
+
+         if ( a != m_keys.Begin() )
+            ::memcpy( m_keys.Begin(), a, m_count*sizeof( uint64 ) );
+      }
+   };
+
 private:
 
    class RejectionThreadPrivate
@@ -2659,6 +2866,7 @@ void RejectionEngine::MinMaxRejectionThread::Run()
 
    RejectionMatrix* R = E.R.ComponentPtr( m_firstStack );
    IVector* N = E.N.ComponentPtr( m_firstStack );
+   RejectionWorkingSet W;
 
    for ( int k = m_firstStack; k < m_endStack; ++k, ++R, ++N )
    {
@@ -2674,15 +2882,10 @@ void RejectionEngine::MinMaxRejectionThread::Run()
          if ( nl > 0 || nh > 0 )
          {
             RejectionDataItem* r = R->DataPtr()[i];
-            Sort( r, r + n );
-
-            for ( int j = 0; j < nl; ++j )
-               r[j].rejectLow = true;
-            for ( int j = n, nj = nh; nj > 0; --nj )
-               r[--j].rejectHigh = true;
-
-            Sort( r, r + n );
-            N->DataPtr()[i] -= Min( n, nl+nh );
+            W.Load( r, n );
+            W.Reject( nl, nh );
+            W.Store( r );
+            N->DataPtr()[i] = W.n;
          }
       }
 
@@ -2698,6 +2901,7 @@ void RejectionEngine::PercentileClipRejectionThread::Run()
 
    RejectionMatrix* R = E.R.ComponentPtr( m_firstStack );
    IVector* N = E.N.ComponentPtr( m_firstStack );
+   RejectionWorkingSet W;
 
    for ( int k = m_firstStack; k < m_endStack; ++k, ++R, ++N )
    {
@@ -2708,35 +2912,32 @@ void RejectionEngine::PercentileClipRejectionThread::Run()
             continue;
 
          RejectionDataItem* r = R->DataPtr()[i];
-         Sort( r, r + n );
+         W.Load( r, n );
 
-         double median = E.RejectionMedian( r, n );
-         if ( 1 + median == 1 )
-            continue;
+         const float* v = W.Values();
+         double median = E.RejectionMedian( v, n );
+         if ( 1 + median != 1 )
+         {
+            int nl = 0, nh = 0;
 
-         int nc = 0;
+            if ( I.p_clipLow )
+               for ( ; nl < n; ++nl )
+                  if ( (median - v[nl])/median <= I.p_pcClipLow )
+                     break;
 
-         if ( I.p_clipLow )
-            for ( RejectionDataItem* d = r, * d1 = r + n; d < d1; ++d )
-            {
-               if ( (median - d->value)/median <= I.p_pcClipLow )
-                  break;
-               d->rejectLow = true, ++nc;
-            }
+            if ( I.p_clipHigh )
+               for ( ; nh < n; ++nh )
+                  if ( (v[n-nh-1] - median)/median <= I.p_pcClipHigh )
+                     break;
 
-         if ( I.p_clipHigh )
-            for ( RejectionDataItem* d = r + n; --d >= r; )
+            if ( nl > 0 || nh > 0 )
             {
-               if ( (d->value - median)/median <= I.p_pcClipHigh )
-                  break;
-               d->rejectHigh = true, ++nc;
+               W.Reject( nl, nh );
+               N->DataPtr()[i] -= nl + nh;
             }
-
-         if ( nc > 0 )
-         {
-            Sort( r, r + n );
-            N->DataPtr()[i] -= nc;
          }
+
+         W.Store( r );
       }
 
       UPDATE_THREAD_MONITOR( 10 )
@@ -2751,6 +2952,7 @@ void RejectionEngine::SigmaClipRejectionThread::Run()
 
    RejectionMatrix* R = E.R.ComponentPtr( m_firstStack );
    IVector* N = E.N.ComponentPtr( m_firstStack );
+   RejectionWorkingSet W;
 
    for ( int k = m_firstStack; k < m_endStack; ++k, ++R, ++N )
    {
@@ -2761,44 +2963,42 @@ void RejectionEngine::SigmaClipRejectionThread::Run()
             continue;
 
          RejectionDataItem* r = R->DataPtr()[i];
-         Sort( r, r + n );
+         W.Load( r, n );
 
          for ( ;; )
          {
-            double sigma = E.RejectionSigma( r, n );
+            const float* v = W.Values();
+
+            double sigma = E.RejectionSigma( v, n );
             if ( 1 + sigma == 1 )
                break;
 
-            double median = E.RejectionMedian( r, n );
+            double median = E.RejectionMedian( v, n );
 
-            int nc = 0;
+            int nl = 0, nh = 0;
 
             if ( I.p_clipLow )
-               for ( RejectionDataItem* d = r, * d1 = r + n; d < d1; ++d )
-               {
-                  if ( (median - d->value)/sigma <= I.p_sigmaLow )
+               for ( ; nl < n; ++nl )
+                  if ( (median - v[nl])/sigma <= I.p_sigmaLow )
                      break;
-                  d->rejectLow = true, ++nc;
-               }
 
             if ( I.p_clipHigh )
-               for ( RejectionDataItem* d = r + n; --d >= r; )
-               {
-                  if ( (d->value - median)/sigma <= I.p_sigmaHigh )
+               for ( ; nh < n; ++nh )
+                  if ( (v[n-nh-1] - median)/sigma <= I.p_sigmaHigh )
                      break;
-                  d->rejectHigh = true, ++nc;
-               }
 
+            int nc = nl + nh;
             if ( nc == 0 )
                break;
 
-            Sort( r, r + n );
+            W.Reject( nl, nh );
 
             n -= nc;
             if ( n < 3 )
                break;
          }
 
+         W.Store( r );
          N->DataPtr()[i] = n;
       }
 
@@ -2814,6 +3014,7 @@ void RejectionEngine::WinsorizedSigmaClipRejectionThread::Run()
 
    RejectionMatrix* R = E.R.ComponentPtr( m_firstStack );
    IVector* N = E.N.ComponentPtr( m_firstStack );
+   RejectionWorkingSet W;
 
    for ( int k = m_firstStack; k < m_endStack; ++k, ++R, ++N )
    {
@@ -2824,43 +3025,41 @@ void RejectionEngine::WinsorizedSigmaClipRejectionThread::Run()
             continue;
 
          RejectionDataItem* r = R->DataPtr()[i];
-         Sort( r, r + n );
+         W.Load( r, n );
 
          for ( ;; )
          {
+            const float* v = W.Values();
+
             double mean, sigma;
-            RejectionWinsorization( mean, sigma, r, n );
+            RejectionWinsorization( mean, sigma, v, n );
             if ( 1 + sigma == 1 )
                break;
 
-            int nc = 0;
+            int nl = 0, nh = 0;
 
             if ( I.p_clipLow )
-               for ( RejectionDataItem* d = r, * d1 = r + n; d < d1; ++d )
-               {
-                  if ( (mean - d->value)/sigma <= I.p_sigmaLow )
+               for ( ; nl < n; ++nl )
+                  if ( (mean - v[nl])/sigma <= I.p_sigmaLow )
                      break;
-                  d->rejectLow = true, ++nc;
-               }
 
             if ( I.p_clipHigh )
-               for ( RejectionDataItem* d = r + n; --d >= r; )
-               {
-                  if ( (d->value - mean)/sigma <= I.p_sigmaHigh )
+               for ( ; nh < n; ++nh )
+                  if ( (v[n-nh-1] - mean)/sigma <= I.p_sigmaHigh )
                      break;
-                  d->rejectHigh = true, ++nc;
-               }
 
+            int nc = nl + nh;
             if ( nc == 0 )
                break;
 
-            Sort( r, r + n );
+            W.Reject( nl, nh );
 
             n -= nc;
             if ( n < 3 )
                break;
          }
 
+         W.Store( r );
          N->DataPtr()[i] = n;
       }
 
@@ -2877,6 +3076,7 @@ RejectionEngine::AveragedSigmaClipRejectionThread::RejectionData::RejectionData(
 {
    RejectionMatrix* R = R_.DataPtr();
    IVector* N = N_.DataPtr();
+   RejectionWorkingSet W;
 
    for ( int k = 0; k < R_.Length(); ++k, ++R, ++N )
    {
@@ -2893,15 +3093,17 @@ RejectionEngine::AveragedSigmaClipRejectionThread::RejectionData::RejectionData(
          }
 
          RejectionDataItem* r = R->DataPtr()[i];
-         Sort( r, r + n );
+         W.Load( r, n );
+         W.Store( r );
 
-         double median = m[k][i] = RejectionEngine::RejectionMedian( r, n );
+         const float* v = W.Values();
+         double median = m[k][i] = RejectionEngine::RejectionMedian( v, n );
          if ( 1 + median != 1 )
          {
             double acc = 0;
             for ( int j = 0; j < n; ++j )
             {
-               double d = r[j].value - median;
+               double d = v[j] - median;
                acc += d*d/median;
             }
 
@@ -2928,6 +3130,7 @@ void RejectionEngine::AveragedSigmaClipRejectionThread::Run()
 
    RejectionMatrix* R = E.R.ComponentPtr( m_firstStack );
    IVector* N = E.N.ComponentPtr( m_firstStack );
+   RejectionWorkingSet W;
 
    for ( int k = m_firstStack; k < m_endStack; ++k, ++R, ++N )
    {
@@ -2941,45 +3144,44 @@ void RejectionEngine::AveragedSigmaClipRejectionThread::Run()
             continue;
 
          RejectionDataItem* r = R->DataPtr()[i];
+         W.Load( r, n );
 
          double median = m[i];
 
          for ( ;; )
          {
+            const float* v = W.Values();
+
             double sigma = s[i] * Sqrt( median );
             if ( 1 + sigma == 1 )
                break;
 
-            int nc = 0;
+            int nl = 0, nh = 0;
 
             if ( I.p_clipLow )
-               for ( RejectionDataItem* d = r, * d1 = r + n; d < d1; ++d )
-               {
-                  if ( (median - d->value)/sigma <= I.p_sigmaLow )
+               for ( ; nl < n; ++nl )
+                  if ( (median - v[nl])/sigma <= I.p_sigmaLow )
                      break;
-                  d->rejectLow = true, ++nc;
-               }
 
             if ( I.p_clipHigh )
-               for ( RejectionDataItem* d = r + n; --d >= r; )
-               {
-                  if ( (d->value - median)/sigma <= I.p_sigmaHigh )
+               for ( ; nh < n; ++nh )
+                  if ( (v[n-nh-1] - median)/sigma <= I.p_sigmaHigh )
                      break;
-                  d->rejectHigh = true, ++nc;
-               }
 
+            int nc = nl + nh;
             if ( nc == 0 )
                break;
 
-            Sort( r, r + n );
+            W.Reject( nl, nh );
 
             n -= nc;
             if ( n < 3 )
                break;
 
-            median = E.RejectionMedian( r, n );
+            median = E.RejectionMedian( W.Values(), n );
          }
 
+         W.Store( r );
          N->DataPtr()[i] = n;
       }
 
@@ -3001,6 +3203,9 @@ void RejectionEngine::LinearFitRejectionThread::Run()
    RejectionMatrix* R = E.R.ComponentPtr( m_firstStack );
    IVector* N = E.N.ComponentPtr( m_firstStack );
    FVector* M = E.M.ComponentPtr( m_firstStack );
+   RejectionWorkingSet W;
+   ByteArray flagData( size_type( IntegrationFile::NumberOfFiles() ) );
+   uint8* flags = flagData.Begin();
 
    for ( int k = m_firstStack; k < m_endStack; ++k, ++R, ++N, ++M )
    {
@@ -3011,19 +3216,20 @@ void RejectionEngine::LinearFitRejectionThread::Run()
             continue;
 
          RejectionDataItem* r = R->DataPtr()[i];
-         Sort( r, r + n );
+         W.Load( r, n );
 
          for ( ;; )
          {
-            FVector X( n ), Y( n );
+            const float* v = W.Values();
+
+            FVector X( n ), Y( v, n );
             for ( int j = 0; j < n; ++j )
-               X[j] = float( j ), Y[j] = r[j].value;
+               X[j] = float( j );
 
             LinearFit L( X, Y );
             if ( !L.IsValid() )
             {
-               for ( RejectionDataItem* d = r, * d1 = r + n; d < d1; ++d )
-                  d->rejectLow = d->rejectHigh = true;
+               W.Reject( n, n );
                N->DataPtr()[i] = 0;
                M->DataPtr()[i] = 0;
                break;
@@ -3038,17 +3244,18 @@ void RejectionEngine::LinearFitRejectionThread::Run()
             {
                double y = L( j );
 
-               if ( r[j].value < y )
+               flags[j] = 0;
+               if ( v[j] < y )
                {
                   if ( I.p_clipLow )
-                     if ( (y - r[j].value)/sigma >= I.p_linearFitLow )
-                        r[j].rejectLow = true, ++nc;
+                     if ( (y - v[j])/sigma >= I.p_linearFitLow )
+                        flags[j] = RejectionWorkingSet::RejectLowFlag, ++nc;
                }
                else
                {
                   if ( I.p_clipHigh )
-                     if ( (r[j].value - y)/sigma >= I.p_linearFitHigh )
-                        r[j].rejectHigh = true, ++nc;
+                     if ( (v[j] - y)/sigma >= I.p_linearFitHigh )
+                        flags[j] = RejectionWorkingSet::RejectHighFlag, ++nc;
                }
             }
 
@@ -3063,13 +3270,14 @@ void RejectionEngine::LinearFitRejectionThread::Run()
                break;
             }
 
-            Sort( r, r + n );
+            W.Reject( flags );
 
             n -= nc;
             if ( n < 3 )
                break;
          }
 
+         W.Store( r );
          N->DataPtr()[i] = n;
       }
 
@@ -3106,6 +3314,7 @@ void RejectionEngine::CCDClipRejectionThread::Run()
 
    RejectionMatrix* R = E.R.ComponentPtr( m_firstStack );
    IVector* N = E.N.ComponentPtr( m_firstStack );
+   RejectionWorkingSet W;
 
    for ( int k = m_firstStack; k < m_endStack; ++k, ++R, ++N )
    {
@@ -3116,11 +3325,13 @@ void RejectionEngine::CCDClipRejectionThread::Run()
             continue;
 
          RejectionDataItem* r = R->DataPtr()[i];
-         Sort( r, r + n );
+         W.Load( r, n );
 
          for ( ;; )
          {
-            double median = E.RejectionMedian( r, n );
+            const float* v = W.Values();
+
+            double median = E.RejectionMedian( v, n );
             double sigma = P->r2g2 + P->gk*median;
             if ( P->isScaleNoise )
                sigma += P->sn2*median*median;
@@ -3132,34 +3343,30 @@ void RejectionEngine::CCDClipRejectionThread::Run()
                                    + ccdScaleNoise*ccdScaleNoise*DN*DN)/65535 );
             */
 
-            int nc = 0;
+            int nl = 0, nh = 0;
 
             if ( I.p_clipLow )
-               for ( RejectionDataItem* d = r, * d1 = r + n; d < d1; ++d )
-               {
-                  if ( (median - d->value)/sigma <= I.p_sigmaLow )
+               for ( ; nl < n; ++nl )
+                  if ( (median - v[nl])/sigma <= I.p_sigmaLow )
                      break;
-                  d->rejectLow = true, ++nc;
-               }
 
             if ( I.p_clipHigh )
-               for ( RejectionDataItem* d = r + n; --d >= r; )
-               {
-                  if ( (d->value - median)/sigma <= I.p_sigmaHigh )
+               for ( ; nh < n; ++nh )
+                  if ( (v[n-nh-1] - median)/sigma <= I.p_sigmaHigh )
                      break;
-                  d->rejectHigh = true, ++nc;
-               }
 
+            int nc = nl + nh;
             if ( nc == 0 )
                break;
 
-            Sort( r, r + n );
+            W.Reject( nl, nh );
 
             n -= nc;
             if ( n < 2 )
                break;
          }
 
+         W.Store( r );
          N->DataPtr()[i] = n;
       }
 
@@ -53,7 +53,7 @@
 #ifndef __IntegrationCache_h
 #define __IntegrationCache_h
 
-#include "FileDataCache.h"
+#include <pcl/FileDataCache.h>
 
 namespace pcl
 {
@@ -57,6 +57,7 @@
 #include <pcl/ImageWindow.h>
 #include <pcl/Random.h>
 #include <pcl/StdStatus.h>
+#include <pcl/Thread.h>
 #include <pcl/View.h>
 
 namespace pcl
@@ -69,6 +70,7 @@ NoiseGeneratorInstance::NoiseGeneratorInstance( const MetaProcess* m ) :
    p_amount( TheNGNoiseAmountParameter->DefaultValue() ),
    p_distribution( NGNoiseDistribution::Default ),
    p_impulsionalNoiseProbability( TheNGImpulsionalNoiseProbabilityParameter->DefaultValue() ),
+   p_seed( uint32( TheNGRandomSeedParameter->DefaultValue() ) ),
    p_preserveBrightness( false /*NGPreserveBrightness::Default*/ ) // ### deprecated
 {
 }
@@ -91,6 +93,7 @@ void NoiseGeneratorInstance::Assign( const ProcessImplementation& p )
       p_amount = x->p_amount;
       p_distribution = x->p_distribution;
       p_impulsionalNoiseProbability = x->p_impulsionalNoiseProbability;
+      p_seed = x->p_seed;
       p_preserveBrightness = x->p_preserveBrightness; // ### deprecated
    }
 }
@@ -117,6 +120,13 @@ bool NoiseGeneratorInstance::CanExecuteOn( const View& view, pcl::String& whyNot
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Noise is generated with a counter-based random number generator, using an
+ * independent random stream for each pixel row of each channel. Since the
+ * sequence of random deviates for a given row does not depend on the thread
+ * that generates it, the result is reproducible for a given random seed,
+ * irrespective of the number of threads used.
+ */
 class NoiseGeneratorEngine
 {
 public:
@@ -135,41 +145,130 @@ public:
             TheNGImpulsionalNoiseProbabilityParameter->Precision(), G.p_impulsionalNoiseProbability ); break;
       }
 
-      size_type N = image.NumberOfNominalSamples();
+      uint64 seed = (G.p_seed != 0) ? uint64( G.p_seed ) : RandomSeed64();
+
+      size_type N = size_type( image.NumberOfNominalChannels() )*size_type( image.Height() );
 
       image.Status().Initialize( "Generating noise, " + sdist, N );
       image.Status().DisableInitialization();
 
-      RandomNumberGenerator R;
-      double a = G.p_amount;
+      int numberOfThreads = Thread::NumberOfThreads( image.Height(), 16 );
+      int rowsPerThread = image.Height()/numberOfThreads;
 
-      for ( int c = 0; c < image.NumberOfNominalChannels(); ++c )
-         for ( typename GenericImage<P>::sample_iterator i( image, c ); i; ++i, ++image.Status() )
-         {
-            double v; P::FromSample( v, *i );
-            switch ( G.p_distribution )
+      image.EnsureUnique();
+
+      ThreadData<P> data( image, G, seed, N );
+
+      ReferenceArray<GeneratorThread<P> > threads;
+      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+         threads.Add( new GeneratorThread<P>( data,
+                                              i*rowsPerThread,
+                                              (j < numberOfThreads) ? j*rowsPerThread : image.Height() ) );
+
+      AbstractImage::RunThreads( threads, data );
+
+      threads.Destroy();
+
+      image.Status() = data.status;
+   }
+
+private:
+
+   template <class P>
+   struct ThreadData : public AbstractImage::ThreadData
+   {
+      ThreadData( GenericImage<P>& a_image, const NoiseGeneratorInstance& a_instance, uint64 a_seed, size_type count ) :
+      AbstractImage::ThreadData( a_image, count ),
+      image( a_image ),
+      instance( a_instance ),
+      seed( a_seed )
+      {
+      }
+
+            GenericImage<P>&        image;
+      const NoiseGeneratorInstance& instance;
+            uint64                  seed;
+   };
+
+   template <class P>
+   class GeneratorThread : public Thread
+   {
+   public:
+
+      GeneratorThread( ThreadData<P>& data, int startRow, int endRow ) :
+      Thread(),
+      m_data( data ), m_startRow( startRow ), m_endRow( endRow )
+      {
+      }
+
+      virtual void Run()
+      {
+         INIT_THREAD_MONITOR()
+
+         const NoiseGeneratorInstance& G = m_data.instance;
+         const double a = G.p_amount;
+         const double p = G.p_impulsionalNoiseProbability;
+         const double k = 65535/a;
+         const int w = m_data.image.Width();
+         const int h = m_data.image.Height();
+
+         Philox4x32 R( m_data.seed );
+         DVector v( w ), u( w ), s;
+         if ( G.p_distribution == NGNoiseDistribution::Impulsional )
+            s = DVector( w );
+
+         for ( int c = 0; c < m_data.image.NumberOfNominalChannels(); ++c )
+            for ( int y = m_startRow; y < m_endRow; ++y )
             {
-            default:
-            case NGNoiseDistribution::Uniform:
-               v += a*(R() - 0.5);
-               break;
-            case NGNoiseDistribution::Normal:
-               v += R.Normal( 0.0, a );
-               break;
-            case NGNoiseDistribution::Poisson:
-               v = double( R.Poisson( v*65535/a ) )/(65535/a);
-               break;
-            case NGNoiseDistribution::Impulsional:
-               if ( R() <= G.p_impulsionalNoiseProbability )
-                  v += (R() >= 0.5) ? a : -a;
-               else
+               R.SetStream( uint64( c )*uint64( h ) + uint64( y ) );
+
+               typename P::sample* f = m_data.image.ScanLine( y, c );
+               for ( int x = 0; x < w; ++x )
+                  P::FromSample( v[x], f[x] );
+
+               switch ( G.p_distribution )
+               {
+               default:
+               case NGNoiseDistribution::Uniform:
+                  R.Uniform( u.Begin(), w );
+                  for ( int x = 0; x < w; ++x )
+                     v[x] += a*(u[x] - 0.5);
+                  break;
+               case NGNoiseDistribution::Normal:
+                  R.Normal( u.Begin(), w, 0.0, a );
+                  for ( int x = 0; x < w; ++x )
+                     v[x] += u[x];
+                  break;
+               case NGNoiseDistribution::Poisson:
+                  for ( int x = 0; x < w; ++x )
+                     v[x] *= k;
+                  R.Poisson( v.Begin(), w );
+                  for ( int x = 0; x < w; ++x )
+                     v[x] /= k;
+                  break;
+               case NGNoiseDistribution::Impulsional:
+                  R.Uniform( u.Begin(), w );
+                  R.Uniform( s.Begin(), w );
+                  for ( int x = 0; x < w; ++x )
+                     if ( u[x] <= p )
+                        f[x] = P::ToSample( Range( v[x] + ((s[x] >= 0.5) ? a : -a), 0.0, 1.0 ) );
+                  UPDATE_THREAD_MONITOR( 16 )
                   continue;
-               break;
+               }
+
+               for ( int x = 0; x < w; ++x )
+                  f[x] = P::ToSample( Range( v[x], 0.0, 1.0 ) );
+
+               UPDATE_THREAD_MONITOR( 16 )
             }
+      }
 
-            *i = P::ToSample( Range( v, 0.0, 1.0 ) );
-         }
-   }
+   private:
+
+      ThreadData<P>& m_data;
+      int            m_startRow;
+      int            m_endRow;
+   };
 };
 
 // ----------------------------------------------------------------------------
@@ -213,6 +312,8 @@ void* NoiseGeneratorInstance::LockParameter( const MetaParameter* p, size_type /
       return &p_distribution;
    if ( p == TheNGImpulsionalNoiseProbabilityParameter )
       return &p_impulsionalNoiseProbability;
+   if ( p == TheNGRandomSeedParameter )
+      return &p_seed;
    if ( p == TheNGPreserveBrightnessParameter ) // ### deprecated
       return &p_preserveBrightness;
    return nullptr;
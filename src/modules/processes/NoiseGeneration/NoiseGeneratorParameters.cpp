@@ -60,6 +60,7 @@ namespace pcl
 NGNoiseAmount*                 TheNGNoiseAmountParameter = 0;
 NGNoiseDistribution*           TheNGNoiseDistributionParameter = 0;
 NGImpulsionalNoiseProbability* TheNGImpulsionalNoiseProbabilityParameter = 0;
+NGRandomSeed*                  TheNGRandomSeedParameter = 0;
 NGPreserveBrightness*          TheNGPreserveBrightnessParameter = 0; // ### deprecated
 
 // ----------------------------------------------------------------------------
@@ -147,6 +148,23 @@ double NGImpulsionalNoiseProbability::DefaultValue() const
 
 // ----------------------------------------------------------------------------
 
+NGRandomSeed::NGRandomSeed( MetaProcess* p ) : MetaUInt32( p )
+{
+   TheNGRandomSeedParameter = this;
+}
+
+IsoString NGRandomSeed::Id() const
+{
+   return "seed";
+}
+
+double NGRandomSeed::DefaultValue() const
+{
+   return 0; // zero = use a random seed
+}
+
+// ----------------------------------------------------------------------------
+
 /*
  * ### Deprecated
  */
@@ -118,6 +118,20 @@ extern NGImpulsionalNoiseProbability* TheNGImpulsionalNoiseProbabilityParameter;
 
 // ----------------------------------------------------------------------------
 
+class NGRandomSeed : public MetaUInt32
+{
+public:
+
+   NGRandomSeed( MetaProcess* );
+
+   virtual IsoString Id() const;
+   virtual double DefaultValue() const;
+};
+
+extern NGRandomSeed* TheNGRandomSeedParameter;
+
+// ----------------------------------------------------------------------------
+
 /*
  * ### Deprecated
  */
@@ -76,6 +76,7 @@ NoiseGeneratorProcess::NoiseGeneratorProcess() : MetaProcess()
    new NGNoiseAmount( this );
    new NGNoiseDistribution( this );
    new NGImpulsionalNoiseProbability( this );
+   new NGRandomSeed( this );
    new NGPreserveBrightness( this ); // ### deprecated
 }
 
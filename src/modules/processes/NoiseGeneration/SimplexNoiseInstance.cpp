@@ -56,6 +56,7 @@
 #include <pcl/ImageWindow.h>
 #include <pcl/Random.h>
 #include <pcl/StdStatus.h>
+#include <pcl/Thread.h>
 #include <pcl/View.h>
 
 namespace pcl
@@ -122,18 +123,23 @@ class SimplexNoise
 {
 public:
 
-   // 2D simplex noise
-   static double Noise( double xin, double yin )
+   // Must be called before the first call to Noise(), since Noise() can be
+   // invoked concurrently from several threads.
+   static void Initialize()
    {
-      static const double F2 = 0.5*( Sqrt( 3.0 ) - 1.0 );
-      static const double G2 = (3.0 - Sqrt( 3.0 ))/6;
-
       if ( perm == nullptr )
       {
          perm = new int[ 512 ];
          for ( int i = 0; i < 512; ++i )
             perm[i] = p[i & 255];
       }
+   }
+
+   // 2D simplex noise
+   static double Noise( double xin, double yin )
+   {
+      static const double F2 = 0.5*( Sqrt( 3.0 ) - 1.0 );
+      static const double G2 = (3.0 - Sqrt( 3.0 ))/6;
 
       double n0, n1, n2; // Noise contributions from the three corners
 
@@ -260,6 +266,12 @@ int* SimplexNoise::perm = nullptr;
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Simplex noise is a deterministic function of pixel coordinates, so it can
+ * be generated in parallel without affecting the result. Each thread renders
+ * a band of rows, computing the noise function only once per pixel for all
+ * nominal channels.
+ */
 class SimplexNoiseEngine
 {
 public:
@@ -267,72 +279,146 @@ public:
    template <class P>
    static void Apply( GenericImage<P>& image, const SimplexNoiseInstance& instance )
    {
-      size_type N = image.NumberOfNominalSamples();
+      size_type N = image.Height();
 
       image.Status().Initialize( "Generating 2D simplex noise", N );
       image.Status().DisableInitialization();
 
-      double a = instance.p_amount;
-      double a1 = 1 - a;
+      SimplexNoise::Initialize();
+
+      image.EnsureUnique();
 
-      for ( int c = 0; c < image.NumberOfNominalChannels(); ++c )
+      int numberOfThreads = Thread::NumberOfThreads( image.Height(), 16 );
+      int rowsPerThread = image.Height()/numberOfThreads;
+
+      ThreadData<P> data( image, instance, N );
+
+      ReferenceArray<NoiseThread<P> > threads;
+      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+         threads.Add( new NoiseThread<P>( data,
+                                          i*rowsPerThread,
+                                          (j < numberOfThreads) ? j*rowsPerThread : image.Height() ) );
+
+      AbstractImage::RunThreads( threads, data );
+
+      threads.Destroy();
+
+      image.Status() = data.status;
+   }
+
+private:
+
+   template <class P>
+   struct ThreadData : public AbstractImage::ThreadData
+   {
+      ThreadData( GenericImage<P>& a_image, const SimplexNoiseInstance& a_instance, size_type count ) :
+      AbstractImage::ThreadData( a_image, count ),
+      image( a_image ),
+      instance( a_instance )
       {
-         typename GenericImage<P>::sample_iterator i( image, c );
-         for ( int y = 0; y < image.Height(); ++y, image.Status() += image.Width() )
-            for ( int x = 0; x < image.Width(); ++x, ++i )
-            {
-               double v; P::FromSample( v, *i );
-               double r = (1 + SimplexNoise::Noise( double( x + instance.p_offsetX )/instance.p_scale,
+      }
+
+            GenericImage<P>&      image;
+      const SimplexNoiseInstance& instance;
+   };
+
+   template <class P>
+   class NoiseThread : public Thread
+   {
+   public:
+
+      NoiseThread( ThreadData<P>& data, int startRow, int endRow ) :
+      Thread(),
+      m_data( data ), m_startRow( startRow ), m_endRow( endRow )
+      {
+      }
+
+      virtual void Run()
+      {
+         INIT_THREAD_MONITOR()
+
+         const SimplexNoiseInstance& instance = m_data.instance;
+         const double a = instance.p_amount;
+         const double a1 = 1 - a;
+         const int w = m_data.image.Width();
+
+         DVector noise( w );
+
+         for ( int y = m_startRow; y < m_endRow; ++y )
+         {
+            for ( int x = 0; x < w; ++x )
+               noise[x] = (1 + SimplexNoise::Noise( double( x + instance.p_offsetX )/instance.p_scale,
                                                     double( y + instance.p_offsetY )/instance.p_scale ))/2;
-               switch ( instance.p_operator )
+
+            for ( int c = 0; c < m_data.image.NumberOfNominalChannels(); ++c )
+            {
+               typename P::sample* f = m_data.image.ScanLine( y, c );
+               for ( int x = 0; x < w; ++x )
                {
-               default:
-               case SNOperator::Copy:
-                  break;
-               case SNOperator::Add:
-                  r = Min( v + r, 1.0 );
-                  break;
-               case SNOperator::Sub:
-                  r = Max( 0.0, v - r );
-                  break;
-               case SNOperator::Mul:
-                  r *= v;
-                  break;
-               case SNOperator::Div:
-                  r = (r + 1 != 1) ? Range( v/r, 0.0, 1.0 ) : 1.0;
-                  break;
-               case SNOperator::Pow:
-                  r = Pow( v, r );
-                  break;
-               case SNOperator::Dif:
-                  r = Abs( v - r );
-                  break;
-               case SNOperator::Screen:
-                  r = 1 - (1 - v)*(1 - r);
-                  break;
-               case SNOperator::Or:
-                  r = double( uint16( RoundInt( 0xffff*v ) ) | uint16( RoundInt( 0xffff*r ) ) )/0xffff;
-                  break;
-               case SNOperator::And:
-                  r = double( uint16( RoundInt( 0xffff*v ) ) & uint16( RoundInt( 0xffff*r ) ) )/0xffff;
-                  break;
-               case SNOperator::Xor:
-                  r = double( uint16( RoundInt( 0xffff*v ) ) ^ uint16( RoundInt( 0xffff*r ) ) )/0xffff;
-                  break;
-               case SNOperator::Nor:
-                  r = double( ~(uint16( RoundInt( 0xffff*v ) ) | uint16( RoundInt( 0xffff*r ) )) )/0xffff;
-                  break;
-               case SNOperator::Nand:
-                  r = double( ~(uint16( RoundInt( 0xffff*v ) ) & uint16( RoundInt( 0xffff*r ) )) )/0xffff;
-                  break;
-               case SNOperator::Xnor:
-                  r = double( ~(uint16( RoundInt( 0xffff*v ) ) ^ uint16( RoundInt( 0xffff*r ) )) )/0xffff;
-                  break;
+                  double v; P::FromSample( v, f[x] );
+                  f[x] = P::ToSample( a1*v + a*Combine( v, noise[x], instance.p_operator ) );
                }
-
-               *i = P::ToSample( a1*v + a*r );
             }
+
+            UPDATE_THREAD_MONITOR( 16 )
+         }
+      }
+
+   private:
+
+      ThreadData<P>& m_data;
+      int            m_startRow;
+      int            m_endRow;
+   };
+
+   static double Combine( double v, double r, pcl_enum op )
+   {
+      switch ( op )
+      {
+      default:
+      case SNOperator::Copy:
+         break;
+      case SNOperator::Add:
+         r = Min( v + r, 1.0 );
+         break;
+      case SNOperator::Sub:
+         r = Max( 0.0, v - r );
+         break;
+      case SNOperator::Mul:
+         r *= v;
+         break;
+      case SNOperator::Div:
+         r = (r + 1 != 1) ? Range( v/r, 0.0, 1.0 ) : 1.0;
+         break;
+      case SNOperator::Pow:
+         r = Pow( v, r );
+         break;
+      case SNOperator::Dif:
+         r = Abs( v - r );
+         break;
+      case SNOperator::Screen:
+         r = 1 - (1 - v)*(1 - r);
+         break;
+      case SNOperator::Or:
+         r = double( uint16( RoundInt( 0xffff*v ) ) | uint16( RoundInt( 0xffff*r ) ) )/0xffff;
+         break;
+      case SNOperator::And:
+         r = double( uint16( RoundInt( 0xffff*v ) ) & uint16( RoundInt( 0xffff*r ) ) )/0xffff;
+         break;
+      case SNOperator::Xor:
+         r = double( uint16( RoundInt( 0xffff*v ) ) ^ uint16( RoundInt( 0xffff*r ) ) )/0xffff;
+         break;
+      case SNOperator::Nor:
+         r = double( ~(uint16( RoundInt( 0xffff*v ) ) | uint16( RoundInt( 0xffff*r ) )) )/0xffff;
+         break;
+      case SNOperator::Nand:
+         r = double( ~(uint16( RoundInt( 0xffff*v ) ) & uint16( RoundInt( 0xffff*r ) )) )/0xffff;
+         break;
+      case SNOperator::Xnor:
+         r = double( ~(uint16( RoundInt( 0xffff*v ) ) ^ uint16( RoundInt( 0xffff*r ) )) )/0xffff;
+         break;
       }
+      return r;
    }
 };
 
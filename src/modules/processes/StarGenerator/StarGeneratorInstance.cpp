@@ -339,6 +339,14 @@ private:
          }
    }
 
+   /*
+    * Star rendering is performed in two stages. First, star positions and
+    * fluxes are computed in parallel, preserving catalog order. Then each
+    * thread renders a horizontal band of the image, where stars are added in
+    * catalog order. Since every pixel receives its contributions in the same
+    * order irrespective of the number of threads, the rendered image is
+    * identical to the result of a serial rendering.
+    */
    template <class P>
    void PlotStars( GenericImage<P>& image, const StarDatabase::star_list& stars, float starSigma )
    {
@@ -354,50 +362,136 @@ private:
       StandardStatus status;
       StatusMonitor monitor;
       monitor.SetCallback( &status );
-      monitor.Initialize( "Rendering stars", N );
+      monitor.Initialize( "Projecting stars", N );
 
-      int numberOfThreads = Thread::NumberOfThreads( N, 16 );
-      size_type starsPerThread = N/numberOfThreads;
+      Array<StarPlot> plots( N );
+      {
+         int numberOfThreads = Thread::NumberOfThreads( N, 256 );
+         size_type starsPerThread = N/numberOfThreads;
+
+         ProjectionThreadData data( image, projection, stars, plots, monitor );
+
+         ReferenceArray<ProjectionThread> threads;
+         for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+            threads.Add( new ProjectionThread( data,
+                                               i*starsPerThread,
+                                               (j < numberOfThreads) ? j*starsPerThread : N ) );
+         AbstractImage::RunThreads( threads, data );
+         threads.Destroy();
+      }
 
-      ThreadData<P> data( image, star, projection, stars, monitor );
+      Array<StarPlot> visible;
+      for ( const StarPlot& plot : plots )
+         if ( plot.flux > 0 )
+            visible.Add( plot );
+      plots.Clear();
 
-      ReferenceArray<PlotThread<P> > threads;
-      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
-         threads.Add( new PlotThread<P>( data,
-                                         i*starsPerThread,
-                                         (j < numberOfThreads) ? j*starsPerThread : N ) );
+      if ( !visible.IsEmpty() )
+      {
+         int h = image.Height();
+         int numberOfThreads = Thread::NumberOfThreads( h, Max( 16, star.Height() ) );
+         int rowsPerThread = h/numberOfThreads;
+
+         size_type total = visible.Length()*numberOfThreads;
+         monitor.Initialize( "Rendering stars", total );
+
+         PlotThreadData<P> data( image, star, visible, monitor, total );
+
+         ReferenceArray<PlotThread<P> > threads;
+         for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+            threads.Add( new PlotThread<P>( data,
+                                            i*rowsPerThread,
+                                            (j < numberOfThreads) ? j*rowsPerThread : h ) );
+         AbstractImage::RunThreads( threads, data );
+         threads.Destroy();
+      }
 
-      AbstractImage::RunThreads( threads, data );
+      Console().WriteLn( String().Format( "<end><cbr>%u stars in projection", visible.Length() ) );
+   }
 
-      N = 0;
-      for ( int i = 0; i < numberOfThreads; ++i )
-         N += threads[i].N;
+   struct StarPlot
+   {
+      double x = 0, y = 0; // image coordinates
+      float  flux = 0;     // zero if the star falls outside the image
+   };
 
-      threads.Destroy();
+   struct ProjectionThreadData : public AbstractImage::ThreadData
+   {
+      ProjectionThreadData( const ImageGeometry& a_geometry,
+                            const Projection& a_projection,
+                            const StarDatabase::star_list& a_stars,
+                            Array<StarPlot>& a_plots,
+                            StatusMonitor& a_monitor ) :
+      AbstractImage::ThreadData( a_monitor, a_stars.Length() ),
+      geometry( a_geometry ),
+      projection( a_projection ),
+      stars( a_stars ),
+      plots( a_plots )
+      {
+      }
 
-      Console().WriteLn( String().Format( "<end><cbr>%u stars in projection", N ) );
-   }
+      const ImageGeometry&           geometry;
+      const Projection&              projection;
+      const StarDatabase::star_list& stars;
+            Array<StarPlot>&         plots;
+   };
+
+   class ProjectionThread : public Thread
+   {
+   public:
+
+      ProjectionThread( ProjectionThreadData& data, size_type first, size_type end ) :
+      Thread(),
+      m_data( data ), m_first( first ), m_end( end )
+      {
+      }
+
+      virtual void Run()
+      {
+         INIT_THREAD_MONITOR()
+
+         const double x0 = m_data.projection.Width()/2;
+         const double y0 = m_data.projection.Height()/2;
+
+         for ( size_type i = m_first; i < m_end; ++i )
+         {
+            const Star& s = m_data.stars[i];
+            StarPlot& plot = m_data.plots[i];
+            double x, y;
+            m_data.projection.SphericalToRectangular( x, y, Rad( s.ra ), Rad( s.dec ) );
+            plot.x = x0 - x;
+            plot.y = y0 - y;
+            if ( m_data.geometry.Includes( plot.x, plot.y ) )
+               plot.flux = Pow( 2.512, MAG_MIN - s.mag );
+            UPDATE_THREAD_MONITOR( 1024 )
+         }
+      }
+
+   private:
+
+      ProjectionThreadData& m_data;
+      size_type             m_first;
+      size_type             m_end;
+   };
 
    template <class P>
-   struct ThreadData : public AbstractImage::ThreadData
+   struct PlotThreadData : public AbstractImage::ThreadData
    {
-      ThreadData( GenericImage<P>& a_image,
-                  const Image& a_star,
-                  const Projection& a_projection,
-                  const StarDatabase::star_list& a_stars,
-                  StatusMonitor& a_monitor ) :
-      AbstractImage::ThreadData( a_monitor, a_stars.Length() ),
+      PlotThreadData( GenericImage<P>& a_image,
+                      const Image& a_star,
+                      const Array<StarPlot>& a_plots,
+                      StatusMonitor& a_monitor,
+                      size_type a_total ) :
+      AbstractImage::ThreadData( a_monitor, a_total ),
       image( a_image ),
       star( a_star ),
-      projection( a_projection ),
-      stars( a_stars )
+      plots( a_plots )
       {
       }
 
-            GenericImage<P>&         image;
-      const Image&                   star;
-      const Projection&              projection;
-      const StarDatabase::star_list& stars;
+            GenericImage<P>& image;
+      const Image&           star;
+      const Array<StarPlot>& plots;
    };
 
    template <class P>
@@ -405,11 +499,9 @@ private:
    {
    public:
 
-      size_type N;
-
-      PlotThread( ThreadData<P>& data, size_type first, size_type end ) :
+      PlotThread( PlotThreadData<P>& data, int startRow, int endRow ) :
       Thread(),
-      N( 0 ), m_data( data ), m_first( first ), m_end( end )
+      m_data( data ), m_startRow( startRow ), m_endRow( endRow )
       {
       }
 
@@ -417,9 +509,10 @@ private:
       {
          INIT_THREAD_MONITOR()
 
-         const double x0 = m_data.projection.Width()/2;
-         const double y0 = m_data.projection.Height()/2;
-         const int    r2 = m_data.star.Width() >> 1;
+         const int r2 = m_data.star.Width() >> 1;
+         const int sw = m_data.star.Width();
+         const int sh = m_data.star.Height();
+         const int w = m_data.image.Width();
 
          // Here we want smoothness and cannot tolerate ringing, so bicubic
          // B-spline is a good option.
@@ -427,38 +520,47 @@ private:
          Translation T( I );
          T.DisableParallelProcessing();
 
-         Image star( m_data.star.Width(), m_data.star.Height() );
+         Image star( sw, sh );
          star.Status().DisableInitialization();
 
-         for ( StarDatabase::star_list::const_iterator i = m_data.stars.At( m_first ), j = m_data.stars.At( m_end ); i < j; ++i )
+         for ( const StarPlot& plot : m_data.plots )
          {
-            double x, y;
-            m_data.projection.SphericalToRectangular( x, y, Rad( i->ra ), Rad( i->dec ) );
-            x = x0 - x;
-            y = y0 - y;
-            if ( m_data.image.Includes( x, y ) )
+            Point p( TruncI( plot.x ), TruncI( plot.y ) );
+            p -= r2;
+
+            /*
+             * Rows and columns of the star image that fall within this
+             * thread's band of the target image.
+             */
+            int y0 = Max( 0, m_startRow - p.y );
+            int y1 = Min( sh, m_endRow - p.y );
+            if ( y0 < y1 )
             {
                star.Mov( m_data.star );
-               star.Mul( Pow( 2.512, MAG_MIN - i->mag ) );
-               Point p( TruncI( x ), TruncI( y ) );
-               T.SetDelta( x-p.x, y-p.y );
+               star.Mul( plot.flux );
+               T.SetDelta( plot.x - TruncI( plot.x ), plot.y - TruncI( plot.y ) );
                T >> star;
-               p -= r2;
+
+               int x0 = Max( 0, -p.x );
+               int x1 = Min( sw, w - p.x );
+               for ( int y = y0; y < y1; ++y )
                {
-                  AutoLock lock( m_data.mutex );
-                  m_data.image.Apply( star, ImageOp::Add, p );
+                  const float* s = star.PixelAddress( x0, y );
+                  typename P::sample* f = m_data.image.PixelAddress( p.x + x0, p.y + y );
+                  for ( int x = x0; x < x1; ++x, ++f, ++s )
+                     P::Add( *f, *s );
                }
-               ++N;
             }
+
             UPDATE_THREAD_MONITOR( 50 )
          }
       }
 
    private:
 
-      ThreadData<P>& m_data;
-      size_type      m_first;
-      size_type      m_end;
+      PlotThreadData<P>& m_data;
+      int                m_startRow;
+      int                m_endRow;
    };
 
    void ApplyMTF( ImageVariant& image )
@@ -52,19 +52,22 @@
 
 #include "PSF.h"
 
-#include <cminpack/cminpack.h>
+#include <pcl/PSFFitter.h>
+#include <pcl/ReferenceArray.h>
 
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
-PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect, Function function, bool circular )
+bool PSFFit::Initialize( const ImageVariant& image, const DPoint& pos, const DRect& rect, Function function, bool circular )
 {
+   psf.function = function;
+   psf.circular = circular;
    psf.status = NotFitted;
 
    if ( !image )
-      return;
+      return false;
 
    /*
     * Pixel sample matrix
@@ -77,7 +80,8 @@ PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect,
    /*
     * Center of the sampling region
     */
-   DPoint r0 = DRect( r ).Center();
+   r0 = DRect( r ).Center();
+   rectWidth = rect.Width();
 
    int h = S.Rows();
    int w = S.Cols();
@@ -105,84 +109,8 @@ PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect,
    }
 
    /*
-    * CMINPACK L-M - Finite differences
+    * Initial shape parameter of Moffat functions
     */
-
-   // Number of data points
-   int m = S.NumberOfElements();
-
-   // Number of fitted parameters
-   int n = (function == Moffat) ? 6 : 5;
-   if ( !circular )
-      n += 2; // sy, theta
-
-   // Fitting function
-   cminpack_callback fitFunc;
-   if ( circular )
-      switch ( function )
-      {
-      default:
-      case Gaussian:
-         fitFunc = FitCircularGaussian;
-         break;
-      case Moffat:
-         fitFunc = FitCircularMoffat;
-         break;
-      case MoffatA:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat8:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat6:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat4:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat25:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Moffat15:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      case Lorentzian:
-         fitFunc = FitCircularMoffatWithFixedBeta;
-         break;
-      }
-   else
-      switch ( function )
-      {
-      default:
-      case Gaussian:
-         fitFunc = FitGaussian;
-         break;
-      case Moffat:
-         fitFunc = FitMoffat;
-         break;
-      case MoffatA:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat8:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat6:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat4:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat25:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Moffat15:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      case Lorentzian:
-         fitFunc = FitMoffatWithFixedBeta;
-         break;
-      }
-
    int ibeta = circular ? 5 : 7;
    switch ( function )
    {
@@ -190,7 +118,7 @@ PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect,
    case Gaussian:
       break;
    case Moffat:
-      beta0 = P[ibeta] = 3;
+      P[ibeta] = 3;
       break;
    case MoffatA:
       P[ibeta] = 10;
@@ -215,31 +143,25 @@ PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect,
       break;
    }
 
-   Vector fvec( m );
-   IVector iwa( n );
-   Vector wa( m*n + 5*n + m );
+   return true;
+}
+
+// ----------------------------------------------------------------------------
 
-   int info = lmdif1( fitFunc,
-                      this,
-                      m,
-                      n,
-                      P.Begin(),
-                      fvec.Begin(),
-                      1.0e-08,
-                      iwa.Begin(),
-                      wa.Begin(),
-                      wa.Length() );
+void PSFFit::Finalize( Status status )
+{
+   Function function = Function( psf.function );
+   bool circular = psf.circular;
+   int m = S.NumberOfElements();
+   int ibeta = circular ? 5 : 7;
 
-   psf.status = CminpackInfoToStatus( info );
+   psf.status = status;
 
    if ( psf )
       if ( function == Moffat )
          if ( P[ibeta] > 9.99 )
             psf.status = NoConvergence;
 
-   psf.function = function;
-   psf.circular = circular;
-
    if ( psf )
    {
       // Force sx > 0
@@ -253,7 +175,7 @@ PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect,
             Swap( P[4], P[5] );
       }
 
-      if ( psf.FWHM( function, P[4], P[ibeta] ) > rect.Width() )
+      if ( psf.FWHM( function, P[4], P[ibeta] ) > rectWidth )
          psf.status = NoConvergence;
    }
 
@@ -351,298 +273,80 @@ PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect,
 }
 
 // ----------------------------------------------------------------------------
-// Elliptical PSF Functions
-// ----------------------------------------------------------------------------
-
-#define F      reinterpret_cast<const PSFFit*>( p )
-#define B      a[0]
-#define A      a[1]
-#define x0     a[2]
-#define y0     a[3]
-#define sx     a[4]
-#define sy     a[5]
-#define theta  a[6]
-#define beta   a[7]
 
 /*
- * Elliptical Gaussian PSF.
+ * Levenberg-Marquardt fitter with analytic Jacobian for a PSF function.
  */
-int PSFFit::FitGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag )
+static PSFFitter Fitter( PSFFit::Function function, bool circular )
 {
-   /*
-    *   f(x,y) : B + A*Exp(-(a*(x - x0)^2 + 2*b*(x - x0)*(y - y0) + c*(y - y0)^2))
-    */
-
-   if ( B < 0 || A < 0 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double st, ct;
-   SinCos( theta, st, ct );
-   double sct  = st*ct;
-   double st2  = st*st;
-   double ct2  = ct*ct;
-   double ksx2 = 2*sx*sx;
-   double ksy2 = 2*sy*sy;
-   double p1   = ct2/ksx2 + st2/ksy2;
-   double p2   = sct/ksy2 - sct/ksx2;
-   double p3   = st2/ksx2 + ct2/ksy2;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
+   switch ( function )
    {
-      double dy = y - h2y0;
-      double twop2dy = 2*p2*dy;
-      double p3dy2 = p3*dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A*Exp( -(p1*dx*dx + twop2dy*dx + p3dy2) ) );
-      }
+   case PSFFit::Gaussian:
+      return PSFFitter( PSFFitter::Gaussian, circular );
+   case PSFFit::Moffat:
+      return PSFFitter( PSFFitter::Moffat, circular, false/*fixedBeta*/ );
+   case PSFFit::Lorentzian:
+      return PSFFitter( PSFFitter::Lorentzian, circular );
+   default:
+      return PSFFitter( PSFFitter::Moffat, circular );
    }
-   return 0;
 }
 
-/*
- * Elliptical Moffat PSF, variable beta exponent.
- */
-int PSFFit::FitMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A/(1 + a*(x - x0)^2 + 2*b*(x - x0)*(y - y0) + c*(y - y0)^2)^beta
-    */
-
-//std::cout << String().Format( "b = %.2f\n", beta ) << std::flush;
-
-   if ( B < 0 || A < 0 || beta < 0 || beta > 10 || Abs( beta - F->beta0 )/F->beta0 > 0.05 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   F->beta0 = beta;
-
-   double st, ct;
-   SinCos( theta, st, ct );
-   double sct = st*ct;
-   double st2 = st*st;
-   double ct2 = ct*ct;
-   double sx2 = sx*sx;
-   double sy2 = sy*sy;
-   double p1  = ct2/sx2 + st2/sy2;
-   double p2  = sct/sy2 - sct/sx2;
-   double p3  = st2/sx2 + ct2/sy2;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double twop2dy = 2*p2*dy;
-      double p3dy2 = p3*dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + p1*dx*dx + twop2dy*dx + p3dy2, beta ) );
-      }
-   }
-   return 0;
-}
+// ----------------------------------------------------------------------------
 
-/*
- * Elliptical Moffat PSF, fixed beta exponent.
- */
-#undef beta
-#define beta   F->P[7]
-int PSFFit::FitMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag )
+PSFFit::PSFFit( const ImageVariant& image, const DPoint& pos, const DRect& rect, Function function, bool circular )
 {
-   /*
-    *   f(x,y) : B + A/(1 + a*(x - x0)^2 + 2*b*(x - x0)*(y - y0) + c*(y - y0)^2)^beta
-    */
-
-   if ( B < 0 || A < 0 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double st, ct;
-   SinCos( theta, st, ct );
-   double sct = st*ct;
-   double st2 = st*st;
-   double ct2 = ct*ct;
-   double sx2 = sx*sx;
-   double sy2 = sy*sy;
-   double p1  = ct2/sx2 + st2/sy2;
-   double p2  = sct/sy2 - sct/sx2;
-   double p3  = st2/sx2 + ct2/sy2;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double twop2dy = 2*p2*dy;
-      double p3dy2 = p3*dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + p1*dx*dx + twop2dy*dx + p3dy2, beta ) );
-      }
-   }
-   return 0;
+   if ( Initialize( image, pos, rect, function, circular ) )
+      Finalize( Status( Fitter( function, circular ).Fit( P, S ) ) );
 }
 
-#undef F
-#undef B
-#undef A
-#undef x0
-#undef y0
-#undef sx
-#undef sy
-#undef theta
-#undef beta
-
 // ----------------------------------------------------------------------------
-// Circular PSF Functions
-// ----------------------------------------------------------------------------
-
-#define F      reinterpret_cast<const PSFFit*>( p )
-#define B      a[0]
-#define A      a[1]
-#define x0     a[2]
-#define y0     a[3]
-#define sx     a[4]
-#define beta   a[5]
 
-/*
- * Circular Gaussian PSF.
- */
-int PSFFit::FitCircularGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag )
+Array<PSFData> PSFFit::Fit( const ImageVariant& image, const Array<DPoint>& positions, const Array<DRect>& rects,
+                            Function function, bool circular, int maxProcessors )
 {
-   /*
-    *   f(x,y) : B + A*Exp( -((x - x0)^2 + (y - y0)^2)/(2*sigma^2) )
-    */
-
-   if ( B < 0 || A < 0 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double twosx2 = 2*sx*sx;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double dy2 = dy*dy;
-      for ( int x = 0; x < w; ++x )
-      {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A*Exp( -(dx*dx + dy2)/twosx2 ) );
-      }
-   }
-   return 0;
-}
+   PCL_PRECONDITION( positions.Length() == rects.Length() )
 
-/*
- * Circular Moffat PSF, variable beta exponent.
- */
-int PSFFit::FitCircularMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
    /*
-    *   f(x,y) : B + A/(1 + ((x - x0)^2 + (y - y0)^2)/sigma^2)^beta
+    * Sample all stars and solve all fitting problems in a single parallel
+    * batch. Post-fit processing is comparatively inexpensive and is done
+    * sequentially in the calling thread.
     */
-
-   if ( B < 0 || A < 0 || beta < 0 || beta > 10 || Abs( beta - F->beta0 )/F->beta0 > 0.05 )
-   {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   F->beta0 = beta;
-
-   double sx2 = sx*sx;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
+   ReferenceArray<PSFFit> fits;
+   PSFFitter::problem_list problems;
+   for ( size_type i = 0; i < positions.Length(); ++i )
    {
-      double dy = y - h2y0;
-      double dy2 = dy*dy;
-      for ( int x = 0; x < w; ++x )
+      PSFFit* F = new PSFFit;
+      fits << F;
+      PSFFitter::Problem problem;
+      if ( F->Initialize( image, positions[i], rects[i], function, circular ) )
       {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + (dx*dx + dy2)/sx2, beta ) );
+         problem.S = F->S;
+         problem.P = F->P;
       }
+      problems << problem;
    }
-   return 0;
-}
 
-/*
- * Circular Moffat PSF, fixed beta exponent.
- */
-#undef beta
-#define beta   F->P[5]
-int PSFFit::FitCircularMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag )
-{
-   /*
-    *   f(x,y) : B + A/(1 + ((x - x0)^2 + (y - y0)^2)/sigma^2)^beta
-    */
+   PSFFitter fitter = Fitter( function, circular );
+   fitter.EnableParallelProcessing( maxProcessors > 1, maxProcessors );
+   fitter.Fit( problems );
 
-   if ( B < 0 || A < 0 )
+   Array<PSFData> psfs;
+   for ( size_type i = 0; i < fits.Length(); ++i )
    {
-      for ( int i = 0; i < m; ++i )
-         *fvec++ = DBL_MAX;
-      return 0;
-   }
-
-   double sx2 = sx*sx;
-   int h = F->S.Rows();
-   int w = F->S.Cols();
-   double w2x0 = (w >> 1) + x0;
-   double h2y0 = (h >> 1) + y0;
-   const double* s = F->S.Begin();
-   for ( int y = 0; y < h; ++y )
-   {
-      double dy = y - h2y0;
-      double dy2 = dy*dy;
-      for ( int x = 0; x < w; ++x )
+      if ( !problems[i].S.IsEmpty() )
       {
-         double dx = x - w2x0;
-         *fvec++ = Abs( *s++ - B - A/Pow( 1 + (dx*dx + dy2)/sx2, beta ) );
+         fits[i].P = problems[i].P;
+         fits[i].Finalize( Status( problems[i].status ) );
       }
+      psfs << fits[i].psf;
    }
-   return 0;
+
+   fits.Destroy();
+   return psfs;
 }
 
-#undef F
-#undef B
-#undef A
-#undef x0
-#undef y0
-#undef sx
-#undef beta
+// ----------------------------------------------------------------------------
 
 /*
  * Mean absolute deviation
@@ -796,31 +500,6 @@ double PSFFit::AbsoluteDeviation( Function function, bool circular, double bestS
    return adev;
 }
 
-/*
- * Translate CMINPACK information codes into PSF error codes.
- */
-PSFFit::Status PSFFit::CminpackInfoToStatus( int info )
-{
-   switch ( info )
-   {
-   case 0:  // improper input parameters
-      return BadParameters;
-   case 1:  // The relative error in the sum of squares is at most tol
-   case 2:  // The relative error between x and the solution is at most tol
-   case 3:  // Conditions 1 and 2 both hold
-      return FittedOk;
-   case 4:  // Function vector (fvec) is orthogonal to the columns of the Jacobian to machine precision
-      return NoSolution;
-   case 5:  // Number of calls to fcn with iflag = 1 has reached 100*(n+1)
-      return NoConvergence;
-   case 6:  // tol is too small. No further reduction in the sum of squares is possible
-   case 7:  // tol is too small. No further improvement in the approximate solution x is possible
-      return InaccurateSolution;
-   default:
-      return UnknownError;
-   }
-}
-
 // ----------------------------------------------------------------------------
 
 void PSFData::ToImage( Image& img ) const
@@ -129,6 +129,13 @@ public:
 
    PSFFit( const ImageVariant&, const DPoint&, const DRect&, Function, bool circular );
 
+   /*
+    * Fits PSFs to a set of stars with parallel threads. Returns fitted PSF
+    * data in the same order as the specified positions and sampling regions.
+    */
+   static Array<PSFData> Fit( const ImageVariant&, const Array<DPoint>& positions, const Array<DRect>& rects,
+                              Function, bool circular, int maxProcessors );
+
    PSFFit( const PSFFit& x ) : psf( x.psf )
    {
    }
@@ -146,22 +153,17 @@ public:
 
 private:
 
-   Matrix S; // matrix of sampled data
-   Vector P; // vector of function parameters
-   mutable double beta0;
+   Matrix S;         // matrix of sampled data
+   Vector P;         // vector of function parameters
+   DPoint r0;        // center of the sampling region
+   double rectWidth; // width of the sampling region
 
-   double AbsoluteDeviation( Function, bool circular, double bestSoFar = 0 ) const;
+   PSFFit() = default;
 
-   typedef int (*cminpack_callback)( void*, int, int, const double*, double*, int );
+   bool Initialize( const ImageVariant&, const DPoint&, const DRect&, Function, bool circular );
+   void Finalize( Status );
 
-   // Levenberg-Marquadt - CMINPACK - Finite differences
-   static int FitGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitCircularGaussian( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitCircularMoffat( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static int FitCircularMoffatWithFixedBeta( void* p, int m, int n, const double* a, double* fvec, int iflag );
-   static Status CminpackInfoToStatus( int info );
+   double AbsoluteDeviation( Function, bool circular, double bestSoFar = 0 ) const;
 };
 
 inline PSFData::operator bool() const
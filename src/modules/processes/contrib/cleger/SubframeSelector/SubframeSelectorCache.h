@@ -53,7 +53,7 @@
 #ifndef __SubframeSelectorCache_h
 #define __SubframeSelectorCache_h
 
-#include "FileDataCache.h"
+#include <pcl/FileDataCache.h>
 
 namespace pcl
 {
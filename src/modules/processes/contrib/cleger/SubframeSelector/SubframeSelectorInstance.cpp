@@ -57,9 +57,11 @@
 #include <pcl/FileFormat.h>
 #include <pcl/FileFormatInstance.h>
 #include <pcl/ICCProfile.h>
+#include <pcl/ImageWindow.h>
 #include <pcl/MessageBox.h>
 #include <pcl/MetaModule.h>
 #include <pcl/ProcessInstance.h>
+#include <pcl/StarDetector.h>
 #include <pcl/Version.h>
 
 #include "PSF.h"
@@ -67,7 +69,6 @@
 #include "SubframeSelectorInstance.h"
 #include "SubframeSelectorInterface.h"
 #include "SubframeSelectorMeasurementsInterface.h"
-#include "SubframeSelectorStarDetector.h"
 
 namespace pcl
 {
@@ -198,11 +199,12 @@ struct MeasureThreadInputData
    // The static settings
    pcl_bool                  showStarDetectionMaps = false;
    SubframeSelectorInstance* instance = nullptr;
+   int                       maxProcessors = 1; // maximum number of threads allowed (for PSF fitting)
 };
 
 // ----------------------------------------------------------------------------
 
-typedef Array<Star> star_list;
+typedef StarDetector::StarList star_list;
 typedef Array<PSFData> psf_list;
 
 class SubframeSelectorMeasureThread : public Thread
@@ -244,7 +246,7 @@ public:
             m_subframe->CropTo( m_data->instance->p_roi );
 
          // Run the Star Detector
-         star_list stars = StarDetector();
+         star_list stars = DetectStars();
 
          // Stop if just showing the maps
          if ( m_data->showStarDetectionMaps )
@@ -264,7 +266,7 @@ public:
             throw Error( "Aborted" );
 
          // Run the PSF Fitter
-         psf_list fits = FitPSFs( stars.Begin(), stars.End() );
+         psf_list fits = FitPSFs( stars );
 
          if ( fits.IsEmpty() )
          {
@@ -357,41 +359,67 @@ private:
                                pcl::Pow( m_outputData.medianMeanDev, 2.0 ) / pcl::Pow( m_outputData.noise, 2.0 ) : 0;
    }
 
-   star_list StarDetector()
+   star_list DetectStars()
    {
       // Setup StarDetector parameters and find the list of stars
-      SubframeSelectorStarDetector starDetector;
-      starDetector.showStarDetectionMaps      = m_data->showStarDetectionMaps;
-      starDetector.structureLayers            = m_data->instance->p_structureLayers;
-      starDetector.noiseLayers                = m_data->instance->p_noiseLayers;
-      starDetector.hotPixelFilterRadius       = m_data->instance->p_hotPixelFilterRadius;
-      starDetector.noiseReductionFilterRadius = m_data->instance->p_noiseReductionFilterRadius;
-      starDetector.hotPixelFilter             = m_data->instance->p_hotPixelFilter;
-      starDetector.sensitivity                = m_data->instance->p_sensitivity;
-      starDetector.peakResponse               = m_data->instance->p_peakResponse;
-      starDetector.maxDistortion              = m_data->instance->p_maxDistortion;
-      starDetector.upperLimit                 = m_data->instance->p_upperLimit;
-      starDetector.backgroundExpansion        = m_data->instance->p_backgroundExpansion;
-      starDetector.xyStretch                  = m_data->instance->p_xyStretch;
-      return starDetector.GetStars( m_subframe );
+      StarDetector starDetector;
+      starDetector.SetStructureLayers( m_data->instance->p_structureLayers );
+      starDetector.SetNoiseLayers( m_data->instance->p_noiseLayers );
+      starDetector.SetHotPixelFilterRadius( m_data->instance->p_hotPixelFilterRadius );
+      starDetector.SetNoiseReductionFilterRadius( m_data->instance->p_noiseReductionFilterRadius );
+      starDetector.EnableHotPixelFilter( m_data->instance->p_hotPixelFilter );
+      starDetector.SetSensitivity( m_data->instance->p_sensitivity );
+      starDetector.SetPeakResponse( m_data->instance->p_peakResponse );
+      starDetector.SetMaxDistortion( m_data->instance->p_maxDistortion );
+      starDetector.SetUpperLimit( m_data->instance->p_upperLimit );
+      starDetector.SetBackgroundExpansion( m_data->instance->p_backgroundExpansion );
+      starDetector.SetXYStretch( m_data->instance->p_xyStretch );
+      starDetector.SetMaxProcessors( m_data->maxProcessors );
+
+      Image workingImage = starDetector.WorkingImage( *m_subframe );
+      Image structureMap = starDetector.StructureMap( workingImage );
+
+      if ( m_data->showStarDetectionMaps )
+      {
+         CreateImageWindow( *m_subframe, "Original" );
+         if ( m_data->instance->p_noiseReductionFilterRadius > 0 )
+            CreateImageWindow( ImageVariant( &workingImage ), "NoiseReductionFilter" );
+         else if ( m_data->instance->p_hotPixelFilter )
+            CreateImageWindow( ImageVariant( &workingImage ), "HotPixelFilter" );
+         CreateImageWindow( ImageVariant( &structureMap ), "StructuresMap" );
+         return star_list();
+      }
+
+      return starDetector.Detect( workingImage, structureMap );
    }
 
-   psf_list FitPSFs( star_list::const_iterator begin, star_list::const_iterator end )
+   static void CreateImageWindow( const ImageVariant& image, const String& name )
    {
-      psf_list PSFs;
-      for ( star_list::const_iterator i = begin; i != end; ++i )
-      {
-         int radius = pcl::Max(3, pcl::Ceil(pcl::Sqrt(i->size)));
-         Rect rect( Point( i->position.x - radius, i->position.y - radius ),
-                    Point( i->position.x + radius, i->position.y + radius ) );
+      ImageWindow window( image.Width(), image.Height(), 1, 32, true, false, true, name );
+      ImageVariant v = window.MainView().Image();
+      image.GetIntensity( v );
+      window.Show();
+   }
 
-         PSFFit psfFit( *m_subframe, i->position, rect, PSFFunction( m_data->instance->p_psfFit ),
-                        m_data->instance->p_psfFitCircular );
-         PSFData psf = psfFit.psf;
+   psf_list FitPSFs( const star_list& stars )
+   {
+      Array<DPoint> positions;
+      Array<DRect> rects;
+      for ( size_type i = 0; i < stars.Length(); ++i )
+      {
+         Point position( RoundInt( stars.pos[i].x ), RoundInt( stars.pos[i].y ) );
+         int radius = pcl::Max(3, pcl::Ceil(pcl::Sqrt(stars.size[i])));
+         Rect rect( Point( position.x - radius, position.y - radius ),
+                    Point( position.x + radius, position.y + radius ) );
+         positions << DPoint( position );
+         rects << DRect( rect );
+      }
 
+      psf_list PSFs;
+      for ( const PSFData& psf : PSFFit::Fit( *m_subframe, positions, rects, PSFFunction( m_data->instance->p_psfFit ),
+                                              m_data->instance->p_psfFitCircular, m_data->maxProcessors ) )
          if ( psf.status == PSFFit::FittedOk )
             PSFs.Append( psf );
-      }
       return PSFs;
    }
 
@@ -590,6 +618,7 @@ bool SubframeSelectorInstance::TestStarDetector()
    MeasureThreadInputData inputThreadData;
    inputThreadData.showStarDetectionMaps = true;
    inputThreadData.instance = this;
+   inputThreadData.maxProcessors = PCL_MAX_PROCESSORS;
 
    try
    {
@@ -749,6 +778,8 @@ bool SubframeSelectorInstance::Measure()
        */
       int numberOfThreads = Thread::NumberOfThreads( PCL_MAX_PROCESSORS, 1 );
       thread_list runningThreads( Min( int( p_subframes.Length() ), numberOfThreads ) );
+      int numberOfRunningThreads = Max( 1, int( runningThreads.Length() ) );
+      inputThreadData.maxProcessors = 1 + (numberOfThreads - numberOfRunningThreads)/numberOfRunningThreads;
 
       /*
        * Pending subframes list. We use this list for temporary storage of
@@ -50,6 +50,10 @@
 #include <fftw3.h>
 #endif
 
+#ifdef USE_PCLDCT
+#include <pcl/DCT.h>
+#endif
+
 
 #ifdef USE_PIFFT
 #include "solver_dct3.h"
@@ -262,6 +266,42 @@ GradientsBase::solveImage(imageType_t const &rLaplaceImage_p, imageType_t &rSolu
     fftw_destroy_plan(pInverse);
   }
 #endif
+#ifdef USE_PCLDCT
+  // same algorithm as the FFTW solver, using PCL's native transforms.
+  AssertColImage(rLaplaceImage_p);
+
+  rSolution_p.AllocateData(nCols,nRows,nChannels,colorSpace);
+  rSolution_p.ResetSelections();
+
+  GenericDCT2D<realType_t> const forward(nRows,nCols,2);
+  GenericDCT2D<realType_t> const inverse(nRows,nCols,3);
+  realType_t const pi=pcl::Pi();
+  // DCT-II followed by DCT-III multiplies by 4*nRows*nCols
+  realType_t const scale=1/forward.Scale();
+
+  DVector colFactor(nCols);
+  for(int col = 0 ; col < nCols; ++col){
+    colFactor[col]=2*cos(pi*col/( (double) nCols)) - 2;
+  }
+
+  for(int chan=0;chan<nChannels;++chan){
+    TimeMessage startSolver(String("DCT Solver, Channel ")+String(chan));
+
+    realType_t *pData=rSolution_p.PixelData(chan);
+    forward(pData,rLaplaceImage_p.PixelData(chan));
+
+    for(int row = 0 ; row < nRows; ++row){
+      realType_t const rowFactor=2*cos(pi*row/((double) nRows)) - 2;
+      realType_t *pRow=pData+size_type(row)*nCols;
+      for(int col = 0 ; col < nCols; ++col){
+	pRow[col] *= scale/(colFactor[col] + rowFactor);
+      }
+    }
+    pData[0]=0.0;
+
+    inverse(pData,pData);
+  }
+#endif
 #ifdef USE_PIFFT
   // use PI FFT based solver by Carlos Milovic F.
   rLaplaceImage_p.ResetSelections();
@@ -31,9 +31,14 @@
 #ifndef __GradientsBase_h
 #define __GradientsBase_h
 
+/// select solver based on PCL's native DCT-II/DCT-III transforms
+///
+/// Mutually exclusive with USE_FFTW and USE_PIFFT
+#define USE_PCLDCT
+
 /// select solver based on fftw3
 ///
-/// Mutually exclusive with USE_PIFFT
+/// Mutually exclusive with USE_PIFFT and USE_PCLDCT
 //#define USE_FFTW
 
 /// define if you have a threading version of fftw.
@@ -44,8 +49,8 @@
 /// use FFT solver using PI internal functions
 ///
 /// designed by Carlos Milovic F. .
-/// Mutually exclusive with USE_FFTW
-#define USE_PIFFT
+/// Mutually exclusive with USE_FFTW and USE_PCLDCT
+//#define USE_PIFFT
 
 //#include <boost/date_time/posix_time/posix_time.hpp> //header only
 #ifdef __PCL_WINDOWS
@@ -69,7 +74,10 @@ namespace pcl {
 /// useful for images up to 10k*10k pixels (beyond that., things get
 /// real slow). Iterative solvers proved to be too slow or inaccurate.
 ///
-/// Uses solver by Carlos Milovic F (see #define USE_PIFFT).
+/// Uses PCL's parallel DCT-II/DCT-III transforms (see #define USE_PCLDCT),
+/// which work for arbitrary image dimensions without padding.
+///
+/// Alternatively uses solver by Carlos Milovic F (see #define USE_PIFFT).
 /// It is implemented in solver_dct3.h.
 /// This one is slower and uses more memory than the FFTW solver, but it uses
 /// PI internal routines only. Used with kind permission by Carlos.
@@ -53,7 +53,7 @@
 
 #include "CometAlignmentInterface.h"
 #include "CometAlignmentProcess.h"
-#include "StarDetector.h"
+#include "SingleStarDetector.h"
 
 #include <pcl/FileDialog.h>
 #include <pcl/StdStatus.h>
@@ -222,7 +222,7 @@ void CometAlignmentInterface::DynamicMousePress (View& view, const DPoint& pos,
          float bkgThreshold = 1; // star signal( bkgThreshold * StandardDeviation ) above surround median
          bool autoAperture = true;
 
-         StarDetector D (img, ch, pos, searchRadius, bkgThreshold, autoAperture); // Call Centroid Detection
+         SingleStarDetector D (img, ch, pos, searchRadius, bkgThreshold, autoAperture); // Call Centroid Detection
 
          Console ().WriteLn ("Channel:" + img->ChannelId (ch) + " " + D.star.StatusToString ().Uppercase ());
          if (D) // status ?
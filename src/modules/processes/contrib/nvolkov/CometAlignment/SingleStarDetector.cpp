@@ -6,7 +6,7 @@
 // ----------------------------------------------------------------------------
 // Standard CometAlignment Process Module Version 01.02.06.0214
 // ----------------------------------------------------------------------------
-// StarDetector.cpp - Released 2019-01-21T12:06:42Z
+// SingleStarDetector.cpp - Released 2019-01-21T12:06:42Z
 // ----------------------------------------------------------------------------
 // This file is part of the standard CometAlignment PixInsight module.
 //
@@ -51,7 +51,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------------------------------------
 
-#include "StarDetector.h"
+#include "SingleStarDetector.h"
 
 #include <pcl/SeparableConvolution.h>
 
@@ -76,7 +76,7 @@ void Threshold( Image& img, float threshold )
 }
 
 template <class P> static
-StarDetector::Status Detect( DPoint& pos, int& radius, float threshold, const GenericImage<P>& img )
+SingleStarDetector::Status Detect( DPoint& pos, int& radius, float threshold, const GenericImage<P>& img )
 {
    img.Status().DisableInitialization();
 
@@ -91,7 +91,7 @@ StarDetector::Status Detect( DPoint& pos, int& radius, float threshold, const Ge
       // Search box
       Rect r0( p0-radius, p0+radius+1 );
       if ( !img.Intersects( r0 ) )
-         return StarDetector::OutsideImage;
+         return SingleStarDetector::OutsideImage;
 
       // Extract the search subimage
       img.SelectRectangle( r0 );
@@ -103,7 +103,7 @@ StarDetector::Status Detect( DPoint& pos, int& radius, float threshold, const Ge
 
       // Begin searching from the brightest pixel
       if ( simg.LocateMaximumPixelValue( p0 ) == simg.MinimumPixelValue() )
-         return StarDetector::NoSignificantData;
+         return SingleStarDetector::NoSignificantData;
 
       // Coordinate and intensity accumulators.
       double sx = 0, sy = 0, si = 0;
@@ -203,7 +203,7 @@ StarDetector::Status Detect( DPoint& pos, int& radius, float threshold, const Ge
        * Check if we have gathered some data.
        */
       if ( 1 + si == 1 )
-         return StarDetector::NoSignificantData;
+         return SingleStarDetector::NoSignificantData;
 
       /*
        * Update barycenter coordinates.
@@ -226,14 +226,14 @@ StarDetector::Status Detect( DPoint& pos, int& radius, float threshold, const Ge
           */
          if ( Abs( pos.x - lastPos.x ) < 0.005 && Abs( pos.y - lastPos.y ) < 0.005 )
             return (r.x0 > 0 && r.y0 > 0 && r.x1 < simg.Width() && r.y1 < simg.Height()) ?
-                        StarDetector::DetectedOk : StarDetector::CrossingEdges;
+                        SingleStarDetector::DetectedOk : SingleStarDetector::CrossingEdges;
       }
    }
 
-   return StarDetector::NoConvergence;
+   return SingleStarDetector::NoConvergence;
 }
 
-StarDetector::StarDetector( const ImageVariant& image, int channel,
+SingleStarDetector::SingleStarDetector( const ImageVariant& image, int channel,
                             const DPoint& pos, int radius, float threshold, bool autoAperture )
 {
    star.status = NotDetected;
@@ -285,4 +285,4 @@ StarDetector::StarDetector( const ImageVariant& image, int channel,
 } // pcl
 
 // ----------------------------------------------------------------------------
-// EOF StarDetector.cpp - Released 2019-01-21T12:06:42Z
+// EOF SingleStarDetector.cpp - Released 2019-01-21T12:06:42Z
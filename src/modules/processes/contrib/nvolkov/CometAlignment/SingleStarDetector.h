@@ -6,7 +6,7 @@
 // ----------------------------------------------------------------------------
 // Standard CometAlignment Process Module Version 01.02.06.0214
 // ----------------------------------------------------------------------------
-// StarDetector.h - Released 2019-01-21T12:06:42Z
+// SingleStarDetector.h - Released 2019-01-21T12:06:42Z
 // ----------------------------------------------------------------------------
 // This file is part of the standard CometAlignment PixInsight module.
 //
@@ -51,8 +51,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------------------------------------
 
-#ifndef __StarDetector_h
-#define __StarDetector_h
+#ifndef __SingleStarDetector_h
+#define __SingleStarDetector_h
 
 #include <pcl/ImageVariant.h>
 #include <pcl/MetaParameter.h>   // pcl_enum, pcl_bool
@@ -64,7 +64,7 @@ namespace pcl
 
 struct StarData
 {
-   pcl_enum status;  // error code (StarDetector::Status)
+   pcl_enum status;  // error code (SingleStarDetector::Status)
    int32    channel; // channel index (0=R/K, 1=G, 2=B)
    DRect    rect;    // selection rectangle
    DPoint   pos;     // barycenter position
@@ -74,7 +74,7 @@ struct StarData
    String StatusToString() const;
 };
 
-class StarDetector
+class SingleStarDetector
 {
 public:
 
@@ -91,7 +91,7 @@ public:
 
    StarData star;
 
-   StarDetector( const ImageVariant& img, int channel,
+   SingleStarDetector( const ImageVariant& img, int channel,
                  const DPoint& pos, int searchRadius = 8, float bkgThreshold = 1.0F,
                  bool autoAperture = true );
 
@@ -103,21 +103,21 @@ public:
 
 inline StarData::operator bool() const
 {
-   return status == StarDetector::DetectedOk;
+   return status == SingleStarDetector::DetectedOk;
 }
 
 inline String StarData::StatusToString() const
 {
    switch ( status )
    {
-   case StarDetector::NotDetected:       return "Not detected";
-   case StarDetector::DetectedOk:        return "Detected Ok";
-   case StarDetector::NoSignificantData: return "No significant data";
-   case StarDetector::CrossingEdges:     return "Crossing edges";
-   case StarDetector::OutsideImage:      return "Outside image";
-   case StarDetector::NoConvergence:     return "No convergence";
+   case SingleStarDetector::NotDetected:       return "Not detected";
+   case SingleStarDetector::DetectedOk:        return "Detected Ok";
+   case SingleStarDetector::NoSignificantData: return "No significant data";
+   case SingleStarDetector::CrossingEdges:     return "Crossing edges";
+   case SingleStarDetector::OutsideImage:      return "Outside image";
+   case SingleStarDetector::NoConvergence:     return "No convergence";
    default:
-   case StarDetector::UnknownError:      return "Unknown error";
+   case SingleStarDetector::UnknownError:      return "Unknown error";
    }
 }
 
@@ -125,7 +125,7 @@ inline String StarData::StatusToString() const
 
 } // pcl
 
-#endif   // __StarDetector_h
+#endif   // __SingleStarDetector_h
 
 // ----------------------------------------------------------------------------
-// EOF StarDetector.h - Released 2019-01-21T12:06:42Z
+// EOF SingleStarDetector.h - Released 2019-01-21T12:06:42Z
@@ -73,7 +73,8 @@ radius( int32( TheLHERadiusParameter->DefaultValue() ) ),
 histogramBins( LHEHistogramBins::Default ),
 slopeLimit( TheLHESlopeLimitParameter->DefaultValue() ),
 amount( TheLHEAmountParameter->DefaultValue() ),
-circularKernel( TheLHECircularKernelParameter->DefaultValue() )
+circularKernel( TheLHECircularKernelParameter->DefaultValue() ),
+algorithm( LHEAlgorithm::Default )
 {
 }
 
@@ -97,6 +98,7 @@ void LocalHistogramEqualizationInstance::Assign( const ProcessImplementation& p
       slopeLimit = x->slopeLimit;
       amount = x->amount;
       circularKernel = x->circularKernel;
+      algorithm = x->algorithm;
    }
 }
 
@@ -151,6 +153,12 @@ public:
          return;
       }
 
+      if ( instance.IsTiled() )
+      {
+         ApplyTiled( image, instance );
+         return;
+      }
+
       // create copy of the luminance to evaluate histogram from
       GenericImage<P> imageCopy( image );
       imageCopy.EnsureUnique(); // really not necessary, but we'll be safer if this is done
@@ -181,8 +189,400 @@ public:
       image.Status() = data.status;
    }
 
+   // tile-interpolated CLAHE: clipped CDFs are computed once for each node of
+   // a regular grid, with node spacing equal to the kernel radius, and the
+   // mapping of each pixel is bilinearly interpolated from the four nodes
+   // surrounding it
+   template <class P>
+   static void ApplyTiled( GenericImage<P>& image, const LocalHistogramEqualizationInstance& instance )
+   {
+      // histograms are evaluated on an unmodified copy of the image
+      GenericImage<P> imageCopy( image );
+      imageCopy.EnsureUnique();
+
+      TileGrid grid;
+      grid.Initialize( image.Width(), image.Height(), Max( 2, instance.GetRadius() ) );
+
+      // distribute grid intervals among threads, so that each node row is
+      // computed at most twice
+      int numberOfIntervals = grid.ny - 1;
+      int numberOfThreads = Thread::NumberOfThreads( numberOfIntervals, 1 );
+      int intervalsPerThread = numberOfIntervals/numberOfThreads;
+
+      image.Status().Initialize( "CLAHE (tile interpolation)", image.Height() );
+
+      AbstractImage::ThreadData data( image, image.Height() );
+
+      ReferenceArray<TileInterpolationThread<P> > threads;
+      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+         threads.Add( new TileInterpolationThread<P>( data,
+                                 instance,
+                                 image,
+                                 imageCopy,
+                                 grid,
+                                 i*intervalsPerThread,
+                                 (j < numberOfThreads) ? j*intervalsPerThread : numberOfIntervals ) );
+
+      AbstractImage::RunThreads( threads, data );
+
+      threads.Destroy();
+
+      image.Status() = data.status;
+   }
+
 private:
 
+   // creates clipped version of the histogram
+   // the histogram is clipped to ensure maximal required slope of its cumulative distribution function
+   // it is done by clipping each value in histogram and redistributing clipped values uniformly over
+   // the histogram
+   static void ClipHistogram( uint32* clippedHistogram, const uint32* histogram, uint32 histogramSize,
+                              uint32 valuesInHistogram, double limit )
+   {
+      // copy current histogram to clipped histogram
+      memcpy( clippedHistogram, histogram, histogramSize * sizeof(uint32) );
+
+      int clippedValues = 0;
+      int clippedValuesBefore;
+
+      // compute maximal limit for one histogram value from required slope
+      int histLimit = ( int )( limit * valuesInHistogram / (histogramSize-1) + 0.5f );
+      if (histLimit == 0) histLimit = 1;
+
+      int iterations = 0;
+
+      // start iterative clipping
+      do
+      {
+         clippedValuesBefore = clippedValues;
+         clippedValues = 0;
+
+         // clip all values over limit, accumulate amount of clipped values
+         for ( uint32 i = 0; i < histogramSize; i++ )
+         {
+            int32 d = (int32)clippedHistogram[i] - histLimit;
+            if ( d > 0 )
+            {
+               clippedValues += d;
+               clippedHistogram[i] = histLimit;
+            }
+         }
+
+         // number of clipped values should be less then in previous iteration
+         if ( iterations == 0 || clippedValues < clippedValuesBefore )
+         {
+            // compute amount to deliver to each value and rest
+            int32 d = clippedValues / histogramSize;
+            int32 m = clippedValues % histogramSize;
+            if ( d != 0 )
+            {
+               // distribute clipped values to whole histogram
+               for ( uint32 i = 0; i < histogramSize; i++ )
+                  clippedHistogram[i] += d;
+            }
+
+            if ( m != 0 )
+            {
+               // distribute uniformly the rest
+               int s = (histogramSize - 1) / m;
+               for ( uint32 i = 0; i < histogramSize; i += s )
+                  clippedHistogram[i]++;
+            }
+         }
+
+         iterations++;
+      }
+      // continue iterations as long as number of clipped values goes down
+      while ( iterations == 1 || clippedValues < clippedValuesBefore );
+   }
+
+   // geometry of the grid of tile nodes
+   // nodes are evenly distributed with the first and last nodes placed on the
+   // image borders; cellX/cellY and fracX/fracY give, for each pixel column
+   // and row, the index of the node preceding it and the interpolation weight
+   // of the next node
+   struct TileGrid
+   {
+      int          nx, ny;
+      Array<int>   nodeX, nodeY;
+      Array<int>   cellX, cellY;
+      Array<float> fracX, fracY;
+      Array<int>   firstRow;
+
+      void Initialize( int width, int height, int spacing )
+      {
+         nx = Max( 2, 1 + (width - 1 + spacing - 1)/spacing );
+         ny = Max( 2, 1 + (height - 1 + spacing - 1)/spacing );
+         InitializeAxis( nodeX, cellX, fracX, nx, width );
+         InitializeAxis( nodeY, cellY, fracY, ny, height );
+
+         // first pixel row of each grid interval
+         firstRow = Array<int>( size_type( ny ), height );
+         for ( int y = height; --y >= 0; )
+            firstRow[cellY[y]] = y;
+         for ( int j = ny-1; --j >= 0; )
+            if ( firstRow[j] > firstRow[j+1] )
+               firstRow[j] = firstRow[j+1];
+      }
+
+   private:
+
+      static void InitializeAxis( Array<int>& node, Array<int>& cell, Array<float>& frac, int n, int length )
+      {
+         double s = (length > 1) ? double( length - 1 )/(n - 1) : 1.0;
+         node = Array<int>( size_type( n ) );
+         for ( int i = 0; i < n; i++ )
+            node[i] = RoundInt( i*s );
+         cell = Array<int>( size_type( length ) );
+         frac = Array<float>( size_type( length ) );
+         for ( int x = 0; x < length; x++ )
+         {
+            double t = x/s;
+            int i = Min( TruncInt( t ), n-2 );
+            cell[x] = i;
+            frac[x] = float( Range( t - i, 0.0, 1.0 ) );
+         }
+      }
+   };
+
+   // Thread class, performs tile-interpolated CLAHE on a range of grid intervals
+   template <class P>
+   class TileInterpolationThread : public Thread
+   {
+   public:
+
+      TileInterpolationThread( const AbstractImage::ThreadData&          data,
+                               const LocalHistogramEqualizationInstance& instance,
+                               GenericImage<P>&                          imageDst,
+                               const GenericImage<P>&                    imageSrc,
+                               const TileGrid&                           grid,
+                               int                                       firstInterval,
+                               int                                       endInterval ) :
+      Thread(),
+      m_data( data ), m_instance( instance ), m_imageDst( imageDst ), m_imageSrc( imageSrc ), m_grid( grid ),
+      m_firstInterval( firstInterval ), m_endInterval( endInterval )
+      {
+      }
+
+      virtual void Run()
+      {
+         INIT_THREAD_MONITOR()
+
+         histogramSize = m_instance.GetHistogramSize();
+         limit = m_instance.GetLimit();
+         factor = (double)(histogramSize-1);
+         histogram = Array<uint32>( histogramSize );
+         clippedHistogram = Array<uint32>( histogramSize );
+         BuildKernelExtents();
+
+         // mapping functions of the two node rows bounding the current interval
+         Array<float> top( size_type( m_grid.nx )*histogramSize );
+         Array<float> bottom( size_type( m_grid.nx )*histogramSize );
+
+         int width = m_imageSrc.Width();
+         Array<uint16> value( m_imageSrc.Width() );
+         Array<float> L( m_imageSrc.Width() );
+         Array<float> out( m_imageSrc.Width() );
+         float amount = float( m_instance.GetAmount() );
+
+         for ( int j = m_firstInterval; j < m_endInterval; j++ )
+         {
+            if ( j == m_firstInterval )
+               ComputeMappings( top.Begin(), j );
+            else
+               pcl::Swap( top, bottom );
+            ComputeMappings( bottom.Begin(), j+1 );
+
+            for ( int y = m_grid.firstRow[j], y1 = m_grid.firstRow[j+1]; y < y1; y++ )
+            {
+               const typename P::sample* pS = m_imageSrc.ScanLine( y );
+                     typename P::sample* pL = m_imageDst.ScanLine( y );
+
+               // get pixel luminances and sample them to current histogram resolution
+               for ( int x = 0; x < width; x++ )
+               {
+                  P::FromSample( L[x], pS[x] );
+                  value[x] = uint16( Range( (uint32)(L[x]*factor), (uint32)0, (uint32)(histogramSize-1) ) );
+               }
+
+               InterpolateRow( out.Begin(), top.Begin(), bottom.Begin(), value.Begin(), L.Begin(), m_grid.fracY[y], amount, width );
+
+               for ( int x = 0; x < width; x++ )
+                  pL[x] = P::ToSample( out[x] );
+
+               UPDATE_THREAD_MONITOR( 16 )
+            }
+         }
+      }
+
+   private:
+
+      // extents of the kernel on each row, relative to its center, for the
+      // current kernel shape (square or circular)
+      void BuildKernelExtents()
+      {
+         int r = m_instance.GetRadius() - 1;
+         kernelExtent = Array<int>( size_type( 2*r + 1 ) );
+         for ( int ky = -r; ky <= r; ky++ )
+         {
+            int e = r;
+            if ( m_instance.IsCircular() )
+               while ( e > 0 && Sqrt( (double)( e*e + ky*ky ) ) > (double)r+1e-6 )
+                  --e;
+            kernelExtent[ky+r] = e;
+         }
+      }
+
+      // computes mapping functions (normalized CDFs of clipped histograms)
+      // of all nodes in the given node row
+      void ComputeMappings( float* mappings, int j )
+      {
+         int r = m_instance.GetRadius() - 1;
+         int width = m_imageSrc.Width();
+         int height = m_imageSrc.Height();
+         int cy = m_grid.nodeY[j];
+
+         for ( int i = 0; i < m_grid.nx; i++, mappings += histogramSize )
+         {
+            int cx = m_grid.nodeX[i];
+
+            ::memset( histogram.Begin(), 0, histogramSize * sizeof(uint32) );
+            uint32 valuesInHistogram = 0;
+
+            for ( int ky = -r; ky <= r; ky++ )
+            {
+               // mirror kernel rows on boundaries
+               int yy = cy + ky;
+               if ( yy < 0 ) yy = -yy;
+               if ( yy >= height ) yy = 2*(height-1) - yy;
+               if ( yy < 0 || yy >= height )
+                  continue;
+
+               const typename P::sample* pL = m_imageSrc.ScanLine( yy );
+               int e = kernelExtent[ky+r];
+               int x0 = cx - e, x1 = cx + e;
+
+               // fast path for kernel rows lying entirely within the image
+               if ( x0 >= 0 && x1 < width )
+               {
+                  for ( int xx = x0; xx <= x1; xx++ )
+                  {
+                     RGBColorSystem::sample L;
+                     P::FromSample( L, pL[xx] );
+                     histogram[Range( (uint32)(L*factor), (uint32)0, (uint32)(histogramSize-1) )]++;
+                  }
+                  valuesInHistogram += x1 - x0 + 1;
+               }
+               else
+               {
+                  for ( int x = x0; x <= x1; x++ )
+                  {
+                     int xx = x;
+                     if ( xx < 0 ) xx = -xx;
+                     if ( xx >= width ) xx = 2*(width-1) - xx;
+                     if ( xx < 0 || xx >= width )
+                        continue;
+                     RGBColorSystem::sample L;
+                     P::FromSample( L, pL[xx] );
+                     histogram[Range( (uint32)(L*factor), (uint32)0, (uint32)(histogramSize-1) )]++;
+                     valuesInHistogram++;
+                  }
+               }
+            }
+
+            ClipHistogram( clippedHistogram.Begin(), histogram.Begin(), histogramSize, valuesInHistogram, limit );
+
+            // find first nonzero value in histogram
+            uint32 cdfMin = 0;
+            for ( uint32 k = 0; k < histogramSize; k++ )
+               if ( clippedHistogram[k] != 0 )
+               {
+                  cdfMin = clippedHistogram[k];
+                  break;
+               }
+
+            uint32 cdfMax = 0;
+            for ( uint32 k = 0; k < histogramSize; k++ )
+               cdfMax += clippedHistogram[k];
+
+            // rescale cumulative distribution function to [0,1], or use an
+            // identity mapping for degenerate (empty) histograms
+            if ( cdfMax > cdfMin )
+            {
+               float s = 1.0F/(cdfMax - cdfMin);
+               uint32 cdf = 0;
+               for ( uint32 k = 0; k < histogramSize; k++ )
+               {
+                  cdf += clippedHistogram[k];
+                  // bins below the first nonzero bin have cdf < cdfMin
+                  mappings[k] = (cdf > cdfMin) ? (cdf - cdfMin)*s : 0.0F;
+               }
+            }
+            else
+               for ( uint32 k = 0; k < histogramSize; k++ )
+                  mappings[k] = float( k/factor );
+         }
+      }
+
+      // bilinear interpolation of the mapping functions of the four nodes
+      // surrounding each pixel of a row, blended with the original luminance
+      // according to the Amount parameter
+      void InterpolateRow( float* out, const float* top, const float* bottom,
+                           const uint16* value, const float* L, float fy, float amount, int width ) const
+      {
+         const int*   cellX = m_grid.cellX.Begin();
+         const float* fracX = m_grid.fracX.Begin();
+         int x = 0;
+#ifdef __PCL_HAVE_SSE2
+         const __m128 vfy = _mm_set1_ps( fy );
+         const __m128 va = _mm_set1_ps( amount );
+         const __m128 va1 = _mm_set1_ps( 1 - amount );
+         for ( ; x <= width-4; x += 4 )
+         {
+            float f00[ 4 ], f01[ 4 ], f10[ 4 ], f11[ 4 ];
+            for ( int k = 0; k < 4; k++ )
+            {
+               size_type i0 = size_type( cellX[x+k] )*histogramSize + value[x+k];
+               size_type i1 = i0 + histogramSize;
+               f00[k] = top[i0];
+               f01[k] = top[i1];
+               f10[k] = bottom[i0];
+               f11[k] = bottom[i1];
+            }
+            __m128 fx = _mm_loadu_ps( fracX + x );
+            __m128 a0 = _mm_loadu_ps( f00 );
+            __m128 a1 = _mm_loadu_ps( f10 );
+            a0 = _mm_add_ps( a0, _mm_mul_ps( fx, _mm_sub_ps( _mm_loadu_ps( f01 ), a0 ) ) );
+            a1 = _mm_add_ps( a1, _mm_mul_ps( fx, _mm_sub_ps( _mm_loadu_ps( f11 ), a1 ) ) );
+            __m128 m = _mm_add_ps( a0, _mm_mul_ps( vfy, _mm_sub_ps( a1, a0 ) ) );
+            _mm_storeu_ps( out + x, _mm_add_ps( _mm_mul_ps( va, m ), _mm_mul_ps( va1, _mm_loadu_ps( L + x ) ) ) );
+         }
+#endif
+         for ( ; x < width; x++ )
+         {
+            size_type i0 = size_type( cellX[x] )*histogramSize + value[x];
+            size_type i1 = i0 + histogramSize;
+            float a0 = top[i0] + fracX[x]*(top[i1] - top[i0]);
+            float a1 = bottom[i0] + fracX[x]*(bottom[i1] - bottom[i0]);
+            out[x] = amount*(a0 + fy*(a1 - a0)) + (1 - amount)*L[x];
+         }
+      }
+
+      const AbstractImage::ThreadData&          m_data;
+      const LocalHistogramEqualizationInstance& m_instance;
+            GenericImage<P>&                    m_imageDst;
+      const GenericImage<P>&                    m_imageSrc;
+      const TileGrid&                           m_grid;
+            int                                 m_firstInterval, m_endInterval;
+
+            Array<int>    kernelExtent;
+            uint32        histogramSize;
+            Array<uint32> histogram;
+            Array<uint32> clippedHistogram;
+            double        limit;
+            double        factor;
+   };
+
    // Thread class, performs CLAHE on given range of lines
    template <class P>
    class LocalHistogramEqualizationThread : public Thread
@@ -465,66 +865,9 @@ private:
       }
 
       // creates clipped version of the histogram
-      // the histogram is clipped to ensure maximal required slope of its cumulative distribution function
-      // it is done by clipping each value in histogram and redistributing clipped values uniformly over
-      // the histogram
       void ClipHistogram()
       {
-         // copy current histogram to clipped histogram
-         memcpy( clippedHistogram, histogram, histogramSize * sizeof(uint32) );
-
-         int clippedValues = 0;
-         int clippedValuesBefore;
-
-         // compute maximal limit for one histogram value from required slope
-         int histLimit = ( int )( limit * valuesInHistogram / (histogramSize-1) + 0.5f );
-         if (histLimit == 0) histLimit = 1;
-
-         int iterations = 0;
-
-         // start iterative clipping
-         do
-         {
-            clippedValuesBefore = clippedValues;
-            clippedValues = 0;
-
-            // clip all values over limit, accumulate amount of clipped values
-            for ( uint32 i = 0; i < histogramSize; i++ )
-            {
-               int32 d = (int32)clippedHistogram[i] - histLimit;
-               if ( d > 0 )
-               {
-                  clippedValues += d;
-                  clippedHistogram[i] = histLimit;
-               }
-            }
-
-            // number of clipped values should be less then in previous iteration
-            if ( iterations == 0 || clippedValues < clippedValuesBefore )
-            {
-               // compute amount to deliver to each value and rest
-               int32 d = clippedValues / histogramSize;
-               int32 m = clippedValues % histogramSize;
-               if ( d != 0 )
-               {
-                  // distribute clipped values to whole histogram
-                  for ( uint32 i = 0; i < histogramSize; i++ )
-                     clippedHistogram[i] += d;
-               }
-
-               if ( m != 0 )
-               {
-                  // distribute uniformly the rest
-                  int s = (histogramSize - 1) / m;
-                  for ( uint32 i = 0; i < histogramSize; i += s )
-                     clippedHistogram[i]++;
-               }
-            }
-
-            iterations++;
-         }
-         // continue iterations as long as number of clipped values goes down
-         while ( iterations == 1 || clippedValues < clippedValuesBefore );
+         LocalHistogramEqualizationEngine::ClipHistogram( clippedHistogram, histogram, histogramSize, valuesInHistogram, limit );
       }
 
       // compute new lightness value from old one, using cumulative distribution function
@@ -625,6 +968,8 @@ void* LocalHistogramEqualizationInstance::LockParameter( const MetaParameter* p,
       return &circularKernel;
    if ( p == TheLHEAmountParameter )
       return &amount;
+   if ( p == TheLHEAlgorithmParameter )
+      return &algorithm;
    return 0;
 }
 
@@ -643,6 +988,13 @@ int LocalHistogramEqualizationInstance::GetHistogramSize() const
 
 // ----------------------------------------------------------------------------
 
+bool LocalHistogramEqualizationInstance::IsTiled() const
+{
+   return algorithm == LHEAlgorithm::TileInterpolation;
+}
+
+// ----------------------------------------------------------------------------
+
 } // pcl
 
 // ----------------------------------------------------------------------------
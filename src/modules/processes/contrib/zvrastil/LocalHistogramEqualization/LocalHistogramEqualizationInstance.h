@@ -83,6 +83,7 @@ public:
    double GetLimit() const { return slopeLimit; }
    double GetAmount() const { return amount; }
    bool IsCircular() const { return circularKernel; }
+   bool IsTiled() const;
 
    void Preview( UInt16Image& ) const;
 
@@ -93,6 +94,7 @@ private:
    double   slopeLimit;
    double   amount;
    pcl_bool circularKernel;
+   pcl_enum algorithm;
 
    friend class LocalHistogramEqualizationProcess;
    friend class LocalHistogramEqualizationInterface;
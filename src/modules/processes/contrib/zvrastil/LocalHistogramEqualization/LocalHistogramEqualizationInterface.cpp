@@ -261,6 +261,7 @@ void LocalHistogramEqualizationInterface::UpdateControls()
    GUI->SlopeLimit_NumericControl.SetValue( instance.slopeLimit );
    GUI->Amount_NumericControl.SetValue( instance.amount );
    GUI->CircularKernel_CheckBox.SetChecked( instance.circularKernel );
+   GUI->Algorithm_ComboBox.SetCurrentItem( instance.algorithm );
 }
 
 void LocalHistogramEqualizationInterface::UpdateRealTimePreview()
@@ -301,6 +302,8 @@ void LocalHistogramEqualizationInterface::__ItemSelected( ComboBox& sender, int
 {
    if (sender == GUI->HistogramBins_ComboBox )
       instance.histogramBins = itemIndex;
+   else if ( sender == GUI->Algorithm_ComboBox )
+      instance.algorithm = itemIndex;
    UpdateRealTimePreview();
 }
 
@@ -324,6 +327,28 @@ LocalHistogramEqualizationInterface::GUIData::GUIData( LocalHistogramEqualizatio
    int labelWidth1 = fnt.Width( String( "Histogram Resolution:" ) ); // the longest label text
    int editWidth1 = fnt.Width( String( '0', 10 ) );
 
+   Algorithm_Label.SetText( "Algorithm:" );
+   Algorithm_Label.SetFixedWidth( labelWidth1 );
+   Algorithm_Label.SetToolTip( "<p>The method used to compute local contrast transfer functions.</p>"
+      "<p><b>Tile interpolation</b> evaluates clipped histograms on a grid of nodes spaced by the kernel radius, "
+      "and interpolates the resulting transfer functions bilinearly between nodes. This is the classic CLAHE "
+      "algorithm, and is orders of magnitude faster than the exact method for large kernels.</p>"
+      "<p><b>Exact</b> evaluates the histogram of the kernel centered on each pixel. This is the reference "
+      "implementation, and can be extremely slow for large images and kernels.</p>" );
+   Algorithm_Label.SetTextAlignment( TextAlign::Right|TextAlign::VertCenter );
+
+   Algorithm_ComboBox.AddItem( "Exact" );
+   Algorithm_ComboBox.AddItem( "Tile interpolation" );
+   Algorithm_ComboBox.SetToolTip( Algorithm_Label.ToolTip() );
+   Algorithm_ComboBox.OnItemSelected( (ComboBox::item_event_handler)&LocalHistogramEqualizationInterface::__ItemSelected, w );
+
+   Algorithm_Sizer.Add( Algorithm_Label );
+   Algorithm_Sizer.AddSpacing( 4 );
+   Algorithm_Sizer.Add( Algorithm_ComboBox );
+   Algorithm_Sizer.AddStretch();
+
+   //
+
    Radius_NumericControl.label.SetText( "Kernel Radius:" );
    Radius_NumericControl.label.SetFixedWidth( labelWidth1 );
    Radius_NumericControl.slider.SetScaledMinWidth( 250 );
@@ -397,6 +422,7 @@ LocalHistogramEqualizationInterface::GUIData::GUIData( LocalHistogramEqualizatio
 
    Global_Sizer.SetMargin( 8 );
    Global_Sizer.SetSpacing( 6 );
+   Global_Sizer.Add( Algorithm_Sizer );
    Global_Sizer.Add( Radius_NumericControl );
    Global_Sizer.Add( SlopeLimit_NumericControl );
    Global_Sizer.Add( Amount_NumericControl );
@@ -130,6 +130,9 @@ private:
       GUIData( LocalHistogramEqualizationInterface& );
 
       VerticalSizer     Global_Sizer;
+         HorizontalSizer   Algorithm_Sizer;
+            Label             Algorithm_Label;
+            ComboBox          Algorithm_ComboBox;
          NumericControl    Radius_NumericControl;
          HorizontalSizer   HistogramBins_Sizer;
             Label             HistogramBins_Label;
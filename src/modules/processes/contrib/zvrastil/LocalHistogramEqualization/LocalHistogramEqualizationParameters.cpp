@@ -63,6 +63,7 @@ LHEHistogramBins*  TheLHEHistogramBinsParameter = 0;
 LHESlopeLimit*     TheLHESlopeLimitParameter = 0;
 LHEAmount*         TheLHEAmountParameter = 0;
 LHECircularKernel* TheLHECircularKernelParameter = 0;
+LHEAlgorithm*      TheLHEAlgorithmParameter = 0;
 
 // ----------------------------------------------------------------------------
 
@@ -214,6 +215,43 @@ bool LHECircularKernel::DefaultValue() const
 
 // ----------------------------------------------------------------------------
 
+LHEAlgorithm::LHEAlgorithm( MetaProcess* P ) : MetaEnumeration( P )
+{
+   TheLHEAlgorithmParameter = this;
+}
+
+IsoString LHEAlgorithm::Id() const
+{
+   return "algorithm";
+}
+
+size_type LHEAlgorithm::NumberOfElements() const
+{
+   return NumberOfItems;
+}
+
+IsoString LHEAlgorithm::ElementId( size_type i ) const
+{
+   switch ( i )
+   {
+   case Exact:             return "Exact";
+   default:
+   case TileInterpolation: return "TileInterpolation";
+   }
+}
+
+int LHEAlgorithm::ElementValue( size_type i ) const
+{
+   return int( i );
+}
+
+size_type LHEAlgorithm::DefaultValueIndex() const
+{
+   return Default;
+}
+
+// ----------------------------------------------------------------------------
+
 } // pcl
 
 // ----------------------------------------------------------------------------
@@ -157,6 +157,29 @@ extern LHECircularKernel* TheLHECircularKernelParameter;
 
 // ----------------------------------------------------------------------------
 
+class LHEAlgorithm : public MetaEnumeration
+{
+public:
+
+   enum { Exact,
+          TileInterpolation,
+          NumberOfItems,
+          Default = Exact };
+
+   LHEAlgorithm( MetaProcess* );
+
+   virtual IsoString Id() const;
+
+   virtual size_type NumberOfElements() const;
+   virtual IsoString ElementId( size_type ) const;
+   virtual int ElementValue( size_type ) const;
+   virtual size_type DefaultValueIndex() const;
+};
+
+extern LHEAlgorithm* TheLHEAlgorithmParameter;
+
+// ----------------------------------------------------------------------------
+
 PCL_END_LOCAL
 
 } // pcl
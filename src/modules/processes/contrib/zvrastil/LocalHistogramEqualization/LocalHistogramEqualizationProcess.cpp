@@ -84,6 +84,7 @@ LocalHistogramEqualizationProcess::LocalHistogramEqualizationProcess() : MetaPro
    new LHESlopeLimit( this );
    new LHEAmount( this );
    new LHECircularKernel( this );
+   new LHEAlgorithm( this );
 }
 
 IsoString LocalHistogramEqualizationProcess::Id() const
@@ -165,6 +166,14 @@ static void ShowHelp()
 "\n      Enables or disables the circular kernel. When disabled, a square"
 "\n      kernel is used. (default = circular)"
 "\n"
+"\n-t[+|-] | --tiled[+|-]"
+"\n"
+"\n      Enables or disables tile interpolation. When enabled, contrast transfer"
+"\n      functions are computed on a grid of nodes spaced by the kernel radius"
+"\n      and interpolated bilinearly. When disabled, an exact sliding window"
+"\n      histogram is evaluated for each pixel, which is much slower."
+"\n      (default = exact)"
+"\n"
 "\n--interface"
 "\n"
 "\n      Launches the interface of this process."
@@ -211,11 +220,14 @@ int LocalHistogramEqualizationProcess::ProcessCommandLine( const StringList& arg
       else if ( arg.IsSwitch() )
       {
          if (arg.Id() == "c" || arg.Id() == "-circular") instance.circularKernel = arg.SwitchState();
+         else if (arg.Id() == "t" || arg.Id() == "-tiled")
+            instance.algorithm = arg.SwitchState() ? LHEAlgorithm::TileInterpolation : LHEAlgorithm::Exact;
          else throw Error( "Unknown switch argument: " + arg.Token() );
       }
       else if ( arg.IsLiteral() )
       {
          if (arg.Id() == "c" || arg.Id() == "-circular") instance.circularKernel = true;
+         else if (arg.Id() == "t" || arg.Id() == "-tiled") instance.algorithm = LHEAlgorithm::TileInterpolation;
          // These are standard parameters that all processes should provide.
          else if ( arg.Id() == "-interface" )
             launchInterface = true;
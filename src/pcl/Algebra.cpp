@@ -50,53 +50,827 @@
 // ----------------------------------------------------------------------------
 
 #include <pcl/Algebra.h>
+#include <pcl/Math.h>
+#include <pcl/Thread.h>
+#include <pcl/ThreadPool.h>
 
-#include <pcl/api/APIException.h>
-#include <pcl/api/APIInterface.h>
+#include <limits>
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#  define __PCL_HAVE_AVX2_GEMM_KERNELS   1
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define __PCL_GEMM_TARGET( features )
+#  else
+#    include <immintrin.h>
+#    define __PCL_GEMM_TARGET( features ) __attribute__ ((target( features )))
+#  endif
+#endif
 
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
-void PCL_FUNC InPlaceGaussJordan( Matrix& A, Matrix& B )
+/*
+ * General matrix multiplication: C += alpha*A*B, where A is an n x p matrix, B
+ * is a p x m matrix and C is an n x m matrix.
+ *
+ * This is the well-known Goto/BLIS scheme: the operands are partitioned into
+ * blocks that fit in the L1, L2 and L3 caches, blocks are packed into
+ * contiguous buffers of MR-row (A) and NR-column (B) slivers, padded with
+ * zeros, and the product is computed by a register-blocked micro-kernel that
+ * updates an MR x NR tile of C.
+ *
+ * The A and B operands are addressed with arbitrary row and column strides,
+ * so transposed matrices and submatrices can be multiplied without copying
+ * them. The C operand has unit column stride and row stride ldc.
+ */
+
+/*
+ * Portable micro-kernel. The inner loop is simple enough to be vectorized by
+ * the compiler for the instruction set selected at build time.
+ */
+template <typename T, int MR, int NR>
+static void GEMMKernel( int kc, const T* a, const T* b, T* c, distance_type ldc, int mr, int nr, T alpha )
+{
+   T ab[ MR*NR ];
+   for ( int i = 0; i < MR*NR; ++i )
+      ab[i] = 0;
+   for ( int k = 0; k < kc; ++k, a += MR, b += NR )
+      for ( int i = 0; i < MR; ++i )
+         for ( int j = 0; j < NR; ++j )
+            ab[i*NR + j] += a[i]*b[j];
+   for ( int i = 0; i < mr; ++i, c += ldc )
+      for ( int j = 0; j < nr; ++j )
+         c[j] += alpha*ab[i*NR + j];
+}
+
+#ifdef __PCL_HAVE_AVX2_GEMM_KERNELS
+
+/*
+ * AVX2/FMA micro-kernels: 6x8 tiles for double and 6x16 tiles for float, held
+ * in twelve 256-bit accumulators.
+ */
+
+__PCL_GEMM_TARGET( "avx2,fma" )
+static void GEMMKernelAVX2( int kc, const double* a, const double* b, double* c, distance_type ldc, int mr, int nr, double alpha )
+{
+   __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd(),
+           c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd(),
+           c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd(),
+           c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd(),
+           c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd(),
+           c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+   for ( int k = 0; k < kc; ++k, a += 6, b += 8 )
+   {
+      __m256d b0 = _mm256_loadu_pd( b );
+      __m256d b1 = _mm256_loadu_pd( b+4 );
+      __m256d ai;
+      ai = _mm256_broadcast_sd( a   ); c00 = _mm256_fmadd_pd( ai, b0, c00 ); c01 = _mm256_fmadd_pd( ai, b1, c01 );
+      ai = _mm256_broadcast_sd( a+1 ); c10 = _mm256_fmadd_pd( ai, b0, c10 ); c11 = _mm256_fmadd_pd( ai, b1, c11 );
+      ai = _mm256_broadcast_sd( a+2 ); c20 = _mm256_fmadd_pd( ai, b0, c20 ); c21 = _mm256_fmadd_pd( ai, b1, c21 );
+      ai = _mm256_broadcast_sd( a+3 ); c30 = _mm256_fmadd_pd( ai, b0, c30 ); c31 = _mm256_fmadd_pd( ai, b1, c31 );
+      ai = _mm256_broadcast_sd( a+4 ); c40 = _mm256_fmadd_pd( ai, b0, c40 ); c41 = _mm256_fmadd_pd( ai, b1, c41 );
+      ai = _mm256_broadcast_sd( a+5 ); c50 = _mm256_fmadd_pd( ai, b0, c50 ); c51 = _mm256_fmadd_pd( ai, b1, c51 );
+   }
+
+   __m256d r[ 12 ] = { c00, c01, c10, c11, c20, c21, c30, c31, c40, c41, c50, c51 };
+   __m256d va = _mm256_set1_pd( alpha );
+   if ( mr == 6 && nr == 8 )
+   {
+      for ( int i = 0; i < 6; ++i, c += ldc )
+      {
+         _mm256_storeu_pd( c,   _mm256_fmadd_pd( va, r[2*i],   _mm256_loadu_pd( c ) ) );
+         _mm256_storeu_pd( c+4, _mm256_fmadd_pd( va, r[2*i+1], _mm256_loadu_pd( c+4 ) ) );
+      }
+   }
+   else
+   {
+      // Partial tile at the bottom/right borders of C.
+      double ab[ 48 ];
+      for ( int i = 0; i < 12; ++i )
+         _mm256_storeu_pd( ab + 4*i, r[i] );
+      for ( int i = 0; i < mr; ++i, c += ldc )
+         for ( int j = 0; j < nr; ++j )
+            c[j] += alpha*ab[i*8 + j];
+   }
+}
+
+__PCL_GEMM_TARGET( "avx2,fma" )
+static void GEMMKernelAVX2( int kc, const float* a, const float* b, float* c, distance_type ldc, int mr, int nr, float alpha )
+{
+   __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(),
+          c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps(),
+          c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(),
+          c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps(),
+          c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(),
+          c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+   for ( int k = 0; k < kc; ++k, a += 6, b += 16 )
+   {
+      __m256 b0 = _mm256_loadu_ps( b );
+      __m256 b1 = _mm256_loadu_ps( b+8 );
+      __m256 ai;
+      ai = _mm256_broadcast_ss( a   ); c00 = _mm256_fmadd_ps( ai, b0, c00 ); c01 = _mm256_fmadd_ps( ai, b1, c01 );
+      ai = _mm256_broadcast_ss( a+1 ); c10 = _mm256_fmadd_ps( ai, b0, c10 ); c11 = _mm256_fmadd_ps( ai, b1, c11 );
+      ai = _mm256_broadcast_ss( a+2 ); c20 = _mm256_fmadd_ps( ai, b0, c20 ); c21 = _mm256_fmadd_ps( ai, b1, c21 );
+      ai = _mm256_broadcast_ss( a+3 ); c30 = _mm256_fmadd_ps( ai, b0, c30 ); c31 = _mm256_fmadd_ps( ai, b1, c31 );
+      ai = _mm256_broadcast_ss( a+4 ); c40 = _mm256_fmadd_ps( ai, b0, c40 ); c41 = _mm256_fmadd_ps( ai, b1, c41 );
+      ai = _mm256_broadcast_ss( a+5 ); c50 = _mm256_fmadd_ps( ai, b0, c50 ); c51 = _mm256_fmadd_ps( ai, b1, c51 );
+   }
+
+   __m256 r[ 12 ] = { c00, c01, c10, c11, c20, c21, c30, c31, c40, c41, c50, c51 };
+   __m256 va = _mm256_set1_ps( alpha );
+   if ( mr == 6 && nr == 16 )
+   {
+      for ( int i = 0; i < 6; ++i, c += ldc )
+      {
+         _mm256_storeu_ps( c,   _mm256_fmadd_ps( va, r[2*i],   _mm256_loadu_ps( c ) ) );
+         _mm256_storeu_ps( c+8, _mm256_fmadd_ps( va, r[2*i+1], _mm256_loadu_ps( c+8 ) ) );
+      }
+   }
+   else
+   {
+      // Partial tile at the bottom/right borders of C.
+      float ab[ 96 ];
+      for ( int i = 0; i < 12; ++i )
+         _mm256_storeu_ps( ab + 8*i, r[i] );
+      for ( int i = 0; i < mr; ++i, c += ldc )
+         for ( int j = 0; j < nr; ++j )
+            c[j] += alpha*ab[i*16 + j];
+   }
+}
+
+static const bool s_hasAVX2 = IsAVX2InstructionSetSupported();
+
+#endif   // __PCL_HAVE_AVX2_GEMM_KERNELS
+
+/*
+ * Selection of the best micro-kernel available on the running machine.
+ */
+template <typename T>
+struct PCL_GEMMKernel
+{
+   typedef void (*kernel_function)( int, const T*, const T*, T*, distance_type, int, int, T );
+
+   kernel_function kernel;
+   int             MR, NR;
+
+   PCL_GEMMKernel()
+   {
+#ifdef __PCL_HAVE_AVX2_GEMM_KERNELS
+      if ( s_hasAVX2 )
+      {
+         kernel = GEMMKernelAVX2;
+         MR = 6;
+         NR = 64/int( sizeof( T ) );
+         return;
+      }
+#endif
+      kernel = GEMMKernel<T, 4, 8>;
+      MR = 4;
+      NR = 8;
+   }
+};
+
+template <typename T>
+static void GEMM( int n, int m, int p, T alpha,
+                  const T* A, distance_type rsA, distance_type csA,
+                  const T* B, distance_type rsB, distance_type csB,
+                  T* C, distance_type ldc )
+{
+   if ( n <= 0 || m <= 0 || p <= 0 )
+      return;
+
+   const PCL_GEMMKernel<T> K;
+   const int MR = K.MR;
+   const int NR = K.NR;
+
+   /*
+    * Blocking parameters: A KC x NR sliver of B stays in the L1 cache, an
+    * MC x KC block of A in L2, and a KC x NC panel of B in L3.
+    */
+   const int KC = 256;
+   const int NC = 4096;
+   int MC = 120/MR*MR;
+
+   /*
+    * Blocks of A are distributed among threads. For relatively small matrices
+    * the block height is reduced to keep all threads busy.
+    */
+   int numberOfThreads = (double( n )*m*p >= 2097152.0) ? Thread::NumberOfThreads( (n + MR - 1)/MR, 1 ) : 1;
+   if ( numberOfThreads > 1 )
+      MC = Max( MR, Min( MC, ((n + numberOfThreads - 1)/numberOfThreads + MR - 1)/MR*MR ) );
+
+   GenericVector<T> Bp( KC*((Min( NC, m ) + NR - 1)/NR*NR) );
+
+   for ( int jc = 0; jc < m; jc += NC )
+   {
+      int nc = Min( NC, m - jc );
+      int np = (nc + NR - 1)/NR;
+
+      for ( int pc = 0; pc < p; pc += KC )
+      {
+         int kc = Min( KC, p - pc );
+
+         /*
+          * Pack a KC x NC panel of B into NR-column slivers.
+          */
+         ThreadPool::ParallelFor( 0, np,
+            [&]( size_type j0, size_type j1 )
+            {
+               for ( size_type jp = j0; jp < j1; ++jp )
+               {
+                  T* bp = Bp.Begin() + jp*kc*NR;
+                  int j = jc + int( jp )*NR;
+                  int nr = Min( NR, jc + nc - j );
+                  for ( int k = 0; k < kc; ++k, bp += NR )
+                  {
+                     const T* b = B + (pc + k)*rsB + j*csB;
+                     int jj = 0;
+                     if ( csB == 1 )
+                        for ( ; jj < nr; ++jj )
+                           bp[jj] = b[jj];
+                     else
+                        for ( ; jj < nr; ++jj )
+                           bp[jj] = b[jj*csB];
+                     for ( ; jj < NR; ++jj )
+                        bp[jj] = 0;
+                  }
+               }
+            }, 0, numberOfThreads );
+
+         /*
+          * Pack MC x KC blocks of A into MR-row slivers and multiply them by
+          * the packed panel of B.
+          */
+         ThreadPool::ParallelFor( 0, (n + MC - 1)/MC,
+            [&]( size_type b0, size_type b1 )
+            {
+               GenericVector<T> Ap( (MC + MR)*kc );
+               for ( size_type ib = b0; ib < b1; ++ib )
+               {
+                  int ic = int( ib )*MC;
+                  int mc = Min( MC, n - ic );
+
+                  T* ap = Ap.Begin();
+                  for ( int ip = 0; ip < mc; ip += MR )
+                  {
+                     int mr = Min( MR, mc - ip );
+                     for ( int k = 0; k < kc; ++k, ap += MR )
+                     {
+                        const T* a = A + (ic + ip)*rsA + (pc + k)*csA;
+                        int ii = 0;
+                        for ( ; ii < mr; ++ii )
+                           ap[ii] = a[ii*rsA];
+                        for ( ; ii < MR; ++ii )
+                           ap[ii] = 0;
+                     }
+                  }
+
+                  for ( int jp = 0; jp < np; ++jp )
+                  {
+                     int j = jc + jp*NR;
+                     int nr = Min( NR, jc + nc - j );
+                     const T* bp = Bp.Begin() + jp*kc*NR;
+                     for ( int ip = 0; ip < mc; ip += MR )
+                        K.kernel( kc, Ap.Begin() + ip*kc, bp, C + (ic + ip)*ldc + j, ldc, Min( MR, mc - ip ), nr, alpha );
+                  }
+               }
+            }, 1, numberOfThreads );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+static void MatrixProduct( GenericMatrix<T>& R, const GenericMatrix<T>& A, const GenericMatrix<T>& B )
 {
+   int n = R.Rows();
+   int m = R.Cols();
+   int p = A.Cols();
+
+   /*
+    * Packing overhead does not pay off for very small matrices.
+    */
+   if ( double( n )*m*p < 32768.0 )
+   {
+      MatrixProductImplementation<T>( R, A, B );
+      return;
+   }
+
+   R = T( 0 );
+   GEMM( n, m, p, T( 1 ), A.Begin(), p, 1, B.Begin(), m, 1, R.Begin(), m );
+}
+
+void PCL_FUNC MatrixProductImplementation( Matrix& R, const Matrix& A, const Matrix& B )
+{
+   MatrixProduct( R, A, B );
+}
+
+void PCL_FUNC MatrixProductImplementation( FMatrix& R, const FMatrix& A, const FMatrix& B )
+{
+   MatrixProduct( R, A, B );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Solution of T*X = B in place for a triangular n x n matrix T, whose element
+ * (i,j) is t[i*rs + j*cs], and an n x m matrix B with row stride ldb.
+ *
+ * The system is solved by diagonal blocks. Off-diagonal blocks are applied as
+ * matrix products, so nearly all of the work is done by GEMM.
+ */
+template <typename T>
+static void TriangularSolve( int n, int m, const T* t, distance_type rs, distance_type cs,
+                             bool lower, bool unitDiagonal, T* b, distance_type ldb )
+{
+   const int NB = 64;
+   if ( lower )
+   {
+      for ( int i0 = 0; i0 < n; i0 += NB )
+      {
+         int i1 = Min( i0 + NB, n );
+         GEMM( i1 - i0, m, i0, T( -1 ), t + i0*rs, rs, cs, b, ldb, 1, b + i0*ldb, ldb );
+         for ( int i = i0; i < i1; ++i )
+         {
+            T* bi = b + i*ldb;
+            for ( int j = i0; j < i; ++j )
+            {
+               T tij = t[i*rs + j*cs];
+               if ( tij != 0 )
+               {
+                  const T* bj = b + j*ldb;
+                  for ( int k = 0; k < m; ++k )
+                     bi[k] -= tij*bj[k];
+               }
+            }
+            if ( !unitDiagonal )
+            {
+               T d = 1/t[i*(rs + cs)];
+               for ( int k = 0; k < m; ++k )
+                  bi[k] *= d;
+            }
+         }
+      }
+   }
+   else
+   {
+      for ( int i1 = n; i1 > 0; i1 -= NB )
+      {
+         int i0 = Max( 0, i1 - NB );
+         GEMM( i1 - i0, m, n - i1, T( -1 ), t + i0*rs + i1*cs, rs, cs, b + i1*ldb, ldb, 1, b + i0*ldb, ldb );
+         for ( int i = i1; --i >= i0; )
+         {
+            T* bi = b + i*ldb;
+            for ( int j = i+1; j < i1; ++j )
+            {
+               T tij = t[i*rs + j*cs];
+               if ( tij != 0 )
+               {
+                  const T* bj = b + j*ldb;
+                  for ( int k = 0; k < m; ++k )
+                     bi[k] -= tij*bj[k];
+               }
+            }
+            if ( !unitDiagonal )
+            {
+               T d = 1/t[i*(rs + cs)];
+               for ( int k = 0; k < m; ++k )
+                  bi[k] *= d;
+            }
+         }
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Blocked right-looking LU decomposition with partial pivoting: P*A = L*U.
+ */
+template <typename T>
+static void LUDecomposition( GenericMatrix<T>& A, IVector& P )
+{
+   int n = A.Rows();
+   if ( A.Cols() != n || n == 0 )
+      throw Error( "LU decomposition: Non-square or empty matrix." );
+
    A.EnsureUnique();
+   P = IVector( n );
+   T* a = A.Begin();
+
+   const int NB = 64;
+   for ( int k0 = 0; k0 < n; k0 += NB )
+   {
+      int k1 = Min( k0 + NB, n );
+
+      /*
+       * Unblocked factorization of the current panel A[k0:n,k0:k1]. Row
+       * interchanges are applied to entire rows.
+       */
+      for ( int k = k0; k < k1; ++k )
+      {
+         int ip = k;
+         T pmax = Abs( a[k*n + k] );
+         for ( int i = k+1; i < n; ++i )
+         {
+            T x = Abs( a[i*n + k] );
+            if ( x > pmax )
+            {
+               pmax = x;
+               ip = i;
+            }
+         }
+         if ( pmax == 0 )
+            throw Error( "LU decomposition: Singular matrix." );
+
+         P[k] = ip;
+         if ( ip != k )
+         {
+            T* rk = a + k*n;
+            T* ri = a + ip*n;
+            for ( int j = 0; j < n; ++j )
+               pcl::Swap( rk[j], ri[j] );
+         }
+
+         const T* rk = a + k*n;
+         T d = 1/rk[k];
+         for ( int i = k+1; i < n; ++i )
+         {
+            T* ri = a + i*n;
+            T l = ri[k] *= d;
+            if ( l != 0 )
+               for ( int j = k+1; j < k1; ++j )
+                  ri[j] -= l*rk[j];
+         }
+      }
+
+      if ( k1 < n )
+      {
+         // U12 = L11^-1 * A12
+         TriangularSolve( k1 - k0, n - k1, a + k0*n + k0, n, 1, true/*lower*/, true/*unitDiagonal*/, a + k0*n + k1, n );
+         // A22 -= L21 * U12
+         GEMM( n - k1, n - k1, k1 - k0, T( -1 ), a + k1*n + k0, n, 1, a + k0*n + k1, n, 1, a + k1*n + k1, n );
+      }
+   }
+}
+
+template <typename T>
+static void LUSolve( const GenericMatrix<T>& LU, const IVector& P, GenericMatrix<T>& B )
+{
+   int n = LU.Rows();
+   if ( LU.Cols() != n || P.Length() != n || B.Rows() != n )
+      throw Error( "LU solve: Incompatible matrix dimensions." );
+
+   int m = B.Cols();
+   if ( n == 0 || m == 0 )
+      return;
+
    B.EnsureUnique();
-   if ( (*API->Numerical->GaussJordanInPlaceD)( A.DataPtr(), B.DataPtr(), A.Rows(), B.Columns() ) == api_false )
-      throw APIFunctionError( "GaussJordanInPlaceD" );
+   T* b = B.Begin();
+
+   for ( int k = 0; k < n; ++k )
+      if ( P[k] != k )
+      {
+         T* bk = b + k*m;
+         T* bi = b + P[k]*m;
+         for ( int j = 0; j < m; ++j )
+            pcl::Swap( bk[j], bi[j] );
+      }
+
+   TriangularSolve( n, m, LU.Begin(), n, 1, true/*lower*/, true/*unitDiagonal*/, b, m );
+   TriangularSolve( n, m, LU.Begin(), n, 1, false/*lower*/, false/*unitDiagonal*/, b, m );
 }
 
-void PCL_FUNC InPlaceGaussJordan( FMatrix& A, FMatrix& B )
+void PCL_FUNC LUDecompositionImplementation( Matrix& A, IVector& P )
+{
+   LUDecomposition( A, P );
+}
+
+void PCL_FUNC LUDecompositionImplementation( FMatrix& A, IVector& P )
+{
+   LUDecomposition( A, P );
+}
+
+void PCL_FUNC LUSolveImplementation( const Matrix& LU, const IVector& P, Matrix& B )
+{
+   LUSolve( LU, P, B );
+}
+
+void PCL_FUNC LUSolveImplementation( const FMatrix& LU, const IVector& P, FMatrix& B )
+{
+   LUSolve( LU, P, B );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Blocked Cholesky decomposition: A = L*Lt.
+ */
+template <typename T>
+static void CholeskyDecomposition( GenericMatrix<T>& A )
 {
+   int n = A.Rows();
+   if ( A.Cols() != n || n == 0 )
+      throw Error( "Cholesky decomposition: Non-square or empty matrix." );
+
    A.EnsureUnique();
+   T* a = A.Begin();
+
+   const int NB = 64;
+   for ( int k0 = 0; k0 < n; k0 += NB )
+   {
+      int k1 = Min( k0 + NB, n );
+
+      /*
+       * Unblocked factorization of the current panel A[k0:n,k0:k1], including
+       * the diagonal block L11 and L21 = A21 * L11^-T.
+       */
+      for ( int j = k0; j < k1; ++j )
+      {
+         T* rj = a + j*n;
+         T s = rj[j];
+         for ( int l = k0; l < j; ++l )
+            s -= rj[l]*rj[l];
+         if ( !(s > 0) )
+            throw Error( "Cholesky decomposition: Matrix not positive definite." );
+         s = rj[j] = Sqrt( s );
+         T d = 1/s;
+         for ( int i = j+1; i < n; ++i )
+         {
+            T* ri = a + i*n;
+            T x = ri[j];
+            for ( int l = k0; l < j; ++l )
+               x -= ri[l]*rj[l];
+            ri[j] = x*d;
+         }
+      }
+
+      /*
+       * A22 -= L21 * L21t, computed by horizontal strips of the lower
+       * triangle.
+       */
+      const int CB = 256;
+      for ( int i0 = k1; i0 < n; i0 += CB )
+      {
+         int i1 = Min( i0 + CB, n );
+         GEMM( i1 - i0, i1 - k1, k1 - k0, T( -1 ), a + i0*n + k0, n, 1, a + k1*n + k0, 1, n, a + i0*n + k1, n );
+      }
+   }
+
+   for ( int i = 0; i < n; ++i )
+      for ( int j = i+1; j < n; ++j )
+         a[i*n + j] = 0;
+}
+
+template <typename T>
+static void CholeskySolve( const GenericMatrix<T>& L, GenericMatrix<T>& B )
+{
+   int n = L.Rows();
+   if ( L.Cols() != n || B.Rows() != n )
+      throw Error( "Cholesky solve: Incompatible matrix dimensions." );
+
+   int m = B.Cols();
+   if ( n == 0 || m == 0 )
+      return;
+
    B.EnsureUnique();
-   if ( (*API->Numerical->GaussJordanInPlaceF)( A.DataPtr(), B.DataPtr(), A.Rows(), B.Columns() ) == api_false )
-      throw APIFunctionError( "GaussJordanInPlaceF" );
+   TriangularSolve( n, m, L.Begin(), n, 1, true/*lower*/, false/*unitDiagonal*/, B.Begin(), m );
+   TriangularSolve( n, m, L.Begin(), 1, n, false/*lower*/, false/*unitDiagonal*/, B.Begin(), m );
+}
+
+void PCL_FUNC CholeskyDecompositionImplementation( Matrix& A )
+{
+   CholeskyDecomposition( A );
+}
+
+void PCL_FUNC CholeskyDecompositionImplementation( FMatrix& A )
+{
+   CholeskyDecomposition( A );
+}
+
+void PCL_FUNC CholeskySolveImplementation( const Matrix& L, Matrix& B )
+{
+   CholeskySolve( L, B );
+}
+
+void PCL_FUNC CholeskySolveImplementation( const FMatrix& L, FMatrix& B )
+{
+   CholeskySolve( L, B );
 }
 
 // ----------------------------------------------------------------------------
 
-void PCL_FUNC InPlaceSVDImplementation( Matrix& A, Vector& W, Matrix& V )
+/*
+ * Gauss-Jordan solver, implemented as an LU decomposition followed by forward
+ * and backward substitutions for the inverse matrix and the solution vectors.
+ */
+template <typename T>
+static void GaussJordan( GenericMatrix<T>& A, GenericMatrix<T>& B )
+{
+   int n = A.Rows();
+   if ( A.Cols() != n || n == 0 )
+      throw Error( "InPlaceGaussJordan(): Non-square or empty matrix." );
+   if ( B.Rows() != n )
+      throw Error( "InPlaceGaussJordan(): Incompatible matrix dimensions." );
+
+   IVector P;
+   LUDecomposition( A, P );
+
+   GenericMatrix<T> Ai = GenericMatrix<T>::UnitMatrix( n );
+   LUSolve( A, P, Ai );
+
+   /*
+    * Matrix inversion routines call us with a unit matrix on the right-hand
+    * side. Do not solve the same system twice.
+    */
+   bool isUnit = B.Cols() == n;
+   for ( int i = 0; i < n && isUnit; ++i )
+   {
+      const T* bi = B[i];
+      for ( int j = 0; j < n; ++j )
+         if ( bi[j] != ((i == j) ? T( 1 ) : T( 0 )) )
+         {
+            isUnit = false;
+            break;
+         }
+   }
+   if ( isUnit )
+      B = Ai;
+   else
+      LUSolve( A, P, B );
+
+   A = Ai;
+}
+
+void PCL_FUNC InPlaceGaussJordan( Matrix& A, Matrix& B )
+{
+   GaussJordan( A, B );
+}
+
+void PCL_FUNC InPlaceGaussJordan( FMatrix& A, FMatrix& B )
+{
+   GaussJordan( A, B );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * One-sided Jacobi singular value decomposition (Hestenes' method).
+ *
+ * Pairs of columns of A are orthogonalized by plane rotations, which are
+ * accumulated in V, until all columns are mutually orthogonal within the
+ * machine precision. Then the singular values are the Euclidean norms of the
+ * columns, and the normalized columns are the left singular vectors.
+ *
+ * We work with the transposed matrices, so that column rotations are
+ * performed on contiguous rows. The column pairs of each sweep are generated
+ * with a round-robin ordering, which yields n/2 disjoint pairs per step that
+ * can be rotated in parallel.
+ */
+template <typename T>
+static void JacobiSVD( GenericMatrix<T>& A, GenericVector<T>& W, GenericMatrix<T>& V )
 {
-   A.EnsureUnique();
    int m = A.Rows();
-   int n = A.Columns();
-   W = Vector( n );
-   V = Matrix( n, n );
-   if ( (*API->Numerical->SVDInPlaceD)( A.DataPtr(), W.DataPtr(), V.DataPtr(), m, n ) == api_false )
-      throw APIFunctionError( "SVDInPlaceD" );
+   int n = A.Cols();
+
+   W = GenericVector<T>( T( 0 ), n );
+   if ( m == 0 || n == 0 )
+   {
+      V = GenericMatrix<T>::UnitMatrix( n );
+      return;
+   }
+
+   GenericMatrix<T> G = A.Transpose();
+   GenericMatrix<T> Vt = GenericMatrix<T>::UnitMatrix( n );
+   T* g = G.Begin();
+   T* v = Vt.Begin();
+
+   // Squared column norms, updated after each rotation.
+   DVector D( n );
+   double* d = D.Begin();
+
+   const double tolerance = Sqrt( double( m ) )*std::numeric_limits<T>::epsilon();
+
+   auto rotate = [&]( int p, int q ) -> bool
+   {
+      T* gp = g + p*m;
+      T* gq = g + q*m;
+      double gamma = 0;
+      for ( int r = 0; r < m; ++r )
+         gamma += double( gp[r] )*gq[r];
+      double alpha = d[p];
+      double beta = d[q];
+      if ( Abs( gamma ) <= tolerance*Sqrt( alpha*beta ) )
+         return false;
+
+      double zeta = (beta - alpha)/(2*gamma);
+      double t = ((zeta < 0) ? -1 : +1)/(Abs( zeta ) + Sqrt( 1 + zeta*zeta ));
+      double c = 1/Sqrt( 1 + t*t );
+      double s = c*t;
+
+      for ( int r = 0; r < m; ++r )
+      {
+         double x = gp[r], y = gq[r];
+         gp[r] = T( c*x - s*y );
+         gq[r] = T( s*x + c*y );
+      }
+      T* vp = v + p*n;
+      T* vq = v + q*n;
+      for ( int r = 0; r < n; ++r )
+      {
+         double x = vp[r], y = vq[r];
+         vp[r] = T( c*x - s*y );
+         vq[r] = T( s*x + c*y );
+      }
+
+      d[p] = Max( 0.0, alpha - t*gamma );
+      d[q] = Max( 0.0, beta + t*gamma );
+      return true;
+   };
+
+   // Round-robin ordering, with a dummy column when n is odd.
+   int nn = n + (n & 1);
+   int numberOfPairs = nn >> 1;
+   IVector O( nn );
+   int* order = O.Begin();
+   for ( int i = 0; i < nn; ++i )
+      order[i] = i;
+   IVector R( numberOfPairs );
+   int* rotated = R.Begin();
+
+   int numberOfThreads = (n >= 64 && double( m )*n >= 65536.0) ? Thread::NumberOfThreads( numberOfPairs, 1 ) : 1;
+
+   for ( int sweep = 0; sweep < 64; ++sweep )
+   {
+      for ( int j = 0; j < n; ++j )
+      {
+         const T* gj = g + j*m;
+         double s = 0;
+         for ( int r = 0; r < m; ++r )
+            s += double( gj[r] )*gj[r];
+         d[j] = s;
+      }
+
+      int count = 0;
+      for ( int step = 0; step < nn-1; ++step )
+      {
+         ThreadPool::ParallelFor( 0, numberOfPairs,
+            [&]( size_type i0, size_type i1 )
+            {
+               for ( size_type i = i0; i < i1; ++i )
+               {
+                  int p = order[i];
+                  int q = order[nn-1-i];
+                  rotated[i] = (p < n && q < n) ? int( rotate( Min( p, q ), Max( p, q ) ) ) : 0;
+               }
+            }, 0, numberOfThreads );
+
+         for ( int i = 0; i < numberOfPairs; ++i )
+            count += rotated[i];
+
+         // Keep the first index fixed and rotate the rest.
+         int last = order[nn-1];
+         for ( int i = nn-1; i > 1; --i )
+            order[i] = order[i-1];
+         order[1] = last;
+      }
+
+      if ( count == 0 )
+         break;
+   }
+
+   A.EnsureUnique();
+   for ( int j = 0; j < n; ++j )
+   {
+      const T* gj = g + j*m;
+      double s = 0;
+      for ( int r = 0; r < m; ++r )
+         s += double( gj[r] )*gj[r];
+      s = Sqrt( s );
+      W[j] = T( s );
+      if ( s > 0 )
+         for ( int r = 0; r < m; ++r )
+            A[r][j] = T( gj[r]/s );
+      else
+         for ( int r = 0; r < m; ++r )
+            A[r][j] = T( 0 );
+   }
+
+   V = Vt.Transpose();
+}
+
+void PCL_FUNC InPlaceSVDImplementation( Matrix& A, Vector& W, Matrix& V )
+{
+   JacobiSVD( A, W, V );
 }
 
 void PCL_FUNC InPlaceSVDImplementation( FMatrix& A, FVector& W, FMatrix& V )
 {
-   A.EnsureUnique();
-   int m = A.Rows();
-   int n = A.Columns();
-   W = FVector( n );
-   V = FMatrix( n, n );
-   if ( (*API->Numerical->SVDInPlaceF)( A.DataPtr(), W.DataPtr(), V.DataPtr(), m, n ) == api_false )
-      throw APIFunctionError( "SVDInPlaceF" );
+   JacobiSVD( A, W, V );
 }
 
 // ----------------------------------------------------------------------------
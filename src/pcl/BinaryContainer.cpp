@@ -0,0 +1,480 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/BinaryContainer.cpp - Released 2019-01-21T12:06:21Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#include <pcl/Defs.h>
+
+#ifdef __PCL_WINDOWS
+#  include <windows.h>
+#else
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <errno.h>
+#endif
+
+#include <string.h>
+
+#include <new> // std::bad_alloc
+
+#include <pcl/BinaryContainer.h>
+#include <pcl/File.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+#define SIGNATURE          "PCLBDC10"
+#define HEADER_SIZE        64
+#define ENTRY_SIZE         64
+#define BLOCK_ALIGNMENT    64
+#define MAX_ID_LENGTH      23
+#define MAX_FORMAT_LENGTH  8
+
+static inline uint64 AlignUp( uint64 n )
+{
+   return (n + (BLOCK_ALIGNMENT-1)) & ~uint64( BLOCK_ALIGNMENT-1 );
+}
+
+static inline void PutUInt32( uint8* p, uint32 x )
+{
+   ::memcpy( p, &x, sizeof( uint32 ) );
+}
+
+static inline void PutUInt64( uint8* p, uint64 x )
+{
+   ::memcpy( p, &x, sizeof( uint64 ) );
+}
+
+static inline uint32 GetUInt32( const uint8* p )
+{
+   uint32 x;
+   ::memcpy( &x, p, sizeof( uint32 ) );
+   return x;
+}
+
+static inline uint64 GetUInt64( const uint8* p )
+{
+   uint64 x;
+   ::memcpy( &x, p, sizeof( uint64 ) );
+   return x;
+}
+
+static IsoString GetFixedString( const uint8* p, size_type maxLength )
+{
+   size_type n = 0;
+   while ( n < maxLength && p[n] != 0 )
+      ++n;
+   return IsoString( reinterpret_cast<const char*>( p ), 0, n );
+}
+
+static bool IsValidIdentifier( const IsoString& id, size_type maxLength )
+{
+   if ( id.IsEmpty() || id.Length() > maxLength )
+      return false;
+   for ( char c : id )
+      if ( c <= ' ' || c > '~' )
+         return false;
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+BinaryContainerWriter::BinaryContainerWriter( const IsoString& formatId ) :
+   m_formatId( formatId )
+{
+   if ( !IsValidIdentifier( m_formatId, MAX_FORMAT_LENGTH ) )
+      throw Error( "BinaryContainerWriter: Invalid format identifier '" + m_formatId + '\'' );
+}
+
+// ----------------------------------------------------------------------------
+
+void BinaryContainerWriter::AddBlock( const IsoString& id, BinaryBlockType::value_type type, const void* data, size_type size,
+                                      int dim0, int dim1, int dim2 )
+{
+   if ( !IsValidIdentifier( id, MAX_ID_LENGTH ) )
+      throw Error( "BinaryContainerWriter::AddBlock(): Invalid block identifier '" + id + '\'' );
+   for ( const Block& block : m_blocks )
+      if ( block.id == id )
+         throw Error( "BinaryContainerWriter::AddBlock(): Duplicate block identifier '" + id + '\'' );
+   size_type itemSize = BinaryBlockType::ItemSize( type );
+   if ( itemSize == 0 )
+      throw Error( "BinaryContainerWriter::AddBlock(): Invalid block type: " + IsoString( int( type ) ) );
+   if ( size % itemSize != 0 || size > 0 && data == nullptr )
+      throw Error( "BinaryContainerWriter::AddBlock(): Invalid block data: " + id );
+   if ( dim0 < 0 || dim1 < 0 || dim2 < 0 )
+      throw Error( "BinaryContainerWriter::AddBlock(): Invalid block dimensions: " + id );
+
+   Block block;
+   block.id = id;
+   block.type = type;
+   block.dim[0] = dim0;
+   block.dim[1] = dim1;
+   block.dim[2] = dim2;
+   block.data = data;
+   block.size = size;
+   m_blocks << block;
+}
+
+// ----------------------------------------------------------------------------
+
+void BinaryContainerWriter::AddText( const IsoString& id, const String& text )
+{
+   if ( !text.IsEmpty() )
+   {
+      IsoString utf8 = text.ToUTF8();
+      AddBlock( id, BinaryBlockType::UTF8Text, utf8.c_str(), utf8.Length(), int( utf8.Length() ) );
+      m_blocks[m_blocks.UpperBound()].text = utf8;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void BinaryContainerWriter::WriteFile( const String& filePath ) const
+{
+   /*
+    * Compute block offsets and build the file header and block directory.
+    */
+   uint64 directorySize = HEADER_SIZE + uint64( m_blocks.Length() )*ENTRY_SIZE;
+   ByteArray directory( size_type( directorySize ), uint8( 0 ) );
+   Array<uint64> offsets;
+   uint64 position = AlignUp( directorySize );
+   uint8* entry = directory.Begin() + HEADER_SIZE;
+   for ( const Block& block : m_blocks )
+   {
+      offsets << position;
+      ::memcpy( entry, block.id.c_str(), block.id.Length() );
+      PutUInt32( entry + 24, uint32( block.type ) );
+      PutUInt32( entry + 28, uint32( block.dim[0] ) );
+      PutUInt32( entry + 32, uint32( block.dim[1] ) );
+      PutUInt32( entry + 36, uint32( block.dim[2] ) );
+      PutUInt64( entry + 40, position );
+      PutUInt64( entry + 48, uint64( block.size ) );
+      position = AlignUp( position + block.size );
+      entry += ENTRY_SIZE;
+   }
+
+   uint8* header = directory.Begin();
+   ::memcpy( header, SIGNATURE, 8 );
+   ::memcpy( header + 8, m_formatId.c_str(), m_formatId.Length() );
+   PutUInt32( header + 16, uint32( m_blocks.Length() ) );
+   PutUInt64( header + 24, position );
+
+   /*
+    * Write the header, directory and data blocks with zero padding.
+    */
+   static const uint8 zeros[ BLOCK_ALIGNMENT ] = {};
+
+   File file = File::CreateFileForWriting( filePath );
+   file.Write( directory.Begin(), fsize_type( directorySize ) );
+   uint64 written = directorySize;
+   for ( size_type i = 0; i < m_blocks.Length(); ++i )
+   {
+      const Block& block = m_blocks[i];
+      if ( offsets[i] > written )
+         file.Write( zeros, fsize_type( offsets[i] - written ) );
+      if ( block.size > 0 )
+         file.Write( block.text.IsEmpty() ? block.data : block.text.c_str(), fsize_type( block.size ) );
+      written = offsets[i] + block.size;
+   }
+   if ( position > written )
+      file.Write( zeros, fsize_type( position - written ) );
+   file.Close();
+}
+
+// ----------------------------------------------------------------------------
+
+void BinaryContainerReader::Open( const String& filePath, const IsoString& formatId )
+{
+   Close();
+
+   try
+   {
+      m_filePath = filePath;
+      LoadFile();
+      ParseDirectory( formatId );
+   }
+   catch ( ... )
+   {
+      Close();
+      throw;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void BinaryContainerReader::Close()
+{
+   if ( m_data != nullptr )
+   {
+      if ( m_mapped )
+      {
+#ifdef __PCL_WINDOWS
+         ::UnmapViewOfFile( m_data );
+#else
+         ::munmap( const_cast<uint8*>( m_data ), m_size );
+#endif
+      }
+      else
+         PCL_ALIGNED_FREE( const_cast<uint8*>( m_data ) );
+   }
+
+   m_filePath.Clear();
+   m_data = nullptr;
+   m_size = 0;
+   m_mapped = false;
+   m_blocks.Clear();
+}
+
+// ----------------------------------------------------------------------------
+
+void BinaryContainerReader::LoadFile()
+{
+   /*
+    * Try to map the whole file into memory with read-only access. File and
+    * mapping handles can be closed immediately since the mapped view keeps a
+    * reference to the underlying file.
+    */
+#ifdef __PCL_WINDOWS
+
+   String winPath = File::UnixPathToWindows( m_filePath );
+   HANDLE hFile = ::CreateFileW( (LPCWSTR)winPath.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+   if ( hFile == INVALID_HANDLE_VALUE )
+      throw File::Error( m_filePath, String().Format( "Unable to open file: Win32 error (%u)", ::GetLastError() ) );
+   LARGE_INTEGER fileSize;
+   if ( !::GetFileSizeEx( hFile, &fileSize ) )
+   {
+      DWORD errCode = ::GetLastError();
+      ::CloseHandle( hFile );
+      throw File::Error( m_filePath, String().Format( "File access error: Win32 error (%u)", errCode ) );
+   }
+   m_size = size_type( fileSize.QuadPart );
+   if ( m_size < HEADER_SIZE )
+   {
+      ::CloseHandle( hFile );
+      throw Error( "Not a binary data container file: " + m_filePath );
+   }
+   HANDLE hMapping = ::CreateFileMappingW( hFile, 0, PAGE_READONLY, 0, 0, 0 );
+   if ( hMapping != 0 )
+   {
+      m_data = reinterpret_cast<const uint8*>( ::MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 ) );
+      ::CloseHandle( hMapping );
+   }
+   ::CloseHandle( hFile );
+
+#else // !__PCL_WINDOWS
+
+   IsoString utf8 = m_filePath.ToUTF8();
+   int fd = ::open( utf8.c_str(), O_RDONLY );
+   if ( fd < 0 )
+      throw File::Error( m_filePath, "Unable to open file: " + String( ::strerror( errno ) ) );
+   struct stat st;
+   if ( ::fstat( fd, &st ) != 0 )
+   {
+      int errCode = errno;
+      ::close( fd );
+      throw File::Error( m_filePath, "File access error: " + String( ::strerror( errCode ) ) );
+   }
+   m_size = size_type( st.st_size );
+   if ( m_size < HEADER_SIZE )
+   {
+      ::close( fd );
+      throw Error( "Not a binary data container file: " + m_filePath );
+   }
+   void* p = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+   if ( p != MAP_FAILED )
+      m_data = reinterpret_cast<const uint8*>( p );
+   ::close( fd );
+
+#endif // __PCL_WINDOWS
+
+   if ( m_data != nullptr )
+   {
+      m_mapped = true;
+      return;
+   }
+
+   /*
+    * Memory mapping not available: read the file into an aligned buffer.
+    */
+   uint8* buffer = reinterpret_cast<uint8*>( PCL_ALIGNED_MALLOC( m_size, BLOCK_ALIGNMENT ) );
+   if ( buffer == nullptr )
+      throw std::bad_alloc();
+   try
+   {
+      File file = File::OpenFileForReading( m_filePath );
+      file.Read( buffer, fsize_type( m_size ) );
+      file.Close();
+   }
+   catch ( ... )
+   {
+      PCL_ALIGNED_FREE( buffer );
+      throw;
+   }
+   m_data = buffer;
+}
+
+// ----------------------------------------------------------------------------
+
+void BinaryContainerReader::ParseDirectory( const IsoString& formatId )
+{
+   if ( ::memcmp( m_data, SIGNATURE, 8 ) != 0 )
+      throw Error( "Not a binary data container file: " + m_filePath );
+
+   IsoString fileFormatId = GetFixedString( m_data + 8, MAX_FORMAT_LENGTH );
+   if ( fileFormatId != formatId )
+      throw Error( "Unexpected binary data container format '" + fileFormatId + "' (expected '" + formatId + "'): " + m_filePath );
+
+   uint32 blockCount = GetUInt32( m_data + 16 );
+   uint64 fileSize = GetUInt64( m_data + 24 );
+   if ( fileSize != m_size )
+      throw Error( "Truncated or corrupted binary data container file: " + m_filePath );
+
+   uint64 directorySize = HEADER_SIZE + uint64( blockCount )*ENTRY_SIZE;
+   if ( directorySize > m_size )
+      throw Error( "Corrupted binary data container directory: " + m_filePath );
+
+   m_blocks.Clear();
+   m_blocks.Reserve( blockCount );
+   const uint8* entry = m_data + HEADER_SIZE;
+   for ( uint32 i = 0; i < blockCount; ++i, entry += ENTRY_SIZE )
+   {
+      Block block;
+      block.id = GetFixedString( entry, MAX_ID_LENGTH );
+      block.type = BinaryBlockType::value_type( GetUInt32( entry + 24 ) );
+      for ( int j = 0; j < 3; ++j )
+      {
+         uint32 d = GetUInt32( entry + 28 + 4*j );
+         if ( d > uint32( int32_max ) )
+            throw Error( "Invalid binary data container block dimensions: " + block.id + ": " + m_filePath );
+         block.dim[j] = int( d );
+      }
+
+      uint64 offset = GetUInt64( entry + 40 );
+      uint64 size = GetUInt64( entry + 48 );
+      size_type itemSize = BinaryBlockType::ItemSize( block.type );
+      if ( block.id.IsEmpty() ||
+           itemSize == 0 ||
+           size % itemSize != 0 ||
+           offset % BLOCK_ALIGNMENT != 0 ||
+           offset < directorySize ||
+           offset > m_size ||
+           size > m_size - offset )
+         throw Error( "Corrupted binary data container directory entry #" + String( i ) + ": " + m_filePath );
+
+      block.data = m_data + offset;
+      block.size = size_type( size );
+      m_blocks << block;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+const BinaryContainerReader::Block* BinaryContainerReader::FindBlock( const IsoString& id ) const
+{
+   for ( const Block& block : m_blocks )
+      if ( block.id == id )
+         return &block;
+   return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+const BinaryContainerReader::Block* BinaryContainerReader::TypedBlock( const IsoString& id, BinaryBlockType::value_type type ) const
+{
+   const Block* block = FindBlock( id );
+   if ( block != nullptr )
+      if ( block->type != type )
+         throw Error( "Unexpected binary data container block type: " + id + ": " + m_filePath );
+   return block;
+}
+
+// ----------------------------------------------------------------------------
+
+String BinaryContainerReader::TextBlock( const IsoString& id ) const
+{
+   const Block* block = TypedBlock( id, BinaryBlockType::UTF8Text );
+   if ( block == nullptr || block->size == 0 )
+      return String();
+   return String::UTF8ToUTF16( reinterpret_cast<const char*>( block->data ), 0, block->size );
+}
+
+// ----------------------------------------------------------------------------
+
+bool BinaryContainerReader::IsContainerFile( const String& filePath )
+{
+   try
+   {
+      if ( File::Exists( filePath ) )
+      {
+         File file = File::OpenFileForReading( filePath );
+         if ( file.Size() >= HEADER_SIZE )
+         {
+            char signature[ 8 ];
+            file.Read( signature, 8 );
+            return ::memcmp( signature, SIGNATURE, 8 ) == 0;
+         }
+      }
+   }
+   catch ( ... )
+   {
+   }
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
+// EOF pcl/BinaryContainer.cpp - Released 2019-01-21T12:06:21Z
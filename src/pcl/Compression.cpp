@@ -53,9 +53,11 @@
 #include <pcl/Compression.h>
 #include <pcl/ElapsedTime.h>
 #include <pcl/Exception.h>
+#include <pcl/Math.h>
 #include <pcl/ReferenceArray.h>
 #include <pcl/StringList.h>
 #include <pcl/Thread.h>
+#include <pcl/ThreadPool.h>
 
 #include <lz4/lz4.h>
 #include <lz4/lz4hc.h>
@@ -66,6 +68,367 @@ namespace pcl
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Byte shuffling kernels.
+ *
+ * A shuffled block of size bytes with m-byte items consists of m contiguous
+ * byte planes of n = size/m bytes each, where plane j contains the j-th byte
+ * of every item, followed by the size % m trailing bytes of the block, which
+ * are not shuffled.
+ *
+ * ShuffleRange() works on arbitrary ranges [p0,p1) of the shuffled stream.
+ * This allows compression threads to shuffle their own subblocks in
+ * parallel, without any intermediate shuffled copy of the whole data block.
+ * Decompressed blocks are unshuffled in place; see UnshuffleInPlace().
+ */
+
+/*
+ * Plane gather: dst[k] = items[k*m + j], k = 0,...,count-1.
+ */
+static void GatherPlane( uint8* dst, const uint8* items, size_type m, size_type j, size_type count )
+{
+   size_type k = 0;
+#ifdef __PCL_HAVE_SSE2
+   /*
+    * Vectorized gathers: 16 items per iteration. Each item is loaded in an
+    * integer lane, shifted right to bring byte j to the least significant
+    * position, masked, and packed with saturating packs (lossless since all
+    * values are in [0,255]).
+    */
+   switch ( m )
+   {
+   case 2:
+      {
+         const __m128i mask = _mm_set1_epi16( 0x00ff );
+         const __m128i shift = _mm_cvtsi32_si128( int( j << 3 ) );
+         for ( ; k + 16 <= count; k += 16 )
+         {
+            const __m128i* s = reinterpret_cast<const __m128i*>( items + k*2 );
+            __m128i a = _mm_and_si128( _mm_srl_epi16( _mm_loadu_si128( s ), shift ), mask );
+            __m128i b = _mm_and_si128( _mm_srl_epi16( _mm_loadu_si128( s+1 ), shift ), mask );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + k ), _mm_packus_epi16( a, b ) );
+         }
+      }
+      break;
+   case 4:
+      {
+         const __m128i mask = _mm_set1_epi32( 0x000000ff );
+         const __m128i shift = _mm_cvtsi32_si128( int( j << 3 ) );
+         for ( ; k + 16 <= count; k += 16 )
+         {
+            const __m128i* s = reinterpret_cast<const __m128i*>( items + k*4 );
+            __m128i a = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( s ), shift ), mask );
+            __m128i b = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( s+1 ), shift ), mask );
+            __m128i c = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( s+2 ), shift ), mask );
+            __m128i d = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( s+3 ), shift ), mask );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + k ),
+                              _mm_packus_epi16( _mm_packs_epi32( a, b ), _mm_packs_epi32( c, d ) ) );
+         }
+      }
+      break;
+   case 8:
+      {
+         const __m128i mask = _mm_set_epi32( 0, 0x000000ff, 0, 0x000000ff );
+         const __m128i shift = _mm_cvtsi32_si128( int( j << 3 ) );
+         for ( ; k + 16 <= count; k += 16 )
+         {
+            const __m128i* s = reinterpret_cast<const __m128i*>( items + k*8 );
+            __m128i v[ 8 ];
+            for ( int i = 0; i < 8; ++i )
+               // Move the low dwords of both 64-bit lanes to dwords 0 and 1.
+               v[i] = _mm_shuffle_epi32( _mm_and_si128( _mm_srl_epi64( _mm_loadu_si128( s+i ), shift ), mask ),
+                                         _MM_SHUFFLE( 3, 1, 2, 0 ) );
+            __m128i a = _mm_unpacklo_epi64( v[0], v[1] );
+            __m128i b = _mm_unpacklo_epi64( v[2], v[3] );
+            __m128i c = _mm_unpacklo_epi64( v[4], v[5] );
+            __m128i d = _mm_unpacklo_epi64( v[6], v[7] );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + k ),
+                              _mm_packus_epi16( _mm_packs_epi32( a, b ), _mm_packs_epi32( c, d ) ) );
+         }
+      }
+      break;
+   default:
+      break;
+   }
+#endif
+   for ( const uint8* s = items + k*m + j; k < count; ++k, s += m )
+      dst[k] = *s;
+}
+
+/*
+ * Full interleave of m planes: items[k*m + j] = planes[j*n + k], for
+ * k = 0,...,count-1 and j = 0,...,m-1.
+ */
+static void InterleavePlanes( uint8* items, const uint8* planes, size_type n, size_type m, size_type count )
+{
+   size_type k = 0;
+#ifdef __PCL_HAVE_SSE2
+   /*
+    * Vectorized transposition of 16 items per iteration by recursive
+    * unpacking of 8-bit, 16-bit and 32-bit lanes.
+    */
+   switch ( m )
+   {
+   case 2:
+      for ( ; k + 16 <= count; k += 16 )
+      {
+         __m128i p0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( planes + k ) );
+         __m128i p1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( planes + n + k ) );
+         __m128i* d = reinterpret_cast<__m128i*>( items + k*2 );
+         _mm_storeu_si128( d,   _mm_unpacklo_epi8( p0, p1 ) );
+         _mm_storeu_si128( d+1, _mm_unpackhi_epi8( p0, p1 ) );
+      }
+      break;
+   case 4:
+      for ( ; k + 16 <= count; k += 16 )
+      {
+         __m128i p0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( planes + k ) );
+         __m128i p1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( planes + n + k ) );
+         __m128i p2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( planes + 2*n + k ) );
+         __m128i p3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( planes + 3*n + k ) );
+         __m128i a0 = _mm_unpacklo_epi8( p0, p1 ), a1 = _mm_unpackhi_epi8( p0, p1 );
+         __m128i b0 = _mm_unpacklo_epi8( p2, p3 ), b1 = _mm_unpackhi_epi8( p2, p3 );
+         __m128i* d = reinterpret_cast<__m128i*>( items + k*4 );
+         _mm_storeu_si128( d,   _mm_unpacklo_epi16( a0, b0 ) );
+         _mm_storeu_si128( d+1, _mm_unpackhi_epi16( a0, b0 ) );
+         _mm_storeu_si128( d+2, _mm_unpacklo_epi16( a1, b1 ) );
+         _mm_storeu_si128( d+3, _mm_unpackhi_epi16( a1, b1 ) );
+      }
+      break;
+   case 8:
+      for ( ; k + 16 <= count; k += 16 )
+      {
+         __m128i p[ 8 ];
+         for ( int i = 0; i < 8; ++i )
+            p[i] = _mm_loadu_si128( reinterpret_cast<const __m128i*>( planes + i*n + k ) );
+         __m128i a0 = _mm_unpacklo_epi8( p[0], p[1] ), a1 = _mm_unpackhi_epi8( p[0], p[1] );
+         __m128i b0 = _mm_unpacklo_epi8( p[2], p[3] ), b1 = _mm_unpackhi_epi8( p[2], p[3] );
+         __m128i c0 = _mm_unpacklo_epi8( p[4], p[5] ), c1 = _mm_unpackhi_epi8( p[4], p[5] );
+         __m128i d0 = _mm_unpacklo_epi8( p[6], p[7] ), d1 = _mm_unpackhi_epi8( p[6], p[7] );
+         // 4-byte groups: bytes 0-3 and 4-7 of items 0-3, 4-7, 8-11, 12-15.
+         __m128i e0 = _mm_unpacklo_epi16( a0, b0 ), e1 = _mm_unpackhi_epi16( a0, b0 );
+         __m128i e2 = _mm_unpacklo_epi16( a1, b1 ), e3 = _mm_unpackhi_epi16( a1, b1 );
+         __m128i f0 = _mm_unpacklo_epi16( c0, d0 ), f1 = _mm_unpackhi_epi16( c0, d0 );
+         __m128i f2 = _mm_unpacklo_epi16( c1, d1 ), f3 = _mm_unpackhi_epi16( c1, d1 );
+         __m128i* d = reinterpret_cast<__m128i*>( items + k*8 );
+         _mm_storeu_si128( d,   _mm_unpacklo_epi32( e0, f0 ) );
+         _mm_storeu_si128( d+1, _mm_unpackhi_epi32( e0, f0 ) );
+         _mm_storeu_si128( d+2, _mm_unpacklo_epi32( e1, f1 ) );
+         _mm_storeu_si128( d+3, _mm_unpackhi_epi32( e1, f1 ) );
+         _mm_storeu_si128( d+4, _mm_unpacklo_epi32( e2, f2 ) );
+         _mm_storeu_si128( d+5, _mm_unpackhi_epi32( e2, f2 ) );
+         _mm_storeu_si128( d+6, _mm_unpacklo_epi32( e3, f3 ) );
+         _mm_storeu_si128( d+7, _mm_unpackhi_epi32( e3, f3 ) );
+      }
+      break;
+   default:
+      break;
+   }
+#endif
+   for ( ; k < count; ++k )
+      for ( size_type j = 0; j < m; ++j )
+         items[k*m + j] = planes[j*n + k];
+}
+
+/*
+ * Shuffles the range [p0,p1) of the shuffled stream of a block of size bytes
+ * starting at data with m-byte items. The p1-p0 shuffled bytes are stored
+ * contiguously at dst.
+ */
+static void ShuffleRange( uint8* dst, const uint8* data, size_type size, size_type m, size_type p0, size_type p1 )
+{
+   size_type n = size/m;
+   size_type nm = n*m;
+   for ( size_type p = p0; p < p1; )
+   {
+      if ( p >= nm )
+      {
+         ::memcpy( dst, data + p, p1 - p );
+         break;
+      }
+      size_type j = p/n;
+      size_type k = p - j*n;
+      size_type count = Min( p1, (j + 1)*n ) - p;
+      GatherPlane( dst, data + k*m, m, j, count );
+      dst += count;
+      p += count;
+   }
+}
+
+/*
+ * In-place unshuffling.
+ *
+ * A shuffled block is an m x n byte matrix (m planes of n bytes) that has to
+ * be transposed in place into an n x m matrix. The n items are divided into c
+ * segments of B items, plus t = n - c*B trailing items:
+ *
+ * 1. The t trailing bytes of each plane are saved to a small buffer, and the
+ *    remaining m*c*B bytes are compacted at the beginning of the block.
+ *
+ * 2. The m x c matrix of B-byte segments is transposed in place by following
+ *    the cycles of the transposition permutation. After this step, the m
+ *    segments of each group of B items are contiguous.
+ *
+ * 3. Each group of m*B contiguous bytes is transposed through a small
+ *    cache-resident buffer. Groups are independent and occupy contiguous
+ *    ranges of the block, so this step can be performed by several threads
+ *    without sharing cache lines.
+ *
+ * 4. The saved trailing bytes are interleaved at the end of the block.
+ *
+ * Besides a fixed-size stack buffer, the only auxiliary storage required is
+ * a bit map with one bit per segment, that is, m*c/8 bytes.
+ */
+const size_type UnshuffleScratchSize = 16384;
+
+class UnshuffleScratch
+{
+public:
+
+   UnshuffleScratch( size_type size ) :
+      m_data( (size <= sizeof( m_local )) ? m_local : (m_buffer = ByteArray( size )).Begin() )
+   {
+   }
+
+   uint8* operator *()
+   {
+      return m_data;
+   }
+
+private:
+
+   uint8     m_local[ UnshuffleScratchSize ];
+   ByteArray m_buffer;
+   uint8*    m_data;
+};
+
+static void TransposeSegments( uint8* data, size_type m, size_type c, size_type B, uint8* temp )
+{
+   /*
+    * For an m x c matrix stored in row order with N = m*c elements, the
+    * element at index i < N-1 goes to index (i*m) mod (N-1). Hence the
+    * element stored at index p after transposition comes from index
+    * (p*c) mod (N-1). The first and last elements never move.
+    */
+   size_type N1 = m*c - 1;
+   ByteArray visited( (N1 >> 3) + 1, uint8( 0 ) );
+   for ( size_type s = 1; s < N1; ++s )
+      if ( (visited[s >> 3] & (1 << (s & 7))) == 0 )
+      {
+         ::memcpy( temp, data + s*B, B );
+         for ( size_type p = s;; )
+         {
+            visited[p >> 3] |= uint8( 1 << (p & 7) );
+            size_type q = size_type( (uint64( p )*c) % N1 );
+            if ( q == s )
+            {
+               ::memcpy( data + p*B, temp, B );
+               break;
+            }
+            ::memcpy( data + p*B, data + q*B, B );
+            p = q;
+         }
+      }
+}
+
+static void UnshuffleInPlace( uint8* data, size_type size, size_type m, int numberOfThreads )
+{
+   size_type n = size/m;
+   if ( m < 2 || n < 2 )
+      return;
+
+   size_type B = Max( size_type( 1 ), UnshuffleScratchSize/m );
+   size_type c = n/B;
+   size_type M = c*B;
+   size_type t = n - M;
+
+   // 1. Save the trailing items and compact the leading segments.
+   UnshuffleScratch tail( m*t );
+   if ( t > 0 )
+   {
+      for ( size_type j = 0; j < m; ++j )
+         ::memcpy( *tail + j*t, data + j*n + M, t );
+      for ( size_type j = 1; j < m; ++j )
+         ::memmove( data + j*M, data + j*n, M );
+   }
+
+   if ( c > 0 )
+   {
+      // 2. Make the m segments of each group contiguous.
+      if ( c > 1 )
+      {
+         UnshuffleScratch temp( B );
+         TransposeSegments( data, m, c, B, *temp );
+      }
+
+      // 3. Transpose each group of m segments.
+      const size_type groupSize = m*B;
+      ThreadPool::ParallelFor( 0, c,
+         [=]( size_type g0, size_type g1 )
+         {
+            UnshuffleScratch group( groupSize );
+            for ( size_type g = g0; g < g1; ++g )
+            {
+               uint8* items = data + g*groupSize;
+               ::memcpy( *group, items, groupSize );
+               InterleavePlanes( items, *group, B, m, B );
+            }
+         }, 0, numberOfThreads );
+   }
+
+   // 4. Interleave the trailing items.
+   if ( t > 0 )
+      InterleavePlanes( data + M*m, *tail, t, m, t );
+}
+
+// ----------------------------------------------------------------------------
+
+ByteArray Compression::Shuffle( const uint8* data, size_type size, size_type itemSize )
+{
+   ByteArray shuffled( size );
+   if ( size > 0 && data != nullptr )
+   {
+      /*
+       * Process blocks of items small enough to remain in cache while all
+       * byte planes are gathered.
+       */
+      const size_type blockItems = 8192;
+      size_type n = size/itemSize;
+      for ( size_type k = 0; k < n; k += blockItems )
+      {
+         size_type count = Min( blockItems, n - k );
+         for ( size_type j = 0; j < itemSize; ++j )
+            GatherPlane( shuffled.At( j*n + k ), data + k*itemSize, itemSize, j, count );
+      }
+      ::memcpy( shuffled.At( n*itemSize ), data + n*itemSize, size % itemSize );
+   }
+   return shuffled;
+}
+
+// ----------------------------------------------------------------------------
+
+ByteArray Compression::Unshuffle( const uint8* data, size_type size, size_type itemSize )
+{
+   ByteArray unshuffled( size );
+   if ( size > 0 && data != nullptr )
+   {
+      size_type n = size/itemSize;
+      InterleavePlanes( unshuffled.Begin(), data, n, itemSize, n );
+      ::memcpy( unshuffled.At( n*itemSize ), data + n*itemSize, size % itemSize );
+   }
+   return unshuffled;
+}
+
+// ----------------------------------------------------------------------------
+
+void Compression::InPlaceUnshuffle( uint8* data, size_type size, size_type itemSize )
+{
+   if ( size > 0 && data != nullptr && itemSize > 1 )
+      UnshuffleInPlace( data, size, itemSize, 1 );
+}
+
+// ----------------------------------------------------------------------------
+
 class PCL_CompressionEngine
 {
 public:
@@ -95,19 +458,16 @@ public:
       m_numberOfSubblocks = size / m_subblockSize;
       m_remainingSize = size % m_subblockSize;
 
+      /*
+       * Byte shuffling is performed by each compression thread on its own
+       * subblocks, so no shuffled copy of the whole data block is required.
+       */
+      m_size = size;
+      m_itemSize = (m_compression.ByteShufflingEnabled() && m_compression.ItemSize() > 1) ? m_compression.ItemSize() : 0;
+
       ElapsedTime T;
       double dt = 0;
 
-      ByteArray S;
-      if ( m_compression.ByteShufflingEnabled() )
-         if ( m_compression.ItemSize() > 1 )
-         {
-            T.Reset();
-            S = Compression::Shuffle( m_data, size, m_compression.ItemSize() );
-            dt += T();
-            m_data = S.Begin();
-         }
-
       int numberOfThreads = m_compression.IsParallelProcessingEnabled() ?
                Min( m_compression.MaxProcessors(), pcl::Thread::NumberOfThreads( m_numberOfSubblocks + 1, 1 ) ) : 1;
       int subblocksPerThread = int( m_numberOfSubblocks + 1 )/numberOfThreads;
@@ -170,6 +530,8 @@ private:
            size_type                 m_numberOfSubblocks;
            size_type                 m_subblockSize;
            size_type                 m_remainingSize;
+           size_type                 m_size;
+           size_type                 m_itemSize; // zero if byte shuffling is disabled
            ByteArray::const_iterator m_data;
    mutable Mutex                     m_mutex;
    mutable StringList                m_errors;
@@ -198,6 +560,14 @@ private:
                if ( subblock.uncompressedSize > 0 )
                {
                   ByteArray::const_iterator uncompressedBegin = E.m_data + i*E.m_subblockSize;
+                  if ( E.m_itemSize > 0 )
+                  {
+                     size_type p0 = i*E.m_subblockSize;
+                     if ( m_shuffled.Length() < subblock.uncompressedSize )
+                        m_shuffled = ByteArray( subblock.uncompressedSize );
+                     ShuffleRange( m_shuffled.Begin(), E.m_data, E.m_size, E.m_itemSize, p0, p0 + subblock.uncompressedSize );
+                     uncompressedBegin = m_shuffled.Begin();
+                  }
                   if ( subblock.uncompressedSize >= E.m_compression.MinBlockSize() )
                   {
                      ByteArray compressedData( E.m_compression.MaxCompressedBlockSize( subblock.uncompressedSize ) );
@@ -251,6 +621,7 @@ private:
       const PCL_CompressionEngine& E;
             size_type              m_beginSubblock;
             size_type              m_endSubblock;
+            ByteArray              m_shuffled;
    };
 };
 
@@ -289,6 +660,13 @@ public:
 
       m_uncompressedData = reinterpret_cast<ByteArray::iterator>( data );
 
+      /*
+       * Subblocks are decompressed directly to their locations in the
+       * shuffled stream. Then the whole block is unshuffled in place by
+       * threads working on contiguous ranges of items.
+       */
+      m_itemSize = (m_compression.ByteShufflingEnabled() && m_compression.ItemSize() > 1) ? m_compression.ItemSize() : 0;
+
       int numberOfThreads = m_compression.IsParallelProcessingEnabled() ?
                Min( m_compression.MaxProcessors(), pcl::Thread::NumberOfThreads( subblocks.Length(), 1 ) ) : 1;
       int subblocksPerThread = int( subblocks.Length() )/numberOfThreads;
@@ -321,20 +699,15 @@ public:
       else
          threads[0].Run();
 
-      double dt = T();
-
       threads.Destroy();
 
       if ( !m_errors.IsEmpty() )
          m_compression.Throw( String().ToSeparated( m_errors, '\n' ) );
 
-      if ( m_compression.ByteShufflingEnabled() )
-         if ( m_compression.ItemSize() > 1 )
-         {
-            T.Reset();
-            Compression::InPlaceUnshuffle( m_uncompressedData, uncompressedSize, m_compression.ItemSize() );
-            dt += T();
-         }
+      if ( m_itemSize > 0 )
+         UnshuffleInPlace( m_uncompressedData, uncompressedSize, m_itemSize, numberOfThreads );
+
+      double dt = T();
 
       if ( perf != nullptr )
       {
@@ -355,6 +728,7 @@ private:
 
      const Compression&        m_compression;
            ByteArray::iterator m_uncompressedData;
+           size_type           m_itemSize; // zero if byte shuffling is disabled
    mutable Mutex               m_mutex;
    mutable StringList          m_errors;
 
@@ -392,23 +766,23 @@ private:
                                             m_offset+totalSize, i->checksum, checksum );
                }
 
+               size_type p0 = m_offset + totalSize;
                if ( i->compressedData.Length() < i->uncompressedSize )
                {
                   // Compressed subblock.
-                  size_type subblockSize = E.m_compression.UncompressBlock( E.m_uncompressedData+m_offset+totalSize,
-                                                                            uncompressedSize-totalSize,
+                  size_type subblockSize = E.m_compression.UncompressBlock( E.m_uncompressedData + p0, uncompressedSize - totalSize,
                                                                             i->compressedData.Begin(), i->compressedData.Length() );
                   if ( subblockSize == 0 )
                      throw String().Format( "Failed to uncompress subblock data (offset=%llu usize=%llu csize=%llu)",
-                                            m_offset+totalSize, i->uncompressedSize, i->compressedData.Length() );
+                                            p0, i->uncompressedSize, i->compressedData.Length() );
                   if ( subblockSize != i->uncompressedSize )
                      throw String().Format( "Uncompressed subblock size mismatch (offset=%llu, expected %llu, got %llu)",
-                                            m_offset+totalSize, i->uncompressedSize, subblockSize );
+                                            p0, i->uncompressedSize, subblockSize );
                }
                else
                {
                   // Subblock too small to be compressed, or data not compressible.
-                  ::memcpy( E.m_uncompressedData+m_offset+totalSize, i->compressedData.Begin(), i->uncompressedSize );
+                  ::memcpy( E.m_uncompressedData + p0, i->compressedData.Begin(), i->uncompressedSize );
                }
 
                totalSize += i->uncompressedSize;
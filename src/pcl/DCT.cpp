@@ -0,0 +1,581 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/DCT.cpp - Released 2019-01-21T12:06:21Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#include <pcl/DCT.h>
+#include <pcl/FFT1D.h>
+#include <pcl/Thread.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Real-to-real transforms are computed with a single complex or real FFT of
+ * (approximately) the same length, plus O(n) pre- and post-processing:
+ *
+ * DCT-II/III  - Makhoul's algorithm: a real FFT of length n applied to an
+ *               even/odd reordering of the data (complex FFT if n is odd).
+ * DCT-IV      - a complex FFT of length n/2 applied to interleaved data with
+ *               pre- and post-twiddles (complex FFT of length 2n if n is odd).
+ * DCT-I/DST-I - a real FFT of the even/odd symmetric extension of the data,
+ *               of length 2(n-1) and 2(n+1), respectively.
+ * DST-II/III/IV are reduced to the corresponding DCTs by reversing the order
+ * and/or alternating the signs of input or output data.
+ */
+
+class PCL_DCTPlanBase
+{
+public:
+
+   virtual ~PCL_DCTPlanBase()
+   {
+   }
+};
+
+template <typename T>
+class PCL_DCTPlan : public PCL_DCTPlanBase, public FFT1DBase
+{
+public:
+
+   typedef T                      scalar;
+   typedef Complex<T>             complex;
+   typedef GenericVector<scalar>  vector;
+   typedef GenericVector<complex> complex_vector;
+
+   PCL_DCTPlan( int n, int kind ) :
+      m_length( n ), m_kind( kind )
+   {
+      if ( n < ((kind == 0) ? 2 : 1) )
+         throw Error( String().Format( "Invalid DCT/DST length: %d", n ) );
+
+      switch ( m_kind & 3 )
+      {
+      case 0: // DCT-I, DST-I
+         m_fftLength = (m_kind == 0) ? 2*(n - 1) : 2*(n + 1);
+         m_real = true;
+         m_rwork = vector( m_fftLength );
+         m_cwork = complex_vector( m_fftLength/2 + 1 );
+         m_forward = Create( m_fftLength, static_cast<scalar*>( nullptr ) );
+         break;
+
+      case 1: // DCT-II, DST-II
+      case 2: // DCT-III, DST-III
+         m_fftLength = n;
+         m_real = (n & 1) == 0;
+         m_rwork = vector( n );
+         m_cwork = complex_vector( n );
+         if ( !m_real )
+            m_cwork2 = complex_vector( n );
+         m_post = complex_vector( n );
+         for ( int k = 0; k < n; ++k )
+            m_post[k] = Polar( T( 1 ), T( -Pi()*k/(2.0*n) ) );
+         if ( (m_kind & 3) == 1 )
+            m_forward = m_real ? Create( n, static_cast<scalar*>( nullptr ) ) : Create( n, static_cast<complex*>( nullptr ) );
+         else
+            m_inverse = m_real ? CreateInv( n, static_cast<scalar*>( nullptr ) ) : CreateInv( n, static_cast<complex*>( nullptr ) );
+         break;
+
+      case 3: // DCT-IV, DST-IV
+         m_real = false;
+         if ( (n & 1) == 0 )
+         {
+            m_fftLength = n >> 1;
+            m_pre = complex_vector( m_fftLength );
+            m_post = complex_vector( m_fftLength );
+            for ( int k = 0; k < m_fftLength; ++k )
+            {
+               m_pre[k] = Polar( T( 1 ), T( -Pi()*k/n ) );
+               m_post[k] = Polar( T( 1 ), T( -Pi()*(k + 0.25)/n ) );
+            }
+         }
+         else
+         {
+            m_fftLength = n << 1;
+            m_pre = complex_vector( n );
+            m_post = complex_vector( n );
+            for ( int k = 0; k < n; ++k )
+            {
+               m_pre[k] = Polar( T( 1 ), T( -Pi()*k/(2.0*n) ) );
+               m_post[k] = Polar( T( 1 ), T( -Pi()*(k + 0.5)/(2.0*n) ) );
+            }
+         }
+         m_cwork = complex_vector( m_fftLength );
+         m_cwork2 = complex_vector( m_fftLength );
+         m_forward = Create( m_fftLength, static_cast<complex*>( nullptr ) );
+         break;
+      }
+
+      if ( m_kind > 4 )
+         m_xwork = vector( n );
+   }
+
+   virtual ~PCL_DCTPlan()
+   {
+      if ( m_forward != nullptr )
+         Destroy( m_forward );
+      if ( m_inverse != nullptr )
+         Destroy( m_inverse );
+   }
+
+   /*
+    * In-place transforms (y == x) are supported: the input data are always
+    * fully consumed before writing any output data.
+    */
+   void operator()( scalar* y, const scalar* x )
+   {
+      const int n = m_length;
+      switch ( m_kind )
+      {
+      case 0: DCT1( y, x ); break;
+      case 1: DCT2( y, x, false ); break;
+      case 2: DCT3( y, x ); break;
+      case 3: DCT4( y, x ); break;
+      case 4: DST1( y, x ); break;
+      case 5: DCT2( y, x, true ); break;
+      case 6:
+      case 7:
+         for ( int j = 0; j < n; ++j )
+            m_xwork[j] = x[n-1-j];
+         if ( m_kind == 6 )
+            DCT3( y, *m_xwork );
+         else
+            DCT4( y, *m_xwork );
+         for ( int k = 1; k < n; k += 2 )
+            y[k] = -y[k];
+         break;
+      }
+   }
+
+   static int OptimizedLength( int n, int kind )
+   {
+      switch ( kind & 3 )
+      {
+      case 0:
+         if ( kind == 0 )
+            return FFT1DBase::OptimizedLength( 2*(Max( 2, n ) - 1), static_cast<float*>( nullptr ) )/2 + 1;
+         return FFT1DBase::OptimizedLength( 2*(Max( 1, n ) + 1), static_cast<float*>( nullptr ) )/2 - 1;
+      case 3:
+         return 2*FFT1DBase::OptimizedLength( (Max( 1, n ) + 1) >> 1, static_cast<fcomplex*>( nullptr ) );
+      default:
+         return FFT1DBase::OptimizedLength( Max( 1, n ), static_cast<float*>( nullptr ) );
+      }
+   }
+
+private:
+
+   int            m_length;
+   int            m_kind;
+   int            m_fftLength = 0;
+   bool           m_real = false;
+   void*          m_forward = nullptr;
+   void*          m_inverse = nullptr;
+   complex_vector m_pre;
+   complex_vector m_post;
+   vector         m_rwork;
+   vector         m_xwork;
+   complex_vector m_cwork;
+   complex_vector m_cwork2;
+
+   /*
+    * Forward DFT of the real sequence in m_rwork. The first m_fftLength/2 + 1
+    * elements of the transform are stored in m_cwork.
+    */
+   void RealDFT()
+   {
+      if ( m_real )
+         Transform( m_forward, *m_cwork, *m_rwork );
+      else
+      {
+         for ( int i = 0; i < m_fftLength; ++i )
+            m_cwork2[i] = complex( m_rwork[i], 0 );
+         Transform( m_forward, *m_cwork, *m_cwork2 );
+      }
+   }
+
+   /*
+    * Unnormalized inverse DFT of the Hermitian sequence whose first
+    * m_fftLength/2 + 1 elements are stored in m_cwork. The real result is
+    * stored in m_rwork.
+    */
+   void RealIDFT()
+   {
+      if ( m_real )
+         Transform( m_inverse, *m_rwork, *m_cwork );
+      else
+      {
+         int L = m_fftLength;
+         for ( int k = 0; k <= L/2; ++k )
+            m_cwork2[k] = m_cwork[k];
+         for ( int k = L/2 + 1; k < L; ++k )
+            m_cwork2[k] = ~m_cwork[L-k];
+         Transform( m_inverse, *m_cwork, *m_cwork2 );
+         for ( int i = 0; i < L; ++i )
+            m_rwork[i] = m_cwork[i].Real();
+      }
+   }
+
+   void DCT1( scalar* y, const scalar* x )
+   {
+      const int n = m_length;
+      scalar* v = *m_rwork;
+      for ( int j = 0; j < n; ++j )
+         v[j] = x[j];
+      for ( int j = 1; j < n-1; ++j )
+         v[m_fftLength-j] = x[j];
+      RealDFT();
+      for ( int k = 0; k < n; ++k )
+         y[k] = m_cwork[k].Real();
+   }
+
+   void DST1( scalar* y, const scalar* x )
+   {
+      const int n = m_length;
+      scalar* v = *m_rwork;
+      v[0] = v[n+1] = 0;
+      for ( int j = 0; j < n; ++j )
+      {
+         v[j+1] = x[j];
+         v[m_fftLength-1-j] = -x[j];
+      }
+      RealDFT();
+      for ( int k = 0; k < n; ++k )
+         y[k] = -m_cwork[k+1].Imag();
+   }
+
+   /*
+    * DST-II(x)[k] = DCT-II(x[j]*(-1)^j)[n-1-k]
+    */
+   void DCT2( scalar* y, const scalar* x, bool sine )
+   {
+      const int n = m_length;
+      scalar* v = *m_rwork;
+      if ( sine )
+         for ( int j = 0; j < n; ++j )
+            if ( j & 1 )
+               v[n-1-(j >> 1)] = -x[j];
+            else
+               v[j >> 1] = x[j];
+      else
+         for ( int j = 0; j < n; ++j )
+            if ( j & 1 )
+               v[n-1-(j >> 1)] = x[j];
+            else
+               v[j >> 1] = x[j];
+
+      RealDFT();
+
+      const complex* c = *m_cwork;
+      const complex* w = *m_post;
+      for ( int k = 0; k < n; ++k )
+      {
+         complex V = (k <= n/2) ? c[k] : ~c[n-k];
+         scalar Y = 2*(w[k].Real()*V.Real() - w[k].Imag()*V.Imag());
+         if ( sine )
+            y[n-1-k] = Y;
+         else
+            y[k] = Y;
+      }
+   }
+
+   void DCT3( scalar* y, const scalar* x )
+   {
+      const int n = m_length;
+      const complex* w = *m_post;
+      complex* c = *m_cwork;
+      c[0] = complex( x[0], 0 );
+      for ( int k = 1; k <= n/2; ++k )
+         c[k] = ~w[k] * complex( x[k], -x[n-k] );
+
+      RealIDFT();
+
+      const scalar* v = *m_rwork;
+      for ( int j = 0; j < n; ++j )
+         y[j] = (j & 1) ? v[n-1-(j >> 1)] : v[j >> 1];
+   }
+
+   void DCT4( scalar* y, const scalar* x )
+   {
+      const int n = m_length;
+      const complex* p = *m_pre;
+      const complex* q = *m_post;
+      complex* a = *m_cwork2;
+      complex* A = *m_cwork;
+
+      if ( (n & 1) == 0 )
+      {
+         const int m = n >> 1;
+         for ( int j = 0; j < m; ++j )
+            a[j] = complex( x[2*j], x[n-1-2*j] ) * p[j];
+         Transform( m_forward, A, a );
+         for ( int k = 0; k < m; ++k )
+         {
+            complex t = A[k] * q[k];
+            y[2*k] = 2*t.Real();
+            y[n-1-2*k] = -2*t.Imag();
+         }
+      }
+      else
+      {
+         for ( int j = 0; j < n; ++j )
+            a[j] = x[j] * p[j];
+         for ( int j = n; j < m_fftLength; ++j )
+            a[j] = 0;
+         Transform( m_forward, A, a );
+         for ( int k = 0; k < n; ++k )
+            y[k] = 2*(q[k].Real()*A[k].Real() - q[k].Imag()*A[k].Imag());
+      }
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*
+ * 2-D real-to-real transforms
+ */
+template <typename T>
+class PCL_DCT2DEngine
+{
+public:
+
+   typedef T                      scalar;
+   typedef PCL_DCTPlan<T>         plan;
+   typedef ReferenceArray<Thread> thread_list;
+
+   PCL_DCT2DEngine( int rows, int cols, scalar* output, const scalar* input, int kind, StatusMonitor* monitor, bool parallel, int maxProcessors ) :
+      m_rows( rows ), m_cols( cols ), m_output( output ), m_input( input ), m_kind( kind )
+   {
+      if ( monitor != nullptr )
+         if ( monitor->IsInitializationEnabled() )
+            monitor->Initialize( (kind < 4) ? "DCT" : "DST", rows + cols );
+
+      for ( int direction = 0; direction < 2; ++direction ) // transform rows, then columns
+      {
+         int numberOfItems = (direction == 0) ? m_rows : m_cols;
+         int numberOfThreads = parallel ? Min( maxProcessors, Thread::NumberOfThreads( numberOfItems, 1 ) ) : 1;
+         int itemsPerThread = numberOfItems/numberOfThreads;
+
+         thread_list threads;
+         for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+         {
+            int a = i*itemsPerThread;
+            int b = (j < numberOfThreads) ? j*itemsPerThread : numberOfItems;
+            threads.Add( (direction == 0) ? static_cast<Thread*>( new RowThread( *this, a, b ) ) :
+                                            static_cast<Thread*>( new ColThread( *this, a, b ) ) );
+         }
+
+         int n = 0;
+         for ( Thread& thread : threads )
+            thread.Start( ThreadPriority::DefaultMax, n++ );
+         for ( Thread& thread : threads )
+            thread.Wait();
+
+         threads.Destroy();
+
+         if ( monitor != nullptr )
+            *monitor += numberOfItems;
+      }
+   }
+
+private:
+
+         int     m_rows;
+         int     m_cols;
+         scalar* m_output;
+   const scalar* m_input;
+         int     m_kind;
+
+   class RowThread : public Thread
+   {
+   public:
+
+      RowThread( PCL_DCT2DEngine& e, int r0, int r1 ) :
+         m_engine( e ), m_firstRow( r0 ), m_endRow( r1 )
+      {
+      }
+
+      void Run() override
+      {
+         plan P( m_engine.m_cols, m_engine.m_kind );
+         for ( int i = m_firstRow; i < m_endRow; ++i )
+         {
+            size_type d = size_type( i )*size_type( m_engine.m_cols );
+            P( m_engine.m_output + d, m_engine.m_input + d );
+         }
+      }
+
+   private:
+
+      PCL_DCT2DEngine& m_engine;
+      int              m_firstRow;
+      int              m_endRow;
+   };
+
+   /*
+    * Columns are transformed in tiles of contiguous columns, gathered and
+    * scattered with sequential accesses to short row segments.
+    */
+   class ColThread : public Thread
+   {
+   public:
+
+      ColThread( PCL_DCT2DEngine& e, int c0, int c1 ) :
+         m_engine( e ), m_firstCol( c0 ), m_endCol( c1 )
+      {
+      }
+
+      void Run() override
+      {
+         const int rows = m_engine.m_rows;
+         const int cols = m_engine.m_cols;
+         const int tileCols = Range( int( 64/sizeof( scalar ) ), 8, 16 );
+
+         plan P( rows, m_engine.m_kind );
+         GenericVector<scalar> tile( tileCols*rows );
+
+         for ( int j0 = m_firstCol; j0 < m_endCol; j0 += tileCols )
+         {
+            int n = Min( tileCols, m_endCol - j0 );
+
+            scalar* t = *tile;
+            const scalar* x = m_engine.m_output + j0;
+            for ( int i = 0; i < rows; ++i, x += cols )
+               for ( int c = 0, k = i; c < n; ++c, k += rows )
+                  t[k] = x[c];
+
+            for ( int c = 0, k = 0; c < n; ++c, k += rows )
+               P( t + k, t + k );
+
+            scalar* y = m_engine.m_output + j0;
+            for ( int i = 0; i < rows; ++i, y += cols )
+               for ( int c = 0, k = i; c < n; ++c, k += rows )
+                  y[c] = t[k];
+         }
+      }
+
+   private:
+
+      PCL_DCT2DEngine& m_engine;
+      int              m_firstCol;
+      int              m_endCol;
+   };
+};
+
+// ----------------------------------------------------------------------------
+
+int DCTBase::OptimizedLength( int n, int kind )
+{
+   return PCL_DCTPlan<float>::OptimizedLength( n, kind );
+}
+
+void* DCTBase::Create( int n, int kind, float* )
+{
+   return new PCL_DCTPlan<float>( n, kind );
+}
+
+void* DCTBase::Create( int n, int kind, double* )
+{
+   return new PCL_DCTPlan<double>( n, kind );
+}
+
+void DCTBase::Destroy( void* handle )
+{
+   delete reinterpret_cast<PCL_DCTPlanBase*>( handle );
+}
+
+void DCTBase::Transform( void* handle, float* y, const float* x )
+{
+   (*static_cast<PCL_DCTPlan<float>*>( reinterpret_cast<PCL_DCTPlanBase*>( handle ) ))( y, x );
+}
+
+void DCTBase::Transform( void* handle, double* y, const double* x )
+{
+   (*static_cast<PCL_DCTPlan<double>*>( reinterpret_cast<PCL_DCTPlanBase*>( handle ) ))( y, x );
+}
+
+void DCTBase::Transform( int rows, int cols, float* y, const float* x, int kind, StatusMonitor* monitor, bool parallel, int maxProcessors )
+{
+   PCL_DCT2DEngine<float>( rows, cols, y, x, kind, monitor, parallel, maxProcessors );
+}
+
+void DCTBase::Transform( int rows, int cols, double* y, const double* x, int kind, StatusMonitor* monitor, bool parallel, int maxProcessors )
+{
+   PCL_DCT2DEngine<double>( rows, cols, y, x, kind, monitor, parallel, maxProcessors );
+}
+
+double DCTBase::Scale( int n, int kind )
+{
+   switch ( kind )
+   {
+   case 0:  return 2.0*(n - 1);
+   case 4:  return 2.0*(n + 1);
+   default: return 2.0*n;
+   }
+}
+
+int DCTBase::InverseKind( int kind )
+{
+   switch ( kind )
+   {
+   case 1:  return 2;
+   case 2:  return 1;
+   case 5:  return 6;
+   case 6:  return 5;
+   default: return kind;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
+// EOF pcl/DCT.cpp - Released 2019-01-21T12:06:21Z
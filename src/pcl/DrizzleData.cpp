@@ -50,12 +50,14 @@
 // ----------------------------------------------------------------------------
 
 #include <pcl/AutoPointer.h>
+#include <pcl/BinaryContainer.h>
 #include <pcl/Compression.h>
 #include <pcl/Console.h>
 #include <pcl/DrizzleData.h>
 #include <pcl/XML.h>
 
 #include <errno.h>
+#include <string.h>
 
 namespace pcl
 {
@@ -82,7 +84,7 @@ void DrizzleData::ClearIntegrationData()
 
 // ----------------------------------------------------------------------------
 
-XMLDocument* DrizzleData::Serialize() const
+void DrizzleData::ValidateSerializableData() const
 {
    // Validate image registration data
    if ( m_sourceFilePath.IsEmpty() ||
@@ -97,6 +99,13 @@ XMLDocument* DrizzleData::Serialize() const
        !m_weight.IsEmpty() && m_location.Length() != m_weight.Length() ||
        !m_rejectionMap.IsEmpty() && m_location.Length() != m_rejectionMap.NumberOfChannels() )
       throw Error( "Invalid or insufficient image integration data." );
+}
+
+// ----------------------------------------------------------------------------
+
+XMLDocument* DrizzleData::Serialize() const
+{
+   ValidateSerializableData();
 
    AutoPointer<XMLDocument> xml = new XMLDocument;
    xml->SetXML( "1.0", "UTF-8" );
@@ -165,6 +174,63 @@ void DrizzleData::SerializeToFile( const String& path ) const
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Binary drizzle data format. Optional data are stored only when they are
+ * also serialized by Serialize(), so conversions between the .xdrz and binary
+ * formats are lossless.
+ */
+void DrizzleData::SerializeToBinaryFile( const String& path ) const
+{
+   ValidateSerializableData();
+
+   BinaryContainerWriter writer( "XDRZ" );
+
+   writer.AddText( "CreationTime", TimePoint::Now().ToString() );
+   writer.AddText( "SourceImage", m_sourceFilePath );
+   if ( !m_cfaSourceFilePath.IsEmpty() )
+   {
+      writer.AddText( "CFASourceImage", m_cfaSourceFilePath );
+      writer.AddText( "CFASourcePattern", m_cfaSourcePattern );
+   }
+   writer.AddText( "AlignmentTargetImage", m_alignTargetFilePath );
+
+   int32 geometry[] = { m_referenceWidth, m_referenceHeight };
+   writer.AddBlock( "ReferenceGeometry", BinaryBlockType::Int32, geometry, sizeof( geometry ), 2 );
+
+   if ( !m_H.IsEmpty() )
+      writer.AddBlock( "AlignmentMatrix", BinaryBlockType::Float64, m_H.Begin(), m_H.Size(), 3, 3 );
+
+   Vector px, py;
+   if ( m_S.IsValid() )
+   {
+      EncodeBinarySpline( writer, m_S.m_Sx, "SplineX.", px );
+      EncodeBinarySpline( writer, m_S.m_Sy, "SplineY.", py );
+   }
+
+   ByteArray rejectionMap;
+   if ( !m_location.IsEmpty() )
+   {
+      writer.AddVector( "LocationEstimates", m_location );
+      writer.AddVector( "ReferenceLocation", m_referenceLocation );
+      writer.AddVector( "ScaleFactors", m_scale );
+      writer.AddVector( "Weights", m_weight );
+      if ( !m_rejectionMap.IsEmpty() )
+      {
+         // Store all channels of the rejection map as a contiguous block.
+         size_type channelSize = m_rejectionMap.ChannelSize();
+         rejectionMap = ByteArray( channelSize*m_rejectionMap.NumberOfChannels() );
+         for ( int c = 0; c < m_rejectionMap.NumberOfChannels(); ++c )
+            ::memcpy( rejectionMap.At( c*channelSize ), m_rejectionMap[c], channelSize );
+         writer.AddBlock( "RejectionMap", BinaryBlockType::UInt8, rejectionMap.Begin(), rejectionMap.Length(),
+                          m_rejectionMap.Width(), m_rejectionMap.Height(), m_rejectionMap.NumberOfChannels() );
+      }
+   }
+
+   writer.WriteFile( path );
+}
+
+// ----------------------------------------------------------------------------
+
 static void WarnOnUnexpectedChildNode( const XMLNode& node, const String& parsingWhatElement )
 {
    if ( !node.IsComment() )
@@ -240,6 +306,30 @@ static Vector ParseListOfRealValues( const XMLElement& element, size_type minCou
    return ParseListOfRealValues( text, 0, text.Length(), minCount, maxCount );
 }
 
+static Vector ParseListOfRealValues( const XMLStringView& text, size_type minCount = 0, size_type maxCount = ~size_type( 0 ) )
+{
+   XMLStringView list = text.Trimmed();
+   Array<double> v;
+   for ( XMLStringView::const_iterator i = list.Begin(); i < list.End(); ++i )
+   {
+      XMLStringView::const_iterator j = reinterpret_cast<XMLStringView::const_iterator>( ::memchr( i, ',', list.End() - i ) );
+      if ( j == nullptr )
+         j = list.End();
+      char* endptr = nullptr;
+      errno = 0;
+      double x = ::strtod( i, &endptr );
+      if ( errno != 0 || endptr == i || endptr > j || !XMLStringView( endptr, j ).Trimmed().IsEmpty() )
+         throw Error( "Parsing real numeric list: Invalid floating point numeric literal \'" + IsoString( i, j ) + "\'" );
+      if ( v.Length() == maxCount )
+         throw Error( "Parsing real numeric list: Too many items." );
+      v << x;
+      i = j;
+   }
+   if ( v.Length() < minCount )
+      throw Error( "Parsing real numeric list: Too few items." );
+   return Vector( v.Begin(), int( v.Length() ) );
+}
+
 static IVector ParseListOfIntegerValues( IsoString& text, size_type start, size_type end, size_type minCount = 0, size_type maxCount = ~size_type( 0 ) )
 {
    Array<int> v;
@@ -281,35 +371,375 @@ static int ParseIntegerValue( const IsoString& s, size_type start, size_type end
 // ----------------------------------------------------------------------------
 
 template <typename T>
-static GenericVector<T> ParseBase64EncodedVector( const XMLElement& element, size_type minCount = 0, size_type maxCount = ~size_type( 0 ) )
+static GenericVector<T> ParseBase64EncodedVector( const XMLStringView& text, const String& elementName, size_type minCount = 0, size_type maxCount = ~size_type( 0 ) )
 {
-   ByteArray data = IsoString( element.Text().Trimmed() ).FromBase64();
+   XMLStringView encoded = text.Trimmed();
+   ByteArray data = IsoString( encoded.Begin(), encoded.End() ).FromBase64();
    if ( data.IsEmpty() )
-      throw Error( "Missing encoded vector data in " + element.Name() + " element." );
+      throw Error( "Missing encoded vector data in " + elementName + " element." );
    if ( data.Size() % sizeof( T ) != 0 )
-      throw Error( "Invalid size of encoded vector data in " + element.Name() + " element." );
+      throw Error( "Invalid size of encoded vector data in " + elementName + " element." );
    size_type n = data.Size()/sizeof( T );
    if ( n < minCount )
-      throw Error( "Too few vector components in " + element.Name() + " element." );
+      throw Error( "Too few vector components in " + elementName + " element." );
    if ( n > maxCount )
-      throw Error( "Too many vector components in " + element.Name() + " element." );
+      throw Error( "Too many vector components in " + elementName + " element." );
    return GenericVector<T>( reinterpret_cast<const T*>( data.Begin() ), int( n ) );
 }
 
+template <typename T>
+static GenericVector<T> ParseBase64EncodedVector( const XMLElement& element, size_type minCount = 0, size_type maxCount = ~size_type( 0 ) )
+{
+   IsoString text( element.Text() );
+   return ParseBase64EncodedVector<T>( XMLStringView( text.Begin(), text.End() ), element.Name(), minCount, maxCount );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Event-driven XDRZ decoder. Numeric lists and Base64 encoded data are
+ * decoded directly from the UTF-8 encoded source document, without generating
+ * an XML document tree. Error handling is equivalent to
+ * Parse( const XMLElement& ): errors found in a child element of the root
+ * element are shown and the element is ignored.
+ */
+class DrizzleData::XMLDecoder : public XMLSAXDecoder
+{
+public:
+
+   XMLDecoder( DrizzleData* data, bool ignoreIntegrationData ) :
+      m_data( data ),
+      m_ignoreIntegrationData( ignoreIntegrationData )
+   {
+   }
+
+protected:
+
+   void StartRootElement( const XMLStringView& name, const XMLSAXAttributeList& attributes ) override
+   {
+      if ( name != "xdrz" || attributes.AttributeValue( "version" ) != "1.0" )
+         throw Error( "Not an XDRZ version 1.0 document." );
+   }
+
+   void StartDecodedElement( const XMLStringView& name, const XMLSAXAttributeList& attributes ) override
+   {
+      if ( Depth() == 2 )
+         m_spline = nullptr;
+
+      switch ( Depth() )
+      {
+      case 2:
+         if ( name == "SourceImage" || name == "AlignmentTargetImage" || name == "AlignmentMatrix" || name == "CreationTime" )
+         {
+            StartText();
+         }
+         else if ( name == "CFASourceImage" )
+         {
+            m_data->m_cfaSourcePattern = attributes.AttributeValue( "pattern" );
+            StartText();
+         }
+         else if ( name == "ReferenceGeometry" )
+         {
+            String width = attributes.AttributeValue( "width" );
+            String height = attributes.AttributeValue( "height" );
+            if ( width.IsEmpty() || height.IsEmpty() )
+               throw Error( "Missing reference dimension attribute(s)." );
+            m_data->m_referenceWidth = width.ToInt();
+            m_data->m_referenceHeight = height.ToInt();
+            if ( m_data->m_referenceWidth < 1 || m_data->m_referenceHeight < 1 )
+               throw Error( "Invalid reference dimension(s)." );
+            StartText();
+         }
+         else if ( name == "LocationEstimates" || name == "ReferenceLocation" || name == "ScaleFactors" || name == "Weights" )
+         {
+            if ( m_ignoreIntegrationData )
+               SkipElement();
+            else
+               StartText();
+         }
+         else if ( name == "AlignmentSplineX" )
+            StartSpline( m_data->m_Sx, attributes );
+         else if ( name == "AlignmentSplineY" )
+            StartSpline( m_data->m_Sy, attributes );
+         else if ( name == "RejectionMap" )
+         {
+            if ( m_ignoreIntegrationData )
+               SkipElement();
+            else
+               StartRejectionMap( attributes );
+         }
+         else
+            SkipUnknownElement( name, "xdrz root" );
+         break;
+
+      case 3:
+         if ( m_spline != nullptr )
+         {
+            if ( name == "NodeXCoordinates" || name == "NodeYCoordinates" || name == "Coefficients" || name == "NodeWeights" )
+               StartText();
+            else
+               SkipUnknownElement( name, "AlignmentSplineX/AlignmentSplineY" );
+         }
+         else
+         {
+            if ( name == "ChannelData" )
+               StartChannelData( attributes );
+            else
+               SkipUnknownElement( name, "RejectionMap" );
+         }
+         break;
+
+      default:
+         if ( name == "Subblock" )
+         {
+            String s = attributes.AttributeValue( "uncompressedSize" );
+            if ( s.IsEmpty() )
+               throw Error( "Missing subblock uncompressedSize attribute." );
+            m_uncompressedSize = s.ToUInt64();
+            StartText();
+         }
+         else
+            SkipUnknownElement( name, "ChannelData" );
+         break;
+      }
+   }
+
+   void EndDecodedElement( const XMLStringView& name ) override
+   {
+      switch ( Depth() )
+      {
+      case 2:
+         if ( name == "SourceImage" )
+         {
+            m_data->m_sourceFilePath = Text().DecodedText().Trimmed();
+            if ( m_data->m_sourceFilePath.IsEmpty() )
+               throw Error( "Empty source file path definition." );
+         }
+         else if ( name == "CFASourceImage" )
+            m_data->m_cfaSourceFilePath = Text().DecodedText().Trimmed();
+         else if ( name == "AlignmentTargetImage" )
+            m_data->m_alignTargetFilePath = Text().DecodedText().Trimmed();
+         else if ( name == "CreationTime" )
+            m_data->m_creationTime = TimePoint( Text().DecodedText().Trimmed() );
+         else if ( name == "AlignmentMatrix" )
+         {
+            Vector v = ParseListOfRealValues( Text(), 9, 9 );
+            m_data->m_H = Matrix( v.Begin(), 3, 3 );
+         }
+         else if ( name == "LocationEstimates" )
+            m_data->m_location = ParseListOfRealValues( Text(), 1 );
+         else if ( name == "ReferenceLocation" )
+            m_data->m_referenceLocation = ParseListOfRealValues( Text(), 1 );
+         else if ( name == "ScaleFactors" )
+            m_data->m_scale = ParseListOfRealValues( Text(), 1 );
+         else if ( name == "Weights" )
+            m_data->m_weight = ParseListOfRealValues( Text(), 1 );
+         else if ( name == "AlignmentSplineX" || name == "AlignmentSplineY" )
+            EndSpline();
+         else if ( name == "RejectionMap" )
+         {
+            if ( m_channel < m_data->m_rejectionMap.NumberOfChannels() )
+               throw Error( "Missing rejection map channel data." );
+         }
+         break;
+
+      case 3:
+         if ( m_spline != nullptr )
+         {
+            String elementName = name.ToString();
+            if ( name == "NodeXCoordinates" )
+               m_spline->m_x = ParseBase64EncodedVector<vector_spline::spline::scalar>( Text(), elementName, 3 );
+            else if ( name == "NodeYCoordinates" )
+               m_spline->m_y = ParseBase64EncodedVector<vector_spline::spline::scalar>( Text(), elementName, 3 );
+            else if ( name == "Coefficients" )
+               m_spline->m_spline = ParseBase64EncodedVector<vector_spline::spline::scalar>( Text(), elementName, 3 );
+            else
+               m_spline->m_weights = ParseBase64EncodedVector<FVector::scalar>( Text(), elementName, 3 );
+         }
+         else
+            EndChannelData();
+         break;
+
+      default:
+         {
+            Compression::Subblock subblock;
+            subblock.uncompressedSize = m_uncompressedSize;
+            subblock.compressedData = DecodeBase64( Text() );
+            m_subblocks << subblock;
+         }
+         break;
+      }
+   }
+
+private:
+
+   DrizzleData*               m_data;
+   bool                       m_ignoreIntegrationData;
+   spline*                    m_spline = nullptr;     // current alignment spline, nullptr if none
+   int                        m_channel = 0;
+   AutoPointer<Compression>   m_compression;
+   Compression::subblock_list m_subblocks;
+   uint64                     m_uncompressedSize = 0;
+
+   void StartSpline( spline& S, const XMLSAXAttributeList& attributes )
+   {
+      // Scaling factor for normalization of node coordinates
+      String s = attributes.AttributeValue( "scalingFactor" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing surface spline scalingFactor attribute." );
+      S.m_r0 = s.ToDouble();
+      if ( S.m_r0 <= 0 )
+         throw Error( "Invalid surface spline scaling factor '" + s + '\'' );
+
+      // Zero offset for normalization of X node coordinates
+      s = attributes.AttributeValue( "zeroOffsetX" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing surface spline zeroOffsetX attribute." );
+      S.m_x0 = s.ToDouble();
+
+      // Zero offset for normalization of Y node coordinates
+      s = attributes.AttributeValue( "zeroOffsetY" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing surface spline zeroOffsetY attribute." );
+      S.m_y0 = s.ToDouble();
+
+      // Derivative order > 0
+      s = attributes.AttributeValue( "order" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing surface spline order attribute." );
+      S.m_order = s.ToInt();
+      if ( S.m_order < 1 )
+         throw Error( "Invalid surface spline derivative order '" + s + '\'' );
+
+      // Smoothing factor, or interpolating 2-D spline if m_smoothing == 0
+      s = attributes.AttributeValue( "smoothing" );
+      if ( !s.IsEmpty() )
+      {
+         S.m_smoothing = s.ToFloat();
+         if ( S.m_smoothing < 0 )
+            throw Error( "Invalid surface spline smoothing factor '" + s + '\'' );
+      }
+      else
+         S.m_smoothing = 0;
+
+      S.m_x.Clear();
+      S.m_y.Clear();
+      S.m_weights.Clear();
+      S.m_spline.Clear();
+
+      m_spline = &S;
+   }
+
+   void EndSpline()
+   {
+      ValidateSpline( *m_spline );
+   }
+
+   void StartRejectionMap( const XMLSAXAttributeList& attributes )
+   {
+      String s = attributes.AttributeValue( "width" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing rejection map width attribute." );
+      int width = s.ToInt();
+      if ( width < 1 )
+         throw Error( "Invalid rejection map width attribute value '" + s + '\'' );
+
+      s = attributes.AttributeValue( "height" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing rejection map height attribute." );
+      int height = s.ToInt();
+      if ( height < 1 )
+         throw Error( "Invalid rejection map height attribute value '" + s + '\'' );
+
+      s = attributes.AttributeValue( "numberOfChannels" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing rejection map numberOfChannels attribute." );
+      int numberOfChannels = s.ToInt();
+      if ( numberOfChannels < 1 )
+         throw Error( "Invalid rejection map numberOfChannels attribute value '" + s + '\'' );
+
+      m_data->m_rejectionMap.AllocateData( width, height, numberOfChannels );
+      m_channel = 0;
+   }
+
+   void StartChannelData( const XMLSAXAttributeList& attributes )
+   {
+      if ( m_channel == m_data->m_rejectionMap.NumberOfChannels() )
+         throw Error( "Unexpected ChannelData child element - all rejection map channels are already defined." );
+
+      m_compression.Reset();
+      m_subblocks.Clear();
+
+      String compressionName = attributes.AttributeValue( "compression" ).CaseFolded();
+      if ( !compressionName.IsEmpty() )
+      {
+         if ( compressionName == "lz4" )
+            m_compression = new LZ4Compression;
+         else if ( compressionName == "lz4hc" )
+            m_compression = new LZ4HCCompression;
+         else if ( compressionName == "zlib" )
+            m_compression = new ZLibCompression;
+         else
+            throw Error( "Unknown or unsupported compression codec '" + compressionName + '\'' );
+      }
+      else
+         StartText();
+   }
+
+   void EndChannelData()
+   {
+      ByteArray channelData;
+      if ( m_compression.IsValid() )
+      {
+         if ( m_subblocks.IsEmpty() )
+            throw Error( "Parsing xdrz RejectionMap ChannelData element: Missing Subblock child element(s)." );
+         channelData = m_compression->Uncompress( m_subblocks );
+         m_subblocks.Clear();
+      }
+      else
+         channelData = DecodeBase64( Text() );
+
+      if ( channelData.Size() != m_data->m_rejectionMap.ChannelSize() )
+         throw Error( "Parsing xdrz RejectionMap ChannelData element: Invalid channel data size: "
+            "Expected " + String( m_data->m_rejectionMap.ChannelSize() ) + " bytes, "
+            "got " + String( channelData.Size() ) + " bytes." );
+
+      ::memcpy( m_data->m_rejectionMap[m_channel], channelData.Begin(), channelData.Size() );
+
+      ++m_channel;
+   }
+
+   String ParentElementName() const override
+   {
+      switch ( Depth() )
+      {
+      case 1:  return "xdrz root";
+      case 2:  return (m_spline != nullptr) ? String( "AlignmentSplineX/AlignmentSplineY" ) : ElementName();
+      default: return "ChannelData";
+      }
+   }
+};
+
 // ----------------------------------------------------------------------------
 
 void DrizzleData::Parse( const String& filePath, bool ignoreIntegrationData )
 {
+   if ( BinaryContainerReader::IsContainerFile( filePath ) )
+   {
+      Clear();
+      DecodeBinary( BinaryContainerReader( filePath, "XDRZ" ), ignoreIntegrationData );
+      ValidateParsedData( ignoreIntegrationData );
+      return;
+   }
+
    IsoString text = File::ReadTextFile( filePath );
    for ( auto ch : text )
    {
       if ( ch == '<' )
       {
-         XMLDocument xml;
-         xml.SetParserOption( XMLParserOption::IgnoreComments );
-         xml.SetParserOption( XMLParserOption::IgnoreUnknownElements );
-         xml.Parse( text.UTF8ToUTF16() );
-         Parse( xml, ignoreIntegrationData );
+         Clear();
+         XMLDecoder( this, ignoreIntegrationData ).Parse( text );
+         ValidateParsedData( ignoreIntegrationData );
          return;
       }
 
@@ -469,6 +899,76 @@ void DrizzleData::Parse( const XMLElement& root, bool ignoreIntegrationData )
       }
    }
 
+   ValidateParsedData( ignoreIntegrationData );
+}
+
+// ----------------------------------------------------------------------------
+
+void DrizzleData::DecodeBinary( const BinaryContainerReader& reader, bool ignoreIntegrationData )
+{
+   String creationTime = reader.TextBlock( "CreationTime" );
+   if ( !creationTime.IsEmpty() )
+      m_creationTime = TimePoint( creationTime );
+
+   m_sourceFilePath = reader.TextBlock( "SourceImage" );
+   m_cfaSourceFilePath = reader.TextBlock( "CFASourceImage" );
+   m_cfaSourcePattern = reader.TextBlock( "CFASourcePattern" );
+   m_alignTargetFilePath = reader.TextBlock( "AlignmentTargetImage" );
+
+   size_type length;
+   const int32* geometry = reader.BlockData<int32>( "ReferenceGeometry", length );
+   if ( geometry != nullptr )
+   {
+      if ( length != 2 )
+         throw Error( "Invalid ReferenceGeometry block." );
+      m_referenceWidth = geometry[0];
+      m_referenceHeight = geometry[1];
+      if ( m_referenceWidth < 1 || m_referenceHeight < 1 )
+         throw Error( "Invalid reference dimension(s)." );
+   }
+
+   const double* H = reader.BlockData<double>( "AlignmentMatrix", length );
+   if ( H != nullptr )
+   {
+      if ( length != 9 )
+         throw Error( "Invalid AlignmentMatrix block." );
+      m_H = Matrix( H, 3, 3 );
+   }
+
+   if ( reader.FindBlock( "SplineX.Parameters" ) != nullptr )
+      DecodeBinarySpline( m_Sx, reader, "SplineX." );
+   if ( reader.FindBlock( "SplineY.Parameters" ) != nullptr )
+      DecodeBinarySpline( m_Sy, reader, "SplineY." );
+
+   if ( !ignoreIntegrationData )
+   {
+      m_location = reader.VectorBlock<double>( "LocationEstimates" );
+      m_referenceLocation = reader.VectorBlock<double>( "ReferenceLocation" );
+      m_scale = reader.VectorBlock<double>( "ScaleFactors" );
+      m_weight = reader.VectorBlock<double>( "Weights" );
+
+      const uint8* rejectionMap = reader.BlockData<uint8>( "RejectionMap", length );
+      if ( rejectionMap != nullptr )
+      {
+         const BinaryContainerReader::Block* block = reader.FindBlock( "RejectionMap" );
+         int width = block->dim[0];
+         int height = block->dim[1];
+         int numberOfChannels = block->dim[2];
+         if ( width < 1 || height < 1 || numberOfChannels < 1 ||
+              length != size_type( width )*size_type( height )*size_type( numberOfChannels ) )
+            throw Error( "Invalid RejectionMap block." );
+         m_rejectionMap.AllocateData( width, height, numberOfChannels );
+         size_type channelSize = m_rejectionMap.ChannelSize();
+         for ( int c = 0; c < numberOfChannels; ++c )
+            ::memcpy( m_rejectionMap[c], rejectionMap + c*channelSize, channelSize );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void DrizzleData::ValidateParsedData( bool ignoreIntegrationData )
+{
    if ( m_sourceFilePath.IsEmpty() )
       throw Error( "Missing required SourceImage element." );
 
@@ -504,16 +1004,20 @@ void DrizzleData::Parse( const XMLElement& root, bool ignoreIntegrationData )
       {
          if ( m_location.Length() != m_rejectionMap.NumberOfChannels() )
             throw Error( "Incongruent pixel rejection map definition." );
-         m_rejectionHighCount = UI64Vector( uint64( 0 ), m_location.Length() );
-         m_rejectionLowCount = UI64Vector( uint64( 0 ), m_location.Length() );
-         for ( UInt8Image::const_pixel_iterator i( m_rejectionMap ); i; ++i )
-            for ( int j = 0; j < m_location.Length(); ++j )
+         m_rejectionHighCount = UI64Vector( m_location.Length() );
+         m_rejectionLowCount = UI64Vector( m_location.Length() );
+         for ( int j = 0; j < m_location.Length(); ++j )
+         {
+            // Channel by channel for vectorization of the counting loop.
+            uint64 highCount = 0, lowCount = 0;
+            for ( const uint8* p = m_rejectionMap[j], * p1 = p + m_rejectionMap.NumberOfPixels(); p < p1; ++p )
             {
-               if ( i[j] & 1 )
-                  ++m_rejectionHighCount[j];
-               if ( i[j] & 2 )
-                  ++m_rejectionLowCount[j];
+               highCount += *p & 1;
+               lowCount += (*p >> 1) & 1;
             }
+            m_rejectionHighCount[j] = highCount;
+            m_rejectionLowCount[j] = lowCount;
+         }
       }
    }
 
@@ -754,6 +1258,13 @@ void DrizzleData::ParseSpline( DrizzleData::spline& S, const XMLElement& root )
       }
    }
 
+   ValidateSpline( S );
+}
+
+// ----------------------------------------------------------------------------
+
+void DrizzleData::ValidateSpline( const DrizzleData::spline& S )
+{
    if ( S.m_x.Length() < 3 )
       throw Error( "Missing surface spline NodeXCoordinates child element." );
    if ( S.m_y.Length() < 3 )
@@ -771,6 +1282,51 @@ void DrizzleData::ParseSpline( DrizzleData::spline& S, const XMLElement& root )
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Binary surface spline parameters: scaling factor, zero offsets, derivative
+ * order and smoothing factor, in this order, stored as a Float64 block.
+ */
+void DrizzleData::DecodeBinarySpline( DrizzleData::spline& S, const BinaryContainerReader& reader, const IsoString& prefix )
+{
+   Vector p = reader.VectorBlock<double>( prefix + "Parameters" );
+   if ( p.Length() != 5 )
+      throw Error( "Invalid " + prefix + "Parameters block." );
+
+   S.m_r0 = p[0];
+   if ( S.m_r0 <= 0 )
+      throw Error( "Invalid surface spline scaling factor '" + String( S.m_r0 ) + '\'' );
+   S.m_x0 = p[1];
+   S.m_y0 = p[2];
+   S.m_order = int( p[3] );
+   if ( S.m_order < 1 )
+      throw Error( "Invalid surface spline derivative order '" + String( S.m_order ) + '\'' );
+   S.m_smoothing = float( p[4] );
+   if ( S.m_smoothing < 0 )
+      throw Error( "Invalid surface spline smoothing factor '" + String( S.m_smoothing ) + '\'' );
+
+   S.m_x = reader.VectorBlock<vector_spline::spline::scalar>( prefix + "NodeX" );
+   S.m_y = reader.VectorBlock<vector_spline::spline::scalar>( prefix + "NodeY" );
+   S.m_spline = reader.VectorBlock<vector_spline::spline::scalar>( prefix + "Coefficients" );
+   S.m_weights = reader.VectorBlock<FVector::scalar>( prefix + "NodeWeights" );
+
+   ValidateSpline( S );
+}
+
+// ----------------------------------------------------------------------------
+
+void DrizzleData::EncodeBinarySpline( BinaryContainerWriter& writer, const DrizzleData::spline& S, const IsoString& prefix, Vector& parameters )
+{
+   parameters = Vector( { S.m_r0, S.m_x0, S.m_y0, double( S.m_order ), double( S.m_smoothing ) } );
+   writer.AddVector( prefix + "Parameters", parameters );
+   writer.AddVector( prefix + "NodeX", S.m_x );
+   writer.AddVector( prefix + "NodeY", S.m_y );
+   writer.AddVector( prefix + "Coefficients", S.m_spline );
+   if ( S.m_smoothing > 0 )
+      writer.AddVector( prefix + "NodeWeights", S.m_weights );
+}
+
+// ----------------------------------------------------------------------------
+
 void DrizzleData::SerializeSpline( XMLElement* root, const DrizzleData::spline& S )
 {
    root->SetAttribute( "scalingFactor", String( S.m_r0 ) );
@@ -49,14 +49,194 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------------------------------------
 
+#include <pcl/AutoLock.h>
 #include <pcl/FFT2D.h>
 #include <pcl/Thread.h>
 
+#include <pcl/api/APIInterface.h>
+
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Cache of one-dimensional FFT plans.
+ *
+ * Creating a plan involves factorizing the transform length and computing a
+ * complete set of twiddle factors, which is wasteful when the same 2-D
+ * transform sizes are used repeatedly, as happens with FFT convolutions and
+ * registrations. Plans are not reentrant (real transforms use internal work
+ * buffers), so each plan is owned by a single thread between Acquire() and
+ * Release() calls. Released plans are kept for reuse by subsequent transforms
+ * of the same length, direction and data type, up to a fixed maximum number of
+ * idle plans; the least recently released plans are destroyed first.
+ */
+class PCL_FFTPlanCache : public FFT1DBase
+{
+public:
+
+   PCL_FFTPlanCache() = default;
+
+   ~PCL_FFTPlanCache()
+   {
+      /*
+       * The core application may have been disconnected at this point.
+       */
+      if ( API != nullptr )
+         for ( const Plan& plan : m_plans )
+            try
+            {
+               Destroy( plan.handle );
+            }
+            catch ( ... )
+            {
+            }
+   }
+
+   template <typename T>
+   void* Acquire( int length, bool inverse, T* )
+   {
+      {
+         int type = TypeCode( static_cast<T*>( nullptr ) );
+         volatile AutoLock lock( m_mutex );
+         for ( size_type i = m_plans.Length(); i > 0; )
+         {
+            plan_list::iterator p = m_plans.At( --i );
+            if ( p->length == length && p->type == type && p->inverse == inverse )
+            {
+               void* handle = p->handle;
+               m_plans.Remove( p );
+               return handle;
+            }
+         }
+      }
+
+      return inverse ? CreateInv( length, static_cast<T*>( nullptr ) ) : Create( length, static_cast<T*>( nullptr ) );
+   }
+
+   template <typename T>
+   void Release( void* handle, int length, bool inverse, T* )
+   {
+      Plan plan = { handle, length, TypeCode( static_cast<T*>( nullptr ) ), inverse };
+      void* expired = nullptr;
+      {
+         volatile AutoLock lock( m_mutex );
+         m_plans.Add( plan );
+         if ( m_plans.Length() > MaxIdlePlans )
+         {
+            plan_list::iterator oldest = m_plans.Begin();
+            expired = oldest->handle;
+            m_plans.Remove( oldest );
+         }
+      }
+
+      if ( expired != nullptr )
+         Destroy( expired );
+   }
+
+private:
+
+   enum { MaxIdlePlans = 64 };
+
+   struct Plan
+   {
+      void* handle;
+      int   length;
+      int   type;
+      bool  inverse;
+   };
+
+   typedef Array<Plan> plan_list;
+
+   Mutex     m_mutex;
+   plan_list m_plans;
+
+   static int TypeCode( fcomplex* ) { return 0; }
+   static int TypeCode( dcomplex* ) { return 1; }
+   static int TypeCode( float* )    { return 2; }
+   static int TypeCode( double* )   { return 3; }
+};
+
+static PCL_FFTPlanCache s_planCache;
+
+// ----------------------------------------------------------------------------
+
+/*
+ * A one-dimensional FFT plan borrowed from the plan cache for the lifetime of
+ * this object. Ti is the input data type of the forward transform.
+ */
+template <typename Ti>
+class PCL_FFTPlan : public FFT1DBase
+{
+public:
+
+   PCL_FFTPlan( int length, bool inverse ) :
+      m_handle( s_planCache.Acquire( length, inverse, static_cast<Ti*>( nullptr ) ) ),
+      m_length( length ), m_inverse( inverse )
+   {
+   }
+
+   ~PCL_FFTPlan()
+   {
+      s_planCache.Release( m_handle, m_length, m_inverse, static_cast<Ti*>( nullptr ) );
+   }
+
+   template <typename To, typename T>
+   void operator()( To* y, const T* x ) const
+   {
+      Transform( m_handle, y, x );
+   }
+
+   /*
+    * Transforms the columns [c0,c1) of a row-major matrix of complex values
+    * with the specified number of rows and distance between rows (stride).
+    * This plan must be a complex transform of length equal to rows.
+    *
+    * A column-by-column gather of single elements would touch a different
+    * cache line for every element read and written. Instead, columns are
+    * processed in tiles of contiguous columns: each tile is gathered with
+    * sequential reads of short row segments into a column-major work buffer,
+    * transformed on contiguous data, and scattered back with sequential writes
+    * of short row segments.
+    */
+   template <typename C>
+   void TransformColumns( C* output, const C* input, int rows, int stride, int c0, int c1 ) const
+   {
+      const int tileCols = Range( int( 128/sizeof( C ) ), 8, 16 );
+      GenericVector<C> itile( tileCols*rows );
+      GenericVector<C> otile( tileCols*rows );
+
+      for ( int j0 = c0; j0 < c1; j0 += tileCols )
+      {
+         int n = Min( tileCols, c1 - j0 );
+
+         C* t = *itile;
+         const C* x = input + j0;
+         for ( int i = 0; i < rows; ++i, x += stride )
+            for ( int c = 0, k = i; c < n; ++c, k += rows )
+               t[k] = x[c];
+
+         for ( int c = 0, k = 0; c < n; ++c, k += rows )
+            Transform( m_handle, *otile + k, *itile + k );
+
+         const C* u = *otile;
+         C* y = output + j0;
+         for ( int i = 0; i < rows; ++i, y += stride )
+            for ( int c = 0, k = i; c < n; ++c, k += rows )
+               y[c] = u[k];
+      }
+   }
+
+private:
+
+   void* m_handle;
+   int   m_length;
+   bool  m_inverse;
+};
+
+// ----------------------------------------------------------------------------
+
 template <typename To, typename Ti>
 class PCL_FFT2DEngineBase
 {
@@ -158,7 +338,7 @@ private:
 
    friend class RowThread;
 
-   class RowThread : public Thread, public FFT1DBase
+   class RowThread : public Thread
    {
    public:
 
@@ -169,8 +349,7 @@ private:
 
       void Run() override
       {
-         void* h = (m_engine.m_dir == PCL_FFT_FORWARD) ?
-               this->Create( m_engine.m_cols, (complex*)0 ) : this->CreateInv( m_engine.m_cols, (complex*)0 );
+         PCL_FFTPlan<complex> fft( m_engine.m_cols, m_engine.m_dir != PCL_FFT_FORWARD );
 
          if ( m_engine.m_overlapped )
          {
@@ -180,7 +359,7 @@ private:
             {
                int d = i*m_engine.m_cols;
                memcpy( *irow, m_engine.m_input + d, m_engine.m_cols*sizeof( complex ) );
-               this->Transform( h, m_engine.m_output + d, *irow );
+               fft( m_engine.m_output + d, *irow );
             }
          }
          else
@@ -188,11 +367,9 @@ private:
             for ( int i = m_firstRow; i < m_endRow; ++i )
             {
                int d = i*m_engine.m_cols;
-               this->Transform( h, m_engine.m_output + d, m_engine.m_input + d );
+               fft( m_engine.m_output + d, m_engine.m_input + d );
             }
          }
-
-         this->Destroy( h );
       }
 
    private:
@@ -204,7 +381,7 @@ private:
 
    friend class ColThread;
 
-   class ColThread : public Thread, public FFT1DBase
+   class ColThread : public Thread
    {
    public:
 
@@ -215,24 +392,8 @@ private:
 
       void Run() override
       {
-         void* h = (m_engine.m_dir == PCL_FFT_FORWARD) ?
-               this->Create( m_engine.m_rows, (complex*)0 ) : this->CreateInv( m_engine.m_rows, (complex*)0 );
-
-         GenericVector<complex> icol( m_engine.m_rows );
-         GenericVector<complex> ocol( m_engine.m_rows );
-
-         for ( int j = m_firstCol; j < m_endCol; ++j )
-         {
-            for ( int i = 0, k = j; i < m_engine.m_rows; ++i, k += m_engine.m_cols )
-               icol[i] = m_engine.m_output[k];
-
-            this->Transform( h, *ocol, *icol );
-
-            for ( int i = 0, k = j; i < m_engine.m_rows; ++i, k += m_engine.m_cols )
-               m_engine.m_output[k] = ocol[i];
-         }
-
-         this->Destroy( h );
+         PCL_FFTPlan<complex> fft( m_engine.m_rows, m_engine.m_dir != PCL_FFT_FORWARD );
+         fft.TransformColumns( m_engine.m_output, m_engine.m_output, m_engine.m_rows, m_engine.m_cols, m_firstCol, m_endCol );
       }
 
    private:
@@ -313,7 +474,7 @@ private:
 
    friend class RowThread;
 
-   class RowThread : public Thread, public FFT1DBase
+   class RowThread : public Thread
    {
    public:
 
@@ -324,10 +485,9 @@ private:
 
       void Run() override
       {
-         void* h = this->Create( m_engine.m_cols, (scalar*)0 );
+         PCL_FFTPlan<scalar> fft( m_engine.m_cols, false/*inverse*/ );
          for ( int i = m_firstRow; i < m_endRow; ++i )
-            this->Transform( h, m_engine.m_output + i*m_engine.m_transformCols, m_engine.m_input + i*m_engine.m_cols );
-         this->Destroy( h );
+            fft( m_engine.m_output + i*m_engine.m_transformCols, m_engine.m_input + i*m_engine.m_cols );
       }
 
    private:
@@ -339,7 +499,7 @@ private:
 
    friend class ColThread;
 
-   class ColThread : public Thread, public FFT1DBase
+   class ColThread : public Thread
    {
    public:
 
@@ -350,23 +510,8 @@ private:
 
       void Run() override
       {
-         void* h = this->Create( m_engine.m_rows, (complex*)0 );
-
-         GenericVector<complex> icol( m_engine.m_rows );
-         GenericVector<complex> ocol( m_engine.m_rows );
-
-         for ( int j = m_firstCol; j < m_endCol; ++j )
-         {
-            for ( int i = 0, k = j; i < m_engine.m_rows; ++i, k += m_engine.m_transformCols )
-               icol[i] = m_engine.m_output[k];
-
-            this->Transform( h, *ocol, *icol );
-
-            for ( int i = 0, k = j; i < m_engine.m_rows; ++i, k += m_engine.m_transformCols )
-               m_engine.m_output[k] = ocol[i];
-         }
-
-         this->Destroy( h );
+         PCL_FFTPlan<complex> fft( m_engine.m_rows, false/*inverse*/ );
+         fft.TransformColumns( m_engine.m_output, m_engine.m_output, m_engine.m_rows, m_engine.m_transformCols, m_firstCol, m_endCol );
       }
 
    private:
@@ -426,7 +571,7 @@ private:
 
    friend class ColThread;
 
-   class ColThread : public Thread, public FFT1DBase
+   class ColThread : public Thread
    {
    public:
 
@@ -437,23 +582,8 @@ private:
 
       void Run() override
       {
-         void* h = this->CreateInv( m_engine.m_rows, (complex*)0 );
-
-         GenericVector<complex> icol( m_engine.m_rows );
-         GenericVector<complex> ocol( m_engine.m_rows );
-
-         for ( int j = m_firstCol; j < m_endCol; ++j )
-         {
-            for ( int i = 0, k = j; i < m_engine.m_rows; ++i, k += m_engine.m_transformCols )
-               icol[i] = m_engine.m_input[k];
-
-            this->Transform( h, *ocol, *icol );
-
-            for ( int i = 0; i < m_engine.m_rows; ++i )
-               m_engine.m_colTransform[i][j] = ocol[i];
-         }
-
-         this->Destroy( h );
+         PCL_FFTPlan<complex> fft( m_engine.m_rows, true/*inverse*/ );
+         fft.TransformColumns( m_engine.m_colTransform[0], m_engine.m_input, m_engine.m_rows, m_engine.m_transformCols, m_firstCol, m_endCol );
       }
 
    private:
@@ -465,7 +595,7 @@ private:
 
    friend class RowThread;
 
-   class RowThread : public Thread, public FFT1DBase
+   class RowThread : public Thread
    {
    public:
 
@@ -476,10 +606,9 @@ private:
 
       void Run() override
       {
-         void* h = this->CreateInv( m_engine.m_cols, (scalar*)0 );
+         PCL_FFTPlan<scalar> fft( m_engine.m_cols, true/*inverse*/ );
          for ( int i = m_firstRow; i < m_endRow; ++i )
-            this->Transform( h, m_engine.m_output + i*m_engine.m_cols, m_engine.m_colTransform[i] );
-         this->Destroy( h );
+            fft( m_engine.m_output + i*m_engine.m_cols, m_engine.m_colTransform[i] );
       }
 
    private:
@@ -0,0 +1,897 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/FileDataCache.cpp - Released 2019-01-21T12:06:21Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#include <pcl/FileDataCache.h>
+
+#include <pcl/AutoPointer.h>
+#include <pcl/FileInfo.h>
+#include <pcl/Math.h>
+#include <pcl/Settings.h>
+
+#include <time.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Persistent cache log file.
+ *
+ * The log begins with a 16-byte header: an 8-byte signature followed by a
+ * 32-bit version number and 4 reserved bytes. The rest of the file is a
+ * sequence of variable-length records, each of them formed by a 32-bit length
+ * and a 32-bit checksum of the record payload, followed by the payload. A
+ * payload is a fixed-size LogRecord structure followed by the UTF-8 encoded
+ * file path and item data.
+ *
+ * Records are only appended to the log. An item record supersedes any
+ * previous record for the same path; a removal record deletes it. The log is
+ * rewritten from scratch when it accumulates too many superseded records.
+ */
+
+static const char*  s_logSignature = "PIFDCLOG";
+static const uint32 s_logVersion   = 1;
+
+#define LOG_HEADER_SIZE          16
+#define LOG_RECORD_HEADER_SIZE    8
+
+enum { ItemRecord = 1, RemovalRecord = 2 };
+
+struct LogRecord
+{
+   uint8  type;
+   uint8  reserved[ 3 ];
+   uint32 lastUsed;    // JD.0
+   uint32 timeJD;      // JD.0 of file time
+   uint32 timeMs;      // milliseconds elapsed since 0h UTC
+   int64  size;        // file size in bytes
+   uint64 fingerprint; // file contents fingerprint
+   uint32 pathLength;  // length of the UTF-8 path in bytes
+   uint32 dataLength;  // length of the UTF-8 data in bytes
+};
+
+static void AppendLogRecord( ByteArray& log, const LogRecord& record, const IsoString& path, const IsoString& data )
+{
+   size_type payloadLength = sizeof( LogRecord ) + path.Length() + data.Length();
+   size_type start = log.Length();
+   log.Add( uint8( 0 ), LOG_RECORD_HEADER_SIZE + payloadLength );
+   uint8* payload = log.At( start + LOG_RECORD_HEADER_SIZE );
+   ::memcpy( payload, &record, sizeof( LogRecord ) );
+   if ( !path.IsEmpty() )
+      ::memcpy( payload + sizeof( LogRecord ), path.Begin(), path.Length() );
+   if ( !data.IsEmpty() )
+      ::memcpy( payload + sizeof( LogRecord ) + path.Length(), data.Begin(), data.Length() );
+   uint32 header[ 2 ] = { uint32( payloadLength ), Hash32( payload, payloadLength ) };
+   ::memcpy( log.At( start ), header, LOG_RECORD_HEADER_SIZE );
+}
+
+static void AppendRemovalRecord( ByteArray& log, const String& path )
+{
+   LogRecord record;
+   ::memset( &record, 0, sizeof( LogRecord ) );
+   IsoString path8 = path.ToUTF8();
+   record.type = RemovalRecord;
+   record.pathLength = uint32( path8.Length() );
+   AppendLogRecord( log, record, path8, IsoString() );
+}
+
+static String LogPath( const LogRecord& record, const uint8* payload )
+{
+   return String::UTF8ToUTF16( reinterpret_cast<const char*>( payload + sizeof( LogRecord ) ), 0, record.pathLength );
+}
+
+static uint32 CurrentJD()
+{
+   time_t t0 = ::time( 0 );
+   const tm* t = ::gmtime( &t0 );
+   return uint32( ComplexTimeToJD( t->tm_year+1900, t->tm_mon+1, t->tm_mday ) );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Scoped read and write locks on the cache's ReadWriteMutex. Lookups only
+ * take read locks, so concurrent readers never block each other.
+ */
+
+class FileDataCacheReadLock
+{
+public:
+
+   FileDataCacheReadLock( ReadWriteMutex& mutex ) : m_mutex( mutex )
+   {
+      m_mutex.LockForRead();
+   }
+
+   ~FileDataCacheReadLock()
+   {
+      m_mutex.Unlock();
+   }
+
+private:
+
+   ReadWriteMutex& m_mutex;
+};
+
+class FileDataCacheWriteLock
+{
+public:
+
+   FileDataCacheWriteLock( ReadWriteMutex& mutex ) : m_mutex( mutex )
+   {
+      m_mutex.LockForWrite();
+   }
+
+   ~FileDataCacheWriteLock()
+   {
+      m_mutex.Unlock();
+   }
+
+private:
+
+   ReadWriteMutex& m_mutex;
+};
+
+// ----------------------------------------------------------------------------
+
+bool FileDataCache::IsEmpty() const
+{
+   volatile FileDataCacheReadLock lock( m_mutex );
+   return m_cache.IsEmpty();
+}
+
+// ----------------------------------------------------------------------------
+
+const FileDataCacheItem* FileDataCache::Find( const String& path ) const
+{
+   volatile FileDataCacheReadLock lock( m_mutex );
+   cache_index::const_iterator i = m_cache.Search( FileDataCacheItem( path ) );
+   return (i == m_cache.End()) ? nullptr : &*i;
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::Clear()
+{
+   volatile FileDataCacheWriteLock lock( m_mutex );
+   DestroyItems();
+   m_removed.Clear();
+   m_rewrite = true;
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::Add( const FileDataCacheItem& item )
+{
+   FileInfo info( item.path );
+   if ( !info.Exists() || !info.IsFile() )
+      throw Error( "FileDataCache::Add(): No such file: " + item.path );
+
+   uint64 fingerprint = FileDataCacheItem::Fingerprint( item.path, info.Size() );
+
+   {
+      volatile FileDataCacheWriteLock lock( m_mutex );
+
+      FileDataCacheItem* newItem;
+      cache_index::const_iterator i = m_cache.Search( item );
+      if ( i == m_cache.End() )
+         newItem = AddItem( item.path );
+      else
+      {
+         newItem = m_cache.MutableIterator( i );
+         m_fingerprints.Remove( FingerprintIndexItem{ newItem->fingerprint, newItem } );
+      }
+
+      newItem->lastUsed = CurrentJD();
+      newItem->time = info.LastModified();
+      newItem->size = info.Size();
+      newItem->fingerprint = fingerprint;
+      newItem->AssignData( item );
+      newItem->modified = true;
+      m_fingerprints << FingerprintIndexItem{ fingerprint, newItem };
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+bool FileDataCache::Get( FileDataCacheItem& item, const String& path )
+{
+   FileInfo info( path );
+   if ( !info.Exists() || !info.IsFile() )
+   {
+      {
+         volatile FileDataCacheWriteLock lock( m_mutex );
+         cache_index::const_iterator i = m_cache.Search( FileDataCacheItem( path ) );
+         if ( i != m_cache.End() )
+         {
+            DestroyItem( i );
+            m_removed << path;
+         }
+      }
+
+      throw Error( "FileDataCache::Get(): No such file: " + path );
+   }
+
+   /*
+    * Fast path: the file has not been modified since it was cached. Items
+    * migrated from the old settings-based storage have no fingerprint, hence
+    * only their file times can be checked.
+    */
+   {
+      volatile FileDataCacheReadLock lock( m_mutex );
+      cache_index::const_iterator i = m_cache.Search( FileDataCacheItem( path ) );
+      if ( i != m_cache.End() )
+         if ( !i->ModifiedSince( info.LastModified() ) )
+            if ( i->fingerprint == 0 || i->size == info.Size() )
+            {
+               item.Assign( *i );
+               item.AssignData( *i );
+               return true;
+            }
+   }
+
+   /*
+    * Slow path: the file is either unknown or has been modified, moved or
+    * copied. Look for an item with the same file contents.
+    */
+   uint64 fingerprint = 0;
+   try
+   {
+      fingerprint = FileDataCacheItem::Fingerprint( path, info.Size() );
+   }
+   catch ( ... )
+   {
+   }
+
+   {
+      volatile FileDataCacheWriteLock lock( m_mutex );
+
+      cache_index::const_iterator i = m_cache.Search( FileDataCacheItem( path ) );
+
+      const FileDataCacheItem* source = nullptr;
+      if ( fingerprint != 0 )
+         for ( fingerprint_index::const_iterator j = pcl::InsertionPoint( m_fingerprints.Begin(), m_fingerprints.End(),
+                                                                          FingerprintIndexItem{ fingerprint, nullptr } );
+               j != m_fingerprints.End() && j->fingerprint == fingerprint;
+               ++j )
+            if ( j->item->size == info.Size() )
+            {
+               source = j->item;
+               break;
+            }
+
+      if ( source == nullptr )
+      {
+         if ( i != m_cache.End() )
+         {
+            DestroyItem( i );
+            m_removed << path;
+         }
+         return false;
+      }
+
+      FileDataCacheItem* target;
+      if ( i == m_cache.End() )
+      {
+         target = AddItem( path );
+         target->lastUsed = source->lastUsed;
+         target->AssignData( *source );
+      }
+      else
+      {
+         target = m_cache.MutableIterator( i );
+         m_fingerprints.Remove( FingerprintIndexItem{ target->fingerprint, target } );
+         if ( target != source )
+            target->AssignData( *source );
+      }
+
+      target->time = info.LastModified();
+      target->size = info.Size();
+      target->fingerprint = fingerprint;
+      target->modified = true;
+      m_fingerprints << FingerprintIndexItem{ fingerprint, target };
+
+      item.Assign( *target );
+      item.AssignData( *target );
+      return true;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::Load()
+{
+   DestroyItems();
+   m_removed.Clear();
+   m_logRecords = 0;
+   m_rewrite = false;
+
+   m_durationDays = 30;
+   Settings::Read( m_keyPrefix + "Duration", m_durationDays );
+   m_durationDays = Max( 0, m_durationDays );
+
+   m_enabled = true;
+   Settings::Read( m_keyPrefix + "Enabled", m_enabled );
+
+   if ( !IsEnabled() )
+      return;
+
+   String filePath = CacheFilePath();
+   if ( !File::Exists( filePath ) )
+   {
+      /*
+       * No persistent log yet: migrate items stored by previous versions as
+       * settings keys, if any.
+       */
+      LoadSettingsItems();
+      return;
+   }
+
+   ByteArray log;
+   try
+   {
+      log = File::ReadFile( filePath );
+   }
+   catch ( ... )
+   {
+      m_rewrite = true;
+      return;
+   }
+
+   if ( log.Length() < LOG_HEADER_SIZE
+     || ::memcmp( log.Begin(), s_logSignature, 8 ) != 0
+     || *reinterpret_cast<const uint32*>( log.At( 8 ) ) != s_logVersion )
+   {
+      m_rewrite = true;
+      return;
+   }
+
+   /*
+    * Read all log records in a single pass. Records are stored in log order;
+    * removals are represented by null item pointers.
+    */
+   Array<FileDataCacheItem*> items;
+   StringList paths;
+   try
+   {
+      for ( const uint8* p = log.At( LOG_HEADER_SIZE ), * end = log.End(); p < end; )
+      {
+         uint32 header[ 2 ];
+         if ( end - p < LOG_RECORD_HEADER_SIZE )
+         {
+            m_rewrite = true;
+            break;
+         }
+         ::memcpy( header, p, LOG_RECORD_HEADER_SIZE );
+         p += LOG_RECORD_HEADER_SIZE;
+
+         /*
+          * A truncated or corrupted record can only be caused by an
+          * interrupted write. Ignore the rest of the log and rewrite it.
+          */
+         if ( header[0] < sizeof( LogRecord ) || size_type( end - p ) < header[0] || Hash32( p, header[0] ) != header[1] )
+         {
+            m_rewrite = true;
+            break;
+         }
+
+         LogRecord record;
+         ::memcpy( &record, p, sizeof( LogRecord ) );
+         if ( record.type == ItemRecord )
+         {
+            AutoPointer<FileDataCacheItem> item( NewItem() );
+            if ( item->Deserialize( p, header[0] ) )
+            {
+               paths << item->path;
+               items << item.Release();
+            }
+         }
+         else if ( record.type == RemovalRecord )
+         {
+            if ( sizeof( LogRecord ) + size_type( record.pathLength ) <= header[0] )
+            {
+               paths << LogPath( record, p );
+               items << nullptr;
+            }
+         }
+
+         p += header[0];
+         ++m_logRecords;
+      }
+
+      /*
+       * Resolve superseded and removed items. Sort record indices by path,
+       * preserving log order for equal paths, and keep the last record of
+       * each path.
+       */
+      Array<size_type> order( items.Length() );
+      for ( size_type i = 0; i < order.Length(); ++i )
+         order[i] = i;
+      pcl::Sort( order.Begin(), order.End(),
+                 [&paths]( size_type a, size_type b )
+                 {
+                    if ( paths[a] != paths[b] )
+                       return paths[a] < paths[b];
+                    return a < b;
+                 } );
+
+      for ( size_type k = 0; k < order.Length(); ++k )
+      {
+         size_type i = order[k];
+         if ( k+1 < order.Length() )
+            if ( paths[order[k+1]] == paths[i] )
+               continue;
+
+         FileDataCacheItem* item = items[i];
+         if ( item != nullptr )
+            if ( m_durationDays <= 0 || item->DaysSinceLastUsed() <= unsigned( m_durationDays ) )
+            {
+               m_cache << item;
+               if ( item->fingerprint != 0 )
+                  m_fingerprints << FingerprintIndexItem{ item->fingerprint, item };
+               items[i] = nullptr;
+            }
+      }
+
+      for ( FileDataCacheItem* item : items )
+         delete item;
+   }
+   catch ( ... )
+   {
+      for ( FileDataCacheItem* item : items )
+         delete item;
+      DestroyItems();
+      m_rewrite = true;
+      throw Error( "FileDataCache::Load(): Corrupted cache data" );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::Save() const
+{
+   if ( IsEnabled() )
+   {
+      {
+         volatile FileDataCacheWriteLock lock( m_mutex );
+         WriteLog( m_rewrite || m_logRecords > 2*m_cache.Length() + 1024 );
+      }
+
+      // Remove any cache items stored by previous versions.
+      PurgeSettings();
+   }
+
+   // Make sure this is done _after_ PurgeSettings()
+   Settings::Write( m_keyPrefix + "Duration", Duration() );
+   Settings::Write( m_keyPrefix + "Enabled", IsEnabled() );
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::Purge() const
+{
+   {
+      volatile FileDataCacheWriteLock lock( m_mutex );
+      String filePath = CacheFilePath();
+      if ( File::Exists( filePath ) )
+         File::Remove( filePath );
+      m_logRecords = 0;
+      m_removed.Clear();
+      m_rewrite = true;
+   }
+
+   PurgeSettings();
+}
+
+// ----------------------------------------------------------------------------
+
+String FileDataCache::CacheFilePath() const
+{
+#ifdef __PCL_MACOSX
+   String dirPath = File::SystemCacheDirectory();
+#else
+# ifdef __PCL_WINDOWS
+   String dirPath = File::HomeDirectory() + "/AppData/Local";
+# else
+   String dirPath = File::HomeDirectory() + "/.cache";
+# endif
+#endif
+   if ( !dirPath.EndsWith( '/' ) )
+      dirPath << '/';
+
+   // "/ImageIntegration/Cache/" -> "ImageIntegration-Cache"
+   IsoString name = m_keyPrefix.Substring( 1, m_keyPrefix.Length()-2 );
+   name.ReplaceChar( '/', '-' );
+
+   return dirPath + "PixInsight/" + String( name ) + ".cache";
+}
+
+// ----------------------------------------------------------------------------
+
+FileDataCacheItem* FileDataCache::AddItem( const String& path )
+{
+   FileDataCacheItem* item = NewItem();
+   item->path = path;
+   m_cache << item;
+   return item;
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::DestroyItem( cache_index::const_iterator i )
+{
+   m_fingerprints.Remove( FingerprintIndexItem{ i->fingerprint, i } );
+   m_cache.Destroy( m_cache.MutableIterator( i ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::DestroyItems()
+{
+   m_fingerprints.Clear();
+   m_cache.Destroy();
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::LoadSettingsItems()
+{
+   try
+   {
+      AutoPointer<FileDataCacheItem> item;
+      for ( int i = 0; ; ++i )
+      {
+         item = NewItem();
+         if ( !item->Load( m_keyPrefix, i ) )
+            break;
+
+         if ( m_durationDays > 0 && item->DaysSinceLastUsed() > unsigned( m_durationDays ) )
+            item.Destroy();
+         else
+         {
+            item->modified = true;
+            m_cache << item.Release();
+         }
+      }
+   }
+   catch ( ... )
+   {
+      DestroyItems();
+      throw Error( "FileDataCache::Load(): Corrupted cache data" );
+   }
+
+   m_rewrite = true;
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::PurgeSettings() const
+{
+   IsoString key = m_keyPrefix;
+   if ( key.EndsWith( '/' ) )
+      key.DeleteRight( key.UpperBound() );
+   Settings::Remove( key );
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCache::WriteLog( bool rewrite ) const
+{
+   String filePath = CacheFilePath();
+   String dirPath = File::ExtractDrive( filePath ) + File::ExtractDirectory( filePath );
+   if ( !File::DirectoryExists( dirPath ) )
+      File::CreateDirectory( dirPath );
+
+   if ( rewrite || !File::Exists( filePath ) )
+   {
+      /*
+       * Write a compacted log to a temporary file, then replace the existing
+       * log, so that an interrupted write cannot destroy the persistent cache.
+       */
+      ByteArray log( size_type( LOG_HEADER_SIZE ), uint8( 0 ) );
+      ::memcpy( log.Begin(), s_logSignature, 8 );
+      ::memcpy( log.At( 8 ), &s_logVersion, sizeof( uint32 ) );
+      for ( const FileDataCacheItem& item : m_cache )
+         item.Serialize( log );
+
+      String tmpFilePath = filePath + ".tmp";
+      File::WriteFile( tmpFilePath, log );
+      if ( File::Exists( filePath ) )
+         File::Remove( filePath );
+      File::Move( tmpFilePath, filePath );
+
+      m_logRecords = m_cache.Length();
+   }
+   else
+   {
+      ByteArray log;
+      size_type count = 0;
+      for ( const String& path : m_removed )
+      {
+         AppendRemovalRecord( log, path );
+         ++count;
+      }
+      for ( const FileDataCacheItem& item : m_cache )
+         if ( item.modified )
+         {
+            item.Serialize( log );
+            ++count;
+         }
+
+      if ( !log.IsEmpty() )
+      {
+         File file;
+         file.OpenOrCreate( filePath );
+         file.SetPosition( file.Size() );
+         file.Write( reinterpret_cast<const void*>( log.Begin() ), fsize_type( log.Length() ) );
+         file.Close();
+      }
+
+      m_logRecords += count;
+   }
+
+   for ( const FileDataCacheItem& item : m_cache )
+      item.modified = false;
+   m_removed.Clear();
+   m_rewrite = false;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned FileDataCacheItem::DaysSinceLastUsed() const
+{
+   return unsigned( CurrentJD() ) - lastUsed;
+}
+
+// ----------------------------------------------------------------------------
+
+uint64 FileDataCacheItem::Fingerprint( const String& path, fsize_type size )
+{
+   /*
+    * Hash the first and last 64 KiB of the file, plus 32 blocks of 4 KiB
+    * evenly distributed over the rest of it. Files smaller than the sampled
+    * area are hashed entirely.
+    */
+   const fsize_type edgeSize = 64*1024;
+   const fsize_type blockSize = 4*1024;
+   const int numberOfBlocks = 32;
+
+   File file = File::OpenFileForReading( path );
+   uint64 hash = Hash64( &size, sizeof( size ), 0x46444331u );
+   ByteArray buffer( size_type( Min( size, 2*edgeSize + numberOfBlocks*blockSize ) ) );
+
+   auto hashBlock = [&]( fsize_type position, fsize_type length )
+   {
+      file.SetPosition( position );
+      file.Read( reinterpret_cast<void*>( buffer.Begin() ), length );
+      hash = Hash64( buffer.Begin(), size_type( length ), hash );
+   };
+
+   if ( size <= 2*edgeSize + numberOfBlocks*blockSize )
+   {
+      if ( size > 0 )
+         hashBlock( 0, size );
+   }
+   else
+   {
+      hashBlock( 0, edgeSize );
+      fsize_type step = (size - 2*edgeSize - blockSize)/(numberOfBlocks - 1);
+      for ( int i = 0; i < numberOfBlocks; ++i )
+         hashBlock( edgeSize + i*step, blockSize );
+      hashBlock( size - edgeSize, edgeSize );
+   }
+
+   file.Close();
+
+   // Zero means 'no fingerprint available'.
+   return (hash != 0) ? hash : 1;
+}
+
+// ----------------------------------------------------------------------------
+
+void FileDataCacheItem::Serialize( ByteArray& log ) const
+{
+   LogRecord record;
+   ::memset( &record, 0, sizeof( LogRecord ) );
+   IsoString path8 = path.ToUTF8();
+   IsoString data8 = DataAsString().ToUTF8();
+   record.type = ItemRecord;
+   record.lastUsed = lastUsed;
+   record.timeJD = uint32( ComplexTimeToJD( time.year, time.month, time.day ) );
+   record.timeMs = uint32( ((time.hour*60 + time.minute)*60 + time.second)*1000 + time.milliseconds );
+   record.size = size;
+   record.fingerprint = fingerprint;
+   record.pathLength = uint32( path8.Length() );
+   record.dataLength = uint32( data8.Length() );
+   AppendLogRecord( log, record, path8, data8 );
+}
+
+// ----------------------------------------------------------------------------
+
+bool FileDataCacheItem::Deserialize( const uint8* payload, size_type length )
+{
+   LogRecord record;
+   ::memcpy( &record, payload, sizeof( LogRecord ) );
+   if ( sizeof( LogRecord ) + size_type( record.pathLength ) + size_type( record.dataLength ) != length )
+      return false;
+
+   path = LogPath( record, payload );
+   lastUsed = record.lastUsed;
+
+   int y, m, d; double f;
+   JDToComplexTime( y, m, d, f, record.timeJD+0.5 );
+   unsigned t = record.timeMs;
+   time.year = y;
+   time.month = m;
+   time.day = d;
+   time.milliseconds = t % 1000;
+   time.second = (t /= 1000) % 60;
+   time.minute = (t /= 60) % 60;
+   time.hour = t / 60;
+
+   size = record.size;
+   fingerprint = record.fingerprint;
+
+   if ( record.dataLength > 0 )
+   {
+      StringList tokens;
+      String::UTF8ToUTF16( reinterpret_cast<const char*>( payload + sizeof( LogRecord ) + record.pathLength ),
+                           0, record.dataLength ).Break( tokens, char16_type( '\n' ) );
+      if ( !GetDataFromTokens( tokens ) )
+         return false;
+   }
+
+   return !path.IsEmpty() && lastUsed > 0 && time.year > 0 && ValidateData();
+}
+
+// ----------------------------------------------------------------------------
+
+String FileDataCacheItem::VectorAsString( const DVector& v )
+{
+   String s = String().Format( "\n%d", v.Length() );
+   for ( int i = 0; i < v.Length(); ++i )
+      s.AppendFormat( "\n%.8e", v[i] );
+   return s;
+}
+
+// ----------------------------------------------------------------------------
+
+bool FileDataCacheItem::GetVector( DVector& v, StringList::const_iterator& i, const StringList& s )
+{
+   if ( i == s.End() )
+      return false;
+   int n = i->ToInt();
+   if ( n < 0 || s.End() - i <= n )
+      return false;
+   ++i;
+   v = DVector( n );
+   for ( int j = 0; j < n; ++j, ++i )
+      v[j] = i->ToDouble();
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool FileDataCacheItem::FromString( const String& s )
+{
+   path.Clear();
+   lastUsed = 0;
+   time.year = 0;
+
+   StringList tokens;
+   s.Break( tokens, char16_type( '\n' ) );
+
+   for ( StringList::const_iterator i = tokens.Begin(); i != tokens.End(); )
+   {
+      if ( *i == "path" )
+      {
+         if ( ++i == tokens.End() )
+            return false;
+         path = i->Trimmed();
+         ++i;
+      }
+      else if ( *i == "lastUsed" )
+      {
+         if ( ++i == tokens.End() )
+            return false;
+         lastUsed = i->ToUInt();
+         ++i;
+      }
+      else if ( *i == "time" )
+      {
+         if ( tokens.End() - i < 3 )
+            return false;
+         int y, m, d; double f;
+         JDToComplexTime( y, m, d, f, i[1].ToUInt()+0.5 );
+         unsigned t = i[2].ToUInt();
+         time.year = y;
+         time.month = m;
+         time.day = d;
+         time.milliseconds = t - 86399000;
+         time.hour = TruncI( (t = TruncI( t/1000.0 ))/3600.0 );
+         time.minute = TruncI( (t -= time.hour*3600)/60.0 );
+         time.second = t - time.minute*60;
+         i += 3;
+      }
+      else if ( *i == "data" )
+      {
+         if ( !GetDataFromTokens( tokens ) )
+            return false;
+         ++i;
+      }
+      else
+      {
+         ++i;
+      }
+   }
+
+   return !path.IsEmpty() && lastUsed > 0 && time.year > 0 && ValidateData();
+}
+
+// ----------------------------------------------------------------------------
+
+bool FileDataCacheItem::Load( const IsoString& keyPrefix, int index )
+{
+   String s;
+   if ( !Settings::Read( keyPrefix + IsoString().Format( "%08d", index+1 ), s ) )
+      return false;
+   if ( s.IsEmpty() || !FromString( s ) )
+      throw CaughtException();
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
+// EOF pcl/FileDataCache.cpp - Released 2019-01-21T12:06:21Z
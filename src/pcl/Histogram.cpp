@@ -51,6 +51,9 @@
 
 #include <pcl/Histogram.h>
 #include <pcl/Thread.h>
+#include <pcl/ThreadPool.h>
+
+#include <float.h> // DBL_MAX
 
 namespace pcl
 {
@@ -92,39 +95,41 @@ public:
       if ( image->Status().IsInitializationEnabled() )
          image->Status().Initialize( "Histogram generation", N );
 
+      /*
+       * Rows are split into one stripe per thread (the calling thread
+       * included). Each stripe accumulates partial results in its own slot,
+       * indexed by stripe, which are combined once all threads have finished.
+       */
       int numberOfThreads = parallel ? Min( maxProcessors, Thread::NumberOfThreads( height, Max( 1, 1024/width ) ) ) : 1;
-      int rowsPerThread = height/numberOfThreads;
-      bool useAffinity = parallel && Thread::IsRootThread();
+      size_type numberOfSlots = size_type( numberOfThreads );
+      auto stripeStart = [=]( size_type i ) { return int( (i*size_type( height ))/numberOfSlots ); };
 
       double min = 0, max = 1;
       if ( image.IsFloatSample() )
       {
-         ReferenceArray<RealMinMaxThread> threads;
-         for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
-            threads.Add( new RealMinMaxThread( image, r, channel, i*rowsPerThread, (j < numberOfThreads) ? j*rowsPerThread : height ) );
-
-         if ( numberOfThreads > 1 )
-         {
-            for ( int i = 0; i < numberOfThreads; ++i )
-               threads[i].Start( ThreadPriority::DefaultMax, useAffinity ? i : -1 );
-            for ( int i = 0; i < numberOfThreads; ++i )
-               threads[i].Wait();
-         }
-         else
-            threads[0].Run();
-
-         min = threads[0].min;
-         max = threads[0].max;
-         for ( int i = 1; i < numberOfThreads; ++i )
+         Array<double> mins( numberOfSlots, DBL_MAX );
+         Array<double> maxs( numberOfSlots, -DBL_MAX );
+         ThreadPool::ParallelFor( 0, numberOfSlots,
+            [&]( size_type i0, size_type i1 )
+            {
+               for ( size_type i = i0; i < i1; ++i )
+                  switch ( image.BitsPerSample() )
+                  {
+                  case 32: RealMinMax( static_cast<const Image&>( *image ), r, channel, mins[i], maxs[i], stripeStart( i ), stripeStart( i+1 ) ); break;
+                  case 64: RealMinMax( static_cast<const DImage&>( *image ), r, channel, mins[i], maxs[i], stripeStart( i ), stripeStart( i+1 ) ); break;
+                  }
+            }, 1, numberOfThreads );
+
+         min = DBL_MAX;
+         max = -DBL_MAX;
+         for ( size_type i = 0; i < numberOfSlots; ++i )
          {
-            if ( threads[i].min < min )
-               min = threads[i].min;
-            if ( max < threads[i].max )
-               max = threads[i].max;
+            if ( mins[i] < min )
+               min = mins[i];
+            if ( max < maxs[i] )
+               max = maxs[i];
          }
 
-         threads.Destroy();
-
          if ( 1 + (max - min) == 1 )
          {
             image->Status() += N1 + N2;
@@ -134,161 +139,102 @@ public:
 
       image->Status() += N1;
 
-      ReferenceArray<HistogramThread> threads;
-      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
-         threads.Add( new HistogramThread( image, r, channel, histogram.Length(), min, max,
-                                           i*rowsPerThread, (j < numberOfThreads) ? j*rowsPerThread : height ) );
-      if ( numberOfThreads > 1 )
-      {
-         for ( int i = 0; i < numberOfThreads; ++i )
-            threads[i].Start( ThreadPriority::DefaultMax, useAffinity ? i : -1 );
-         for ( int i = 0; i < numberOfThreads; ++i )
-            threads[i].Wait();
-      }
-      else
-         threads[0].Run();
-
-      for ( int i = 0; i < numberOfThreads; ++i )
-         histogram += threads[i].histogram;
+      Array<Histogram::histogram_type> histograms( numberOfSlots );
+      ThreadPool::ParallelFor( 0, numberOfSlots,
+         [&]( size_type i0, size_type i1 )
+         {
+            for ( size_type i = i0; i < i1; ++i )
+            {
+               Histogram::histogram_type& H = histograms[i];
+               H = Histogram::histogram_type( 0, histogram.Length() );
+               int y0 = stripeStart( i );
+               int y1 = stripeStart( i+1 );
+               if ( image.IsFloatSample() )
+                  switch ( image.BitsPerSample() )
+                  {
+                  case 32: RealHistogram( static_cast<const Image&>( *image ), r, channel, H, min, max, y0, y1 );
+                     break;
+                  case 64: RealHistogram( static_cast<const DImage&>( *image ), r, channel, H, min, max, y0, y1 );
+                     break;
+                  }
+               else
+                  switch ( image.BitsPerSample() )
+                  {
+                  case  8: IntegerHistogram( static_cast<const UInt8Image&>( *image ), r, channel, H, y0, y1 );
+                     break;
+                  case 16: IntegerHistogram( static_cast<const UInt16Image&>( *image ), r, channel, H, y0, y1 );
+                     break;
+                  case 32: IntegerHistogram( static_cast<const UInt32Image&>( *image ), r, channel, H, y0, y1 );
+                     break;
+                  }
+            }
+         }, 1, numberOfThreads );
 
-      threads.Destroy();
+      for ( const Histogram::histogram_type& H : histograms )
+         histogram += H;
 
       image->Status() += N2;
    }
 
 private:
 
-   class RealMinMaxThread : public Thread
+   template <class P> static
+   void RealMinMax( const GenericImage<P>& image, const Rect& r, int c, double& min, double& max, int y0, int y1 )
    {
-   public:
-
-      double min, max;
-
-      RealMinMaxThread( const ImageVariant& image, const Rect& rect, int channel, int startRow, int endRow ) :
-         m_image( image ), m_rect( rect ), m_channel( channel ), m_startRow( startRow ), m_endRow( endRow )
-      {
-      }
-
-      void Run() override
-      {
-         if ( m_image.IsFloatSample() )
-            switch ( m_image.BitsPerSample() )
-            {
-            case 32 : RealMinMax( static_cast<const Image&>( *m_image ), m_rect, m_channel, min, max, m_startRow, m_endRow ); break;
-            case 64 : RealMinMax( static_cast<const DImage&>( *m_image ), m_rect, m_channel, min, max, m_startRow, m_endRow ); break;
-            }
-      }
-
-   private:
-
-      const ImageVariant& m_image;
-      const Rect&         m_rect;
-            int           m_channel;
-            int           m_startRow, m_endRow;
-
-      template <class P> static
-      void RealMinMax( const GenericImage<P>& image, const Rect& r, int c, double& min, double& max, int y0, int y1 )
+      int w = r.Width();
+      for ( int y = r.y0+y0, y01 = r.y0+y1; y < y01; ++y )
       {
-         int w = r.Width();
-         min = max = image( r.LeftTop(), c );
-         for ( int y = r.y0+y0, y01 = r.y0+y1; y < y01; ++y )
+         const typename P::sample* f  = image.ScanLine( y, c ) + r.x0;
+         const typename P::sample* fw = f + w;
+         do
          {
-            const typename P::sample* f  = image.ScanLine( y, c ) + r.x0;
-            const typename P::sample* fw = f + w;
-            do
-            {
-               if ( *f < min )
-                  min = *f;
-               else if ( max < *f )
-                  max = *f;
-            }
-            while ( ++f < fw );
+            if ( *f < min )
+               min = *f;
+            if ( max < *f )
+               max = *f;
          }
+         while ( ++f < fw );
       }
-   };
+   }
 
-   class HistogramThread : public Thread
+   template <class P> static
+   void IntegerHistogram( const GenericImage<P>& image,
+                          const Rect& r, int c, Histogram::histogram_type& histogram, int y0, int y1 )
    {
-   public:
-
-      Histogram::histogram_type histogram;
-
-      HistogramThread( const ImageVariant& image, const Rect& rect, int channel,
-                       int resolution, double min, double max, int startRow, int endRow ) :
-         histogram( 0, resolution ), m_image( image ), m_rect( rect ), m_channel( channel ),
-         m_min( min ), m_max( max ), m_startRow( startRow ), m_endRow( endRow )
+      if ( size_type( P::MaxSampleValue() ) == size_type( histogram.Length()-1 ) )
       {
+         // The image and the histogram use the same sample range (e.g. UInt16Image and a 16-bit histogram).
+         for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
+            ++histogram[int( *i )];
       }
-
-      void Run() override
+      else
       {
-         if ( m_image.IsFloatSample() )
-            switch ( m_image.BitsPerSample() )
-            {
-            case 32: RealHistogram( static_cast<const Image&>( *m_image ), m_rect, m_channel, histogram, m_min, m_max, m_startRow, m_endRow );
-               break;
-            case 64: RealHistogram( static_cast<const DImage&>( *m_image ), m_rect, m_channel, histogram, m_min, m_max, m_startRow, m_endRow );
-               break;
-            }
-         else
-            switch ( m_image.BitsPerSample() )
-            {
-            case  8: IntegerHistogram( static_cast<const UInt8Image&>( *m_image ), m_rect, m_channel, histogram, m_startRow, m_endRow );
-               break;
-            case 16: IntegerHistogram( static_cast<const UInt16Image&>( *m_image ), m_rect, m_channel, histogram, m_startRow, m_endRow );
-               break;
-            case 32: IntegerHistogram( static_cast<const UInt32Image&>( *m_image ), m_rect, m_channel, histogram, m_startRow, m_endRow );
-               break;
-            }
+         // The image and the histogram use different sample ranges.
+         double k = double( histogram.Length()-1 )/P::MaxSampleValue();
+         for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
+            ++histogram[pcl::RoundInt( *i * k )];
       }
+   }
 
-   private:
-
-      const ImageVariant& m_image;
-      const Rect&         m_rect;
-            int           m_channel;
-            double        m_min, m_max;
-            int           m_startRow, m_endRow;
-
-      template <class P> static
-      void IntegerHistogram( const GenericImage<P>& image,
-                             const Rect& r, int c, Histogram::histogram_type& histogram, int y0, int y1 )
+   template <class P> static
+   void RealHistogram( const GenericImage<P>& image,
+                       const Rect& r, int c, Histogram::histogram_type& histogram, double min, double max, int y0, int y1 )
+   {
+      if ( min >= 0 && min <= 1 && max >= 0 && max <= 1 )
       {
-         if ( size_type( P::MaxSampleValue() ) == size_type( histogram.Length()-1 ) )
-         {
-            // The image and the histogram use the same sample range (e.g. UInt16Image and a 16-bit histogram).
-            for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
-               ++histogram[int( *i )];
-         }
-         else
-         {
-            // The image and the histogram use different sample ranges.
-            double k = double( histogram.Length()-1 )/P::MaxSampleValue();
-            for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
-               ++histogram[pcl::RoundInt( *i * k )];
-         }
+         // Normalized real image.
+         int k = histogram.Length() - 1;
+         for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
+            ++histogram[pcl::RoundInt( *i * k )];
       }
-
-      template <class P> static
-      void RealHistogram( const GenericImage<P>& image,
-                          const Rect& r, int c, Histogram::histogram_type& histogram, double min, double max, int y0, int y1 )
+      else
       {
-         if ( min >= 0 && min <= 1 && max >= 0 && max <= 1 )
-         {
-            // Normalized real image.
-            int k = histogram.Length() - 1;
-            for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
-               ++histogram[pcl::RoundInt( *i * k )];
-         }
-         else
-         {
-            // Unnormalized real image.
-            double k = (histogram.Length() - 1)/(max - min);
-            for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
-               ++histogram[pcl::RoundInt( k*(*i - min) )];
-         }
+         // Unnormalized real image.
+         double k = (histogram.Length() - 1)/(max - min);
+         for ( typename GenericImage<P>::const_roi_sample_iterator i( image, Rect( r.x0, r.y0+y0, r.x1, r.y0+y1 ), c ); i; ++i )
+            ++histogram[pcl::RoundInt( k*(*i - min) )];
       }
-   };
+   }
 };
 
 // ----------------------------------------------------------------------------
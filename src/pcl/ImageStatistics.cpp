@@ -50,8 +50,7 @@
 // ----------------------------------------------------------------------------
 
 #include <pcl/ImageStatistics.h>
-#include <pcl/Matrix.h>
-#include <pcl/Selection.h>
+#include <pcl/ParallelSelection.h>
 
 namespace pcl
 {
@@ -63,7 +62,7 @@ class PCL_ImageStatisticsEngine
 public:
 
    template <class P> static
-   void Compute( const GenericImage<P>& image, ImageStatistics::Data& data, bool /*parallel*/, int /*maxProcessors*/ )
+   void Compute( const GenericImage<P>& image, ImageStatistics::Data& data, bool parallel, int maxProcessors )
    {
       data.AssignStatisticalData( ImageStatistics::Data() );
 
@@ -83,319 +82,302 @@ public:
       data.minimum = data.maximum = 0;
       data.minPos = data.maxPos = Point( 0 );
 
-      if ( data.rejectLow || data.rejectHigh )
+      /*
+       * All statistics are computed in parallel directly from pixel samples.
+       * Order statistics (median, MAD, PBMV) are selected without copying
+       * samples; see ParallelSampleSelection.
+       */
+      RejectionFilter<P> filter;
+      filter.rejectLow = data.rejectLow;
+      filter.rejectHigh = data.rejectHigh;
+      // Rejection bounds in the native range
+      if ( data.rejectLow )
+         filter.low = P::MinSampleValue() + data.low*(P::MaxSampleValue() - P::MinSampleValue());
+      if ( data.rejectHigh )
+         filter.high = P::MinSampleValue() + data.high*(P::MaxSampleValue() - P::MinSampleValue());
+
+      Array<const typename P::sample*> channels;
+      channels << image[channel];
+
+      int numberOfThreads = parallel ? Min( maxProcessors,
+                                            Thread::NumberOfThreads( rect.Height(),
+                                                                     Max( 1, 1024/Max( 1, rect.Width() ) ) ) ) : 1;
+
+      ParallelSampleSelection<P, RejectionFilter<P> > S( channels, image.Width(), rect, filter, numberOfThreads );
+
+      MomentsAccumulator M;
+      M = S.Accumulate( M );
+
+      size_type n = data.count = M.count;
+      if ( n == 0 )
       {
-         // Rejection bounds in the native range
-         double s0 = 0, s1 = 0;
-         if ( data.rejectLow )
-            s0 = P::MinSampleValue() + data.low*(P::MaxSampleValue() - P::MinSampleValue());
-         if ( data.rejectHigh )
-            s1 = P::MinSampleValue() + data.high*(P::MaxSampleValue() - P::MinSampleValue());
+         image.Status() += N;
+         return;
+      }
 
-         Array<double> v;
-         v.Reserve( N ); // clearly, optimize for speed
+      if ( !data.noExtremes )
+      {
+         data.minimum = M.minimum;
+         data.maximum = M.maximum;
+         data.minPos = M.minPos;
+         data.maxPos = M.maxPos;
+      }
 
-         typename GenericImage<P>::const_roi_sample_iterator i( image, rect, channel );
-         P::FromSample( data.minimum, *i );
-         data.maximum = data.minimum;
+      if ( !data.noSumOfSquares )
+         data.sumOfSquares = M.sumOfSquares;
 
-         if ( data.noExtremes )
-         {
-            if ( data.rejectLow )
-            {
-               if ( data.rejectHigh )
-               {
-                  for ( ; i; ++i )
-                     if ( *i > s0 )
-                        if ( *i < s1 )
-                        {
-                           double f; P::FromSample( f, *i );
-                           v << f;
-                        }
-               }
-               else
-               {
-                  for ( ; i; ++i )
-                     if ( *i > s0 )
-                     {
-                        double f; P::FromSample( f, *i );
-                        v << f;
-                     }
-               }
-            }
-            else
-            {
-               for ( ; i; ++i )
-                  if ( *i < s1 )
-                  {
-                     double f; P::FromSample( f, *i );
-                     v << f;
-                  }
-            }
-         }
-         else // !data.noExtremes
+      image.Status() += NS;
+
+      if ( !data.noMean )
+      {
+         data.mean = M.sum/n;
+
+         image.Status() += NS;
+
+         if ( !data.noVariance )
          {
-            bool extremesSeen = false;
-            if ( data.rejectLow )
-            {
-               if ( data.rejectHigh )
-               {
-                  for ( int y = rect.y0; y < rect.y1; ++y )
-                     for ( int x = rect.x0; x < rect.x1; ++x, ++i )
-                        if ( *i > s0 )
-                           if ( *i < s1 )
-                           {
-                              double f; P::FromSample( f, *i );
-                              v << f;
-
-                              if ( extremesSeen )
-                              {
-                                 if ( f < data.minimum )
-                                 {
-                                    data.minimum = f;
-                                    data.minPos.x = x;
-                                    data.minPos.y = y;
-                                 }
-                                 else if ( f > data.maximum )
-                                 {
-                                    data.maximum = f;
-                                    data.maxPos.x = x;
-                                    data.maxPos.y = y;
-                                 }
-                              }
-                              else
-                              {
-                                 data.minimum = data.maximum = f;
-                                 data.minPos.x = data.maxPos.x = x;
-                                 data.minPos.y = data.maxPos.y = y;
-                                 extremesSeen = true;
-                              }
-                           }
-               }
-               else
-               {
-                  for ( int y = rect.y0; y < rect.y1; ++y )
-                     for ( int x = rect.x0; x < rect.x1; ++x, ++i )
-                        if ( *i > s0 )
-                        {
-                           double f; P::FromSample( f, *i );
-                           v << f;
-
-                           if ( extremesSeen )
-                           {
-                              if ( f < data.minimum )
-                              {
-                                 data.minimum = f;
-                                 data.minPos.x = x;
-                                 data.minPos.y = y;
-                              }
-                              else if ( f > data.maximum )
-                              {
-                                 data.maximum = f;
-                                 data.maxPos.x = x;
-                                 data.maxPos.y = y;
-                              }
-                           }
-                           else
-                           {
-                              data.minimum = data.maximum = f;
-                              data.minPos.x = data.maxPos.x = x;
-                              data.minPos.y = data.maxPos.y = y;
-                              extremesSeen = true;
-                           }
-                        }
-               }
-            }
-            else
+            if ( n > 1 )
             {
-               for ( int y = rect.y0; y < rect.y1; ++y )
-                  for ( int x = rect.x0; x < rect.x1; ++x, ++i )
-                     if ( *i < s1 )
-                     {
-                        double f; P::FromSample( f, *i );
-                        v << f;
-
-                        if ( extremesSeen )
-                        {
-                           if ( f < data.minimum )
-                           {
-                              data.minimum = f;
-                              data.minPos.x = x;
-                              data.minPos.y = y;
-                           }
-                           else if ( f > data.maximum )
-                           {
-                              data.maximum = f;
-                              data.maxPos.x = x;
-                              data.maxPos.y = y;
-                           }
-                        }
-                        else
-                        {
-                           data.minimum = data.maximum = f;
-                           data.minPos.x = data.maxPos.x = x;
-                           data.minPos.y = data.maxPos.y = y;
-                           extremesSeen = true;
-                        }
-                     }
+               VarianceAccumulator V( data.mean );
+               V = S.Accumulate( V );
+               data.variance = (V.var - V.eps*V.eps/n)/(n - 1);
             }
+            data.stdDev = Sqrt( data.variance );
          }
 
-         data.count = v.Length();
+         image.Status() += NS;
+      }
+      else
+      {
+         image.Status() += 2*NS;
+      }
 
-         if ( !data.noSumOfSquares )
-            data.sumOfSquares = pcl::SumOfSquares( v.Begin(), v.End() );
+      if ( !data.noMedian )
+      {
+         data.median = S.Median();
 
          image.Status() += NS;
 
-         if ( !data.noMean )
+         double wb = 0;
+         if ( n > 1 )
          {
-            data.mean = pcl::Mean( v.Begin(), v.End() );
+            S.SetCenter( data.median );
 
-            image.Status() += NS;
-
-            if ( !data.noVariance )
-            {
-               data.variance = pcl::Variance( v.Begin(), v.End(), data.mean );
-               data.stdDev = Sqrt( data.variance );
-            }
+            if ( !data.noMAD )
+               data.MAD = S.Median();
 
-            image.Status() += NS;
-         }
-         else
-         {
-            image.Status() += 2*NS;
-         }
+            if ( !data.noPBMV )
+               wb = S.OrderStatistic( Min( size_type( Floor( (1 - 0.2)*n + 0.5 ) ), n-1 ) );
 
-         if ( !data.noMedian )
-         {
-            data.median = pcl::Median( v.Begin(), v.End() );
+            S.ClearCenter();
 
-            image.Status() += NS;
+            DispersionAccumulator D( data.median, (!data.noMAD && !data.noBWMV) ? 9*data.MAD : 0, wb );
+            D = S.Accumulate( D );
 
             if ( !data.noAvgDev )
-               data.avgDev = pcl::AvgDev( v.Begin(), v.End(), data.median );
-
-            image.Status() += NS;
+               data.avgDev = D.absDev/n;
 
-            if ( !data.noMAD )
+            if ( !data.noMAD && !data.noBWMV )
             {
-               data.MAD = pcl::MAD( v.Begin(), v.End(), data.median );
-
-               if ( !data.noBWMV )
-                  data.bwmv = pcl::BiweightMidvariance( v.Begin(), v.End(), data.median, data.MAD );
+               double den = D.bwmvDen*D.bwmvDen;
+               if ( D.kd > 0 && 1 + D.kd != 1 && 1 + den != 1 )
+                  data.bwmv = n*D.bwmvNum/den;
             }
 
             if ( !data.noPBMV )
-               data.pbmv = pcl::BendMidvariance( v.Begin(), v.End(), data.median, 0.2 );
-
-            image.Status() += NS;
-         }
-         else
-         {
-            image.Status() += 3*NS;
+               if ( 1 + wb != 1 && D.pbmvDen > 0 )
+                  data.pbmv = n*wb*wb*D.pbmvNum/D.pbmvDen/D.pbmvDen;
          }
 
+         image.Status() += 2*NS;
+      }
+      else
+      {
+         image.Status() += 3*NS;
+      }
+
+      if ( !data.noSn || !data.noQn )
+      {
+         // The Sn and Qn estimators require a copy of all selected values.
+         ValuesAccumulator A;
+         A = S.Accumulate( A );
+
          if ( !data.noSn )
-            data.Sn = pcl::Sn( v.Begin(), v.End() );
+            data.Sn = pcl::Sn( A.values.Begin(), A.values.End() );
 
          image.Status() += NS;
 
          if ( !data.noQn )
-            data.Qn = pcl::Qn( v.Begin(), v.End() );
+            data.Qn = pcl::Qn( A.values.Begin(), A.values.End() );
 
          image.Status() += NN;
       }
       else
       {
-         data.count = N;
-
-         DMatrix V( image, rect, channel );
+         image.Status() += NS + NN;
+      }
+   }
 
-         if ( !data.noExtremes )
-         {
-            double* i = V.Begin();
-            data.minimum = data.maximum = *i;
-            for ( int y = rect.y0; y < rect.y1; ++y )
-               for ( int x = rect.x0; x < rect.x1; ++x, ++i )
-                  if ( *i < data.minimum )
-                  {
-                     data.minimum = *i;
-                     data.minPos.x = x;
-                     data.minPos.y = y;
-                  }
-                  else if ( *i > data.maximum )
-                  {
-                     data.maximum = *i;
-                     data.maxPos.x = x;
-                     data.maxPos.y = y;
-                  }
-         }
+private:
 
-         if ( !data.noSumOfSquares )
-            data.sumOfSquares = pcl::SumOfSquares( V.Begin(), V.End() );
+   template <class P>
+   struct RejectionFilter
+   {
+      bool   rejectLow = false;
+      bool   rejectHigh = false;
+      double low = 0;
+      double high = 0;
 
-         image.Status() += NS;
+      bool operator()( const typename P::sample& v ) const
+      {
+         return (!rejectLow || v > low) && (!rejectHigh || v < high);
+      }
+   };
 
-         if ( !data.noMean )
+   struct MomentsAccumulator
+   {
+      size_type count = 0;
+      double    sum = 0;
+      double    sumOfSquares = 0;
+      double    minimum = 0;
+      double    maximum = 0;
+      Point     minPos = 0;
+      Point     maxPos = 0;
+
+      void operator()( double v, int x, int y )
+      {
+         if ( count++ == 0 )
          {
-            data.mean = pcl::Mean( V.Begin(), V.End() );
-
-            image.Status() += NS;
-
-            if ( !data.noVariance )
-            {
-               data.variance = pcl::Variance( V.Begin(), V.End(), data.mean );
-               data.stdDev = Sqrt( data.variance );
-            }
-
-            image.Status() += NS;
+            minimum = maximum = v;
+            minPos.x = maxPos.x = x;
+            minPos.y = maxPos.y = y;
+         }
+         else if ( v < minimum )
+         {
+            minimum = v;
+            minPos.x = x;
+            minPos.y = y;
          }
-         else
+         else if ( v > maximum )
          {
-            image.Status() += 2*NS;
+            maximum = v;
+            maxPos.x = x;
+            maxPos.y = y;
          }
+         sum += v;
+         sumOfSquares += v*v;
+      }
 
-         if ( !data.noMedian )
+      void Combine( const MomentsAccumulator& M )
+      {
+         if ( M.count > 0 )
          {
-            data.median = pcl::Median( V.Begin(), V.End() );
+            if ( count == 0 || M.minimum < minimum )
+            {
+               minimum = M.minimum;
+               minPos = M.minPos;
+            }
+            if ( count == 0 || M.maximum > maximum )
+            {
+               maximum = M.maximum;
+               maxPos = M.maxPos;
+            }
+            count += M.count;
+            sum += M.sum;
+            sumOfSquares += M.sumOfSquares;
+         }
+      }
+   };
 
-            image.Status() += NS;
+   struct VarianceAccumulator
+   {
+      double mean;
+      double var = 0;
+      double eps = 0;
 
-            if ( !data.noAvgDev )
-               data.avgDev = pcl::AvgDev( V.Begin(), V.End(), data.median );
+      VarianceAccumulator( double m ) : mean( m )
+      {
+      }
 
-            image.Status() += NS;
+      void operator()( double v, int, int )
+      {
+         double d = v - mean;
+         var += d*d;
+         eps += d;
+      }
 
-            if ( !data.noMAD )
-            {
-               data.MAD = pcl::MAD( V.Begin(), V.End(), data.median );
+      void Combine( const VarianceAccumulator& V )
+      {
+         var += V.var;
+         eps += V.eps;
+      }
+   };
 
-               if ( !data.noBWMV )
-                  data.bwmv = pcl::BiweightMidvariance( V.Begin(), V.End(), data.median, data.MAD );
-            }
+   struct DispersionAccumulator
+   {
+      double center;
+      double kd;      // biweight rejection limit, 9*MAD
+      double wb;      // percentage bend quantile
+      double absDev = 0;
+      double bwmvNum = 0, bwmvDen = 0;
+      double pbmvNum = 0;
+      size_type pbmvDen = 0;
+
+      DispersionAccumulator( double c, double k, double w ) : center( c ), kd( k ), wb( w )
+      {
+      }
 
-            if ( !data.noPBMV )
-               data.pbmv = pcl::BendMidvariance( V.Begin(), V.End(), data.median, 0.2 );
+      void operator()( double v, int, int )
+      {
+         double xc = v - center;
+         absDev += Abs( xc );
 
-            image.Status() += NS;
+         if ( kd > 0 )
+         {
+            double y = xc/kd;
+            if ( Abs( y ) < 1 )
+            {
+               double y2 = y*y;
+               double y21 = 1 - y2;
+               bwmvNum += xc*xc * y21*y21*y21*y21;
+               bwmvDen += y21 * (1 - 5*y2);
+            }
          }
-         else
+
+         if ( wb > 0 )
          {
-            image.Status() += 3*NS;
+            double y = xc/wb;
+            double f = Max( -1.0, Min( 1.0, y ) );
+            pbmvNum += f*f;
+            if ( Abs( y ) < 1 )
+               ++pbmvDen;
          }
+      }
 
-         if ( !data.noSn )
-            data.Sn = pcl::Sn( V.Begin(), V.End() );
+      void Combine( const DispersionAccumulator& D )
+      {
+         absDev += D.absDev;
+         bwmvNum += D.bwmvNum;
+         bwmvDen += D.bwmvDen;
+         pbmvNum += D.pbmvNum;
+         pbmvDen += D.pbmvDen;
+      }
+   };
 
-         image.Status() += NS;
+   struct ValuesAccumulator
+   {
+      Array<double> values;
 
-         if ( !data.noQn )
-            data.Qn = pcl::Qn( V.Begin(), V.End() );
+      void operator()( double v, int, int )
+      {
+         values << v;
+      }
 
-         image.Status() += NN;
+      void Combine( const ValuesAccumulator& A )
+      {
+         values.Add( A.values );
       }
-   }
+   };
 };
 
 // ----------------------------------------------------------------------------
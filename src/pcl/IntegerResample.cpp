@@ -50,7 +50,9 @@
 // ----------------------------------------------------------------------------
 
 #include <pcl/IntegerResample.h>
+#include <pcl/ReferenceArray.h>
 #include <pcl/Selection.h>
+#include <pcl/Thread.h>
 
 // ----------------------------------------------------------------------------
 
@@ -100,14 +102,16 @@ public:
       typename P::sample** f0 = 0;
 
       int n = image.NumberOfChannels();
-      size_type N = image.NumberOfPixels();
       typename GenericImage<P>::color_space cs0 = image.ColorSpace();
 
       StatusMonitor status = image.Status();
 
       int z = pcl::Abs( Z.ZoomFactor() );
-      int z2 = z*z;
-      int n2 = z2 >> 1;
+
+      int numberOfRows = (Z.ZoomFactor() > 0) ? h0 : height;
+      int numberOfThreads = Z.IsParallelProcessingEnabled() ?
+               Min( Z.MaxProcessors(), pcl::Thread::NumberOfThreads( numberOfRows, 1 ) ) : 1;
+      int rowsPerThread = numberOfRows/numberOfThreads;
 
       try
       {
@@ -131,110 +135,32 @@ public:
                }
             }
 
-            status.Initialize( info, n*N );
+            status.Initialize( info, size_type( n )*size_type( numberOfRows ) );
          }
 
-         GenericVector<typename P::sample> fm;
-         if ( Z.ZoomFactor() < 0 && Z.DownsampleMode() == IntegerDownsampleMode::Median )
-            fm = GenericVector<typename P::sample>( z2 );
-
          f0 = image.ReleaseData();
 
-         for ( int c = 0; c < n; ++c, status += N )
+         for ( int c = 0; c < n; ++c )
          {
-            f = image.Allocator().AllocatePixels( width, height );
-
-            if ( Z.ZoomFactor() > 0 )
-            {
-               const typename P::sample* f0c = f0[c];
-
-               for ( int y = 0; y < h0; ++y )
-               {
-                  int yz = y*z;
-
-                  for ( int x = 0; x < w0; ++x )
-                  {
-                     int xz = x*z;
-                     typename P::sample v = *f0c++;
-
-                     for ( int i = 0; i < z; ++i )
-                     {
-                        typename P::sample* fi = f + (size_type( yz + i )*width + xz);
+            ThreadData<P> data( Z, w0, width, status, numberOfRows );
+            data.f0 = f0[c];
+            data.f = f = image.Allocator().AllocatePixels( width, height );
 
-                        for ( int j = 0; j < z; ++j )
-                           *fi++ = v;
-                     }
-                  }
-               }
-            }
-            else
-            {
-               typename P::sample* fz = f;
+            ReferenceArray<Thread<P> > threads;
+            for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+               threads.Add( new Thread<P>( data,
+                                           i*rowsPerThread,
+                                           (j < numberOfThreads) ? j*rowsPerThread : numberOfRows ) );
 
-               for ( int y = 0; y < height; ++y )
-               {
-                  const typename P::sample* fy = f0[c] + size_type( y )*z*w0;
+            AbstractImage::RunThreads( threads, data );
 
-                  for ( int x = 0; x < width; ++x )
-                  {
-                     const typename P::sample* fyx = fy + x*z;
-
-                     switch ( Z.DownsampleMode() )
-                     {
-                     default:
-                     case IntegerDownsampleMode::Average:
-                        {
-                           double s = 0;
-                           for ( int i = 0; i < z; ++i, fyx += w0 )
-                              for ( int j = 0; j < z; ++j )
-                                 s += fyx[j];
-                           *fz++ = typename P::sample( P::IsFloatSample() ? s/z2 : Round( s/z2 ) );
-                        }
-                        break;
-
-                     case IntegerDownsampleMode::Median:
-                        {
-                           typename P::sample* fmi = *fm;
-                           for ( int i = 0; i < z; ++i, fyx += w0 )
-                              for ( int j = 0; j < z; ++j )
-                                 *fmi++ = fyx[j];
-
-                           *fz++ = (z & 1) ?
-                                 *Select( *fm, fm.At( z2 ), n2 ) :
-                                 P::FloatToSample( 0.5*(double( *Select( *fm, fm.At( z2 ), n2   ) ) +
-                                                        double( *Select( *fm, fm.At( z2 ), n2-1 ) )) );
-                        }
-                        break;
-
-                     case IntegerDownsampleMode::Maximum:
-                        {
-                           *fz = P::MinSampleValue();
-                           for ( int i = 0; i < z; ++i, fyx += w0 )
-                              for ( int j = 0; j < z; ++j )
-                                 if ( fyx[j] > *fz )
-                                    *fz = fyx[j];
-                           ++fz;
-                        }
-                        break;
-
-                     case IntegerDownsampleMode::Minimum:
-                        {
-                           *fz = P::MaxSampleValue();
-                           for ( int i = 0; i < z; ++i, fyx += w0 )
-                              for ( int j = 0; j < z; ++j )
-                                 if ( fyx[j] < *fz )
-                                    *fz = fyx[j];
-                           ++fz;
-                        }
-                        break;
-                     }
-                  }
-               }
-            }
+            threads.Destroy();
 
             image.Allocator().Deallocate( f0[c] );
             f0[c] = f;
             f = 0;
+
+            status = data.status;
          }
 
          image.ImportData( f0, width, height, n, cs0 ).Status() = status;
@@ -254,6 +180,153 @@ public:
          throw;
       }
    }
+
+private:
+
+   template <class P>
+   struct ThreadData : public AbstractImage::ThreadData
+   {
+      ThreadData( const IntegerResample& a_Z, int a_sourceWidth, int a_width, const StatusMonitor& a_status, size_type a_count ) :
+         AbstractImage::ThreadData( a_status, a_count ),
+         Z( a_Z ), sourceWidth( a_sourceWidth ), width( a_width )
+      {
+      }
+
+      const IntegerResample&    Z;
+            int                 sourceWidth;
+            int                 width;
+      const typename P::sample* f0 = nullptr;
+            typename P::sample* f = nullptr;
+   };
+
+   /*
+    * Each thread processes a range of source rows (upsampling) or a range of
+    * output rows (downsampling).
+    */
+   template <class P>
+   class Thread : public pcl::Thread
+   {
+   public:
+
+      Thread( ThreadData<P>& data, int firstRow, int endRow ) :
+         m_data( data ), m_firstRow( firstRow ), m_endRow( endRow )
+      {
+      }
+
+      PCL_HOT_FUNCTION void Run() override
+      {
+         INIT_THREAD_MONITOR()
+
+         const IntegerResample& Z = m_data.Z;
+         const int w0 = m_data.sourceWidth;
+         const int width = m_data.width;
+         const int z = pcl::Abs( Z.ZoomFactor() );
+         const int z2 = z*z;
+         const int n2 = z2 >> 1;
+
+         if ( Z.ZoomFactor() > 0 )
+         {
+            const typename P::sample* f0c = m_data.f0 + size_type( m_firstRow )*w0;
+
+            for ( int y = m_firstRow; y < m_endRow; ++y )
+            {
+               int yz = y*z;
+
+               for ( int x = 0; x < w0; ++x )
+               {
+                  int xz = x*z;
+                  typename P::sample v = *f0c++;
+
+                  for ( int i = 0; i < z; ++i )
+                  {
+                     typename P::sample* fi = m_data.f + (size_type( yz + i )*width + xz);
+
+                     for ( int j = 0; j < z; ++j )
+                        *fi++ = v;
+                  }
+               }
+
+               UPDATE_THREAD_MONITOR( 16 )
+            }
+         }
+         else
+         {
+            GenericVector<typename P::sample> fm;
+            if ( Z.DownsampleMode() == IntegerDownsampleMode::Median )
+               fm = GenericVector<typename P::sample>( z2 );
+
+            typename P::sample* fz = m_data.f + size_type( m_firstRow )*width;
+
+            for ( int y = m_firstRow; y < m_endRow; ++y )
+            {
+               const typename P::sample* fy = m_data.f0 + size_type( y )*z*w0;
+
+               for ( int x = 0; x < width; ++x )
+               {
+                  const typename P::sample* fyx = fy + x*z;
+
+                  switch ( Z.DownsampleMode() )
+                  {
+                  default:
+                  case IntegerDownsampleMode::Average:
+                     {
+                        double s = 0;
+                        for ( int i = 0; i < z; ++i, fyx += w0 )
+                           for ( int j = 0; j < z; ++j )
+                              s += fyx[j];
+                        *fz++ = typename P::sample( P::IsFloatSample() ? s/z2 : Round( s/z2 ) );
+                     }
+                     break;
+
+                  case IntegerDownsampleMode::Median:
+                     {
+                        typename P::sample* fmi = *fm;
+                        for ( int i = 0; i < z; ++i, fyx += w0 )
+                           for ( int j = 0; j < z; ++j )
+                              *fmi++ = fyx[j];
+
+                        *fz++ = (z & 1) ?
+                              *Select( *fm, fm.At( z2 ), n2 ) :
+                              P::FloatToSample( 0.5*(double( *Select( *fm, fm.At( z2 ), n2   ) ) +
+                                                     double( *Select( *fm, fm.At( z2 ), n2-1 ) )) );
+                     }
+                     break;
+
+                  case IntegerDownsampleMode::Maximum:
+                     {
+                        *fz = P::MinSampleValue();
+                        for ( int i = 0; i < z; ++i, fyx += w0 )
+                           for ( int j = 0; j < z; ++j )
+                              if ( fyx[j] > *fz )
+                                 *fz = fyx[j];
+                        ++fz;
+                     }
+                     break;
+
+                  case IntegerDownsampleMode::Minimum:
+                     {
+                        *fz = P::MaxSampleValue();
+                        for ( int i = 0; i < z; ++i, fyx += w0 )
+                           for ( int j = 0; j < z; ++j )
+                              if ( fyx[j] < *fz )
+                                 *fz = fyx[j];
+                        ++fz;
+                     }
+                     break;
+                  }
+               }
+
+               UPDATE_THREAD_MONITOR( 16 )
+            }
+         }
+      }
+
+   private:
+
+      ThreadData<P>& m_data;
+      int            m_firstRow;
+      int            m_endRow;
+   };
 };
 
 // ----------------------------------------------------------------------------
@@ -50,11 +50,14 @@
 // ----------------------------------------------------------------------------
 
 #include <pcl/AutoPointer.h>
+#include <pcl/BinaryContainer.h>
 #include <pcl/Compression.h>
 #include <pcl/Console.h>
 #include <pcl/LocalNormalizationData.h>
 #include <pcl/XML.h>
 
+#include <string.h>
+
 #define MIN_NORMALIZATION_SCALE  16
 
 namespace pcl
@@ -104,17 +107,270 @@ void LocalNormalizationData::Clear()
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Event-driven XNML decoder. Normalization matrices are decoded directly from
+ * the UTF-8 encoded source document, without generating an XML document tree.
+ * Error handling is equivalent to Parse( const XMLElement& ): errors found in
+ * a child element of the root element are shown and the element is ignored.
+ */
+class LocalNormalizationData::XMLDecoder : public XMLSAXDecoder
+{
+public:
+
+   XMLDecoder( LocalNormalizationData* data, bool ignoreNormalizationData ) :
+      m_data( data ),
+      m_ignoreNormalizationData( ignoreNormalizationData )
+   {
+   }
+
+protected:
+
+   void StartRootElement( const XMLStringView& name, const XMLSAXAttributeList& attributes ) override
+   {
+      if ( name != "xnml" || attributes.AttributeValue( "version" ) != "1.0" )
+         throw Error( "Not an XNML version 1.0 document." );
+   }
+
+   void StartDecodedElement( const XMLStringView& name, const XMLSAXAttributeList& attributes ) override
+   {
+      switch ( Depth() )
+      {
+      case 2:
+         if ( name == "ReferenceImage" || name == "TargetImage" || name == "CreationTime" )
+         {
+            StartText();
+         }
+         else if ( name == "ReferenceGeometry" )
+         {
+            String width = attributes.AttributeValue( "width" );
+            String height = attributes.AttributeValue( "height" );
+            if ( width.IsEmpty() || height.IsEmpty() )
+               throw Error( "Missing reference dimension attribute(s)." );
+            m_data->m_referenceWidth = width.ToInt();
+            m_data->m_referenceHeight = height.ToInt();
+            if ( m_data->m_referenceWidth < 1 || m_data->m_referenceHeight < 1 )
+               throw Error( "Invalid reference dimension(s)." );
+            StartText();
+         }
+         else if ( name == "LocalNormalization" )
+         {
+            if ( m_ignoreNormalizationData )
+            {
+               SkipElement();
+               break;
+            }
+            String scale = attributes.AttributeValue( "scale" );
+            if ( scale.IsEmpty() )
+               throw Error( "Missing local normalization scale attribute." );
+            m_data->m_scale = scale.ToInt();
+            if ( m_data->m_scale < MIN_NORMALIZATION_SCALE )
+               throw Error( "Invalid local normalization scale attribute value '" + scale + '\'' );
+         }
+         else
+            SkipUnknownElement( name, "xnml root" );
+         break;
+
+      case 3:
+         if ( name == "Scale" )
+            StartNormalizationMatrices( m_data->m_A, attributes );
+         else if ( name == "ZeroOffset" )
+            StartNormalizationMatrices( m_data->m_B, attributes );
+         else
+            SkipUnknownElement( name, "LocalNormalization" );
+         break;
+
+      case 4:
+         if ( name == "ChannelData" )
+            StartChannelData( attributes );
+         else
+            SkipUnknownElement( name, m_matricesName );
+         break;
+
+      default:
+         if ( name == "Subblock" )
+         {
+            String s = attributes.AttributeValue( "uncompressedSize" );
+            if ( s.IsEmpty() )
+               throw Error( "Missing subblock uncompressedSize attribute." );
+            m_uncompressedSize = s.ToUInt64();
+            StartText();
+         }
+         else
+            SkipUnknownElement( name, "ChannelData" );
+         break;
+      }
+   }
+
+   void EndDecodedElement( const XMLStringView& name ) override
+   {
+      switch ( Depth() )
+      {
+      case 2:
+         if ( name == "ReferenceImage" )
+            m_data->m_referenceFilePath = Text().DecodedText().Trimmed();
+         else if ( name == "TargetImage" )
+            m_data->m_targetFilePath = Text().DecodedText().Trimmed();
+         else if ( name == "CreationTime" )
+            m_data->m_creationTime = TimePoint( Text().DecodedText().Trimmed() );
+         else if ( name == "LocalNormalization" )
+         {
+            if ( m_data->m_A.IsEmpty() )
+               throw Error( "Missing local normalization scale matrices." );
+            if ( m_data->m_B.IsEmpty() )
+               throw Error( "Missing local normalization zero offset matrices." );
+         }
+         break;
+
+      case 3:
+         if ( m_channel < m_matrices->NumberOfChannels() )
+            throw Error( "Missing " + m_matricesName + " channel data." );
+         break;
+
+      case 4:
+         EndChannelData();
+         break;
+
+      default:
+         {
+            Compression::Subblock subblock;
+            subblock.uncompressedSize = m_uncompressedSize;
+            subblock.compressedData = DecodeBase64( Text() );
+            m_subblocks << subblock;
+         }
+         break;
+      }
+   }
+
+private:
+
+   LocalNormalizationData*    m_data;
+   bool                       m_ignoreNormalizationData;
+   normalization_matrices*    m_matrices = nullptr;
+   String                     m_matricesName;
+   int                        m_channel = 0;
+   AutoPointer<Compression>   m_compression;
+   Compression::subblock_list m_subblocks;
+   uint64                     m_uncompressedSize = 0;
+
+   void StartNormalizationMatrices( normalization_matrices& M, const XMLSAXAttributeList& attributes )
+   {
+      m_matricesName = (&M == &m_data->m_A) ? "Scale" : "ZeroOffset";
+
+      String s = attributes.AttributeValue( "width" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing " + m_matricesName + " width attribute." );
+      int width = s.ToInt();
+      if ( width < 1 )
+         throw Error( "Invalid " + m_matricesName + " width attribute value '" + s + '\'' );
+
+      s = attributes.AttributeValue( "height" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing " + m_matricesName + " height attribute." );
+      int height = s.ToInt();
+      if ( height < 1 )
+         throw Error( "Invalid " + m_matricesName + " height attribute value '" + s + '\'' );
+
+      s = attributes.AttributeValue( "numberOfChannels" );
+      if ( s.IsEmpty() )
+         throw Error( "Missing " + m_matricesName + " numberOfChannels attribute." );
+      int numberOfChannels = s.ToInt();
+      if ( numberOfChannels < 1 )
+         throw Error( "Invalid " + m_matricesName + " numberOfChannels attribute value '" + s + '\'' );
+
+      s = attributes.AttributeValue( "sampleFormat" );
+      if ( !s.IsEmpty() )
+         if ( s != "Float64" )
+            throw Error( "Invalid or unsupported " + m_matricesName + " sampleFormat attribute value '" + s + '\'' );
+
+      M.AllocateData( width, height, numberOfChannels );
+      m_matrices = &M;
+      m_channel = 0;
+   }
+
+   void StartChannelData( const XMLSAXAttributeList& attributes )
+   {
+      if ( m_channel == m_matrices->NumberOfChannels() )
+         throw Error( "Unexpected ChannelData child element - all normalization function channels are already defined." );
+
+      m_compression.Reset();
+      m_subblocks.Clear();
+
+      String compressionName = attributes.AttributeValue( "compression" ).CaseFolded();
+      if ( !compressionName.IsEmpty() )
+      {
+         if ( compressionName == "lz4" || compressionName == "lz4+sh" )
+            m_compression = new LZ4Compression;
+         else if ( compressionName == "lz4hc" || compressionName == "lz4hc+sh" )
+            m_compression = new LZ4HCCompression;
+         else if ( compressionName == "zlib" || compressionName == "zlib+sh" )
+            m_compression = new ZLibCompression;
+         else
+            throw Error( "Unknown or unsupported compression codec '" + compressionName + '\'' );
+
+         if ( compressionName.EndsWith( "+sh" ) )
+         {
+            m_compression->EnableByteShuffling();
+            m_compression->SetItemSize( m_matrices->BytesPerSample() );
+         }
+      }
+      else
+         StartText();
+   }
+
+   void EndChannelData()
+   {
+      ByteArray channelData;
+      if ( m_compression.IsValid() )
+      {
+         if ( m_subblocks.IsEmpty() )
+            throw Error( "Parsing xnml " + m_matricesName + " ChannelData element: Missing Subblock child element(s)." );
+         channelData = m_compression->Uncompress( m_subblocks );
+         m_subblocks.Clear();
+      }
+      else
+         channelData = DecodeBase64( Text() );
+
+      if ( channelData.Size() != m_matrices->ChannelSize() )
+         throw Error( "Parsing xnml " + m_matricesName + " ChannelData element: Invalid channel data size: "
+            "Expected " + String( m_matrices->ChannelSize() ) + " bytes, "
+            "got " + String( channelData.Size() ) + " bytes." );
+
+      ::memcpy( (*m_matrices)[m_channel], channelData.Begin(), channelData.Size() );
+
+      ++m_channel;
+   }
+
+   String ParentElementName() const override
+   {
+      switch ( Depth() )
+      {
+      case 1:  return "xnml root";
+      case 2:  return ElementName();
+      case 3:  return m_matricesName;
+      default: return "ChannelData";
+      }
+   }
+};
+
+// ----------------------------------------------------------------------------
+
 void LocalNormalizationData::Parse( const String& filePath, bool ignoreNormalizationData )
 {
+   if ( BinaryContainerReader::IsContainerFile( filePath ) )
+   {
+      Clear();
+      DecodeBinary( BinaryContainerReader( filePath, "XNML" ), ignoreNormalizationData );
+      ValidateParsedData( ignoreNormalizationData );
+      return;
+   }
+
    IsoString text = File::ReadTextFile( filePath );
    if ( text.IsEmpty() )
       throw Error( "Empty normalization data file." );
 
-   XMLDocument xml;
-   xml.SetParserOption( XMLParserOption::IgnoreComments );
-   xml.SetParserOption( XMLParserOption::IgnoreUnknownElements );
-   xml.Parse( text.UTF8ToUTF16() );
-   Parse( xml, ignoreNormalizationData );
+   Clear();
+   XMLDecoder( this, ignoreNormalizationData ).Parse( text );
+   ValidateParsedData( ignoreNormalizationData );
 }
 
 // ----------------------------------------------------------------------------
@@ -247,6 +503,13 @@ void LocalNormalizationData::Parse( const XMLElement& root, bool ignoreNormaliza
       }
    }
 
+   ValidateParsedData( ignoreNormalizationData );
+}
+
+// ----------------------------------------------------------------------------
+
+void LocalNormalizationData::ValidateParsedData( bool ignoreNormalizationData )
+{
    if ( m_referenceWidth < 0 || m_referenceHeight < 0 )
       throw Error( "Missing required ReferenceGeometry element." );
 
@@ -268,9 +531,8 @@ void LocalNormalizationData::Parse( const XMLElement& root, bool ignoreNormaliza
 
 // ----------------------------------------------------------------------------
 
-XMLDocument* LocalNormalizationData::Serialize() const
+void LocalNormalizationData::ValidateSerializableData() const
 {
-   // Validate data
    if ( m_scale < MIN_NORMALIZATION_SCALE ||
         m_referenceWidth < m_scale ||
         m_referenceHeight < m_scale ||
@@ -281,6 +543,13 @@ XMLDocument* LocalNormalizationData::Serialize() const
         m_referenceWidth < m_A.Width() ||
         m_referenceHeight < m_A.Height() )
       throw Error( "LocalNormalizationData::Serialize(): Uninitialized or invalid local normalization data." );
+}
+
+// ----------------------------------------------------------------------------
+
+XMLDocument* LocalNormalizationData::Serialize() const
+{
+   ValidateSerializableData();
 
    AutoPointer<XMLDocument> xml = new XMLDocument;
    xml->SetXML( "1.0", "UTF-8" );
@@ -328,6 +597,104 @@ void LocalNormalizationData::SerializeToFile( const String& path ) const
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Binary normalization data format. Each set of normalization matrices is
+ * stored as a single block with all channels in consecutive order.
+ */
+static ByteArray ContiguousMatrices( const LocalNormalizationData::normalization_matrices& M )
+{
+   ByteArray data( M.NumberOfChannels()*M.ChannelSize() );
+   for ( int c = 0; c < M.NumberOfChannels(); ++c )
+      ::memcpy( data.At( c*M.ChannelSize() ), M[c], M.ChannelSize() );
+   return data;
+}
+
+static void DecodeBinaryMatrices( LocalNormalizationData::normalization_matrices& M,
+                                  const BinaryContainerReader& reader, const IsoString& id )
+{
+   size_type length;
+   const LocalNormalizationData::normalization_coefficient* data =
+            reader.BlockData<LocalNormalizationData::normalization_coefficient>( id, length );
+   if ( data != nullptr )
+   {
+      const BinaryContainerReader::Block* block = reader.FindBlock( id );
+      int width = block->dim[0];
+      int height = block->dim[1];
+      int numberOfChannels = block->dim[2];
+      if ( width < 1 || height < 1 || numberOfChannels < 1 ||
+           length != size_type( width )*size_type( height )*size_type( numberOfChannels ) )
+         throw Error( "Invalid " + id + " block." );
+      M.AllocateData( width, height, numberOfChannels );
+      for ( int c = 0; c < numberOfChannels; ++c )
+         ::memcpy( M[c], data + c*M.NumberOfPixels(), M.ChannelSize() );
+   }
+}
+
+void LocalNormalizationData::SerializeToBinaryFile( const String& path ) const
+{
+   ValidateSerializableData();
+
+   BinaryContainerWriter writer( "XNML" );
+
+   writer.AddText( "CreationTime", TimePoint::Now().ToString() );
+   writer.AddText( "ReferenceImage", m_referenceFilePath );
+   writer.AddText( "TargetImage", m_targetFilePath );
+
+   int32 geometry[] = { m_referenceWidth, m_referenceHeight };
+   writer.AddBlock( "ReferenceGeometry", BinaryBlockType::Int32, geometry, sizeof( geometry ), 2 );
+
+   int32 scale = m_scale;
+   writer.AddBlock( "NormalizationScale", BinaryBlockType::Int32, &scale, sizeof( scale ), 1 );
+
+   ByteArray A = ContiguousMatrices( m_A );
+   writer.AddBlock( "Scale", BinaryBlockType::Float64, A.Begin(), A.Length(),
+                    m_A.Width(), m_A.Height(), m_A.NumberOfChannels() );
+   ByteArray B = ContiguousMatrices( m_B );
+   writer.AddBlock( "ZeroOffset", BinaryBlockType::Float64, B.Begin(), B.Length(),
+                    m_B.Width(), m_B.Height(), m_B.NumberOfChannels() );
+
+   writer.WriteFile( path );
+}
+
+// ----------------------------------------------------------------------------
+
+void LocalNormalizationData::DecodeBinary( const BinaryContainerReader& reader, bool ignoreNormalizationData )
+{
+   String creationTime = reader.TextBlock( "CreationTime" );
+   if ( !creationTime.IsEmpty() )
+      m_creationTime = TimePoint( creationTime );
+
+   m_referenceFilePath = reader.TextBlock( "ReferenceImage" );
+   m_targetFilePath = reader.TextBlock( "TargetImage" );
+
+   size_type length;
+   const int32* geometry = reader.BlockData<int32>( "ReferenceGeometry", length );
+   if ( geometry != nullptr )
+   {
+      if ( length != 2 )
+         throw Error( "Invalid ReferenceGeometry block." );
+      m_referenceWidth = geometry[0];
+      m_referenceHeight = geometry[1];
+      if ( m_referenceWidth < 1 || m_referenceHeight < 1 )
+         throw Error( "Invalid reference dimension(s)." );
+   }
+
+   if ( !ignoreNormalizationData )
+   {
+      const int32* scale = reader.BlockData<int32>( "NormalizationScale", length );
+      if ( scale == nullptr || length != 1 )
+         throw Error( "Missing or invalid local normalization scale block." );
+      m_scale = *scale;
+      if ( m_scale < MIN_NORMALIZATION_SCALE )
+         throw Error( "Invalid local normalization scale value '" + String( m_scale ) + '\'' );
+
+      DecodeBinaryMatrices( m_A, reader, "Scale" );
+      DecodeBinaryMatrices( m_B, reader, "ZeroOffset" );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
 void LocalNormalizationData::ParseNormalizationMatrices( normalization_matrices& M, const XMLElement& root ) const
 {
    String s = root.AttributeValue( "width" );
@@ -51,6 +51,8 @@
 
 #include <pcl/MorphologicalTransformation.h>
 #include <pcl/MultiVector.h>
+#include <pcl/Search.h>
+#include <pcl/Sort.h>
 #include <pcl/Thread.h>
 
 namespace pcl
@@ -58,6 +60,861 @@ namespace pcl
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Fast morphological transformations for erosion, dilation and median
+ * operators.
+ *
+ * Erosion and dilation are decomposed into horizontal runs of existing
+ * structure elements. Running minima/maxima are computed for each distinct run
+ * length with the van Herk/Gil-Werman algorithm, which requires three
+ * comparisons per pixel irrespective of the run length. Runs with identical
+ * horizontal extents on consecutive structure rows are merged with a vertical
+ * van Herk/Gil-Werman pass, so box structures are computed at constant cost
+ * per pixel, and the cost for arbitrary structures is proportional to the
+ * number of runs, not to the number of structure elements.
+ *
+ * The median operator uses a sliding two-level histogram (Huang's algorithm)
+ * updated with the leftmost and rightmost elements of each structure run, with
+ * incremental tracking of the median bin. Pixel values are mapped to at most
+ * 4096 bins with an order-preserving, quantile-based mapping, and the median
+ * value is refined exactly from sorted per-bin value lists, so the result is
+ * identical to a direct evaluation of the median.
+ *
+ * All algorithms read from a padded copy of each channel with the same border
+ * extension rules as the direct engine.
+ *
+ * References
+ *
+ * M. van Herk, A fast algorithm for local minimum and maximum filters on
+ * rectangular and octagonal kernels, Pattern Recognition Letters 13, 1992,
+ * pp. 517-521.
+ *
+ * J. Gil, M. Werman, Computing 2-D min, median, and max filters, IEEE
+ * Transactions on Pattern Analysis and Machine Intelligence 15, 1993,
+ * pp. 504-507.
+ *
+ * T. S. Huang, G. J. Yang, G. Y. Tang, A fast two-dimensional median
+ * filtering algorithm, IEEE Transactions on Acoustics, Speech, and Signal
+ * Processing 27, 1979, pp. 13-18.
+ *
+ * S. Perreault, P. Hebert, Median Filtering in Constant Time, IEEE
+ * Transactions on Image Processing 16, 2007, pp. 2389-2394.
+ */
+class PCL_FastMorphologicalTransformationEngine
+{
+public:
+
+   template <class P> static
+   bool Apply( GenericImage<P>& image, const MorphologicalTransformation& transformation )
+   {
+      const MorphologicalOperator& op = transformation.Operator();
+      const StructuringElement& structure = transformation.Structure();
+
+      int kind;
+      if ( dynamic_cast<const ErosionFilter*>( &op ) != nullptr )
+         kind = Erosion;
+      else if ( dynamic_cast<const DilationFilter*>( &op ) != nullptr )
+         kind = Dilation;
+      else if ( dynamic_cast<const MedianFilter*>( &op ) != nullptr )
+         kind = Median;
+      else
+         return false;
+
+      /*
+       * For small structures, the direct algorithm is faster.
+       */
+      if ( structure.Size() < ((kind == Median) ? MinMedianSize : MinExtremeSize) )
+         return false;
+
+      Rect r = image.SelectedRectangle();
+      int n = transformation.OverlappingDistance();
+      if ( n > r.Width() || n > r.Height() )
+         return false;
+
+      ThreadData<P> data( image, transformation, kind, image.NumberOfSelectedPixels() );
+
+      /*
+       * The cost of a sliding histogram median is proportional to the number
+       * of spans in the structure, while a direct median is proportional to
+       * the number of structure elements.
+       */
+      if ( kind == Median )
+         if ( data.numberOfElements < 4*data.numberOfSpans )
+            return false;
+
+      if ( image.Status().IsInitializationEnabled() )
+      {
+         image.Status().Initialize( "Morphological transformation, " + op.Description(), image.NumberOfSelectedSamples() );
+         data.status = image.Status();
+      }
+
+      int numberOfThreads = transformation.IsParallelProcessingEnabled() ?
+               Min( transformation.MaxProcessors(), pcl::Thread::NumberOfThreads( data.h, n ) ) : 1;
+      int rowsPerThread = data.h/numberOfThreads;
+
+      ReferenceArray<Thread<P> > threads;
+      for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+         threads.Add( new Thread<P>( data, i*rowsPerThread, (j < numberOfThreads) ? j*rowsPerThread : data.h ) );
+
+      for ( int c = image.FirstSelectedChannel(); c <= image.LastSelectedChannel(); ++c )
+      {
+         data.Initialize( c );
+         AbstractImage::RunThreads( threads, data );
+      }
+
+      image.SetStatusCallback( nullptr );
+      image.Status() = data.status;
+
+      threads.Destroy();
+      return true;
+   }
+
+private:
+
+   enum { Erosion, Dilation, Median };
+
+   enum { MinExtremeSize = 5, MinMedianSize = 7 };
+
+   /*
+    * Limits for the number of histogram bins. The number of bins grows with
+    * the number of structure elements, so that neighborhood values are never
+    * too sparse in the histogram.
+    */
+   enum { MinBinsShift = 8, MaxBinsShift = 12 };
+
+   /*
+    * A span of consecutive existing elements on a row of a structure way.
+    * Coordinates are in structure element units.
+    */
+   struct Span
+   {
+      int row, col, length;
+   };
+
+   /*
+    * A span that extends over a set of consecutive structure rows.
+    */
+   struct Segment
+   {
+      int row, col, length, height;
+   };
+
+   typedef Array<Span>     span_list;
+   typedef Array<Segment>  segment_list;
+
+   template <class P>
+   struct ThreadData : public AbstractImage::ThreadData
+   {
+      typedef typename P::sample sample;
+
+      GenericImage<P>&                   image;
+      const MorphologicalTransformation& transformation;
+      int                                kind;
+      Rect                               rect;
+      int                                w, h;         // selection dimensions
+      int                                d;            // interlacing distance
+      int                                n, n2;        // overlapping distance and half-distance
+      int                                wp, hp;       // padded channel dimensions
+      int                                channel = 0;
+      Array<span_list>                    runs;         // per way
+      Array<segment_list>                segments;     // per way
+      Array<sample>                      source;       // padded channel
+      Array<uint16>                      keys;         // median histogram bins
+      Array<sample>                      binValues;    // value of exact bins
+      Array<uint8>                       exactBins;    // bins with a unique value
+      int                                numberOfElements = 0; // existing structure elements, all ways
+      int                                numberOfSpans = 0;    // structure spans, all ways
+      int                                binShift = MinBinsShift;  // log2 of the maximum number of bins
+      int                                numberOfBins = 0;
+      sample                             th0, th1;
+      bool                               tz0, tz1;
+
+      ThreadData( GenericImage<P>& a_image, const MorphologicalTransformation& a_transformation, int a_kind, size_type a_count ) :
+         AbstractImage::ThreadData( a_image, a_count ),
+         image( a_image ), transformation( a_transformation ), kind( a_kind )
+      {
+         rect = image.SelectedRectangle();
+         w = rect.Width();
+         h = rect.Height();
+         d = transformation.InterlacingDistance();
+         n = transformation.OverlappingDistance();
+         n2 = n >> 1;
+         wp = w + 2*n2;
+         hp = h + 2*n2;
+
+         th0 = P::ToSample( transformation.LowThreshold() );
+         th1 = P::ToSample( transformation.HighThreshold() );
+         tz0 = 1 + th0 == 1;
+         tz1 = 1 + th1 == 1;
+
+         /*
+          * Decompose structure ways into runs of existing elements, from the
+          * (possibly reflected) existence masks.
+          */
+         const StructuringElement& S = transformation.Structure();
+         int s = S.Size();
+         GenericVector<int> index( S.NumberOfElements() ), existing( S.NumberOfElements() );
+         for ( int i = 0; i < index.Length(); ++i )
+            index[i] = i;
+         for ( int k = 0; k < S.NumberOfWays(); ++k )
+         {
+            int count;
+            S.PeekElements( existing.Begin(), count, index.Begin(), k );
+            span_list R;
+            for ( int i = 0; i < count; )
+            {
+               Span run = { existing[i]/s, existing[i]%s, 1 };
+               for ( ++i; i < count && existing[i] == existing[i-1]+1 && existing[i]%s != 0; ++i )
+                  ++run.length;
+               R << run;
+            }
+            runs << R;
+
+            segment_list G;
+            for ( const Span& run : R )
+            {
+               bool merged = false;
+               for ( Segment& g : G )
+                  if ( g.col == run.col && g.length == run.length && g.row + g.height == run.row )
+                  {
+                     ++g.height;
+                     merged = true;
+                     break;
+                  }
+               if ( !merged )
+                  G << Segment{ run.row, run.col, run.length, 1 };
+            }
+            segments << G;
+
+            numberOfElements += count;
+            numberOfSpans += int( R.Length() );
+            while ( binShift < MaxBinsShift && (1 << binShift) < 4*count )
+               ++binShift;
+         }
+      }
+
+      /*
+       * Prepares working data for the specified channel: a padded copy of the
+       * selected region, with the same border extension rules used by the
+       * direct algorithm, and histogram bins for median filtering.
+       */
+      void Initialize( int c )
+      {
+         channel = c;
+         count = 0;
+         total = size_type( w )*size_type( h );
+
+         int H = image.Height();
+         source = Array<sample>( size_type( wp )*size_type( hp ) );
+         for ( int yy = 0; yy < hp; ++yy )
+         {
+            int y = rect.y0 - n2 + yy;
+            if ( y < 0 )
+               y = 2*rect.y0 - 1 - y;
+            y = Range( y, 0, H-1 );
+            const sample* f = image.PixelAddress( rect.x0, y, c );
+            sample* g = source.Begin() + size_type( yy )*wp;
+            for ( int xx = 0; xx < wp; ++xx )
+            {
+               int x = xx - n2;
+               if ( x < 0 )
+                  x = -x;
+               else if ( x >= w )
+                  x = 2*(w - 1) - x;
+               g[xx] = f[Range( x, 0, w-1 )];
+            }
+         }
+
+         if ( kind == Median )
+            InitializeBins();
+      }
+
+   private:
+
+      /*
+       * Order-preserving mapping of sample values to histogram bins. Bin
+       * boundaries are quantiles of a regular subsample of the channel, so
+       * the values of any neighborhood tend to be spread uniformly among
+       * bins. Frequent values are isolated in their own bins, where they can
+       * be retrieved without refinement.
+       */
+      void InitializeBins()
+      {
+         const size_type N = source.Length();
+         const int maxBins = 1 << binShift;
+         const size_type maxSamples = 16*maxBins;
+         size_type step = Max( size_type( 1 ), N/maxSamples );
+         Array<sample> v;
+         v.Reserve( N/step + 1 );
+         for ( size_type i = 0; i < N; i += step )
+            v << source[i];
+         pcl::Sort( v.Begin(), v.End() );
+
+         Array<sample> bounds;
+         for ( int i = 1; i < maxBins; ++i )
+         {
+            size_type j = (i*v.Length())/maxBins;
+            if ( j == 0 )
+               continue;
+            if ( bounds.IsEmpty() || bounds[bounds.Length()-1] < v[j] )
+               bounds << v[j];
+            else if ( bounds[bounds.Length()-1] == v[j] )
+            {
+               /*
+                * Repeated quantile: isolate this frequent value in its own
+                * bin, bounded by the next distinct sample value.
+                */
+               const sample* u = pcl::InsertionPoint( v.Begin(), v.End(), v[j] );
+               if ( u != v.End() )
+                  bounds << *u;
+            }
+         }
+
+         numberOfBins = int( bounds.Length() ) + 1;
+         keys = Array<uint16>( N );
+         size_type nb = numberOfBins;
+         Array<sample> binMin( nb ), binMax( nb );
+         Array<uint8> used( nb, uint8( 0 ) );
+         const sample* b0 = bounds.Begin();
+         const sample* b1 = bounds.End();
+         for ( size_type i = 0; i < N; ++i )
+         {
+            sample x = source[i];
+            int k = int( pcl::InsertionPoint( b0, b1, x ) - b0 );
+            keys[i] = uint16( k );
+            if ( used[k] )
+            {
+               if ( x < binMin[k] )
+                  binMin[k] = x;
+               else if ( x > binMax[k] )
+                  binMax[k] = x;
+            }
+            else
+            {
+               binMin[k] = binMax[k] = x;
+               used[k] = 1;
+            }
+         }
+
+         binValues = binMin;
+         exactBins = Array<uint8>( nb );
+         for ( int k = 0; k < numberOfBins; ++k )
+            exactBins[k] = used[k] && binMin[k] == binMax[k];
+      }
+   };
+
+   // -------------------------------------------------------------------------
+
+   struct MinOp
+   {
+      template <typename T>
+      static T Apply( T a, T b )
+      {
+         return (b < a) ? b : a;
+      }
+   };
+
+   struct MaxOp
+   {
+      template <typename T>
+      static T Apply( T a, T b )
+      {
+         return (a < b) ? b : a;
+      }
+   };
+
+   /*
+    * Running minimum/maximum of length L over a sequence of n elements with
+    * the van Herk/Gil-Werman algorithm:
+    *
+    *    y[i] = op( x[i*step], ..., x[(i+L-1)*step] ),  0 <= i <= n-L.
+    *
+    * g and h are working arrays of length n.
+    */
+   template <class Op, typename T>
+   static void RunningExtreme( T* y, const T* x, int n, int step, int L, T* g, T* h )
+   {
+      for ( int i = 0; i < n; ++i )
+         g[i] = (i % L) ? Op::Apply( g[i-1], x[i*step] ) : x[i*step];
+      for ( int i = n; --i >= 0; )
+         h[i] = (i == n-1 || (i+1) % L == 0) ? x[i*step] : Op::Apply( h[i+1], x[i*step] );
+      for ( int i = 0, j = L-1; j < n; ++i, ++j )
+         y[i] = Op::Apply( h[i], g[j] );
+   }
+
+   /*
+    * Vectorized running minimum/maximum over a sequence of rows.
+    *
+    *    y[i][] = op( x[i][], ..., x[i+L-1][] ),  0 <= i <= n-L
+    *
+    * where x[i] is the address of the i-th input row. g and h are working
+    * arrays of n rows.
+    */
+   template <class Op, typename T, class F>
+   static void RunningExtremeRows( F output, const T* const* x, int n, int L, int width, T* g, T* h )
+   {
+      for ( int i = 0; i < n; ++i )
+      {
+         T* gi = g + size_type( i )*width;
+         if ( i % L )
+         {
+            const T* gp = gi - width;
+            for ( int j = 0; j < width; ++j )
+               gi[j] = Op::Apply( gp[j], x[i][j] );
+         }
+         else
+            ::memcpy( gi, x[i], width*sizeof( T ) );
+      }
+      for ( int i = n; --i >= 0; )
+      {
+         T* hi = h + size_type( i )*width;
+         if ( i == n-1 || (i+1) % L == 0 )
+            ::memcpy( hi, x[i], width*sizeof( T ) );
+         else
+         {
+            const T* hn = hi + width;
+            for ( int j = 0; j < width; ++j )
+               hi[j] = Op::Apply( hn[j], x[i][j] );
+         }
+      }
+      for ( int i = 0, j = L-1; j < n; ++i, ++j )
+      {
+         const T* hi = h + size_type( i )*width;
+         const T* gj = g + size_type( j )*width;
+         output( i, hi, gj );
+      }
+   }
+
+   // -------------------------------------------------------------------------
+
+   /*
+    * Sliding histogram for exact median computation.
+    */
+   template <typename T>
+   class MedianHistogram
+   {
+   public:
+
+      MedianHistogram( int numberOfBins, int binShift, const uint16* keys, const T* values, const uint8* exact, const T* binValues ) :
+         m_keys( keys ), m_values( values ), m_exact( exact ), m_binValues( binValues ),
+         m_blockShift( binShift >> 1 ),
+         m_blockSize( 1 << m_blockShift ),
+         m_fine( size_type( numberOfBins + m_blockSize ), 0 ),
+         m_coarse( size_type( (numberOfBins >> m_blockShift) + 2 ), 0 ),
+         m_lists( size_type( numberOfBins ) )
+      {
+      }
+
+      ~MedianHistogram()
+      {
+         for ( BinList& list : m_lists )
+            delete [] list.data;
+      }
+
+      void Add( size_type i )
+      {
+         int k = m_keys[i];
+         if ( !m_exact[k] )
+            Insert( m_lists[k], m_fine[k], m_values[i] );
+         ++m_fine[k];
+         ++m_coarse[k >> m_blockShift];
+         if ( k < m_bin )
+            ++m_below;
+      }
+
+      void Remove( size_type i )
+      {
+         int k = m_keys[i];
+         if ( !m_exact[k] )
+            Delete( m_lists[k], m_fine[k], m_values[i] );
+         --m_fine[k];
+         --m_coarse[k >> m_blockShift];
+         if ( k < m_bin )
+            --m_below;
+      }
+
+      /*
+       * Returns the k-th smallest value in the histogram, 0 <= k < count.
+       */
+      T Select( int k )
+      {
+         const int* H = m_fine.Begin();
+         const int* C = m_coarse.Begin();
+         while ( m_below > k )
+            if ( (m_bin & (m_blockSize-1)) == 0 && m_below - C[(m_bin >> m_blockShift) - 1] > k )
+            {
+               m_bin -= m_blockSize;
+               m_below -= C[m_bin >> m_blockShift];
+            }
+            else
+               m_below -= H[--m_bin];
+         for ( ;; )
+         {
+            if ( (m_bin & (m_blockSize-1)) == 0 && m_below + C[m_bin >> m_blockShift] <= k )
+            {
+               m_below += C[m_bin >> m_blockShift];
+               m_bin += m_blockSize;
+               continue;
+            }
+            if ( m_below + H[m_bin] > k )
+               break;
+            m_below += H[m_bin++];
+         }
+         return m_exact[m_bin] ? m_binValues[m_bin] : m_lists[m_bin].data[k - m_below];
+      }
+
+   private:
+
+      struct BinList
+      {
+         T*  data = nullptr;
+         int capacity = 0;
+      };
+
+      const uint16*   m_keys;
+      const T*        m_values;
+      const uint8*    m_exact;
+      const T*        m_binValues;
+      int             m_blockShift; // log2 of the number of bins per coarse block
+      int             m_blockSize;
+      Array<int>      m_fine;
+      Array<int>      m_coarse;
+      Array<BinList>  m_lists;
+      int             m_bin = 0;    // current median bin
+      int             m_below = 0;  // number of elements in bins < m_bin
+
+      static void Insert( BinList& list, int count, T x )
+      {
+         if ( count == list.capacity )
+         {
+            int capacity = Max( 8, 2*list.capacity );
+            T* data = new T[ capacity ];
+            if ( count > 0 )
+               ::memcpy( data, list.data, count*sizeof( T ) );
+            delete [] list.data;
+            list.data = data;
+            list.capacity = capacity;
+         }
+         T* p = pcl::InsertionPoint( list.data, list.data+count, x );
+         ::memmove( p+1, p, (list.data+count - p)*sizeof( T ) );
+         *p = x;
+      }
+
+      static void Delete( BinList& list, int count, T x )
+      {
+         T* p = pcl::BinarySearch( list.data, list.data+count, x );
+         ::memmove( p, p+1, (list.data+count - p - 1)*sizeof( T ) );
+      }
+   };
+
+   // -------------------------------------------------------------------------
+
+   template <class P>
+   class Thread : public pcl::Thread
+   {
+   public:
+
+      typedef typename P::sample sample;
+
+      Thread( ThreadData<P>& data, int startRow, int endRow ) :
+         m_data( data ), m_startRow( startRow ), m_endRow( endRow )
+      {
+      }
+
+      PCL_HOT_FUNCTION void Run() override
+      {
+         INIT_THREAD_MONITOR()
+
+         const int ways = m_data.runs.Length();
+         const int w = m_data.w;
+         const int wp = m_data.wp;
+         const int n2 = m_data.n2;
+         DVector W( ways );
+         bool tz = m_data.tz0 && m_data.tz1;
+
+         /*
+          * Process output rows in strips. For median filtering, strips only
+          * determine the size of working buffers.
+          */
+         int strip = Max( 32, 2*m_data.n );
+         Array<sample> R( size_type( ways )*w*strip );
+
+         for ( int y0 = m_startRow; y0 < m_endRow; y0 += strip )
+         {
+            int y1 = Min( y0 + strip, m_endRow );
+            for ( int k = 0; k < ways; ++k )
+            {
+               sample* Rk = R.Begin() + size_type( k )*w*strip;
+               switch ( m_data.kind )
+               {
+               case Erosion:
+                  ExtremeStrip<MinOp>( Rk, k, y0, y1 );
+                  break;
+               case Dilation:
+                  ExtremeStrip<MaxOp>( Rk, k, y0, y1 );
+                  break;
+               case Median:
+                  MedianStrip( Rk, k, y0, y1 );
+                  break;
+               }
+            }
+
+            for ( int y = y0; y < y1; ++y )
+            {
+               sample* f = m_data.image.PixelAddress( m_data.rect.x0, m_data.rect.y0 + y, m_data.channel );
+               const sample* f0 = m_data.source.Begin() + size_type( y + n2 )*wp + n2;
+               for ( int x = 0; x < w; ++x )
+               {
+                  double r;
+                  if ( ways > 1 )
+                  {
+                     for ( int k = 0; k < ways; ++k )
+                        W[k] = R[(size_type( k )*strip + y - y0)*w + x];
+                     r = m_data.transformation.Operator()( *W, W.Length() );
+                  }
+                  else
+                     r = R[size_type( y - y0 )*w + x];
+
+                  if ( !tz )
+                  {
+                     double v = f0[x];
+                     if ( r < v )
+                     {
+                        if ( !m_data.tz0 )
+                        {
+                           double k = v - r;
+                           if ( k < m_data.th0 )
+                           {
+                              k /= m_data.th0;
+                              r = k*r + (1 - k)*v;
+                           }
+                        }
+                     }
+                     else
+                     {
+                        if ( !m_data.tz1 )
+                        {
+                           double k = r - v;
+                           if ( k < m_data.th1 )
+                           {
+                              k /= m_data.th1;
+                              r = k*r + (1 - k)*v;
+                           }
+                        }
+                     }
+                  }
+
+                  f[x] = P::FloatToSample( r );
+
+                  UPDATE_THREAD_MONITOR( 65536 )
+               }
+            }
+         }
+      }
+
+   private:
+
+      ThreadData<P>& m_data;
+      int            m_startRow;
+      int            m_endRow;
+
+      /*
+       * Erosion/dilation of output rows [y0,y1) for the k-th structure way.
+       * Output row y corresponds to padded source rows [y,y+n).
+       */
+      template <class Op>
+      void ExtremeStrip( sample* R, int k, int y0, int y1 )
+      {
+         const int w = m_data.w;
+         const int wp = m_data.wp;
+         const int d = m_data.d;
+         const int hs = y1 - y0;
+         const int rows = hs + m_data.n - 1;
+         const segment_list& segments = m_data.segments[k];
+
+         if ( segments.IsEmpty() )
+         {
+            for ( int i = 0; i < hs*w; ++i )
+               R[i] = 0;
+            return;
+         }
+
+         Array<uint8> done( segments.Length(), uint8( 0 ) );
+         bool first = true;
+
+         Array<sample> M, G, H, g, h;
+         Array<const sample*> x;
+
+         for ( size_type s = 0; s < segments.Length(); ++s )
+         {
+            if ( done[s] )
+               continue;
+
+            /*
+             * Horizontal running extreme for the current run length on all
+             * source rows required by this strip.
+             */
+            const int L = segments[s].length;
+            const int wm = wp - d*(L - 1);
+            M = Array<sample>( size_type( rows )*wm );
+            {
+               int nx = (wp + d - 1)/d;
+               g = Array<sample>( size_type( nx ) );
+               h = Array<sample>( size_type( nx ) );
+               Array<sample> tmp( g.Length() );
+               for ( int i = 0; i < rows; ++i )
+               {
+                  const sample* src = m_data.source.Begin() + size_type( y0 + i )*wp;
+                  sample* dst = M.Begin() + size_type( i )*wm;
+                  for ( int rho = 0; rho < d && rho < wm; ++rho )
+                  {
+                     int ns = (wp - rho + d - 1)/d;
+                     RunningExtreme<Op>( tmp.Begin(), src + rho, ns, d, L, g.Begin(), h.Begin() );
+                     for ( int j = 0, xx = rho; xx < wm; ++j, xx += d )
+                        dst[xx] = tmp[j];
+                  }
+               }
+            }
+
+            for ( size_type t = s; t < segments.Length(); ++t )
+            {
+               if ( done[t] || segments[t].length != L )
+                  continue;
+               done[t] = 1;
+
+               const Segment& seg = segments[t];
+               const int dx = d*seg.col;
+               const int dy = d*seg.row;
+
+               auto accumulate = [&]( int y, const sample* a, const sample* b )
+               {
+                  sample* Ry = R + size_type( y )*w;
+                  a += dx;
+                  b += dx;
+                  if ( first )
+                     for ( int x = 0; x < w; ++x )
+                        Ry[x] = Op::Apply( a[x], b[x] );
+                  else
+                     for ( int x = 0; x < w; ++x )
+                        Ry[x] = Op::Apply( Ry[x], Op::Apply( a[x], b[x] ) );
+               };
+
+               if ( seg.height == 1 )
+               {
+                  for ( int y = 0; y < hs; ++y )
+                  {
+                     const sample* a = M.Begin() + size_type( y + dy )*wm;
+                     accumulate( y, a, a );
+                  }
+               }
+               else
+               {
+                  /*
+                   * Vertical running extreme over the rows of this segment,
+                   * for each residue class of output rows modulo the
+                   * interlacing distance.
+                   */
+                  for ( int rho = 0; rho < d && rho < hs; ++rho )
+                  {
+                     int nq = (hs - rho + d - 1)/d;
+                     int ns = nq + seg.height - 1;
+                     x = Array<const sample*>( size_type( ns ) );
+                     for ( int q = 0; q < ns; ++q )
+                        x[q] = M.Begin() + size_type( rho + dy + d*q )*wm;
+                     if ( G.Length() < size_type( ns )*wm )
+                     {
+                        G = Array<sample>( size_type( ns )*wm );
+                        H = Array<sample>( size_type( ns )*wm );
+                     }
+                     RunningExtremeRows<Op>( [&]( int q, const sample* a, const sample* b )
+                                             {
+                                                accumulate( rho + d*q, a, b );
+                                             },
+                                             x.Begin(), ns, seg.height, wm, G.Begin(), H.Begin() );
+                  }
+               }
+
+               first = false;
+            }
+         }
+      }
+
+      /*
+       * Median filter of output rows [y0,y1) for the k-th structure way.
+       */
+      void MedianStrip( sample* R, int k, int y0, int y1 )
+      {
+         const int w = m_data.w;
+         const int wp = m_data.wp;
+         const int d = m_data.d;
+         const span_list& runs = m_data.runs[k];
+
+         int count = 0;
+         for ( const Span& run : runs )
+            count += run.length;
+
+         if ( count == 0 )
+         {
+            for ( int i = 0; i < (y1 - y0)*w; ++i )
+               R[i] = 0;
+            return;
+         }
+
+         MedianHistogram<sample> H( m_data.numberOfBins, m_data.binShift, m_data.keys.Begin(), m_data.source.Begin(),
+                                    m_data.exactBins.Begin(), m_data.binValues.Begin() );
+         int k2 = count >> 1;
+
+         for ( int y = y0; y < y1; ++y )
+         {
+            sample* Ry = R + size_type( y - y0 )*w;
+            for ( int rho = 0; rho < d && rho < w; ++rho )
+            {
+               size_type origin = size_type( y )*wp + rho;
+
+               for ( const Span& run : runs )
+               {
+                  size_type i = origin + size_type( d*run.row )*wp + d*run.col;
+                  for ( int j = 0; j < run.length; ++j, i += d )
+                     H.Add( i );
+               }
+
+               for ( int x = rho; ; )
+               {
+                  if ( count & 1 )
+                     Ry[x] = H.Select( k2 );
+                  else
+                  {
+                     double a = H.Select( k2-1 );
+                     double b = H.Select( k2 );
+                     Ry[x] = P::FloatToSample( (a + b)/2 );
+                  }
+
+                  if ( (x += d) >= w )
+                     break;
+
+                  for ( const Span& run : runs )
+                  {
+                     size_type i = origin + size_type( d*run.row )*wp + d*run.col;
+                     H.Remove( i );
+                     H.Add( i + d*run.length );
+                  }
+                  origin += d;
+               }
+
+               for ( const Span& run : runs )
+               {
+                  size_type i = origin + size_type( d*run.row )*wp + d*run.col;
+                  for ( int j = 0; j < run.length; ++j, i += d )
+                     H.Remove( i );
+               }
+            }
+         }
+      }
+   };
+};
+
+// ----------------------------------------------------------------------------
+
 class PCL_MorphologicalTransformationEngine
 {
 public:
@@ -88,6 +945,22 @@ public:
          didReflect = true;
       }
 
+      try
+      {
+         if ( PCL_FastMorphologicalTransformationEngine::Apply( image, transformation ) )
+         {
+            if ( didReflect )
+               const_cast<StructuringElement&>( transformation.Structure() ).Reflect();
+            return;
+         }
+      }
+      catch ( ... )
+      {
+         if ( didReflect )
+            const_cast<StructuringElement&>( transformation.Structure() ).Reflect();
+         throw;
+      }
+
       int numberOfRows = image.SelectedRectangle().Height();
       int numberOfThreads = transformation.IsParallelProcessingEnabled() ?
                Min( transformation.MaxProcessors(), pcl::Thread::NumberOfThreads( numberOfRows, n ) ) : 1;
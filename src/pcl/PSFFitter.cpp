@@ -0,0 +1,538 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/PSFFitter.cpp - Released 2019-01-21T12:06:21Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#include <pcl/PSFFitter.h>
+#include <pcl/ReferenceArray.h>
+#include <pcl/Thread.h>
+
+// ----------------------------------------------------------------------------
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Levenberg-Marquardt PSF fitting with analytic Jacobians.
+ *
+ * Each model evaluation generates residuals and partial derivatives for a
+ * full row of sampled pixels into per-parameter row buffers (one contiguous
+ * array per Jacobian column), then accumulates the normal equations J'J and
+ * J'r with dot products over the row buffers. The m x n Jacobian matrix is
+ * never stored, and no finite differences are required.
+ */
+class PCL_PSFFitEngine
+{
+public:
+
+   typedef PSFFitter::Status  status;
+
+   PCL_PSFFitEngine( const PSFFitter& F, const Matrix& S ) :
+      m_F( F ),
+      m_S( S ),
+      m_n( F.NumberOfFittedParameters() ),
+      m_nb( F.IsCircular() ? 5 : 7 ),
+      m_ib( F.BetaIndex() ),
+      m_w( S.Cols() ),
+      m_h( S.Rows() ),
+      m_J( m_n*m_w ),
+      m_r( m_w )
+   {
+   }
+
+   status Solve( Vector& P )
+   {
+      int np = PSFFitter::NumberOfParameters( m_F.IsCircular() );
+      if ( P.Length() < np || m_S.NumberOfElements() < size_type( m_n ) )
+         return PSFFitter::BadParameters;
+
+      double a[ 8 ];
+      for ( int i = 0; i < np; ++i )
+         a[i] = P[i];
+      if ( m_F.PSFFunction() == PSFFitter::Lorentzian )
+         a[m_ib] = 1;
+
+      if ( !IsValid( a ) )
+         return PSFFitter::BadParameters;
+
+      const double tol = m_F.Tolerance();
+      const int maxEvaluations = 100*(m_n + 1);
+
+      double JtJ[ 64 ], g[ 8 ], ssr;
+      Evaluate( a, JtJ, g, ssr );
+      int evaluations = 1;
+
+      status result;
+      double lambda = 1.0e-03;
+
+      for ( ;; )
+      {
+         if ( ssr == 0 )
+         {
+            result = PSFFitter::FittedOk;
+            break;
+         }
+
+         /*
+          * Marquardt's damped normal equations: (J'J + lambda*diag(J'J))*d = -J'r
+          */
+         double M[ 64 ], d[ 8 ];
+         for ( int i = 0; i < m_n*m_n; ++i )
+            M[i] = JtJ[i];
+         for ( int i = 0; i < m_n; ++i )
+         {
+            M[i*m_n + i] += lambda*Max( JtJ[i*m_n + i], 1.0e-30 );
+            d[i] = -g[i];
+         }
+
+         bool ok = CholeskySolve( M, d, m_n );
+         if ( ok )
+         {
+            /*
+             * Constrain variations of the beta shape parameter to 5% per
+             * iteration to prevent convergence to spurious local minima.
+             */
+            if ( m_n > m_nb )
+            {
+               double dmax = 0.05*a[m_ib];
+               if ( Abs( d[m_nb] ) > dmax )
+               {
+                  double k = dmax/Abs( d[m_nb] );
+                  for ( int i = 0; i < m_n; ++i )
+                     d[i] *= k;
+               }
+            }
+
+            double a1[ 8 ];
+            for ( int i = 0; i < np; ++i )
+               a1[i] = a[i];
+            double dnorm = 0, anorm = 0;
+            for ( int i = 0; i < m_n; ++i )
+            {
+               int j = (i < m_nb) ? i : m_ib;
+               a1[j] += d[i];
+               dnorm += d[i]*d[i];
+               anorm += a[j]*a[j];
+            }
+            bool smallStep = Sqrt( dnorm ) <= tol*(Sqrt( anorm ) + tol);
+
+            if ( IsValid( a1 ) )
+            {
+               double JtJ1[ 64 ], g1[ 8 ], ssr1;
+               Evaluate( a1, JtJ1, g1, ssr1 );
+               ++evaluations;
+
+               if ( ssr1 < ssr )
+               {
+                  bool smallReduction = ssr - ssr1 <= tol*ssr;
+                  for ( int i = 0; i < np; ++i )
+                     a[i] = a1[i];
+                  for ( int i = 0; i < m_n*m_n; ++i )
+                     JtJ[i] = JtJ1[i];
+                  for ( int i = 0; i < m_n; ++i )
+                     g[i] = g1[i];
+                  ssr = ssr1;
+                  lambda = Max( 0.1*lambda, 1.0e-15 );
+
+                  if ( smallReduction || smallStep )
+                  {
+                     result = PSFFitter::FittedOk;
+                     break;
+                  }
+               }
+               else
+                  ok = false;
+            }
+            else
+               ok = false;
+
+            if ( !ok && smallStep )
+            {
+               result = PSFFitter::FittedOk;
+               break;
+            }
+         }
+
+         if ( !ok )
+         {
+            lambda *= 10;
+            if ( lambda > 1.0e+16 )
+            {
+               result = PSFFitter::InaccurateSolution;
+               break;
+            }
+         }
+
+         if ( evaluations >= maxEvaluations )
+         {
+            result = PSFFitter::NoConvergence;
+            break;
+         }
+      }
+
+      for ( int i = 0; i < np; ++i )
+         P[i] = a[i];
+      return result;
+   }
+
+private:
+
+   const PSFFitter& m_F;
+   const Matrix&    m_S;
+         int        m_n;  // number of fitted parameters
+         int        m_nb; // index of beta in the fitted subset, if fitted
+         int        m_ib; // index of beta in parameter vectors
+         int        m_w;
+         int        m_h;
+         Vector     m_J;  // Jacobian row buffers, one per fitted parameter
+         Vector     m_r;  // residuals row buffer
+
+   bool IsValid( const double* a ) const
+   {
+      // B, A >= 0
+      if ( !(a[0] >= 0) || !(a[1] >= 0) )
+         return false;
+      // sx, sy != 0
+      if ( !(Abs( a[4] ) > 1.0e-10) )
+         return false;
+      if ( !m_F.IsCircular() )
+         if ( !(Abs( a[5] ) > 1.0e-10) || !IsFinite( a[6] ) )
+            return false;
+      if ( m_F.IsVariableShape() )
+         if ( !(a[m_ib] > 0 && a[m_ib] <= 10) )
+            return false;
+      return IsFinite( a[2] ) && IsFinite( a[3] );
+   }
+
+   void Evaluate( const double* a, double* JtJ, double* g, double& ssr )
+   {
+      switch ( m_F.PSFFunction() )
+      {
+      case PSFFitter::Gaussian:
+         if ( m_F.IsCircular() )
+            EvaluateModel<true, true, false>( a, JtJ, g, ssr );
+         else
+            EvaluateModel<false, true, false>( a, JtJ, g, ssr );
+         break;
+      default:
+         if ( m_F.IsCircular() )
+         {
+            if ( m_F.IsVariableShape() )
+               EvaluateModel<true, false, true>( a, JtJ, g, ssr );
+            else
+               EvaluateModel<true, false, false>( a, JtJ, g, ssr );
+         }
+         else
+         {
+            if ( m_F.IsVariableShape() )
+               EvaluateModel<false, false, true>( a, JtJ, g, ssr );
+            else
+               EvaluateModel<false, false, false>( a, JtJ, g, ssr );
+         }
+         break;
+      }
+   }
+
+   /*
+    * Model evaluation. In the rotated frame of the PSF:
+    *
+    *   u = cos(theta)*dx - sin(theta)*dy
+    *   v = sin(theta)*dx + cos(theta)*dy
+    *   q = u^2/sx^2 + v^2/sy^2
+    *
+    * with dx = x - x0 and dy = y - y0. Gaussian models are B + A*Exp( -q/2 );
+    * Moffat models are B + A*(1 + q)^-beta. All partial derivatives with
+    * respect to geometric parameters are df/dq * dq/dp.
+    */
+   template <bool circular, bool gaussian, bool fitBeta>
+   PCL_HOT_FUNCTION
+   void EvaluateModel( const double* a, double* JtJ, double* g, double& ssr )
+   {
+      const double B = a[0];
+      const double A = a[1];
+      const double sx = a[4];
+      const double sy = circular ? sx : a[5];
+      const double beta = gaussian ? 0.0 : a[m_ib];
+      const bool lorentzian = !gaussian && !fitBeta && beta == 1;
+      const double isx2 = 1/sx/sx;
+      const double isy2 = 1/sy/sy;
+      const double kth = isy2 - isx2;
+      double st = 0, ct = 1;
+      if ( !circular )
+         SinCos( a[6], st, ct );
+      const double xc = (m_w >> 1) + a[2];
+      const double yc = (m_h >> 1) + a[3];
+
+      const int n = m_n;
+      const int w = m_w;
+      double* J = m_J.Begin();
+      double* r = m_r.Begin();
+      double* JB = J;
+      double* JA = JB + w;
+      double* Jx = JA + w;
+      double* Jy = Jx + w;
+      double* Jsx = Jy + w;
+      double* Jsy = Jsx + w;
+      double* Jth = Jsy + w;
+      double* Jbeta = J + m_nb*w;
+
+      for ( int i = 0; i < w; ++i )
+         JB[i] = 1;
+
+      for ( int i = 0; i < n*n; ++i )
+         JtJ[i] = 0;
+      for ( int i = 0; i < n; ++i )
+         g[i] = 0;
+      ssr = 0;
+
+      for ( int y = 0; y < m_h; ++y )
+      {
+         const double dy = y - yc;
+         const double* s = m_S[y];
+
+         for ( int x = 0; x < w; ++x )
+         {
+            const double dx = x - xc;
+            double u, v, uu, vv, q;
+            if ( circular )
+            {
+               u = dx;
+               v = dy;
+               uu = u*isx2;
+               vv = v*isx2;
+            }
+            else
+            {
+               u = ct*dx - st*dy;
+               v = st*dx + ct*dy;
+               uu = u*isx2;
+               vv = v*isy2;
+            }
+            q = u*uu + v*vv;
+
+            double G, fq, fb = 0;
+            if ( gaussian )
+            {
+               G = Exp( -0.5*q );
+               fq = -0.5*A*G;
+            }
+            else if ( lorentzian )
+            {
+               G = 1/(1 + q);
+               fq = -A*G*G;
+            }
+            else
+            {
+               const double D = 1 + q;
+               const double L = Ln( D );
+               G = Exp( -beta*L );
+               fq = -A*beta*G/D;
+               if ( fitBeta )
+                  fb = -A*G*L;
+            }
+
+            r[x] = B + A*G - s[x];
+            JA[x] = G;
+            if ( circular )
+            {
+               Jx[x] = -2*fq*uu;
+               Jy[x] = -2*fq*vv;
+               Jsx[x] = -2*fq*q/sx;
+            }
+            else
+            {
+               Jx[x] = -2*fq*(uu*ct + vv*st);
+               Jy[x] = 2*fq*(uu*st - vv*ct);
+               Jsx[x] = -2*fq*u*uu/sx;
+               Jsy[x] = -2*fq*v*vv/sy;
+               Jth[x] = 2*fq*u*v*kth;
+            }
+            if ( fitBeta )
+               Jbeta[x] = fb;
+         }
+
+         for ( int i = 0; i < n; ++i )
+         {
+            const double* Ji = J + i*w;
+            g[i] += Dot( Ji, r, w );
+            for ( int j = i; j < n; ++j )
+               JtJ[i*n + j] += Dot( Ji, J + j*w, w );
+         }
+         ssr += Dot( r, r, w );
+      }
+
+      for ( int i = 1; i < n; ++i )
+         for ( int j = 0; j < i; ++j )
+            JtJ[i*n + j] = JtJ[j*n + i];
+   }
+
+   static double Dot( const double* a, const double* b, int n )
+   {
+      double s = 0;
+      for ( int i = 0; i < n; ++i )
+         s += a[i]*b[i];
+      return s;
+   }
+
+   /*
+    * In-place Cholesky decomposition and solution of a small symmetric
+    * positive definite system. Returns false if the matrix is not positive
+    * definite to working precision.
+    */
+   static bool CholeskySolve( double* M, double* b, int n )
+   {
+      for ( int j = 0; j < n; ++j )
+      {
+         double d = M[j*n + j];
+         for ( int k = 0; k < j; ++k )
+            d -= M[j*n + k]*M[j*n + k];
+         if ( !(d > 0) )
+            return false;
+         d = Sqrt( d );
+         M[j*n + j] = d;
+         for ( int i = j+1; i < n; ++i )
+         {
+            double s = M[i*n + j];
+            for ( int k = 0; k < j; ++k )
+               s -= M[i*n + k]*M[j*n + k];
+            M[i*n + j] = s/d;
+         }
+      }
+
+      for ( int i = 0; i < n; ++i )
+      {
+         double s = b[i];
+         for ( int k = 0; k < i; ++k )
+            s -= M[i*n + k]*b[k];
+         b[i] = s/M[i*n + i];
+      }
+      for ( int i = n; --i >= 0; )
+      {
+         double s = b[i];
+         for ( int k = i+1; k < n; ++k )
+            s -= M[k*n + i]*b[k];
+         b[i] = s/M[i*n + i];
+      }
+
+      return true;
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+PSFFitter::Status PSFFitter::Fit( Vector& P, const Matrix& S ) const
+{
+   if ( S.IsEmpty() )
+      return BadParameters;
+   return PCL_PSFFitEngine( *this, S ).Solve( P );
+}
+
+// ----------------------------------------------------------------------------
+
+class PCL_PSFFitThread : public Thread
+{
+public:
+
+   PCL_PSFFitThread( const PSFFitter& fitter, PSFFitter::problem_list& problems, int first, int step ) :
+      m_fitter( fitter ), m_problems( problems ), m_first( first ), m_step( step )
+   {
+   }
+
+   PCL_HOT_FUNCTION void Run() override
+   {
+      /*
+       * Problems are distributed by interleaving, which balances the workload
+       * among threads without synchronization when sampling regions have
+       * different sizes.
+       */
+      for ( size_type i = m_first; i < m_problems.Length(); i += m_step )
+      {
+         PSFFitter::Problem& p = m_problems[i];
+         p.status = m_fitter.Fit( p.P, p.S );
+      }
+   }
+
+private:
+
+   const PSFFitter&           m_fitter;
+   PSFFitter::problem_list&   m_problems;
+   int                        m_first;
+   int                        m_step;
+};
+
+void PSFFitter::Fit( problem_list& problems ) const
+{
+   if ( problems.IsEmpty() )
+      return;
+
+   int numberOfThreads = IsParallelProcessingEnabled() ?
+            Min( MaxProcessors(), pcl::Thread::NumberOfThreads( problems.Length(), 4 ) ) : 1;
+   if ( numberOfThreads > 1 )
+   {
+      ReferenceArray<PCL_PSFFitThread> threads;
+      for ( int i = 0; i < numberOfThreads; ++i )
+         threads << new PCL_PSFFitThread( *this, problems, i, numberOfThreads );
+      for ( int i = 0; i < numberOfThreads; ++i )
+         threads[i].Start( ThreadPriority::DefaultMax, i );
+      for ( int i = 0; i < numberOfThreads; ++i )
+         threads[i].Wait();
+      threads.Destroy();
+   }
+   else
+      PCL_PSFFitThread( *this, problems, 0, 1 ).Run();
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
+// EOF pcl/PSFFitter.cpp - Released 2019-01-21T12:06:21Z
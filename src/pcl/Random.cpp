@@ -498,7 +498,7 @@ int RandomNumberGenerator::Poisson( double lambda )
          m_lambda[0] = lambda;
          m_lambda[4] = Exp( -lambda );
       }
-      int k = -1;
+      int k = 0;
       for ( double p = 1; ; ++k )
          if ( (p *= Rand1()) <= m_lambda[4] )
             return k;
@@ -535,6 +535,347 @@ int RandomNumberGenerator::Poisson( double lambda )
 
 // ----------------------------------------------------------------------------
 
+/*
+ * The Philox4x32-10 generator computes BufferBlocks consecutive counter blocks
+ * at once. With SSE2, four blocks are processed in parallel, one per 32-bit
+ * vector lane, and two groups of four blocks are interleaved to hide the
+ * latency of vector multiplications. The result is identical to applying
+ * Bijection() to each block.
+ */
+#ifdef __PCL_HAVE_SSE2
+
+struct PhiloxLanes
+{
+   __m128i c0, c1, c2, c3;
+
+   void Initialize( uint64 block, uint64 stream )
+   {
+      c0 = _mm_set_epi32( int( uint32( block+3 ) ), int( uint32( block+2 ) ), int( uint32( block+1 ) ), int( uint32( block ) ) );
+      c1 = _mm_set_epi32( int( uint32( (block+3) >> 32 ) ), int( uint32( (block+2) >> 32 ) ),
+                          int( uint32( (block+1) >> 32 ) ), int( uint32( block >> 32 ) ) );
+      c2 = _mm_set1_epi32( int( uint32( stream ) ) );
+      c3 = _mm_set1_epi32( int( uint32( stream >> 32 ) ) );
+   }
+
+   void Round( __m128i k0, __m128i k1 )
+   {
+      const __m128i M0 = _mm_set1_epi32( int( 0xD2511F53u ) );
+      const __m128i M1 = _mm_set1_epi32( int( 0xCD9E8D57u ) );
+      const __m128i maskLo = _mm_set1_epi64x( 0x00000000FFFFFFFFll );
+
+      // 32x32 -> 64-bit products of even and odd lanes.
+      __m128i e0 = _mm_mul_epu32( c0, M0 );
+      __m128i o0 = _mm_mul_epu32( _mm_srli_epi64( c0, 32 ), M0 );
+      __m128i e1 = _mm_mul_epu32( c2, M1 );
+      __m128i o1 = _mm_mul_epu32( _mm_srli_epi64( c2, 32 ), M1 );
+      __m128i lo0 = _mm_or_si128( _mm_and_si128( e0, maskLo ), _mm_slli_epi64( o0, 32 ) );
+      __m128i hi0 = _mm_or_si128( _mm_srli_epi64( e0, 32 ), _mm_andnot_si128( maskLo, o0 ) );
+      __m128i lo1 = _mm_or_si128( _mm_and_si128( e1, maskLo ), _mm_slli_epi64( o1, 32 ) );
+      __m128i hi1 = _mm_or_si128( _mm_srli_epi64( e1, 32 ), _mm_andnot_si128( maskLo, o1 ) );
+      c0 = _mm_xor_si128( _mm_xor_si128( hi1, c1 ), k0 );
+      c1 = lo1;
+      c2 = _mm_xor_si128( _mm_xor_si128( hi0, c3 ), k1 );
+      c3 = lo0;
+   }
+
+   // Transpose lanes to four consecutive blocks.
+   void Store( uint32* buffer ) const
+   {
+      __m128i t0 = _mm_unpacklo_epi32( c0, c1 );
+      __m128i t1 = _mm_unpacklo_epi32( c2, c3 );
+      __m128i t2 = _mm_unpackhi_epi32( c0, c1 );
+      __m128i t3 = _mm_unpackhi_epi32( c2, c3 );
+      __m128i* b = reinterpret_cast<__m128i*>( buffer );
+      _mm_storeu_si128( b,   _mm_unpacklo_epi64( t0, t1 ) );
+      _mm_storeu_si128( b+1, _mm_unpackhi_epi64( t0, t1 ) );
+      _mm_storeu_si128( b+2, _mm_unpacklo_epi64( t2, t3 ) );
+      _mm_storeu_si128( b+3, _mm_unpackhi_epi64( t2, t3 ) );
+   }
+};
+
+#endif // __PCL_HAVE_SSE2
+
+void Philox4x32::Generate()
+{
+#ifdef __PCL_HAVE_SSE2
+   for ( int i = 0; i < BufferBlocks; i += 8 )
+   {
+      PhiloxLanes A, B;
+      A.Initialize( m_block + i, m_stream );
+      B.Initialize( m_block + i + 4, m_stream );
+      uint32 k0 = uint32( m_seed );
+      uint32 k1 = uint32( m_seed >> 32 );
+      for ( int r = 0; ; )
+      {
+         __m128i K0 = _mm_set1_epi32( int( k0 ) );
+         __m128i K1 = _mm_set1_epi32( int( k1 ) );
+         A.Round( K0, K1 );
+         B.Round( K0, K1 );
+         if ( ++r == 10 )
+            break;
+         k0 += 0x9E3779B9u;
+         k1 += 0xBB67AE85u;
+      }
+      A.Store( m_buffer + 4*i );
+      B.Store( m_buffer + 4*i + 16 );
+   }
+#else
+   uint32 key[ 2 ] = { uint32( m_seed ), uint32( m_seed >> 32 ) };
+   uint32 counter[ 4 ] = { 0, 0, uint32( m_stream ), uint32( m_stream >> 32 ) };
+   for ( int i = 0; i < BufferBlocks; ++i )
+   {
+      uint64 block = m_block + i;
+      counter[0] = uint32( block );
+      counter[1] = uint32( block >> 32 );
+      Bijection( m_buffer + 4*i, counter, key );
+   }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void Philox4x32::Uniform( double* x, size_type n )
+{
+   for ( size_type i = 0; i < n; )
+   {
+      if ( m_index < BufferLength-1 )
+      {
+         // Pairs of words available in the current buffer.
+         size_type m = pcl::Min( n - i, size_type( (BufferLength - m_index) >> 1 ) );
+         const uint32* b = m_buffer + m_index;
+         for ( size_type j = 0; j < m; ++j, b += 2 )
+            x[i+j] = 1.1102230246251565404236316680908203125e-16 * ((b[0] | (uint64( b[1] ) << 32)) >> 11);
+         m_index += int( m << 1 );
+         i += m;
+      }
+      else
+         x[i++] = operator()();
+   }
+}
+
+void Philox4x32::Uniform( float* x, size_type n )
+{
+   for ( size_type i = 0; i < n; )
+   {
+      if ( m_index == BufferLength )
+      {
+         m_block += BufferBlocks;
+         Generate();
+         m_index = 0;
+      }
+      size_type m = pcl::Min( n - i, size_type( BufferLength - m_index ) );
+      const uint32* b = m_buffer + m_index;
+      for ( size_type j = 0; j < m; ++j )
+         x[i+j] = 5.9604644775390625e-08F * (b[j] >> 8); // 2^-24
+      m_index += int( m );
+      i += m;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Ziggurat tables for the normal distribution with 128 layers, after
+ * Marsaglia and Tsang (2000).
+ */
+struct ZigguratNormalTables
+{
+   uint32 k[ 128 ];
+   double w[ 128 ];
+   double f[ 128 ];
+
+   ZigguratNormalTables()
+   {
+      const double m1 = 2147483648.0; // 2^31
+      const double vn = 9.91256303526217e-3;
+      double dn = 3.442619855899, tn = dn;
+      double q = vn/Exp( -0.5*dn*dn );
+      k[0] = uint32( (dn/q)*m1 );
+      k[1] = 0;
+      w[0] = q/m1;
+      w[127] = dn/m1;
+      f[0] = 1;
+      f[127] = Exp( -0.5*dn*dn );
+      for ( int i = 126; i >= 1; --i )
+      {
+         dn = Sqrt( -2*Ln( vn/dn + Exp( -0.5*dn*dn ) ) );
+         k[i+1] = uint32( (dn/tn)*m1 );
+         tn = dn;
+         f[i] = Exp( -0.5*dn*dn );
+         w[i] = dn/m1;
+      }
+   }
+
+   static const ZigguratNormalTables& Tables()
+   {
+      static ZigguratNormalTables tables;
+      return tables;
+   }
+};
+
+/*
+ * Uniform random deviate in the open interval (0,1).
+ */
+static inline double OpenUniform( Philox4x32& R )
+{
+   return 1.1102230246251565404236316680908203125e-16 * (double( R.UI64() >> 11 ) + 0.5);
+}
+
+/*
+ * Ziggurat standard normal deviate. The layer index and the signed abscissa
+ * are taken from independent bits of a 64-bit random integer.
+ */
+static inline double ZigguratNormal( Philox4x32& R, const ZigguratNormalTables& T )
+{
+   for ( ;; )
+   {
+      uint64 u = R.UI64();
+      int iz = int( u & 127 );
+      int32 hz = int32( uint32( u >> 32 ) );
+      uint32 ahz = (hz < 0) ? 0u - uint32( hz ) : uint32( hz );
+      double x = hz*T.w[iz];
+      if ( ahz < T.k[iz] )
+         return x;
+
+      if ( iz == 0 )
+      {
+         // Sample from the tail of the distribution.
+         const double r = 3.442619855899;
+         double y;
+         do
+         {
+            x = -Ln( OpenUniform( R ) )/r;
+            y = -Ln( OpenUniform( R ) );
+         }
+         while ( y+y < x*x );
+         return (hz > 0) ? r + x : -r - x;
+      }
+
+      // Sample from the wedge of the current layer.
+      if ( T.f[iz] + R()*(T.f[iz-1] - T.f[iz]) < Exp( -0.5*x*x ) )
+         return x;
+   }
+}
+
+double Philox4x32::StandardNormal()
+{
+   return ZigguratNormal( *this, ZigguratNormalTables::Tables() );
+}
+
+void Philox4x32::Normal( double* x, size_type n, double mean, double sigma )
+{
+   const ZigguratNormalTables& T = ZigguratNormalTables::Tables();
+   for ( size_type i = 0; i < n; ++i )
+      x[i] = mean + sigma*ZigguratNormal( *this, T );
+}
+
+void Philox4x32::Normal( float* x, size_type n, double mean, double sigma )
+{
+   const ZigguratNormalTables& T = ZigguratNormalTables::Tables();
+   for ( size_type i = 0; i < n; ++i )
+      x[i] = float( mean + sigma*ZigguratNormal( *this, T ) );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Poisson deviates: Knuth's multiplication method for small expected values,
+ * and H\"ormann's PTRS transformed rejection method otherwise.
+ */
+class PoissonDeviate
+{
+public:
+
+   void Initialize( double lambda )
+   {
+      m_lambda = lambda;
+      if ( m_lambda < 10 )
+         m_L = Exp( -m_lambda );
+      else
+      {
+         double slam = Sqrt( m_lambda );
+         m_logLambda = Ln( m_lambda );
+         m_b = 0.931 + 2.53*slam;
+         m_a = -0.059 + 0.02483*m_b;
+         m_logInvAlpha = Ln( 1.1239 + 1.1328/(m_b - 3.4) );
+         m_vr = 0.9277 - 3.6224/(m_b - 2);
+      }
+   }
+
+   double Lambda() const
+   {
+      return m_lambda;
+   }
+
+   double operator()( Philox4x32& R ) const
+   {
+      if ( m_lambda <= 0 )
+         return 0;
+
+      if ( m_lambda < 10 )
+      {
+         // 32-bit uniforms in (0,1) are accurate enough for the product.
+         int k = 0;
+         for ( double p = 1; ; ++k )
+            if ( (p *= (R.UI32() + 0.5)*2.3283064365386962890625e-10) <= m_L ) // 2^-32
+               return k;
+      }
+
+      for ( ;; )
+      {
+         double U = R() - 0.5;
+         double V = R();
+         double us = 0.5 - Abs( U );
+         if ( us <= 0 )
+            continue;
+         double k = Floor( (2*m_a/us + m_b)*U + m_lambda + 0.43 );
+         if ( us >= 0.07 && V <= m_vr )
+            return k;
+         if ( k < 0 || us < 0.013 && V > us )
+            continue;
+         if ( Ln( V ) + m_logInvAlpha - Ln( m_a/(us*us) + m_b ) <= -m_lambda + k*m_logLambda - LnGamma( k+1 ) )
+            return k;
+      }
+   }
+
+private:
+
+   double m_lambda = -1;
+   double m_L = 0, m_logLambda = 0, m_a = 0, m_b = 0, m_logInvAlpha = 0, m_vr = 0;
+};
+
+int Philox4x32::Poisson( double lambda )
+{
+   PoissonDeviate P;
+   P.Initialize( lambda );
+   return int( P( *this ) );
+}
+
+template <typename T>
+static void PoissonBlock( Philox4x32& R, T* x, size_type n )
+{
+   PoissonDeviate P;
+   for ( size_type i = 0; i < n; ++i )
+   {
+      // Avoid recalculation of constants for runs of equal expected values.
+      if ( double( x[i] ) != P.Lambda() )
+         P.Initialize( x[i] );
+      x[i] = T( P( R ) );
+   }
+}
+
+void Philox4x32::Poisson( double* x, size_type n )
+{
+   PoissonBlock( *this, x, n );
+}
+
+void Philox4x32::Poisson( float* x, size_type n )
+{
+   PoissonBlock( *this, x, n );
+}
+
+// ----------------------------------------------------------------------------
+
 } // pcl
 
 // ----------------------------------------------------------------------------
@@ -50,25 +50,136 @@
 // ----------------------------------------------------------------------------
 
 #include <pcl/AutoLock.h>
+#include <pcl/Exception.h>
 #include <pcl/ReadWriteMutex.h>
 
 #include <pcl/api/APIException.h>
 #include <pcl/api/APIInterface.h>
 
+#ifdef __PCL_UNIX
+# include <pthread.h>
+#endif
+
+#ifdef __PCL_WINDOWS
+# include <windows.h>
+#endif
+
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Native read/write lock, used when there is no PixInsight core application
+ * available (API == nullptr).
+ */
+struct ReadWriteMutex::NativeData
+{
+#ifdef __PCL_WINDOWS
+   SRWLOCK lock;
+   bool    exclusive = false;
+
+   NativeData()
+   {
+      ::InitializeSRWLock( &lock );
+   }
+
+   void LockForRead()
+   {
+      ::AcquireSRWLockShared( &lock );
+   }
+
+   void LockForWrite()
+   {
+      ::AcquireSRWLockExclusive( &lock );
+      exclusive = true;
+   }
+
+   bool TryLockForRead()
+   {
+      return ::TryAcquireSRWLockShared( &lock ) != FALSE;
+   }
+
+   bool TryLockForWrite()
+   {
+      if ( ::TryAcquireSRWLockExclusive( &lock ) == FALSE )
+         return false;
+      exclusive = true;
+      return true;
+   }
+
+   void Unlock()
+   {
+      // An exclusive lock excludes any other owner, so this flag is reliable.
+      if ( exclusive )
+      {
+         exclusive = false;
+         ::ReleaseSRWLockExclusive( &lock );
+      }
+      else
+         ::ReleaseSRWLockShared( &lock );
+   }
+#else
+   pthread_rwlock_t lock;
+
+   NativeData()
+   {
+      if ( ::pthread_rwlock_init( &lock, nullptr ) != 0 )
+         throw Error( "ReadWriteMutex: Unable to initialize a native read/write lock." );
+   }
+
+   ~NativeData()
+   {
+      (void)::pthread_rwlock_destroy( &lock );
+   }
+
+   void LockForRead()
+   {
+      (void)::pthread_rwlock_rdlock( &lock );
+   }
+
+   void LockForWrite()
+   {
+      (void)::pthread_rwlock_wrlock( &lock );
+   }
+
+   bool TryLockForRead()
+   {
+      return ::pthread_rwlock_tryrdlock( &lock ) == 0;
+   }
+
+   bool TryLockForWrite()
+   {
+      return ::pthread_rwlock_trywrlock( &lock ) == 0;
+   }
+
+   void Unlock()
+   {
+      (void)::pthread_rwlock_unlock( &lock );
+   }
+#endif
+};
+
+// ----------------------------------------------------------------------------
+
 ReadWriteMutex::ReadWriteMutex() :
-   UIObject( (*API->Mutex->CreateReadWriteMutex)( ModuleHandle(), this, 0/*flags*/ ) )
+   UIObject( (API != nullptr) ? (*API->Mutex->CreateReadWriteMutex)( ModuleHandle(), this, 0/*flags*/ ) : nullptr )
 {
-   if ( handle == 0 )
+   if ( API == nullptr )
+      m_native = new NativeData;
+   else if ( handle == 0 )
       throw APIFunctionError( "CreateReadWriteMutex" );
 }
 
 // ----------------------------------------------------------------------------
 
+ReadWriteMutex::~ReadWriteMutex()
+{
+   delete m_native, m_native = nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
 ReadWriteMutex& ReadWriteMutex::Null()
 {
    static ReadWriteMutex* nullMutex = nullptr;
@@ -83,20 +194,28 @@ ReadWriteMutex& ReadWriteMutex::Null()
 
 void ReadWriteMutex::LockForRead()
 {
-   (*API->Mutex->LockForRead)( handle, api_false );
+   if ( m_native != nullptr )
+      m_native->LockForRead();
+   else
+      (*API->Mutex->LockForRead)( handle, api_false );
 }
 
 // ----------------------------------------------------------------------------
 
 void ReadWriteMutex::LockForWrite()
 {
-   (*API->Mutex->LockForWrite)( handle, api_false );
+   if ( m_native != nullptr )
+      m_native->LockForWrite();
+   else
+      (*API->Mutex->LockForWrite)( handle, api_false );
 }
 
 // ----------------------------------------------------------------------------
 
 bool ReadWriteMutex::TryLockForRead()
 {
+   if ( m_native != nullptr )
+      return m_native->TryLockForRead();
    return (*API->Mutex->LockForRead)( handle, api_true ) != api_false;
 }
 
@@ -104,6 +223,8 @@ bool ReadWriteMutex::TryLockForRead()
 
 bool ReadWriteMutex::TryLockForWrite()
 {
+   if ( m_native != nullptr )
+      return m_native->TryLockForWrite();
    return (*API->Mutex->LockForWrite)( handle, api_true ) != api_false;
 }
 
@@ -111,7 +232,10 @@ bool ReadWriteMutex::TryLockForWrite()
 
 void ReadWriteMutex::Unlock()
 {
-   (*API->Mutex->Unlock)( handle );
+   if ( m_native != nullptr )
+      m_native->Unlock();
+   else
+      (*API->Mutex->Unlock)( handle );
 }
 
 // ----------------------------------------------------------------------------
@@ -142,6 +142,426 @@ void Resample::GetNewSizes( int& width, int& height ) const
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Separable resampling with Lanczos interpolation.
+ *
+ * For pure scaling, the interpolation coordinates of all pixels in an output
+ * column (resp. row) share the same horizontal (resp. vertical) filter
+ * weights. We precompute weight tables for output columns and rows once, then
+ * perform a horizontal pass on each required source row and accumulate the
+ * results vertically for each output row.
+ *
+ * Clamping is not separable in general, since it depends on the signs of the
+ * individual two-dimensional filter terms. However, for each source row the
+ * sign of a term is the sign of its horizontal product times the (constant)
+ * sign of the vertical weight, so it suffices to accumulate positive and
+ * negative horizontal partial sums, and their weights, separately. This
+ * reproduces the clamping behavior of LanczosInterpolation and
+ * LanczosLUTInterpolationBase exactly, up to roundoff errors.
+ */
+class PCL_SeparableResampleEngine
+{
+public:
+
+   struct Kernel
+   {
+      enum { Function, RealLUT, IntLUT };
+
+      int            n = 0;          // filter order
+      int            type = Function;
+      bool           clamp = false;  // clamping enabled?
+      double         clampTh = 0;    // clamping threshold
+      double         clampThInv = 1; // 1 - clampTh
+      const double** realLUT = nullptr;
+      const float*   intLUT = nullptr;
+
+      void SetClamping( float c )
+      {
+         clamp = c >= 0;
+         clampTh = Range( c, 0.0F, 1.0F );
+         clampThInv = 1 - clampTh;
+      }
+
+      static double Sinc( double x )
+      {
+         x *= Const<double>::pi();
+         return (x > 1.0e-07) ? Sin( x )/x : 1.0;
+      }
+
+      double Lanczos( double x ) const
+      {
+         if ( x < 0 )
+            x = -x;
+         if ( x < n )
+            return Sinc( x ) * Sinc( x/n );
+         return 0;
+      }
+
+      /*
+       * Filter weights for 2*n nodes at offsets -n+1,...,n, for an
+       * interpolation increment 0 <= d < 1. These are the same weights
+       * computed by the corresponding BidimensionalInterpolation classes.
+       */
+      void GetWeights( double* L, double d ) const
+      {
+         switch ( type )
+         {
+         case Function:
+            for ( int j = -n + 1, k = 0; j <= n; ++j, ++k )
+               L[k] = Lanczos( j - d );
+            break;
+         case RealLUT:
+            {
+               int dx = TruncInt( __PCL_LANCZOS_LUT_REAL_RESOLUTION*d );
+               for ( int k = 0; k < 2*n; ++k )
+                  L[k] = realLUT[k][dx];
+            }
+            break;
+         case IntLUT:
+            {
+               int dx = RoundInt( d*__PCL_LANCZOS_LUT_INT_RESOLUTION );
+               for ( int j = -n + 1, k = 0; j <= n; ++j, ++k )
+                  L[k] = intLUT[Abs( j*__PCL_LANCZOS_LUT_INT_RESOLUTION - dx )];
+            }
+            break;
+         }
+      }
+   };
+
+   /*
+    * Returns true iff the specified pixel interpolation can be applied by
+    * this engine to images of the specified pixel sample type.
+    */
+   template <class P>
+   static bool GetKernel( Kernel& K, const PixelInterpolation& interpolation )
+   {
+      if ( const LanczosPixelInterpolation* L = dynamic_cast<const LanczosPixelInterpolation*>( &interpolation ) )
+      {
+         K.n = Max( 1, L->FilterOrder() );
+         K.SetClamping( L->ClampingThreshold() );
+         // Same criterion as LanczosInterpolation::Default::UseLUT()
+         if ( P::BitsPerSample() < 32 || P::IsFloatSample() && P::BitsPerSample() == 32 )
+         {
+            K.type = Kernel::RealLUT;
+            K.realLUT = PCL_InitializeLanczosRealLUT( K.n );
+         }
+         else
+            K.type = Kernel::Function;
+         return true;
+      }
+
+      float clamp;
+      if ( const Lanczos3LUTPixelInterpolation* L = dynamic_cast<const Lanczos3LUTPixelInterpolation*>( &interpolation ) )
+         K.n = 3, clamp = L->ClampingThreshold();
+      else if ( const Lanczos4LUTPixelInterpolation* L = dynamic_cast<const Lanczos4LUTPixelInterpolation*>( &interpolation ) )
+         K.n = 4, clamp = L->ClampingThreshold();
+      else if ( const Lanczos5LUTPixelInterpolation* L = dynamic_cast<const Lanczos5LUTPixelInterpolation*>( &interpolation ) )
+         K.n = 5, clamp = L->ClampingThreshold();
+      else
+         return false;
+
+      K.SetClamping( clamp );
+      K.type = Kernel::IntLUT;
+      K.intLUT = PCL_InitializeLanczosIntLUT( K.n );
+      return true;
+   }
+
+   /*
+    * Source indices and filter weights for all pixels along one output axis.
+    * Source indices are mirrored at the borders, as in LanczosInterpolation.
+    */
+   struct AxisTable
+   {
+      int             m;      // filter length = 2*n
+      Array<int>      index;  // source indices, m per output pixel
+      Array<double>   weight; // filter weights, m per output pixel
+      Array<double>   sum;    // sum of filter weights for each output pixel
+
+      AxisTable( const Kernel& K, int length, int sourceLength, double ratio ) :
+         m( 2*K.n ),
+         index( size_type( length )*m ),
+         weight( size_type( length )*m ),
+         sum( size_type( length ) )
+      {
+         for ( int i = 0; i < length; ++i )
+         {
+            double x = i*ratio;
+            int x0 = Range( TruncInt( x ), 0, sourceLength-1 );
+            int*    ix = index.At( size_type( i )*m );
+            double* L = weight.At( size_type( i )*m );
+            K.GetWeights( L, x - x0 );
+            double s = 0;
+            for ( int j = -K.n + 1, k = 0; j <= K.n; ++j, ++k )
+            {
+               int xx = x0 + j;
+               if ( xx < 0 )
+                  xx = -xx;
+               else if ( xx >= sourceLength )
+                  xx = 2*sourceLength - 2 - xx;
+               ix[k] = Range( xx, 0, sourceLength-1 );
+               s += L[k];
+            }
+            sum[i] = s;
+         }
+      }
+   };
+
+   template <class P>
+   struct ThreadData : public AbstractImage::ThreadData
+   {
+      ThreadData( const Kernel& a_kernel, const AxisTable& a_columns, const AxisTable& a_rows,
+                  int a_width, int a_sourceWidth, bool a_unclipped, const StatusMonitor& a_status, size_type a_count ) :
+         AbstractImage::ThreadData( a_status, a_count ),
+         kernel( a_kernel ), columns( a_columns ), rows( a_rows ),
+         width( a_width ), sourceWidth( a_sourceWidth ), unclipped( a_unclipped )
+      {
+      }
+
+      const Kernel&                    kernel;
+      const AxisTable&                 columns;
+      const AxisTable&                 rows;
+            int                        width;
+            int                        sourceWidth;
+            bool                       unclipped;
+      const typename P::sample*        f0 = nullptr;
+            typename P::sample*        f = nullptr;
+   };
+
+   template <class P>
+   class Thread : public pcl::Thread
+   {
+   public:
+
+      Thread( ThreadData<P>& data, int firstRow, int endRow ) :
+         m_data( data ), m_firstRow( firstRow ), m_endRow( endRow )
+      {
+      }
+
+      PCL_HOT_FUNCTION void Run() override
+      {
+         INIT_THREAD_MONITOR()
+
+         const int width = m_data.width;
+         const int m = m_data.rows.m;
+         const bool clamp = m_data.kernel.clamp;
+
+         /*
+          * Horizontal pass components for each cached source row. Without
+          * clamping we only need the filtered row. With clamping we need
+          * positive and negative partial sums (Tp, Tn), their weights
+          * (Wp, Wn), and the weight of zero terms (Z).
+          */
+         const int nc = clamp ? 5 : 1;
+         const int cacheSize = 2*m;
+         const size_type rowSize = size_type( nc )*width;
+         Array<double> cache( cacheSize*rowSize );
+         Array<int> cachedRow( size_type( cacheSize ), -1 );
+         Array<size_type> lastUsed( size_type( cacheSize ), size_type( 0 ) );
+         Array<const double*> H( 2*m_data.kernel.n );
+         Array<double> acc( size_type( clamp ? 4 : 1 )*width );
+         size_type stamp = 0;
+
+         typename P::sample* f = m_data.f + size_type( m_firstRow )*size_type( width );
+
+         for ( int i = m_firstRow; i < m_endRow; ++i )
+         {
+            const int* iy = m_data.rows.index.At( size_type( i )*m );
+            const double* Ly = m_data.rows.weight.At( size_type( i )*m );
+
+            /*
+             * Gather horizontally filtered source rows, reusing those
+             * computed for previous output rows.
+             */
+            ++stamp;
+            for ( int k = 0; k < m; ++k )
+            {
+               int slot = -1;
+               for ( int s = 0; s < cacheSize; ++s )
+                  if ( cachedRow[s] == iy[k] )
+                  {
+                     slot = s;
+                     break;
+                  }
+               if ( slot < 0 )
+               {
+                  slot = 0;
+                  for ( int s = 1; s < cacheSize; ++s )
+                     if ( lastUsed[s] < lastUsed[slot] )
+                        slot = s;
+                  FilterRow( cache.At( slot*rowSize ), iy[k] );
+                  cachedRow[slot] = iy[k];
+               }
+               lastUsed[slot] = stamp;
+               H[k] = cache.At( slot*rowSize );
+            }
+
+            if ( clamp )
+            {
+               double* sp = acc.Begin();
+               double* sn = sp + width;
+               double* wp = sn + width;
+               double* wn = wp + width;
+               ::memset( sp, 0, 4*width*sizeof( double ) );
+
+               for ( int k = 0; k < m; ++k )
+               {
+                  double L = Ly[k];
+                  const double* Tp = H[k];
+                  const double* Tn = Tp + width;
+                  const double* Wp = Tn + width;
+                  const double* Wn = Wp + width;
+                  const double* Z  = Wn + width;
+                  if ( L > 0 )
+                  {
+                     for ( int j = 0; j < width; ++j )
+                     {
+                        sp[j] += Tp[j]*L;
+                        wp[j] += Wp[j]*L;
+                        sn[j] -= Tn[j]*L;
+                        wn[j] -= Wn[j]*L;
+                     }
+                  }
+                  else if ( L < 0 )
+                  {
+                     for ( int j = 0; j < width; ++j )
+                     {
+                        sn[j] -= Tp[j]*L;
+                        wn[j] -= (Wp[j] - Z[j])*L;
+                        sp[j] += Tn[j]*L;
+                        wp[j] += (Wn[j] + Z[j])*L;
+                     }
+                  }
+               }
+
+               for ( int j = 0; j < width; ++j, ++f )
+               {
+                  *f = ToSample( Clamped( sp[j], sn[j], wp[j], wn[j] ) );
+                  UPDATE_THREAD_MONITOR( 65536 )
+               }
+            }
+            else
+            {
+               double* s = acc.Begin();
+               ::memset( s, 0, width*sizeof( double ) );
+
+               for ( int k = 0; k < m; ++k )
+               {
+                  double L = Ly[k];
+                  const double* T = H[k];
+                  for ( int j = 0; j < width; ++j )
+                     s[j] += T[j]*L;
+               }
+
+               double wy = m_data.rows.sum[i];
+               const double* wx = m_data.columns.sum.Begin();
+               for ( int j = 0; j < width; ++j, ++f )
+               {
+                  *f = ToSample( s[j]/(wx[j]*wy) );
+                  UPDATE_THREAD_MONITOR( 65536 )
+               }
+            }
+         }
+      }
+
+   private:
+
+      ThreadData<P>& m_data;
+      int            m_firstRow;
+      int            m_endRow;
+
+      void FilterRow( double* H, int y ) const
+      {
+         const int width = m_data.width;
+         const int m = m_data.columns.m;
+         const typename P::sample* f = m_data.f0 + size_type( y )*size_type( m_data.sourceWidth );
+         const int* ix = m_data.columns.index.Begin();
+         const double* Lx = m_data.columns.weight.Begin();
+
+         if ( m_data.kernel.clamp )
+         {
+            double* Tp = H;
+            double* Tn = Tp + width;
+            double* Wp = Tn + width;
+            double* Wn = Wp + width;
+            double* Z  = Wn + width;
+            for ( int j = 0; j < width; ++j, ix += m, Lx += m )
+            {
+               double tp = 0, tn = 0, wp = 0, wn = 0, z = 0;
+               for ( int k = 0; k < m; ++k )
+               {
+                  double L = Lx[k];
+                  double t = double( f[ix[k]] )*L;
+                  if ( t < 0 )
+                     tn += t, wn += L;
+                  else
+                  {
+                     tp += t, wp += L;
+                     if ( t == 0 )
+                        z += L;
+                  }
+               }
+               Tp[j] = tp; Tn[j] = tn; Wp[j] = wp; Wn[j] = wn; Z[j] = z;
+            }
+         }
+         else
+         {
+            for ( int j = 0; j < width; ++j, ix += m, Lx += m )
+            {
+               double t = 0;
+               for ( int k = 0; k < m; ++k )
+                  t += double( f[ix[k]] )*Lx[k];
+               H[j] = t;
+            }
+         }
+      }
+
+      /*
+       * Clamped weighted convolution, as in LanczosInterpolation.
+       */
+      double Clamped( double sp, double sn, double wp, double wn ) const
+      {
+         // Empty data?
+         if ( sp == 0 )
+            return 0;
+
+         // Clamping ratio: s-/s+
+         double r = sn/sp;
+
+         // Clamp for s- >= s+
+         if ( r >= 1 )
+            return sp/wp;
+
+         // Clamp for c < s- < s+
+         if ( r > m_data.kernel.clampTh )
+         {
+            r = (r - m_data.kernel.clampTh)/m_data.kernel.clampThInv;
+            double c = 1 - r*r;
+            sn *= c, wn *= c;
+         }
+
+         // Weighted convolution
+         return (sp - sn)/(wp - wn);
+      }
+
+      /*
+       * Same conversion as PixelInterpolation::Interpolator.
+       */
+      typename P::sample ToSample( double r ) const
+      {
+         if ( !m_data.unclipped )
+         {
+            if ( r > P::MaxSampleValue() )
+               return P::MaxSampleValue();
+            if ( r < P::MinSampleValue() )
+               return P::MinSampleValue();
+         }
+         return P::FloatToSample( r );
+      }
+   };
+};
+
+// ----------------------------------------------------------------------------
+
 #if !defined( _MSC_VER ) && !defined( __clang__ )
 #pragma GCC push_options
 #pragma GCC optimize ("O2")
@@ -195,6 +615,40 @@ public:
                                                 + R.Interpolation().Description(), size_type( n )*N );
          f0 = image.ReleaseData();
 
+         PCL_SeparableResampleEngine::Kernel K;
+         if ( PCL_SeparableResampleEngine::GetKernel<P>( K, R.Interpolation() ) )
+         {
+            PCL_SeparableResampleEngine::AxisTable columns( K, width, w0, rx );
+            PCL_SeparableResampleEngine::AxisTable rows( K, height, h0, ry );
+
+            for ( int c = 0; c < n; ++c )
+            {
+               PCL_SeparableResampleEngine::ThreadData<P> data( K, columns, rows, width, w0,
+                                                         R.UsingUnclippedInterpolation(), status, N );
+               data.f0 = f0[c];
+               data.f = f = image.Allocator().AllocatePixels( width, height );
+
+               ReferenceArray<PCL_SeparableResampleEngine::Thread<P> > threads;
+               for ( int i = 0, j = 1; i < numberOfThreads; ++i, ++j )
+                  threads.Add( new PCL_SeparableResampleEngine::Thread<P>( data,
+                                                i*rowsPerThread,
+                                                (j < numberOfThreads) ? j*rowsPerThread : height ) );
+
+               AbstractImage::RunThreads( threads, data );
+
+               threads.Destroy();
+
+               image.Allocator().Deallocate( f0[c] );
+               f0[c] = f;
+               f = nullptr;
+
+               status = data.status;
+            }
+
+            image.ImportData( f0, width, height, n, cs0 ).Status() = status;
+            return;
+         }
+
          for ( int c = 0; c < n; ++c )
          {
             ThreadData<P> data( rx, ry, width, status, N );
@@ -51,17 +51,319 @@
 
 #include <pcl/Cryptography.h>
 #include <pcl/Exception.h>
+#include <pcl/Math.h>
 
-extern "C" {
-#include <RFC6234/sha.h>
-}
+#include <string.h>
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#  define __PCL_HAVE_SHA_INSTRUCTIONS   1
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define __PCL_SHA_TARGET( features )
+#  else
+#    include <immintrin.h>
+#    define __PCL_SHA_TARGET( features ) __attribute__ ((target( features )))
+#  endif
+#endif
 
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
-#define CTX reinterpret_cast<SHA1Context*>( m_context )
+/*
+ * SHA-1 hashing engine (FIPS 180-4).
+ *
+ * Message blocks are compressed directly from the input data whenever
+ * possible, with a portable implementation or, on x86_64 processors
+ * supporting the Intel SHA extensions, with the SHA-NI instructions. The
+ * implementation is selected at runtime.
+ */
+struct PCL_SHA1Context
+{
+   uint32 H[ 5 ];
+   uint64 length;       // total message length in bytes
+   uint8  buffer[ 64 ]; // pending partial block
+   size_type count;     // bytes in the pending partial block
+
+   void Reset()
+   {
+      H[0] = 0x67452301u;
+      H[1] = 0xEFCDAB89u;
+      H[2] = 0x98BADCFEu;
+      H[3] = 0x10325476u;
+      H[4] = 0xC3D2E1F0u;
+      length = 0;
+      count = 0;
+   }
+};
+
+static inline uint32 LoadBE32( const uint8* p )
+{
+   return (uint32( p[0] ) << 24) | (uint32( p[1] ) << 16) | (uint32( p[2] ) << 8) | uint32( p[3] );
+}
+
+static inline void StoreBE32( uint8* p, uint32 x )
+{
+   p[0] = uint8( x >> 24 );
+   p[1] = uint8( x >> 16 );
+   p[2] = uint8( x >>  8 );
+   p[3] = uint8( x );
+}
+
+static inline uint32 Rol32( uint32 x, int n )
+{
+   return (x << n) | (x >> (32 - n));
+}
+
+/*
+ * Portable compression function.
+ */
+static void SHA1Blocks( uint32* H, const uint8* p, size_type blocks )
+{
+   for ( ; blocks > 0; --blocks, p += 64 )
+   {
+      uint32 W[ 16 ];
+      for ( int t = 0; t < 16; ++t )
+         W[t] = LoadBE32( p + 4*t );
+
+      uint32 a = H[0], b = H[1], c = H[2], d = H[3], e = H[4];
+
+      for ( int t = 0; t < 80; ++t )
+      {
+         uint32 w;
+         if ( t < 16 )
+            w = W[t];
+         else
+            W[t & 15] = w = Rol32( W[(t+13) & 15] ^ W[(t+8) & 15] ^ W[(t+2) & 15] ^ W[t & 15], 1 );
+
+         uint32 f;
+         if ( t < 20 )
+            f = ((b & c) | (~b & d)) + 0x5A827999u;
+         else if ( t < 40 )
+            f = (b ^ c ^ d) + 0x6ED9EBA1u;
+         else if ( t < 60 )
+            f = ((b & c) | (b & d) | (c & d)) + 0x8F1BBCDCu;
+         else
+            f = (b ^ c ^ d) + 0xCA62C1D6u;
+
+         uint32 T = Rol32( a, 5 ) + f + e + w;
+         e = d;
+         d = c;
+         c = Rol32( b, 30 );
+         b = a;
+         a = T;
+      }
+
+      H[0] += a;
+      H[1] += b;
+      H[2] += c;
+      H[3] += d;
+      H[4] += e;
+   }
+}
+
+#ifdef __PCL_HAVE_SHA_INSTRUCTIONS
+
+/*
+ * Compression function using the Intel SHA extensions.
+ *
+ * Reference: S. Gulley et al., Intel SHA Extensions: New Instructions
+ * Supporting the Secure Hash Algorithm on Intel Architecture Processors,
+ * Intel Corporation, 2013.
+ */
+__PCL_SHA_TARGET( "sha,sse4.1" )
+static void SHA1BlocksSHANI( uint32* H, const uint8* p, size_type blocks )
+{
+   const __m128i mask = _mm_set_epi64x( 0x0001020304050607ll, 0x08090a0b0c0d0e0fll );
+
+   __m128i abcd = _mm_shuffle_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( H ) ), 0x1B );
+   __m128i e0 = _mm_set_epi32( int( H[4] ), 0, 0, 0 );
+
+   for ( ; blocks > 0; --blocks, p += 64 )
+   {
+      __m128i abcd0 = abcd;
+      __m128i e00 = e0;
+      __m128i e1, msg0, msg1, msg2, msg3;
+
+      // Rounds 0-3
+      msg0 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+0 ) ), mask );
+      e0 = _mm_add_epi32( e0, msg0 );
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 0 );
+
+      // Rounds 4-7
+      msg1 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+16 ) ), mask );
+      e1 = _mm_sha1nexte_epu32( e1, msg1 );
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 0 );
+      msg0 = _mm_sha1msg1_epu32( msg0, msg1 );
+
+      // Rounds 8-11
+      msg2 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+32 ) ), mask );
+      e0 = _mm_sha1nexte_epu32( e0, msg2 );
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 0 );
+      msg1 = _mm_sha1msg1_epu32( msg1, msg2 );
+      msg0 = _mm_xor_si128( msg0, msg2 );
+
+      // Rounds 12-15
+      msg3 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+48 ) ), mask );
+      e1 = _mm_sha1nexte_epu32( e1, msg3 );
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32( msg0, msg3 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 0 );
+      msg2 = _mm_sha1msg1_epu32( msg2, msg3 );
+      msg1 = _mm_xor_si128( msg1, msg3 );
+
+      // Rounds 16-19
+      e0 = _mm_sha1nexte_epu32( e0, msg0 );
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32( msg1, msg0 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 0 );
+      msg3 = _mm_sha1msg1_epu32( msg3, msg0 );
+      msg2 = _mm_xor_si128( msg2, msg0 );
+
+      // Rounds 20-23
+      e1 = _mm_sha1nexte_epu32( e1, msg1 );
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32( msg2, msg1 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 1 );
+      msg0 = _mm_sha1msg1_epu32( msg0, msg1 );
+      msg3 = _mm_xor_si128( msg3, msg1 );
+
+      // Rounds 24-27
+      e0 = _mm_sha1nexte_epu32( e0, msg2 );
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32( msg3, msg2 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 1 );
+      msg1 = _mm_sha1msg1_epu32( msg1, msg2 );
+      msg0 = _mm_xor_si128( msg0, msg2 );
+
+      // Rounds 28-31
+      e1 = _mm_sha1nexte_epu32( e1, msg3 );
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32( msg0, msg3 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 1 );
+      msg2 = _mm_sha1msg1_epu32( msg2, msg3 );
+      msg1 = _mm_xor_si128( msg1, msg3 );
+
+      // Rounds 32-35
+      e0 = _mm_sha1nexte_epu32( e0, msg0 );
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32( msg1, msg0 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 1 );
+      msg3 = _mm_sha1msg1_epu32( msg3, msg0 );
+      msg2 = _mm_xor_si128( msg2, msg0 );
+
+      // Rounds 36-39
+      e1 = _mm_sha1nexte_epu32( e1, msg1 );
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32( msg2, msg1 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 1 );
+      msg0 = _mm_sha1msg1_epu32( msg0, msg1 );
+      msg3 = _mm_xor_si128( msg3, msg1 );
+
+      // Rounds 40-43
+      e0 = _mm_sha1nexte_epu32( e0, msg2 );
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32( msg3, msg2 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 2 );
+      msg1 = _mm_sha1msg1_epu32( msg1, msg2 );
+      msg0 = _mm_xor_si128( msg0, msg2 );
+
+      // Rounds 44-47
+      e1 = _mm_sha1nexte_epu32( e1, msg3 );
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32( msg0, msg3 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 2 );
+      msg2 = _mm_sha1msg1_epu32( msg2, msg3 );
+      msg1 = _mm_xor_si128( msg1, msg3 );
+
+      // Rounds 48-51
+      e0 = _mm_sha1nexte_epu32( e0, msg0 );
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32( msg1, msg0 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 2 );
+      msg3 = _mm_sha1msg1_epu32( msg3, msg0 );
+      msg2 = _mm_xor_si128( msg2, msg0 );
+
+      // Rounds 52-55
+      e1 = _mm_sha1nexte_epu32( e1, msg1 );
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32( msg2, msg1 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 2 );
+      msg0 = _mm_sha1msg1_epu32( msg0, msg1 );
+      msg3 = _mm_xor_si128( msg3, msg1 );
+
+      // Rounds 56-59
+      e0 = _mm_sha1nexte_epu32( e0, msg2 );
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32( msg3, msg2 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 2 );
+      msg1 = _mm_sha1msg1_epu32( msg1, msg2 );
+      msg0 = _mm_xor_si128( msg0, msg2 );
+
+      // Rounds 60-63
+      e1 = _mm_sha1nexte_epu32( e1, msg3 );
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32( msg0, msg3 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 3 );
+      msg2 = _mm_sha1msg1_epu32( msg2, msg3 );
+      msg1 = _mm_xor_si128( msg1, msg3 );
+
+      // Rounds 64-67
+      e0 = _mm_sha1nexte_epu32( e0, msg0 );
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32( msg1, msg0 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 3 );
+      msg3 = _mm_sha1msg1_epu32( msg3, msg0 );
+      msg2 = _mm_xor_si128( msg2, msg0 );
+
+      // Rounds 68-71
+      e1 = _mm_sha1nexte_epu32( e1, msg1 );
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32( msg2, msg1 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 3 );
+      msg3 = _mm_xor_si128( msg3, msg1 );
+
+      // Rounds 72-75
+      e0 = _mm_sha1nexte_epu32( e0, msg2 );
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32( msg3, msg2 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 3 );
+
+      // Rounds 76-79
+      e1 = _mm_sha1nexte_epu32( e1, msg3 );
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 3 );
+      e0 = _mm_sha1nexte_epu32( e0, e00 );
+      abcd = _mm_add_epi32( abcd, abcd0 );
+   }
+
+   _mm_storeu_si128( reinterpret_cast<__m128i*>( H ), _mm_shuffle_epi32( abcd, 0x1B ) );
+   H[4] = uint32( _mm_extract_epi32( e0, 3 ) );
+}
+
+static const bool s_hasSHA = IsSHAInstructionSetSupported() && MaxSSEInstructionSetSupported() >= 41;
+
+#endif   // __PCL_HAVE_SHA_INSTRUCTIONS
+
+static void SHA1Compress( uint32* H, const uint8* p, size_type blocks )
+{
+#ifdef __PCL_HAVE_SHA_INSTRUCTIONS
+   if ( s_hasSHA )
+   {
+      SHA1BlocksSHANI( H, p, blocks );
+      return;
+   }
+#endif
+   SHA1Blocks( H, p, blocks );
+}
+
+// ----------------------------------------------------------------------------
+
+#define CTX reinterpret_cast<PCL_SHA1Context*>( m_context )
 
 SHA1::~SHA1()
 {
@@ -72,8 +374,8 @@ SHA1::~SHA1()
 void SHA1::Initialize()
 {
    if ( m_context == nullptr )
-      m_context = new SHA1Context;
-   SHA1Reset( CTX );
+      m_context = new PCL_SHA1Context;
+   CTX->Reset();
 }
 
 void SHA1::Update( const void* data, size_type size )
@@ -83,18 +385,39 @@ void SHA1::Update( const void* data, size_type size )
       {
          if ( m_context == nullptr )
          {
-            m_context = new SHA1Context;
-            SHA1Reset( CTX );
+            m_context = new PCL_SHA1Context;
+            CTX->Reset();
          }
+
          const uint8* bytes = reinterpret_cast<const uint8*>( data );
-         do
+         CTX->length += size;
+
+         if ( CTX->count > 0 )
          {
-            size_type blockSize = Min( size_type( 0xfffffff0 ), size );
-            SHA1Input( CTX, bytes, unsigned( blockSize ) );
-            size -= blockSize;
-            bytes += blockSize;
+            size_type n = Min( size_type( 64 ) - CTX->count, size );
+            ::memcpy( CTX->buffer + CTX->count, bytes, n );
+            CTX->count += n;
+            bytes += n;
+            size -= n;
+            if ( CTX->count < 64 )
+               return;
+            SHA1Compress( CTX->H, CTX->buffer, 1 );
+            CTX->count = 0;
+         }
+
+         if ( size >= 64 )
+         {
+            size_type blocks = size >> 6;
+            SHA1Compress( CTX->H, bytes, blocks );
+            bytes += blocks << 6;
+            size &= 63;
+         }
+
+         if ( size > 0 )
+         {
+            ::memcpy( CTX->buffer, bytes, size );
+            CTX->count = size;
          }
-         while ( size > 0 );
       }
 }
 
@@ -102,8 +425,25 @@ void SHA1::Finalize( void* hash )
 {
    if ( m_context == nullptr )
       throw Error( "SHA1::Finalize(): Invalid call on uninitialized object." );
-   SHA1Result( CTX, static_cast<uint8_t*>( hash ) );
-   SHA1Reset( CTX );
+
+   uint64 bits = CTX->length << 3;
+   CTX->buffer[CTX->count++] = 0x80;
+   if ( CTX->count > 56 )
+   {
+      ::memset( CTX->buffer + CTX->count, 0, 64 - CTX->count );
+      SHA1Compress( CTX->H, CTX->buffer, 1 );
+      CTX->count = 0;
+   }
+   ::memset( CTX->buffer + CTX->count, 0, 56 - CTX->count );
+   StoreBE32( CTX->buffer + 56, uint32( bits >> 32 ) );
+   StoreBE32( CTX->buffer + 60, uint32( bits ) );
+   SHA1Compress( CTX->H, CTX->buffer, 1 );
+
+   uint8* digest = static_cast<uint8*>( hash );
+   for ( int i = 0; i < 5; ++i )
+      StoreBE32( digest + 4*i, CTX->H[i] );
+
+   CTX->Reset();
 }
 
 // ----------------------------------------------------------------------------
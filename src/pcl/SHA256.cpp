@@ -4,7 +4,7 @@
 //  / ____// /___ / /___   PixInsight Class Library
 // /_/     \____//_____/   PCL 02.01.11.0938
 // ----------------------------------------------------------------------------
-// pcl/SHA256.cpp - Released 2019-01-21T12:06:21Z
+// pcl/SHA1.cpp - Released 2019-01-21T12:06:21Z
 // ----------------------------------------------------------------------------
 // This file is part of the PixInsight Class Library (PCL).
 // PCL is a multiplatform C++ framework for development of PixInsight modules.
@@ -51,17 +51,292 @@
 
 #include <pcl/Cryptography.h>
 #include <pcl/Exception.h>
+#include <pcl/Math.h>
 
-extern "C" {
-#include <RFC6234/sha.h>
-}
+#include <string.h>
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#  define __PCL_HAVE_SHA_INSTRUCTIONS   1
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define __PCL_SHA_TARGET( features )
+#  else
+#    include <immintrin.h>
+#    define __PCL_SHA_TARGET( features ) __attribute__ ((target( features )))
+#  endif
+#endif
 
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
-#define CTX reinterpret_cast<SHA256Context*>( m_context )
+/*
+ * SHA-256 hashing engine (FIPS 180-4).
+ *
+ * Message blocks are compressed directly from the input data whenever
+ * possible, with a portable implementation or, on x86_64 processors
+ * supporting the Intel SHA extensions, with the SHA-NI instructions. The
+ * implementation is selected at runtime.
+ */
+struct PCL_SHA256Context
+{
+   uint32 H[ 8 ];
+   uint64 length;       // total message length in bytes
+   uint8  buffer[ 64 ]; // pending partial block
+   size_type count;     // bytes in the pending partial block
+
+   void Reset()
+   {
+      H[0] = 0x6A09E667u;
+      H[1] = 0xBB67AE85u;
+      H[2] = 0x3C6EF372u;
+      H[3] = 0xA54FF53Au;
+      H[4] = 0x510E527Fu;
+      H[5] = 0x9B05688Cu;
+      H[6] = 0x1F83D9ABu;
+      H[7] = 0x5BE0CD19u;
+      length = 0;
+      count = 0;
+   }
+};
+
+alignas( 16 ) static const uint32 K[ 64 ] =
+{
+   0x428A2F98u, 0x71374491u, 0xB5C0FBCFu, 0xE9B5DBA5u, 0x3956C25Bu, 0x59F111F1u, 0x923F82A4u, 0xAB1C5ED5u,
+   0xD807AA98u, 0x12835B01u, 0x243185BEu, 0x550C7DC3u, 0x72BE5D74u, 0x80DEB1FEu, 0x9BDC06A7u, 0xC19BF174u,
+   0xE49B69C1u, 0xEFBE4786u, 0x0FC19DC6u, 0x240CA1CCu, 0x2DE92C6Fu, 0x4A7484AAu, 0x5CB0A9DCu, 0x76F988DAu,
+   0x983E5152u, 0xA831C66Du, 0xB00327C8u, 0xBF597FC7u, 0xC6E00BF3u, 0xD5A79147u, 0x06CA6351u, 0x14292967u,
+   0x27B70A85u, 0x2E1B2138u, 0x4D2C6DFCu, 0x53380D13u, 0x650A7354u, 0x766A0ABBu, 0x81C2C92Eu, 0x92722C85u,
+   0xA2BFE8A1u, 0xA81A664Bu, 0xC24B8B70u, 0xC76C51A3u, 0xD192E819u, 0xD6990624u, 0xF40E3585u, 0x106AA070u,
+   0x19A4C116u, 0x1E376C08u, 0x2748774Cu, 0x34B0BCB5u, 0x391C0CB3u, 0x4ED8AA4Au, 0x5B9CCA4Fu, 0x682E6FF3u,
+   0x748F82EEu, 0x78A5636Fu, 0x84C87814u, 0x8CC70208u, 0x90BEFFFAu, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u
+};
+
+static inline uint32 LoadBE32( const uint8* p )
+{
+   return (uint32( p[0] ) << 24) | (uint32( p[1] ) << 16) | (uint32( p[2] ) << 8) | uint32( p[3] );
+}
+
+static inline void StoreBE32( uint8* p, uint32 x )
+{
+   p[0] = uint8( x >> 24 );
+   p[1] = uint8( x >> 16 );
+   p[2] = uint8( x >>  8 );
+   p[3] = uint8( x );
+}
+
+static inline uint32 Ror32( uint32 x, int n )
+{
+   return (x >> n) | (x << (32 - n));
+}
+
+/*
+ * Portable compression function.
+ */
+static void SHA256Blocks( uint32* H, const uint8* p, size_type blocks )
+{
+   for ( ; blocks > 0; --blocks, p += 64 )
+   {
+      uint32 W[ 64 ];
+      for ( int t = 0; t < 16; ++t )
+         W[t] = LoadBE32( p + 4*t );
+      for ( int t = 16; t < 64; ++t )
+      {
+         uint32 s0 = Ror32( W[t-15], 7 ) ^ Ror32( W[t-15], 18 ) ^ (W[t-15] >> 3);
+         uint32 s1 = Ror32( W[t-2], 17 ) ^ Ror32( W[t-2], 19 ) ^ (W[t-2] >> 10);
+         W[t] = W[t-16] + s0 + W[t-7] + s1;
+      }
+
+      uint32 a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];
+
+      for ( int t = 0; t < 64; ++t )
+      {
+         uint32 T1 = h + (Ror32( e, 6 ) ^ Ror32( e, 11 ) ^ Ror32( e, 25 )) + ((e & f) ^ (~e & g)) + K[t] + W[t];
+         uint32 T2 = (Ror32( a, 2 ) ^ Ror32( a, 13 ) ^ Ror32( a, 22 )) + ((a & b) ^ (a & c) ^ (b & c));
+         h = g;
+         g = f;
+         f = e;
+         e = d + T1;
+         d = c;
+         c = b;
+         b = a;
+         a = T1 + T2;
+      }
+
+      H[0] += a;
+      H[1] += b;
+      H[2] += c;
+      H[3] += d;
+      H[4] += e;
+      H[5] += f;
+      H[6] += g;
+      H[7] += h;
+   }
+}
+
+#ifdef __PCL_HAVE_SHA_INSTRUCTIONS
+
+/*
+ * Compression function using the Intel SHA extensions.
+ *
+ * Reference: S. Gulley et al., Intel SHA Extensions: New Instructions
+ * Supporting the Secure Hash Algorithm on Intel Architecture Processors,
+ * Intel Corporation, 2013.
+ */
+__PCL_SHA_TARGET( "sha,sse4.1" )
+static void SHA256BlocksSHANI( uint32* H, const uint8* p, size_type blocks )
+{
+   const __m128i mask = _mm_set_epi64x( 0x0c0d0e0f08090a0bll, 0x0405060700010203ll );
+
+   // Rearrange the state words as required by SHA256RNDS2.
+   __m128i tmp = _mm_shuffle_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( H ) ), 0xB1 );    // CDAB
+   __m128i state1 = _mm_shuffle_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( H+4 ) ), 0x1B ); // EFGH
+   __m128i state0 = _mm_alignr_epi8( tmp, state1, 8 );    // ABEF
+   state1 = _mm_blend_epi16( state1, tmp, 0xF0 );         // CDGH
+
+   for ( ; blocks > 0; --blocks, p += 64 )
+   {
+      __m128i abef = state0;
+      __m128i cdgh = state1;
+      __m128i msg, msg0, msg1, msg2, msg3;
+
+      // Rounds 0-3
+      msg0 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+0 ) ), mask );
+      msg = _mm_add_epi32( msg0, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+0 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+
+      // Rounds 4-7
+      msg1 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+16 ) ), mask );
+      msg = _mm_add_epi32( msg1, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+4 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+      // Rounds 8-11
+      msg2 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+32 ) ), mask );
+      msg = _mm_add_epi32( msg2, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+8 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+      // Rounds 12-15
+      msg3 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p+48 ) ), mask );
+      msg = _mm_add_epi32( msg3, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+12 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg0 = _mm_sha256msg2_epu32( _mm_add_epi32( msg0, _mm_alignr_epi8( msg3, msg2, 4 ) ), msg3 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+      // Rounds 16-19
+      msg = _mm_add_epi32( msg0, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+16 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg1 = _mm_sha256msg2_epu32( _mm_add_epi32( msg1, _mm_alignr_epi8( msg0, msg3, 4 ) ), msg0 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+      // Rounds 20-23
+      msg = _mm_add_epi32( msg1, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+20 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg2 = _mm_sha256msg2_epu32( _mm_add_epi32( msg2, _mm_alignr_epi8( msg1, msg0, 4 ) ), msg1 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+      // Rounds 24-27
+      msg = _mm_add_epi32( msg2, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+24 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg3 = _mm_sha256msg2_epu32( _mm_add_epi32( msg3, _mm_alignr_epi8( msg2, msg1, 4 ) ), msg2 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+      // Rounds 28-31
+      msg = _mm_add_epi32( msg3, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+28 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg0 = _mm_sha256msg2_epu32( _mm_add_epi32( msg0, _mm_alignr_epi8( msg3, msg2, 4 ) ), msg3 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+      // Rounds 32-35
+      msg = _mm_add_epi32( msg0, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+32 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg1 = _mm_sha256msg2_epu32( _mm_add_epi32( msg1, _mm_alignr_epi8( msg0, msg3, 4 ) ), msg0 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+      // Rounds 36-39
+      msg = _mm_add_epi32( msg1, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+36 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg2 = _mm_sha256msg2_epu32( _mm_add_epi32( msg2, _mm_alignr_epi8( msg1, msg0, 4 ) ), msg1 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+      // Rounds 40-43
+      msg = _mm_add_epi32( msg2, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+40 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg3 = _mm_sha256msg2_epu32( _mm_add_epi32( msg3, _mm_alignr_epi8( msg2, msg1, 4 ) ), msg2 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+      // Rounds 44-47
+      msg = _mm_add_epi32( msg3, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+44 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg0 = _mm_sha256msg2_epu32( _mm_add_epi32( msg0, _mm_alignr_epi8( msg3, msg2, 4 ) ), msg3 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+      // Rounds 48-51
+      msg = _mm_add_epi32( msg0, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+48 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg1 = _mm_sha256msg2_epu32( _mm_add_epi32( msg1, _mm_alignr_epi8( msg0, msg3, 4 ) ), msg0 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+      // Rounds 52-55
+      msg = _mm_add_epi32( msg1, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+52 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg2 = _mm_sha256msg2_epu32( _mm_add_epi32( msg2, _mm_alignr_epi8( msg1, msg0, 4 ) ), msg1 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+
+      // Rounds 56-59
+      msg = _mm_add_epi32( msg2, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+56 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg3 = _mm_sha256msg2_epu32( _mm_add_epi32( msg3, _mm_alignr_epi8( msg2, msg1, 4 ) ), msg2 );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+
+      // Rounds 60-63
+      msg = _mm_add_epi32( msg3, _mm_loadu_si128( reinterpret_cast<const __m128i*>( K+60 ) ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( msg, 0x0E ) );
+      state0 = _mm_add_epi32( state0, abef );
+      state1 = _mm_add_epi32( state1, cdgh );
+   }
+
+   tmp = _mm_shuffle_epi32( state0, 0x1B );               // FEBA
+   state1 = _mm_shuffle_epi32( state1, 0xB1 );            // DCHG
+   _mm_storeu_si128( reinterpret_cast<__m128i*>( H ), _mm_blend_epi16( tmp, state1, 0xF0 ) );   // DCBA
+   _mm_storeu_si128( reinterpret_cast<__m128i*>( H+4 ), _mm_alignr_epi8( state1, tmp, 8 ) );    // HGFE
+}
+
+static const bool s_hasSHA = IsSHAInstructionSetSupported() && MaxSSEInstructionSetSupported() >= 41;
+
+#endif   // __PCL_HAVE_SHA_INSTRUCTIONS
+
+static void SHA256Compress( uint32* H, const uint8* p, size_type blocks )
+{
+#ifdef __PCL_HAVE_SHA_INSTRUCTIONS
+   if ( s_hasSHA )
+   {
+      SHA256BlocksSHANI( H, p, blocks );
+      return;
+   }
+#endif
+   SHA256Blocks( H, p, blocks );
+}
+
+// ----------------------------------------------------------------------------
+
+#define CTX reinterpret_cast<PCL_SHA256Context*>( m_context )
 
 SHA256::~SHA256()
 {
@@ -72,8 +347,8 @@ SHA256::~SHA256()
 void SHA256::Initialize()
 {
    if ( m_context == nullptr )
-      m_context = new SHA256Context;
-   SHA256Reset( CTX );
+      m_context = new PCL_SHA256Context;
+   CTX->Reset();
 }
 
 void SHA256::Update( const void* data, size_type size )
@@ -83,18 +358,39 @@ void SHA256::Update( const void* data, size_type size )
       {
          if ( m_context == nullptr )
          {
-            m_context = new SHA256Context;
-            SHA256Reset( CTX );
+            m_context = new PCL_SHA256Context;
+            CTX->Reset();
          }
+
          const uint8* bytes = reinterpret_cast<const uint8*>( data );
-         do
+         CTX->length += size;
+
+         if ( CTX->count > 0 )
+         {
+            size_type n = Min( size_type( 64 ) - CTX->count, size );
+            ::memcpy( CTX->buffer + CTX->count, bytes, n );
+            CTX->count += n;
+            bytes += n;
+            size -= n;
+            if ( CTX->count < 64 )
+               return;
+            SHA256Compress( CTX->H, CTX->buffer, 1 );
+            CTX->count = 0;
+         }
+
+         if ( size >= 64 )
+         {
+            size_type blocks = size >> 6;
+            SHA256Compress( CTX->H, bytes, blocks );
+            bytes += blocks << 6;
+            size &= 63;
+         }
+
+         if ( size > 0 )
          {
-            size_type blockSize = Min( size_type( 0xfffffff0 ), size );
-            SHA256Input( CTX, bytes, unsigned( blockSize ) );
-            size -= blockSize;
-            bytes += blockSize;
+            ::memcpy( CTX->buffer, bytes, size );
+            CTX->count = size;
          }
-         while ( size > 0 );
       }
 }
 
@@ -102,8 +398,25 @@ void SHA256::Finalize( void* hash )
 {
    if ( m_context == nullptr )
       throw Error( "SHA256::Finalize(): Invalid call on uninitialized object." );
-   SHA256Result( CTX, static_cast<uint8_t*>( hash ) );
-   SHA256Reset( CTX );
+
+   uint64 bits = CTX->length << 3;
+   CTX->buffer[CTX->count++] = 0x80;
+   if ( CTX->count > 56 )
+   {
+      ::memset( CTX->buffer + CTX->count, 0, 64 - CTX->count );
+      SHA256Compress( CTX->H, CTX->buffer, 1 );
+      CTX->count = 0;
+   }
+   ::memset( CTX->buffer + CTX->count, 0, 56 - CTX->count );
+   StoreBE32( CTX->buffer + 56, uint32( bits >> 32 ) );
+   StoreBE32( CTX->buffer + 60, uint32( bits ) );
+   SHA256Compress( CTX->H, CTX->buffer, 1 );
+
+   uint8* digest = static_cast<uint8*>( hash );
+   for ( int i = 0; i < 8; ++i )
+      StoreBE32( digest + 4*i, CTX->H[i] );
+
+   CTX->Reset();
 }
 
 // ----------------------------------------------------------------------------
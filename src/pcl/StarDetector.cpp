@@ -0,0 +1,541 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/StarDetector.cpp - Released 2019-01-21T12:06:21Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#include <pcl/ATrousWaveletTransform.h>
+#include <pcl/GaussianFilter.h>
+#include <pcl/Matrix.h>
+#include <pcl/MorphologicalTransformation.h>
+#include <pcl/ReferenceArray.h>
+#include <pcl/SeparableConvolution.h>
+#include <pcl/StarDetector.h>
+#include <pcl/Thread.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*
+ * 5x5 B3-spline wavelet scaling function used for noise estimation, as a
+ * separable filter, and the corresponding Gaussian noise scaling factors.
+ */
+static const float s_5x5B3Spline_hv[] = { 0.0625F, 0.25F, 0.375F, 0.25F, 0.0625F };
+static const float s_5x5B3Spline_kj[] =
+   { 0.8907F, 0.2007F, 0.0856F, 0.0413F, 0.0205F, 0.0103F, 0.0052F, 0.0026F, 0.0013F, 0.0007F };
+
+// ----------------------------------------------------------------------------
+
+void StarDetector::HotPixelFilter( Image& image ) const
+{
+   if ( m_hotPixelFilterRadius > 0 )
+   {
+      MorphologicalTransformation M;
+      M.SetOperator( MedianFilter() );
+      if ( m_hotPixelFilterRadius > 1 )
+         M.SetStructure( CircularStructure( 2*m_hotPixelFilterRadius + 1 ) );
+      else
+         M.SetStructure( BoxStructure( 3 ) );
+      M.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+      M >> image;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+Image StarDetector::WorkingImage( const ImageVariant& image ) const
+{
+   Image working;
+   working.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+   {
+      ImageVariant v( &working );
+      image.GetIntensity( v, Rect( 0 ), IsParallelProcessingEnabled() ? MaxProcessors() : 1 );
+   }
+
+   /*
+    * When noise reduction is enabled, always remove hot pixels first, or hot
+    * pixels would be promoted to stars.
+    */
+   if ( m_hotPixelFilter || m_noiseReductionFilterRadius > 0 )
+      HotPixelFilter( working );
+
+   if ( m_noiseReductionFilterRadius > 0 )
+   {
+      SeparableConvolution C( GaussianFilter( (m_noiseReductionFilterRadius << 1)|1 ).AsSeparableFilter() );
+      C.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+      C >> working;
+   }
+
+   return working;
+}
+
+// ----------------------------------------------------------------------------
+
+Image StarDetector::StructureMap( const Image& workingImage ) const
+{
+   Image map( workingImage );
+   map.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+
+   if ( !m_hotPixelFilter && m_noiseReductionFilterRadius == 0 )
+      HotPixelFilter( map );
+
+   // Noise reduction with a low-pass filter
+   if ( m_noiseLayers > 0 )
+   {
+      SeparableConvolution C( GaussianFilter( 1 + (1 << m_noiseLayers) ).AsSeparableFilter() );
+      C.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+      C >> map;
+   }
+
+   // Flatten the image with a high-pass filter
+   {
+      Image highPass( map );
+      SeparableConvolution C( GaussianFilter( 1 + (1 << m_structureLayers) ).AsSeparableFilter() );
+      C.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+      C >> highPass;
+      map -= highPass;
+      map.Truncate();
+      map.Rescale();
+   }
+
+   // Strengthen the smallest structures with a dilation filter
+   {
+      MorphologicalTransformation M( DilationFilter(), BoxStructure( 3 ) );
+      M.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+      M >> map;
+   }
+
+   // Adaptive binarization based on noise evaluation
+   double median = map.Median();
+   if ( 1 + median == 1 )
+   {
+      // Black background - probably a synthetic star field
+      map.EnableRangeClipping();
+      map.SetRangeClipping( 0, 1 );
+      median = map.Median();
+      map.Binarize( median + map.MAD( median ) );
+      map.DisableRangeClipping();
+   }
+   else
+   {
+      // A natural image. Only the second wavelet layer is required.
+      ATrousWaveletTransform W( SeparableFilter( s_5x5B3Spline_hv, s_5x5B3Spline_hv, 5 ), 2 );
+      W.DisableLayer( 0 );
+      W.EnableParallelProcessing( IsParallelProcessingEnabled(), MaxProcessors() );
+      W << map;
+      double noise = W.NoiseKSigma( 1 )/s_5x5B3Spline_kj[1];
+      map.Binarize( median + 3*noise );
+   }
+
+   return map;
+}
+
+// ----------------------------------------------------------------------------
+
+class PCL_StarDetectorThread : public Thread
+{
+public:
+
+   typedef Array<uint64>   seed_list;
+
+   PCL_StarDetectorThread( const StarDetector& detector, const Image& image, const Image& map,
+                           const Array<Rect>& tiles, Array<StarDetector::StarList>& stars, Array<seed_list>& clipped,
+                           int first, int step ) :
+      m_detector( detector ), m_image( image ), m_map( map ), m_tiles( tiles ), m_stars( stars ), m_clipped( clipped ),
+      m_first( first ), m_step( step )
+   {
+   }
+
+   PCL_HOT_FUNCTION void Run() override
+   {
+      /*
+       * Tiles are distributed by interleaving. Each tile has its own output
+       * list, so the results don't depend on the order of execution.
+       */
+      for ( size_type i = m_first; i < m_tiles.Length(); i += m_step )
+         ScanTile( m_tiles[i], m_stars[i], m_clipped[i] );
+   }
+
+   /*
+    * Scans the whole structure map and evaluates only the structures seeded
+    * at the specified pixels, which must be sorted in ascending order.
+    */
+   void ScanSeeds( const seed_list& seeds, StarDetector::StarList& stars )
+   {
+      seed_list unused;
+      m_seeds = &seeds;
+      ScanTile( m_map.Bounds(), stars, unused );
+      m_seeds = nullptr;
+   }
+
+private:
+
+   const StarDetector&            m_detector;
+   const Image&                   m_image;
+   const Image&                   m_map;
+   const Array<Rect>&             m_tiles;
+   Array<StarDetector::StarList>& m_stars;
+   Array<seed_list>&              m_clipped;
+   int                            m_first;
+   int                            m_step;
+   const seed_list*               m_seeds = nullptr;
+
+   Array<uint8>                   m_M;          // binarized map of the extended tile
+   Array<Point>                   m_points;     // pixels of the current structure
+   Array<float>                   m_samples;    // local background samples
+
+   void ScanTile( const Rect& tile, StarDetector::StarList& stars, seed_list& clipped )
+   {
+      int W = m_map.Width();
+      int H = m_map.Height();
+
+      // The extended tile. Structures touching its boundaries are deferred,
+      // except at image borders, where the usual rejection criteria apply.
+      // Structures seeded above this tile can only extend downward, so
+      // the top boundary never clips a structure seeded on the tile.
+      Rect E = tile.InflatedBy( m_detector.m_tileOverlap ).Intersection( m_map.Bounds() );
+      int w = E.Width();
+      int h = E.Height();
+      bool clipLeft = E.x0 > 0;
+      bool clipRight = E.x1 < W;
+      bool clipBottom = E.y1 < H;
+
+      // The tile in local coordinates.
+      int cx0 = tile.x0 - E.x0;
+      int cy0 = tile.y0 - E.y0;
+      int cx1 = tile.x1 - E.x0;
+      int cy1 = tile.y1 - E.y0;
+
+      m_M.Clear();
+      m_M.Reserve( size_type( w )*size_type( h ) );
+      for ( int y = E.y0; y < E.y1; ++y )
+      {
+         const float* f = m_map.PixelAddress( E.x0, y );
+         for ( int x = 0; x < w; ++x )
+            m_M.Append( uint8( f[x] != 0 ) );
+      }
+      uint8* M = m_M.Begin();
+
+      // Structure scanner. Structures seeded below this tile cannot modify
+      // structures seeded on it, so the scan stops at its bottom boundary.
+      for ( int y0 = 0, x1 = w-1, y1 = h-1; y0 < y1 && y0 < cy1; ++y0 )
+         for ( int x0 = 0; x0 < x1; ++x0 )
+         {
+            // Exclude background pixels and already visited pixels
+            if ( M[y0*w + x0] == 0 )
+               continue;
+
+            m_points.Clear();
+
+            // Structure bounding rectangle
+            Rect r( x0, y0, x0+1, y0+1 );
+
+            // Grow the structure region downward
+            for ( int y = y0, x = x0, xa, xb; ; )
+            {
+               const uint8* m = M + y*w;
+
+               m_points.Append( Point( x, y ) );
+
+               // Explore the left segment of this row
+               for ( xa = x; xa > 0 && m[xa-1] != 0; )
+                  m_points.Append( Point( --xa, y ) );
+
+               // Explore the right segment of this row
+               for ( xb = x; xb < x1 && m[xb+1] != 0; )
+                  m_points.Append( Point( ++xb, y ) );
+
+               if ( xa < r.x0 )
+                  r.x0 = xa;
+               if ( xb >= r.x1 )
+                  r.x1 = xb + 1;
+
+               // Continue with the next row if it has at least one nonzero
+               // map pixel below this row segment.
+               ++y;
+               m += w;
+               for ( x = xa; x <= xb; ++x )
+                  if ( m[x] != 0 )
+                     break;
+               if ( x > xb )
+                  break;
+
+               r.y1 = y + 1;
+
+               if ( y == y1 )
+                  break;
+            }
+
+            // Erase this structure.
+            for ( const Point& p : m_points )
+               M[p.y*w + p.x] = 0;
+
+            /*
+             * Only structures seeded on this tile are reported, so each
+             * structure is evaluated by a single tile. Structures seeded on
+             * the extended region have been scanned just to erase their
+             * pixels, as would happen in a serial scan of the whole map.
+             */
+            if ( x0 < cx0 || x0 >= cx1 || y0 < cy0 || y0 >= cy1 )
+               continue;
+
+            /*
+             * Structures clipped by the extended tile cannot be evaluated
+             * here. Their seeds are stored to scan them on the whole map.
+             */
+            uint64 seed = uint64( y0 + E.y0 )*uint64( W ) + uint64( x0 + E.x0 );
+            if ( r.x0 == 0 && clipLeft || r.x1 == w && clipRight || r.y1 == h && clipBottom )
+            {
+               clipped << seed;
+               continue;
+            }
+            if ( m_seeds != nullptr )
+               if ( pcl::BinarySearch( m_seeds->Begin(), m_seeds->End(), seed ) == m_seeds->End() )
+                  continue;
+
+            Rect rect = r.MovedBy( E.x0, E.y0 );
+            for ( Point& p : m_points )
+               p.MoveBy( E.x0, E.y0 );
+
+            /*
+             * Rejection criteria:
+             *
+             * - Too small structures, which mainly prevents inclusion of hot
+             *   and cold pixels.
+             *
+             * - Structures touching a border of the image, where an accurate
+             *   position cannot be computed.
+             *
+             * - Too distorted structures, as defined by the maximum distortion
+             *   parameter, relative to a perfect square.
+             *
+             * - Stars whose peak values are greater than the upper limit.
+             *
+             * - Stars whose detection level is not significant with respect
+             *   to the local background.
+             *
+             * - Stars whose barycenters are too misplaced with respect to
+             *   their peak positions, which prevents detection of multiple
+             *   stars.
+             *
+             * - Too flat structures, as defined by the peak response
+             *   parameter.
+             */
+            if ( rect.Width() < 2 || rect.Height() < 2 )
+               continue;
+            if ( rect.x0 == 0 || rect.y0 == 0 || rect.x1 >= W || rect.y1 >= H )
+               continue;
+            double d = Max( rect.Width(), rect.Height() );
+            if ( m_points.Length()/d/d <= m_detector.m_maxDistortion )
+               continue;
+
+            DPoint pos;
+            if ( !Barycenter( pos, rect ) )
+               continue;
+
+            double flux = 0, peak = 0;
+            for ( const Point& p : m_points )
+            {
+               double v = m_image( p );
+               flux += v;
+               if ( v > peak )
+                  peak = v;
+            }
+            if ( peak > m_detector.m_upperLimit )
+               continue;
+
+            double normalized = peak - (1 - m_detector.m_peakResponse)*flux/m_points.Length();
+            double background = Background( rect );
+            if ( background != 0 )
+               if ( (normalized - background)/background <= m_detector.m_sensitivity )
+                  continue;
+
+            if ( m_image( RoundInt( pos.x ), RoundInt( pos.y ) ) <= 0.85*peak )
+               continue;
+            if ( Matrix( m_image, rect ).Median() >= m_detector.m_peakResponse*peak )
+               continue;
+
+            stars.pos << pos;
+            stars.rect << rect;
+            stars.size << int( m_points.Length() );
+            stars.flux << flux;
+            stars.peak << peak;
+            stars.background << background;
+            stars.normalized << normalized;
+         }
+   }
+
+   /*
+    * Local background estimate: the median of pixels in a frame around the
+    * structure's bounding rectangle.
+    */
+   double Background( const Rect& r )
+   {
+      Rect e = r.InflatedBy( m_detector.m_backgroundExpansion );
+      m_samples.Clear();
+      AddSamples( Rect( e.x0, e.y0, e.x1, r.y0 ) );
+      AddSamples( Rect( e.x0, r.y0, r.x0, r.y1 ) );
+      AddSamples( Rect( e.x0, r.y1, e.x1, e.y1 ) );
+      AddSamples( Rect( r.x1, r.y0, e.x1, r.y1 ) );
+      return m_samples.IsEmpty() ? 0.0 : double( pcl::Median( m_samples.Begin(), m_samples.End() ) );
+   }
+
+   void AddSamples( const Rect& rect )
+   {
+      Rect r = rect.Intersection( m_image.Bounds() );
+      if ( r.IsRect() )
+         for ( int y = r.y0; y < r.y1; ++y )
+         {
+            const float* f = m_image.PixelAddress( r.x0, y );
+            m_samples.Append( f, f + r.Width() );
+         }
+   }
+
+   /*
+    * Barycenter of the bright core of the structure, isolated by truncation
+    * at the median plus a multiple of the standard deviation of its bounding
+    * rectangle. Pixel centers are at half-integer coordinates.
+    */
+   bool Barycenter( DPoint& pos, const Rect& rect ) const
+   {
+      Matrix m( m_image, rect );
+      m.Truncate( Range( Matrix( m ).Median() + m_detector.m_xyStretch*m.StdDev(), 0.0, 1.0 ), 1.0 );
+      m.Rescale();
+
+      double sx = 0, sy = 0, sz = 0;
+      for ( int i = 0, y = rect.y0; i < m.Rows(); ++i, ++y )
+      {
+         const double* z = m[i];
+         for ( int j = 0, x = rect.x0; j < m.Cols(); ++j, ++x )
+            if ( z[j] > 0 )
+            {
+               sx += z[j]*x;
+               sy += z[j]*y;
+               sz += z[j];
+            }
+      }
+      if ( sz <= 0 )
+         return false;
+      pos.x = sx/sz + 0.5;
+      pos.y = sy/sz + 0.5;
+      return true;
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+StarDetector::StarList StarDetector::Detect( const Image& workingImage, const Image& structureMap ) const
+{
+   PCL_PRECONDITION( workingImage.Bounds() == structureMap.Bounds() )
+
+   StarList stars;
+   if ( workingImage.IsEmpty() || workingImage.Bounds() != structureMap.Bounds() )
+      return stars;
+
+   Array<Rect> tiles;
+   for ( int y = 0; y < workingImage.Height(); y += m_tileSize )
+      for ( int x = 0; x < workingImage.Width(); x += m_tileSize )
+         tiles << Rect( x, y, Min( x+m_tileSize, workingImage.Width() ), Min( y+m_tileSize, workingImage.Height() ) );
+
+   Array<StarList> tileStars( tiles.Length() );
+   Array<PCL_StarDetectorThread::seed_list> tileClipped( tiles.Length() );
+
+   int numberOfThreads = IsParallelProcessingEnabled() ?
+            Min( MaxProcessors(), pcl::Thread::NumberOfThreads( tiles.Length(), 1 ) ) : 1;
+   if ( numberOfThreads > 1 )
+   {
+      ReferenceArray<PCL_StarDetectorThread> threads;
+      for ( int i = 0; i < numberOfThreads; ++i )
+         threads << new PCL_StarDetectorThread( *this, workingImage, structureMap, tiles, tileStars, tileClipped, i, numberOfThreads );
+      for ( int i = 0; i < numberOfThreads; ++i )
+         threads[i].Start( ThreadPriority::DefaultMax, i );
+      for ( int i = 0; i < numberOfThreads; ++i )
+         threads[i].Wait();
+      threads.Destroy();
+   }
+   else
+      PCL_StarDetectorThread( *this, workingImage, structureMap, tiles, tileStars, tileClipped, 0, 1 ).Run();
+
+   for ( const StarList& s : tileStars )
+      stars.Add( s );
+
+   /*
+    * Structures too large for the tile overlap are scanned again on the whole
+    * structure map, where they are grown exactly as in a serial scan. This is
+    * a serial pass, but only the clipped structures are evaluated.
+    */
+   PCL_StarDetectorThread::seed_list seeds;
+   for ( const PCL_StarDetectorThread::seed_list& c : tileClipped )
+      seeds.Add( c );
+   if ( !seeds.IsEmpty() )
+   {
+      pcl::Sort( seeds.Begin(), seeds.End() );
+      StarList s;
+      PCL_StarDetectorThread( *this, workingImage, structureMap, tiles, tileStars, tileClipped, 0, 1 ).ScanSeeds( seeds, s );
+      stars.Add( s );
+   }
+
+   return stars;
+}
+
+// ----------------------------------------------------------------------------
+
+StarDetector::StarList StarDetector::Detect( const ImageVariant& image ) const
+{
+   Image working = WorkingImage( image );
+   return Detect( working, StructureMap( working ) );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
+// EOF pcl/StarDetector.cpp - Released 2019-01-21T12:06:21Z
@@ -49,48 +49,294 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------------------------------------
 
+#include <pcl/Algebra.h>
 #include <pcl/SurfaceSpline.h>
 
-#include <pcl/api/APIException.h>
-#include <pcl/api/APIInterface.h>
-
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Radial basis function of a surface spline of order m, as a function of the
+ * squared distance r2 between two points:
+ *
+ *    phi(r2) = r2^(m-1) * ln( r2 )
+ *
+ * for m >= 2, and phi(r2) = r2 * ln( r2 ) for m = 1, that is, order 1 uses
+ * the same kernel as order 2. In all cases phi(0) = 0. Adding a tiny constant to the argument of the logarithm
+ * yields the correct limit at the origin without branching, which allows the
+ * compiler to vectorize batched evaluation loops.
+ */
+static inline double SplineKernel( double r2, int m )
+{
+   double k = r2 * pcl::Ln( r2 + 1.0e-300 );
+   for ( int j = m; --j > 1; )
+      k *= r2;
+   return k;
+}
+
+/*
+ * Evaluates the polynomial part of a surface spline of order m at normalized
+ * coordinates (x,y). The polynomial terms are ordered by increasing degree:
+ * 1, x, y, x^2, xy, y^2, x^3, ...
+ */
+template <typename T>
+static inline double SplinePolynomial( const T* c, int m, double x, double y )
+{
+   double z = c[0];
+   switch ( m )
+   {
+   case 1:
+      break;
+   case 2:
+      z += c[1]*x + c[2]*y;
+      break;
+   case 3:
+      z += (c[1] + c[3]*x)*x + (c[2] + c[5]*y)*y + c[4]*x*y;
+      break;
+   default:
+      for ( int i = 1, k = 1; i < m; ++i )
+         for ( int j = 0; j <= i; ++j, ++k )
+            z += c[k] * pcl::PowI( x, i-j ) * pcl::PowI( y, j );
+      break;
+   }
+   return z;
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+static void GenerateSurfaceSpline( T* x, T* y, const T* z, int n,
+                                   int m, float s, const float* w, T* cv,
+                                   double& r0, double& x0, double& y0 )
+{
+   if ( n < 3 )
+      throw Error( "SurfaceSpline::Generate(): At least three input nodes are required" );
+   if ( m < 1 )
+      throw Error( "SurfaceSpline::Generate(): Invalid derivative order" );
+
+   /*
+    * Normalize node coordinates to the unit circle centered at the centroid
+    * of the input node set, to improve the conditioning of the linear system.
+    */
+   x0 = y0 = 0;
+   for ( int i = 0; i < n; ++i )
+   {
+      x0 += x[i];
+      y0 += y[i];
+   }
+   x0 /= n;
+   y0 /= n;
+
+   r0 = 0;
+   for ( int i = 0; i < n; ++i )
+   {
+      double dx = x[i] - x0;
+      double dy = y[i] - y0;
+      double r = Sqrt( dx*dx + dy*dy );
+      if ( r > r0 )
+         r0 = r;
+   }
+   if ( 1 + r0 == 1 )
+      throw Error( "SurfaceSpline::Generate(): Empty or insignificant interpolation space" );
+   r0 = 1/r0;
+
+   for ( int i = 0; i < n; ++i )
+   {
+      x[i] = T( (x[i] - x0)*r0 );
+      y[i] = T( (y[i] - y0)*r0 );
+   }
+
+   /*
+    * Build the linear system:
+    *
+    *    | K + S   P | | c |   | z |
+    *    |           | |   | = |   |
+    *    |  P^T    0 | | a |   | 0 |
+    *
+    * where K is the matrix of radial basis function values between node
+    * pairs, P is the matrix of polynomial terms evaluated at node coordinates,
+    * and S is a diagonal regularization matrix for smoothing splines. The sign
+    * of the regularization term follows the sign of the conditionally definite
+    * kernel function for the specified order.
+    *
+    * The system is solved by the blocked LU decomposition with partial
+    * pivoting implemented in Algebra.cpp.
+    */
+   int nm = (m*(m + 1)) >> 1;
+   int N = n + nm;
+   Matrix A( 0.0, N, N );
+   Matrix b( 0.0, N, 1 );
+
+   for ( int i = 0; i < n; ++i )
+   {
+      double* Ai = A[i];
+      for ( int j = i+1; j < n; ++j )
+      {
+         double dx = double( x[i] ) - double( x[j] );
+         double dy = double( y[i] ) - double( y[j] );
+         Ai[j] = SplineKernel( dx*dx + dy*dy, m );
+      }
+
+      double* Pi = Ai + n;
+      for ( int d = 0, k = 0; d < m; ++d )
+         for ( int j = 0; j <= d; ++j, ++k )
+            Pi[k] = pcl::PowI( double( x[i] ), d-j ) * pcl::PowI( double( y[i] ), j );
+
+      b[i][0] = z[i];
+   }
+
+   for ( int i = 0; i < N; ++i )
+      for ( int j = i+1; j < N; ++j )
+         A[j][i] = A[i][j];
+
+   if ( s > 0 )
+   {
+      double sk = (m & 1) ? -s : s;
+      for ( int i = 0; i < n; ++i )
+         A[i][i] = (w != nullptr) ? sk/w[i] : sk;
+   }
+
+   /*
+    * Pivots are the diagonal elements of the decomposed matrix. Reject
+    * insignificant pivots, not just exact zeros.
+    */
+   IVector P;
+   try
+   {
+      LUDecompositionImplementation( A, P );
+   }
+   catch ( const Error& )
+   {
+      throw Error( "SurfaceSpline::Generate(): Singular linear system" );
+   }
+   for ( int i = 0; i < N; ++i )
+      if ( 1 + Abs( A[i][i] ) == 1 )
+         throw Error( "SurfaceSpline::Generate(): Singular linear system" );
+   LUSolveImplementation( A, P, b );
+
+   for ( int i = 0; i < N; ++i )
+      cv[i] = T( b[i][0] );
+}
+
 void SurfaceSplineBase::Generate( float* fx, float* fy, const float* fz, int n,
                                   int m, float r, const float* w, float* cv,
                                   double& rm, double& xm, double& ym )
 {
-   if ( (*API->Numerical->SurfaceSplineGenerateF)( cv, &rm, &xm, &ym, fx, fy, fz, n, m, r, w ) == api_false )
-      throw APIFunctionError( "SurfaceSplineGenerateF" );
+   GenerateSurfaceSpline( fx, fy, fz, n, m, r, w, cv, rm, xm, ym );
 }
 
 void SurfaceSplineBase::Generate( double* fx, double* fy, const double* fz, int n,
                                   int m, float r, const float* w, double* cv,
                                   double& rm, double& xm, double& ym )
 {
-   if ( (*API->Numerical->SurfaceSplineGenerateD)( cv, &rm, &xm, &ym, fx, fy, fz, n, m, r, w ) == api_false )
-      throw APIFunctionError( "SurfaceSplineGenerateD" );
+   GenerateSurfaceSpline( fx, fy, fz, n, m, r, w, cv, rm, xm, ym );
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+static double InterpolateSurfaceSpline( const T* fx, const T* fy, int n,
+                                        const T* cv, int m, double x, double y )
+{
+   double z = SplinePolynomial( cv + n, m, x, y );
+   for ( int i = 0; i < n; ++i )
+   {
+      double dx = fx[i] - x;
+      double dy = fy[i] - y;
+      z += cv[i] * SplineKernel( dx*dx + dy*dy, m );
+   }
+   return z;
 }
 
 float SurfaceSplineBase::Interpolate( const float* fx, const float* fy, int n,
                                       const float* cv, int m, double x, double y )
 {
-   float z;
-   if ( (*API->Numerical->SurfaceSplineInterpolateF)( &z, fx, fy, cv, n, m, x, y ) == api_false )
-      throw APIFunctionError( "SurfaceSplineInterpolateF" );
-   return z;
+   return float( InterpolateSurfaceSpline( fx, fy, n, cv, m, x, y ) );
 }
 
 double SurfaceSplineBase::Interpolate( const double* fx, const double* fy, int n,
                                        const double* cv, int m, double x, double y )
 {
-   double z;
-   if ( (*API->Numerical->SurfaceSplineInterpolateD)( &z, fx, fy, cv, n, m, x, y ) == api_false )
-      throw APIFunctionError( "SurfaceSplineInterpolateD" );
-   return z;
+   return InterpolateSurfaceSpline( fx, fy, n, cv, m, x, y );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Batched evaluation. Points are processed in fixed-size blocks, and each
+ * block is updated with a single sweep over the list of nodes. The innermost
+ * loop runs over the points of a block with contiguous, aligned working
+ * arrays, so it can be vectorized, and node data are read once per block
+ * instead of once per point.
+ */
+template <typename T>
+static void InterpolateSurfaceSpline( T* z, const double* x, const double* y, size_type count,
+                                      const T* fx, const T* fy, int n,
+                                      const T* cv, int m, double r0, double x0, double y0 )
+{
+   const int BlockSize = 256;
+   double px[ BlockSize ];
+   double py[ BlockSize ];
+   double pz[ BlockSize ];
+
+   for ( size_type p0 = 0; p0 < count; p0 += BlockSize )
+   {
+      int np = int( Min( size_type( BlockSize ), count - p0 ) );
+
+      for ( int j = 0; j < np; ++j )
+      {
+         px[j] = r0*(x[p0+j] - x0);
+         py[j] = r0*(y[p0+j] - y0);
+         pz[j] = SplinePolynomial( cv + n, m, px[j], py[j] );
+      }
+
+      if ( m == 2 )
+      {
+         for ( int i = 0; i < n; ++i )
+         {
+            double xi = fx[i], yi = fy[i], ci = cv[i];
+            for ( int j = 0; j < np; ++j )
+            {
+               double dx = xi - px[j];
+               double dy = yi - py[j];
+               double r2 = dx*dx + dy*dy;
+               pz[j] += ci * r2 * pcl::Ln( r2 + 1.0e-300 );
+            }
+         }
+      }
+      else
+      {
+         for ( int i = 0; i < n; ++i )
+         {
+            double xi = fx[i], yi = fy[i], ci = cv[i];
+            for ( int j = 0; j < np; ++j )
+            {
+               double dx = xi - px[j];
+               double dy = yi - py[j];
+               pz[j] += ci * SplineKernel( dx*dx + dy*dy, m );
+            }
+         }
+      }
+
+      for ( int j = 0; j < np; ++j )
+         z[p0+j] = T( pz[j] );
+   }
+}
+
+void SurfaceSplineBase::Interpolate( float* z, const double* x, const double* y, size_type count,
+                                     const float* fx, const float* fy, int n,
+                                     const float* cv, int m, double r0, double x0, double y0 )
+{
+   InterpolateSurfaceSpline( z, x, y, count, fx, fy, n, cv, m, r0, x0, y0 );
+}
+
+void SurfaceSplineBase::Interpolate( double* z, const double* x, const double* y, size_type count,
+                                     const double* fx, const double* fy, int n,
+                                     const double* cv, int m, double r0, double x0, double y0 )
+{
+   InterpolateSurfaceSpline( z, x, y, count, fx, fy, n, cv, m, r0, x0, y0 );
 }
 
 // ----------------------------------------------------------------------------
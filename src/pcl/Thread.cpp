@@ -55,10 +55,17 @@
 #include <pcl/GlobalSettings.h>
 #include <pcl/Math.h>
 #include <pcl/Thread.h>
+#include <pcl/ThreadPool.h>
 
 #include <pcl/api/APIException.h>
 #include <pcl/api/APIInterface.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib> // for getenv()
+#include <mutex>
+#include <thread>
+
 #ifdef __PCL_UNIX
 # include <time.h> // for nanosleep()
 #endif
@@ -94,9 +101,33 @@ namespace pcl
 
 // ----------------------------------------------------------------------------
 
-static bool      s_enableAffinity = false;
-static AtomicInt s_featureDataInitialized;
-static AtomicInt s_numberOfRunningThreads;
+static bool              s_enableAffinity = false;
+static AtomicInt         s_featureDataInitialized;
+static AtomicInt         s_numberOfRunningThreads;
+static AtomicInt         s_maxProcessors;           // standalone mode only
+static thread_local bool s_isNativeThread = false;  // standalone mode only
+
+/*
+ * Completion of pooled threads. A single condition variable is shared by all
+ * pooled threads: completions are infrequent, and waiters recheck the active
+ * state of their own thread.
+ */
+static std::mutex              s_pooledMutex;
+static std::condition_variable s_pooledFinished;
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Native thread implementation, used when there is no PixInsight core
+ * application available (API == nullptr).
+ */
+struct Thread::NativeData
+{
+   std::thread             thread;
+   std::mutex              mutex;
+   std::condition_variable finished;
+   Thread::priority        priority = ThreadPriority::Inherit;
+};
 
 // ----------------------------------------------------------------------------
 
@@ -140,6 +171,47 @@ public:
           */
       }
    }
+
+   static void RunPooledThread( Thread& thread )
+   {
+      try
+      {
+         volatile AutoCounter counter;
+         thread.Run();
+      }
+      catch ( ... )
+      {
+         // Same as above: never propagate exceptions from a running thread.
+      }
+      {
+         std::lock_guard<std::mutex> lock( s_pooledMutex );
+         thread.m_localActive.Store( 0 );
+      }
+      s_pooledFinished.notify_all();
+   }
+
+   static void RunNativeThread( Thread* thread )
+   {
+      s_isNativeThread = true;
+      try
+      {
+         volatile AutoCounter counter;
+
+         if ( thread->m_processorIndex >= 0 )
+            thread->SetAffinity( thread->m_processorIndex );
+
+         thread->Run();
+      }
+      catch ( ... )
+      {
+         // Never propagate exceptions from a running thread.
+      }
+      {
+         std::lock_guard<std::mutex> lock( thread->m_native->mutex );
+         thread->m_localActive.Store( 0 );
+      }
+      thread->m_native->finished.notify_all();
+   }
 }; // ThreadDispatcher
 
 #undef T
@@ -147,17 +219,16 @@ public:
 // ----------------------------------------------------------------------------
 
 /*
- * ### TODO: Implement pcl::Thread without core application support, in case
- * we are running as an independent application.
- *
- * For now, we simply construct a null object when API = nullptr. The
- * reimplemented Thread::Run() can be invoked single-threaded.
+ * When API = nullptr we are running as an independent application. In this
+ * case threads are implemented natively with std::thread.
  */
 
 Thread::Thread() :
    UIObject( (API != nullptr) ? (*API->Thread->CreateThread)( ModuleHandle(), this, 0/*flags*/ ) : nullptr )
 {
-   if ( API != nullptr )
+   if ( API == nullptr )
+      m_native = new NativeData;
+   else
    {
       if ( IsNull() )
          throw APIFunctionError( "CreateThread" );
@@ -185,13 +256,36 @@ Thread::Thread() :
 
 // ----------------------------------------------------------------------------
 
+Thread::~Thread()
+{
+   if ( m_native != nullptr )
+   {
+      /*
+       * The running thread uses both this object and its native data, so we
+       * cannot release them before it terminates. Request an abort and wait.
+       */
+      if ( m_native->thread.joinable() )
+      {
+         if ( m_localActive.Load() != 0 )
+            Abort();
+         m_native->thread.join();
+      }
+      delete m_native, m_native = nullptr;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
 Thread& Thread::Null()
 {
    static Thread* nullThread = nullptr;
    static Mutex mutex;
    volatile AutoLock lock( mutex );
    if ( nullThread == nullptr )
+   {
       nullThread = new Thread( nullptr );
+      delete nullThread->m_native, nullThread->m_native = nullptr;
+   }
    return *nullThread;
 }
 
@@ -199,7 +293,21 @@ Thread& Thread::Null()
 
 void Thread::Start( Thread::priority p, int processor )
 {
+   m_pooled = false;
    m_processorIndex = Range( processor, -1, PCL_MAX_PROCESSORS );
+   if ( m_native != nullptr )
+   {
+      if ( m_localActive.Load() != 0 )
+         return;
+      if ( m_native->thread.joinable() )
+         m_native->thread.join();
+      if ( p != ThreadPriority::Inherit )
+         m_native->priority = p;
+      m_localStatus.Store( 0 );
+      m_localActive.Store( 1 );
+      m_native->thread = std::thread( ThreadDispatcher::RunNativeThread, this );
+      return;
+   }
    (*API->Thread->StartThread)( handle, p );
 }
 
@@ -232,7 +340,9 @@ Array<int> Thread::Affinity() const
 
 bool Thread::SetAffinity( const Array<int>& processors )
 {
-   if ( (*API->Thread->IsThreadActive)( handle ) == api_false )
+   if ( m_pooled ) // never change the affinity of a pool worker
+      return false;
+   if ( !IsActive() )
       return false;
 #ifdef __PCL_LINUX
    cpu_set_t set;
@@ -268,7 +378,9 @@ bool Thread::SetAffinity( const Array<int>& processors )
 
 bool Thread::SetAffinity( int processor )
 {
-   if ( (*API->Thread->IsThreadActive)( handle ) == api_false )
+   if ( m_pooled )
+      return false;
+   if ( !IsActive() )
       return false;
 #ifdef __PCL_LINUX
    if ( processor < 0 || processor >= CPU_SETSIZE )
@@ -297,6 +409,8 @@ bool Thread::SetAffinity( int processor )
 
 void Thread::Kill()
 {
+   if ( m_pooled || m_native != nullptr ) // pool workers and native threads cannot be killed
+      return;
    (*API->Thread->KillThread)( handle );
 }
 
@@ -304,6 +418,8 @@ void Thread::Kill()
 
 bool Thread::IsActive() const
 {
+   if ( m_pooled || m_native != nullptr )
+      return m_localActive.Load() != 0;
    return (*API->Thread->IsThreadActive)( handle ) != api_false;
 }
 
@@ -311,6 +427,10 @@ bool Thread::IsActive() const
 
 Thread::priority Thread::Priority() const
 {
+   if ( m_pooled )
+      return ThreadPriority::Inherit;
+   if ( m_native != nullptr )
+      return m_native->priority;
    return priority( (*API->Thread->GetThreadPriority)( handle ) );
 }
 
@@ -318,6 +438,14 @@ Thread::priority Thread::Priority() const
 
 void Thread::SetPriority( Thread::priority p )
 {
+   if ( m_pooled )
+      return;
+   if ( m_native != nullptr )
+   {
+      // Native thread priorities are informative only.
+      m_native->priority = p;
+      return;
+   }
    (*API->Thread->SetThreadPriority)( handle, p );
 }
 
@@ -325,6 +453,18 @@ void Thread::SetPriority( Thread::priority p )
 
 void Thread::Wait()
 {
+   if ( m_pooled )
+   {
+      std::unique_lock<std::mutex> lock( s_pooledMutex );
+      s_pooledFinished.wait( lock, [this]() { return m_localActive.Load() == 0; } );
+      return;
+   }
+   if ( m_native != nullptr )
+   {
+      std::unique_lock<std::mutex> lock( m_native->mutex );
+      m_native->finished.wait( lock, [this]() { return m_localActive.Load() == 0; } );
+      return;
+   }
    (void)(*API->Thread->WaitThread)( handle, uint32_max );
 }
 
@@ -332,6 +472,18 @@ void Thread::Wait()
 
 bool Thread::Wait( unsigned ms )
 {
+   if ( m_pooled )
+   {
+      std::unique_lock<std::mutex> lock( s_pooledMutex );
+      return s_pooledFinished.wait_for( lock, std::chrono::milliseconds( ms ),
+                                        [this]() { return m_localActive.Load() == 0; } );
+   }
+   if ( m_native != nullptr )
+   {
+      std::unique_lock<std::mutex> lock( m_native->mutex );
+      return m_native->finished.wait_for( lock, std::chrono::milliseconds( ms ),
+                                          [this]() { return m_localActive.Load() == 0; } );
+   }
    return (*API->Thread->WaitThread)( handle, ms ) != api_false;
 }
 
@@ -368,6 +520,10 @@ Thread& Thread::CurrentThread()
 
 bool Thread::IsRootThread()
 {
+   if ( ThreadPool::IsWorkerThread() )
+      return false;
+   if ( API == nullptr )
+      return !s_isNativeThread;
    return (*API->Thread->GetCurrentThread)() == 0;
 }
 
@@ -382,6 +538,8 @@ int Thread::NumberOfRunningThreads()
 
 uint32 Thread::Status() const
 {
+   if ( m_pooled || m_native != nullptr )
+      return uint32( m_localStatus.Load() );
    return (*API->Thread->GetThreadStatus)( handle );
 }
 
@@ -389,6 +547,11 @@ uint32 Thread::Status() const
 
 bool Thread::TryGetStatus( uint32& status ) const
 {
+   if ( m_pooled || m_native != nullptr )
+   {
+      status = uint32( m_localStatus.Load() );
+      return true;
+   }
    return (*API->Thread->GetThreadStatusEx)( handle, &status, 0x00000001 ) != api_false;
 }
 
@@ -396,6 +559,12 @@ bool Thread::TryGetStatus( uint32& status ) const
 
 void Thread::SetStatus( uint32 status )
 {
+   if ( m_pooled || m_native != nullptr )
+   {
+      if ( m_localActive.Load() != 0 )
+         m_localStatus.Store( int( status ) );
+      return;
+   }
    (*API->Thread->SetThreadStatus)( handle, status );
 }
 
@@ -403,6 +572,8 @@ void Thread::SetStatus( uint32 status )
 
 String Thread::ConsoleOutputText() const
 {
+   if ( m_pooled || m_native != nullptr ) // no console output accumulation without core support
+      return String();
    size_type len = 0;
    (*API->Thread->GetThreadConsoleOutputText)( handle, 0, &len );
 
@@ -421,6 +592,8 @@ String Thread::ConsoleOutputText() const
 
 void Thread::ClearConsoleOutputText()
 {
+   if ( m_pooled || m_native != nullptr )
+      return;
    (*API->Thread->ClearThreadConsoleOutputText)( handle );
 }
 
@@ -437,6 +610,13 @@ void Thread::FlushConsoleOutputText()
 
 // ----------------------------------------------------------------------------
 
+void Thread::RunPooled()
+{
+   ThreadDispatcher::RunPooledThread( *this );
+}
+
+// ----------------------------------------------------------------------------
+
 void* Thread::CloneHandle() const
 {
    throw Error( "Cannot clone a Thread handle" );
@@ -471,12 +651,63 @@ int Thread::NumberOfThreads( size_type N, size_type overheadLimit )
          return Max( 1, int( Min( np, N/Max( overheadLimit, N/np ) ) ) );
       }
    }
+   else
+   {
+      int nf = MaxProcessors();
+
+      int nr = NumberOfRunningThreads();
+      if ( nr > 0 )
+         nf -= nr - 1;
+
+      if ( nf > 1 && N > overheadLimit )
+      {
+         size_type np = nf;
+         return Max( 1, int( Min( np, N/Max( overheadLimit, N/np ) ) ) );
+      }
+   }
 
    return 1;
 }
 
 // ----------------------------------------------------------------------------
 
+int Thread::MaxProcessors()
+{
+   if ( API != nullptr )
+      return Range( Min( PixInsightSettings::GlobalInteger( "System/NumberOfProcessors" ),
+                         PixInsightSettings::GlobalInteger( "Process/MaxProcessors" ) ), 1, PCL_MAX_PROCESSORS );
+
+   int n = s_maxProcessors.Load();
+   if ( n == 0 )
+   {
+      static Mutex mutex;
+      volatile AutoLock lock( mutex );
+      if ( (n = s_maxProcessors.Load()) == 0 )
+      {
+         n = int( std::thread::hardware_concurrency() );
+         const char* env = ::getenv( "PCL_MAX_PROCESSORS" );
+         if ( env != nullptr )
+         {
+            int m = ::atoi( env );
+            if ( m > 0 )
+               n = m;
+         }
+         s_maxProcessors.Store( n = Range( n, 1, PCL_MAX_PROCESSORS ) );
+      }
+   }
+   return n;
+}
+
+// ----------------------------------------------------------------------------
+
+void Thread::SetMaxProcessors( int n )
+{
+   if ( API == nullptr )
+      s_maxProcessors.Store( Range( n, 1, PCL_MAX_PROCESSORS ) );
+}
+
+// ----------------------------------------------------------------------------
+
 void PCL_FUNC Sleep( unsigned ms )
 {
    //(*API->Thread->SleepThread)( 0, ms );
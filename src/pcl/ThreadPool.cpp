@@ -0,0 +1,412 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+// pcl/ThreadPool.cpp - Released 2019-01-21T12:06:21Z
+// ----------------------------------------------------------------------------
+// This file is part of the PixInsight Class Library (PCL).
+// PCL is a multiplatform C++ framework for development of PixInsight modules.
+//
+// Copyright (c) 2003-2019 Pleiades Astrophoto S.L. All Rights Reserved.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+#include <pcl/AutoLock.h>
+#include <pcl/ThreadPool.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+static thread_local int s_workerIndex = -1;
+static AtomicInt        s_poolEnabled;
+
+// ----------------------------------------------------------------------------
+
+class PCL_ThreadPoolEngine
+{
+public:
+
+   PCL_ThreadPoolEngine( int numberOfWorkers )
+   {
+      for ( int i = 0; i < PCL_MAX_PROCESSORS; ++i )
+         m_queues[i] = nullptr;
+      Grow( numberOfWorkers );
+   }
+
+   ~PCL_ThreadPoolEngine()
+   {
+      {
+         std::lock_guard<std::mutex> lock( m_mutex );
+         m_stop = true;
+      }
+      m_wakeup.notify_all();
+      for ( std::thread& t : m_workers )
+#ifdef __PCL_WINDOWS
+         // Joining threads while a DLL is being unloaded deadlocks on Windows.
+         t.detach();
+#else
+         t.join();
+#endif
+      for ( int i = 0; i < PCL_MAX_PROCESSORS; ++i )
+         delete m_queues[i];
+   }
+
+   int NumberOfWorkers() const
+   {
+      return m_numberOfWorkers.Load();
+   }
+
+   /*
+    * Adds workers until there are at least numberOfWorkers of them. Workers
+    * are never removed: surplus workers just remain idle, since the number of
+    * tasks submitted for each parallel operation is limited by its callers.
+    * Queues are created before publishing the new worker count, so that
+    * concurrent Pop() calls only access fully constructed queues.
+    */
+   void Grow( int numberOfWorkers )
+   {
+      numberOfWorkers = Range( numberOfWorkers, 1, PCL_MAX_PROCESSORS );
+      if ( numberOfWorkers <= m_numberOfWorkers.Load() )
+         return;
+      std::lock_guard<std::mutex> lock( m_growMutex );
+      for ( int i = m_numberOfWorkers.Load(); i < numberOfWorkers; ++i )
+      {
+         m_queues[i] = new TaskQueue;
+         m_numberOfWorkers.Store( i+1 );
+         m_workers.push_back( std::thread( &PCL_ThreadPoolEngine::WorkerLoop, this, i ) );
+      }
+   }
+
+   void Push( ThreadPoolTask* task )
+   {
+      TaskQueue& queue = (s_workerIndex >= 0) ? *m_queues[s_workerIndex] : m_global;
+      {
+         std::lock_guard<std::mutex> lock( queue.mutex );
+         queue.tasks.push_back( task );
+      }
+      {
+         std::lock_guard<std::mutex> lock( m_mutex );
+         ++m_queued;
+      }
+      m_wakeup.notify_one();
+      m_done.notify_all(); // threads waiting in HelpWait() can help with it
+   }
+
+   void HelpWait( TaskGroup& group )
+   {
+      while ( !group.IsDone() )
+      {
+         ThreadPoolTask* task = Pop( s_workerIndex );
+         if ( task != nullptr )
+            Execute( task );
+         else
+         {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_done.wait( lock, [&]() { return group.IsDone() || m_queued > 0; } );
+         }
+      }
+   }
+
+   bool TimedWait( TaskGroup& group, unsigned ms )
+   {
+      std::unique_lock<std::mutex> lock( m_mutex );
+      return m_done.wait_for( lock, std::chrono::milliseconds( ms ),
+                              [&]() { return group.IsDone(); } );
+   }
+
+private:
+
+   struct TaskQueue
+   {
+      std::mutex                  mutex;
+      std::deque<ThreadPoolTask*> tasks;
+   };
+
+   std::vector<std::thread> m_workers;                     // protected by m_growMutex
+   TaskQueue*               m_queues[ PCL_MAX_PROCESSORS ];
+   mutable AtomicInt        m_numberOfWorkers;
+   std::mutex               m_growMutex;
+   TaskQueue                m_global;
+   std::mutex               m_mutex;   // protects m_queued and m_stop
+   std::condition_variable  m_wakeup;  // signaled when new tasks are available
+   std::condition_variable  m_done;    // signaled when a task group completes
+   int                      m_queued = 0;
+   bool                     m_stop = false;
+
+   /*
+    * Workers pop tasks from the back of their own queues (LIFO, for cache
+    * locality of nested tasks), then from the front of the global queue, and
+    * finally try to steal from the front of other workers' queues.
+    */
+   ThreadPoolTask* Pop( int self )
+   {
+      ThreadPoolTask* task = nullptr;
+      if ( self >= 0 )
+         task = PopBack( *m_queues[self] );
+      if ( task == nullptr )
+         task = PopFront( m_global );
+      if ( task == nullptr )
+      {
+         int n = m_numberOfWorkers.Load();
+         for ( int i = 1; i <= n && task == nullptr; ++i )
+         {
+            int victim = (self + i) % n;
+            if ( victim != self )
+               task = PopFront( *m_queues[victim] );
+         }
+      }
+      if ( task != nullptr )
+      {
+         std::lock_guard<std::mutex> lock( m_mutex );
+         --m_queued;
+      }
+      return task;
+   }
+
+   static ThreadPoolTask* PopBack( TaskQueue& queue )
+   {
+      std::lock_guard<std::mutex> lock( queue.mutex );
+      if ( queue.tasks.empty() )
+         return nullptr;
+      ThreadPoolTask* task = queue.tasks.back();
+      queue.tasks.pop_back();
+      return task;
+   }
+
+   static ThreadPoolTask* PopFront( TaskQueue& queue )
+   {
+      std::lock_guard<std::mutex> lock( queue.mutex );
+      if ( queue.tasks.empty() )
+         return nullptr;
+      ThreadPoolTask* task = queue.tasks.front();
+      queue.tasks.pop_front();
+      return task;
+   }
+
+   void Execute( ThreadPoolTask* task )
+   {
+      TaskGroup& group = task->Group();
+      if ( !group.IsCanceled() )
+         try
+         {
+            task->Execute();
+         }
+         catch ( ... )
+         {
+            group.SetException( std::current_exception() );
+         }
+      delete task;
+
+      if ( group.m_pending.FetchAndAdd( -1 ) == 1 )
+      {
+         std::lock_guard<std::mutex> lock( m_mutex );
+         m_done.notify_all();
+      }
+   }
+
+   void WorkerLoop( int index )
+   {
+      s_workerIndex = index;
+      for ( ;; )
+      {
+         ThreadPoolTask* task = Pop( index );
+         if ( task != nullptr )
+         {
+            Execute( task );
+            continue;
+         }
+
+         std::unique_lock<std::mutex> lock( m_mutex );
+         m_wakeup.wait( lock, [this]() { return m_stop || m_queued > 0; } );
+         if ( m_stop )
+            break;
+      }
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+static PCL_ThreadPoolEngine* s_pool = nullptr;
+static AtomicInt             s_poolInitialized;
+static Mutex                 s_poolMutex;
+
+static struct PoolDestroyer
+{
+   ~PoolDestroyer()
+   {
+      delete s_pool, s_pool = nullptr;
+   }
+} s_poolDestroyer;
+
+static PCL_ThreadPoolEngine& Pool()
+{
+   if ( s_poolInitialized.Load() == 0 )
+   {
+      volatile AutoLock lock( s_poolMutex );
+      if ( s_poolInitialized.Load() == 0 )
+      {
+         s_pool = new PCL_ThreadPoolEngine( Thread::MaxProcessors() );
+         s_poolInitialized.Store( 1 );
+      }
+   }
+   return *s_pool;
+}
+
+// ----------------------------------------------------------------------------
+
+int ThreadPool::NumberOfWorkers()
+{
+   /*
+    * The maximum number of processors can change at any time (global
+    * settings, or SetMaxProcessors() in standalone mode). Make sure we have
+    * enough workers for the current setting.
+    */
+   PCL_ThreadPoolEngine& pool = Pool();
+   pool.Grow( Thread::MaxProcessors() );
+   return pool.NumberOfWorkers();
+}
+
+// ----------------------------------------------------------------------------
+
+int ThreadPool::CurrentWorkerIndex()
+{
+   return s_workerIndex;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadPool::IsEnabled()
+{
+   return s_poolEnabled.Load() != 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadPool::Enable( bool enable )
+{
+   s_poolEnabled.Store( enable ? 1 : 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+TaskGroup::~TaskGroup()
+{
+   if ( !IsDone() )
+   {
+      Cancel();
+      Pool().HelpWait( *this );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void TaskGroup::Start( Thread& thread )
+{
+   thread.m_pooled = true;
+   thread.m_localStatus.Store( 0 );
+   thread.m_localActive.Store( 1 );
+   Thread* t = &thread;
+   Run( [t]() { t->RunPooled(); } );
+}
+
+// ----------------------------------------------------------------------------
+
+void TaskGroup::Wait()
+{
+   if ( !IsDone() )
+      Pool().HelpWait( *this );
+   ThrowException();
+}
+
+// ----------------------------------------------------------------------------
+
+bool TaskGroup::Wait( unsigned ms )
+{
+   return IsDone() || Pool().TimedWait( *this, ms );
+}
+
+// ----------------------------------------------------------------------------
+
+void TaskGroup::Enqueue( ThreadPoolTask* task )
+{
+   m_pending.Increment();
+   Pool().Push( task );
+}
+
+// ----------------------------------------------------------------------------
+
+void TaskGroup::SetException( std::exception_ptr e )
+{
+   volatile AutoLock lock( m_mutex );
+   if ( !m_exception )
+      m_exception = e;
+   Cancel();
+}
+
+// ----------------------------------------------------------------------------
+
+void TaskGroup::ThrowException()
+{
+   std::exception_ptr e;
+   {
+      volatile AutoLock lock( m_mutex );
+      e = m_exception;
+      m_exception = std::exception_ptr();
+   }
+   if ( e )
+      std::rethrow_exception( e );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
+// EOF pcl/ThreadPool.cpp - Released 2019-01-21T12:06:21Z
@@ -65,11 +65,14 @@ namespace pcl
 
 const fsize_type XISF::DefaultBlockAlignSize = 4096;
 const fsize_type XISF::DefaultMaxBlockInlineSize = 3072;
+const fsize_type XISF::DefaultCompressionSubblockSize = 1024*1024;
+const fsize_type XISF::MinStreamedImageSize = 64*1024*1024;
 const int XISF::MaxThumbnailSize = 1024;
 const XISF::block_checksum XISF::DefaultChecksum = XISFChecksum::None;
 const XISF::block_compression XISF::DefaultCompression = XISFCompression::None;
 const int XISF::DefaultCompressionLevel = 0;
 const int XISF::MaxCompressionLevel = 100;
+const bool XISF::DefaultCompressionSubblocks = false;
 const int XISF::DefaultVerbosity = 1;
 const double XISF::DefaultOutputLowerBound = 0.0;
 const double XISF::DefaultOutputUpperBound = 1.0;
@@ -98,6 +98,22 @@ struct XISFInputDataBlock
     */
    typedef Array<SubblockDimensions>   subblock_info;
 
+   /*
+    * An uncompressed subblock kept for incremental reads of compressed
+    * blocks.
+    */
+   struct CachedSubblock
+   {
+      size_type index = 0; // subblock index
+      ByteArray data;      // uncompressed subblock data
+   };
+
+   /*
+    * A least recently used cache of uncompressed subblocks. The most recently
+    * used subblock is the last element.
+    */
+   typedef Array<CachedSubblock>       subblock_cache;
+
    /*
     * Compressed subblocks.
     */
@@ -137,6 +153,7 @@ struct XISFInputDataBlock
    unsigned          compressedItemSize = 1; // size in bytes of a data item, for byte shuffling
    subblock_info     subblockInfo;           // compressed subblock dimensions
    subblock_list     subblocks;              // compressed data
+   subblock_cache    subblockCache;          // uncompressed subblocks for incremental reads
    ByteArray         data;                   // uncompressed data
    ByteArray         checksum;               // cryptographic hash digest
    block_checksum    checksumAlgorithm  = XISFChecksum::None; // hashing algorithm
@@ -208,13 +225,29 @@ struct XISFInputDataBlock
       if ( IsEmpty() )
          throw Error( String( "XISFInputDataBlock::GetData(): " ) + "Internal error: Invalid function call." );
 
-      VerifyChecksum( file );
-
       if ( IsCompressed() )
+      {
+         if ( IsIncrementalRead( dstSize, offset ) )
+         {
+            /*
+             * The block checksum covers the entire compressed block. If it
+             * has to be verified, load all compressed subblocks once,
+             * hashing them as they are read, so that this and subsequent
+             * incremental reads are served from memory instead of reading
+             * the whole block twice.
+             */
+            if ( HasChecksum() && !checksumVerified )
+               LoadCompressedData( file );
+            GetUncompressedRange( file, reinterpret_cast<uint8*>( dst ), dstSize, offset );
+            return;
+         }
+
          Uncompress( file );
+      }
 
       if ( HasData() )
       {
+         VerifyChecksum( file );
          if ( offset + dstSize > data.Length() )
             throw Error( String( "XISFInputDataBlock::GetData(): " ) + "Internal error: Invalid destination array size." );
          ApplyByteOrder();
@@ -224,26 +257,30 @@ struct XISFInputDataBlock
       {
          if ( offset + dstSize > size_type( size ) )
             throw Error( String( "XISFInputDataBlock::GetData(): " ) + "Internal error: Invalid destination array size." );
-         file.SetPosition( position + offset );
-         file.Read( dst, dstSize );
+         if ( offset == 0 && dstSize == size_type( size ) )
+            ReadAttachment( file, dst );
+         else
+         {
+            VerifyChecksum( file );
+            file.SetPosition( position + offset );
+            file.Read( dst, dstSize );
+         }
          ApplyByteOrder( dst, dstSize );
       }
    }
 
    void LoadData( File& file )
    {
-      VerifyChecksum( file );
-
       if ( !HasData() )
          if ( IsCompressed() )
             Uncompress( file );
          else
          {
             data = ByteArray( size );
-            file.SetPosition( position );
-            file.Read( data.Begin(), size );
+            ReadAttachment( file, data.Begin() );
          }
 
+      VerifyChecksum( file );
       ApplyByteOrder();
    }
 
@@ -252,6 +289,7 @@ struct XISFInputDataBlock
       if ( IsCompressed() )
       {
          data.Clear();
+         subblockCache.Clear();
          if ( IsAttachment() )
             subblocks.Clear();
       }
@@ -291,23 +329,36 @@ struct XISFInputDataBlock
       if ( IsEmpty() || !IsCompressed() )
          throw Error( String( "XISFInputDataBlock::LoadCompressedData(): " ) + "Internal error: Invalid function call." );
 
-      VerifyChecksum( file );
-
       if ( !HasCompressedData() )
       {
+         /*
+          * The block checksum is computed for the compressed attachment, so
+          * it can be verified while the subblocks are being read, as long as
+          * they cover the entire block.
+          */
+         fsize_type compressedSize = 0;
+         for ( const SubblockDimensions& info : subblockInfo )
+            compressedSize += info.compressedSize;
+         AutoPointer<CryptographicHash> hash( (compressedSize == size) ? NewChecksumHash() : nullptr );
+
          file.SetPosition( position );
          for ( const SubblockDimensions& info : subblockInfo )
          {
             Compression::Subblock subblock;
             subblock.compressedData = ByteArray( size_type( info.compressedSize ) );
             subblock.uncompressedSize = info.uncompressedSize;
-            file.Read( subblock.compressedData.Begin(), info.compressedSize );
+            ReadAndHash( file, subblock.compressedData.Begin(), subblock.compressedData.Length(), hash.Pointer() );
             subblocks << subblock;
          }
 
          if ( subblocks.IsEmpty() )
             throw Error( String( "XISFInputDataBlock::LoadCompressedData(): " ) + "Internal error: Invalid or corrupted compressed subblock data." );
+
+         if ( hash )
+            CheckChecksum( hash->Finalize(), hash->AlgorithmName() );
       }
+
+      VerifyChecksum( file );
    }
 
    void Uncompress( File& file )
@@ -326,6 +377,209 @@ struct XISFInputDataBlock
       ApplyByteOrder();
    }
 
+   /*
+    * Returns true iff a read of dstSize bytes at the specified offset can be
+    * served by uncompressing only the subblocks that cover it. Whole-block
+    * reads, and reads of blocks already uncompressed, use the full block path.
+    */
+   bool IsIncrementalRead( size_type dstSize, size_type offset ) const
+   {
+      if ( !IsCompressed() || HasData() )
+         return false;
+
+      size_type dataSize = DataSize();
+      if ( offset == 0 && dstSize >= dataSize )
+         return false;
+
+      /*
+       * With byte shuffling, the requested range must consist of whole items
+       * in the shuffled part of the block.
+       */
+      size_type m = ShuffledItemSize();
+      return m == 1 || dataSize % m == 0 && offset % m == 0 && dstSize % m == 0;
+   }
+
+   /*
+    * Size in bytes of a shuffled data item, or one if the block has been
+    * compressed without byte shuffling.
+    */
+   size_type ShuffledItemSize() const
+   {
+      return (XISF::CompressionUsesByteShuffle( compressionCodec ) && compressedItemSize > 1) ? compressedItemSize : 1;
+   }
+
+   /*
+    * Copies dstSize uncompressed bytes starting at offset to dst,
+    * uncompressing only the subblocks that cover the requested range.
+    *
+    * For shuffled blocks, the range of n items [i0,i1) is stored as m
+    * segments [j*N + i0, j*N + i1), j = 0,...,m-1, of the shuffled stream,
+    * where m is the item size and N the total number of items in the block.
+    * Each segment is scattered to dst with a stride of m bytes.
+    */
+   void GetUncompressedRange( File& file, uint8* dst, size_type dstSize, size_type offset )
+   {
+      if ( offset + dstSize > DataSize() )
+         throw Error( String( "XISFInputDataBlock::GetData(): " ) + "Internal error: Invalid destination array size." );
+
+      size_type m = ShuffledItemSize();
+      if ( m > 1 )
+      {
+         size_type N = DataSize()/m;
+         size_type i0 = offset/m;
+         size_type i1 = i0 + dstSize/m;
+         for ( size_type j = 0; j < m; ++j )
+            CopyUncompressedBytes( file, dst + j, m, j*N + i0, j*N + i1 );
+      }
+      else
+         CopyUncompressedBytes( file, dst, 1, offset, offset + dstSize );
+
+      if ( IsLittleEndianMachine() != (byteOrder == XISFByteOrder::LittleEndian) )
+         ReverseByteOrder( dst, dstSize, itemSize );
+   }
+
+   /*
+    * Copies the range [p0,p1) of the uncompressed stream to dst, writing one
+    * byte every stride bytes.
+    */
+   void CopyUncompressedBytes( File& file, uint8* dst, size_type stride, size_type p0, size_type p1 )
+   {
+      size_type subblockStart = 0;
+      for ( size_type i = 0; i < subblockInfo.Length() && p0 < p1; ++i )
+      {
+         size_type subblockSize = subblockInfo[i].uncompressedSize;
+         size_type subblockEnd = subblockStart + subblockSize;
+         if ( p0 < subblockEnd )
+         {
+            const ByteArray& subblock = UncompressedSubblock( file, i );
+            size_type count = Min( p1, subblockEnd ) - p0;
+            const uint8* src = subblock.At( p0 - subblockStart );
+            if ( stride == 1 )
+            {
+               ::memcpy( dst, src, count );
+               dst += count;
+            }
+            else
+               for ( const uint8* end = src + count; src < end; ++src, dst += stride )
+                  *dst = *src;
+            p0 += count;
+         }
+         subblockStart = subblockEnd;
+      }
+
+      if ( p0 < p1 )
+         throw Error( "Invalid or corrupted compressed block data." );
+   }
+
+   /*
+    * Returns the uncompressed data of the specified subblock, either from the
+    * subblock cache or by loading and uncompressing it.
+    */
+   const ByteArray& UncompressedSubblock( File& file, size_type index )
+   {
+      for ( subblock_cache::iterator i = subblockCache.Begin(); i != subblockCache.End(); ++i )
+         if ( i->index == index )
+         {
+            if ( i != subblockCache.End()-1 )
+            {
+               CachedSubblock s = *i;
+               subblockCache.Remove( i );
+               subblockCache << s;
+            }
+            return subblockCache.ReverseBegin()->data;
+         }
+
+      Compression::subblock_list list;
+      Compression::Subblock subblock;
+      subblock.uncompressedSize = subblockInfo[index].uncompressedSize;
+      if ( HasCompressedData() )
+         subblock.compressedData = subblocks[index].compressedData;
+      else
+      {
+         fpos_type subblockPosition = position;
+         for ( size_type i = 0; i < index; ++i )
+            subblockPosition += subblockInfo[i].compressedSize;
+         subblock.compressedData = ByteArray( size_type( subblockInfo[index].compressedSize ) );
+         file.SetPosition( subblockPosition );
+         file.Read( subblock.compressedData.Begin(), subblock.compressedData.Length() );
+      }
+      list << subblock;
+
+      /*
+       * Byte shuffling applies to the whole block, so each subblock must be
+       * uncompressed as a plain byte sequence.
+       */
+      AutoPointer<Compression> compressor( XISF::NewCompression( compressionCodec, 1 ) );
+      CachedSubblock cached;
+      cached.index = index;
+      cached.data = compressor->Uncompress( list );
+
+      /*
+       * Keep enough subblocks to serve sequential reads of shuffled blocks,
+       * which require one subblock per byte plane.
+       */
+      size_type maxCachedSubblocks = Max( size_type( 4 ), 2*ShuffledItemSize() );
+      if ( subblockCache.Length() >= maxCachedSubblocks )
+         subblockCache.Remove( subblockCache.Begin() );
+      subblockCache << cached;
+      return subblockCache.ReverseBegin()->data;
+   }
+
+   /*
+    * Returns a new, initialized hash generator if the checksum of this block
+    * has to be verified, nullptr otherwise.
+    */
+   CryptographicHash* NewChecksumHash() const
+   {
+      if ( !HasChecksum() || checksumVerified )
+         return nullptr;
+      CryptographicHash* hash = XISF::NewCryptographicHash( checksumAlgorithm );
+      hash->Initialize();
+      return hash;
+   }
+
+   /*
+    * Reads length bytes from the current file position, feeding the hash
+    * generator (if any) with each chunk just read. Chunks are small enough to
+    * be hashed while still cached, so checksum verification requires no
+    * additional pass over the data.
+    */
+   static void ReadAndHash( File& file, void* dst, size_type length, CryptographicHash* hash )
+   {
+      const size_type chunkSize = 256*1024;
+      for ( uint8* p = reinterpret_cast<uint8*>( dst ); length > 0; )
+      {
+         size_type n = Min( chunkSize, length );
+         file.Read( p, n );
+         if ( hash != nullptr )
+            hash->Update( p, n );
+         p += n;
+         length -= n;
+      }
+   }
+
+   /*
+    * Reads the entire uncompressed attachment to dst, verifying its checksum.
+    */
+   void ReadAttachment( File& file, void* dst ) const
+   {
+      AutoPointer<CryptographicHash> hash( NewChecksumHash() );
+      file.SetPosition( position );
+      ReadAndHash( file, dst, size, hash.Pointer() );
+      if ( hash )
+         CheckChecksum( hash->Finalize(), hash->AlgorithmName() );
+   }
+
+   void CheckChecksum( const ByteArray& theChecksum, const String& algorithmName ) const
+   {
+      checksumVerified = true;
+
+      if ( theChecksum != checksum )
+         throw Error( "Block " + algorithmName + " checksum mismatch: "
+                      "Expected " + IsoString::ToHex( checksum ) +
+                         ", got " + IsoString::ToHex( theChecksum ) );
+   }
+
    void VerifyChecksum( File& file ) const
    {
       if ( HasChecksum() )
@@ -337,19 +591,15 @@ struct XISFInputDataBlock
             if ( IsAttachment() )
             {
                hash->Initialize();
-               const size_type chunkSize = 4096;
-               size_type numberOfChunks = size / chunkSize;
-               size_type lastChunkSize = size % chunkSize;
-               ByteArray chunk( chunkSize );
+               const size_type chunkSize = 256*1024;
+               ByteArray chunk( size_type( Min( fsize_type( chunkSize ), size ) ) );
                file.SetPosition( position );
-               for ( size_type i = 0; i <= numberOfChunks; ++i )
+               for ( fsize_type remaining = size; remaining > 0; )
                {
-                  size_type thisChunkSize = (i < numberOfChunks) ? chunkSize : lastChunkSize;
-                  if ( thisChunkSize > 0 )
-                  {
-                     file.Read( reinterpret_cast<void*>( chunk.Begin() ), thisChunkSize );
-                     hash->Update( chunk.Begin(), thisChunkSize );
-                  }
+                  size_type n = size_type( Min( fsize_type( chunkSize ), remaining ) );
+                  file.Read( reinterpret_cast<void*>( chunk.Begin() ), n );
+                  hash->Update( chunk.Begin(), n );
+                  remaining -= n;
                }
                theChecksum = hash->Finalize();
             }
@@ -372,12 +622,7 @@ struct XISFInputDataBlock
                }
             }
 
-            checksumVerified = true;
-
-            if ( theChecksum != checksum )
-               throw Error( "Block " + hash->AlgorithmName() + " checksum mismatch: "
-                            "Expected " + IsoString::ToHex( checksum ) +
-                               ", got " + IsoString::ToHex( theChecksum ) );
+            CheckChecksum( theChecksum, hash->AlgorithmName() );
          }
    }
 
@@ -389,30 +634,35 @@ struct XISFInputDataBlock
             if ( !checksumVerified )
                throw Error( String( "XISFInputDataBlock::ApplyByteOrder(): " ) + "Internal error: Invalid function call." );
 
-         switch ( itemSize )
-         {
-         case 1:
-            break;
-         case 2:
-            for ( uint16* p = reinterpret_cast<uint16*>( dst ), * q = p + dstSize/2; p < q; ++p )
-               *p = BigToLittleEndian( *p );
-            break;
-         case 4:
-            for ( uint32* p = reinterpret_cast<uint32*>( dst ), * q = p + dstSize/4; p < q; ++p )
-               *p = BigToLittleEndian( *p );
-            break;
-         case 8:
-            for ( uint64* p = reinterpret_cast<uint64*>( dst ), * q = p + dstSize/8; p < q; ++p )
-               *p = BigToLittleEndian( *p );
-            break;
-         default: // ?!
-            break;
-         }
+         ReverseByteOrder( dst, dstSize, itemSize );
 
          byteOrderApplied = true;
       }
    }
 
+   static void ReverseByteOrder( void* dst, size_type dstSize, unsigned itemSize )
+   {
+      switch ( itemSize )
+      {
+      case 1:
+         break;
+      case 2:
+         for ( uint16* p = reinterpret_cast<uint16*>( dst ), * q = p + dstSize/2; p < q; ++p )
+            *p = BigToLittleEndian( *p );
+         break;
+      case 4:
+         for ( uint32* p = reinterpret_cast<uint32*>( dst ), * q = p + dstSize/4; p < q; ++p )
+            *p = BigToLittleEndian( *p );
+         break;
+      case 8:
+         for ( uint64* p = reinterpret_cast<uint64*>( dst ), * q = p + dstSize/8; p < q; ++p )
+            *p = BigToLittleEndian( *p );
+         break;
+      default: // ?!
+         break;
+      }
+   }
+
    void ApplyByteOrder()
    {
       if ( !HasData() )
@@ -558,9 +808,11 @@ public:
             header.SetLength( m_headerLength );
             m_file.Read( reinterpret_cast<void*>( header.Begin() ), m_headerLength );
 
+            header.ResizeToNullTerminated();
+
             xml.SetParserOption( XMLParserOption::IgnoreComments );
             xml.SetParserOption( XMLParserOption::IgnoreUnknownElements );
-            xml.Parse( header.UTF8ToUTF16() );
+            xml.ParseUTF8( header );
          }
 
          if ( xml.RootElement()->Name() != "xisf" || xml.RootElement()->AttributeValue( "version" ) != "1.0" )
@@ -1595,7 +1847,8 @@ private:
 
    void GetBlockData( XISFInputDataBlock& block, void* dst, size_type dstSize, size_type offset = 0u )
    {
-      bool verbose = m_xisfOptions.verbosity > 0 && block.IsCompressed() && !block.HasData();
+      bool verbose = m_xisfOptions.verbosity > 0 && block.IsCompressed() && !block.HasData()
+                  && !block.IsIncrementalRead( dstSize, offset );
       if ( verbose )
          Log( "Uncompressing block (" +
                String( XISF::CompressionCodecId( block.compressionCodec ) ) + "): " +
@@ -3004,10 +3257,11 @@ XMLDocument* XISFReader::ExtractHeader( const String& path, XMLParserOptions opt
    header.SetLength( signature.headerLength );
    file.Read( reinterpret_cast<void*>( header.Begin() ), signature.headerLength );
    file.Close();
+   header.ResizeToNullTerminated();
 
    AutoPointer<XMLDocument> xml = new XMLDocument;
    xml->SetParserOptions( options );
-   xml->Parse( header.UTF8ToUTF16() );
+   xml->ParseUTF8( header );
    return xml.Release();
 }
 
@@ -52,6 +52,7 @@
 #include <pcl/Compression.h>
 #include <pcl/Cryptography.h>
 #include <pcl/MetaModule.h>
+#include <pcl/ThreadPool.h>
 #include <pcl/Version.h>
 #include <pcl/XISF.h>
 
@@ -71,6 +72,14 @@ struct XISFOutputBlock
 
    typedef XISF::block_compression     block_compression;
 
+   struct SubblockDimensions
+   {
+      fsize_type compressedSize   = 0; // size in bytes of the compressed subblock.
+      fsize_type uncompressedSize = 0; // size in bytes of the uncompressed subblock.
+   };
+
+   typedef Array<SubblockDimensions>   subblock_info;
+
    IsoString         attachmentPos;
    block_compression compressionCodec  = XISFCompression::None;
    int               itemSize          = 1;
@@ -79,6 +88,17 @@ struct XISFOutputBlock
    block_checksum    checksumAlgorithm = XISFChecksum::None;
    ByteArray         checksum;
 
+   /*
+    * Streamed blocks have already been written to the output file by the
+    * engine. streamPos is the block position relative to the beginning of
+    * streamed data, streamSize is the block size in bytes, and streamInfo
+    * describes the subblocks of a compressed streamed block.
+    */
+   bool              streamed          = false;
+   fpos_type         streamPos         = 0;
+   fsize_type        streamSize        = 0;
+   subblock_info     streamInfo;
+
    XISFOutputBlock() :
       attachmentPos( UniqueAttachmentToken() )
    {
@@ -123,6 +143,9 @@ struct XISFOutputBlock
 
    size_type BlockSize() const
    {
+      if ( streamed )
+         return streamSize;
+
       if ( HasData() )
          return data.Length();
 
@@ -160,8 +183,12 @@ struct XISFOutputBlock
       if ( IsCompressed() )
       {
          size_type uncompressedSize = 0;
-         for ( const Compression::Subblock& subblock : subblocks )
-            uncompressedSize += subblock.uncompressedSize;
+         if ( streamed )
+            for ( const SubblockDimensions& info : streamInfo )
+               uncompressedSize += info.uncompressedSize;
+         else
+            for ( const Compression::Subblock& subblock : subblocks )
+               uncompressedSize += subblock.uncompressedSize;
          value = String( XISF::CompressionCodecId( compressionCodec ) ) + ':' + String( uncompressedSize );
          if ( itemSize > 1 && XISF::CompressionNeedsItemSize( compressionCodec ) )
             value += ':' + String( itemSize );
@@ -173,7 +200,18 @@ struct XISFOutputBlock
    {
       // subblocks="<cs0>,<us0>:<cs1>,<us1>:...:<csN-1>,<usN-1>"
       String value;
-      if ( subblocks.Length() > 1 )
+      if ( streamed )
+      {
+         if ( streamInfo.Length() > 1 )
+            for ( subblock_info::const_iterator i = streamInfo.Begin(); ; )
+            {
+               value.AppendFormat( "%llu,%llu", i->compressedSize, i->uncompressedSize );
+               if ( ++i == streamInfo.End() )
+                  break;
+               value += ':';
+            }
+      }
+      else if ( subblocks.Length() > 1 )
          for ( subblock_list::const_iterator i = subblocks.Begin(); ; )
          {
             value.AppendFormat( "%llu,%llu", i->compressedData.Length(), i->uncompressedSize );
@@ -184,7 +222,7 @@ struct XISFOutputBlock
       return value;
    }
 
-   void CompressData( block_compression method, int bytesPerItem, int level )
+   void CompressData( block_compression method, int bytesPerItem, int level, bool useSubblocks )
    {
       if ( HasData() )
       {
@@ -193,6 +231,8 @@ struct XISFOutputBlock
 
          AutoPointer<Compression> compressor( XISF::NewCompression( method, bytesPerItem ) );
          compressor->SetCompressionLevel( level );
+         if ( useSubblocks )
+            compressor->SetSubblockSize( XISF::DefaultCompressionSubblockSize );
 
          subblocks = compressor->Compress( data );
          if ( subblocks.IsEmpty() )
@@ -383,19 +423,32 @@ public:
       /*
        * Replace block position attributes. This is an iterative algorithm
        * resilient to variations in attribute value lengths.
+       *
+       * Streamed blocks have fixed positions after the space reserved for the
+       * XML header. If the header does not fit in the reserved space, all
+       * streamed data are moved forward in the output file. The rest of
+       * attached blocks follow streamed data.
        */
       for ( size_type n = 0; ; )
       {
-         fpos_type pos = AlignedPosition( sizeof( XISFFileSignature ) + m_text.Length() );
+         fpos_type headerEnd = fpos_type( sizeof( XISFFileSignature ) + m_text.Length() );
+         if ( m_file.IsOpen() )
+            if ( headerEnd > m_streamBase )
+               MoveStreamedData( AlignedPosition( headerEnd + StreamedHeaderReserve( 0 ) ) );
+
+         fpos_type pos = AlignedPosition( m_file.IsOpen() ? m_streamBase + m_streamEnd : headerEnd );
          for ( XISFOutputBlock& block : m_blocks )
          {
-            IsoString attachmentPos = IsoString().Format( "attachment:%llu", pos );
+            fpos_type blockPos = block.streamed ? m_streamBase + block.streamPos : pos;
+            IsoString attachmentPos = IsoString().Format( "attachment:%llu", blockPos );
             m_text.ReplaceString( block.attachmentPos, attachmentPos );
-            pos = AlignedPosition( pos + block.BlockSize() );
+            if ( !block.streamed )
+               pos = AlignedPosition( pos + block.BlockSize() );
             block.attachmentPos = attachmentPos;
          }
          if ( m_text.Length() == n )
-            break;
+            if ( !m_file.IsOpen() || fpos_type( sizeof( XISFFileSignature ) + m_text.Length() ) <= m_streamBase )
+               break;
          n = m_text.Length();
       }
 
@@ -406,27 +459,38 @@ public:
       // Prepare sufficient unused space, if necessary for alignment.
       ByteArray zero( size_type( m_xisfOptions.blockAlignmentSize ), uint8( 0 ) );
 
-      // Create the output file.
-      File file = File::CreateFileForWriting( m_path );
+      // Create the output file, unless we already have streamed data.
+      if ( !m_file.IsOpen() )
+         m_file.CreateForWriting( m_path );
 
       // 1. XISF signature.
-      file.Write( XISFFileSignature( uint32( m_text.Length() ) ) );
+      m_file.SetPosition( 0 );
+      m_file.Write( XISFFileSignature( uint32( m_text.Length() ) ) );
 
       // 2. XISF header.
-      file.Write( reinterpret_cast<const void*>( m_text.Begin() ), m_text.Length() );
+      m_file.Write( reinterpret_cast<const void*>( m_text.Begin() ), m_text.Length() );
 
-      // 3. Attached XISF blocks.
-      for ( const XISFOutputBlock& block : m_blocks )
+      // Clear unused header space and skip streamed data.
+      if ( m_streamBase > 0 )
       {
-         fpos_type pos = file.Position();
-         fsize_type padding = AlignedPosition( pos ) - pos;
-         if ( padding )
-            file.Write( zero.Begin(), padding );
-         block.WriteData( file );
+         ByteArray unused( size_type( m_streamBase - m_file.Position() ), uint8( 0 ) );
+         m_file.Write( unused.Begin(), unused.Length() );
+         m_file.SetPosition( m_streamBase + m_streamEnd );
       }
 
+      // 3. Attached XISF blocks.
+      for ( const XISFOutputBlock& block : m_blocks )
+         if ( !block.streamed )
+         {
+            fpos_type pos = m_file.Position();
+            fsize_type padding = AlignedPosition( pos ) - pos;
+            if ( padding )
+               m_file.Write( zero.Begin(), padding );
+            block.WriteData( m_file );
+         }
+
       // Close the output file.
-      file.Close();
+      m_file.Close();
 
       // Liberate us.
       Reset();
@@ -786,10 +850,11 @@ public:
       CloseImage();
 
       m_info = info;
-      m_randomData = ByteArray( size_type( m_info.width )
-                                         * m_info.height
-                                         * m_info.numberOfChannels
-                                         * (m_options.bitsPerSample >> 3), uint8( 0 ) );
+      size_type blockSize = BlockSampleSize( m_info.height ) * m_info.numberOfChannels;
+      if ( blockSize >= XISF::MinStreamedImageSize )
+         StartStreamedImage( blockSize );
+      else
+         m_randomData = ByteArray( blockSize, uint8( 0 ) );
    }
 
    /*
@@ -798,7 +863,7 @@ public:
    template <typename T, class P>
    void WriteSamples( const T* buffer, int startRow, int rowCount, int channel, P* )
    {
-      if ( !m_randomData.IsEmpty() ) // CreateImage() should have been called before this
+      if ( !m_randomData.IsEmpty() || m_streaming ) // CreateImage() should have been called before this
          if ( rowCount > 0 )
             if ( m_options.complexSample )
                switch ( m_options.bitsPerSample )
@@ -827,7 +892,7 @@ public:
     */
    void CloseImage()
    {
-      if ( !m_randomData.IsEmpty() ) // CreateImage() should have been called before this
+      if ( !m_randomData.IsEmpty() || m_streaming ) // CreateImage() should have been called before this
       {
          if ( m_xisfOptions.verbosity > 0 )
             LogLn( "Writing image" + (m_id.IsEmpty() ? String() : String( " '" + m_id + '\'' )) +
@@ -838,7 +903,10 @@ public:
 
          XMLElement* element = NewElement( m_root, "Image" );
          WriteImageAttributes( element );
-         NewBlock( element, m_randomData, m_options.bitsPerSample >> 3, false/*canInline*/ );
+         if ( m_streaming )
+            NewStreamedBlock( element, m_options.bitsPerSample >> 3 );
+         else
+            NewBlock( element, m_randomData, m_options.bitsPerSample >> 3, false/*canInline*/ );
          WriteImageElements( element );
          ResetImage();
       }
@@ -859,6 +927,9 @@ private:
    String                  m_path;            // path to the current output file
    IsoString               m_text;            // the XML header, UTF-8
    XISFOutputBlockArray    m_blocks;          // attached blocks
+   File                    m_file;            // output file, open after the first streamed image
+   fpos_type               m_streamBase = 0;  // file position of streamed data
+   fpos_type               m_streamEnd = 0;   // end of streamed data, relative to m_streamBase
 
    /*
     * Image data.
@@ -875,6 +946,10 @@ private:
    UInt8Image              m_thumbnail;       // thumbnail image
    XISFOutputPropertyArray m_imageProperties; // image properties
    ByteArray               m_randomData;      // sequential/random access image data
+   bool                    m_streaming = false; // the current image is being streamed
+   fpos_type               m_streamPos = 0;   // position of the streamed image, relative to m_streamBase
+   AutoPointer<CryptographicHash> m_streamHash; // checksum of sequentially streamed samples
+   size_type               m_streamHashed = 0; // length of the hashed streamed data
 
    /*
     * Reset the state of the engine and destroy all internal data structures.
@@ -886,6 +961,9 @@ private:
       m_text.Clear();
       m_blocks.Clear();
       m_lastKeywords.Clear();
+      if ( m_file.IsOpen() )
+         m_file.Close();
+      m_streamBase = m_streamEnd = 0;
       ResetImage();
    }
 
@@ -904,6 +982,10 @@ private:
       m_thumbnail.FreeData();
       m_imageProperties.Clear();
       m_randomData.Clear();
+      m_streaming = false;
+      m_streamPos = 0;
+      m_streamHash.Destroy();
+      m_streamHashed = 0;
    }
 
    /*
@@ -1165,7 +1247,7 @@ private:
                  String().Format( ":%d): ", compressionLevel ) +
                  File::SizeAsString( uncompressedSize ) + " -> " );
 
-         block.CompressData( m_xisfOptions.compressionCodec, itemSize, compressionLevel );
+         block.CompressData( m_xisfOptions.compressionCodec, itemSize, compressionLevel, m_xisfOptions.compressionSubblocks );
 
          if ( m_xisfOptions.verbosity > 0 )
          {
@@ -1378,11 +1460,21 @@ private:
    template <class I, class P>
    void WriteSamples( const typename I::sample* buffer, int startRow, int rowCount, int channel, I*, P* )
    {
-      typename P::sample* p = reinterpret_cast<typename P::sample*>( m_randomData.At( BlockSampleOffset( startRow, channel ) ) );
       size_type n = BlockSampleCount( rowCount );
+      Array<typename P::sample> samples;
+      typename P::sample* p;
+      if ( m_streaming )
+      {
+         samples = Array<typename P::sample>( n );
+         p = samples.Begin();
+      }
+      else
+         p = reinterpret_cast<typename P::sample*>( m_randomData.At( BlockSampleOffset( startRow, channel ) ) );
       XISF::EnsurePTLUTInitialized();
       for ( size_type i = 0; i < n; ++i, ++p, ++buffer )
          *p = P::ToSample( *buffer );
+      if ( m_streaming )
+         WriteStreamedSamples( samples.Begin(), BlockSampleOffset( startRow, channel ), BlockSampleSize( rowCount ) );
    }
 
    /*
@@ -1391,7 +1483,300 @@ private:
    template <class P>
    void WriteSamples( const typename P::sample* buffer, int startRow, int rowCount, int channel, P*, P* )
    {
-      ::memcpy( m_randomData.At( BlockSampleOffset( startRow, channel ) ), buffer, BlockSampleSize( rowCount ) );
+      if ( m_streaming )
+         WriteStreamedSamples( buffer, BlockSampleOffset( startRow, channel ), BlockSampleSize( rowCount ) );
+      else
+         ::memcpy( m_randomData.At( BlockSampleOffset( startRow, channel ) ), buffer, BlockSampleSize( rowCount ) );
+   }
+
+   /*
+    * Streamed image output.
+    *
+    * A streamed image is written directly to the output file as a contiguous
+    * sequence of pixel samples starting at m_streamBase + m_streamPos. The
+    * output file is created when the first streamed image is created, with
+    * some space reserved for the XML header, which is written when the output
+    * stream is closed.
+    *
+    * Compressed streamed images are compressed when the image is closed,
+    * reading back pixel samples by subblocks and writing compressed subblocks
+    * after the uncompressed data. Compressed subblocks are then moved to the
+    * block position in the correct order, and the file is truncated. Memory
+    * usage is thus proportional to the subblock size, not to the image size.
+    *
+    * Block checksums are computed on the fly: for uncompressed blocks as
+    * pixel samples are written, provided that they are written sequentially,
+    * and for compressed blocks as subblocks are moved to their final
+    * locations. Only when this is not possible is a streamed block read back
+    * from the output file to compute its checksum.
+    */
+
+   /*
+    * Estimated space required for the XML header, including subblock
+    * dimensions for a compressed block of the specified size.
+    */
+   static fsize_type StreamedHeaderReserve( fsize_type blockSize )
+   {
+      return 256*1024 + 32*(blockSize/XISF::DefaultCompressionSubblockSize);
+   }
+
+   void StartStreamedImage( size_type blockSize )
+   {
+      if ( !m_file.IsOpen() )
+      {
+         m_file.Create( m_path );
+         m_streamBase = AlignedPosition( sizeof( XISFFileSignature ) + StreamedHeaderReserve( blockSize ) );
+         m_streamEnd = 0;
+      }
+
+      m_streamPos = AlignedPosition( m_streamBase + m_streamEnd ) - m_streamBase;
+      m_file.Resize( m_streamBase + m_streamPos + blockSize );
+      m_streaming = true;
+
+      m_streamHash.Destroy();
+      m_streamHashed = 0;
+      if ( m_xisfOptions.checksumAlgorithm != XISFChecksum::None )
+         if ( m_xisfOptions.compressionCodec == XISFCompression::None )
+         {
+            m_streamHash = XISF::NewCryptographicHash( m_xisfOptions.checksumAlgorithm );
+            m_streamHash->Initialize();
+         }
+   }
+
+   void WriteStreamedSamples( const void* buffer, size_type offset, size_type size )
+   {
+      m_file.SetPosition( m_streamBase + m_streamPos + offset );
+      m_file.Write( buffer, size );
+
+      if ( m_streamHash )
+         if ( offset == m_streamHashed )
+         {
+            m_streamHash->Update( buffer, size );
+            m_streamHashed += size;
+         }
+         else // not sequential, the block will have to be read back
+            m_streamHash.Destroy();
+   }
+
+   /*
+    * Generate a new output data block for the current streamed image.
+    */
+   void NewStreamedBlock( XMLElement* element, int itemSize )
+   {
+      XISFOutputBlock block;
+      block.streamed = true;
+      block.streamPos = m_streamPos;
+      block.streamSize = BlockSampleSize( m_info.height ) * m_info.numberOfChannels;
+
+      if ( m_xisfOptions.compressionCodec != XISFCompression::None )
+         CompressStreamedBlock( block, itemSize );
+
+      if ( m_xisfOptions.checksumAlgorithm != XISFChecksum::None )
+         if ( !block.HasChecksum() )
+            if ( m_streamHash && m_streamHashed == size_type( block.streamSize ) )
+            {
+               block.checksumAlgorithm = m_xisfOptions.checksumAlgorithm;
+               block.checksum = m_streamHash->Finalize();
+            }
+            else
+               ComputeStreamedChecksum( block );
+      m_streamHash.Destroy();
+
+      WriteBlockCompressionAttributes( element, block );
+      WriteBlockChecksumAttributes( element, block );
+      element->SetAttribute( "location", block.attachmentPos + ':' + String( block.streamSize ) );
+      m_blocks << block;
+
+      m_streamEnd = block.streamPos + block.streamSize;
+      m_file.Resize( m_streamBase + m_streamEnd );
+   }
+
+   /*
+    * Compress a streamed block by subblocks.
+    *
+    * With byte shuffling, each byte plane of the block is divided into
+    * separate subblocks. Compressed subblocks are generated for batches of
+    * items (one subblock per byte plane and item range) in parallel, and are
+    * written temporarily after the uncompressed block data.
+    */
+   void CompressStreamedBlock( XISFOutputBlock& block, int itemSize )
+   {
+      XISF::block_compression codec = m_xisfOptions.compressionCodec;
+      if ( itemSize < 2 )
+         codec = XISF::CompressionCodecNoShuffle( codec );
+      int compressionLevel = XISF::CompressionLevelForMethod( codec, m_xisfOptions.compressionLevel );
+
+      size_type uncompressedSize = block.streamSize;
+      if ( m_xisfOptions.verbosity > 0 )
+         Log( "<end><cbr>Compressing block (" +
+              String( XISF::CompressionCodecId( codec ) ) +
+              String().Format( ":%d): ", compressionLevel ) +
+              File::SizeAsString( uncompressedSize ) + " -> " );
+
+      AutoPointer<Compression> compressor( XISF::NewCompression( XISF::CompressionCodecNoShuffle( codec ), 1 ) );
+      compressor->SetCompressionLevel( compressionLevel );
+      compressor->DisableParallelProcessing();
+
+      size_type m = XISF::CompressionUsesByteShuffle( codec ) ? size_type( itemSize ) : size_type( 1 );
+      size_type numberOfItems = uncompressedSize/m;
+      size_type tailSize = uncompressedSize % m;
+      size_type chunkItems = XISF::DefaultCompressionSubblockSize;
+      size_type numberOfChunks = (numberOfItems + chunkItems - 1)/chunkItems;
+      size_type batchChunks = Max( size_type( 1 ), Min( size_type( ThreadPool::NumberOfWorkers() )/m, numberOfChunks ) );
+
+      fpos_type blockPos = m_streamBase + block.streamPos;
+      fpos_type spillPos = blockPos + uncompressedSize;
+
+      /*
+       * Spilled subblock positions and dimensions, indexed in final subblock
+       * order (plane-major), followed by the uncompressed tail, if any.
+       */
+      Array<fpos_type> spillPositions( m*numberOfChunks + 1 );
+      XISFOutputBlock::subblock_info info( m*numberOfChunks + 1 );
+
+      ByteArray items( batchChunks*chunkItems*m );
+      Array<ByteArray> results( batchChunks*m );
+      fsize_type compressedSize = 0;
+      for ( size_type c0 = 0; c0 < numberOfChunks; c0 += batchChunks )
+      {
+         size_type c1 = Min( c0 + batchChunks, numberOfChunks );
+         size_type i0 = c0*chunkItems;
+         size_type i1 = Min( c1*chunkItems, numberOfItems );
+         m_file.SetPosition( blockPos + i0*m );
+         m_file.Read( items.Begin(), (i1 - i0)*m );
+
+         ThreadPool::ParallelFor( 0, (c1 - c0)*m,
+            [&]( size_type t0, size_type t1 )
+            {
+               for ( size_type t = t0; t < t1; ++t )
+               {
+                  size_type c = t/m;
+                  size_type j = t - c*m;
+                  size_type k0 = c*chunkItems;
+                  size_type k1 = Min( k0 + chunkItems, i1 - i0 );
+                  ByteArray plane( k1 - k0 );
+                  const uint8* src = items.At( k0*m + j );
+                  for ( size_type k = 0; k < plane.Length(); ++k, src += m )
+                     plane[k] = *src;
+                  Compression::subblock_list subblocks = compressor->Compress( plane );
+                  results[t] = subblocks.IsEmpty() ? plane : subblocks[0].compressedData;
+               }
+            }, 1 );
+
+         m_file.SetPosition( spillPos + compressedSize );
+         for ( size_type t = 0; t < (c1 - c0)*m; ++t )
+         {
+            size_type c = c0 + t/m;
+            size_type j = t % m;
+            size_type index = j*numberOfChunks + c;
+            spillPositions[index] = spillPos + compressedSize;
+            info[index].compressedSize = results[t].Length();
+            info[index].uncompressedSize = Min( chunkItems, numberOfItems - c*chunkItems );
+            m_file.Write( results[t].Begin(), results[t].Length() );
+            compressedSize += results[t].Length();
+         }
+      }
+
+      // The uncompressed tail is stored as is.
+      if ( tailSize > 0 )
+      {
+         spillPositions[m*numberOfChunks] = blockPos + numberOfItems*m;
+         info[m*numberOfChunks].compressedSize = info[m*numberOfChunks].uncompressedSize = tailSize;
+         compressedSize += tailSize;
+      }
+      else
+         info.Remove( info.At( m*numberOfChunks ) );
+
+      if ( compressedSize < fsize_type( uncompressedSize ) )
+      {
+         /*
+          * Move compressed subblocks to their final locations. Since no
+          * subblock can be larger than uncompressed data, a subblock is never
+          * moved to a location overlapping its current one or the current
+          * location of a subblock still to be moved. The block checksum is
+          * computed for the subblocks as they are moved.
+          */
+         AutoPointer<CryptographicHash> hash;
+         if ( m_xisfOptions.checksumAlgorithm != XISFChecksum::None )
+         {
+            hash = XISF::NewCryptographicHash( m_xisfOptions.checksumAlgorithm );
+            hash->Initialize();
+         }
+
+         ByteArray buffer;
+         fpos_type pos = blockPos;
+         for ( size_type i = 0; i < info.Length(); ++i )
+         {
+            size_type size = info[i].compressedSize;
+            if ( buffer.Length() < size )
+               buffer = ByteArray( size );
+            m_file.SetPosition( spillPositions[i] );
+            m_file.Read( buffer.Begin(), size );
+            m_file.SetPosition( pos );
+            m_file.Write( buffer.Begin(), size );
+            if ( hash )
+               hash->Update( buffer.Begin(), size );
+            pos += size;
+         }
+
+         if ( hash )
+         {
+            block.checksumAlgorithm = m_xisfOptions.checksumAlgorithm;
+            block.checksum = hash->Finalize();
+         }
+
+         block.compressionCodec = codec;
+         block.itemSize = itemSize;
+         block.streamSize = compressedSize;
+         block.streamInfo = info;
+      }
+      else
+         compressedSize = uncompressedSize; // not compressible, store uncompressed data
+
+      if ( m_xisfOptions.verbosity > 0 )
+         LogLn( File::SizeAsString( compressedSize ) +
+            String().Format( " (%.2f%%)", 100*double( uncompressedSize - compressedSize )/uncompressedSize ) );
+   }
+
+   /*
+    * Compute the checksum of a streamed block, reading its data back from the
+    * output file.
+    */
+   void ComputeStreamedChecksum( XISFOutputBlock& block )
+   {
+      AutoPointer<CryptographicHash> hash( XISF::NewCryptographicHash( block.checksumAlgorithm = m_xisfOptions.checksumAlgorithm ) );
+      hash->Initialize();
+      ByteArray chunk( size_type( XISF::DefaultCompressionSubblockSize ) );
+      m_file.SetPosition( m_streamBase + block.streamPos );
+      for ( fsize_type remaining = block.streamSize; remaining > 0; )
+      {
+         size_type size = size_type( Min( remaining, fsize_type( chunk.Length() ) ) );
+         m_file.Read( chunk.Begin(), size );
+         hash->Update( chunk.Begin(), size );
+         remaining -= size;
+      }
+      block.checksum = hash->Finalize();
+   }
+
+   /*
+    * Move all streamed data to a new file position newBase > m_streamBase,
+    * when the XML header does not fit in the reserved space.
+    */
+   void MoveStreamedData( fpos_type newBase )
+   {
+      fsize_type delta = newBase - m_streamBase;
+      m_file.Resize( newBase + m_streamEnd );
+      ByteArray buffer( size_type( XISF::DefaultCompressionSubblockSize ) );
+      for ( fpos_type end = m_streamEnd; end > 0; )
+      {
+         size_type size = size_type( Min( end, fpos_type( buffer.Length() ) ) );
+         end -= size;
+         m_file.SetPosition( m_streamBase + end );
+         m_file.Read( buffer.Begin(), size );
+         m_file.SetPosition( m_streamBase + end + delta );
+         m_file.Write( buffer.Begin(), size );
+      }
+      m_streamBase = newBase;
    }
 
    /*
@@ -49,9 +49,12 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------------------------------------
 
+#include <pcl/Console.h>
 #include <pcl/File.h>
 #include <pcl/XML.h>
 
+#include <string.h>
+
 namespace pcl
 {
 
@@ -1039,6 +1042,738 @@ void XMLDocument::Parse( const String& text )
    }
 }
 
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+/*
+ * Decodes a UTF-8 sequence and advances i past it. Returns zero for invalid
+ * or truncated sequences, which is never a valid name character.
+ */
+inline static uint32 DecodeUTF8Char( const char*& i, const char* j )
+{
+   uint32 c = uint8( *i++ );
+   if ( c < 0x80 )
+      return c;
+   int n;
+   if ( (c & 0xE0) == 0xC0 )
+      n = 1, c &= 0x1F;
+   else if ( (c & 0xF0) == 0xE0 )
+      n = 2, c &= 0x0F;
+   else if ( (c & 0xF8) == 0xF0 )
+      n = 3, c &= 0x07;
+   else
+      return 0;
+   for ( ; n > 0; --n, ++i )
+   {
+      if ( i == j || (uint8( *i ) & 0xC0) != 0x80 )
+         return 0;
+      c = (c << 6) | (uint8( *i ) & 0x3F);
+   }
+   return c;
+}
+
+/*
+ * Returns the first UTF-16 code unit of the UTF-8 sequence at i, or zero if
+ * i == j. XMLDocument::Parse() checks and reports individual UTF-16 code
+ * units; testing a high surrogate for supplementary characters makes both
+ * parsers accept the same documents and generate the same diagnostics.
+ */
+inline static uint32 UTF16UnitAt( const char* i, const char* j )
+{
+   if ( i == j )
+      return 0;
+   uint32 c = DecodeUTF8Char( i, j );
+   return (c < 0x10000) ? c : 0xD800 + ((c - 0x10000) >> 10);
+}
+
+inline static const char* NextUTF8Char( const char* i, const char* j )
+{
+   DecodeUTF8Char( i, j );
+   return i;
+}
+
+/*
+ * As IsToken() above, true only if the token is followed by at least one
+ * more character.
+ */
+inline static bool IsUTF8Token( const char* i, const char* j, const char* t )
+{
+   size_type n = ::strlen( t );
+   return size_type( j - i ) > n && ::memcmp( i, t, n ) == 0;
+}
+
+static const char* FindUTF8Token( const char* i, const char* j, const char* t )
+{
+   size_type n = ::strlen( t );
+   while ( i < j )
+   {
+      i = reinterpret_cast<const char*>( ::memchr( i, *t, j - i ) );
+      if ( i == nullptr )
+         break;
+      if ( size_type( j - i ) >= n && ::memcmp( i, t, n ) == 0 )
+         return i;
+      ++i;
+   }
+   return j;
+}
+
+static const char* FindUTF8ClosingChar( const char* i, const char* j, char l, char r )
+{
+   for ( size_type n = 1; i < j; ++i )
+      if ( *i == r )
+      {
+         if ( --n == 0 )
+            break;
+      }
+      else if ( *i == l )
+         ++n;
+   return i;
+}
+
+// ----------------------------------------------------------------------------
+
+String XMLStringView::ToString() const
+{
+   for ( const_iterator i = m_begin; i < m_end; ++i )
+      if ( uint8( *i ) >= 0x80 )
+         return IsoString( m_begin, m_end ).UTF8ToUTF16();
+   return String( m_begin, m_end );
+}
+
+// ----------------------------------------------------------------------------
+
+String XMLStringView::DecodedText() const
+{
+   if ( ::memchr( m_begin, '&', Length() ) == nullptr )
+      return ToString();
+   return XML::DecodedText( ToString() );
+}
+
+// ----------------------------------------------------------------------------
+
+String XMLStringView::ToAttributeValue() const
+{
+   return XML::CollapsedSpaces( Trimmed().DecodedText() );
+}
+
+// ----------------------------------------------------------------------------
+
+XMLAttributeList XMLSAXAttributeList::ToAttributeList() const
+{
+   XMLAttributeList list;
+   for ( const XMLSAXAttribute& a : *this )
+      list.SetAttribute( a.name.ToString(), a.value.ToAttributeValue() );
+   return list;
+}
+
+// ----------------------------------------------------------------------------
+
+XMLNodeLocation XMLSAXParser::Location() const
+{
+   if ( m_locPos == nullptr || m_pos < m_locPos )
+   {
+      m_locPos = m_begin;
+      m_location = XMLNodeLocation( 0, 0 );
+   }
+   /*
+    * Columns count UTF-16 code units, as in XMLDocument::Parse(). The lead
+    * byte of a four-byte sequence stands for a surrogate pair.
+    */
+   for ( ; m_locPos < m_pos; ++m_locPos )
+      if ( XML::IsLineBreakChar( *m_locPos ) )
+         ++m_location.line, m_location.column = 0;
+      else if ( (uint8( *m_locPos ) & 0xC0) != 0x80 )
+         m_location.column += (uint8( *m_locPos ) >= 0xF0) ? 2 : 1;
+   return m_location;
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXParser::SyntaxError( const String& message )
+{
+   throw XMLParseError( Location(), "Parsing XML document", message );
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * The syntax rules of this parser, the order in which they are checked, and
+ * the diagnostics generated are the same as those of XMLDocument::Parse().
+ * Errors in markup are located at the '<' delimiter of the offending tag,
+ * stray characters at their own positions, and unterminated documents at the
+ * end of the text.
+ */
+void XMLSAXParser::Parse( const char* begin, const char* end )
+{
+   if ( end - begin >= 3 )
+      if ( uint8( begin[0] ) == 0xEF && uint8( begin[1] ) == 0xBB && uint8( begin[2] ) == 0xBF )
+         begin += 3;
+
+   m_begin = m_pos = begin;
+   m_end = end;
+   m_locPos = nullptr;
+   m_depth = m_skipDepth = 0;
+   m_attributeCount = 0;
+   m_hasRoot = m_hasDeclaration = m_hasDocType = false;
+
+   for ( const char* i = m_begin; ; )
+   {
+      const char* j = reinterpret_cast<const char*>( ::memchr( i, '<', m_end - i ) );
+      if ( j == nullptr )
+         j = m_end;
+
+      if ( j > i )
+         if ( m_depth == 0 )
+         {
+            if ( !m_parserOptions.IsFlagSet( XMLParserOption::IgnoreStrayCharacters ) )
+               for ( const char* k = i; k < j; ++k )
+                  if ( !XML::IsSpaceChar( *k ) )
+                  {
+                     m_pos = k;
+                     SyntaxError( String().Format( "Stray character #x%x outside markup.", UTF16UnitAt( k, j ) ) );
+                  }
+         }
+         else if ( m_skipDepth == 0 )
+         {
+            // Text nodes are located at the end of the text.
+            m_pos = j;
+            Characters( XMLStringView( i, j ) );
+         }
+
+      if ( j == m_end )
+         break;
+
+      m_pos = j;
+
+      const char* k = SkipWhitespace( j+1, m_end );
+      if ( k == m_end )
+         SyntaxError( "Unmatched start-tag delimiter." );
+
+      if ( *k == '/' || XML::IsNameStartChar( UTF16UnitAt( k, m_end ) ) )
+         i = ParseElementTag( k );
+      else if ( *k == '!' )
+         i = ParseSpecialTag( k+1 );
+      else if ( *k == '?' )
+         i = ParseProcessingInstructions( k );
+      else
+         SyntaxError( String().Format( "Invalid name start character #x%x", UTF16UnitAt( k, m_end ) ) );
+   }
+
+   m_pos = m_end;
+
+   if ( m_depth > 0 )
+      SyntaxError( "Incomplete element definition: Expected end-tag '/" + m_elements[m_depth-1].ToString() + "'" );
+
+   if ( !m_hasRoot )
+      SyntaxError( "No root element has been defined." );
+}
+
+// ----------------------------------------------------------------------------
+
+XMLSAXParser::TagData XMLSAXParser::ParseTag( const char* i )
+{
+   TagData t;
+   t.start = t.end = t.PI = false;
+
+   i = SkipWhitespace( i, m_end );
+   if ( i == m_end )
+      SyntaxError( "Parsing XML tag: Missing tag name." );
+   if ( *i == '/' )
+   {
+      t.end = true;
+      ++i;
+   }
+   else
+   {
+      t.start = true;
+      if ( *i == '?' )
+      {
+         t.PI = t.end = true;
+         ++i;
+      }
+   }
+
+   if ( !XML::IsNameStartChar( UTF16UnitAt( i, m_end ) ) )
+      SyntaxError( String().Format( "Parsing XML tag: Invalid tag name starting character #x%x", UTF16UnitAt( i, m_end ) ) );
+
+   const char* j = FindUTF8ClosingChar( i, m_end, '<', '>' );
+   if ( j == m_end )
+      SyntaxError( "Parsing XML tag: Unmatched start-tag delimiter." );
+   if ( j == i )
+      SyntaxError( "Parsing XML tag: Missing tag name." );
+   t.next = j + 1;
+   if ( t.PI )
+   {
+      if ( *--j != '?' )
+         SyntaxError( "Parsing XML tag: Invalid PI tag syntax: Expected '?>' tag delimiter." );
+      if ( j == i )
+         SyntaxError( "Parsing XML tag: Missing PI tag name." );
+   }
+   else if ( *(j-1) == '/' )
+   {
+      if ( t.end )
+         SyntaxError( "Parsing XML tag: Invalid end-tag syntax: Unexpected '/>' tag delimiter." );
+      t.end = true;
+      if ( --j == i )
+         SyntaxError( "Parsing XML tag: Missing tag name." );
+   }
+
+   const char* k = i;
+   while ( k < j && !XML::IsSpaceChar( *k ) )
+      ++k;
+   for ( const char* l = NextUTF8Char( i, k ); l < k; l = NextUTF8Char( l, k ) )
+      if ( !XML::IsNameChar( UTF16UnitAt( l, k ) ) )
+         SyntaxError( String().Format( "Parsing XML tag: Invalid tag name character #x%x", UTF16UnitAt( l, k ) ) );
+   t.name = XMLStringView( i, k );
+
+   k = SkipWhitespace( k, m_end );
+   t.parameters = (k < j) ? XMLStringView( k, j ).Trimmed() : XMLStringView( j, j );
+   return t;
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXParser::ParseAttributes( const XMLStringView& text )
+{
+   m_attributeCount = 0;
+
+   for ( const char* i = text.Begin(), * end = text.End(); ; )
+   {
+      i = SkipWhitespace( i, end );
+      if ( i == end )
+         break;
+
+      if ( !XML::IsNameStartChar( UTF16UnitAt( i, end ) ) )
+         SyntaxError( String().Format( "Parsing XML attribute list: Invalid attribute name starting character #x%x", UTF16UnitAt( i, end ) ) );
+
+      const char* j = NextUTF8Char( i, end );
+      for ( ; j < end && *j != '=' && !XML::IsSpaceChar( *j ); j = NextUTF8Char( j, end ) )
+         if ( !XML::IsNameChar( UTF16UnitAt( j, end ) ) )
+            SyntaxError( String().Format( "Parsing XML attribute list: Invalid attribute name character #x%x", UTF16UnitAt( j, end ) ) );
+
+      const char* k = SkipWhitespace( j, end );
+      if ( k == end || *k != '=' )
+         SyntaxError( "Parsing XML attribute list: Expected equal sign." );
+
+      k = SkipWhitespace( k+1, end );
+      if ( k == end )
+         SyntaxError( "Parsing XML attribute list: Missing attribute value." );
+      char q = *k;
+      if ( q != '\"' && q != '\'' )
+         SyntaxError( "Parsing XML attribute list: Expected starting double or single quote." );
+
+      ++k;
+      const char* l = reinterpret_cast<const char*>( ::memchr( k, q, end - k ) );
+      if ( l == nullptr )
+         SyntaxError( "Parsing XML attribute list: Unmatched double or single quote." );
+
+      if ( m_attributeCount == m_attributes.Length() )
+         m_attributes.Add( XMLSAXAttribute() );
+      XMLSAXAttribute& a = m_attributes[m_attributeCount++];
+      a.name = XMLStringView( i, j );
+      a.value = XMLStringView( k, l );
+
+      i = l+1;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+const char* XMLSAXParser::ParseElementTag( const char* p )
+{
+   TagData t = ParseTag( p );
+
+   if ( t.start )
+   {
+      ParseAttributes( t.parameters );
+
+      m_hasRoot = true;
+      PushElement( t.name );
+      if ( m_skipDepth == 0 )
+         StartElement( t.name, XMLSAXAttributeList( m_attributes.Begin(), m_attributeCount ) );
+      if ( t.end )
+         PopElement( t.name );
+   }
+   else
+   {
+      if ( m_depth == 0 )
+         SyntaxError( "Stray end-tag '" + t.name.ToString() + "'" );
+      if ( t.name != m_elements[m_depth-1] )
+         SyntaxError( "Unexpected end-tag '/" + t.name.ToString() + "'; expected '/" + m_elements[m_depth-1].ToString() + "'" );
+
+      PopElement( t.name );
+   }
+
+   return t.next;
+}
+
+// ----------------------------------------------------------------------------
+
+const char* XMLSAXParser::ParseSpecialTag( const char* p )
+{
+   if ( IsUTF8Token( p, m_end, "--" ) )
+   {
+      const char* i = p + 2;
+      const char* j = FindUTF8Token( i, m_end, "-->" );
+      if ( j == m_end )
+         SyntaxError( "Unmatched comment start." );
+
+      if ( !m_parserOptions.IsFlagSet( XMLParserOption::IgnoreComments ) )
+         if ( m_skipDepth == 0 )
+            Comment( XMLStringView( i, j ) );
+
+      return j+3;
+   }
+
+   if ( IsUTF8Token( p, m_end, "DOCTYPE" ) )
+   {
+      if ( m_hasRoot )
+         SyntaxError( "Invalid DOCTYPE declaration after the root element." );
+      if ( m_hasDocType )
+         SyntaxError( "Duplicate DOCTYPE declaration." );
+
+      TagData t = ParseTag( p );
+      if ( t.end || t.parameters.IsEmpty() )
+         SyntaxError( "Invalid DOCTYPE tag syntax." );
+
+      const char* k = t.parameters.Begin();
+      while ( k < t.parameters.End() && !XML::IsSpaceChar( *k ) )
+         ++k;
+
+      m_hasDocType = true;
+      DocTypeDeclaration( XMLStringView( t.parameters.Begin(), k ), XMLStringView( k, t.parameters.End() ).Trimmed() );
+
+      return t.next;
+   }
+
+   if ( IsUTF8Token( p, m_end, "[CDATA[" ) )
+   {
+      const char* i = p + 7;
+      const char* j = FindUTF8Token( i, m_end, "]]>" );
+      if ( j == m_end )
+         SyntaxError( "Unmatched CDATA start-tag." );
+
+      if ( m_skipDepth == 0 )
+      {
+         if ( m_depth == 0 )
+            SyntaxError( "Invalid CDATA section outside an element." );
+         CDATASection( XMLStringView( i, j ) );
+      }
+
+      return j+3;
+   }
+
+   TagData t = ParseTag( p );
+
+   if ( !m_parserOptions.IsFlagSet( XMLParserOption::IgnoreUnknownElements ) )
+      if ( m_skipDepth == 0 )
+         UnknownElement( t.name, t.parameters );
+
+   return t.next;
+}
+
+// ----------------------------------------------------------------------------
+
+const char* XMLSAXParser::ParseProcessingInstructions( const char* p )
+{
+   TagData t = ParseTag( p );
+
+   if ( t.name == "xml" )
+   {
+      if ( m_hasRoot )
+         SyntaxError( "Invalid XML declaration after the root element." );
+      if ( m_hasDeclaration )
+         SyntaxError( "Duplicate XML declaration." );
+
+      ParseAttributes( t.parameters );
+      XMLSAXAttributeList attributes( m_attributes.Begin(), m_attributeCount );
+
+      String version = attributes.AttributeValue( "version" );
+      if ( version.IsEmpty() )
+         SyntaxError( "Missing XML version attribute." );
+
+      String encoding = attributes.AttributeValue( "encoding" );
+      if ( !encoding.IsEmpty() )
+         if (    encoding.CompareIC( "UTF-8" ) && encoding.CompareIC( "UTF8" )
+            && encoding.CompareIC( "UTF-16" ) && encoding.CompareIC( "UTF16" )
+            && encoding.CompareIC( "ISO-8859-1" ) )
+            SyntaxError( "Unsupported or invalid document encoding '" + encoding + "'" );
+
+      String standalone = attributes.AttributeValue( "standalone" );
+      if ( !standalone.IsEmpty() )
+         if ( standalone.CompareIC( "yes" ) && standalone.CompareIC( "no" ) )
+            SyntaxError( "Invalid document standalone attribute value '" + standalone + "'" );
+
+      m_hasDeclaration = true;
+      Declaration( attributes.RawValue( "version" ), attributes.RawValue( "encoding" ), standalone.CompareIC( "yes" ) == 0 );
+   }
+   else
+   {
+      if ( m_skipDepth == 0 )
+         ProcessingInstructions( t.name, t.parameters );
+   }
+
+   return t.next;
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXParser::PushElement( const XMLStringView& name )
+{
+   if ( size_type( m_depth ) == m_elements.Length() )
+      m_elements.Add( name );
+   else
+      m_elements[m_depth] = name;
+   ++m_depth;
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXParser::PopElement( const XMLStringView& name )
+{
+   if ( m_skipDepth == 0 )
+      EndElement( name );
+   else if ( m_skipDepth == m_depth )
+      m_skipDepth = 0;
+   --m_depth;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::StartElement( const XMLStringView& name, const XMLSAXAttributeList& attributes )
+{
+   if ( Depth() == 1 )
+   {
+      StartRootElement( name, attributes );
+      return;
+   }
+
+   if ( m_textDepth > 0 || m_failed )
+   {
+      SkipElement();
+      return;
+   }
+
+   if ( Depth() == 2 )
+   {
+      m_elementName = name.ToString();
+      m_elementLocation = Location();
+   }
+
+   try
+   {
+      StartDecodedElement( name, attributes );
+   }
+   catch ( Exception& x )
+   {
+      ShowError( x );
+      SkipElement();
+      m_failed = Depth() > 2;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::EndElement( const XMLStringView& name )
+{
+   if ( Depth() == 1 )
+      return;
+
+   if ( !m_failed )
+      try
+      {
+         EndDecodedElement( name );
+      }
+      catch ( Exception& x )
+      {
+         ShowError( x );
+         m_failed = Depth() > 2;
+      }
+
+   if ( m_textDepth == Depth() )
+      m_textDepth = 0;
+   if ( Depth() == 2 )
+      m_failed = false;
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::Characters( const XMLStringView& text )
+{
+   if ( m_textDepth == Depth() )
+   {
+      if ( m_textView.IsEmpty() && m_textBuffer.IsEmpty() )
+         m_textView = text;
+      else
+      {
+         if ( m_textBuffer.IsEmpty() )
+            m_textBuffer = m_textView.ToIsoString();
+         m_textBuffer.Append( text.Begin(), text.End() );
+      }
+   }
+   else if ( !m_failed && !text.Trimmed().IsEmpty() )
+      WarnOnUnexpectedChildNode( "text" );
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::CDATASection( const XMLStringView& )
+{
+   if ( m_textDepth != Depth() && !m_failed )
+      WarnOnUnexpectedChildNode( "CDATA" );
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::ProcessingInstructions( const XMLStringView&, const XMLStringView& )
+{
+   if ( m_textDepth != Depth() && !m_failed )
+      WarnOnUnexpectedChildNode( "processing instructions" );
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::ShowError( const Exception& x ) const
+{
+   XMLParseError( m_elementLocation, "Parsing " + m_elementName + " element", x.Message() ).Show();
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::WarnOnUnexpectedChildNode( const String& nodeType ) const
+{
+   XMLParseError e( Location(),
+         "Parsing " + ParentElementName() + " element",
+         "Ignoring unexpected XML child node of " + nodeType + " type." );
+   Console().WarningLn( "<end><cbr>** Warning: " + e.Message() );
+}
+
+// ----------------------------------------------------------------------------
+
+void XMLSAXDecoder::SkipUnknownElement( const XMLStringView& name, const String& parsingWhatElement )
+{
+   XMLParseError e( Location(),
+         "Parsing " + parsingWhatElement + " element",
+         "Skipping unknown \'" + name.ToString() + "\' child element." );
+   Console().WarningLn( "<end><cbr>** Warning: " + e.Message() );
+   SkipElement();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+/*
+ * SAX-driven generation of XMLDocument objects. Implements the same element
+ * filtering and text node rules as XMLDocument::Parse().
+ */
+class XMLDocumentBuilder : public XMLSAXParser
+{
+public:
+
+   XMLDocumentBuilder( XMLDocument& document ) :
+      m_document( document )
+   {
+      SetParserOptions( m_document.m_parserOptions );
+   }
+
+protected:
+
+   void StartElement( const XMLStringView& name, const XMLSAXAttributeList& attributes ) override
+   {
+      String elementName = name.ToString();
+      XMLAttributeList list = attributes.ToAttributeList();
+      if ( m_document.m_filter == nullptr ||
+           (*m_document.m_filter)( m_currentElement, elementName ) &&
+           (*m_document.m_filter)( m_currentElement, elementName, list ) )
+      {
+         XMLElement* element = new XMLElement( elementName, list );
+         if ( m_currentElement != nullptr )
+            m_currentElement->AddChildNode( element, Location() );
+         else
+         {
+            m_document.m_nodes << element;
+            if ( m_document.m_root == nullptr )
+               m_document.m_root = element;
+         }
+         m_currentElement = element;
+      }
+      else
+         SkipElement();
+   }
+
+   void EndElement( const XMLStringView& ) override
+   {
+      m_currentElement = m_currentElement->ParentElement();
+   }
+
+   void Characters( const XMLStringView& text ) override
+   {
+      if ( !m_currentElement->HasText() )
+      {
+         XMLStringView::const_iterator i = text.Begin();
+         for ( ; i < text.End(); ++i )
+            if ( !XML::IsSpaceChar( *i ) )
+               break;
+         if ( i == text.End() )
+            return;
+      }
+      m_currentElement->AddChildNode( new XMLText( text.DecodedText(),
+                        !m_document.m_parserOptions.IsFlagSet( XMLParserOption::NormalizeTextSpaces ) ), Location() );
+   }
+
+   void CDATASection( const XMLStringView& data ) override
+   {
+      m_currentElement->AddChildNode( new XMLCDATA( data.ToString() ), Location() );
+   }
+
+   void Comment( const XMLStringView& comment ) override
+   {
+      AddNode( new XMLComment( comment.ToString() ) );
+   }
+
+   void ProcessingInstructions( const XMLStringView& target, const XMLStringView& instructions ) override
+   {
+      AddNode( new XMLProcessingInstructions( target.ToString(), instructions.ToString() ) );
+   }
+
+   void UnknownElement( const XMLStringView& name, const XMLStringView& parameters ) override
+   {
+      AddNode( new XMLUnknownElement( name.ToString(), parameters.ToString() ) );
+   }
+
+   void Declaration( const XMLStringView& version, const XMLStringView& encoding, bool standalone ) override
+   {
+      m_document.m_xml = XMLDeclaration( version.ToAttributeValue(), encoding.ToAttributeValue(), standalone );
+   }
+
+   void DocTypeDeclaration( const XMLStringView& name, const XMLStringView& definition ) override
+   {
+      m_document.m_docType = XMLDocTypeDeclaration( name.ToString(), definition.ToString() );
+   }
+
+private:
+
+   XMLDocument& m_document;
+   XMLElement*  m_currentElement = nullptr;
+
+   void AddNode( XMLNode* node )
+   {
+      if ( m_currentElement != nullptr )
+         m_currentElement->AddChildNode( node, Location() );
+      else
+         m_document.m_nodes << node;
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+void XMLDocument::ParseUTF8( const IsoString& text )
+{
+   Clear();
+   XMLDocumentBuilder( *this ).Parse( text );
+}
+
 // ----------------------------------------------------------------------------
 
 } // pcl
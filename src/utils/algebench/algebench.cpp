@@ -0,0 +1,648 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+//
+// This file is part of the PCL linear algebra benchmark utility.
+//
+// Copyright (c) 2019 Pleiades Astrophoto S.L.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// ----------------------------------------------------------------------------
+
+/*
+ * A command line utility to benchmark the linear algebra routines of PCL.
+ *
+ * Matrix products, LU and Cholesky decompositions, Gauss-Jordan elimination
+ * and singular value decomposition are compared with the straightforward
+ * implementations used before the introduction of cache-blocked algorithms.
+ * The previous Gauss-Jordan and SVD routines were provided by the PixInsight
+ * core application, which is not available to a standalone program, so they
+ * are represented here by equivalent textbook algorithms: Gauss-Jordan
+ * elimination with full pivoting and the Golub-Reinsch SVD.
+ *
+ * Usage: algebench [<n>]
+ *
+ * where <n> is the largest matrix dimension tested (default = 1000).
+ *
+ * Copyright (c) 2019, Pleiades Astrophoto S.L.
+ */
+
+#include <pcl/Algebra.h>
+#include <pcl/ElapsedTime.h>
+#include <pcl/ErrorHandler.h>
+#include <pcl/Random.h>
+
+#include <iostream>
+
+using namespace pcl;
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+static GenericMatrix<T> RandomMatrix( int rows, int cols, RandomNumberGenerator& R )
+{
+   GenericMatrix<T> A( rows, cols );
+   for ( T& a : A )
+      a = T( 2*R() - 1 );
+   return A;
+}
+
+template <typename T>
+static double MaxDifference( const GenericMatrix<T>& A, const GenericMatrix<T>& B )
+{
+   double d = 0;
+   for ( int i = 0; i < A.Rows(); ++i )
+      for ( int j = 0; j < A.Cols(); ++j )
+         d = Max( d, Abs( double( A[i][j] ) - double( B[i][j] ) ) );
+   return d;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Matrix product, as implemented by the previous operator *( A, B ).
+ */
+template <typename T>
+static GenericMatrix<T> ReferenceProduct( const GenericMatrix<T>& A, const GenericMatrix<T>& B )
+{
+   int n = A.Rows();
+   int m = B.Cols();
+   int p = A.Cols();
+   GenericMatrix<T> R( n, m );
+   for ( int i = 0; i < n; ++i )
+      for ( int j = 0; j < m; ++j )
+      {
+         T rij = 0;
+         for ( int k = 0; k < p; ++k )
+            rij += A[i][k] * B[k][j];
+         R[i][j] = rij;
+      }
+   return R;
+}
+
+/*
+ * Gauss-Jordan elimination with full pivoting. On output, A is replaced by
+ * its inverse and B by the solution vectors.
+ */
+static void ReferenceGaussJordan( Matrix& A, Matrix& B )
+{
+   int n = A.Rows();
+   int m = B.Cols();
+   IVector indxc( n ), indxr( n ), ipiv( 0, n );
+   for ( int i = 0; i < n; ++i )
+   {
+      int irow = 0, icol = 0;
+      double big = 0;
+      for ( int j = 0; j < n; ++j )
+         if ( ipiv[j] != 1 )
+            for ( int k = 0; k < n; ++k )
+               if ( ipiv[k] == 0 )
+                  if ( Abs( A[j][k] ) >= big )
+                  {
+                     big = Abs( A[j][k] );
+                     irow = j;
+                     icol = k;
+                  }
+      ++ipiv[icol];
+      if ( irow != icol )
+      {
+         for ( int l = 0; l < n; ++l )
+            Swap( A[irow][l], A[icol][l] );
+         for ( int l = 0; l < m; ++l )
+            Swap( B[irow][l], B[icol][l] );
+      }
+      indxr[i] = irow;
+      indxc[i] = icol;
+      if ( A[icol][icol] == 0 )
+         throw Error( "ReferenceGaussJordan(): Singular matrix." );
+      double pivinv = 1/A[icol][icol];
+      A[icol][icol] = 1;
+      for ( int l = 0; l < n; ++l )
+         A[icol][l] *= pivinv;
+      for ( int l = 0; l < m; ++l )
+         B[icol][l] *= pivinv;
+      for ( int ll = 0; ll < n; ++ll )
+         if ( ll != icol )
+         {
+            double d = A[ll][icol];
+            A[ll][icol] = 0;
+            for ( int l = 0; l < n; ++l )
+               A[ll][l] -= A[icol][l]*d;
+            for ( int l = 0; l < m; ++l )
+               B[ll][l] -= B[icol][l]*d;
+         }
+   }
+   for ( int l = n; --l >= 0; )
+      if ( indxr[l] != indxc[l] )
+         for ( int k = 0; k < n; ++k )
+            Swap( A[k][indxr[l]], A[k][indxc[l]] );
+}
+
+/*
+ * Unblocked LU decomposition with partial pivoting, followed by forward and
+ * back substitution for a single right-hand side vector.
+ */
+static Vector ReferenceLUSolve( Matrix A, Vector b )
+{
+   int n = A.Rows();
+   for ( int k = 0; k < n; ++k )
+   {
+      int p = k;
+      for ( int i = k+1; i < n; ++i )
+         if ( Abs( A[i][k] ) > Abs( A[p][k] ) )
+            p = i;
+      if ( A[p][k] == 0 )
+         throw Error( "ReferenceLUSolve(): Singular matrix." );
+      if ( p != k )
+      {
+         for ( int j = 0; j < n; ++j )
+            Swap( A[p][j], A[k][j] );
+         Swap( b[p], b[k] );
+      }
+      for ( int i = k+1; i < n; ++i )
+      {
+         double l = A[i][k] /= A[k][k];
+         for ( int j = k+1; j < n; ++j )
+            A[i][j] -= l*A[k][j];
+      }
+   }
+   for ( int i = 0; i < n; ++i )
+      for ( int j = 0; j < i; ++j )
+         b[i] -= A[i][j]*b[j];
+   for ( int i = n; --i >= 0; )
+   {
+      for ( int j = i+1; j < n; ++j )
+         b[i] -= A[i][j]*b[j];
+      b[i] /= A[i][i];
+   }
+   return b;
+}
+
+/*
+ * Unblocked Cholesky decomposition A = L*Lt, followed by forward and back
+ * substitution for a single right-hand side vector.
+ */
+static Vector ReferenceCholeskySolve( Matrix A, Vector b )
+{
+   int n = A.Rows();
+   for ( int j = 0; j < n; ++j )
+   {
+      double d = A[j][j];
+      for ( int k = 0; k < j; ++k )
+         d -= A[j][k]*A[j][k];
+      if ( d <= 0 )
+         throw Error( "ReferenceCholeskySolve(): Matrix not positive definite." );
+      A[j][j] = d = Sqrt( d );
+      for ( int i = j+1; i < n; ++i )
+      {
+         double s = A[i][j];
+         for ( int k = 0; k < j; ++k )
+            s -= A[i][k]*A[j][k];
+         A[i][j] = s/d;
+      }
+   }
+   for ( int i = 0; i < n; ++i )
+   {
+      for ( int j = 0; j < i; ++j )
+         b[i] -= A[i][j]*b[j];
+      b[i] /= A[i][i];
+   }
+   for ( int i = n; --i >= 0; )
+   {
+      for ( int j = i+1; j < n; ++j )
+         b[i] -= A[j][i]*b[j];
+      b[i] /= A[i][i];
+   }
+   return b;
+}
+
+static double Sign( double a, double b )
+{
+   return (b >= 0) ? Abs( a ) : -Abs( a );
+}
+
+/*
+ * Golub-Reinsch singular value decomposition A = U*W*Vt: Householder
+ * bidiagonalization followed by implicit shifted QR iterations. On output, A
+ * is replaced by U.
+ */
+static void ReferenceSVD( Matrix& a, Vector& w, Matrix& v )
+{
+   int m = a.Rows();
+   int n = a.Cols();
+   w = Vector( 0.0, n );
+   v = Matrix( 0.0, n, n );
+   Vector rv1( 0.0, n );
+   double g = 0, scale = 0, anorm = 0;
+   int l = 0;
+
+   // Householder reduction to bidiagonal form.
+   for ( int i = 0; i < n; ++i )
+   {
+      l = i+1;
+      rv1[i] = scale*g;
+      double s = 0;
+      g = scale = 0;
+      if ( i < m )
+      {
+         for ( int k = i; k < m; ++k )
+            scale += Abs( a[k][i] );
+         if ( scale != 0 )
+         {
+            for ( int k = i; k < m; ++k )
+            {
+               a[k][i] /= scale;
+               s += a[k][i]*a[k][i];
+            }
+            double f = a[i][i];
+            g = -Sign( Sqrt( s ), f );
+            double h = f*g - s;
+            a[i][i] = f - g;
+            for ( int j = l; j < n; ++j )
+            {
+               s = 0;
+               for ( int k = i; k < m; ++k )
+                  s += a[k][i]*a[k][j];
+               f = s/h;
+               for ( int k = i; k < m; ++k )
+                  a[k][j] += f*a[k][i];
+            }
+            for ( int k = i; k < m; ++k )
+               a[k][i] *= scale;
+         }
+      }
+      w[i] = scale*g;
+      s = 0;
+      g = scale = 0;
+      if ( i < m && i != n-1 )
+      {
+         for ( int k = l; k < n; ++k )
+            scale += Abs( a[i][k] );
+         if ( scale != 0 )
+         {
+            for ( int k = l; k < n; ++k )
+            {
+               a[i][k] /= scale;
+               s += a[i][k]*a[i][k];
+            }
+            double f = a[i][l];
+            g = -Sign( Sqrt( s ), f );
+            double h = f*g - s;
+            a[i][l] = f - g;
+            for ( int k = l; k < n; ++k )
+               rv1[k] = a[i][k]/h;
+            for ( int j = l; j < m; ++j )
+            {
+               s = 0;
+               for ( int k = l; k < n; ++k )
+                  s += a[j][k]*a[i][k];
+               for ( int k = l; k < n; ++k )
+                  a[j][k] += s*rv1[k];
+            }
+            for ( int k = l; k < n; ++k )
+               a[i][k] *= scale;
+         }
+      }
+      anorm = Max( anorm, Abs( w[i] ) + Abs( rv1[i] ) );
+   }
+
+   // Accumulation of right-hand transformations.
+   for ( int i = n; --i >= 0; )
+   {
+      if ( i < n-1 )
+      {
+         if ( g != 0 )
+         {
+            for ( int j = l; j < n; ++j )
+               v[j][i] = (a[i][j]/a[i][l])/g;
+            for ( int j = l; j < n; ++j )
+            {
+               double s = 0;
+               for ( int k = l; k < n; ++k )
+                  s += a[i][k]*v[k][j];
+               for ( int k = l; k < n; ++k )
+                  v[k][j] += s*v[k][i];
+            }
+         }
+         for ( int j = l; j < n; ++j )
+            v[i][j] = v[j][i] = 0;
+      }
+      v[i][i] = 1;
+      g = rv1[i];
+      l = i;
+   }
+
+   // Accumulation of left-hand transformations.
+   for ( int i = Min( m, n ); --i >= 0; )
+   {
+      l = i+1;
+      g = w[i];
+      for ( int j = l; j < n; ++j )
+         a[i][j] = 0;
+      if ( g != 0 )
+      {
+         g = 1/g;
+         for ( int j = l; j < n; ++j )
+         {
+            double s = 0;
+            for ( int k = l; k < m; ++k )
+               s += a[k][i]*a[k][j];
+            double f = (s/a[i][i])*g;
+            for ( int k = i; k < m; ++k )
+               a[k][j] += f*a[k][i];
+         }
+         for ( int j = i; j < m; ++j )
+            a[j][i] *= g;
+      }
+      else
+         for ( int j = i; j < m; ++j )
+            a[j][i] = 0;
+      a[i][i] += 1;
+   }
+
+   // Diagonalization of the bidiagonal form.
+   for ( int k = n; --k >= 0; )
+      for ( int its = 0; ; ++its )
+      {
+         bool split = false;
+         int nm = 0;
+         for ( l = k; l >= 0; --l )
+         {
+            nm = l-1;
+            // rv1[0] is always zero.
+            if ( Abs( rv1[l] ) + anorm == anorm )
+            {
+               split = true;
+               break;
+            }
+            if ( Abs( w[nm] ) + anorm == anorm )
+               break;
+         }
+         if ( !split )
+         {
+            // Cancellation of rv1[l].
+            double c = 0, s = 1;
+            for ( int i = l; i <= k; ++i )
+            {
+               double f = s*rv1[i];
+               rv1[i] *= c;
+               if ( Abs( f ) + anorm == anorm )
+                  break;
+               g = w[i];
+               double h = Sqrt( f*f + g*g );
+               w[i] = h;
+               h = 1/h;
+               c = g*h;
+               s = -f*h;
+               for ( int j = 0; j < m; ++j )
+               {
+                  double y = a[j][nm];
+                  double z = a[j][i];
+                  a[j][nm] = y*c + z*s;
+                  a[j][i] = z*c - y*s;
+               }
+            }
+         }
+
+         double z = w[k];
+         if ( l == k )
+         {
+            // Convergence. Make the singular value nonnegative.
+            if ( z < 0 )
+            {
+               w[k] = -z;
+               for ( int j = 0; j < n; ++j )
+                  v[j][k] = -v[j][k];
+            }
+            break;
+         }
+         if ( its == 30 )
+            throw Error( "ReferenceSVD(): No convergence." );
+
+         // Shift from the bottom 2x2 minor.
+         double x = w[l];
+         nm = k-1;
+         double y = w[nm];
+         g = rv1[nm];
+         double h = rv1[k];
+         double f = ((y - z)*(y + z) + (g - h)*(g + h))/(2*h*y);
+         g = Sqrt( f*f + 1 );
+         f = ((x - z)*(x + z) + h*(y/(f + Sign( g, f )) - h))/x;
+
+         // Next QR transformation.
+         double c = 1, s = 1;
+         for ( int j = l; j <= nm; ++j )
+         {
+            int i = j+1;
+            g = rv1[i];
+            y = w[i];
+            h = s*g;
+            g = c*g;
+            z = Sqrt( f*f + h*h );
+            rv1[j] = z;
+            c = f/z;
+            s = h/z;
+            f = x*c + g*s;
+            g = g*c - x*s;
+            h = y*s;
+            y *= c;
+            for ( int jj = 0; jj < n; ++jj )
+            {
+               x = v[jj][j];
+               z = v[jj][i];
+               v[jj][j] = x*c + z*s;
+               v[jj][i] = z*c - x*s;
+            }
+            z = Sqrt( f*f + h*h );
+            w[j] = z;
+            if ( z != 0 )
+            {
+               z = 1/z;
+               c = f*z;
+               s = h*z;
+            }
+            f = c*g + s*y;
+            x = c*y - s*g;
+            for ( int jj = 0; jj < m; ++jj )
+            {
+               y = a[jj][j];
+               z = a[jj][i];
+               a[jj][j] = y*c + z*s;
+               a[jj][i] = z*c - y*s;
+            }
+         }
+         rv1[l] = 0;
+         rv1[k] = f;
+         w[k] = x;
+      }
+}
+
+/*
+ * Returns the maximum absolute difference between A and U*W*Vt.
+ */
+static double SVDResidual( const Matrix& A, const Matrix& U, const Vector& W, const Matrix& V )
+{
+   Matrix UW( U );
+   for ( int i = 0; i < UW.Rows(); ++i )
+      for ( int j = 0; j < UW.Cols(); ++j )
+         UW[i][j] *= W[j];
+   return MaxDifference( A, Matrix( UW*V.Transpose() ) );
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+static void BenchmarkProduct( int n, RandomNumberGenerator& R, const char* typeName )
+{
+   GenericMatrix<T> A = RandomMatrix<T>( n, n, R );
+   GenericMatrix<T> B = RandomMatrix<T>( n, n, R );
+   ElapsedTime T0;
+   GenericMatrix<T> C0 = ReferenceProduct( A, B );
+   double t0 = T0();
+   ElapsedTime T1;
+   GenericMatrix<T> C1 = A*B;
+   double t1 = T1();
+   std::cout << IsoString().Format( "GEMM      %-6s n=%5d  old %9.4f s  new %9.4f s  x%6.1f  maxdiff %.2e\n",
+                                    typeName, n, t0, t1, t0/t1, MaxDifference( C0, C1 ) );
+}
+
+static void BenchmarkSolvers( int n, RandomNumberGenerator& R )
+{
+   Matrix A = RandomMatrix<double>( n, n, R );
+   Matrix B = RandomMatrix<double>( n, 1, R );
+   Vector b = B.ColumnVector( 0 );
+
+   {
+      Matrix A0( A ), B0( B );
+      A0.EnsureUnique();
+      B0.EnsureUnique();
+      ElapsedTime T0;
+      ReferenceGaussJordan( A0, B0 );
+      double t0 = T0();
+      Matrix A1( A ), B1( B );
+      ElapsedTime T1;
+      InPlaceGaussJordan( A1, B1 );
+      double t1 = T1();
+      std::cout << IsoString().Format( "GaussJrdn double n=%5d  old %9.4f s  new %9.4f s  x%6.1f  maxdiff %.2e\n",
+                                       n, t0, t1, t0/t1, Max( MaxDifference( A0, A1 ), MaxDifference( B0, B1 ) ) );
+   }
+
+   {
+      ElapsedTime T0;
+      Vector x0 = ReferenceLUSolve( A, b );
+      double t0 = T0();
+      ElapsedTime T1;
+      Vector x1 = LUDecomposition( A ).Solve( b );
+      double t1 = T1();
+      std::cout << IsoString().Format( "LU        double n=%5d  old %9.4f s  new %9.4f s  x%6.1f  maxdiff %.2e\n",
+                                       n, t0, t1, t0/t1, MaxDifference( Matrix::FromColumnVector( x0 ), Matrix::FromColumnVector( x1 ) ) );
+   }
+
+   {
+      Matrix S = A.Transpose()*A;
+      for ( int i = 0; i < n; ++i )
+         S[i][i] += n;
+      ElapsedTime T0;
+      Vector x0 = ReferenceCholeskySolve( S, b );
+      double t0 = T0();
+      ElapsedTime T1;
+      Vector x1 = CholeskyDecomposition( S ).Solve( b );
+      double t1 = T1();
+      std::cout << IsoString().Format( "Cholesky  double n=%5d  old %9.4f s  new %9.4f s  x%6.1f  maxdiff %.2e\n",
+                                       n, t0, t1, t0/t1, MaxDifference( Matrix::FromColumnVector( x0 ), Matrix::FromColumnVector( x1 ) ) );
+   }
+}
+
+static void BenchmarkSVD( int m, int n, RandomNumberGenerator& R )
+{
+   Matrix A = RandomMatrix<double>( m, n, R );
+
+   Matrix U0( A );
+   U0.EnsureUnique();
+   Vector W0;
+   Matrix V0;
+   ElapsedTime T0;
+   ReferenceSVD( U0, W0, V0 );
+   double t0 = T0();
+
+   Matrix U1( A );
+   U1.EnsureUnique();
+   ElapsedTime T1;
+   InPlaceSVD svd( U1 );
+   double t1 = T1();
+
+   std::cout << IsoString().Format( "SVD       double %5dx%-5d old %9.4f s  new %9.4f s  x%6.1f  residual %.2e / %.2e\n",
+                                    m, n, t0, t1, t0/t1, SVDResidual( A, U0, W0, V0 ), SVDResidual( A, U1, svd.W, svd.V ) );
+}
+
+// ----------------------------------------------------------------------------
+
+int main( int argc, const char* argv[] )
+{
+   Exception::DisableGUIOutput();
+   Exception::EnableConsoleOutput();
+
+   try
+   {
+      int maxSize = (argc > 1) ? IsoString( argv[1] ).ToInt() : 1000;
+      if ( maxSize < 16 )
+         throw Error( "Invalid maximum matrix dimension: " + String( maxSize ) );
+
+      RandomNumberGenerator R( 1.0, 1234567 );
+
+      for ( int n = 64; n <= maxSize; n *= 2 )
+      {
+         BenchmarkProduct<double>( n, R, "double" );
+         BenchmarkProduct<float>( n, R, "float" );
+      }
+      for ( int n = 64; n <= maxSize; n *= 2 )
+         BenchmarkSolvers( n, R );
+      for ( int n = 32; 2*n <= maxSize; n *= 2 )
+         BenchmarkSVD( 2*n, n, R );
+
+      return 0;
+   }
+   ERROR_HANDLER
+   return -1;
+}
+
+// ----------------------------------------------------------------------------
+// EOF pcl/algebench.cpp - Released 2019-01-21T12:06:07Z
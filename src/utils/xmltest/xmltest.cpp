@@ -0,0 +1,254 @@
+//     ____   ______ __
+//    / __ \ / ____// /
+//   / /_/ // /    / /
+//  / ____// /___ / /___   PixInsight Class Library
+// /_/     \____//_____/   PCL 02.01.11.0938
+// ----------------------------------------------------------------------------
+//
+// This file is part of the PCL XML parser test utility.
+//
+// Copyright (c) 2019 Pleiades Astrophoto S.L.
+//
+// Redistribution and use in both source and binary forms, with or without
+// modification, is permitted provided that the following conditions are met:
+//
+// 1. All redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+// 2. All redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the names "PixInsight" and "Pleiades Astrophoto", nor the names
+//    of their contributors, may be used to endorse or promote products derived
+//    from this software without specific prior written permission. For written
+//    permission, please contact info@pixinsight.com.
+//
+// 4. All products derived from this software, in any form whatsoever, must
+//    reproduce the following acknowledgment in the end-user documentation
+//    and/or other materials provided with the product:
+//
+//    "This product is based on software from the PixInsight project, developed
+//    by Pleiades Astrophoto and its contributors (http://pixinsight.com/)."
+//
+//    Alternatively, if that is where third-party acknowledgments normally
+//    appear, this acknowledgment must be reproduced in the product itself.
+//
+// THIS SOFTWARE IS PROVIDED BY PLEIADES ASTROPHOTO AND ITS CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL PLEIADES ASTROPHOTO OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, BUSINESS
+// INTERRUPTION; PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; AND LOSS OF USE,
+// DATA OR PROFITS) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+
+/*
+ * A command line utility to test the equivalence of the XML parsers of PCL.
+ *
+ * A set of valid documents is damaged with random deletions and insertions
+ * of markup fragments. Each resulting text is parsed with
+ * XMLDocument::Parse(), XMLDocument::ParseUTF8() and a plain XMLSAXParser
+ * object. For valid UTF-8 text, the three parsers must either fail with the
+ * same error message, including the text location of the error, or succeed
+ * generating identical documents, including the text locations of all nodes.
+ * Mutated texts that are not valid UTF-8 are not compared.
+ *
+ * Usage: xmltest [<n>]
+ *
+ * where <n> is the number of tested documents (default = 20000). The exit
+ * code is zero if no differences have been found.
+ *
+ * Copyright (c) 2019, Pleiades Astrophoto S.L.
+ */
+
+#include <pcl/ErrorHandler.h>
+#include <pcl/Random.h>
+#include <pcl/XML.h>
+
+#include <iostream>
+
+using namespace pcl;
+
+// ----------------------------------------------------------------------------
+
+static const char* s_documents[] =
+{
+   "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+   "<!DOCTYPE foo SYSTEM \"foo.dtd\">\n"
+   "<!-- comment -->\n"
+   "<root a=\"1\" b='2'>\n"
+   "  <x y=\"\xC3\xA9\xF0\x9F\x98\x80\">t\xC3\xA9xt &amp; more</x>\r\n"
+   "  <e/><![CDATA[ <cdata> ]]><?pi some data?>\n"
+   "  <!ELEM foo>\n"
+   "</root>\n",
+
+   "<a><b c = \"d\" /><b>text</b>\n"
+   "\n"
+   "<c\n"
+   " d='e'\n"
+   ">\xF0\x9F\x98\x80\xF0\x9F\x98\x80 x</c></a>"
+};
+
+static const char* s_fragments[] =
+{
+   "<", ">", "/", "?", "!", "\"", "'", "=", " ", "\t", "\n", "\r\n", "-", "--", "-->", "]]>",
+   "<![CDATA[", "<!--", "<?xml version=\"1.0\"?>", "<!DOCTYPE x>", "</", "/>", "?>", "&", ":", "x", "1",
+   "<a>", "</a>", "<b/>", "a=", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"
+};
+
+// ----------------------------------------------------------------------------
+
+static int RandomIndex( RandomNumberGenerator& R, int n )
+{
+   return int( R.Rand32() % uint32( n ) );
+}
+
+// ----------------------------------------------------------------------------
+
+static bool IsValidUTF8( const IsoString& text )
+{
+   for ( IsoString::const_iterator i = text.Begin(); i < text.End(); )
+   {
+      uint32 c = uint8( *i++ );
+      if ( c < 0x80 )
+         continue;
+      int n;
+      uint32 cmin;
+      if ( (c & 0xE0) == 0xC0 )
+         n = 1, cmin = 0x80, c &= 0x1F;
+      else if ( (c & 0xF0) == 0xE0 )
+         n = 2, cmin = 0x800, c &= 0x0F;
+      else if ( (c & 0xF8) == 0xF0 )
+         n = 3, cmin = 0x10000, c &= 0x07;
+      else
+         return false;
+      for ( ; n > 0; --n, ++i )
+      {
+         if ( i == text.End() || (uint8( *i ) & 0xC0) != 0x80 )
+            return false;
+         c = (c << 6) | (uint8( *i ) & 0x3F);
+      }
+      // Reject overlong sequences, surrogates and out of range code points.
+      if ( c < cmin || c >= 0xD800 && c <= 0xDFFF || c > 0x10FFFF )
+         return false;
+   }
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+static void DumpNode( IsoString& text, const XMLNode& node )
+{
+   text << IsoString( node.Location().ToString() ) << ' ';
+   node.Serialize( text, false, ' ', 0, 0 );
+   text << '\n';
+   if ( node.IsElement() )
+      for ( const XMLNode& child : static_cast<const XMLElement&>( node ) )
+         DumpNode( text, child );
+}
+
+static IsoString DumpDocument( const XMLDocument& document )
+{
+   IsoString text = document.Serialize();
+   text << '\n';
+   for ( const XMLNode& node : document )
+      DumpNode( text, node );
+   return text;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Returns "OK" followed by a dump of the generated document, or the error
+ * message if parsing fails.
+ */
+static IsoString ParseWith( int parser, const IsoString& text )
+{
+   try
+   {
+      switch ( parser )
+      {
+      default:
+      case 0:
+         {
+            XMLDocument document;
+            document.Parse( text.UTF8ToUTF16() );
+            return "OK\n" + DumpDocument( document );
+         }
+      case 1:
+         {
+            XMLDocument document;
+            document.ParseUTF8( text );
+            return "OK\n" + DumpDocument( document );
+         }
+      case 2:
+         XMLSAXParser().Parse( text );
+         return "OK\n";
+      }
+   }
+   catch ( const Exception& x )
+   {
+      return x.Message().ToUTF8();
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+   Exception::DisableGUIOutput();
+   Exception::EnableConsoleOutput();
+
+   try
+   {
+      int numberOfTests = (argc > 1) ? IsoString( argv[1] ).ToInt() : 20000;
+      if ( numberOfTests < 1 )
+         throw Error( "Invalid number of tests: " + String( numberOfTests ) );
+
+      const int numberOfDocuments = int( sizeof( s_documents )/sizeof( s_documents[0] ) );
+      const int numberOfFragments = int( sizeof( s_fragments )/sizeof( s_fragments[0] ) );
+
+      RandomNumberGenerator R( 1.0, 1234567 );
+      int compared = 0, failed = 0, differences = 0;
+
+      for ( int t = 0; t < numberOfTests; ++t )
+      {
+         IsoString text = s_documents[t % numberOfDocuments];
+         for ( int m = 1 + RandomIndex( R, 3 ); m > 0; --m )
+         {
+            size_type pos = RandomIndex( R, int( text.Length() ) );
+            if ( R() < 0.5 )
+               text.Insert( pos, s_fragments[RandomIndex( R, numberOfFragments )] );
+            else
+               text.Delete( pos, 1 + RandomIndex( R, 4 ) );
+         }
+
+         if ( !IsValidUTF8( text ) )
+            continue;
+         ++compared;
+
+         IsoString dom = ParseWith( 0, text );
+         IsoString utf8 = ParseWith( 1, text );
+         IsoString sax = ParseWith( 2, text );
+         bool ok = dom.StartsWith( "OK" );
+         if ( !ok )
+            ++failed;
+         if ( utf8 != dom || (ok ? !sax.StartsWith( "OK" ) : sax != dom) )
+            if ( ++differences <= 10 )
+               std::cout << "\n** Parsers differ for document:\n" << text
+                         << "\n** XMLDocument::Parse():\n" << dom
+                         << "\n** XMLDocument::ParseUTF8():\n" << utf8
+                         << "\n** XMLSAXParser::Parse():\n" << sax << '\n';
+      }
+
+      std::cout << IsoString().Format( "%d documents compared, %d not well-formed, %d differences.\n",
+                                       compared, failed, differences );
+      return (differences > 0) ? 1 : 0;
+   }
+   ERROR_HANDLER
+   return -1;
+}
+
+// ----------------------------------------------------------------------------
+// EOF pcl/xmltest.cpp - Released 2019-01-21T12:06:07Z